@@ -3,7 +3,36 @@
 #include "tb_allocator.h"
 
 typedef struct cgltf_data cgltf_data;
+typedef struct cgltf_mesh cgltf_mesh;
+typedef struct cgltf_material cgltf_material;
+typedef struct cgltf_image cgltf_image;
 
 char *tb_resolve_asset_path(TbAllocator tmp_alloc, const char *source_name);
 
+// The returned data is reference counted and the caller holds the first
+// reference. Anything that reads from the data asynchronously must hold a
+// reference of its own until it is done
 cgltf_data *tb_read_glb(TbAllocator gp_alloc, const char *path);
+
+// Once the last reference is released the data, its mapped file and every
+// buffer view decoded from it are freed
+void tb_acquire_glb(const cgltf_data *data);
+void tb_release_glb(const cgltf_data *data);
+
+// Number of glbs that have been read and not yet released
+uint32_t tb_glb_count(void);
+
+// Content hashes of the meshes, materials and images of a glb, computed when
+// it is read. Identical content hashes the same no matter which glb it came
+// from so loaders key their entities by these and shared content is only
+// loaded once. Size is how many bytes of the glb the content covers
+typedef struct TbAssetHash {
+  uint64_t hash;
+  uint64_t size;
+} TbAssetHash;
+
+TbAssetHash tb_glb_mesh_hash(const cgltf_data *data, const cgltf_mesh *mesh);
+TbAssetHash tb_glb_material_hash(const cgltf_data *data,
+                                 const cgltf_material *material);
+TbAssetHash tb_glb_image_hash(const cgltf_data *data,
+                              const cgltf_image *image);
@@ -21,3 +21,7 @@ typedef struct TbCameraComponent {
 extern ECS_COMPONENT_DECLARE(TbCameraComponent);
 
 void tb_register_camera_component(TbWorld *world);
+
+// World position of the first camera or the origin when there is none.
+// The query is the caller's and its first term must be TbCameraComponent
+float3 tb_get_camera_position(ecs_world_t *ecs, ecs_query_t *camera_query);
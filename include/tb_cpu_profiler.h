@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A small CPU profiler that is always compiled in, unlike Tracy.
+// Zones are recorded into per-thread buffers only while a capture is running;
+// outside of a capture a zone costs a single atomic load. A capture spans a
+// fixed number of frames and is written out as Chrome trace-event JSON which
+// can be opened with chrome://tracing or ui.perfetto.dev
+
+#define TB_PROF_MAX_THREADS 64
+#define TB_PROF_EVENTS_PER_THREAD (1 << 15)
+#define TB_PROF_DEFAULT_CAPTURE_FRAMES 8
+#define TB_PROF_DEFAULT_CAPTURE_PATH "./capture.json"
+
+typedef struct TbProfZone {
+  const char *name; // NULL when no capture was running at zone begin
+  uint64_t begin;
+} TbProfZone;
+
+typedef struct TbProfCaptureInfo {
+  uint32_t frames;
+  uint32_t threads;
+  uint32_t events;
+  uint32_t dropped; // Events lost to full thread buffers
+  bool written;
+} TbProfCaptureInfo;
+
+bool tb_prof_capturing(void);
+uint64_t tb_prof_now(void);
+
+// Names the calling thread in captures. The string must outlive the profiler
+void tb_prof_set_thread_name(const char *name);
+
+// Zone names must be string literals or otherwise outlive the capture
+TbProfZone tb_prof_zone_begin(const char *name);
+void tb_prof_zone_end(TbProfZone *zone);
+void tb_prof_emit(const char *name, uint64_t begin, uint64_t end);
+
+// Asks for the next frame_count frames to be captured and written to path.
+// Returns false if a capture is already pending or running
+bool tb_prof_request_capture(uint32_t frame_count, const char *path);
+
+// Marks a frame boundary. Starts, counts and finishes captures so it must only
+// be called from the main thread
+void tb_prof_frame(void);
+
+// Stats about the most recently finished capture
+TbProfCaptureInfo tb_prof_last_capture(void);
+
+#define TB_PROF_SCOPE(name)                                                    \
+  __attribute__((cleanup(tb_prof_zone_end)))                                   \
+  TbProfZone TB_COUNTER(prof_zone) = tb_prof_zone_begin(name);
+
+#ifdef __cplusplus
+}
+#endif
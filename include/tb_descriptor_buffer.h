@@ -14,6 +14,7 @@ typedef struct TbDescriptorBuffer {
   TbBuffer buffer;
   TbHostBuffer host;
   uint8_t *data_ptr;
+  uint8_t *shadow; // CPU copy of the buffer's contents. Never read from gpu
 #ifndef TB_FINAL
   const char *name;
 #endif
@@ -24,6 +25,13 @@ typedef struct TbDescriptor {
   VkDescriptorDataEXT data;
 } TbDescriptor;
 
+typedef struct TbDescriptorWrite {
+  uint32_t slot;    // Set sized slot from tb_alloc_desc_slot
+  uint32_t binding;
+  uint32_t element; // Array element within the binding
+  TbDescriptor desc;
+} TbDescriptorWrite;
+
 VkResult tb_create_descriptor_buffer(TbRenderSystem *rnd_sys,
                                      VkDescriptorSetLayout layout,
                                      const char *name, uint32_t capacity,
@@ -35,6 +43,25 @@ void tb_destroy_descriptor_buffer(TbRenderSystem *rnd_sys,
 VkDescriptorBufferBindingInfoEXT
 tb_desc_buff_get_binding(const TbDescriptorBuffer *desc_buf);
 
+// Reserves a set sized slot that stays valid until it is freed. Grows the
+// buffer if needed
+uint32_t tb_alloc_desc_slot(TbRenderSystem *rnd_sys,
+                            TbDescriptorBuffer *desc_buf);
+
+// Writes a batch of descriptors to previously allocated slots. Descriptors
+// that match what the slot already holds are skipped and the ranges that did
+// change are uploaded with as few copies as possible
+void tb_write_descs_to_buffer(TbRenderSystem *rnd_sys,
+                              TbDescriptorBuffer *desc_buf,
+                              uint32_t write_count,
+                              const TbDescriptorWrite *writes);
+
+// Sorts copies by destination and merges any that overlap or touch so that
+// an upload takes as few copies as possible. Each copy must read from the
+// same offset it writes to. Returns how many copies are left
+uint32_t tb_merge_buffer_copies(uint32_t count, TbBufferCopy *copies);
+
+// Allocates a slot and writes a single descriptor to it.
 // Returns the index of the descriptor in the buffer
 uint32_t tb_write_desc_to_buffer(TbRenderSystem *rnd_sys,
                                  TbDescriptorBuffer *desc_buf, uint32_t binding,
@@ -20,7 +20,7 @@ typedef struct TbDynDescWrite {
 // A descriptor pool that contains a single set with a single type of resizable
 // descriptor
 typedef struct TbDynDescPool {
-
+  TbAllocator alloc;
   uint32_t desc_cap;
   uint32_t binding;
   VkDescriptorSetLayout layout;
@@ -28,17 +28,53 @@ typedef struct TbDynDescPool {
   VkDescriptorPool pools[TB_MAX_FRAME_STATES];
   VkDescriptorSet sets[TB_MAX_FRAME_STATES];
   TbFreeList free_list;
-  TB_QUEUE_OF(VkWriteDescriptorSet) write_queues[TB_MAX_FRAME_STATES];
+  // Released indices wait here until no frame in flight can reference them
+  TbFreeList released;
+  TbFreeList pending[TB_MAX_FRAME_STATES];
+  // Latest descriptor written to each index, tightly packed by type so that
+  // neighboring indices can be written to a set with one ranged write
+  uint32_t desc_size;
+  uint8_t *descs;
+  // One bit per index that still has to be written to each frame state's set
+  uint32_t *dirty[TB_MAX_FRAME_STATES];
 } TbDynDescPool;
 
 void tb_create_dyn_desc_pool(TbRenderSystem *rnd_sys, const char *name,
                              VkDescriptorSetLayout layout,
                              VkDescriptorType type, uint32_t desc_cap,
                              TbDynDescPool *pool, uint32_t binding);
+void tb_destroy_dyn_desc_pool(TbRenderSystem *rnd_sys, TbDynDescPool *pool);
+
+// Sets up and tears down only the CPU side of a pool: the descriptors, the
+// dirty bits and the free lists. tb_create_dyn_desc_pool builds on these;
+// on their own they let the pool's bookkeeping be driven without a device
+void tb_init_dyn_desc_storage(TbAllocator alloc, VkDescriptorType type,
+                              uint32_t desc_cap, TbDynDescPool *pool);
+void tb_destroy_dyn_desc_storage(TbDynDescPool *pool);
 
+// Writes are copied into the pool so the caller's array can be freed as soon
+// as this returns. Each frame state's set is written when it is next ticked
 bool tb_write_dyn_desc_pool(TbDynDescPool *pool, uint32_t write_count,
                             const TbDynDescWrite *writes, uint32_t *out_idxs);
 
+// Points an index from tb_write_dyn_desc_pool at a different descriptor.
+// Each frame state's set changes when that state is next ticked so frames in
+// flight keep reading the old descriptor
+void tb_update_dyn_desc(TbDynDescPool *pool, uint32_t idx,
+                        const TbDynDescWrite *write);
+
+// Hands an index from tb_write_dyn_desc_pool back to the pool. It is only
+// reused once every frame state has been ticked past it
+void tb_release_dyn_desc(TbDynDescPool *pool, uint32_t idx);
+
+// Recycles the indices released before the given frame state was last ticked
+// and gathers the writes its set is missing as ranged writes allocated from
+// alloc. The writes point into the pool's descriptors and stay valid until the
+// pool is next written to. Returns how many writes were gathered
+uint32_t tb_flush_dyn_desc_pool(TbDynDescPool *pool, uint32_t frame_idx,
+                                TbAllocator alloc,
+                                VkWriteDescriptorSet **out_writes);
+
 // Call this once per frame after you've issues any relevant writes
 void tb_tick_dyn_desc_pool(TbRenderSystem *rnd_sys, TbDynDescPool *pool);
 
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Picks a resolution scale for the scene passes from measured GPU frame
+// times. GPU cost is assumed to follow the pixel count, so the scale moves
+// by the square root of the ratio between the budget and the smoothed time.
+// Spikes are followed right away while recovery waits for clear headroom so
+// the scale doesn't oscillate around the budget.
+// The controller is pure state so it behaves the same for a given trace of
+// frame times.
+
+#define TB_DYN_RES_DEFAULT_TARGET_MS 16.0f
+#define TB_DYN_RES_DEFAULT_MIN_SCALE 0.5f
+
+typedef struct TbDynResController {
+  float target_ms; // GPU time budget per frame
+  float min_scale;
+  float max_scale;
+  float scale;    // Current scale applied to both axes
+  float avg_ms;   // Smoothed GPU time; 0 until the first sample
+  uint32_t delay; // Frames to wait before the scale may change again
+} TbDynResController;
+
+void tb_dyn_res_init(TbDynResController *self, float target_ms,
+                     float min_scale, float max_scale);
+
+// Feeds one frame's GPU time and returns the scale to render the next
+// frame at. Non-positive times are treated as missing samples
+float tb_dyn_res_update(TbDynResController *self, float gpu_ms);
+
+#ifdef __cplusplus
+}
+#endif
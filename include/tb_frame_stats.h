@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include <stdbool.h>
+
+// Number of finished frames kept around for graphs and CSV dumps
+#define TB_FRAME_STATS_HISTORY 256
+#define TB_FRAME_STATS_DEFAULT_CSV_PATH "./frame_stats.csv"
+
+// Counters are summed over a frame and reset when it ends.
+// Levels keep their value across frames and are either set outright or moved
+// up and down as work starts and finishes
+typedef enum TbFrameStat {
+  // Counters
+  TB_FRAME_STAT_DRAW_CALLS,
+  TB_FRAME_STAT_TRIANGLES, // Mesh triangles submitted for the main view
+  TB_FRAME_STAT_UPLOADS,
+  TB_FRAME_STAT_UPLOAD_BYTES, // Buffer copies only; image sizes are unknown
+  TB_FRAME_STAT_DESC_WRITES,
+  // Levels
+  TB_FRAME_STAT_TMP_BYTES,
+  TB_FRAME_STAT_LOADS_IN_FLIGHT,
+  TB_FRAME_STAT_ENTITIES,
+  TB_FRAME_STAT_TABLES,
+  TB_FRAME_STAT_COUNT,
+} TbFrameStat;
+
+typedef struct TbFrameStatsSample {
+  uint64_t frame;
+  float frame_ms;
+  int64_t values[TB_FRAME_STAT_COUNT];
+} TbFrameStatsSample;
+
+// Stats may be recorded from any thread. A value lands in whichever frame is
+// open when it is recorded, so work done by the render thread shows up one
+// frame after the main thread work that issued it
+void tb_frame_stat_add(TbFrameStat stat, int64_t value);
+void tb_frame_stat_set(TbFrameStat stat, int64_t value);
+
+const char *tb_frame_stat_name(TbFrameStat stat);
+
+// Closes the open frame and stores it in the history ring. Main thread only
+void tb_frame_stats_end_frame(float frame_ms);
+
+// How many frames are in the history, at most TB_FRAME_STATS_HISTORY
+uint32_t tb_frame_stats_count(void);
+// Returns a finished frame where age 0 is the most recent one.
+// Age must be less than tb_frame_stats_count
+const TbFrameStatsSample *tb_frame_stats_get(uint32_t age);
+
+// Writes the history, oldest frame first. Returns false with a warning if
+// the file can't be written
+bool tb_frame_stats_write_csv(const char *path);
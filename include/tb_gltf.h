@@ -16,12 +16,54 @@
 
 // Toybox specific helpers
 #include "tb_allocator.h"
+#include "tb_task_scheduler.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
+// Decode a view into memory from the given allocator and keep it on the view.
+// Does nothing if the view was already decoded.
+// Uncompressed views aren't copied. Their data points straight into the
+// buffer, see tb_is_buffer_view_aliased
 cgltf_result tb_decompress_buffer_view(TbAllocator alloc,
                                        cgltf_buffer_view *view);
+
+// How many bytes a view takes up once decoded
+uint64_t tb_buffer_view_decoded_size(const cgltf_buffer_view *view);
+
+// Decode a view into caller provided memory without keeping it on the view
+cgltf_result tb_decode_buffer_view(const cgltf_buffer_view *view, void *dst);
+
+typedef struct TbBufferViewDecode {
+  cgltf_buffer_view *view;
+  // When set the view is decoded straight into this memory. Otherwise it is
+  // decoded the same way tb_decompress_buffer_view would
+  void *dst;
+  cgltf_result result;
+} TbBufferViewDecode;
+
+// Decode a batch of views at once.
+// Meshopt codecs delta encode a stream from front to back so a single view
+// can't be split up. Instead independent views are spread across the task
+// scheduler and the calling thread participates while it waits.
+// Returns the first failure if any view failed to decode
+cgltf_result tb_decompress_buffer_views(TbTaskScheduler enki,
+                                        TbAllocator alloc, uint32_t count,
+                                        TbBufferViewDecode *decodes);
+
+// True when the view's data points into its buffer rather than memory of its
+// own. Such data must not be freed and is only valid while the buffer is
+bool tb_is_buffer_view_aliased(const cgltf_buffer_view *view);
+
+// Loaders report every byte they copy out of a glb so the cost of a load can
+// be measured. The count is global and only ever grows
+void tb_gltf_count_copy(uint64_t size);
+uint64_t tb_gltf_copied_bytes(void);
+
+// Likewise loaders report the content size of every request that resolved to
+// an asset with the same content hash that was already loaded or loading
+void tb_gltf_count_reuse(uint64_t size);
+uint64_t tb_gltf_reused_bytes(void);
 #ifdef __cplusplus
 }
 #endif
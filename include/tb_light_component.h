@@ -12,6 +12,7 @@ typedef uint32_t TbViewId;
 typedef struct TbDirectionalLightComponent {
   float3 color;
   float4 cascade_splits;
+  uint32_t cascade_count; // Set by the shadow system from TbSettings
   TbViewId cascade_views[TB_CASCADE_COUNT];
 } TbDirectionalLightComponent;
 extern ECS_COMPONENT_DECLARE(TbDirectionalLightComponent);
@@ -36,19 +36,27 @@ extern ECS_COMPONENT_DECLARE(TbMaterialComponent);
 // of memory that represents that material
 typedef bool TbMatParseFn(const cgltf_data *gltf_data, const char *name,
                           const cgltf_material *material, void **out_mat_data);
-typedef void TbMatOnLoadFn(ecs_world_t *ecs, void *mat_data);
+// Anything the material loads in turn should inherit its load priority
+typedef void TbMatOnLoadFn(ecs_world_t *ecs, TbMaterial mat, void *mat_data);
+// Gives back anything load_fn acquired. The material system frees mat_data
+typedef void TbMatOnUnloadFn(ecs_world_t *ecs, void *mat_data);
 typedef bool TbMatIsReadyFn(ecs_world_t *ecs, const TbMaterialData *data);
 typedef void *TbMatGetDataFn(ecs_world_t *ecs, const TbMaterialData *data);
 typedef size_t TbMatGetSizeFn(void);
 typedef bool TbMatIsTransparent(const TbMaterialData *data);
+// Told the largest size in pixels the material was drawn at this frame
+typedef void TbMatOnUsageFn(ecs_world_t *ecs, void *mat_data,
+                            float screen_size);
 
 typedef struct TbMaterialDomain {
   TbMatParseFn *parse_fn;
   TbMatOnLoadFn *load_fn;
+  TbMatOnUnloadFn *unload_fn;
   TbMatIsReadyFn *ready_fn;
   TbMatGetDataFn *get_data_fn;
   TbMatGetSizeFn *get_size_fn;
   TbMatIsTransparent *is_trans_fn;
+  TbMatOnUsageFn *usage_fn; // Optional
 } TbMaterialDomain;
 
 bool tb_register_mat_usage(ecs_world_t *ecs, const char *domain_name,
@@ -61,12 +69,25 @@ VkDescriptorSet tb_mat_sys_get_set(ecs_world_t *ecs);
 
 VkDescriptorBufferBindingInfoEXT tb_mat_sys_get_table_addr(ecs_world_t *ecs);
 
+// Every call takes a reference that must be given back with
+// tb_mat_sys_release_mat_ref.
+// Materials with the same content hash resolve to the same entity even when
+// they come from different glbs
 TbMaterial tb_mat_sys_load_gltf_mat(ecs_world_t *ecs, const cgltf_data *data,
                                     const char *name, TbMaterialUsage usage);
 
+// The material is destroyed once the last reference is gone. Default
+// materials are never destroyed and are safe to pass here
+void tb_mat_sys_release_mat_ref(ecs_world_t *ecs, TbMaterial mat);
+
 // Returns true if the material is ready to be used
 bool tb_is_material_ready(ecs_world_t *ecs, TbMaterial mat_ent);
 
 bool tb_is_mat_transparent(ecs_world_t *ecs, TbMaterial mat_ent);
 
+// Lets the material's domain know how large the material appears on screen so
+// that anything it references, like textures, can be streamed to match
+void tb_mat_sys_report_screen_size(ecs_world_t *ecs, TbMaterial mat_ent,
+                                   float screen_size);
+
 TbMaterial tb_get_default_mat(ecs_world_t *ecs, TbMaterialUsage usage);
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "tb_allocator.h"
+#include "tb_free_list.h"
+#include "tb_gltf.slangh"
+#include "tb_mesh_system.h"
+
+// The persistent draw records of the mesh system and the bookkeeping of which
+// mesh instance owns which slot. None of this touches the world or the device
+// so that it can be driven without either
+
+#define TB_MESH_DRAW_SLOT_NONE SDL_MAX_UINT32
+
+// CPU side copy of a persistent draw record along with what's needed to build
+// and order indirect commands without going back to the ECS
+typedef struct TbMeshDrawRecord {
+  TbGLTFDrawData data;
+  ecs_entity_t owner; // Mesh instance owning this slot. Zero when free
+  uint32_t next;      // Next slot owned by the same instance
+  TbAABB bounds;      // Local space bounds of the submesh
+  uint32_t index_count;
+  bool transparent;
+  TbMaterial material; // Told how large it appears so textures can stream
+  // Neighbouring slots drawn with the same material
+  uint32_t mat_prev;
+  uint32_t mat_next;
+  // Large submeshes are drawn as whichever of their meshlets pass culling
+  uint32_t meshlet_count;
+  const TbMeshlet *meshlets;
+  TbSubMeshLods lods; // Empty when the submesh has no simplified LODs
+} TbMeshDrawRecord;
+
+// Present on mesh instances whose submeshes have draw slots. The slots form a
+// chain through TbMeshDrawRecord::next
+typedef struct TbMeshDrawSlots {
+  uint32_t head;
+  uint32_t count;
+} TbMeshDrawSlots;
+
+// First slot of the chain, through TbMeshDrawRecord::mat_next, of every slot
+// drawn with the material
+typedef struct TbMeshDrawMaterial {
+  TbMaterial material;
+  uint32_t head;
+} TbMeshDrawMaterial;
+
+typedef struct TbMeshDraws {
+  TbAllocator alloc;
+  TbFreeList free_slots;
+  TbMeshDrawRecord *records;
+  // Sorted by material. Only materials with at least one slot are present
+  TB_DYN_ARR_OF(TbMeshDrawMaterial) materials;
+  uint32_t capacity;
+  uint32_t slot_count; // High water mark of used slots
+  // Slots written since the last upload. Empty when dirty_min > dirty_max
+  uint32_t dirty_min;
+  uint32_t dirty_max;
+} TbMeshDraws;
+
+// Bit N of a draw's visibility mask is set when it is visible to view N
+#define TB_MESH_MAX_VIEWS 64
+
+typedef struct TbMeshCullView {
+  TbViewId view_id;
+  TbFrustum frustum;
+} TbMeshCullView;
+
+// Every draw that passed at least one view's frustum test this frame
+typedef struct TbMeshVisibleDraws {
+  uint32_t count;
+  uint32_t *slots;
+  uint64_t *masks;
+  float3 *centers; // World space bounds center used for depth sorting
+  float *scales;   // Largest axis scale of the owner's transform
+} TbMeshVisibleDraws;
+
+// Looks up the world transform of the mesh instance owning a slot
+typedef float4x4 (*TbMeshDrawWorldFn)(void *ctx, ecs_entity_t owner);
+
+void tb_create_mesh_draws(TbAllocator alloc, uint32_t capacity,
+                          TbMeshDraws *draws);
+void tb_destroy_mesh_draws(TbMeshDraws *draws);
+
+// Makes room for count more slots. Grows the records, keeping every slot
+// where it is, so the owner of the draws must reallocate the GPU copy when the
+// capacity changes
+void tb_reserve_mesh_draws(TbMeshDraws *draws, uint32_t count);
+
+// Copies the record into a free slot and links it into the instance's chain.
+// The record's owner and next are filled in here. Returns the slot or
+// TB_MESH_DRAW_SLOT_NONE if no room was reserved for it
+uint32_t tb_add_mesh_draw(TbMeshDraws *draws, ecs_entity_t owner,
+                          TbMeshDrawSlots *slots,
+                          const TbMeshDrawRecord *record);
+
+// Returns every slot of the instance's chain to the free list
+void tb_free_mesh_draws(TbMeshDraws *draws, const TbMeshDrawSlots *slots);
+
+// First slot drawn with the material, or TB_MESH_DRAW_SLOT_NONE. The rest
+// follow through TbMeshDrawRecord::mat_next
+uint32_t tb_mesh_draws_material_head(const TbMeshDraws *draws, TbMaterial mat);
+
+// Marks every written slot as uploaded
+void tb_clear_mesh_draws_dirty(TbMeshDraws *draws);
+
+float tb_mesh_max_scale(const float4x4 *m);
+
+// Bounds in world space that still enclose the local bounds after rotation
+TbAABB tb_mesh_world_bounds(const float4x4 *m, TbAABB local);
+
+// Tests every live draw against every view in one pass so that each extra
+// view only costs one frustum test per draw. The result is allocated from
+// alloc which is expected to be a per frame arena
+TbMeshVisibleDraws tb_cull_mesh_draws(const TbMeshDraws *draws,
+                                      TbAllocator alloc,
+                                      TbMeshDrawWorldFn get_world, void *ctx,
+                                      uint32_t view_count,
+                                      const TbMeshCullView *views);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "tb_mesh_system.h"
+
+// Splitting primitives into meshlets and simplifying them into LOD chains.
+// Works on plain index and position arrays so it can run without a world or
+// a device
+
+// Submeshes with fewer triangles than this are only ever culled as a whole
+#define TB_MESHLET_MIN_TRIANGLES 512
+#define TB_MESHLET_MAX_VERTICES 64
+#define TB_MESHLET_MAX_TRIANGLES 124
+#define TB_MESHLET_CONE_WEIGHT 0.25f
+
+// Submeshes with fewer triangles than this are always drawn at full detail
+#define TB_MESH_LOD_MIN_TRIANGLES 256
+// Largest deviation allowed when simplifying, relative to the mesh extents
+#define TB_MESH_LOD_TARGET_ERROR 0.05f
+
+// Triangles of a primitive in the form meshoptimizer expects. Positions stay
+// in the same (possibly quantized) space as the submesh AABB
+typedef struct TbPrimGeometry {
+  size_t index_count;
+  size_t vertex_count;
+  uint32_t *indices;
+  float *positions;
+} TbPrimGeometry;
+
+// Simplified index buffers of a primitive. Index offsets are only known once
+// the indices are written to the arena
+typedef struct TbPrimLods {
+  TbSubMeshLods lods;
+  uint32_t *indices[TB_MESH_MAX_LODS];
+} TbPrimLods;
+
+// Builds a chain of simplified index buffers that roughly halve the triangle
+// count at each level. Each level is simplified from LOD 0 so that its error
+// is measured against the original surface. Index buffers are allocated from
+// tb_thread_alloc and released with tb_free_lods
+TbPrimLods tb_build_lods(const TbPrimGeometry *geom);
+void tb_free_lods(TbPrimLods *lods);
+
+// Splits a primitive into meshlets and writes its indices to dst in meshlet
+// order so that each meshlet covers a contiguous range of indices. The
+// meshlets are allocated from tb_global_alloc.
+// Returns no meshlets and leaves dst untouched when the primitive isn't worth
+// splitting
+TbSubMeshMeshlets tb_build_meshlets(const TbPrimGeometry *geom,
+                                    bool double_sided, uint32_t *dst);
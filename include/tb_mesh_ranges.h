@@ -0,0 +1,44 @@
+#pragma once
+
+#include "tb_dynarray.h"
+#include "tb_offset_alloc.h"
+#include "tb_render_common.h"
+
+// The index and vertex range bookkeeping of the mesh arena. None of this
+// touches the world or the device so that it can be driven without either.
+// Callers are expected to provide their own locking
+
+// The index and vertex ranges of one mesh
+typedef struct TbMeshArenaRange {
+  TbOffsetAllocation index_alloc;
+  TbOffsetAllocation vertex_alloc;
+} TbMeshArenaRange;
+typedef TB_DYN_ARR_OF(TbMeshArenaRange) TbMeshArenaRanges;
+
+typedef struct TbMeshRanges {
+  TbOffsetAllocator indices;
+  TbOffsetAllocator vertices;
+  // Ranges of destroyed meshes wait here until no frame in flight can draw
+  // from them
+  TbMeshArenaRanges released;
+  TbMeshArenaRanges pending[TB_MAX_FRAME_STATES];
+} TbMeshRanges;
+
+void tb_create_mesh_ranges(TbAllocator alloc, uint32_t max_indices,
+                           uint32_t max_vertices, uint32_t max_allocs,
+                           TbMeshRanges *ranges);
+void tb_destroy_mesh_ranges(TbMeshRanges *ranges);
+
+// Reserves index and vertex ranges for a mesh. Nothing is reserved if either
+// doesn't fit
+bool tb_alloc_mesh_range(TbMeshRanges *ranges, uint32_t index_count,
+                         uint32_t vertex_count, TbMeshArenaRange *range);
+
+// The range is only handed out again once the frame state it was released
+// in comes around again
+void tb_release_mesh_range(TbMeshRanges *ranges, TbMeshArenaRange range);
+
+// Call once per frame with the frame state about to be recorded. Everything
+// that was pending on it is freed and everything released since the last
+// call starts pending on it
+void tb_recycle_mesh_ranges(TbMeshRanges *ranges, uint32_t frame_idx);
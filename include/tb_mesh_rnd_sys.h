@@ -6,6 +6,7 @@
 #include "tb_dynarray.h"
 #include "tb_gltf.slangh"
 #include "tb_mesh_component.h"
+#include "tb_mesh_draws.h"
 #include "tb_render_common.h"
 #include "tb_render_system.h"
 #include "tb_render_target_system.h"
@@ -51,6 +52,11 @@ typedef struct TbIndirectDraw {
   uint32_t stride;
 } TbIndirectDraw;
 
+typedef struct TbMeshViewDraws {
+  TbViewId view_id;
+  TbIndirectDraw draw;
+} TbMeshViewDraws;
+
 typedef struct TbPrimitiveBatch {
 #if TB_USE_DESC_BUFFER == 1
   VkDescriptorBufferBindingInfoEXT view_addr;
@@ -86,7 +92,8 @@ typedef struct TbMeshSystem {
   TbRenderPipelineSystem *rp_sys;
 
   ecs_query_t *camera_query;
-  ecs_query_t *mesh_query;
+  ecs_query_t *pending_draw_query;
+  ecs_query_t *drawn_query;
   ecs_query_t *dir_light_query;
 
   TbDrawContextId prepass_draw_ctx2;
@@ -101,8 +108,12 @@ typedef struct TbMeshSystem {
   TbShader transparent_shader;
   TbShader prepass_shader;
 
-  // Re-used by shadows
-  TbDrawBatch *opaque_batch;
+  // Template of the opaque batch that shadows fill in for each cascade.
+  // Built every frame and consumed by the shadow system
+  TbDrawBatch *shadow_batch;
+  // Opaque draws culled against each shadow view. Reset every frame
+  TbMeshViewDraws *shadow_draws;
+  uint32_t shadow_draw_count;
 
   TB_DYN_ARR_OF(TbMesh) meshes;
   // For per draw data
@@ -110,10 +121,28 @@ typedef struct TbMeshSystem {
 
   TbDescriptorBuffer opaque_draw_descs;
   TbDescriptorBuffer trans_draw_descs;
+
+  // Persistent draw records. Every submesh of every mesh instance owns a slot
+  // that is only written when the instance is added, changed or removed.
+  // Indirect commands reference their slot through firstInstance.
+  TbMeshDraws draws;
+  TbBuffer draw_buffer;
+  TbHostBuffer draw_host;
+  uint32_t draw_buffer_cap; // Records the draw buffer was sized for
+  uint32_t frames_since_validate;
+
+  // Camera triangles before and after meshlet culling. Reset every frame
+  uint64_t tris_considered;
+  uint64_t tris_submitted;
 } TbMeshSystem;
 extern ECS_COMPONENT_DECLARE(TbMeshSystem);
 
 void tb_register_mesh_sys(TbWorld *world);
+
+// Returns this frame's opaque draws visible to the given shadow view or NULL
+// if nothing is visible to it
+const TbIndirectDraw *tb_mesh_sys_get_shadow_draw(TbMeshSystem *self,
+                                                  TbViewId view_id);
 void tb_unregister_mesh_sys(TbWorld *world);
 
 VkDescriptorSet tb_mesh_system_get_pos_set(TbMeshSystem *self);
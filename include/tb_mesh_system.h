@@ -35,6 +35,43 @@ typedef struct TbSubMesh2Data {
 } TbSubMesh2Data;
 extern ECS_COMPONENT_DECLARE(TbSubMesh2Data);
 
+// A small cluster of a submesh's triangles that can be culled on its own.
+// Bounds are in the submesh's local space and the meshlet's indices are a
+// contiguous range starting index_offset indices into the submesh
+typedef struct TbMeshlet {
+  float3 center;
+  float radius;
+  float3 cone_apex;
+  float3 cone_axis;
+  float cone_cutoff; // Back facing from everywhere dot(view, axis) >= cutoff
+  uint32_t index_offset;
+  uint32_t index_count;
+} TbMeshlet;
+
+// Only present on submeshes large enough to be worth culling per meshlet
+typedef struct TbSubMeshMeshlets {
+  uint32_t count;
+  const TbMeshlet *meshlets;
+} TbSubMeshMeshlets;
+extern ECS_COMPONENT_DECLARE(TbSubMeshMeshlets);
+
+#define TB_MESH_MAX_LODS 4
+
+// One level of detail of a submesh. LOD 0 is the full resolution submesh
+typedef struct TbMeshLod {
+  uint32_t index_offset; // Relative to the submesh's first index
+  uint32_t index_count;
+  float error; // Local space distance from the surface of LOD 0
+} TbMeshLod;
+
+// Only present on submeshes that were able to be simplified
+typedef struct TbSubMeshLods {
+  uint32_t count;
+  TbMeshLod lods[TB_MESH_MAX_LODS];
+} TbSubMeshLods;
+extern ECS_COMPONENT_DECLARE(TbSubMeshLods);
+extern ECS_COMPONENT_DECLARE(TbAABB);
+
 VkDescriptorSetLayout tb_mesh_sys_get_set_layout(ecs_world_t *ecs);
 
 VkDescriptorSet tb_mesh_sys_get_idx_set(ecs_world_t *ecs);
@@ -49,9 +86,25 @@ VkDescriptorBufferBindingInfoEXT tb_mesh_sys_get_norm_addr(ecs_world_t *ecs);
 VkDescriptorBufferBindingInfoEXT tb_mesh_sys_get_tan_addr(ecs_world_t *ecs);
 VkDescriptorBufferBindingInfoEXT tb_mesh_sys_get_uv0_addr(ecs_world_t *ecs);
 
+// Every call takes a reference that must be given back with
+// tb_mesh_sys_release_mesh_ref.
+// Meshes are keyed by their content hash so the same mesh in several glbs
+// resolves to the same entity
 TbMesh2 tb_mesh_sys_load_gltf_mesh(ecs_world_t *ecs, cgltf_data *data,
-                                   const char *path, const char *name,
                                    uint32_t index);
-VkBuffer tb_mesh_sys_get_gpu_mesh(ecs_world_t *ecs, TbMesh2 mesh);
+
+// The mesh, its submeshes and their material references are destroyed once
+// the last reference is gone
+void tb_mesh_sys_release_mesh_ref(ecs_world_t *ecs, TbMesh2 mesh);
+
+// Where a mesh lives in the shared geometry buffer, for binding it to a
+// classic indexed draw. Indices are always 32-bit and byte offsets point at
+// the mesh's first index and first position
+typedef struct TbMeshGeometry {
+  VkBuffer buffer;
+  uint64_t index_offset;
+  uint64_t position_offset;
+} TbMeshGeometry;
+TbMeshGeometry tb_mesh_sys_get_gpu_geometry(ecs_world_t *ecs, TbMesh2 mesh);
 
 bool tb_is_mesh_ready(ecs_world_t *ecs, TbMesh2 mesh_ent);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "tb_allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Hard real-time allocator of ranges inside some externally owned resource
+// (a GPU buffer, a descriptor array, ...). It never touches the memory it
+// manages, it only hands out offsets.
+// Free ranges are sorted into 256 bins on a small float scale (3 bits of
+// mantissa) so allocation is two bit scans away from a suitable block and
+// freeing merges with free neighbors in constant time.
+// Units are up to the caller: bytes, indices, vertices, etc.
+
+#define TB_OFFSET_ALLOC_NO_SPACE 0xffffffff
+
+#define TB_OFFSET_ALLOC_TOP_BIN_COUNT 32
+#define TB_OFFSET_ALLOC_BINS_PER_LEAF 8
+#define TB_OFFSET_ALLOC_LEAF_BIN_COUNT                                         \
+  (TB_OFFSET_ALLOC_TOP_BIN_COUNT * TB_OFFSET_ALLOC_BINS_PER_LEAF)
+
+typedef struct TbOffsetAllocation {
+  uint32_t offset; // TB_OFFSET_ALLOC_NO_SPACE when the allocation failed
+  uint32_t node;   // Needed to free the allocation
+} TbOffsetAllocation;
+
+typedef struct TbOffsetAllocNode {
+  uint32_t data_offset;
+  uint32_t data_size;
+  uint32_t bin_list_prev;
+  uint32_t bin_list_next;
+  uint32_t neighbor_prev;
+  uint32_t neighbor_next;
+  bool used;
+} TbOffsetAllocNode;
+
+typedef struct TbOffsetAllocator {
+  TbAllocator alloc;
+  uint32_t size;
+  uint32_t max_allocs;
+  uint32_t free_storage;
+
+  uint32_t used_bins_top;
+  uint8_t used_bins[TB_OFFSET_ALLOC_TOP_BIN_COUNT];
+  uint32_t bin_indices[TB_OFFSET_ALLOC_LEAF_BIN_COUNT];
+
+  TbOffsetAllocNode *nodes;
+  uint32_t *free_nodes;
+  uint32_t free_offset;
+} TbOffsetAllocator;
+
+// Manages the range [0, size) with room for at most max_allocs live
+// allocations
+void tb_create_offset_allocator(TbAllocator alloc, uint32_t size,
+                                uint32_t max_allocs, TbOffsetAllocator *out);
+void tb_destroy_offset_allocator(TbOffsetAllocator *self);
+
+// Frees every allocation at once
+void tb_reset_offset_allocator(TbOffsetAllocator *self);
+
+TbOffsetAllocation tb_offset_alloc(TbOffsetAllocator *self, uint32_t size);
+void tb_offset_free(TbOffsetAllocator *self, TbOffsetAllocation allocation);
+
+// Total free space and the largest single allocation that is sure to succeed
+uint32_t tb_offset_alloc_free_space(const TbOffsetAllocator *self);
+uint32_t tb_offset_alloc_largest_free(const TbOffsetAllocator *self);
+
+#ifdef __cplusplus
+}
+#endif
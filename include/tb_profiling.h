@@ -15,6 +15,16 @@
 #include <tracy/Tracy.hpp>
 #endif
 
+// Classic macro expansion hack to append __COUNTER__ to a variable name
+// Necessary for creating unique symbols for each scope
+#define TB_CAT2(x, y) x##y
+#define TB_CAT(x, y) TB_CAT2(x, y)
+#define TB_COUNTER(x) TB_CAT(x, __COUNTER__)
+
+// The internal profiler records the same scopes as Tracy so that timings are
+// available from builds that ship without Tracy
+#include "tb_cpu_profiler.h"
+
 #define TracyCategoryColorCore 0xe066ff
 #define TracyCategoryColorRendering 0x7fff00
 #define TracyCategoryColorUI 0xe0eeee
@@ -37,12 +47,6 @@ typedef struct TracyCGPUScope TracyCGPUScope;
 extern "C" {
 #endif
 
-// Classic macro expansion hack to append __COUNTER__ to a variable name
-// Necessary for creating unique symbols for each scope
-#define TB_CAT2(x, y) x##y
-#define TB_CAT(x, y) TB_CAT2(x, y)
-#define TB_COUNTER(x) TB_CAT(x, __COUNTER__)
-
 // A cleanup function used by TB_TRACY_SCOPE
 void tb_tracy_zone_end(TracyCZoneCtx *ctx);
 
@@ -83,7 +87,8 @@ void TracyCVkCollect(TracyCGPUContext *ctx, VkCommandBuffer cmd_buf);
   __attribute__((cleanup(tb_tracy_zone_end))) TracyCZoneCtx TB_COUNTER(ctx) =  \
       ___tracy_emit_zone_begin_callstack(                                      \
           &TracyConcat(__tracy_source_location, TracyLine), TRACY_CALLSTACK,   \
-          true);
+          true);                                                               \
+  TB_PROF_SCOPE(name)
 
 #define TB_TRACY_SCOPEC(name, color)                                           \
   static const struct ___tracy_source_location_data TracyConcat(               \
@@ -92,7 +97,8 @@ void TracyCVkCollect(TracyCGPUContext *ctx, VkCommandBuffer cmd_buf);
   __attribute__((cleanup(tb_tracy_zone_end))) TracyCZoneCtx TB_COUNTER(ctx) =  \
       ___tracy_emit_zone_begin_callstack(                                      \
           &TracyConcat(__tracy_source_location, TracyLine), TRACY_CALLSTACK,   \
-          true);
+          true);                                                               \
+  TB_PROF_SCOPE(name)
 
 #ifdef __cplusplus
 }
@@ -119,8 +125,8 @@ typedef struct TracyCGPUScope TracyCGPUScope;
 #define TracyCVkZoneEnd(...)
 #define TracyCVkCollect(...)
 
-#define TB_TRACY_SCOPE(...)
-#define TB_TRACY_SCOPEC(...)
+#define TB_TRACY_SCOPE(name) TB_PROF_SCOPE(name)
+#define TB_TRACY_SCOPEC(name, color) TB_PROF_SCOPE(name)
 
 #endif
 
@@ -12,7 +12,6 @@
 
 #define TB_VMA_TMP_GPU_MB 64
 #define TB_MAX_ATTACHMENTS 4
-#define TB_MAX_RENDER_PASS_DEPS 8
 #define TB_MAX_RENDER_PASS_TRANS 16
 #define TB_MAX_BARRIERS 16
 
@@ -2,6 +2,7 @@
 
 #include "tb_allocator.h"
 #include "tb_bloom.h"
+#include "tb_dyn_res.h"
 #include "tb_dynarray.h"
 #include "tb_luminance.h"
 #include "tb_render_common.h"
@@ -19,6 +20,9 @@ typedef ecs_entity_t TbShader;
 
 #define TB_MAX_RENDER_PASS_ATTACHMENTS 4
 
+// Frames that per pass GPU times are averaged over
+#define TB_PASS_TIMING_WINDOW 64
+
 typedef uint32_t TbRenderPassId;
 static const TbRenderPassId InvalidRenderPassId = SDL_MAX_UINT32;
 typedef uint32_t TbDrawContextId;
@@ -40,6 +44,12 @@ typedef struct TbPassAttachment {
   TbRenderTargetId attachment;
 } TbPassAttachment;
 
+typedef struct TbPassTiming {
+  const char *name;
+  float gpu_ms;    // Average over the last TB_PASS_TIMING_WINDOW frames
+  float record_ms; // CPU time spent recording the pass last frame
+} TbPassTiming;
+
 typedef struct TbDrawContextDescriptor {
   TbRenderPassId pass_id;
   uint64_t batch_size;
@@ -73,6 +83,7 @@ typedef struct TbRenderPipelineSystem {
   TbRenderPassId sky_pass;
   TbRenderPassId transparent_depth_pass;
   TbRenderPassId transparent_color_pass;
+  TbRenderPassId upscale_pass;
   TbRenderPassId luminance_pass;
   TbRenderPassId brightness_pass;
   TbRenderPassId bloom_blur_pass;
@@ -83,11 +94,25 @@ typedef struct TbRenderPipelineSystem {
   TbRenderPassId ui_pass;
 
   TB_DYN_ARR_OF(TbRenderPass) render_passes;
-  uint32_t *pass_order; // Array that is kept at the same size as render_passes
+  // Live passes in execution order. Sized for every pass but only the first
+  // live_pass_count entries are used; the rest were culled
+  uint32_t *pass_order;
+  uint32_t live_pass_count;
+  // Barriers derived by the render graph and how many passes issue any
+  uint32_t barrier_count;
+  uint32_t barrier_batch_count;
+
+  // Scene passes render into the top left corner of their targets at this
+  // scale of the output resolution. The upscale pass stretches that region
+  // back out before post processing
+  TbDynResController dyn_res;
+  float render_scale;
+  float gpu_ms; // GPU time of the most recently completed frame
 
   // Some default draw contexts
   TbDrawContextId depth_copy_ctx;
   TbDrawContextId color_copy_ctx;
+  TbDrawContextId upscale_ctx;
   TbDrawContextId brightness_ctx;
   TbDrawContextId tonemap_ctx;
   TbDispatchContextId bloom_copy_ctx;
@@ -109,6 +134,7 @@ typedef struct TbRenderPipelineSystem {
   VkPipelineLayout tonemap_pipe_layout;
   TbShader depth_copy_shader;
   TbShader color_copy_shader;
+  TbShader upscale_shader;
   TbShader brightness_shader;
   TbShader comp_copy_shader;
   TbShader tonemap_shader;
@@ -121,6 +147,10 @@ extern ECS_COMPONENT_DECLARE(TbRenderPipelineSystem);
 
 void tb_rnd_on_swapchain_resize(TbRenderPipelineSystem *self);
 
+// Points every pass back at its targets' current images and views. Call after
+// resizing a render target while the render thread is idle
+void tb_render_pipeline_reimport_targets(TbRenderPipelineSystem *self);
+
 TbDrawContextId
 tb_render_pipeline_register_draw_context(TbRenderPipelineSystem *self,
                                          const TbDrawContextDescriptor *desc);
@@ -142,3 +172,14 @@ void tb_render_pipeline_issue_dispatch_batch(TbRenderPipelineSystem *self,
                                              TbDispatchContextId dispatch_ctx,
                                              uint32_t batch_count,
                                              const TbDispatchBatch *batches);
+
+// Fills timings with one entry per live pass in execution order. timings
+// must have room for live_pass_count entries. GPU times are resolved
+// TB_MAX_FRAME_STATES frames after they were recorded and are zero on
+// devices that can't write timestamps
+uint32_t tb_render_pipeline_get_pass_timings(TbRenderPipelineSystem *self,
+                                             TbPassTiming *timings);
+
+// Writes the current pass timings to path as CSV
+bool tb_render_pipeline_write_timings_csv(TbRenderPipelineSystem *self,
+                                          const char *path);
@@ -18,11 +18,32 @@ typedef struct TbWorld TbWorld;
 
 extern ECS_TAG_DECLARE(TbDescriptorReady);
 
+typedef enum TbGpuFreeType {
+  TB_GPU_FREE_BUFFER,
+  TB_GPU_FREE_IMAGE,
+  TB_GPU_FREE_IMAGE_VIEW,
+} TbGpuFreeType;
+
+// A GPU resource waiting for the frames that may still use it to finish
+typedef struct TbGpuFree {
+  TbGpuFreeType type;
+  VkBuffer buffer;
+  VkImage image;
+  VkImageView view;
+  VmaAllocation alloc;
+} TbGpuFree;
+typedef TB_QUEUE_OF(TbGpuFree) TbGpuFreeQueue;
+
 typedef struct TbRenderSystemFrameState {
   TbHostBuffer tmp_host_buffer;
   TbSetWriteQueue set_write_queue;
   TbBufferCopyQueue buf_copy_queue;
   TbBufferImageCopyQueue buf_img_copy_queue;
+  TbBufferCopyQueue async_buf_copy_queue;
+  TbBufferImageCopyQueue async_buf_img_copy_queue;
+  // Upload timeline value that this frame state's async uploads signal
+  uint64_t upload_value;
+  TbGpuFreeQueue free_queue;
 } TbRenderSystemFrameState;
 
 typedef struct TbRenderSystem {
@@ -37,6 +58,9 @@ typedef struct TbRenderSystem {
 
   uint32_t frame_idx;
   TbRenderSystemFrameState frame_states[3];
+
+  // How many bytes were written to the tmp buffer by the last finished frame
+  uint64_t tmp_bytes_last_frame;
 } TbRenderSystem;
 extern ECS_COMPONENT_DECLARE(TbRenderSystem);
 
@@ -47,6 +71,11 @@ VkResult tb_rnd_sys_alloc_gpu_image(TbRenderSystem *self,
                                     const VkImageCreateInfo *create_info,
                                     VmaAllocationCreateFlags vma_flags,
                                     const char *name, TbImage *image);
+// Allocate a persistently mapped host buffer to stage uploads from.
+// The caller owns it and schedules its own copies with tb_rnd_upload_buffers
+VkResult tb_rnd_sys_alloc_host_buffer(TbRenderSystem *self,
+                                      const VkBufferCreateInfo *create_info,
+                                      const char *name, TbHostBuffer *buffer);
 
 VkResult tb_rnd_sys_copy_to_tmp_buffer(TbRenderSystem *self, uint64_t size,
                                        uint32_t alignment, const void *data,
@@ -90,6 +119,16 @@ VkResult tb_rnd_sys_create_gpu_image(TbRenderSystem *self, const void *data,
                                      const char *name, TbImage *image,
                                      TbHostBuffer *host);
 
+// Like tb_rnd_sys_create_gpu_image but hands back where the image's initial
+// contents go instead of copying them from somewhere. That is either the
+// image's own memory or a new host buffer. The caller writes data_size bytes
+// to ptr and then flushes the image's allocation with tb_flush_alloc
+VkResult tb_rnd_sys_alloc_gpu_image_upload(TbRenderSystem *self,
+                                           uint64_t data_size,
+                                           const VkImageCreateInfo *create_info,
+                                           const char *name, TbImage *image,
+                                           TbHostBuffer *host, void **ptr);
+
 VkResult tb_rnd_sys_create_gpu_image_tmp(TbRenderSystem *self, const void *data,
                                          uint64_t data_size, uint32_t alignment,
                                          const VkImageCreateInfo *create_info,
@@ -99,11 +138,22 @@ VkBuffer tb_rnd_get_gpu_tmp_buffer(TbRenderSystem *self);
 
 VkDeviceAddress tb_rnd_get_gpu_tmp_addr(TbRenderSystem *self);
 
+// Returns how many bytes the last finished frame wrote to the tmp buffer
+uint64_t tb_rnd_sys_get_tmp_bytes(TbRenderSystem *self);
+
 // API for updating the contents of a buffer without resizing it
 VkResult tb_rnd_sys_update_gpu_buffer(TbRenderSystem *self,
                                       const TbBuffer *buffer,
                                       const TbHostBuffer *host, void **ptr);
 
+// Like tb_rnd_sys_update_gpu_buffer but only schedules an upload of the
+// given byte range. The returned pointer is to the start of the whole buffer.
+VkResult tb_rnd_sys_update_gpu_buffer_range(TbRenderSystem *self,
+                                            const TbBuffer *buffer,
+                                            const TbHostBuffer *host,
+                                            uint64_t offset, uint64_t size,
+                                            void **ptr);
+
 // Updates the GPU buffer with the provided data via the tmp buffer
 VkResult tb_rnd_sys_update_gpu_buffer_tmp(TbRenderSystem *self,
                                           const TbBuffer *buffer, void *data,
@@ -157,10 +207,36 @@ void tb_rnd_upload_buffer_to_image(TbRenderSystem *self,
                                    TbBufferImageCopy *uploads,
                                    uint32_t upload_count);
 
+// Uploads that don't have to land in the frame they were queued in. They run
+// on a dedicated transfer queue when the device has one and on the graphics
+// queue otherwise. The destination must not be used by the GPU until
+// tb_rnd_is_upload_complete reports the returned value as done
+uint64_t tb_rnd_upload_buffers_async(TbRenderSystem *self,
+                                     TbBufferCopy *uploads,
+                                     uint32_t upload_count);
+uint64_t tb_rnd_upload_buffer_to_image_async(TbRenderSystem *self,
+                                             TbBufferImageCopy *uploads,
+                                             uint32_t upload_count);
+// An upload value of 0 is always complete
+bool tb_rnd_is_upload_complete(TbRenderSystem *self, uint64_t value);
+
 void tb_rnd_free_gpu_buffer(TbRenderSystem *self, TbBuffer *buffer);
 void tb_rnd_free_gpu_image(TbRenderSystem *self, TbImage *image);
 
+// Like the above but destruction waits until the frame states have come
+// back around and no frame in flight can reference the resource anymore.
+// Use these for anything that may have been drawn with
+void tb_rnd_free_gpu_buffer_deferred(TbRenderSystem *self,
+                                     const TbBuffer *buffer);
+void tb_rnd_free_host_buffer_deferred(TbRenderSystem *self,
+                                      const TbHostBuffer *buffer);
+void tb_rnd_free_gpu_image_deferred(TbRenderSystem *self,
+                                    const TbImage *image);
+void tb_rnd_destroy_image_view_deferred(TbRenderSystem *self,
+                                        VkImageView view);
+
 void tb_rnd_destroy_image_view(TbRenderSystem *self, VkImageView view);
+void tb_rnd_destroy_buffer_view(TbRenderSystem *self, VkBufferView view);
 void tb_rnd_destroy_sampler(TbRenderSystem *self, VkSampler sampler);
 void tb_rnd_destroy_set_layout(TbRenderSystem *self,
                                VkDescriptorSetLayout set_layout);
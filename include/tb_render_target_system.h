@@ -3,13 +3,12 @@
 #include "tb_allocator.h"
 #include "tb_dynarray.h"
 #include "tb_render_system.h"
+#include "tb_shadow_cascades.h"
 #include "tb_vk.h"
 
 #include <SDL3/SDL_stdinc.h>
 #include <flecs.h>
 
-#define TB_SHADOW_MAP_DIM 4096
-
 #define TB_RT_SYS_PRIO (TB_RND_SYS_PRIO + 1)
 
 typedef struct TbRenderSystem TbRenderSystem;
@@ -26,6 +25,9 @@ typedef struct TbRenderTargetDescriptor {
   uint32_t mip_count;
   uint32_t layer_count;
   VkImageViewType view_type;
+  // Contents only need to live between passes of a single frame so the
+  // target's memory may be shared with other transient targets
+  bool transient;
 } TbRenderTargetDescriptor;
 
 typedef struct TbRenderTargetSystem {
@@ -40,6 +42,8 @@ typedef struct TbRenderTargetSystem {
   TbRenderTargetId depth_buffer;
   TbRenderTargetId normal_buffer;
   TbRenderTargetId hdr_color;
+  // hdr_color brought back up to output resolution after dynamic resolution
+  TbRenderTargetId upscaled_color;
   TbRenderTargetId depth_buffer_copy;
   TbRenderTargetId color_copy;
   TbRenderTargetId env_cube;
@@ -49,11 +53,28 @@ typedef struct TbRenderTargetSystem {
   TbRenderTargetId brightness;
   TbRenderTargetId bloom_mip_chain;
   TbRenderTargetId ldr_target;
+
+  // Memory blocks that transient targets are aliased into, one set per frame
+  TB_DYN_ARR_OF(VmaAllocation) transient_blocks;
+  // Per frame state, what the transient targets would take up with dedicated
+  // allocations and what they take up after aliasing
+  uint64_t transient_bytes;
+  uint64_t aliased_bytes;
+  // Image views made for the targets this system allocates images for, so
+  // that leaks show up
+  uint32_t view_count;
 } TbRenderTargetSystem;
 extern ECS_COMPONENT_DECLARE(TbRenderTargetSystem);
 
 void tb_reimport_swapchain(TbRenderTargetSystem *self);
 
+// Re-creates a persistent target at a new size. Expects that the GPU is not
+// using the target; passes that render to it must be reimported afterwards.
+// Outside of final builds this checks that the resize left the number of
+// live allocations and views unchanged
+void tb_resize_render_target(TbRenderTargetSystem *self, TbRenderTargetId rt,
+                             VkExtent3D extent);
+
 TbRenderTargetId
 tb_import_render_target(TbRenderTargetSystem *self,
                         const TbRenderTargetDescriptor *rt_desc,
@@ -82,3 +103,23 @@ VkImageView tb_render_target_get_mip_view(TbRenderTargetSystem *self,
                                           TbRenderTargetId rt);
 VkImage tb_render_target_get_image(TbRenderTargetSystem *self,
                                    uint32_t frame_idx, TbRenderTargetId rt);
+uint32_t tb_render_target_get_layer_count(TbRenderTargetSystem *self,
+                                          TbRenderTargetId rt);
+bool tb_render_target_is_imported(TbRenderTargetSystem *self,
+                                  TbRenderTargetId rt);
+bool tb_render_target_is_transient(TbRenderTargetSystem *self,
+                                   TbRenderTargetId rt);
+
+// Records the range of passes, in execution order, that use a transient
+// target. A first_use greater than last_use means the target is never used
+void tb_render_target_set_lifetime(TbRenderTargetSystem *self,
+                                   TbRenderTargetId rt, uint32_t first_use,
+                                   uint32_t last_use);
+// Re-creates every transient target so that targets whose lifetimes don't
+// overlap share memory. Must be called again after targets are resized.
+// Expects that the GPU is not using any transient target
+void tb_alias_transient_targets(TbRenderTargetSystem *self);
+// The transient target that used this target's memory most recently before
+// it in the frame. The first use of rt has to wait on that target's last use
+TbRenderTargetId tb_render_target_get_alias_prev(TbRenderTargetSystem *self,
+                                                 TbRenderTargetId rt);
@@ -2,6 +2,7 @@
 
 #include "tb_allocator.h"
 #include "tb_render_common.h"
+#include "tb_upload_timeline.h"
 
 #if !defined(TB_FINAL) && !defined(__ANDROID__)
 #define TB_VK_VALIDATION
@@ -18,6 +19,9 @@ typedef struct VmaAllocation_T *VmaAllocation;
 typedef struct VmaAllocator_T *VmaAllocator;
 typedef struct VmaPool_T *VmaPool;
 
+typedef struct enkiTaskScheduler enkiTaskScheduler;
+typedef struct enkiTaskSet enkiTaskSet;
+
 typedef uint32_t TbRenderPassId;
 
 typedef struct TbRenderThreadDescriptor {
@@ -45,6 +49,9 @@ typedef struct TbPassContext {
 
   VkRenderingInfo *render_info;
 
+  // CPU time the render thread spent recording this pass last frame
+  float record_ms;
+
 #ifdef TRACY_ENABLE
   char label[TB_RP_LABEL_LEN];
 #endif
@@ -75,6 +82,8 @@ typedef struct TbDispatchContext {
 } TbDispatchContext;
 
 #define TB_MAX_COMMAND_BUFFERS 64
+// Two for the whole frame and a begin and end pair for every pass
+#define TB_MAX_TIMESTAMPS (2 + TB_MAX_COMMAND_BUFFERS * 2)
 
 typedef struct TbFrameState {
   SDL_Semaphore *wait_sem;
@@ -83,6 +92,9 @@ typedef struct TbFrameState {
   VkCommandPool command_pool;
   VkCommandBuffer base_command_buffers[2];
   uint32_t pass_command_buffer_count;
+  // Every pass command buffer has a pool of its own so that passes can be
+  // recorded on different threads at the same time
+  VkCommandPool pass_command_pools[TB_MAX_COMMAND_BUFFERS];
   VkCommandBuffer pass_command_buffers[TB_MAX_COMMAND_BUFFERS];
   void *tracy_gpu_context;
 
@@ -95,6 +107,16 @@ typedef struct TbFrameState {
   VkSemaphore frame_complete_sem;
   VkFence fence;
 
+  // Timestamps that bracket all of the frame's graphics queue work and each
+  // pass. Null when the graphics queue can't write timestamps
+  VkQueryPool timestamp_pool;
+  bool timestamps_written;
+  // GPU time of the last frame this state completed and of each of its passes
+  // indexed like pass_contexts. Read back by tb_wait_render once the state's
+  // fence has signaled
+  float gpu_ms;
+  float pass_gpu_ms[TB_MAX_COMMAND_BUFFERS];
+
   VmaAllocation tmp_gpu_alloc;
   VkBuffer tmp_gpu_buffer;
   VkDeviceAddress tmp_gpu_buf_addr;
@@ -104,6 +126,17 @@ typedef struct TbFrameState {
   TbSetWriteQueue *set_write_queue;
   TbBufferCopyQueue *buf_copy_queue;
   TbBufferImageCopyQueue *buf_img_copy_queue;
+  // Uploads that may finish in a later frame. They complete when the upload
+  // timeline reaches upload_value
+  TbBufferCopyQueue *async_buf_copy_queue;
+  TbBufferImageCopyQueue *async_buf_img_copy_queue;
+  uint64_t upload_value;
+
+  // Only created when the device has a dedicated transfer queue
+  VkCommandPool transfer_command_pool;
+  VkCommandBuffer transfer_command_buffer;
+  // Timeline value the transfer command buffer was last submitted with
+  uint64_t transfer_value;
 
   TbArenaAllocator tmp_alloc;
   TbAllocator gp_alloc;
@@ -156,12 +189,15 @@ typedef struct TbRenderThread {
   VkSurfaceKHR surface;
   uint32_t graphics_queue_family_index;
   uint32_t present_queue_family_index;
+  // 0xFFFFFFFF when the device has no queue family dedicated to transfers
+  uint32_t transfer_queue_family_index;
 
   TbRenderExtensionSupport ext_support;
 
   VkDevice device;
   VkQueue present_queue;
   VkQueue graphics_queue;
+  VkQueue transfer_queue; // VK_NULL_HANDLE when uploads use graphics_queue
 
   VmaAllocator vma_alloc;
 
@@ -171,10 +207,21 @@ typedef struct TbRenderThread {
 
   uint32_t frame_idx;
   uint64_t frame_count;
+
+  // Signaled with each frame state's upload_value once its async uploads are
+  // done
+  VkSemaphore upload_timeline;
+  TbUploadTimeline uploads;
   TbFrameState frame_states[TB_MAX_FRAME_STATES];
 
   uint8_t stop_signal;
   uint8_t swapchain_resize_signal;
+
+  // Set by the main thread before the first frame. Passes are recorded on its
+  // workers once the render thread has registered with it. Until then they
+  // are recorded on the render thread alone
+  enkiTaskScheduler *enki;
+  enkiTaskSet *record_task;
 } TbRenderThread;
 
 bool tb_start_render_thread(TbRenderThreadDescriptor *desc,
@@ -184,6 +231,11 @@ void tb_signal_render(TbRenderThread *thread, uint32_t frame_idx);
 
 void tb_wait_render(TbRenderThread *thread, uint32_t frame_idx);
 
+// Blocks until the render thread and the GPU are done with every frame state
+// so resources shared by all frames can be replaced. Must be called from the
+// main thread after it has already waited on frame_idx
+void tb_wait_render_idle(TbRenderThread *thread, uint32_t frame_idx);
+
 void tb_wait_thread_initialized(TbRenderThread *thread);
 
 void tb_stop_render_thread(TbRenderThread *thread);
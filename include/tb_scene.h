@@ -7,4 +7,34 @@ extern ECS_TAG_DECLARE(TbSceneRoot);
 
 TbScene tb_create_scene(ecs_world_t *ecs, const char *scene_path);
 
+// Describes how a streamed scene is split up and when its cells load.
+// Subtrees are sorted into square cells on the XZ plane by their bounds and
+// subtrees bigger than a cell are split up, see tb_split_scene_cells.
+// A cell starts loading when the camera gets within load_radius of it and is
+// unloaded once the camera is further than unload_radius away. Subtrees with
+// a camera or a directional light are always loaded.
+typedef struct TbSceneStreamDesc {
+  float cell_size;
+  float load_radius;
+  float unload_radius; // Clamped to at least load_radius
+  uint32_t max_loads_per_frame;
+  uint32_t max_unloads_per_frame;
+  uint32_t max_loading_cells; // Cells whose entities are still loading
+} TbSceneStreamDesc;
+
+// Like tb_create_scene but only the cells around the camera are loaded.
+// The scene is ready once the cells that are always loaded are ready
+TbScene tb_create_streamed_scene(ecs_world_t *ecs, const char *scene_path,
+                                 const TbSceneStreamDesc *desc);
+
+// Loads and unloads the cells of every streamed scene around the camera.
+// Cells are created like scenes so this runs between frames, when the world
+// isn't deferred
+void tb_stream_scenes(ecs_world_t *ecs);
+
 bool tb_is_scene_ready(ecs_world_t *ecs, TbScene scene);
+
+// Destroys every entity the scene created. Meshes, materials and textures
+// that no other scene references are destroyed along with them.
+// A scene that is still loading is unloaded as soon as it is ready
+void tb_destroy_scene(ecs_world_t *ecs, TbScene scene);
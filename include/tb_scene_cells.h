@@ -0,0 +1,71 @@
+#pragma once
+
+#include "tb_allocator.h"
+#include "tb_dynarray.h"
+#include "tb_scene.h"
+#include "tb_simd.h"
+
+// How a streamed scene is split into cells and which cells get loaded and
+// unloaded each frame. None of this touches the world so that streaming can
+// be driven without one
+
+typedef struct cgltf_data cgltf_data;
+
+typedef struct TbSceneCellNode {
+  const cgltf_node *node;
+  // Whether the node's children belong to the cell as well. Nodes that were
+  // split up are loaded on their own and their children land in other cells
+  bool subtree;
+  // The node's ancestors live in another cell. It is loaded without a parent
+  // and with their transforms baked into its own
+  bool detached;
+} TbSceneCellNode;
+typedef TB_DYN_ARR_OF(TbSceneCellNode) TbSceneCellNodes;
+
+typedef enum TbSceneCellState {
+  TB_SCENE_CELL_UNLOADED,
+  TB_SCENE_CELL_PARSING, // Tasks still read the cell so it can't unload
+  TB_SCENE_CELL_LOADING, // Every entity exists but not all are ready
+  TB_SCENE_CELL_READY,
+} TbSceneCellState;
+
+// A square of the XZ plane and the nodes that sit in it.
+// Each loaded cell is a scene of its own
+typedef struct TbSceneCell {
+  int32_t x;
+  int32_t z;
+  bool resident; // Never unloaded; holds cameras and directional lights
+  TbSceneCellState state;
+  TbScene scene; // 0 while unloaded
+  TbSceneCellNodes nodes;
+} TbSceneCell;
+typedef TB_DYN_ARR_OF(TbSceneCell) TbSceneCells;
+
+// What to do with the cells this frame, as indices into the cells
+typedef struct TbSceneCellPlan {
+  TB_DYN_ARR_OF(uint32_t) loads;
+  TB_DYN_ARR_OF(uint32_t) unloads;
+} TbSceneCellPlan;
+
+// Sorts the nodes of the first scene in the glTF into cells.
+// A subtree goes to the cell its bounds are centered in. Subtrees that are
+// bigger than a cell or that hold a camera or a directional light are split
+// up: their root goes to the resident cell on its own and its children are
+// sorted the same way. Subtrees with a camera or a directional light at their
+// root are always resident. Cells are allocated from alloc and scratch memory
+// from tmp_alloc which is expected to be a temporary / arena allocator
+void tb_split_scene_cells(TbAllocator alloc, TbAllocator tmp_alloc,
+                          const cgltf_data *data, float cell_size,
+                          TbSceneCells *cells);
+void tb_destroy_scene_cells(TbSceneCells *cells);
+
+// Distance on the XZ plane from a position to the closest point of a cell
+float tb_scene_cell_distance(const TbSceneCell *cell, float cell_size,
+                             float3 pos);
+
+// Picks the cells to load and unload around origin while keeping to the
+// desc's budgets. Resident cells that aren't loaded are always picked.
+// The plan is cleared first and must have been reset by the caller
+void tb_plan_scene_cells(const TbSceneStreamDesc *desc,
+                         const TbSceneCells *cells, float3 origin,
+                         TbSceneCellPlan *plan);
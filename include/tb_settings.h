@@ -4,6 +4,7 @@
 #include <flecs.h>
 
 #include "tb_fxaa.slangh"
+#include "tb_shadow_cascades.h"
 
 #define TB_SETTINGS_SYS_PRIO (TB_COREUI_SYS_PRIO + 1)
 
@@ -51,7 +52,14 @@ typedef struct TbSettings {
   int32_t display_index;
   TbDisplayMode display_mode;
   TbVsyncMode vsync_mode;
-  float resolution_scale;
+  float resolution_scale; // Fixed scale, or the ceiling with dynamic res
+  bool dynamic_resolution;
+  float gpu_budget_ms; // GPU frame time dynamic resolution aims to stay under
+  float lod_bias; // Each step doubles the mesh LOD error allowed on screen
+  float tex_budget_mb; // Gpu memory that streamed texture mips may use
+  int32_t shadow_map_dim;     // Width and height of each shadow cascade
+  int32_t cascade_count;      // Between 1 and TB_CASCADE_COUNT
+  float cascade_split_lambda; // See TB_CASCADE_SPLIT_LAMBDA
   int32_t fxaa_option;
   TbFXAAPushConstants fxaa;
   bool *coreui;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "tb_common.slangh"
+
+#include <stdint.h>
+
+// How shadow cascades are sized and split. None of this touches the world or
+// the device so that it can be driven without either
+
+// Default shadow map resolution. The real one comes from TbSettings
+#define TB_SHADOW_MAP_DIM 4096
+#define TB_SHADOW_MAP_MIN_DIM 512
+
+// Blend between logarithmic (1) and uniform (0) shadow cascade splits
+#define TB_CASCADE_SPLIT_LAMBDA 0.95f
+
+typedef struct TbCascadeSettings {
+  uint32_t map_dim;
+  uint32_t cascade_count;
+  float split_lambda;
+} TbCascadeSettings;
+
+// Brings shadow settings, which may come from the user or a saved file, into
+// the range the shadow system supports. A lambda that isn't a number falls
+// back to TB_CASCADE_SPLIT_LAMBDA
+TbCascadeSettings tb_clamp_cascade_settings(int32_t map_dim,
+                                            int32_t cascade_count,
+                                            float split_lambda);
+
+// Writes how far through the camera's depth range each of the first
+// cascade_count cascades reaches, from 0 at near to 1 at far. Based on
+// https://developer.nvidia.com/gpugems/GPUGems3/gpugems3_ch10.html
+void tb_calc_cascade_splits(float near, float far, uint32_t cascade_count,
+                            float split_lambda, float *splits);
@@ -279,8 +279,13 @@ float4x4 tb_orthographic(float r, float l, float t, float b, float zn,
                          float zf);
 
 TbFrustum tb_frustum_from_view_proj(const float4x4 *vp);
+// Makes a plane pass everything. Useful for views that clamp depth rather than
+// clip against their near plane
+void tb_frustum_disable_plane(TbFrustum *frust, TbFrustumPlane plane);
 
 bool tb_frustum_test_aabb(const TbFrustum *frust, const TbAABB *aabb);
+bool tb_frustum_test_sphere(const TbFrustum *frust, float3 center,
+                            float radius);
 
 float tb_deg_to_rad(float d);
 float tb_rad_to_deg(float r);
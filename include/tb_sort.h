@@ -0,0 +1,28 @@
+#pragma once
+
+#include "tb_allocator.h"
+#include "tb_task_scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Below this many keys a sort is always performed on the calling thread
+#define TB_RADIX_SORT_PARALLEL_MIN 8192
+
+// Stable LSD radix sort of 64-bit keys in ascending order.
+// Each key carries a 32-bit value along with it (typically an index into some
+// other array) so callers can sort arbitrary records by key.
+// Scratch memory is taken from the given allocator which is expected to be a
+// temporary / arena allocator.
+// If a task scheduler is provided and there are enough keys, histogram and
+// scatter work is split across enkiTS workers. The calling thread participates
+// while it waits.
+// Digit passes where every key shares the same digit are skipped entirely so
+// sparse keys are cheap to sort.
+void tb_radix_sort_u64(TbTaskScheduler enki, TbAllocator tmp_alloc,
+                       uint32_t count, uint64_t *keys, uint32_t *values);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,6 +8,8 @@ extern "C" {
 
 #include <TaskScheduler_c.h>
 
+#include "tb_dynarray.h"
+
 typedef void (*TbAsyncFn)(const void *args);
 typedef enkiTaskExecuteRange TbAsyncFn2;
 
@@ -19,8 +21,37 @@ extern ECS_COMPONENT_DECLARE(TbTask);
 extern ECS_COMPONENT_DECLARE(TbPinnedTask);
 extern ECS_COMPONENT_DECLARE(TbTaskScheduler);
 
+// Asset systems dispatch pending loads with a higher priority first.
+// Entities without one load at priority 0
+typedef float TbLoadPriority;
+extern ECS_COMPONENT_DECLARE(TbLoadPriority);
+
+typedef struct TbLoadQueueEntry {
+  ecs_entity_t ent;
+  TbLoadPriority priority;
+  bool cancelled; // Nothing wants the load anymore so it is never dispatched
+} TbLoadQueueEntry;
+typedef TB_DYN_ARR_OF(TbLoadQueueEntry) TbLoadQueue;
+
+// Which entries of a load queue to act on this frame, as indices into it
+typedef struct TbLoadDispatch {
+  uint32_t count; // Entries to dispatch from the highest priority down
+  uint32_t *order;
+  uint32_t dropped_count; // Cancelled entries the caller must clean up
+  uint32_t *dropped;
+} TbLoadDispatch;
+
 #define TbMainThreadId 0
 
+// Matches enki's priorities where lower values run first. Tasks start out
+// high priority; tb_async_task lowers them so that a thread waiting on frame
+// work never ends up running an asset load
+typedef enum TbTaskPriority {
+  TB_TASK_PRIORITY_HIGH = 0,
+  TB_TASK_PRIORITY_MED = 1,
+  TB_TASK_PRIORITY_LOW = 2,
+} TbTaskPriority;
+
 typedef struct TbAsyncTaskArgs TbAsyncTaskArgs;
 
 // Create a task that runs a given function on any available thread.
@@ -43,7 +74,7 @@ void tb_launch_task_args(TbTaskScheduler enki, TbTask task, void *args,
 // Begin execution of an already created task and also pass along arguments
 void tb_launch_task2(TbTaskScheduler enki, TbTask task, void *args);
 
-// Run a given function on any available thread.
+// Run a given function on any available thread at low priority.
 // Args will be copied to a thread-safe heap
 TbTask tb_async_task(TbTaskScheduler enki, TbAsyncFn fn, void *args,
                      size_t args_size);
@@ -58,12 +89,42 @@ void tb_launch_pinned_task(TbTaskScheduler enki, TbPinnedTask task);
 void tb_launch_pinned_task_args(TbTaskScheduler enki, TbPinnedTask task,
                                 void *args, size_t size);
 
+void tb_set_task_priority(TbTask task, TbTaskPriority priority);
+
 void tb_wait_task(TbTaskScheduler enki, TbTask task);
 
+// Like tb_wait_task but the waiting thread only helps out with tasks of the
+// given priority or higher
+void tb_wait_task_priority(TbTaskScheduler enki, TbTask task,
+                           TbTaskPriority priority);
+
 // Since pinned tasks are pumped manually by threads you will deadlock
 // if you try to wait on a task pinned to the thread that must wait.
 void tb_wait_pinned_task(TbTaskScheduler enki, TbPinnedTask task);
 
+TbLoadPriority tb_get_load_priority(ecs_world_t *ecs, ecs_entity_t ent);
+
+// Raises an entity's load priority to at least the given priority.
+// Something needed by several loads should load as soon as the most
+// important of them
+void tb_raise_load_priority(ecs_world_t *ecs, ecs_entity_t ent,
+                            TbLoadPriority priority);
+
+// Returns the indices of the queue's entries from the highest priority to the
+// lowest. Entries with equal priorities keep their order.
+// Everything is allocated from the given temporary allocator
+uint32_t *tb_sort_load_queue(TbTaskScheduler enki, TbAllocator tmp_alloc,
+                             const TbLoadQueue *queue);
+
+// Picks the slot_count most important loads of the queue to dispatch.
+// Cancelled entries are dropped however few slots are free so that a
+// saturated queue doesn't hold on to loads nothing wants.
+// Everything is allocated from the given temporary allocator
+TbLoadDispatch tb_plan_load_dispatch(TbTaskScheduler enki,
+                                     TbAllocator tmp_alloc,
+                                     const TbLoadQueue *queue,
+                                     uint32_t slot_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+// Picks how many levels of each streamed texture stay resident under a
+// memory budget. None of this touches the world or the device so that it can
+// be driven without either
+
+#define TB_TEX_BUDGET_MAX_LEVELS 16
+
+typedef struct TbTexBudgetRequest {
+  uint32_t requested_mip; // Most detailed level its usage asks for
+  uint32_t min_mip;       // This level and every coarser one stay resident
+  // Bytes resident when each level up to min_mip is the most detailed
+  uint64_t mips_size[TB_TEX_BUDGET_MAX_LEVELS];
+} TbTexBudgetRequest;
+
+typedef struct TbTexBudgetSolution {
+  uint32_t bias;            // Levels every request was dropped by
+  uint64_t requested_bytes; // Bytes the requests take with no bias
+  uint64_t solved_bytes;    // Bytes they take at the solved levels
+} TbTexBudgetSolution;
+
+// Drops every request by the same number of levels, never past its min_mip,
+// until they all fit in the budget so that no texture is starved to keep
+// another at full detail. Writes the level each request gets to levels.
+// When even the min mips don't fit that's what every request gets
+TbTexBudgetSolution tb_solve_tex_budget(uint32_t count,
+                                        const TbTexBudgetRequest *requests,
+                                        uint64_t budget, uint32_t *levels);
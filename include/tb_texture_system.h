@@ -6,6 +6,9 @@
 
 #define TB_TEX_SYS_PRIO (TB_RND_SYS_PRIO + 1)
 
+// Gpu memory streamed textures may use unless the settings ask for otherwise
+#define TB_TEX_STREAM_DEFAULT_BUDGET_MB 1024.0f
+
 typedef struct VkDescriptorSetLayout_T *VkDescriptorSetLayout;
 typedef struct VkDescriptorSet_T *VkDescriptorSet;
 
@@ -44,7 +47,8 @@ TbTexture tb_tex_sys_load_raw_tex(ecs_world_t *ecs, const char *name,
                                   TbTextureUsage usage);
 // Begins an async texture load from a loaded glb file, the material,
 // and the texture usage so the task can parse the gltf data and find the
-// expected image
+// expected image. Every call takes a reference that must be given back with
+// tb_tex_sys_release_tex_ref
 TbTexture tb_tex_sys_load_mat_tex(ecs_world_t *ecs, const cgltf_data *data,
                                   const char *mat_name, TbTextureUsage usage);
 // Begins an async texture load from a path to a given ktx file and the texture
@@ -52,6 +56,32 @@ TbTexture tb_tex_sys_load_mat_tex(ecs_world_t *ecs, const cgltf_data *data,
 TbTexture tb_tex_sys_load_ktx_tex(ecs_world_t *ecs, const char *path,
                                   const char *name, TbTextureUsage usage);
 
+// Gives back a reference taken by tb_tex_sys_load_mat_tex. The texture is
+// destroyed once the last reference is gone. Textures owned by the texture
+// system, like the defaults, are never destroyed and are safe to pass here
+void tb_tex_sys_release_tex_ref(ecs_world_t *ecs, TbTexture tex);
+
+// Lets a streamed texture know the largest size in pixels it was drawn at this
+// frame. Its mips are streamed in or out to match. Textures that aren't
+// streamed ignore this
+void tb_tex_sys_report_screen_size(ecs_world_t *ecs, TbTexture tex,
+                                   float screen_size);
+
+typedef struct TbTextureStreamStats {
+  uint32_t texture_count; // Textures that are streamed
+  uint32_t pending_count; // Textures not yet at their requested mip
+  uint32_t mip_bias;      // Levels dropped from every request to fit budget
+  uint64_t resident_bytes;
+  uint64_t requested_bytes; // Bytes needed if no mip bias was applied
+  uint64_t budget_bytes;
+} TbTextureStreamStats;
+TbTextureStreamStats tb_tex_sys_get_stream_stats(ecs_world_t *ecs);
+
+// Most detailed mip of a texture on the gpu and the one its usage asks for.
+// Both are 0 for textures that aren't streamed
+uint32_t tb_tex_sys_get_resident_mip(ecs_world_t *ecs, TbTexture tex);
+uint32_t tb_tex_sys_get_requested_mip(ecs_world_t *ecs, TbTexture tex);
+
 // Returns true if the texture is ready to be used
 bool tb_is_texture_ready(ecs_world_t *ecs, TbTexture tex_ent);
 
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "tb_ktx.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Basis textures are transcoded once and then cached on disk by a hash of
+// their source data and the target format. None of this touches the world or
+// the device so that it can be driven without either
+
+// Everything a cached transcode must match to stand in for its source
+typedef struct TbTranscodeKey {
+  uint64_t content_hash;
+  uint32_t format; // ktx_transcode_fmt_e the source was transcoded to
+  uint32_t width;
+  uint32_t height;
+  uint32_t levels;
+  uint32_t layers;
+} TbTranscodeKey;
+
+// Where the transcode of the key's texture lives in the cache directory.
+// Only the content hash and format name the file; the rest of the key is
+// checked once the file is open. Returns false if the path doesn't fit
+bool tb_transcode_cache_path(const char *dir, const TbTranscodeKey *key,
+                             char *path, size_t path_size);
+
+// Whether a cached transcode can stand in for the source the key describes.
+// Files left behind by a different source whose hash collided, or by another
+// target format, are rejected
+bool tb_transcode_key_matches(const TbTranscodeKey *key,
+                              const TbTranscodeKey *cached);
+
+// Parses ktx2 data into a texture that doesn't need transcoding. Basis
+// textures are read from the cache in dir when they can be and are
+// transcoded to target and added to the cache otherwise. Untranscoded image
+// data is read from the source memory so it must outlive the returned texture
+ktxTexture2 *tb_open_ktx(const char *dir, ktx_transcode_fmt_e target,
+                         const uint8_t *data, size_t size,
+                         uint64_t content_hash);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "tb_allocator.h"
+#include "tb_dynarray.h"
+#include "tb_vk.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The bookkeeping behind async uploads. Each frame state's async uploads
+// signal one value on the upload timeline semaphore, either from a dedicated
+// transfer queue or from the graphics queue when there isn't one. None of
+// this touches the device so that both paths can be driven without one
+
+// The graphics queue's half of a queue family ownership transfer for a
+// resource uploaded on the transfer queue. Recorded once the release has
+// signaled its timeline value
+typedef struct TbQueueAcquire {
+  uint64_t value;
+  bool is_image;
+  VkBufferMemoryBarrier buffer;
+  VkImageMemoryBarrier image;
+} TbQueueAcquire;
+
+typedef struct TbUploadTimeline {
+  // Uploads run on a dedicated transfer queue which releases every
+  // destination to the graphics queue. Otherwise they run on the graphics
+  // queue and that submission signals the timeline
+  bool transfer_queue;
+  uint64_t submitted; // Last value handed to a submission
+  TB_DYN_ARR_OF(TbQueueAcquire) pending; // Waiting on their release
+  TB_DYN_ARR_OF(TbQueueAcquire) ready;   // From the last take
+} TbUploadTimeline;
+
+void tb_create_upload_timeline(TbAllocator alloc, bool transfer_queue,
+                               TbUploadTimeline *timeline);
+void tb_destroy_upload_timeline(TbUploadTimeline *timeline);
+
+// The value a frame state's uploads signal. Values must only ever increase
+// so a frame state that was handed a stale value signals the next one instead
+uint64_t tb_next_upload_value(TbUploadTimeline *timeline, uint64_t frame_value);
+
+// Queues the acquire matching a release recorded on the transfer queue
+void tb_queue_upload_acquire(TbUploadTimeline *timeline,
+                             const TbQueueAcquire *acquire);
+
+// Moves every pending acquire whose release has signaled into ready, in the
+// order they were queued. Returns the value the submission recording them
+// must wait on or 0 if none were ready
+uint64_t tb_take_upload_acquires(TbUploadTimeline *timeline,
+                                 uint64_t signaled);
+
+// An upload value of 0 is always complete
+bool tb_is_upload_value_complete(uint64_t signaled, uint64_t value);
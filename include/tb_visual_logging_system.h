@@ -37,9 +37,7 @@ typedef struct TbVisualLoggingSystem {
   bool *ui;
 
   TbMesh2 sphere_mesh2;
-  uint32_t sphere_index_type;
   uint32_t sphere_index_count;
-  uint32_t sphere_pos_offset;
   float3 sphere_scale;
 
   VkPipelineLayout pipe_layout;
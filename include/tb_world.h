@@ -87,6 +87,8 @@ bool tb_tick_world(TbWorld *world, float delta_seconds);
 void tb_destroy_world(TbWorld *world);
 
 TbScene tb_load_scene(TbWorld *world, const char *scene_path);
+TbScene tb_load_streamed_scene(TbWorld *world, const char *scene_path,
+                               const TbSceneStreamDesc *desc);
 void tb_unload_scene(TbWorld *world, TbScene *scene);
 
 // HACK: Get component load function by name for scene2
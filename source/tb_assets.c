@@ -1,8 +1,27 @@
 #include "tb_assets.h"
 
-#include "cgltf.h"
 #include "tb_common.h"
+#include "tb_dynarray.h"
+#include "tb_gltf.h"
+#include "tb_hash.h"
 #include "tb_mmap.h"
+#include "tb_profiling.h"
+
+#include <mimalloc.h>
+
+// Every glb read by tb_read_glb that hasn't been released yet
+typedef struct TbGlbRef {
+  const cgltf_data *data;
+  uint32_t ref_count;
+  char path[256];
+  // Indexed the same way as the glb's meshes, materials and images
+  TbAssetHash *mesh_hashes;
+  TbAssetHash *material_hashes;
+  TbAssetHash *image_hashes;
+} TbGlbRef;
+
+static SDL_SpinLock tb_glb_lock = 0;
+static TB_DYN_ARR_OF(TbGlbRef) tb_glb_refs = {0};
 
 static cgltf_result
 sdl_read_glb(const struct cgltf_memory_options *memory_options,
@@ -28,7 +47,7 @@ static void sdl_release_glb(const struct cgltf_memory_options *memory_options,
   tb_auto file_size = (cgltf_size)SDL_GetIOSize(file);
   tb_io_munmap(data, file_size);
 
-  bool ok = SDL_CloseIO(file) == 0;
+  bool ok = SDL_CloseIO(file);
   TB_CHECK(ok, "Failed to close glb file.");
 }
 
@@ -43,6 +62,212 @@ char *tb_resolve_asset_path(TbAllocator tmp_alloc, const char *source_name) {
   return asset_path;
 }
 
+// Hashes the bytes a view reads out of the glb. Compressed views are hashed
+// as they are stored which is cheaper than decoding and just as unique
+static uint64_t tb_hash_buffer_view(const cgltf_buffer_view *view) {
+  const uint8_t *bytes = (const uint8_t *)view->buffer->data;
+  uint64_t offset = view->offset;
+  uint64_t size = view->size;
+  uint64_t hash = size;
+  if (view->has_meshopt_compression) {
+    tb_auto mc = &view->meshopt_compression;
+    bytes = (const uint8_t *)mc->buffer->data;
+    offset = mc->offset;
+    size = mc->size;
+    const uint64_t params[] = {mc->mode, mc->filter, mc->count, mc->stride};
+    hash = tb_hash(hash, (const uint8_t *)params, sizeof(params));
+  }
+  if (bytes) {
+    hash = tb_hash(hash, bytes + offset, size);
+  }
+  return hash;
+}
+
+static uint64_t tb_hash_accessor(uint64_t hash, const cgltf_data *data,
+                                 const uint64_t *view_hashes,
+                                 const cgltf_accessor *accessor) {
+  uint64_t view_hash = 0;
+  if (accessor->buffer_view) {
+    view_hash = view_hashes[accessor->buffer_view - data->buffer_views];
+  }
+  const uint64_t params[] = {
+      view_hash,        accessor->component_type, accessor->type,
+      accessor->offset, accessor->stride,         accessor->count,
+      accessor->normalized,
+  };
+  return tb_hash(hash, (const uint8_t *)params, sizeof(params));
+}
+
+static uint64_t tb_hash_texture_view(uint64_t hash, const cgltf_data *data,
+                                     const TbAssetHash *image_hashes,
+                                     const cgltf_texture_view *view) {
+  uint64_t image_hash = 0;
+  tb_auto texture = view->texture;
+  if (texture) {
+    tb_auto image =
+        texture->has_basisu ? texture->basisu_image : texture->image;
+    if (image) {
+      image_hash = image_hashes[image - data->images].hash;
+    }
+  }
+  const uint64_t params[] = {image_hash, (uint64_t)view->texcoord,
+                             view->has_transform,
+                             (uint64_t)view->transform.texcoord};
+  const float factors[] = {
+      view->scale,
+      view->transform.offset[0],
+      view->transform.offset[1],
+      view->transform.rotation,
+      view->transform.scale[0],
+      view->transform.scale[1],
+  };
+  hash = tb_hash(hash, (const uint8_t *)params, sizeof(params));
+  return tb_hash(hash, (const uint8_t *)factors, sizeof(factors));
+}
+
+static uint64_t tb_texture_view_size(const cgltf_data *data,
+                                     const TbAssetHash *image_hashes,
+                                     const cgltf_texture_view *view) {
+  tb_auto texture = view->texture;
+  if (texture == NULL) {
+    return 0;
+  }
+  tb_auto image = texture->has_basisu ? texture->basisu_image : texture->image;
+  return image ? image_hashes[image - data->images].size : 0;
+}
+
+static TbAssetHash tb_hash_material(const cgltf_data *data,
+                                    const TbAssetHash *image_hashes,
+                                    const cgltf_material *mat) {
+  tb_auto mr = &mat->pbr_metallic_roughness;
+  tb_auto sg = &mat->pbr_specular_glossiness;
+  const uint64_t flags[] = {
+      mat->has_pbr_metallic_roughness,
+      mat->has_pbr_specular_glossiness,
+      mat->has_clearcoat,
+      mat->has_transmission,
+      mat->has_volume,
+      mat->has_ior,
+      mat->has_specular,
+      mat->has_sheen,
+      mat->has_emissive_strength,
+      mat->unlit,
+      mat->double_sided,
+      mat->alpha_mode,
+  };
+  const float factors[] = {
+      mr->base_color_factor[0],
+      mr->base_color_factor[1],
+      mr->base_color_factor[2],
+      mr->base_color_factor[3],
+      mr->metallic_factor,
+      mr->roughness_factor,
+      sg->diffuse_factor[0],
+      sg->diffuse_factor[1],
+      sg->diffuse_factor[2],
+      sg->diffuse_factor[3],
+      sg->specular_factor[0],
+      sg->specular_factor[1],
+      sg->specular_factor[2],
+      sg->glossiness_factor,
+      mat->emissive_factor[0],
+      mat->emissive_factor[1],
+      mat->emissive_factor[2],
+      mat->emissive_strength.emissive_strength,
+      mat->alpha_cutoff,
+  };
+  const cgltf_texture_view *views[] = {
+      &mr->base_color_texture, &mr->metallic_roughness_texture,
+      &sg->diffuse_texture,    &sg->specular_glossiness_texture,
+      &mat->normal_texture,    &mat->occlusion_texture,
+      &mat->emissive_texture,
+  };
+
+  const uint32_t view_count = sizeof(views) / sizeof(views[0]);
+
+  TbAssetHash hash = {0};
+  hash.hash = tb_hash(hash.hash, (const uint8_t *)flags, sizeof(flags));
+  hash.hash = tb_hash(hash.hash, (const uint8_t *)factors, sizeof(factors));
+  for (uint32_t i = 0; i < view_count; ++i) {
+    hash.hash = tb_hash_texture_view(hash.hash, data, image_hashes, views[i]);
+    hash.size += tb_texture_view_size(data, image_hashes, views[i]);
+  }
+  return hash;
+}
+
+static TbAssetHash tb_hash_mesh(const cgltf_data *data,
+                                const uint64_t *view_hashes,
+                                const TbAssetHash *material_hashes,
+                                const cgltf_mesh *mesh) {
+  TbAssetHash hash = {0};
+  for (cgltf_size i = 0; i < mesh->primitives_count; ++i) {
+    tb_auto prim = &mesh->primitives[i];
+    // Identical geometry drawn with different materials is a different mesh
+    uint64_t mat_hash = 0;
+    if (prim->material) {
+      mat_hash = material_hashes[prim->material - data->materials].hash;
+    }
+    const uint64_t params[] = {prim->type, mat_hash, prim->attributes_count};
+    hash.hash = tb_hash(hash.hash, (const uint8_t *)params, sizeof(params));
+
+    if (prim->indices) {
+      hash.hash = tb_hash_accessor(hash.hash, data, view_hashes, prim->indices);
+      hash.size += prim->indices->count * prim->indices->stride;
+    }
+    for (cgltf_size attr_idx = 0; attr_idx < prim->attributes_count;
+         ++attr_idx) {
+      tb_auto attr = &prim->attributes[attr_idx];
+      const uint64_t attr_params[] = {attr->type, (uint64_t)attr->index};
+      hash.hash = tb_hash(hash.hash, (const uint8_t *)attr_params,
+                          sizeof(attr_params));
+      hash.hash = tb_hash_accessor(hash.hash, data, view_hashes, attr->data);
+      hash.size += attr->data->count * attr->data->stride;
+    }
+  }
+  return hash;
+}
+
+// Hashes every mesh, material and image in the glb into the given ref
+static void tb_hash_glb(TbAllocator tmp_alloc, const cgltf_data *data,
+                        TbGlbRef *ref) {
+  TB_TRACY_SCOPE("Hash GLB");
+  tb_auto view_hashes =
+      tb_alloc_nm_tp(tmp_alloc, data->buffer_views_count + 1, uint64_t);
+  for (cgltf_size i = 0; i < data->buffer_views_count; ++i) {
+    view_hashes[i] = tb_hash_buffer_view(&data->buffer_views[i]);
+  }
+
+  ref->image_hashes =
+      tb_alloc_nm_tp(tb_global_alloc, data->images_count + 1, TbAssetHash);
+  for (cgltf_size i = 0; i < data->images_count; ++i) {
+    tb_auto view = data->images[i].buffer_view;
+    if (view) {
+      ref->image_hashes[i] = (TbAssetHash){
+          .hash = view_hashes[view - data->buffer_views],
+          .size = view->size,
+      };
+    } else {
+      ref->image_hashes[i] = (TbAssetHash){0};
+    }
+  }
+
+  ref->material_hashes =
+      tb_alloc_nm_tp(tb_global_alloc, data->materials_count + 1, TbAssetHash);
+  for (cgltf_size i = 0; i < data->materials_count; ++i) {
+    ref->material_hashes[i] =
+        tb_hash_material(data, ref->image_hashes, &data->materials[i]);
+  }
+
+  ref->mesh_hashes =
+      tb_alloc_nm_tp(tb_global_alloc, data->meshes_count + 1, TbAssetHash);
+  for (cgltf_size i = 0; i < data->meshes_count; ++i) {
+    ref->mesh_hashes[i] = tb_hash_mesh(data, view_hashes, ref->material_hashes,
+                                       &data->meshes[i]);
+  }
+
+  tb_free(tmp_alloc, view_hashes);
+}
+
 cgltf_data *tb_read_glb(TbAllocator gp_alloc, const char *path) {
   cgltf_data *data = NULL;
 
@@ -74,5 +299,129 @@ cgltf_data *tb_read_glb(TbAllocator gp_alloc, const char *path) {
   TB_CHECK_RETURN(res == cgltf_result_success, "Failed to validate glb.", NULL);
 #endif
 
+  TbGlbRef ref = {
+      .data = data,
+      .ref_count = 1,
+  };
+  SDL_strlcpy(ref.path, path, sizeof(ref.path));
+  tb_hash_glb(gp_alloc, data, &ref);
+  SDL_LockSpinlock(&tb_glb_lock);
+  if (tb_glb_refs.data == NULL) {
+    TB_DYN_ARR_RESET(tb_glb_refs, tb_global_alloc, 8);
+  }
+  TB_DYN_ARR_APPEND(tb_glb_refs, ref);
+  SDL_UnlockSpinlock(&tb_glb_lock);
+
   return data;
 }
+
+// Must be called with the lock held
+static TbGlbRef *tb_find_glb_ref(const cgltf_data *data) {
+  TB_DYN_ARR_FOREACH(tb_glb_refs, i) {
+    if (TB_DYN_ARR_AT(tb_glb_refs, i).data == data) {
+      return &TB_DYN_ARR_AT(tb_glb_refs, i);
+    }
+  }
+  return NULL;
+}
+
+void tb_acquire_glb(const cgltf_data *data) {
+  SDL_LockSpinlock(&tb_glb_lock);
+  tb_auto ref = tb_find_glb_ref(data);
+  TB_CHECK(ref, "Acquiring a glb that was never read or already released");
+  if (ref) {
+    ref->ref_count++;
+  }
+  SDL_UnlockSpinlock(&tb_glb_lock);
+}
+
+static void tb_free_glb(const char *path, cgltf_data *data) {
+  TB_TRACY_SCOPE("Free GLB");
+  uint64_t freed = data->json_size + data->bin_size;
+
+  // Aliased views point into the mapped file which cgltf_free will unmap.
+  // Decoded views are freed by cgltf_free with the glb's allocator which
+  // like every other toybox allocator is backed by mimalloc
+  for (cgltf_size i = 0; i < data->buffer_views_count; ++i) {
+    tb_auto view = &data->buffer_views[i];
+    if (tb_is_buffer_view_aliased(view)) {
+      view->data = NULL;
+    } else if (view->data != NULL) {
+      freed += tb_buffer_view_decoded_size(view);
+    }
+  }
+  cgltf_free(data);
+
+  size_t rss = 0;
+  mi_process_info(NULL, NULL, NULL, &rss, NULL, NULL, NULL, NULL);
+  TB_LOG_INFO(SDL_LOG_CATEGORY_APPLICATION,
+              "Released %s (%.2fMB). Resident memory is now %.2fMB", path,
+              (double)freed / (1024.0 * 1024.0),
+              (double)rss / (1024.0 * 1024.0));
+}
+
+void tb_release_glb(const cgltf_data *data) {
+  SDL_LockSpinlock(&tb_glb_lock);
+  tb_auto ref = tb_find_glb_ref(data);
+  TB_CHECK(ref, "Releasing a glb that was never read or already released");
+  TbGlbRef released = {0};
+  if (ref && --ref->ref_count == 0) {
+    released = *ref;
+    *ref = *TB_DYN_ARR_BACKPTR(tb_glb_refs);
+    TB_DYN_ARR_POP(tb_glb_refs);
+  }
+  SDL_UnlockSpinlock(&tb_glb_lock);
+
+  // Freeing may take a while so it happens outside the lock
+  if (released.data) {
+    tb_free(tb_global_alloc, released.mesh_hashes);
+    tb_free(tb_global_alloc, released.material_hashes);
+    tb_free(tb_global_alloc, released.image_hashes);
+    tb_free_glb(released.path, (cgltf_data *)released.data);
+  }
+}
+
+uint32_t tb_glb_count(void) {
+  SDL_LockSpinlock(&tb_glb_lock);
+  const uint32_t count = TB_DYN_ARR_SIZE(tb_glb_refs);
+  SDL_UnlockSpinlock(&tb_glb_lock);
+  return count;
+}
+
+TbAssetHash tb_glb_mesh_hash(const cgltf_data *data, const cgltf_mesh *mesh) {
+  TbAssetHash hash = {0};
+  SDL_LockSpinlock(&tb_glb_lock);
+  tb_auto ref = tb_find_glb_ref(data);
+  TB_CHECK(ref, "Hashing a mesh from a glb that isn't loaded");
+  if (ref) {
+    hash = ref->mesh_hashes[mesh - data->meshes];
+  }
+  SDL_UnlockSpinlock(&tb_glb_lock);
+  return hash;
+}
+
+TbAssetHash tb_glb_material_hash(const cgltf_data *data,
+                                 const cgltf_material *material) {
+  TbAssetHash hash = {0};
+  SDL_LockSpinlock(&tb_glb_lock);
+  tb_auto ref = tb_find_glb_ref(data);
+  TB_CHECK(ref, "Hashing a material from a glb that isn't loaded");
+  if (ref) {
+    hash = ref->material_hashes[material - data->materials];
+  }
+  SDL_UnlockSpinlock(&tb_glb_lock);
+  return hash;
+}
+
+TbAssetHash tb_glb_image_hash(const cgltf_data *data,
+                              const cgltf_image *image) {
+  TbAssetHash hash = {0};
+  SDL_LockSpinlock(&tb_glb_lock);
+  tb_auto ref = tb_find_glb_ref(data);
+  TB_CHECK(ref, "Hashing an image from a glb that isn't loaded");
+  if (ref) {
+    hash = ref->image_hashes[image - data->images];
+  }
+  SDL_UnlockSpinlock(&tb_glb_lock);
+  return hash;
+}
@@ -6,6 +6,7 @@
 #include "tb_gltf.h"
 #include "tb_render_system.h"
 #include "tb_render_thread.h"
+#include "tb_transform_component.h"
 #include "tb_view_system.h"
 #include "tb_world.h"
 
@@ -70,4 +71,17 @@ bool tb_ready_camera_comp(ecs_world_t *ecs, ecs_entity_t ent) {
   return comp != NULL;
 }
 
+float3 tb_get_camera_position(ecs_world_t *ecs, ecs_query_t *camera_query) {
+  tb_auto cam_it = ecs_query_iter(ecs, camera_query);
+  while (ecs_query_next(&cam_it)) {
+    if (cam_it.count > 0) {
+      const float3 pos =
+          tb_transform_get_world_trans(ecs, cam_it.entities[0]).position;
+      ecs_iter_fini(&cam_it);
+      return pos;
+    }
+  }
+  return (float3){0};
+}
+
 TB_REGISTER_COMP(tb, camera)
@@ -13,25 +13,54 @@
 
 #include <meshoptimizer.h>
 
+#include <TaskScheduler_c.h>
+
+// Views smaller than this in total aren't worth spreading across threads
+#define TB_DECODE_PARALLEL_MIN_BYTES (64 * 1024)
+
+static uint64_t tb_gltf_copy_bytes = 0;
+static uint64_t tb_gltf_reuse_bytes = 0;
+
+void tb_gltf_count_copy(uint64_t size) {
+  __atomic_fetch_add(&tb_gltf_copy_bytes, size, __ATOMIC_RELAXED);
+}
+
+uint64_t tb_gltf_copied_bytes(void) {
+  return __atomic_load_n(&tb_gltf_copy_bytes, __ATOMIC_RELAXED);
+}
+
+void tb_gltf_count_reuse(uint64_t size) {
+  __atomic_fetch_add(&tb_gltf_reuse_bytes, size, __ATOMIC_RELAXED);
+}
+
+uint64_t tb_gltf_reused_bytes(void) {
+  return __atomic_load_n(&tb_gltf_reuse_bytes, __ATOMIC_RELAXED);
+}
+
+bool tb_is_buffer_view_aliased(const cgltf_buffer_view *view) {
+  return !view->has_meshopt_compression && view->data != NULL &&
+         view->data == (uint8_t *)view->buffer->data + view->offset;
+}
+
+uint64_t tb_buffer_view_decoded_size(const cgltf_buffer_view *view) {
+  if (view->has_meshopt_compression) {
+    return view->meshopt_compression.count * view->meshopt_compression.stride;
+  }
+  return view->size;
+}
+
 // Based on an example from this cgltf commit message:
 // https://github.com/jkuhlmann/cgltf/commit/bd8bd2c9cc08ff9b75a9aa9f99091f7144665c60
-cgltf_result tb_decompress_buffer_view(TbAllocator alloc,
-                                       cgltf_buffer_view *view) {
-  TB_TRACY_SCOPE("Decompress Buffer");
-  if (view->data != NULL) {
-    // Already decoded
-    return cgltf_result_success;
-  }
+cgltf_result tb_decode_buffer_view(const cgltf_buffer_view *view,
+                                   void *result) {
+  TB_TRACY_SCOPE("Decode Buffer View");
 
   // Uncompressed buffer? No problem
   if (!view->has_meshopt_compression) {
-    uint8_t *data = (uint8_t *)view->buffer->data;
+    const uint8_t *data = (const uint8_t *)view->buffer->data;
     data += view->offset;
-
-    uint8_t *result = tb_alloc(alloc, view->size);
     SDL_memcpy(result, data, view->size); // NOLINT
-    view->data = result;
-    TB_LOG_INFO(SDL_LOG_CATEGORY_SYSTEM, "%s", "Using Uncompressed Buffer");
+    tb_gltf_count_copy(view->size);
     return cgltf_result_success;
   }
 
@@ -40,10 +69,6 @@ cgltf_result tb_decompress_buffer_view(TbAllocator alloc,
   data += mc->offset;
   TB_CHECK_RETURN(data, "Invalid data", cgltf_result_invalid_gltf);
 
-  uint8_t *result = tb_alloc(alloc, mc->count * mc->stride);
-  TB_CHECK_RETURN(result, "Failed to allocate space for decoded buffer view",
-                  cgltf_result_out_of_memory);
-
   {
     TB_TRACY_SCOPE("Decoding");
     int32_t res = -1;
@@ -92,6 +117,198 @@ cgltf_result tb_decompress_buffer_view(TbAllocator alloc,
     }
   }
 
-  view->data = result;
   return cgltf_result_success;
 }
+
+// Views of the same cgltf data can be decoded by several loads at once. The
+// first one to finish publishes its result and the others discard theirs
+static bool tb_publish_buffer_view(cgltf_buffer_view *view, void *data) {
+  void *expected = NULL;
+  return __atomic_compare_exchange_n(&view->data, &expected, data, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static bool tb_is_buffer_view_decoded(const cgltf_buffer_view *view) {
+  return __atomic_load_n(&view->data, __ATOMIC_ACQUIRE) != NULL;
+}
+
+cgltf_result tb_decompress_buffer_view(TbAllocator alloc,
+                                       cgltf_buffer_view *view) {
+  TB_TRACY_SCOPE("Decompress Buffer");
+  if (tb_is_buffer_view_decoded(view)) {
+    return cgltf_result_success;
+  }
+
+  // Uncompressed views are read in place from the buffer which stays mapped
+  // for as long as the cgltf data lives
+  if (!view->has_meshopt_compression) {
+    tb_publish_buffer_view(view, (uint8_t *)view->buffer->data + view->offset);
+    return cgltf_result_success;
+  }
+
+  uint8_t *result = tb_alloc(alloc, tb_buffer_view_decoded_size(view));
+  TB_CHECK_RETURN(result, "Failed to allocate space for decoded buffer view",
+                  cgltf_result_out_of_memory);
+
+  cgltf_result res = tb_decode_buffer_view(view, result);
+  if (res != cgltf_result_success) {
+    tb_free(alloc, result);
+    return res;
+  }
+
+  if (!tb_publish_buffer_view(view, result)) {
+    tb_free(alloc, result);
+  }
+  return cgltf_result_success;
+}
+
+// A cached decode of a view. Sorting these groups decodes of the same view
+typedef struct TbViewDecodeRef {
+  const cgltf_buffer_view *view;
+  uint32_t decode;
+} TbViewDecodeRef;
+
+static int32_t tb_view_decode_ref_cmp(const void *a, const void *b) {
+  const TbViewDecodeRef *x = a;
+  const TbViewDecodeRef *y = b;
+  if (x->view != y->view) {
+    return (uintptr_t)x->view < (uintptr_t)y->view ? -1 : 1;
+  }
+  return (x->decode > y->decode) - (x->decode < y->decode);
+}
+
+typedef struct TbDecodeViewsCtx {
+  TbBufferViewDecode *decodes;
+  const uint32_t *pending;
+} TbDecodeViewsCtx;
+
+static void tb_decode_views_task(uint32_t start, uint32_t end,
+                                 uint32_t threadnum, void *args) {
+  TB_TRACY_SCOPE("Decode Buffer Views");
+  (void)threadnum;
+  tb_auto ctx = (const TbDecodeViewsCtx *)args;
+  for (uint32_t i = start; i < end; ++i) {
+    tb_auto decode = &ctx->decodes[ctx->pending[i]];
+    decode->result = tb_decode_buffer_view(decode->view, decode->dst);
+  }
+}
+
+cgltf_result tb_decompress_buffer_views(TbTaskScheduler enki,
+                                        TbAllocator alloc, uint32_t count,
+                                        TbBufferViewDecode *decodes) {
+  TB_TRACY_SCOPE("Decompress Buffer Views");
+  if (count == 0) {
+    return cgltf_result_success;
+  }
+
+  // Figure out which decodes actually have work to do and give cached
+  // decodes somewhere to live
+  tb_auto pending = tb_alloc_nm_tp(alloc, count, uint32_t);
+  tb_auto cached = tb_alloc_nm_tp(alloc, count, bool);
+  tb_auto refs = tb_alloc_nm_tp(alloc, count, TbViewDecodeRef);
+  uint32_t pending_count = 0;
+  uint32_t ref_count = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    tb_auto decode = &decodes[i];
+    decode->result = cgltf_result_success;
+    cached[i] = false;
+    if (decode->dst != NULL) {
+      pending[pending_count++] = i;
+      continue;
+    }
+    if (tb_is_buffer_view_decoded(decode->view)) {
+      continue;
+    }
+    // Nothing to decode so there is no reason to copy
+    if (!decode->view->has_meshopt_compression) {
+      tb_decompress_buffer_view(alloc, decode->view);
+      continue;
+    }
+    refs[ref_count++] = (TbViewDecodeRef){.view = decode->view, .decode = i};
+  }
+
+  // Views are often shared by several accessors. Only the first accessor of
+  // each view decodes it
+  SDL_qsort(refs, ref_count, sizeof(TbViewDecodeRef), tb_view_decode_ref_cmp);
+  cgltf_result result = cgltf_result_success;
+  for (uint32_t r = 0; r < ref_count; ++r) {
+    if (r > 0 && refs[r].view == refs[r - 1].view) {
+      continue;
+    }
+    tb_auto decode = &decodes[refs[r].decode];
+    decode->dst = tb_alloc(alloc, tb_buffer_view_decoded_size(decode->view));
+    if (decode->dst == NULL) {
+      TB_CHECK(false, "Failed to allocate decoded buffer view");
+      result = cgltf_result_out_of_memory;
+      break;
+    }
+    cached[refs[r].decode] = true;
+    pending[pending_count++] = refs[r].decode;
+  }
+  tb_free(alloc, refs);
+  if (result != cgltf_result_success) {
+    // Destinations given by the caller are theirs to free
+    for (uint32_t i = 0; i < count; ++i) {
+      if (cached[i]) {
+        tb_free(alloc, decodes[i].dst);
+        decodes[i].dst = NULL;
+      }
+    }
+    tb_free(alloc, cached);
+    tb_free(alloc, pending);
+    return result;
+  }
+
+  uint64_t pending_size = 0;
+  for (uint32_t i = 0; i < pending_count; ++i) {
+    pending_size += tb_buffer_view_decoded_size(decodes[pending[i]].view);
+  }
+
+  const uint64_t start = SDL_GetPerformanceCounter();
+  TbDecodeViewsCtx ctx = {
+      .decodes = decodes,
+      .pending = pending,
+  };
+  if (enki != NULL && pending_count > 1 &&
+      pending_size >= TB_DECODE_PARALLEL_MIN_BYTES) {
+    TbTask task = tb_create_task2(enki, tb_decode_views_task, &ctx);
+    struct enkiParamsTaskSet params = enkiGetParamsTaskSet(task);
+    params.setSize = pending_count;
+    params.minRange = 1;
+    enkiSetParamsTaskSet(task, params);
+    enkiAddTaskSet(enki, task);
+    tb_wait_task(enki, task);
+    enkiDeleteTaskSet(enki, task);
+  } else {
+    tb_decode_views_task(0, pending_count, 0, &ctx);
+  }
+  if (pending_count > 0) {
+    const double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 /
+                      (double)SDL_GetPerformanceFrequency();
+    TB_LOG_DEBUG(SDL_LOG_CATEGORY_SYSTEM,
+                 "Decoded %u buffer views (%.1fKB) in %.3fms (%.1fMB/s)",
+                 pending_count, (double)pending_size / 1024.0, ms,
+                 (double)pending_size / (1024.0 * 1024.0) /
+                     SDL_max(ms / 1000.0, 1e-6));
+  }
+
+  // Publish cached results only once they are fully decoded. Another batch
+  // may have published the same view first in which case ours is dropped
+  for (uint32_t i = 0; i < pending_count; ++i) {
+    tb_auto decode = &decodes[pending[i]];
+    if (result == cgltf_result_success) {
+      result = decode->result;
+    }
+    if (cached[pending[i]]) {
+      if (decode->result != cgltf_result_success ||
+          !tb_publish_buffer_view(decode->view, decode->dst)) {
+        tb_free(alloc, decode->dst);
+      }
+      decode->dst = NULL;
+    }
+  }
+
+  tb_free(alloc, cached);
+  tb_free(alloc, pending);
+  return result;
+}
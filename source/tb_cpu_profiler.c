@@ -0,0 +1,232 @@
+#include "tb_cpu_profiler.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_profiling.h"
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+typedef struct TbProfEvent {
+  const char *name;
+  uint64_t begin;
+  uint64_t end;
+} TbProfEvent;
+
+// Only the owning thread writes to its buffer. Events are published by
+// storing the count after the event itself so the main thread can read every
+// event below the count at any time without taking a lock
+typedef struct TbProfThread {
+  SDL_ThreadID id;
+  const char *name;
+  SDL_AtomicInt generation;
+  SDL_AtomicInt count;
+  SDL_AtomicInt dropped;
+  TbProfEvent events[TB_PROF_EVENTS_PER_THREAD];
+} TbProfThread;
+
+// Non-zero generation of the running capture
+static SDL_AtomicInt tb_prof_active = {0};
+static SDL_AtomicInt tb_prof_thread_count = {0};
+static void *tb_prof_threads[TB_PROF_MAX_THREADS] = {0};
+
+static _Thread_local TbProfThread *tb_prof_tls = NULL;
+static _Thread_local const char *tb_prof_tls_name = NULL;
+static _Thread_local bool tb_prof_tls_full = false;
+
+// Capture state, only touched by the main thread
+static int32_t tb_prof_generation = 0;
+static uint32_t tb_prof_requested_frames = 0;
+static uint32_t tb_prof_frames_left = 0;
+static uint64_t tb_prof_capture_start = 0;
+static char tb_prof_path[256] = {0};
+static TbProfCaptureInfo tb_prof_last_info = {0};
+
+bool tb_prof_capturing(void) { return SDL_GetAtomicInt(&tb_prof_active) != 0; }
+
+uint64_t tb_prof_now(void) { return SDL_GetPerformanceCounter(); }
+
+void tb_prof_set_thread_name(const char *name) {
+  tb_prof_tls_name = name;
+  if (tb_prof_tls) {
+    tb_prof_tls->name = name;
+  }
+}
+
+static TbProfThread *tb_prof_get_thread(void) {
+  if (tb_prof_tls || tb_prof_tls_full) {
+    return tb_prof_tls;
+  }
+  const int32_t idx = SDL_AddAtomicInt(&tb_prof_thread_count, 1);
+  if (idx >= TB_PROF_MAX_THREADS) {
+    tb_prof_tls_full = true;
+    return NULL;
+  }
+  // Buffers are only allocated once a thread records during a capture and
+  // live until the process exits since other threads may still be reading
+  tb_auto thread = tb_alloc_tp(tb_global_alloc, TbProfThread);
+  thread->id = SDL_GetCurrentThreadID();
+  thread->name = tb_prof_tls_name;
+  SDL_SetAtomicInt(&thread->generation, 0);
+  SDL_SetAtomicInt(&thread->count, 0);
+  SDL_SetAtomicInt(&thread->dropped, 0);
+  SDL_SetAtomicPointer(&tb_prof_threads[idx], thread);
+  tb_prof_tls = thread;
+  return thread;
+}
+
+TbProfZone tb_prof_zone_begin(const char *name) {
+  if (SDL_GetAtomicInt(&tb_prof_active) == 0) {
+    return (TbProfZone){0};
+  }
+  return (TbProfZone){name, SDL_GetPerformanceCounter()};
+}
+
+void tb_prof_zone_end(TbProfZone *zone) {
+  if (zone->name) {
+    tb_prof_emit(zone->name, zone->begin, SDL_GetPerformanceCounter());
+  }
+}
+
+void tb_prof_emit(const char *name, uint64_t begin, uint64_t end) {
+  const int32_t gen = SDL_GetAtomicInt(&tb_prof_active);
+  if (gen == 0) {
+    return;
+  }
+  tb_auto thread = tb_prof_get_thread();
+  if (!thread) {
+    return;
+  }
+  // Count must be reset before the generation is published so that the main
+  // thread never pairs a new generation with a stale count
+  if (SDL_GetAtomicInt(&thread->generation) != gen) {
+    SDL_SetAtomicInt(&thread->count, 0);
+    SDL_SetAtomicInt(&thread->dropped, 0);
+    SDL_SetAtomicInt(&thread->generation, gen);
+  }
+  const int32_t idx = SDL_GetAtomicInt(&thread->count);
+  if (idx >= TB_PROF_EVENTS_PER_THREAD) {
+    SDL_AddAtomicInt(&thread->dropped, 1);
+    return;
+  }
+  thread->events[idx] = (TbProfEvent){name, begin, end};
+  SDL_SetAtomicInt(&thread->count, idx + 1);
+}
+
+bool tb_prof_request_capture(uint32_t frame_count, const char *path) {
+  if (tb_prof_requested_frames > 0 || tb_prof_frames_left > 0 ||
+      frame_count == 0) {
+    return false;
+  }
+  SDL_snprintf(tb_prof_path, sizeof(tb_prof_path), "%s",
+               path ? path : TB_PROF_DEFAULT_CAPTURE_PATH);
+  tb_prof_requested_frames = frame_count;
+  return true;
+}
+
+TbProfCaptureInfo tb_prof_last_capture(void) { return tb_prof_last_info; }
+
+// Names may hold anything so quotes, backslashes and control characters are
+// all escaped to keep the capture valid JSON
+static void tb_prof_write_json_string(SDL_IOStream *io, const char *str) {
+  SDL_WriteU8(io, '"');
+  for (const char *c = str; *c; ++c) {
+    const uint8_t ch = (uint8_t)*c;
+    if (ch == '"' || ch == '\\') {
+      SDL_WriteU8(io, '\\');
+      SDL_WriteU8(io, ch);
+    } else if (ch < 0x20) {
+      SDL_IOprintf(io, "\\u%04x", ch);
+    } else {
+      SDL_WriteU8(io, ch);
+    }
+  }
+  SDL_WriteU8(io, '"');
+}
+
+static void tb_prof_write_capture(int32_t gen, uint32_t frames) {
+  TB_TRACY_SCOPE("Write CPU Capture");
+  TbProfCaptureInfo info = {.frames = frames};
+
+  tb_auto io = SDL_IOFromFile(tb_prof_path, "w");
+  if (!io) {
+    TB_LOG_WARN(SDL_LOG_CATEGORY_APPLICATION,
+                "Failed to open %s to write CPU capture: %s", tb_prof_path,
+                SDL_GetError());
+    tb_prof_last_info = info;
+    return;
+  }
+
+  const double us_per_tick = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+  bool first = true;
+
+  SDL_IOprintf(io, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  const int32_t thread_count = SDL_min(
+      SDL_GetAtomicInt(&tb_prof_thread_count), TB_PROF_MAX_THREADS);
+  for (int32_t t = 0; t < thread_count; ++t) {
+    TbProfThread *thread = SDL_GetAtomicPointer(&tb_prof_threads[t]);
+    if (!thread || SDL_GetAtomicInt(&thread->generation) != gen) {
+      continue;
+    }
+    const int32_t count = SDL_GetAtomicInt(&thread->count);
+    info.threads++;
+    info.events += (uint32_t)count;
+    info.dropped += (uint32_t)SDL_GetAtomicInt(&thread->dropped);
+
+    const uint64_t tid = (uint64_t)thread->id;
+    SDL_IOprintf(io,
+                 "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                 "\"tid\":%" SDL_PRIu64 ",\"args\":{\"name\":",
+                 first ? "" : ",\n", tid);
+    first = false;
+    if (thread->name) {
+      tb_prof_write_json_string(io, thread->name);
+    } else {
+      SDL_IOprintf(io, "\"Thread %" SDL_PRIu64 "\"", tid);
+    }
+    SDL_IOprintf(io, "}}");
+
+    for (int32_t i = 0; i < count; ++i) {
+      const tb_auto event = &thread->events[i];
+      SDL_IOprintf(io, ",\n{\"name\":");
+      tb_prof_write_json_string(io, event->name);
+      SDL_IOprintf(
+          io,
+          ",\"ph\":\"X\",\"pid\":0,\"tid\":%" SDL_PRIu64
+          ",\"ts\":%.3f,\"dur\":%.3f}",
+          tid, (double)(event->begin - tb_prof_capture_start) * us_per_tick,
+          (double)(event->end - event->begin) * us_per_tick);
+    }
+  }
+  SDL_IOprintf(io, "\n]}\n");
+  info.written = SDL_CloseIO(io);
+
+  TB_LOG_INFO(SDL_LOG_CATEGORY_APPLICATION,
+              "Wrote %u CPU profiler events over %u frames to %s (%u dropped)",
+              info.events, info.frames, tb_prof_path, info.dropped);
+  tb_prof_last_info = info;
+}
+
+void tb_prof_frame(void) {
+  if (tb_prof_frames_left > 0) {
+    tb_prof_frames_left--;
+    if (tb_prof_frames_left == 0) {
+      // Stop recording before writing. A thread that is midway through an
+      // event may still append it but events past the count read here are
+      // simply left out
+      SDL_SetAtomicInt(&tb_prof_active, 0);
+      tb_prof_write_capture(tb_prof_generation, tb_prof_requested_frames);
+      tb_prof_requested_frames = 0;
+    }
+    return;
+  }
+
+  if (tb_prof_requested_frames > 0) {
+    tb_prof_generation++;
+    tb_prof_frames_left = tb_prof_requested_frames;
+    tb_prof_capture_start = SDL_GetPerformanceCounter();
+    SDL_SetAtomicInt(&tb_prof_active, tb_prof_generation);
+  }
+}
@@ -16,7 +16,9 @@ VkResult tb_resize_desc_buffer(TbRenderSystem *rnd_sys, uint32_t capacity,
   const uint32_t cap = capacity > 0 ? capacity : 1;
   out_buf->desc_cap = cap;
 
-  const VkDeviceSize buffer_size = capacity * out_buf->layout_size;
+  const VkDeviceSize buffer_size = cap * out_buf->layout_size;
+  // Only set again if the new buffer can't be mapped
+  out_buf->host = (TbHostBuffer){0};
   {
     VkBufferCreateInfo create_info = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
@@ -35,26 +37,41 @@ VkResult tb_resize_desc_buffer(TbRenderSystem *rnd_sys, uint32_t capacity,
                                        (void **)&out_buf->data_ptr);
     TB_VK_CHECK(err, "Failed to create descriptor buffer");
 
-    // Did the previous generation buffer have contents that we should copy?
-    if (prev_buf.desc_count > 0) {
-      const VkDeviceSize prev_buf_size =
-          prev_buf.desc_cap * out_buf->layout_size;
-      // NOTE: This may be extremely expensive. Driver owned memory usually
-      // isn't supposed to be read from but maybe doing this all in one op will
-      // be okay. Maybe a vkCmdCopyBuffer instead?
-      SDL_memcpy(out_buf->data_ptr, prev_buf.data_ptr, prev_buf_size);
-    }
   }
 
+  // The shadow copy is what writes are compared against so it has to grow
+  // with the buffer and keep what was already written. It is also where the
+  // previous generation's contents come from so driver owned memory is never
+  // read back
+  out_buf->shadow = tb_alloc(rnd_sys->gp_alloc, buffer_size);
+  SDL_memset(out_buf->shadow, 0, buffer_size);
+  if (prev_buf.shadow) {
+    const VkDeviceSize prev_buf_size = prev_buf.desc_cap * out_buf->layout_size;
+    SDL_memcpy(out_buf->shadow, prev_buf.shadow, prev_buf_size);
+    SDL_memcpy(out_buf->data_ptr, prev_buf.shadow, prev_buf_size);
+    tb_free(rnd_sys->gp_alloc, prev_buf.shadow);
+  }
+
+  // Frames in flight may still be bound to the previous generation
+  if (prev_buf.buffer.buffer != VK_NULL_HANDLE) {
+    tb_rnd_free_gpu_buffer_deferred(rnd_sys, &prev_buf.buffer);
+  }
+  if (prev_buf.host.buffer != VK_NULL_HANDLE) {
+    tb_rnd_free_host_buffer_deferred(rnd_sys, &prev_buf.host);
+  }
   // Free list can be initialized and all possible indices should be placed into
-  // the list
+  // the list. Indices that were already free stay free
   TB_DYN_ARR_RESET(out_buf->free_list, rnd_sys->gp_alloc, cap);
   // Reverse iter so the last idx we append is 0
   // Iter from the previous buf's cap so that we only reports newly allocated
-  // indices as free. Existing free list is still correct
+  // indices as free
   for (int32_t i = (int32_t)cap - 1; i >= (int32_t)prev_buf.desc_cap; --i) {
     TB_DYN_ARR_APPEND(out_buf->free_list, i);
   }
+  TB_DYN_ARR_FOREACH(prev_buf.free_list, i) {
+    TB_DYN_ARR_APPEND(out_buf->free_list, TB_DYN_ARR_AT(prev_buf.free_list, i));
+  }
+  TB_DYN_ARR_DESTROY(prev_buf.free_list);
 
   return err;
 }
@@ -94,9 +111,20 @@ VkResult tb_create_descriptor_buffer(TbRenderSystem *rnd_sys,
 
 void tb_destroy_descriptor_buffer(TbRenderSystem *rnd_sys,
                                   TbDescriptorBuffer *buf) {
-  (void)rnd_sys;
-  (void)buf;
-  TB_CHECK(false, "Unimplemented");
+  if (buf->buffer.buffer != VK_NULL_HANDLE) {
+    tb_rnd_free_gpu_buffer_deferred(rnd_sys, &buf->buffer);
+  }
+  if (buf->host.buffer != VK_NULL_HANDLE) {
+    tb_rnd_free_host_buffer_deferred(rnd_sys, &buf->host);
+  }
+  if (buf->shadow) {
+    tb_free(rnd_sys->gp_alloc, buf->shadow);
+  }
+  TB_DYN_ARR_DESTROY(buf->free_list);
+#ifndef TB_FINAL
+  tb_free(rnd_sys->gp_alloc, (char *)buf->name);
+#endif
+  *buf = (TbDescriptorBuffer){0};
 }
 
 VkDescriptorBufferBindingInfoEXT
@@ -143,11 +171,10 @@ VkDeviceSize tb_lookup_desc_size(
   }
 }
 
-uint32_t tb_write_desc_to_buffer(TbRenderSystem *rnd_sys,
-                                 TbDescriptorBuffer *desc_buf, uint32_t binding,
-                                 const TbDescriptor *desc) {
+uint32_t tb_alloc_desc_slot(TbRenderSystem *rnd_sys,
+                            TbDescriptorBuffer *desc_buf) {
   // See if we need to resize the buffer
-  if (desc_buf->desc_count + 1 >= desc_buf->desc_cap) {
+  if (TB_DYN_ARR_EMPTY(desc_buf->free_list)) {
     const uint32_t new_cap = desc_buf->desc_cap + TB_DESC_BUF_PAGE_SIZE;
     VkResult err = tb_resize_desc_buffer(rnd_sys, new_cap, desc_buf);
     TB_VK_CHECK(err, "Error occurred during resize");
@@ -158,39 +185,108 @@ uint32_t tb_write_desc_to_buffer(TbRenderSystem *rnd_sys,
   uint32_t idx = *TB_DYN_ARR_BACKPTR(desc_buf->free_list);
   TB_DYN_ARR_POP(desc_buf->free_list);
 
-  VkDevice device = rnd_sys->render_thread->device;
+  desc_buf->desc_count++;
+  return idx;
+}
 
-  // Last minute look up binding offset
-  VkDeviceSize binding_offset = 0;
-  vkGetDescriptorSetLayoutBindingOffsetEXT(device, desc_buf->layout, binding,
-                                           &binding_offset);
-  VkDescriptorGetInfoEXT desc_info = {
-      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
-      .type = desc->type,
-      .data = desc->data,
-  };
+static int32_t tb_cmp_buffer_copy(const void *lhs, const void *rhs) {
+  const VkDeviceSize l = ((const TbBufferCopy *)lhs)->region.dstOffset;
+  const VkDeviceSize r = ((const TbBufferCopy *)rhs)->region.dstOffset;
+  return (l > r) - (l < r);
+}
+
+uint32_t tb_merge_buffer_copies(uint32_t count, TbBufferCopy *copies) {
+  SDL_qsort(copies, count, sizeof(TbBufferCopy), tb_cmp_buffer_copy);
+  uint32_t merged = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    tb_auto copy = &copies[i];
+    if (merged > 0) {
+      tb_auto last = &copies[merged - 1];
+      const VkDeviceSize last_end = last->region.dstOffset + last->region.size;
+      if (copy->region.dstOffset <= last_end) {
+        const VkDeviceSize end = copy->region.dstOffset + copy->region.size;
+        last->region.size = SDL_max(last_end, end) - last->region.dstOffset;
+        continue;
+      }
+    }
+    copies[merged++] = *copy;
+  }
+  return merged;
+}
+
+void tb_write_descs_to_buffer(TbRenderSystem *rnd_sys,
+                              TbDescriptorBuffer *desc_buf,
+                              uint32_t write_count,
+                              const TbDescriptorWrite *writes) {
+  TB_TRACY_SCOPE("Write Descriptor Buffer");
+  if (write_count == 0) {
+    return;
+  }
+
+  VkDevice device = rnd_sys->render_thread->device;
   tb_auto desc_buf_props = &rnd_sys->render_thread->desc_buf_props;
-  tb_auto desc_size = tb_lookup_desc_size(desc->type, desc_buf_props);
 
-  // Write to the buffer by having vkGetDescriptorExt output to the buf's ptr
-  VkDeviceSize offset = (idx * desc_size) + binding_offset;
-  uint8_t *ptr = desc_buf->data_ptr + offset;
-  vkGetDescriptorEXT(device, &desc_info, desc_size, ptr);
+  // Ranges of the buffer that actually changed
+  TB_DYN_ARR_OF(TbBufferCopy) copies = {0};
+  TB_DYN_ARR_RESET(copies, rnd_sys->tmp_alloc, write_count);
+
+  // Large enough for any single descriptor
+  uint8_t scratch[256] = {0};
+  for (uint32_t i = 0; i < write_count; ++i) {
+    tb_auto write = &writes[i];
+    TB_CHECK(write->slot < desc_buf->desc_cap, "Descriptor slot out of range");
+
+    VkDeviceSize binding_offset = 0;
+    vkGetDescriptorSetLayoutBindingOffsetEXT(device, desc_buf->layout,
+                                             write->binding, &binding_offset);
+    tb_auto desc_size = tb_lookup_desc_size(write->desc.type, desc_buf_props);
+    TB_CHECK(desc_size <= sizeof(scratch), "Descriptor too large");
+
+    VkDescriptorGetInfoEXT desc_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+        .type = write->desc.type,
+        .data = write->desc.data,
+    };
+    vkGetDescriptorEXT(device, &desc_info, desc_size, scratch);
+
+    // Unchanged descriptors are never written or uploaded again
+    const VkDeviceSize offset = (write->slot * desc_buf->layout_size) +
+                                binding_offset +
+                                (write->element * desc_size);
+    if (SDL_memcmp(desc_buf->shadow + offset, scratch, desc_size) == 0) {
+      continue;
+    }
+    SDL_memcpy(desc_buf->shadow + offset, scratch, desc_size);
+    SDL_memcpy(desc_buf->data_ptr + offset, scratch, desc_size);
 
-  // Host will be null if the buffer was mappable
-  if (desc_buf->host.buffer != VK_NULL_HANDLE) {
-    // NOTE: This could cause a lot of time spent processing buffer uploads
-    // Upload just the region of the buffer that changed
     TbBufferCopy copy = {
         .dst = desc_buf->buffer.buffer,
         .src = desc_buf->host.buffer,
         .region = {.srcOffset = offset, .dstOffset = offset, .size = desc_size},
     };
-    tb_rnd_upload_buffers(rnd_sys, &copy, 1);
+    TB_DYN_ARR_APPEND(copies, copy);
   }
 
-  // Increase buffer count
-  desc_buf->desc_count++;
+  // Host will be null if the buffer was mappable
+  if (desc_buf->host.buffer == VK_NULL_HANDLE || TB_DYN_ARR_EMPTY(copies)) {
+    return;
+  }
+
+  const uint32_t merged =
+      tb_merge_buffer_copies(TB_DYN_ARR_SIZE(copies), copies.data);
+  tb_rnd_upload_buffers(rnd_sys, copies.data, merged);
+}
+
+uint32_t tb_write_desc_to_buffer(TbRenderSystem *rnd_sys,
+                                 TbDescriptorBuffer *desc_buf, uint32_t binding,
+                                 const TbDescriptor *desc) {
+  const uint32_t idx = tb_alloc_desc_slot(rnd_sys, desc_buf);
+  TbDescriptorWrite write = {
+      .slot = idx,
+      .binding = binding,
+      .desc = *desc,
+  };
+  tb_write_descs_to_buffer(rnd_sys, desc_buf, 1, &write);
   return idx;
 }
 
@@ -2,18 +2,68 @@
 #include "tb_common.h"
 #include "tb_util.h"
 
+static bool tb_is_image_desc(VkDescriptorType type) {
+  return type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
+         type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+         type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+}
+
+static bool tb_is_texel_desc(VkDescriptorType type) {
+  return type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
+         type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+}
+
+static uint32_t tb_dyn_desc_size(VkDescriptorType type) {
+  if (tb_is_image_desc(type)) {
+    return sizeof(VkDescriptorImageInfo);
+  }
+  if (tb_is_texel_desc(type)) {
+    return sizeof(VkBufferView);
+  }
+  TB_CHECK(type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+               type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+           "Unexpected descriptor type");
+  return sizeof(VkDescriptorBufferInfo);
+}
+
+void tb_init_dyn_desc_storage(TbAllocator alloc, VkDescriptorType type,
+                              uint32_t desc_cap, TbDynDescPool *pool) {
+  *pool = (TbDynDescPool){
+      .alloc = alloc,
+      .type = type,
+      .desc_cap = desc_cap,
+      .desc_size = tb_dyn_desc_size(type),
+  };
+  tb_reset_free_list(alloc, &pool->free_list, desc_cap);
+  pool->descs = tb_alloc(alloc, (uint64_t)desc_cap * pool->desc_size);
+  SDL_memset(pool->descs, 0, (uint64_t)desc_cap * pool->desc_size);
+  const uint32_t dirty_words = (desc_cap + 31) / 32;
+  TB_DYN_ARR_RESET(pool->released, alloc, 8);
+  for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+    TB_DYN_ARR_RESET(pool->pending[frame_idx], alloc, 8);
+    pool->dirty[frame_idx] = tb_alloc_nm_tp(alloc, dirty_words, uint32_t);
+    SDL_memset(pool->dirty[frame_idx], 0, dirty_words * sizeof(uint32_t));
+  }
+}
+
+void tb_destroy_dyn_desc_storage(TbDynDescPool *pool) {
+  for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+    tb_free(pool->alloc, pool->dirty[frame_idx]);
+    tb_destroy_free_list(&pool->pending[frame_idx]);
+  }
+  tb_free(pool->alloc, pool->descs);
+  tb_destroy_free_list(&pool->released);
+  tb_destroy_free_list(&pool->free_list);
+}
+
 void tb_create_dyn_desc_pool(TbRenderSystem *rnd_sys, const char *name,
                              VkDescriptorSetLayout layout,
                              VkDescriptorType type, uint32_t desc_cap,
                              TbDynDescPool *pool, uint32_t binding) {
   TB_TRACY_SCOPE("Create Dynamic Descriptor Pool");
-  *pool = (TbDynDescPool){
-      .layout = layout,
-      .binding = binding,
-      .type = type,
-      .desc_cap = desc_cap,
-  };
-  tb_reset_free_list(rnd_sys->gp_alloc, &pool->free_list, pool->desc_cap);
+  tb_init_dyn_desc_storage(rnd_sys->gp_alloc, type, desc_cap, pool);
+  pool->layout = layout;
+  pool->binding = binding;
   for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
     VkDescriptorPoolCreateInfo create_info = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
@@ -50,8 +100,41 @@ void tb_create_dyn_desc_pool(TbRenderSystem *rnd_sys, const char *name,
     };
     tb_rnd_alloc_descriptor_sets(rnd_sys, name, &alloc_info,
                                  &pool->sets[frame_idx]);
+  }
+}
+
+void tb_destroy_dyn_desc_pool(TbRenderSystem *rnd_sys, TbDynDescPool *pool) {
+  for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+    tb_rnd_destroy_descriptor_pool(rnd_sys, pool->pools[frame_idx]);
+  }
+  tb_destroy_dyn_desc_storage(pool);
+  *pool = (TbDynDescPool){0};
+}
+
+// Writes to null resources are dropped rather than written to the set
+static bool tb_is_dyn_desc_null(const TbDynDescPool *pool, uint32_t idx) {
+  const uint8_t *desc = pool->descs + (uint64_t)idx * pool->desc_size;
+  if (tb_is_image_desc(pool->type)) {
+    return ((const VkDescriptorImageInfo *)desc)->imageView == VK_NULL_HANDLE;
+  }
+  if (tb_is_texel_desc(pool->type)) {
+    return *(const VkBufferView *)desc == VK_NULL_HANDLE;
+  }
+  return ((const VkDescriptorBufferInfo *)desc)->buffer == VK_NULL_HANDLE;
+}
+
+// Stores the descriptor for the given index and marks it to be written to
+// every frame state's set. Writing the same index again before a frame state
+// is ticked only results in the latest descriptor being written
+static void tb_enqueue_dyn_desc_write(TbDynDescPool *pool, uint32_t idx,
+                                      const TbDynDescWrite *desc_write) {
+  TB_CHECK(pool->type == desc_write->type, "Invalid write type");
+  TB_CHECK(idx < pool->desc_cap, "Descriptor index out of range");
 
-    TB_QUEUE_RESET(pool->write_queues[frame_idx], rnd_sys->gp_alloc, desc_cap);
+  SDL_memcpy(pool->descs + (uint64_t)idx * pool->desc_size, &desc_write->desc,
+             pool->desc_size);
+  for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+    pool->dirty[frame_idx][idx / 32] |= 1u << (idx % 32);
   }
 }
 
@@ -69,47 +152,8 @@ bool tb_write_dyn_desc_pool(TbDynDescPool *pool, uint32_t write_count,
     bool idx_ok = tb_pull_index(&pool->free_list, &free_idx);
     TB_CHECK(idx_ok, "Failed to retrieve index from free list");
 
-    tb_auto desc_write = &writes[i];
-    TB_CHECK(pool->type == desc_write->type, "Invalid write type");
-
     // Need to enqueue a write per frame
-    for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
-      tb_auto write_queue = &pool->write_queues[frame_idx];
-
-      VkWriteDescriptorSet write = {
-          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-          .descriptorCount = 1,
-          .descriptorType = pool->type,
-          .dstBinding = pool->binding,
-          .dstSet = pool->sets[frame_idx],
-          .dstArrayElement = free_idx,
-      };
-
-      if (pool->type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
-          pool->type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
-          pool->type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
-        write.pImageInfo = &desc_write->desc.image;
-        if (write.pImageInfo->imageView == VK_NULL_HANDLE) {
-          continue;
-        }
-      } else if (pool->type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
-                 pool->type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER) {
-        write.pTexelBufferView = &desc_write->desc.texel_buffer;
-        if (write.pTexelBufferView == VK_NULL_HANDLE) {
-          continue;
-        }
-      } else if (pool->type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
-                 pool->type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) {
-        write.pBufferInfo = &desc_write->desc.buffer;
-        if (write.pBufferInfo->buffer == VK_NULL_HANDLE) {
-          continue;
-        }
-      } else {
-        TB_CHECK(false, "Unexpected descriptor type");
-      }
-
-      TB_QUEUE_PUSH_PTR(write_queue, write);
-    }
+    tb_enqueue_dyn_desc_write(pool, free_idx, &writes[i]);
     if (out_idxs) {
       out_idxs[i] = free_idx;
     }
@@ -117,26 +161,101 @@ bool tb_write_dyn_desc_pool(TbDynDescPool *pool, uint32_t write_count,
   return true;
 }
 
-void tb_tick_dyn_desc_pool(TbRenderSystem *rnd_sys, TbDynDescPool *pool) {
-  TB_TRACY_SCOPE("Tick Dynamic Descriptor Pool");
-  const uint32_t frame_idx = rnd_sys->frame_idx;
-  tb_auto write_queue = &pool->write_queues[frame_idx];
+void tb_update_dyn_desc(TbDynDescPool *pool, uint32_t idx,
+                        const TbDynDescWrite *write) {
+  TB_TRACY_SCOPE("Update Dynamic Descriptor");
+  tb_enqueue_dyn_desc_write(pool, idx, write);
+}
 
-  // Render Thread allocator to make sure writes live
-  tb_auto rnd_tmp_alloc =
-      rnd_sys->render_thread->frame_states[rnd_sys->frame_idx].tmp_alloc.alloc;
+void tb_release_dyn_desc(TbDynDescPool *pool, uint32_t idx) {
+  TB_DYN_ARR_APPEND(pool->released, idx);
+}
+
+uint32_t tb_flush_dyn_desc_pool(TbDynDescPool *pool, uint32_t frame_idx,
+                                TbAllocator alloc,
+                                VkWriteDescriptorSet **out_writes) {
+  TB_TRACY_SCOPE("Flush Dynamic Descriptor Pool");
 
-  // Dequeue to a local collection
+  // The last time this frame state was ticked is done on the GPU so indices
+  // released before then are free to be written again
+  {
+    tb_auto pending = &pool->pending[frame_idx];
+    TB_DYN_ARR_FOREACH(*pending, i) {
+      tb_return_index(&pool->free_list, TB_DYN_ARR_AT(*pending, i));
+    }
+    TB_DYN_ARR_CLEAR(*pending);
+    TB_DYN_ARR_FOREACH(pool->released, i) {
+      TB_DYN_ARR_APPEND(*pending, TB_DYN_ARR_AT(pool->released, i));
+    }
+    TB_DYN_ARR_CLEAR(pool->released);
+  }
+
+  // Every run of neighboring dirty indices becomes a single ranged write that
+  // reads straight from the pool's descriptors
   TB_DYN_ARR_OF(VkWriteDescriptorSet) writes = {0};
-  TB_DYN_ARR_RESET(writes, rnd_tmp_alloc, pool->desc_cap);
-  VkWriteDescriptorSet write = {0};
-  while (TB_QUEUE_POP(*write_queue, &write)) {
-    TB_DYN_ARR_APPEND(writes, write);
+  TB_DYN_ARR_RESET(writes, alloc, 8);
+  const VkWriteDescriptorSet run_base = {
+      .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+      .descriptorType = pool->type,
+      .dstBinding = pool->binding,
+      .dstSet = pool->sets[frame_idx],
+  };
+  VkWriteDescriptorSet run = run_base;
+  tb_auto dirty = pool->dirty[frame_idx];
+  const uint32_t dirty_words = (pool->desc_cap + 31) / 32;
+  for (uint32_t word = 0; word < dirty_words; ++word) {
+    uint32_t bits = dirty[word];
+    dirty[word] = 0;
+    while (bits != 0) {
+      // Isolate the lowest set bit so indices are visited in order
+      const uint32_t bit =
+          (uint32_t)SDL_MostSignificantBitIndex32(bits & (~bits + 1));
+      bits &= bits - 1;
+      const uint32_t idx = word * 32 + bit;
+      if (tb_is_dyn_desc_null(pool, idx)) {
+        continue;
+      }
+      if (run.descriptorCount > 0 &&
+          run.dstArrayElement + run.descriptorCount == idx) {
+        run.descriptorCount++;
+        continue;
+      }
+      if (run.descriptorCount > 0) {
+        TB_DYN_ARR_APPEND(writes, run);
+      }
+      const void *desc = pool->descs + (uint64_t)idx * pool->desc_size;
+      run = run_base;
+      run.dstArrayElement = idx;
+      run.descriptorCount = 1;
+      if (tb_is_image_desc(pool->type)) {
+        run.pImageInfo = desc;
+      } else if (tb_is_texel_desc(pool->type)) {
+        run.pTexelBufferView = desc;
+      } else {
+        run.pBufferInfo = desc;
+      }
+    }
+  }
+  if (run.descriptorCount > 0) {
+    TB_DYN_ARR_APPEND(writes, run);
   }
 
-  // Issue any writes that were gathered
-  if (!TB_DYN_ARR_EMPTY(writes)) {
-    tb_rnd_update_descriptors(rnd_sys, TB_DYN_ARR_SIZE(writes), writes.data);
+  *out_writes = writes.data;
+  return TB_DYN_ARR_SIZE(writes);
+}
+
+void tb_tick_dyn_desc_pool(TbRenderSystem *rnd_sys, TbDynDescPool *pool) {
+  TB_TRACY_SCOPE("Tick Dynamic Descriptor Pool");
+  // Render Thread allocator to make sure writes live. The render system
+  // copies the descriptors when the writes are queued so later writes to the
+  // pool can't race the render thread
+  tb_auto rnd_tmp_alloc =
+      rnd_sys->render_thread->frame_states[rnd_sys->frame_idx].tmp_alloc.alloc;
+  VkWriteDescriptorSet *writes = NULL;
+  const uint32_t write_count =
+      tb_flush_dyn_desc_pool(pool, rnd_sys->frame_idx, rnd_tmp_alloc, &writes);
+  if (write_count > 0) {
+    tb_rnd_update_descriptors(rnd_sys, write_count, writes);
   }
 }
 
@@ -0,0 +1,71 @@
+#include "tb_dyn_res.h"
+
+#include "tb_common.h"
+#include "tb_render_common.h"
+
+// Weight of a new sample when times are falling. Rising times are taken as is
+#define TB_DYN_RES_SMOOTHING 0.1f
+// Only scale up while the smoothed time is under this fraction of the budget
+#define TB_DYN_RES_HEADROOM 0.85f
+// Largest relative change of the scale in one step
+#define TB_DYN_RES_MAX_STEP_DOWN 0.15f
+#define TB_DYN_RES_MAX_STEP_UP 0.05f
+// Timings lag behind by the frames in flight so let a change show up in the
+// measurements before making another
+#define TB_DYN_RES_SETTLE_FRAMES (TB_MAX_FRAME_STATES + 1)
+// Changes smaller than this aren't worth the churn
+#define TB_DYN_RES_MIN_STEP 0.01f
+
+void tb_dyn_res_init(TbDynResController *self, float target_ms,
+                     float min_scale, float max_scale) {
+  TB_CHECK(self, "Invalid controller");
+  TB_CHECK(min_scale > 0.0f && min_scale <= max_scale, "Invalid scale range");
+  *self = (TbDynResController){
+      .target_ms = target_ms,
+      .min_scale = min_scale,
+      .max_scale = max_scale,
+      .scale = max_scale,
+  };
+}
+
+float tb_dyn_res_update(TbDynResController *self, float gpu_ms) {
+  TB_CHECK_RETURN(self, "Invalid controller", 1.0f);
+  if (gpu_ms <= 0.0f || self->target_ms <= 0.0f) {
+    return self->scale;
+  }
+  // Samples still in flight were rendered at the previous scale
+  if (self->delay > 0) {
+    self->delay--;
+    return self->scale;
+  }
+
+  if (self->avg_ms <= 0.0f || gpu_ms > self->avg_ms) {
+    self->avg_ms = gpu_ms;
+  } else {
+    self->avg_ms += (gpu_ms - self->avg_ms) * TB_DYN_RES_SMOOTHING;
+  }
+
+  float scale = self->scale;
+  if (self->avg_ms > self->target_ms) {
+    const float ideal = scale * SDL_sqrtf(self->target_ms / self->avg_ms);
+    scale = SDL_max(ideal, scale * (1.0f - TB_DYN_RES_MAX_STEP_DOWN));
+  } else if (self->avg_ms < self->target_ms * TB_DYN_RES_HEADROOM) {
+    // Aim for the headroom line rather than the budget itself
+    const float budget = self->target_ms * TB_DYN_RES_HEADROOM;
+    const float ideal = scale * SDL_sqrtf(budget / self->avg_ms);
+    scale = SDL_min(ideal, scale * (1.0f + TB_DYN_RES_MAX_STEP_UP));
+  }
+  scale = SDL_clamp(scale, self->min_scale, self->max_scale);
+
+  // Small steps are still taken when they reach the edge of the range, or the
+  // scale could stop just short of it for good
+  const bool at_limit = scale == self->min_scale || scale == self->max_scale;
+  if (scale != self->scale &&
+      (at_limit || SDL_fabsf(scale - self->scale) >= TB_DYN_RES_MIN_STEP)) {
+    // Predict the time at the new scale until fresh samples arrive
+    self->avg_ms *= (scale * scale) / (self->scale * self->scale);
+    self->scale = scale;
+    self->delay = TB_DYN_RES_SETTLE_FRAMES;
+  }
+  return self->scale;
+}
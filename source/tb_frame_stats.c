@@ -0,0 +1,175 @@
+#include "tb_frame_stats.h"
+
+#include "tb_common.h"
+#include "tb_coreui_system.h"
+#include "tb_imgui.h"
+#include "tb_profiling.h"
+#include "tb_world.h"
+
+#include <SDL3/SDL_iostream.h>
+#include <float.h>
+
+#define TB_FRAME_STATS_SYS_PRIO (TB_COREUI_SYS_PRIO + 1)
+
+// Counters before this are reset at the end of every frame
+#define TB_FRAME_STAT_FIRST_LEVEL TB_FRAME_STAT_TMP_BYTES
+
+typedef struct TbFrameStatsSystem {
+  TbAllocator tmp_alloc;
+  bool *ui;
+  bool dump_on_exit;
+} TbFrameStatsSystem;
+ECS_COMPONENT_DECLARE(TbFrameStatsSystem);
+
+static const char *tb_frame_stat_names[TB_FRAME_STAT_COUNT] = {
+    "Draw Calls",      "Triangles",         "Uploads",
+    "Upload Bytes",    "Descriptor Writes", "Tmp Buffer Bytes",
+    "Loads In Flight", "Entities",          "Tables",
+};
+
+// SDL only offers 32-bit atomics and triangle and byte counts can overflow
+// those in a single frame so the compiler builtins are used instead
+static int64_t tb_frame_stats_open[TB_FRAME_STAT_COUNT] = {0};
+
+// Only touched by the main thread
+static TbFrameStatsSample tb_frame_stats_ring[TB_FRAME_STATS_HISTORY] = {0};
+static uint64_t tb_frame_stats_frames = 0;
+
+void tb_register_frame_stats_sys(TbWorld *world);
+void tb_unregister_frame_stats_sys(TbWorld *world);
+
+TB_REGISTER_SYS(tb, frame_stats, TB_FRAME_STATS_SYS_PRIO)
+
+void tb_frame_stat_add(TbFrameStat stat, int64_t value) {
+  __atomic_fetch_add(&tb_frame_stats_open[stat], value, __ATOMIC_RELAXED);
+}
+
+void tb_frame_stat_set(TbFrameStat stat, int64_t value) {
+  __atomic_store_n(&tb_frame_stats_open[stat], value, __ATOMIC_RELAXED);
+}
+
+const char *tb_frame_stat_name(TbFrameStat stat) {
+  return tb_frame_stat_names[stat];
+}
+
+void tb_frame_stats_end_frame(float frame_ms) {
+  TB_TRACY_SCOPEC("End Frame Stats", TracyCategoryColorCore);
+  tb_auto sample =
+      &tb_frame_stats_ring[tb_frame_stats_frames % TB_FRAME_STATS_HISTORY];
+  sample->frame = tb_frame_stats_frames;
+  sample->frame_ms = frame_ms;
+  for (int32_t i = 0; i < TB_FRAME_STAT_COUNT; ++i) {
+    tb_auto value = &tb_frame_stats_open[i];
+    if (i < TB_FRAME_STAT_FIRST_LEVEL) {
+      sample->values[i] = __atomic_exchange_n(value, 0, __ATOMIC_RELAXED);
+    } else {
+      sample->values[i] = __atomic_load_n(value, __ATOMIC_RELAXED);
+    }
+  }
+  tb_frame_stats_frames++;
+}
+
+uint32_t tb_frame_stats_count(void) {
+  return (uint32_t)SDL_min(tb_frame_stats_frames, TB_FRAME_STATS_HISTORY);
+}
+
+const TbFrameStatsSample *tb_frame_stats_get(uint32_t age) {
+  TB_CHECK_RETURN(age < tb_frame_stats_count(), "Frame stat age out of range",
+                  NULL);
+  const uint64_t frame = tb_frame_stats_frames - 1 - age;
+  return &tb_frame_stats_ring[frame % TB_FRAME_STATS_HISTORY];
+}
+
+bool tb_frame_stats_write_csv(const char *path) {
+  TB_TRACY_SCOPE("Write Frame Stats CSV");
+  tb_auto io = SDL_IOFromFile(path, "w");
+  if (!io) {
+    TB_LOG_WARN(SDL_LOG_CATEGORY_APPLICATION,
+                "Failed to open %s to write frame stats: %s", path,
+                SDL_GetError());
+    return false;
+  }
+
+  SDL_IOprintf(io, "frame,frame_ms");
+  for (int32_t i = 0; i < TB_FRAME_STAT_COUNT; ++i) {
+    SDL_IOprintf(io, ",%s", tb_frame_stat_names[i]);
+  }
+  SDL_IOprintf(io, "\n");
+
+  const uint32_t count = tb_frame_stats_count();
+  for (uint32_t age = count; age > 0; --age) {
+    tb_auto sample = tb_frame_stats_get(age - 1);
+    SDL_IOprintf(io, "%" SDL_PRIu64 ",%.3f", sample->frame, sample->frame_ms);
+    for (int32_t i = 0; i < TB_FRAME_STAT_COUNT; ++i) {
+      SDL_IOprintf(io, ",%" SDL_PRIs64, sample->values[i]);
+    }
+    SDL_IOprintf(io, "\n");
+  }
+  return SDL_CloseIO(io);
+}
+
+void frame_stats_ui_tick(ecs_iter_t *it) {
+  TB_TRACY_SCOPEC("Frame Stats UI Tick", TracyCategoryColorUI);
+  tb_auto sys = ecs_field(it, TbFrameStatsSystem, 0);
+  if (!sys->ui || !*sys->ui) {
+    return;
+  }
+
+  if (igBegin("Frame Stats", sys->ui, 0)) {
+    if (igButton("Dump CSV", (ImVec2){0})) {
+      tb_frame_stats_write_csv(TB_FRAME_STATS_DEFAULT_CSV_PATH);
+    }
+    igSameLine(0, 6);
+    igCheckbox("Dump CSV on Exit", &sys->dump_on_exit);
+
+    const uint32_t count = tb_frame_stats_count();
+    if (count > 0) {
+      // Graphs run from the oldest frame on the left to the newest
+      tb_auto values = tb_alloc_nm_tp(sys->tmp_alloc, count, float);
+      char overlay[64] = {0};
+
+      for (uint32_t i = 0; i < count; ++i) {
+        values[i] = tb_frame_stats_get(count - 1 - i)->frame_ms;
+      }
+      SDL_snprintf(overlay, sizeof(overlay), "%.2f ms", values[count - 1]);
+      igPlotLines_FloatPtr("Frame Time", values, (int32_t)count, 0, overlay,
+                           0.0f, FLT_MAX, (ImVec2){0, 40}, sizeof(float));
+
+      for (int32_t stat = 0; stat < TB_FRAME_STAT_COUNT; ++stat) {
+        for (uint32_t i = 0; i < count; ++i) {
+          values[i] = (float)tb_frame_stats_get(count - 1 - i)->values[stat];
+        }
+        SDL_snprintf(overlay, sizeof(overlay), "%" SDL_PRIs64,
+                     tb_frame_stats_get(0)->values[stat]);
+        igPlotLines_FloatPtr(tb_frame_stat_names[stat], values, (int32_t)count,
+                             0, overlay, 0.0f, FLT_MAX, (ImVec2){0, 40},
+                             sizeof(float));
+      }
+    }
+    igEnd();
+  }
+}
+
+void tb_register_frame_stats_sys(TbWorld *world) {
+  TB_TRACY_SCOPE("Register Frame Stats Sys");
+  tb_auto ecs = world->ecs;
+  ECS_COMPONENT_DEFINE(ecs, TbFrameStatsSystem);
+
+  tb_auto coreui = ecs_singleton_ensure(ecs, TbCoreUISystem);
+  tb_auto sys = ecs_singleton_ensure(ecs, TbFrameStatsSystem);
+  *sys = (TbFrameStatsSystem){
+      .tmp_alloc = world->tmp_alloc,
+      .ui = tb_coreui_register_menu(coreui, "Frame Stats"),
+  };
+
+  ECS_SYSTEM(ecs, frame_stats_ui_tick, EcsPostUpdate, TbFrameStatsSystem($));
+}
+
+void tb_unregister_frame_stats_sys(TbWorld *world) {
+  tb_auto ecs = world->ecs;
+  tb_auto sys = ecs_singleton_ensure(ecs, TbFrameStatsSystem);
+  if (sys->dump_on_exit) {
+    tb_frame_stats_write_csv(TB_FRAME_STATS_DEFAULT_CSV_PATH);
+  }
+  ecs_singleton_remove(ecs, TbFrameStatsSystem);
+}
@@ -1,6 +1,7 @@
 #include "tb_fxaa.h"
 
 #include "tb_common.h"
+#include "tb_frame_stats.h"
 #include "tb_imgui.h"
 #include "tb_profiling.h"
 #include "tb_render_pipeline_system.h"
@@ -49,6 +50,7 @@ void record_fxaa(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
   vkCmdPushConstants(buffer, batch->layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0,
                      sizeof(TbFXAAPushConstants), &fxaa_batch->consts);
   vkCmdDraw(buffer, 3, 1, 0, 0);
+  tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, 1);
 
   cmd_end_label(buffer);
   TracyCVkZoneEnd(frame_scope);
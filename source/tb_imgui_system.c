@@ -8,6 +8,7 @@
 #pragma clang diagnostic pop
 
 #include "tb_common.h"
+#include "tb_frame_stats.h"
 #include "tb_imgui.h"
 #include "tb_imgui.slangh"
 #include "tb_input_system.h"
@@ -227,6 +228,7 @@ void imgui_pass_record(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
       vkCmdBindVertexBuffers(buffer, 0, 1, &draw->geom_buffer,
                              &draw->vertex_offset);
       vkCmdDrawIndexed(buffer, draw->index_count, 1, 0, 0, 0);
+      tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, 1);
     }
   }
 
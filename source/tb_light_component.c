@@ -23,6 +23,7 @@ bool tb_load_light_comp(ecs_world_t *ecs, ecs_entity_t ent,
   if (light->type == cgltf_light_type_directional) {
     TbDirectionalLightComponent comp = {
         .color = tb_atof3(light->color),
+        .cascade_count = TB_CASCADE_COUNT,
     };
     for (uint32_t i = 0; i < TB_CASCADE_COUNT; ++i) {
       comp.cascade_views[i] = tb_view_system_create_view(view_sys);
@@ -37,8 +37,9 @@ void light_update_tick(ecs_iter_t *it) {
             .color = light->color,
             .light_dir = dir,
             .cascade_splits = light->cascade_splits,
+            .cascade_count = light->cascade_count,
         };
-        for (uint32_t i = 0; i < TB_CASCADE_COUNT; ++i) {
+        for (uint32_t i = 0; i < light->cascade_count; ++i) {
           const TbView *cascade_view =
               tb_get_view(view_sys, light->cascade_views[i]);
           light_data.cascade_vps[i] = cascade_view->view_data.vp;
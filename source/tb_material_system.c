@@ -3,7 +3,9 @@
 #include "tb_assets.h"
 #include "tb_common.h"
 #include "tb_dyn_desc_pool.h"
+#include "tb_frame_stats.h"
 #include "tb_gltf.h"
+#include "tb_hash.h"
 #include "tb_queue.h"
 #include "tb_scene_material.h"
 #include "tb_task_scheduler.h"
@@ -37,11 +39,18 @@ typedef struct TbMaterialCtx {
   TbDescriptorBuffer desc_buffer;
 
   TB_DYN_ARR_OF(TbMaterialDomainHandler) usage_map;
+
+  ecs_query_t *load_query;
 } TbMaterialCtx;
 ECS_COMPONENT_DECLARE(TbMaterialCtx);
 
 ECS_COMPONENT_DECLARE(TbMaterialComponent);
 
+// How many holders a material that was loaded on behalf of an asset has.
+// Default materials don't have one
+typedef uint32_t TbMaterialRefCount;
+ECS_COMPONENT_DECLARE(TbMaterialRefCount);
+
 // Describes the creation of a material that lives in a GLB file
 typedef struct TbMaterialGLTFLoadRequest {
   const cgltf_data *data;
@@ -51,6 +60,7 @@ ECS_COMPONENT_DECLARE(TbMaterialGLTFLoadRequest);
 
 ECS_TAG_DECLARE(TbMaterialLoaded);
 ECS_TAG_DECLARE(TbMaterialUploaded);
+ECS_TAG_DECLARE(TbMaterialUnreferenced);
 
 // Internals
 
@@ -59,6 +69,7 @@ typedef struct TbMaterialLoadedArgs {
   TbMaterial mat;
   TbMaterialDomain domain;
   TbMaterialData comp;
+  const cgltf_data *data;
 } TbMaterialLoadedArgs;
 
 void tb_material_loaded(const void *args) {
@@ -70,9 +81,12 @@ void tb_material_loaded(const void *args) {
     TB_CHECK(false, "Material load failed. Do we need to retry?");
   }
 
-  loaded_args->domain.load_fn(ecs, loaded_args->comp.domain_data);
+  loaded_args->domain.load_fn(ecs, mat, loaded_args->comp.domain_data);
+  // Any textures the material needs have taken their own references
+  tb_release_glb(loaded_args->data);
 
   SDL_AtomicDecRef(&tb_parallel_mat_load_count);
+  tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, -1);
   ecs_add(ecs, mat, TbMaterialLoaded);
   ecs_set_ptr(ecs, mat, TbMaterialData, &loaded_args->comp);
 }
@@ -142,6 +156,7 @@ void tb_load_gltf_material_task(const void *args) {
       .mat = mat,
       .comp = mat_data,
       .domain = domain,
+      .data = data,
   };
   tb_launch_pinned_task_args(load_args->common.enki,
                              load_args->common.loaded_task, &loaded_args,
@@ -170,19 +185,46 @@ void tb_queue_gltf_mat_loads(ecs_iter_t *it) {
 
   tb_auto enki = *ecs_field(it, TbTaskScheduler, 0);
   tb_auto mat_ctx = ecs_field(it, TbMaterialCtx, 1);
-  tb_auto reqs = ecs_field(it, TbMaterialGLTFLoadRequest, 2);
-  tb_auto usages = ecs_field(it, TbMaterialUsage, 3);
 
-  // TODO: Time slice the time spent creating tasks
-  // Iterate texture load tasks
-  for (int32_t i = 0; i < it->count; ++i) {
-    if (SDL_GetAtomicInt(&tb_parallel_mat_load_count) >
-        TbMaxParallelMaterialLoads) {
-      break;
+  tb_auto rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem);
+  tb_auto tmp_alloc =
+      rnd_sys->render_thread->frame_states[rnd_sys->frame_idx].tmp_alloc.alloc;
+
+  // Every pending load is considered so the most important go out first
+  TbLoadQueue pending = {0};
+  TB_DYN_ARR_RESET(pending, tmp_alloc, 64);
+  tb_auto mat_it = ecs_query_iter(ecs, mat_ctx->load_query);
+  while (ecs_query_next(&mat_it)) {
+    for (int32_t i = 0; i < mat_it.count; ++i) {
+      TbMaterial ent = mat_it.entities[i];
+      TbLoadQueueEntry entry = {
+          .ent = ent,
+          .priority = tb_get_load_priority(ecs, ent),
+          .cancelled = ecs_has(ecs, ent, TbMaterialUnreferenced),
+      };
+      TB_DYN_ARR_APPEND(pending, entry);
     }
-    TbMaterial ent = it->entities[i];
-    tb_auto req = reqs[i];
-    tb_auto usage = usages[i];
+  }
+  const int32_t slot_count =
+      TbMaxParallelMaterialLoads -
+      SDL_GetAtomicInt(&tb_parallel_mat_load_count);
+  tb_auto dispatch = tb_plan_load_dispatch(enki, tmp_alloc, &pending,
+                                           (uint32_t)SDL_max(slot_count, 0));
+
+  // Nothing wants these materials anymore so they don't need to load at all
+  for (uint32_t i = 0; i < dispatch.dropped_count; ++i) {
+    TbMaterial ent = TB_DYN_ARR_AT(pending, dispatch.dropped[i]).ent;
+    tb_auto req = ecs_get(ecs, ent, TbMaterialGLTFLoadRequest);
+    tb_free(tb_global_alloc, (void *)req->name);
+    tb_release_glb(req->data);
+    ecs_delete(ecs, ent);
+  }
+
+  // TODO: Time slice the time spent creating tasks
+  for (uint32_t i = 0; i < dispatch.count; ++i) {
+    TbMaterial ent = TB_DYN_ARR_AT(pending, dispatch.order[i]).ent;
+    tb_auto req = *ecs_get(ecs, ent, TbMaterialGLTFLoadRequest);
+    tb_auto usage = *ecs_get(ecs, ent, TbMaterialUsage);
 
     TbMaterialDomainHandler handler = tb_find_material_domain(mat_ctx, usage);
     if (handler.type_size == 0 || handler.usage == TB_MAT_USAGE_UNKNOWN) {
@@ -210,6 +252,7 @@ void tb_queue_gltf_mat_loads(ecs_iter_t *it) {
     ecs_set(ecs, ent, TbTask, {load_task});
 
     SDL_AtomicIncRef(&tb_parallel_mat_load_count);
+    tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, 1);
     mat_ctx->owned_mat_count++;
 
     // Remove load request as it has now been enqueued to the task system
@@ -314,6 +357,31 @@ void tb_finalize_materials(ecs_iter_t *it) {
   }
 }
 
+void tb_destroy_unreferenced_materials(ecs_iter_t *it) {
+  TB_TRACY_SCOPE("Destroy Unreferenced Materials");
+
+  tb_auto mat_ctx = ecs_field(it, TbMaterialCtx, 0);
+  tb_auto rnd_sys = ecs_field(it, TbRenderSystem, 1);
+  tb_auto materials = ecs_field(it, TbMaterialData, 2);
+  tb_auto mat_indices = ecs_field(it, TbMaterialComponent, 3);
+  tb_auto usages = ecs_field(it, TbMaterialUsage, 4);
+
+  for (int32_t i = 0; i < it->count; ++i) {
+    tb_auto material = &materials[i];
+    tb_auto domain = tb_find_material_domain(mat_ctx, usages[i]).domain;
+    if (domain.unload_fn) {
+      domain.unload_fn(it->world, material->domain_data);
+    }
+    tb_free(tb_global_alloc, material->domain_data);
+
+    // Frames in flight may still read the material
+    tb_rnd_free_gpu_buffer_deferred(rnd_sys, &material->gpu_buffer);
+    tb_release_dyn_desc(&mat_ctx->desc_pool, mat_indices[i]);
+    mat_ctx->owned_mat_count--;
+    ecs_delete(it->world, it->entities[i]);
+  }
+}
+
 void tb_update_material_pool(ecs_iter_t *it) {
   TB_TRACY_SCOPE("Update Material Pool");
   tb_auto mat_ctx = ecs_field(it, TbMaterialCtx, 0);
@@ -333,15 +401,15 @@ void tb_register_material_sys(TbWorld *world) {
   ECS_COMPONENT_DEFINE(ecs, TbMaterialData);
   ECS_COMPONENT_DEFINE(ecs, TbMaterialDomainHandler);
   ECS_COMPONENT_DEFINE(ecs, TbMaterialUsage);
+  ECS_COMPONENT_DEFINE(ecs, TbMaterialRefCount);
   ECS_TAG_DEFINE(ecs, TbMaterialLoaded);
   ECS_TAG_DEFINE(ecs, TbMaterialUploaded);
+  ECS_TAG_DEFINE(ecs, TbMaterialUnreferenced);
 
   tb_auto rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem);
 
-  ECS_SYSTEM(
-      ecs, tb_queue_gltf_mat_loads, EcsPostLoad,
-      TbTaskScheduler(TbTaskScheduler),
-      TbMaterialCtx($), [in] TbMaterialGLTFLoadRequest, [in] TbMaterialUsage);
+  ECS_SYSTEM(ecs, tb_queue_gltf_mat_loads, EcsPostLoad,
+             TbTaskScheduler(TbTaskScheduler), TbMaterialCtx($));
 
   ECS_SYSTEM(ecs, tb_upload_gltf_mats, EcsPreUpdate, TbRenderSystem($),
              TbMaterialCtx($), [in] TbMaterialData, [in] TbMaterialUsage,
@@ -350,10 +418,22 @@ void tb_register_material_sys(TbWorld *world) {
   ECS_SYSTEM(ecs, tb_finalize_materials,
              EcsPostUpdate, [in] TbMaterialCtx($), [in] TbRenderSystem($),
              [in] TbMaterialData, [in] TbMaterialUploaded, !TbDescriptorReady);
+  // Materials that are still loading are destroyed once they finish
+  ECS_SYSTEM(ecs, tb_destroy_unreferenced_materials,
+             EcsPostUpdate, [in] TbMaterialCtx($), [in] TbRenderSystem($),
+             [in] TbMaterialData, [in] TbMaterialComponent,
+             [in] TbMaterialUsage, [in] TbMaterialUnreferenced);
   ECS_SYSTEM(ecs, tb_update_material_pool,
              EcsPreStore, [in] TbMaterialCtx($), [in] TbRenderSystem($));
 
-  TbMaterialCtx ctx = {0};
+  TbMaterialCtx ctx = {
+      .load_query =
+          ecs_query(ecs, {.terms =
+                              {
+                                  {.id = ecs_id(TbMaterialGLTFLoadRequest)},
+                                  {.id = ecs_id(TbMaterialUsage)},
+                              }}),
+  };
 
   SDL_SetAtomicInt(&tb_parallel_mat_load_count, 0);
 
@@ -450,9 +530,12 @@ void tb_unregister_material_sys(TbWorld *world) {
   tb_auto rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem);
   tb_auto ctx = ecs_singleton_ensure(ecs, TbMaterialCtx);
 
+  ecs_query_fini(ctx->load_query);
+
   tb_rnd_destroy_set_layout(rnd_sys, ctx->set_layout);
+  tb_destroy_dyn_desc_pool(rnd_sys, &ctx->desc_pool);
 
-#if TB_DESC_BUFFER == 1
+#if TB_USE_DESC_BUFFER == 1
   tb_destroy_descriptor_buffer(rnd_sys, &ctx->desc_buffer);
 #endif
 
@@ -460,8 +543,6 @@ void tb_unregister_material_sys(TbWorld *world) {
 
   // TODO: Check for leaks
 
-  // TODO: Clean up descriptor pool
-
   ecs_singleton_remove(ecs, TbMaterialCtx);
 }
 
@@ -547,27 +628,48 @@ exists or not. So the calling system *must* be immediate and we will have to
   looking at the correct version of the ECS state when trying to determine if
 an entity for a material already exists
   */
+  if (data == NULL) {
+    TB_CHECK(false, "Expected data");
+    return 0;
+  }
+
+  // Materials are keyed by content rather than by name so that the same
+  // material in several glbs is only loaded once
+  const cgltf_material *material = NULL;
+  for (cgltf_size i = 0; i < data->materials_count; ++i) {
+    if (SDL_strcmp(name, data->materials[i].name) == 0) {
+      material = &data->materials[i];
+      break;
+    }
+  }
+  TB_CHECK_RETURN(material, "Failed to find material by name", 0);
+  TbAssetHash hash = tb_glb_material_hash(data, material);
+  hash.hash = tb_hash(hash.hash, (const uint8_t *)&usage, sizeof(usage));
+  char mat_name[32] = {0};
+  SDL_snprintf(mat_name, sizeof(mat_name), "mat_%016" SDL_PRIx64, hash.hash);
+
   bool deferred = false;
   if (ecs_is_deferred(ecs)) {
     deferred = ecs_defer_end(ecs);
   }
-  // If an entity already exists with this name it is either loading or loaded
-  TbMaterial mat_ent = ecs_lookup_child(ecs, ecs_id(TbMaterialCtx), name);
+  // If an entity already exists with this hash it is either loading or loaded
+  TbMaterial mat_ent = ecs_lookup_child(ecs, ecs_id(TbMaterialCtx), mat_name);
   if (mat_ent != 0) {
+    tb_auto ref_count = ecs_get_mut(ecs, mat_ent, TbMaterialRefCount);
+    if (ref_count) {
+      (*ref_count)++;
+      ecs_remove(ecs, mat_ent, TbMaterialUnreferenced);
+    }
+    tb_gltf_count_reuse(hash.size);
     if (deferred) {
       ecs_defer_begin(ecs);
     }
     return mat_ent;
   }
 
-  if (data == NULL) {
-    TB_CHECK(false, "Expected data");
-    return 0;
-  }
-
   // Create a material entity
   mat_ent = ecs_new(ecs);
-  ecs_set_name(ecs, mat_ent, name);
+  ecs_set_name(ecs, mat_ent, mat_name);
 
   // It is a child of the texture system context singleton
   ecs_add_pair(ecs, mat_ent, EcsChildOf, ecs_id(TbMaterialCtx));
@@ -578,9 +680,12 @@ an entity for a material already exists
   char *name_cpy = tb_alloc_nm_tp(tb_global_alloc, name_len, char);
   SDL_strlcpy(name_cpy, name, name_len);
 
-  // Append a texture load request onto the entity to schedule loading
+  // Append a texture load request onto the entity to schedule loading.
+  // The glb is released once the material has been loaded
+  tb_acquire_glb(data);
   ecs_set(ecs, mat_ent, TbMaterialGLTFLoadRequest, {data, name_cpy});
   ecs_set(ecs, mat_ent, TbMaterialUsage, {usage});
+  ecs_set(ecs, mat_ent, TbMaterialRefCount, {1});
   ecs_remove(ecs, mat_ent, TbDescriptorReady);
 
   if (deferred) {
@@ -590,6 +695,22 @@ an entity for a material already exists
   return mat_ent;
 }
 
+void tb_mat_sys_release_mat_ref(ecs_world_t *ecs, TbMaterial mat) {
+  tb_auto ref_count = ecs_get_mut(ecs, mat, TbMaterialRefCount);
+  if (ref_count == NULL) {
+    return;
+  }
+  if (*ref_count == 0) {
+    TB_CHECK(false, "Trying to release reference to material that has no "
+                    "reference holders");
+    return;
+  }
+  (*ref_count)--;
+  if (*ref_count == 0) {
+    ecs_add(ecs, mat, TbMaterialUnreferenced);
+  }
+}
+
 bool tb_is_material_ready(ecs_world_t *ecs, TbMaterial mat_ent) {
   return ecs_has(ecs, mat_ent, TbMaterialUploaded) &&
          ecs_has(ecs, mat_ent, TbMaterialComponent) &&
@@ -605,6 +726,21 @@ bool tb_is_mat_transparent(ecs_world_t *ecs, TbMaterial mat_ent) {
   return handler.domain.is_trans_fn(data);
 }
 
+void tb_mat_sys_report_screen_size(ecs_world_t *ecs, TbMaterial mat_ent,
+                                   float screen_size) {
+  tb_auto ctx = ecs_singleton_get(ecs, TbMaterialCtx);
+  tb_auto data = ecs_get(ecs, mat_ent, TbMaterialData);
+  tb_auto usage = ecs_get(ecs, mat_ent, TbMaterialUsage);
+  if (!data || !usage) {
+    return;
+  }
+
+  tb_auto handler = tb_find_material_domain(ctx, *usage);
+  if (handler.domain.usage_fn) {
+    handler.domain.usage_fn(ecs, data->domain_data, screen_size);
+  }
+}
+
 TbMaterial tb_get_default_mat(ecs_world_t *ecs, TbMaterialUsage usage) {
   tb_auto ctx = ecs_singleton_get(ecs, TbMaterialCtx);
   TB_DYN_ARR_FOREACH(ctx->usage_map, i) {
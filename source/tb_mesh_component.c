@@ -19,6 +19,7 @@ ECS_COMPONENT_DECLARE(TbMeshComponent);
 bool tb_load_mesh_comp(ecs_world_t *ecs, ecs_entity_t ent,
                        const char *source_path, const cgltf_data *data,
                        const cgltf_node *node, json_object *json) {
+  (void)source_path;
   (void)json;
   TB_TRACY_SCOPE("Load Mesh Component");
 
@@ -34,12 +35,8 @@ bool tb_load_mesh_comp(ecs_world_t *ecs, ecs_entity_t ent,
 
   // We don't reserve here because we're expecting
   // all meshes to already be loading
-  const uint32_t max_name_len = 256;
-  char name[max_name_len] = {0};
-  SDL_snprintf(name, max_name_len, "mesh_%d", mesh_idx);
   TbMeshComponent comp = {
-      .mesh2 = tb_mesh_sys_load_gltf_mesh(ecs, (cgltf_data *)data, source_path,
-                                          name, mesh_idx),
+      .mesh2 = tb_mesh_sys_load_gltf_mesh(ecs, (cgltf_data *)data, mesh_idx),
   };
   ecs_set_ptr(ecs, ent, TbMeshComponent, &comp);
   tb_mark_as_render_object(ecs, ent);
@@ -47,9 +44,25 @@ bool tb_load_mesh_comp(ecs_world_t *ecs, ecs_entity_t ent,
   return true;
 }
 
+// Each mesh component holds a reference to its mesh
+static void tb_on_mesh_comp_remove(ecs_iter_t *it) {
+  tb_auto comps = ecs_field(it, TbMeshComponent, 0);
+  for (int32_t i = 0; i < it->count; ++i) {
+    tb_auto mesh = comps[i].mesh2;
+    // The mesh may already be gone when the whole world is torn down
+    if (mesh != 0 && ecs_is_alive(it->world, mesh)) {
+      tb_mesh_sys_release_mesh_ref(it->world, mesh);
+    }
+  }
+}
+
 TbComponentRegisterResult tb_register_mesh_comp(TbWorld *world) {
   tb_auto ecs = world->ecs;
   ECS_COMPONENT_DEFINE(ecs, TbMeshComponent);
+  ecs_set_hooks(ecs, TbMeshComponent,
+                {
+                    .on_remove = tb_on_mesh_comp_remove,
+                });
   return (TbComponentRegisterResult){ecs_id(TbMeshComponent), 0};
 }
 
@@ -0,0 +1,249 @@
+#include "tb_mesh_draws.h"
+
+#include "tb_common.h"
+
+static const TbMeshDrawRecord TbFreeMeshDrawRecord = {
+    .next = TB_MESH_DRAW_SLOT_NONE,
+    .mat_prev = TB_MESH_DRAW_SLOT_NONE,
+    .mat_next = TB_MESH_DRAW_SLOT_NONE,
+};
+
+// Index of the first entry whose material is not less than mat
+static uint32_t tb_lower_bound_mesh_draw_material(const TbMeshDraws *draws,
+                                                  TbMaterial mat) {
+  uint32_t lo = 0;
+  uint32_t hi = TB_DYN_ARR_SIZE(draws->materials);
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    if (TB_DYN_ARR_AT(draws->materials, mid).material < mat) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static void tb_link_mesh_draw_material(TbMeshDraws *draws, uint32_t slot) {
+  tb_auto record = &draws->records[slot];
+  const uint32_t idx =
+      tb_lower_bound_mesh_draw_material(draws, record->material);
+  const uint32_t count = TB_DYN_ARR_SIZE(draws->materials);
+  if (idx == count ||
+      TB_DYN_ARR_AT(draws->materials, idx).material != record->material) {
+    TB_DYN_ARR_APPEND(draws->materials, (TbMeshDrawMaterial){0});
+    tb_auto entries = draws->materials.data;
+    SDL_memmove(&entries[idx + 1], &entries[idx],
+                (count - idx) * sizeof(TbMeshDrawMaterial));
+    entries[idx] = (TbMeshDrawMaterial){
+        .material = record->material,
+        .head = TB_MESH_DRAW_SLOT_NONE,
+    };
+  }
+  tb_auto entry = &TB_DYN_ARR_AT(draws->materials, idx);
+  record->mat_prev = TB_MESH_DRAW_SLOT_NONE;
+  record->mat_next = entry->head;
+  if (entry->head != TB_MESH_DRAW_SLOT_NONE) {
+    draws->records[entry->head].mat_prev = slot;
+  }
+  entry->head = slot;
+}
+
+static void tb_unlink_mesh_draw_material(TbMeshDraws *draws, uint32_t slot) {
+  tb_auto record = &draws->records[slot];
+  if (record->mat_next != TB_MESH_DRAW_SLOT_NONE) {
+    draws->records[record->mat_next].mat_prev = record->mat_prev;
+  }
+  if (record->mat_prev != TB_MESH_DRAW_SLOT_NONE) {
+    draws->records[record->mat_prev].mat_next = record->mat_next;
+    return;
+  }
+
+  // Was the head of its material's chain
+  const uint32_t idx =
+      tb_lower_bound_mesh_draw_material(draws, record->material);
+  tb_auto entry = &TB_DYN_ARR_AT(draws->materials, idx);
+  TB_CHECK(entry->head == slot, "Mesh draw material index is corrupt");
+  entry->head = record->mat_next;
+  if (entry->head == TB_MESH_DRAW_SLOT_NONE) {
+    const uint32_t count = TB_DYN_ARR_SIZE(draws->materials);
+    tb_auto entries = draws->materials.data;
+    SDL_memmove(&entries[idx], &entries[idx + 1],
+                (count - idx - 1) * sizeof(TbMeshDrawMaterial));
+    TB_DYN_ARR_POP(draws->materials);
+  }
+}
+
+void tb_create_mesh_draws(TbAllocator alloc, uint32_t capacity,
+                          TbMeshDraws *draws) {
+  *draws = (TbMeshDraws){
+      .alloc = alloc,
+      .capacity = capacity,
+  };
+  tb_reset_free_list(alloc, &draws->free_slots, capacity);
+  TB_DYN_ARR_RESET(draws->materials, alloc, 64);
+  draws->records = tb_alloc_nm_tp(alloc, capacity, TbMeshDrawRecord);
+  for (uint32_t slot = 0; slot < capacity; ++slot) {
+    draws->records[slot] = TbFreeMeshDrawRecord;
+  }
+  tb_clear_mesh_draws_dirty(draws);
+}
+
+void tb_destroy_mesh_draws(TbMeshDraws *draws) {
+  tb_free(draws->alloc, draws->records);
+  TB_DYN_ARR_DESTROY(draws->materials);
+  tb_destroy_free_list(&draws->free_slots);
+  *draws = (TbMeshDraws){0};
+}
+
+void tb_reserve_mesh_draws(TbMeshDraws *draws, uint32_t count) {
+  const uint32_t free_count = TB_DYN_ARR_SIZE(draws->free_slots);
+  if (free_count >= count) {
+    return;
+  }
+  TB_TRACY_SCOPE("Grow Mesh Draws");
+  const uint32_t prev_cap = draws->capacity;
+  const uint32_t cap = SDL_max(prev_cap * 2, prev_cap + count - free_count);
+
+  draws->records =
+      tb_realloc_nm_tp(draws->alloc, draws->records, cap, TbMeshDrawRecord);
+  for (uint32_t slot = prev_cap; slot < cap; ++slot) {
+    draws->records[slot] = TbFreeMeshDrawRecord;
+  }
+
+  // Reverse iter so the new slots are handed out from the lowest. Slots that
+  // were already free go on top so they are reused first
+  TbFreeList free_slots = {0};
+  TB_DYN_ARR_RESET(free_slots, draws->alloc, cap);
+  for (int32_t slot = (int32_t)cap - 1; slot >= (int32_t)prev_cap; --slot) {
+    TB_DYN_ARR_APPEND(free_slots, (uint32_t)slot);
+  }
+  TB_DYN_ARR_FOREACH(draws->free_slots, i) {
+    TB_DYN_ARR_APPEND(free_slots, TB_DYN_ARR_AT(draws->free_slots, i));
+  }
+  tb_destroy_free_list(&draws->free_slots);
+  draws->free_slots = free_slots;
+  draws->capacity = cap;
+}
+
+uint32_t tb_add_mesh_draw(TbMeshDraws *draws, ecs_entity_t owner,
+                          TbMeshDrawSlots *slots,
+                          const TbMeshDrawRecord *record) {
+  if (TB_DYN_ARR_EMPTY(draws->free_slots)) {
+    TB_CHECK(false, "Mesh draw slots were not reserved");
+    return TB_MESH_DRAW_SLOT_NONE;
+  }
+  uint32_t slot = 0;
+  tb_pull_index(&draws->free_slots, &slot);
+  tb_auto dst = &draws->records[slot];
+  *dst = *record;
+  dst->owner = owner;
+  dst->next = slots->head;
+  slots->head = slot;
+  slots->count++;
+  tb_link_mesh_draw_material(draws, slot);
+
+  draws->dirty_min = SDL_min(draws->dirty_min, slot);
+  draws->dirty_max = SDL_max(draws->dirty_max, slot);
+  draws->slot_count = SDL_max(draws->slot_count, slot + 1);
+  return slot;
+}
+
+void tb_free_mesh_draws(TbMeshDraws *draws, const TbMeshDrawSlots *slots) {
+  uint32_t slot = slots->head;
+  for (uint32_t i = 0; i < slots->count; ++i) {
+    tb_auto record = &draws->records[slot];
+    const uint32_t next = record->next;
+    tb_unlink_mesh_draw_material(draws, slot);
+    *record = TbFreeMeshDrawRecord;
+    tb_return_index(&draws->free_slots, slot);
+    slot = next;
+  }
+}
+
+uint32_t tb_mesh_draws_material_head(const TbMeshDraws *draws, TbMaterial mat) {
+  const uint32_t idx = tb_lower_bound_mesh_draw_material(draws, mat);
+  if (idx == TB_DYN_ARR_SIZE(draws->materials) ||
+      TB_DYN_ARR_AT(draws->materials, idx).material != mat) {
+    return TB_MESH_DRAW_SLOT_NONE;
+  }
+  return TB_DYN_ARR_AT(draws->materials, idx).head;
+}
+
+void tb_clear_mesh_draws_dirty(TbMeshDraws *draws) {
+  draws->dirty_min = SDL_MAX_UINT32;
+  draws->dirty_max = 0;
+}
+
+float tb_mesh_max_scale(const float4x4 *m) {
+  return SDL_max(tb_magf3(m->cols[0].xyz),
+                 SDL_max(tb_magf3(m->cols[1].xyz), tb_magf3(m->cols[2].xyz)));
+}
+
+TbAABB tb_mesh_world_bounds(const float4x4 *m, TbAABB local) {
+  // Transform the center and project the extents onto each world axis
+  const float3 center = (local.min + local.max) * 0.5f;
+  const float3 extent = (local.max - local.min) * 0.5f;
+  const float3 world_center =
+      tb_f4tof3(tb_mulf44f4(*m, tb_f3tof4(center, 1.0f)));
+  float3 world_extent = {0};
+  for (uint32_t i = 0; i < 3; ++i) {
+    const float3 axis = m->cols[i].xyz;
+    world_extent += (float3){SDL_fabsf(axis.x), SDL_fabsf(axis.y),
+                             SDL_fabsf(axis.z)} *
+                    extent[i];
+  }
+  return (TbAABB){
+      .min = world_center - world_extent,
+      .max = world_center + world_extent,
+  };
+}
+
+TbMeshVisibleDraws tb_cull_mesh_draws(const TbMeshDraws *draws,
+                                      TbAllocator alloc,
+                                      TbMeshDrawWorldFn get_world, void *ctx,
+                                      uint32_t view_count,
+                                      const TbMeshCullView *views) {
+  TB_TRACY_SCOPE("Cull Mesh Draws");
+  const uint32_t max_draw_count = draws->slot_count;
+  TbMeshVisibleDraws vis = {
+      .slots = tb_alloc_nm_tp(alloc, max_draw_count, uint32_t),
+      .masks = tb_alloc_nm_tp(alloc, max_draw_count, uint64_t),
+      .centers = tb_alloc_nm_tp(alloc, max_draw_count, float3),
+      .scales = tb_alloc_nm_tp(alloc, max_draw_count, float),
+  };
+
+  // Slots of an instance are usually adjacent so cache the last transform
+  ecs_entity_t last_owner = 0;
+  float4x4 world = {.col0 = {0}};
+  float scale = 1.0f;
+  for (uint32_t slot = 0; slot < max_draw_count; ++slot) {
+    tb_auto record = &draws->records[slot];
+    if (record->owner == 0) {
+      continue;
+    }
+    if (record->owner != last_owner) {
+      world = get_world(ctx, record->owner);
+      scale = tb_mesh_max_scale(&world);
+      last_owner = record->owner;
+    }
+
+    tb_auto bounds = tb_mesh_world_bounds(&world, record->bounds);
+    uint64_t mask = 0;
+    for (uint32_t view_idx = 0; view_idx < view_count; ++view_idx) {
+      if (tb_frustum_test_aabb(&views[view_idx].frustum, &bounds)) {
+        mask |= 1ull << view_idx;
+      }
+    }
+    if (mask == 0) {
+      continue;
+    }
+
+    vis.slots[vis.count] = slot;
+    vis.masks[vis.count] = mask;
+    vis.centers[vis.count] = (bounds.min + bounds.max) * 0.5f;
+    vis.scales[vis.count] = scale;
+    vis.count++;
+  }
+  return vis;
+}
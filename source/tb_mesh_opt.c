@@ -0,0 +1,135 @@
+#include "tb_mesh_opt.h"
+
+#include "tb_common.h"
+
+#include <meshoptimizer.h>
+
+TbPrimLods tb_build_lods(const TbPrimGeometry *geom) {
+  TB_TRACY_SCOPE("Build LODs");
+  TbPrimLods result = {0};
+  if (geom->index_count / 3 < TB_MESH_LOD_MIN_TRIANGLES) {
+    return result;
+  }
+
+  const size_t vertex_stride = sizeof(float) * 3;
+  // Simplification errors are relative to the mesh extents
+  const float error_scale = meshopt_simplifyScale(
+      geom->positions, geom->vertex_count, vertex_stride);
+
+  result.lods.lods[0] = (TbMeshLod){.index_count = geom->index_count};
+  result.lods.count = 1;
+
+  size_t prev_count = geom->index_count;
+  float prev_error = 0.0f;
+  for (uint32_t lod = 1; lod < TB_MESH_MAX_LODS; ++lod) {
+    const size_t target_count = (prev_count / 2) / 3 * 3;
+    tb_auto lod_indices =
+        tb_alloc_nm_tp(tb_thread_alloc, geom->index_count, uint32_t);
+    float error = 0.0f;
+    const size_t lod_count = meshopt_simplify(
+        lod_indices, geom->indices, geom->index_count, geom->positions,
+        geom->vertex_count, vertex_stride, target_count,
+        TB_MESH_LOD_TARGET_ERROR, 0, &error);
+
+    // Stop once the simplifier can't make meaningful progress
+    if (lod_count == 0 || lod_count > prev_count * 9 / 10) {
+      tb_free(tb_thread_alloc, lod_indices);
+      break;
+    }
+
+    // Keep errors monotonic so selection can stop at the first coarse LOD
+    prev_error = SDL_max(prev_error, error * error_scale);
+    result.lods.lods[lod] = (TbMeshLod){
+        .index_count = lod_count,
+        .error = prev_error,
+    };
+    result.indices[lod] = lod_indices;
+    result.lods.count++;
+    prev_count = lod_count;
+  }
+
+  // A chain with only LOD 0 isn't worth selecting between
+  if (result.lods.count == 1) {
+    result.lods.count = 0;
+  }
+  return result;
+}
+
+void tb_free_lods(TbPrimLods *lods) {
+  for (uint32_t lod = 1; lod < TB_MESH_MAX_LODS; ++lod) {
+    if (lods->indices[lod]) {
+      tb_free(tb_thread_alloc, lods->indices[lod]);
+    }
+  }
+  *lods = (TbPrimLods){0};
+}
+
+TbSubMeshMeshlets tb_build_meshlets(const TbPrimGeometry *geom,
+                                    bool double_sided, uint32_t *dst) {
+  TB_TRACY_SCOPE("Build Meshlets");
+  TbSubMeshMeshlets result = {0};
+
+  const size_t index_count = geom->index_count;
+  if (index_count / 3 < TB_MESHLET_MIN_TRIANGLES) {
+    return result;
+  }
+  const size_t vertex_count = geom->vertex_count;
+  const size_t vertex_stride = sizeof(float) * 3;
+
+  const size_t max_meshlets = meshopt_buildMeshletsBound(
+      index_count, TB_MESHLET_MAX_VERTICES, TB_MESHLET_MAX_TRIANGLES);
+  tb_auto meshlets =
+      tb_alloc_nm_tp(tb_thread_alloc, max_meshlets, meshopt_Meshlet);
+  tb_auto meshlet_verts = tb_alloc_nm_tp(
+      tb_thread_alloc, max_meshlets * TB_MESHLET_MAX_VERTICES, uint32_t);
+  tb_auto meshlet_tris = tb_alloc_nm_tp(
+      tb_thread_alloc, max_meshlets * TB_MESHLET_MAX_TRIANGLES * 3, uint8_t);
+
+  const size_t meshlet_count = meshopt_buildMeshlets(
+      meshlets, meshlet_verts, meshlet_tris, geom->indices, index_count,
+      geom->positions, vertex_count, vertex_stride, TB_MESHLET_MAX_VERTICES,
+      TB_MESHLET_MAX_TRIANGLES, TB_MESHLET_CONE_WEIGHT);
+
+  tb_auto out = tb_alloc_nm_tp(tb_global_alloc, meshlet_count, TbMeshlet);
+  uint32_t index_offset = 0;
+  for (size_t i = 0; i < meshlet_count; ++i) {
+    tb_auto m = &meshlets[i];
+    const uint32_t *m_verts = &meshlet_verts[m->vertex_offset];
+    const uint8_t *m_tris = &meshlet_tris[m->triangle_offset];
+
+    // Expand the meshlet's local triangles back into the submesh's indices
+    const uint32_t m_index_count = m->triangle_count * 3;
+    for (uint32_t t = 0; t < m_index_count; ++t) {
+      dst[index_offset + t] = m_verts[m_tris[t]];
+    }
+
+    tb_auto bounds = meshopt_computeMeshletBounds(
+        m_verts, m_tris, m->triangle_count, geom->positions, vertex_count,
+        vertex_stride);
+    const float *apex = bounds.cone_apex;
+    const float *axis = bounds.cone_axis;
+    out[i] = (TbMeshlet){
+        .center = tb_f3(bounds.center[0], bounds.center[1], bounds.center[2]),
+        .radius = bounds.radius,
+        .cone_apex = tb_f3(apex[0], apex[1], apex[2]),
+        .cone_axis = tb_f3(axis[0], axis[1], axis[2]),
+        // Back faces of double sided materials are visible so a cutoff
+        // above 1 turns the normal cone test off for their meshlets
+        .cone_cutoff = double_sided ? 2.0f : bounds.cone_cutoff,
+        .index_offset = index_offset,
+        .index_count = m_index_count,
+    };
+    index_offset += m_index_count;
+  }
+  TB_CHECK(index_offset == index_count, "Meshlets did not cover every index");
+
+  tb_free(tb_thread_alloc, meshlet_tris);
+  tb_free(tb_thread_alloc, meshlet_verts);
+  tb_free(tb_thread_alloc, meshlets);
+
+  result = (TbSubMeshMeshlets){
+      .count = meshlet_count,
+      .meshlets = out,
+  };
+  return result;
+}
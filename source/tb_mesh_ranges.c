@@ -0,0 +1,65 @@
+#include "tb_mesh_ranges.h"
+
+#include "tb_common.h"
+
+void tb_create_mesh_ranges(TbAllocator alloc, uint32_t max_indices,
+                           uint32_t max_vertices, uint32_t max_allocs,
+                           TbMeshRanges *ranges) {
+  *ranges = (TbMeshRanges){0};
+  tb_create_offset_allocator(alloc, max_indices, max_allocs,
+                             &ranges->indices);
+  tb_create_offset_allocator(alloc, max_vertices, max_allocs,
+                             &ranges->vertices);
+  TB_DYN_ARR_RESET(ranges->released, alloc, 8);
+  for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
+    TB_DYN_ARR_RESET(ranges->pending[i], alloc, 8);
+  }
+}
+
+void tb_destroy_mesh_ranges(TbMeshRanges *ranges) {
+  tb_destroy_offset_allocator(&ranges->indices);
+  tb_destroy_offset_allocator(&ranges->vertices);
+  TB_DYN_ARR_DESTROY(ranges->released);
+  for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
+    TB_DYN_ARR_DESTROY(ranges->pending[i]);
+  }
+  *ranges = (TbMeshRanges){0};
+}
+
+bool tb_alloc_mesh_range(TbMeshRanges *ranges, uint32_t index_count,
+                         uint32_t vertex_count, TbMeshArenaRange *range) {
+  range->index_alloc = tb_offset_alloc(&ranges->indices, index_count);
+  range->vertex_alloc = tb_offset_alloc(&ranges->vertices, vertex_count);
+  const bool ok = range->index_alloc.offset != TB_OFFSET_ALLOC_NO_SPACE &&
+                  range->vertex_alloc.offset != TB_OFFSET_ALLOC_NO_SPACE;
+  if (!ok) {
+    tb_offset_free(&ranges->indices, range->index_alloc);
+    tb_offset_free(&ranges->vertices, range->vertex_alloc);
+    range->index_alloc = (TbOffsetAllocation){
+        .offset = TB_OFFSET_ALLOC_NO_SPACE,
+        .node = TB_OFFSET_ALLOC_NO_SPACE,
+    };
+    range->vertex_alloc = range->index_alloc;
+  }
+  return ok;
+}
+
+void tb_release_mesh_range(TbMeshRanges *ranges, TbMeshArenaRange range) {
+  TB_DYN_ARR_APPEND(ranges->released, range);
+}
+
+void tb_recycle_mesh_ranges(TbMeshRanges *ranges, uint32_t frame_idx) {
+  // The last time this frame state was used is done on the GPU so ranges
+  // released before then can be handed out again
+  tb_auto pending = &ranges->pending[frame_idx];
+  TB_DYN_ARR_FOREACH(*pending, i) {
+    tb_auto range = &TB_DYN_ARR_AT(*pending, i);
+    tb_offset_free(&ranges->indices, range->index_alloc);
+    tb_offset_free(&ranges->vertices, range->vertex_alloc);
+  }
+  TB_DYN_ARR_CLEAR(*pending);
+  TB_DYN_ARR_FOREACH(ranges->released, i) {
+    TB_DYN_ARR_APPEND(*pending, TB_DYN_ARR_AT(ranges->released, i));
+  }
+  TB_DYN_ARR_CLEAR(ranges->released);
+}
@@ -3,19 +3,24 @@
 #include "cgltf.h"
 #include "tb_camera_component.h"
 #include "tb_common.slangh"
+#include "tb_frame_stats.h"
 #include "tb_gltf.h"
 #include "tb_gltf.slangh"
 #include "tb_hash.h"
 #include "tb_light_component.h"
 #include "tb_material_system.h"
 #include "tb_mesh_component.h"
+#include "tb_mesh_draws.h"
 #include "tb_mesh_system.h"
 #include "tb_profiling.h"
 #include "tb_render_object_system.h"
 #include "tb_render_pipeline_system.h"
 #include "tb_render_system.h"
 #include "tb_render_target_system.h"
+#include "tb_settings.h"
 #include "tb_shader_system.h"
+#include "tb_sort.h"
+#include "tb_task_scheduler.h"
 #include "tb_texture_system.h"
 #include "tb_transform_component.h"
 #include "tb_util.h"
@@ -51,6 +56,12 @@ typedef struct TbMesh {
 // Helper macro to auto-register system
 TB_REGISTER_SYS(tb, mesh, TB_MESH_RND_SYS_PRIO)
 
+// Configuration
+// Draw slots are added in bulk as scenes need more
+static const uint32_t TbInitialMeshDraws = 1 << 14; // 16384
+
+ECS_COMPONENT_DECLARE(TbMeshDrawSlots);
+
 typedef struct TbMeshShaderArgs {
   TbRenderSystem *rnd_sys;
   VkFormat depth_format;
@@ -521,6 +532,7 @@ void prepass_record(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
       TB_TRACY_SCOPEC("Record Indirect Draw", TracyCategoryColorRendering);
       vkCmdDrawIndirect(buffer, draw->buffer, draw->offset, draw->draw_count,
                         draw->stride);
+      tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, draw->draw_count);
     }
 
     cmd_end_label(buffer);
@@ -585,6 +597,7 @@ void mesh_record_common(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
       tb_auto draw = &((const TbIndirectDraw *)batch->draws)[draw_idx];
       vkCmdDrawIndirect(buffer, draw->buffer, draw->offset, draw->draw_count,
                         draw->stride);
+      tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, draw->draw_count);
     }
 
     cmd_end_label(buffer);
@@ -613,6 +626,47 @@ void transparent_pass_record(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
   TracyCVkZoneEnd(frame_scope);
 }
 
+// Sizes the GPU copy of the draw records to match the pool. Live records are
+// written to the new buffer and the previous one is freed once no frame in
+// flight can read from it
+static void tb_resize_mesh_draw_buffer(TbMeshSystem *mesh_sys) {
+  TB_TRACY_SCOPE("Resize Mesh Draw Buffer");
+  tb_auto rnd_sys = mesh_sys->rnd_sys;
+  tb_auto draws = &mesh_sys->draws;
+  const TbBuffer prev_buffer = mesh_sys->draw_buffer;
+  const TbHostBuffer prev_host = mesh_sys->draw_host;
+  mesh_sys->draw_host = (TbHostBuffer){0};
+
+  VkBufferCreateInfo create_info = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .size = sizeof(TbGLTFDrawData) * draws->capacity,
+      .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+               VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+               VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+  };
+  TbGLTFDrawData *write_ptr = NULL;
+  tb_rnd_sys_create_gpu_buffer(rnd_sys, &create_info, "Mesh Draw Buffer",
+                               &mesh_sys->draw_buffer, &mesh_sys->draw_host,
+                               (void **)&write_ptr);
+  // Free slots are never drawn so they are left as they are
+  for (uint32_t slot = 0; slot < draws->slot_count; ++slot) {
+    tb_auto record = &draws->records[slot];
+    if (record->owner != 0) {
+      write_ptr[slot] = record->data;
+    }
+  }
+  mesh_sys->draw_buffer_cap = draws->capacity;
+  tb_clear_mesh_draws_dirty(draws);
+
+  if (prev_buffer.buffer != VK_NULL_HANDLE) {
+    tb_rnd_free_gpu_buffer_deferred(rnd_sys, &prev_buffer);
+  }
+  if (prev_host.buffer != VK_NULL_HANDLE) {
+    tb_rnd_free_host_buffer_deferred(rnd_sys, &prev_host);
+  }
+}
+
 TbMeshSystem create_mesh_system_internal(ecs_world_t *ecs, TbAllocator gp_alloc,
                                          TbAllocator tmp_alloc,
                                          TbRenderSystem *rnd_sys,
@@ -765,6 +819,12 @@ TbMeshSystem create_mesh_system_internal(ecs_world_t *ecs, TbAllocator gp_alloc,
     }
   }
 
+  // Persistent draw records
+  {
+    tb_create_mesh_draws(gp_alloc, TbInitialMeshDraws, &sys.draws);
+    tb_resize_mesh_draw_buffer(&sys);
+  }
+
 #if TB_USE_DESC_BUFFER == 1
   // Create descriptor buffers for opaque and transparent draws
   tb_create_descriptor_buffer(rnd_sys, sys.draw_set_layout,
@@ -809,6 +869,9 @@ void destroy_mesh_system(ecs_world_t *ecs, TbMeshSystem *self) {
   tb_destroy_descriptor_buffer(rnd_sys, &self->opaque_draw_descs);
   tb_destroy_descriptor_buffer(rnd_sys, &self->trans_draw_descs);
 
+  tb_rnd_free_gpu_buffer(rnd_sys, &self->draw_buffer);
+  tb_destroy_mesh_draws(&self->draws);
+
   TB_DYN_ARR_FOREACH(self->meshes, i) {
     if (TB_DYN_ARR_AT(self->meshes, i).ref_count != 0) {
       TB_CHECK(false, "Leaking meshes");
@@ -820,6 +883,380 @@ void destroy_mesh_system(ecs_world_t *ecs, TbMeshSystem *self) {
   *self = (TbMeshSystem){0};
 }
 
+// A sort key packs the pass into the top byte so that a single sort groups all
+// opaque draws before all transparent draws. Opaque draws are then grouped by
+// material and ordered front to back within a material to help early-z.
+// Transparent draws must blend back to front so depth takes priority there.
+// Byte 0 is always zero so the radix sort skips that digit pass.
+#define TB_MESH_DRAW_KEY_PASS_SHIFT 56
+#define TB_MESH_DRAW_KEY_HI_SHIFT 32
+#define TB_MESH_DRAW_KEY_LO_SHIFT 8
+#define TB_MESH_DRAW_KEY_FIELD_MASK 0xFFFFFF
+
+// A LOD is used when its error covers at most this many pixels before bias
+#define TB_MESH_LOD_PIXEL_ERROR 1.0f
+// Keeps the projected error finite when the camera is inside a draw's bounds
+#define TB_MESH_LOD_MIN_DISTANCE 0.01f
+
+// Positive bias favours coarser LODs, each step doubling the allowed error
+static float tb_mesh_lod_bias(ecs_world_t *ecs) {
+  tb_auto settings = ecs_singleton_get(ecs, TbSettings);
+  return settings ? settings->lod_bias : 0.0f;
+}
+
+typedef enum TbMeshDrawPass {
+  TbMeshDrawPassOpaque = 0,
+  TbMeshDrawPassTransparent = 1,
+} TbMeshDrawPass;
+
+static uint64_t tb_mesh_draw_sort_key(bool transparent, uint32_t mat_idx,
+                                      float depth) {
+  // The bits of a non-negative float sort the same as the float itself so
+  // keeping the upper 24 bits is a cheap monotonic quantization
+  uint32_t depth_bits = 0;
+  depth = SDL_max(depth, 0.0f);
+  SDL_memcpy(&depth_bits, &depth, sizeof(float)); // NOLINT
+  uint64_t depth_key = (depth_bits >> 8) & TB_MESH_DRAW_KEY_FIELD_MASK;
+  uint64_t mat_key = mat_idx & TB_MESH_DRAW_KEY_FIELD_MASK;
+
+  if (transparent) {
+    depth_key = TB_MESH_DRAW_KEY_FIELD_MASK - depth_key;
+    return ((uint64_t)TbMeshDrawPassTransparent
+            << TB_MESH_DRAW_KEY_PASS_SHIFT) |
+           (depth_key << TB_MESH_DRAW_KEY_HI_SHIFT) |
+           (mat_key << TB_MESH_DRAW_KEY_LO_SHIFT);
+  }
+  return ((uint64_t)TbMeshDrawPassOpaque << TB_MESH_DRAW_KEY_PASS_SHIFT) |
+         (mat_key << TB_MESH_DRAW_KEY_HI_SHIFT) |
+         (depth_key << TB_MESH_DRAW_KEY_LO_SHIFT);
+}
+
+static void tb_on_mesh_draw_slots_remove(ecs_iter_t *it) {
+  tb_auto mesh_sys = ecs_singleton_get_mut(it->world, TbMeshSystem);
+  if (!mesh_sys) {
+    return;
+  }
+  tb_auto slots = ecs_field(it, TbMeshDrawSlots, 0);
+  for (int32_t i = 0; i < it->count; ++i) {
+    tb_free_mesh_draws(&mesh_sys->draws, &slots[i]);
+  }
+}
+
+// Changing or removing the mesh or render object of an instance means its
+// draws must be rebuilt
+static void tb_invalidate_mesh_draws(ecs_iter_t *it) {
+  for (int32_t i = 0; i < it->count; ++i) {
+    ecs_remove(it->world, it->entities[i], TbMeshDrawSlots);
+  }
+}
+
+// A material's descriptor index and transparency are baked into the records of
+// every instance drawing with it so those instances are rebuilt as well
+static void tb_on_mesh_material_changed(ecs_iter_t *it) {
+  tb_auto mesh_sys = ecs_singleton_get_mut(it->world, TbMeshSystem);
+  if (!mesh_sys) {
+    return;
+  }
+  tb_auto draws = &mesh_sys->draws;
+  for (int32_t i = 0; i < it->count; ++i) {
+    // Removing the slots of an owner unlinks them from the chain being walked
+    // so the owners are gathered first
+    TB_DYN_ARR_OF(ecs_entity_t) owners = {0};
+    TB_DYN_ARR_RESET(owners, mesh_sys->tmp_alloc, 64);
+    uint32_t slot = tb_mesh_draws_material_head(draws, it->entities[i]);
+    while (slot != TB_MESH_DRAW_SLOT_NONE) {
+      TB_DYN_ARR_APPEND(owners, draws->records[slot].owner);
+      slot = draws->records[slot].mat_next;
+    }
+    // Owners with several submeshes on the material are already gone by the
+    // time they come up again, which ecs_remove ignores
+    TB_DYN_ARR_FOREACH(owners, o) {
+      ecs_remove(it->world, TB_DYN_ARR_AT(owners, o), TbMeshDrawSlots);
+    }
+  }
+}
+
+// Returns how many submeshes the mesh has if every one of them can be drawn
+static uint32_t tb_count_drawable_submeshes(ecs_world_t *ecs, TbMesh2 mesh) {
+  uint32_t submesh_count = 0;
+  tb_auto submesh_itr = ecs_children(ecs, mesh);
+  while (ecs_children_next(&submesh_itr)) {
+    for (int32_t sm_i = 0; sm_i < submesh_itr.count; ++sm_i) {
+      TbSubMesh2 sm_ent = submesh_itr.entities[sm_i];
+      if (!ecs_has(ecs, sm_ent, TbSubMesh2Data)) {
+        TB_CHECK(false, "Submesh entity unexpectedly lacked submesh data");
+        continue;
+      }
+      tb_auto sm = ecs_get(ecs, sm_ent, TbSubMesh2Data);
+      // Material must be loaded and ready
+      if (!tb_is_material_ready(ecs, sm->material)) {
+        return 0;
+      }
+      submesh_count++;
+    }
+  }
+  return submesh_count;
+}
+
+// Assigns draw slots to mesh instances that became drawable since the last
+// frame and uploads only the range of records that were written
+static void tb_update_mesh_draws(ecs_world_t *ecs, TbMeshSystem *mesh_sys) {
+  TB_TRACY_SCOPE("Update Mesh Draws");
+  tb_auto draws = &mesh_sys->draws;
+
+  tb_auto pending_it = ecs_query_iter(ecs, mesh_sys->pending_draw_query);
+  while (ecs_query_next(&pending_it)) {
+    tb_auto meshes = ecs_field(&pending_it, TbMeshComponent, 0);
+    tb_auto render_objects = ecs_field(&pending_it, TbRenderObject, 1);
+    for (int32_t mesh_idx = 0; mesh_idx < pending_it.count; ++mesh_idx) {
+      tb_auto mesh = meshes[mesh_idx].mesh2;
+      tb_auto ro = render_objects[mesh_idx];
+
+      if (!tb_is_mesh_ready(ecs, mesh)) {
+        continue;
+      }
+
+      // Wait for every material so an instance's slots are written only once
+      const uint32_t submesh_count = tb_count_drawable_submeshes(ecs, mesh);
+      if (submesh_count == 0) {
+        continue;
+      }
+      tb_reserve_mesh_draws(draws, submesh_count);
+
+      tb_auto owner = pending_it.entities[mesh_idx];
+      tb_auto mesh_desc_idx = *ecs_get(ecs, mesh, TbMeshIndex);
+      TbMeshDrawSlots slots = {.head = TB_MESH_DRAW_SLOT_NONE};
+
+      tb_auto submesh_itr = ecs_children(ecs, mesh);
+      while (ecs_children_next(&submesh_itr)) {
+        for (int32_t sm_i = 0; sm_i < submesh_itr.count; ++sm_i) {
+          TbSubMesh2 sm_ent = submesh_itr.entities[sm_i];
+          tb_auto sm = ecs_get(ecs, sm_ent, TbSubMesh2Data);
+          if (!sm) {
+            continue;
+          }
+
+          tb_auto meshlets = ecs_get(ecs, sm_ent, TbSubMeshMeshlets);
+          tb_auto lods = ecs_get(ecs, sm_ent, TbSubMeshLods);
+
+          TbMeshDrawRecord record = {
+              .data =
+                  {
+                      .perm = sm->vertex_perm,
+                      .obj_idx = ro.index,
+                      .mesh_idx = mesh_desc_idx,
+                      .mat_idx =
+                          *ecs_get(ecs, sm->material, TbMaterialComponent),
+                      .index_offset = sm->index_offset,
+                      .vertex_offset = sm->vertex_offset,
+                  },
+              .bounds = *ecs_get(ecs, sm_ent, TbAABB),
+              .index_count = sm->index_count,
+              .transparent = tb_is_mat_transparent(ecs, sm->material),
+              .material = sm->material,
+              .meshlet_count = meshlets ? meshlets->count : 0,
+              .meshlets = meshlets ? meshlets->meshlets : NULL,
+              .lods = lods ? *lods : (TbSubMeshLods){0},
+          };
+          tb_add_mesh_draw(draws, owner, &slots, &record);
+        }
+      }
+
+      ecs_set_ptr(ecs, owner, TbMeshDrawSlots, &slots);
+    }
+  }
+
+  // Growing the pool writes every record to a new buffer
+  if (draws->capacity != mesh_sys->draw_buffer_cap) {
+    tb_resize_mesh_draw_buffer(mesh_sys);
+    return;
+  }
+  if (draws->dirty_min > draws->dirty_max) {
+    return;
+  }
+
+  const uint64_t stride = sizeof(TbGLTFDrawData);
+  TbGLTFDrawData *write_ptr = NULL;
+  tb_rnd_sys_update_gpu_buffer_range(
+      mesh_sys->rnd_sys, &mesh_sys->draw_buffer, &mesh_sys->draw_host,
+      draws->dirty_min * stride,
+      (draws->dirty_max - draws->dirty_min + 1) * stride, (void **)&write_ptr);
+  for (uint32_t slot = draws->dirty_min; slot <= draws->dirty_max; ++slot) {
+    tb_auto record = &draws->records[slot];
+    if (record->owner != 0) {
+      write_ptr[slot] = record->data;
+    }
+  }
+  tb_clear_mesh_draws_dirty(draws);
+}
+
+#ifndef TB_FINAL
+// Walks every instance's records and compares them against the components they
+// were built from. This costs as much as a full rebuild so it only runs on
+// some frames
+#define TB_MESH_DRAW_VALIDATE_INTERVAL 256
+
+static void tb_validate_mesh_draws(ecs_world_t *ecs, TbMeshSystem *mesh_sys) {
+  TB_TRACY_SCOPE("Validate Mesh Draws");
+  uint32_t owned_count = 0;
+
+  tb_auto drawn_it = ecs_query_iter(ecs, mesh_sys->drawn_query);
+  while (ecs_query_next(&drawn_it)) {
+    tb_auto slots = ecs_field(&drawn_it, TbMeshDrawSlots, 0);
+    tb_auto render_objects = ecs_field(&drawn_it, TbRenderObject, 1);
+    for (int32_t i = 0; i < drawn_it.count; ++i) {
+      uint32_t slot = slots[i].head;
+      for (uint32_t n = 0; n < slots[i].count; ++n) {
+        if (slot >= mesh_sys->draws.slot_count) {
+          TB_CHECK(false, "Mesh draw slot chain is broken");
+          break;
+        }
+        tb_auto record = &mesh_sys->draws.records[slot];
+        TB_CHECK(record->owner == drawn_it.entities[i],
+                 "Mesh draw slot has the wrong owner");
+        TB_CHECK(record->data.obj_idx == (uint32_t)render_objects[i].index,
+                 "Mesh draw has a stale render object index");
+        tb_auto mat_idx = ecs_get(ecs, record->material, TbMaterialComponent);
+        if (mat_idx) {
+          TB_CHECK(record->data.mat_idx == *mat_idx,
+                   "Mesh draw has a stale material index");
+          TB_CHECK(record->transparent ==
+                       tb_is_mat_transparent(ecs, record->material),
+                   "Mesh draw has a stale transparency flag");
+        } else {
+          TB_CHECK(false, "Mesh draw references an unloaded material");
+        }
+        slot = record->next;
+        owned_count++;
+      }
+    }
+  }
+
+  uint32_t used_count = 0;
+  for (uint32_t slot = 0; slot < mesh_sys->draws.slot_count; ++slot) {
+    if (mesh_sys->draws.records[slot].owner != 0) {
+      used_count++;
+    }
+  }
+  TB_CHECK(used_count == owned_count, "Mesh draw slots were leaked");
+}
+#endif
+
+// Picks the coarsest LOD whose error projects to no more than the threshold.
+// px_per_unit converts a world space length at the draw's distance to pixels
+static uint32_t tb_select_mesh_lod(const TbSubMeshLods *lods, float scale,
+                                   float px_per_unit, float threshold) {
+  uint32_t lod = 0;
+  for (uint32_t i = 1; i < lods->count; ++i) {
+    if (lods->lods[i].error * scale * px_per_unit > threshold) {
+      break;
+    }
+    lod = i;
+  }
+  return lod;
+}
+
+static float4x4 tb_mesh_draw_world(void *ctx, ecs_entity_t owner) {
+  return tb_transform_get_world_matrix(ctx, owner);
+}
+
+// Writes one indirect command per opaque draw visible to the given view
+static void tb_write_shadow_draws(TbMeshSystem *mesh_sys, TbViewId view_id,
+                                  uint64_t view_bit,
+                                  const TbMeshVisibleDraws *vis) {
+  uint32_t draw_count = 0;
+  for (uint32_t i = 0; i < vis->count; ++i) {
+    if ((vis->masks[i] & view_bit) &&
+        !mesh_sys->draws.records[vis->slots[i]].transparent) {
+      draw_count++;
+    }
+  }
+  if (draw_count == 0) {
+    return;
+  }
+
+  VkDrawIndirectCommand *cmds = NULL;
+  uint64_t cmds_offset = 0;
+  tb_rnd_sys_copy_to_tmp_buffer2(mesh_sys->rnd_sys,
+                                 sizeof(VkDrawIndirectCommand) * draw_count,
+                                 0x40, &cmds_offset, (void **)&cmds);
+  uint32_t cmd_idx = 0;
+  for (uint32_t i = 0; i < vis->count; ++i) {
+    tb_auto slot = vis->slots[i];
+    tb_auto record = &mesh_sys->draws.records[slot];
+    if ((vis->masks[i] & view_bit) && !record->transparent) {
+      cmds[cmd_idx++] = (VkDrawIndirectCommand){
+          .vertexCount = record->index_count,
+          .instanceCount = 1,
+          .firstInstance = slot,
+      };
+    }
+  }
+
+  mesh_sys->shadow_draws[mesh_sys->shadow_draw_count++] = (TbMeshViewDraws){
+      .view_id = view_id,
+      .draw =
+          {
+              .buffer = tb_rnd_get_gpu_tmp_buffer(mesh_sys->rnd_sys),
+              .offset = cmds_offset,
+              .draw_count = draw_count,
+              .stride = sizeof(VkDrawIndirectCommand),
+          },
+  };
+}
+
+// Writes one command per meshlet of the draw that passes both the frustum and
+// the normal cone test. Returns how many commands were written
+static uint32_t tb_write_meshlet_draws(const TbMeshDrawRecord *record,
+                                       uint32_t slot, const float4x4 *world,
+                                       const TbFrustum *frustum,
+                                       float3 view_pos,
+                                       VkDrawIndirectCommand *cmds,
+                                       uint64_t *tri_count) {
+  // Bounds and cones are transformed assuming the instance is scaled
+  // uniformly. The largest axis scale keeps spheres conservative otherwise
+  const float scale = tb_mesh_max_scale(world);
+  uint32_t cmd_count = 0;
+  for (uint32_t i = 0; i < record->meshlet_count; ++i) {
+    tb_auto meshlet = &record->meshlets[i];
+    const float3 center =
+        tb_f4tof3(tb_mulf44f4(*world, tb_f3tof4(meshlet->center, 1.0f)));
+    if (!tb_frustum_test_sphere(frustum, center, meshlet->radius * scale)) {
+      continue;
+    }
+    // Skip meshlets whose triangles all face away from the viewer
+    if (meshlet->cone_cutoff < 1.0f) {
+      const float3 apex =
+          tb_f4tof3(tb_mulf44f4(*world, tb_f3tof4(meshlet->cone_apex, 1.0f)));
+      const float3 axis = tb_normf3(
+          tb_f4tof3(tb_mulf44f4(*world, tb_f3tof4(meshlet->cone_axis, 0.0f))));
+      if (tb_dotf3(tb_normf3(apex - view_pos), axis) >= meshlet->cone_cutoff) {
+        continue;
+      }
+    }
+
+    // firstVertex selects the meshlet's range of the submesh's indices
+    cmds[cmd_count++] = (VkDrawIndirectCommand){
+        .vertexCount = meshlet->index_count,
+        .instanceCount = 1,
+        .firstVertex = meshlet->index_offset,
+        .firstInstance = slot,
+    };
+    *tri_count += meshlet->index_count / 3;
+  }
+  return cmd_count;
+}
+
+const TbIndirectDraw *tb_mesh_sys_get_shadow_draw(TbMeshSystem *self,
+                                                  TbViewId view_id) {
+  for (uint32_t i = 0; i < self->shadow_draw_count; ++i) {
+    if (self->shadow_draws[i].view_id == view_id) {
+      return &self->shadow_draws[i].draw;
+    }
+  }
+  return NULL;
+}
+
 void mesh_draw_tick(ecs_iter_t *it) {
   TB_TRACY_SCOPEC("Mesh Draw Tick", TracyCategoryColorRendering);
   ecs_world_t *ecs = it->world;
@@ -836,7 +1273,203 @@ void mesh_draw_tick(ecs_iter_t *it) {
     return;
   }
 
+#ifndef TB_FINAL
+  // Runs before any slots are assigned this frame since the TbMeshDrawSlots
+  // that claim them are only set once the deferred commands are flushed
+  if (++mesh_sys->frames_since_validate >= TB_MESH_DRAW_VALIDATE_INTERVAL) {
+    mesh_sys->frames_since_validate = 0;
+    tb_validate_mesh_draws(ecs, mesh_sys);
+  }
+#endif
+
+  tb_update_mesh_draws(ecs, mesh_sys);
+
+  mesh_sys->tris_considered = 0;
+  mesh_sys->tris_submitted = 0;
+
+  // Collect every view that draws meshes: cameras followed by shadow cascades
+  TbMeshCullView views[TB_MESH_MAX_VIEWS] = {{0}};
+  uint32_t view_count = 0;
+  {
+    tb_auto camera_it = ecs_query_iter(ecs, mesh_sys->camera_query);
+    while (ecs_query_next(&camera_it)) {
+      tb_auto cameras = ecs_field(&camera_it, TbCameraComponent, 0);
+      for (int32_t cam_idx = 0; cam_idx < camera_it.count; ++cam_idx) {
+        if (view_count >= TB_MESH_MAX_VIEWS) {
+          TB_CHECK(false, "Too many mesh views");
+          break;
+        }
+        tb_auto view_id = cameras[cam_idx].view_id;
+        views[view_count++] = (TbMeshCullView){
+            .view_id = view_id,
+            .frustum = tb_get_view(view_sys, view_id)->frustum,
+        };
+      }
+    }
+  }
+  const uint32_t shadow_view_start = view_count;
+  {
+    tb_auto light_it = ecs_query_iter(ecs, mesh_sys->dir_light_query);
+    while (ecs_query_next(&light_it)) {
+      tb_auto lights = ecs_field(&light_it, TbDirectionalLightComponent, 0);
+      for (int32_t light_idx = 0; light_idx < light_it.count; ++light_idx) {
+        // Cascades the shadow system isn't using don't need culling
+        for (uint32_t cascade_idx = 0;
+             cascade_idx < lights[light_idx].cascade_count; ++cascade_idx) {
+          if (view_count >= TB_MESH_MAX_VIEWS) {
+            TB_CHECK(false, "Too many mesh views");
+            break;
+          }
+          tb_auto view_id = lights[light_idx].cascade_views[cascade_idx];
+          // Shadows clamp depth, so casters between the light and the
+          // cascade still land in the map and must not be culled
+          TbFrustum frustum = tb_get_view(view_sys, view_id)->frustum;
+          tb_frustum_disable_plane(&frustum, NearPlane);
+          views[view_count++] = (TbMeshCullView){
+              .view_id = view_id,
+              .frustum = frustum,
+          };
+        }
+      }
+    }
+  }
+
+  const TbMeshVisibleDraws vis =
+      tb_cull_mesh_draws(&mesh_sys->draws, mesh_sys->tmp_alloc,
+                         tb_mesh_draw_world, ecs, view_count, views);
+
+  mesh_sys->shadow_draw_count = 0;
+  mesh_sys->shadow_draws = tb_alloc_nm_tp(
+      mesh_sys->tmp_alloc, view_count - shadow_view_start, TbMeshViewDraws);
+  for (uint32_t view_idx = shadow_view_start; view_idx < view_count;
+       ++view_idx) {
+    tb_write_shadow_draws(mesh_sys, views[view_idx].view_id, 1ull << view_idx,
+                          &vis);
+  }
+
+  // Everything but the view and the draw stream is shared by every batch this
+  // frame. All draw data lives in the persistent draw buffer
+#if TB_USE_DESC_BUFFER == 1
+  VkDescriptorBufferBindingInfoEXT opaque_draw_addr =
+      tb_desc_buff_get_binding(&mesh_sys->opaque_draw_descs);
+  VkDescriptorBufferBindingInfoEXT trans_draw_addr =
+      tb_desc_buff_get_binding(&mesh_sys->trans_draw_descs);
+  {
+    // Reset descriptor buffers
+    tb_reset_descriptor_buffer(rnd_sys, &mesh_sys->opaque_draw_descs);
+    tb_reset_descriptor_buffer(rnd_sys, &mesh_sys->trans_draw_descs);
+
+    TbDescriptor desc = {
+        .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .data.pStorageBuffer =
+            &(VkDescriptorAddressInfoEXT){
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+                .address = mesh_sys->draw_buffer.address,
+                .range = mesh_sys->draw_buffer.info.size,
+            },
+    };
+    tb_write_desc_to_buffer(rnd_sys, &mesh_sys->opaque_draw_descs, 0, &desc);
+    tb_write_desc_to_buffer(rnd_sys, &mesh_sys->trans_draw_descs, 0, &desc);
+  }
+  const TbPrimitiveBatch frame_prim_batch = {
+      .mat_addr = tb_mat_sys_get_table_addr(ecs),
+      .obj_addr = tb_render_object_sys_get_table_addr(ecs),
+      .tex_addr = tb_tex_sys_get_table_addr(ecs),
+      .idx_addr = tb_mesh_sys_get_idx_addr(ecs),
+      .pos_addr = tb_mesh_sys_get_pos_addr(ecs),
+      .norm_addr = tb_mesh_sys_get_norm_addr(ecs),
+      .tan_addr = tb_mesh_sys_get_tan_addr(ecs),
+      .uv0_addr = tb_mesh_sys_get_uv0_addr(ecs),
+  };
+#else
+  // Allocate per-draw descriptor sets
+  const uint32_t set_count = 2;
+  {
+    VkDescriptorPoolCreateInfo create_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets = set_count * 8,
+        .poolSizeCount = 1,
+        .pPoolSizes =
+            (VkDescriptorPoolSize[1]){
+                {
+                    .descriptorCount = set_count * 8,
+                    .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                },
+            },
+    };
+    VkDescriptorSetLayout layouts[set_count] = {
+        mesh_sys->draw_set_layout,
+        mesh_sys->draw_set_layout,
+    };
+    tb_rnd_frame_desc_pool_tick(rnd_sys, "mesh_draw_instances", &create_info,
+                                layouts, NULL, mesh_sys->draw_pools.pools,
+                                set_count, set_count);
+  }
+  VkDescriptorSet opaque_draw_set =
+      tb_rnd_frame_desc_pool_get_set(rnd_sys, mesh_sys->draw_pools.pools, 0);
+  VkDescriptorSet trans_draw_set =
+      tb_rnd_frame_desc_pool_get_set(rnd_sys, mesh_sys->draw_pools.pools, 1);
+  {
+    VkDescriptorBufferInfo buffer_info = {
+        .buffer = mesh_sys->draw_buffer.buffer,
+        .range = mesh_sys->draw_buffer.info.size,
+    };
+    VkWriteDescriptorSet writes[2] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = opaque_draw_set,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &buffer_info,
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = trans_draw_set,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &buffer_info,
+        },
+    };
+    tb_rnd_update_descriptors(rnd_sys, 2, writes);
+  }
+  const TbPrimitiveBatch frame_prim_batch = {
+      .mat_set = tb_mat_sys_get_set(ecs),
+      .obj_set = tb_render_object_sys_get_set(ecs),
+      .tex_set = tb_tex_sys_get_set(ecs),
+      .idx_set = tb_mesh_sys_get_idx_set(ecs),
+      .pos_set = tb_mesh_sys_get_pos_set(ecs),
+      .norm_set = tb_mesh_sys_get_norm_set(ecs),
+      .tan_set = tb_mesh_sys_get_tan_set(ecs),
+      .uv0_set = tb_mesh_sys_get_uv0_set(ecs),
+  };
+#endif
+
+  // Shadows draw the opaque pipeline's inputs with their own views and draws.
+  // Built whether or not any camera drew something since cascades can still
+  // have casters
+  TB_CHECK(mesh_sys->shadow_batch == NULL, "Shadow batch was not consumed");
+  {
+    tb_auto shadow_prim_batch =
+        tb_alloc_tp(mesh_sys->tmp_alloc, TbPrimitiveBatch);
+    *shadow_prim_batch = frame_prim_batch;
+#if TB_USE_DESC_BUFFER == 1
+    shadow_prim_batch->draw_addr = opaque_draw_addr;
+#else
+    shadow_prim_batch->draw_set = opaque_draw_set;
+#endif
+    mesh_sys->shadow_batch = tb_alloc_tp(mesh_sys->tmp_alloc, TbDrawBatch);
+    *mesh_sys->shadow_batch = (TbDrawBatch){
+        .layout = mesh_sys->pipe_layout,
+        .pipeline = tb_shader_get_pipeline(ecs, mesh_sys->opaque_shader),
+        .user_batch = shadow_prim_batch,
+        .draw_count = 1,
+        .draw_size = sizeof(TbIndirectDraw),
+        .draw_max = 1,
+    };
+  }
+
   // For each camera
+  uint32_t camera_view_idx = 0;
   tb_auto camera_it = ecs_query_iter(ecs, mesh_sys->camera_query);
   while (ecs_query_next(&camera_it)) {
     tb_auto cameras = ecs_field(&camera_it, TbCameraComponent, 0);
@@ -844,6 +1477,12 @@ void mesh_draw_tick(ecs_iter_t *it) {
       TB_TRACY_SCOPE("Camera");
       tb_auto camera = &cameras[cam_idx];
       tb_auto view_id = camera->view_id;
+      // Cameras were collected in query order
+      const uint32_t view_idx = camera_view_idx++;
+      if (view_idx >= shadow_view_start) {
+        continue;
+      }
+      const uint64_t view_bit = 1ull << view_idx;
 #if TB_USE_DESC_BUFFER == 1
       tb_auto view_addr = tb_view_sys_get_table_addr(ecs, view_id);
       // Skip camera if view set isn't ready
@@ -861,85 +1500,86 @@ void mesh_draw_tick(ecs_iter_t *it) {
       const float width = camera->width;
       const float height = camera->height;
 
-      // Run query to determine how many meshes so we can pre-allocate space for
-      // batches
-      TB_TRACY_SCOPE("Count Meshes");
-      tb_auto mesh_it = ecs_query_iter(ecs, mesh_sys->mesh_query);
+      // Gather draws visible to this view along with a sort key so the
+      // indirect streams can be emitted in a cache and blend friendly order
+      tb_auto draw_keys =
+          tb_alloc_nm_tp(mesh_sys->tmp_alloc, vis.count, uint64_t);
+      tb_auto draw_order =
+          tb_alloc_nm_tp(mesh_sys->tmp_alloc, vis.count, uint32_t);
       uint32_t opaque_draw_count = 0;
       uint32_t trans_draw_count = 0;
-      while (ecs_query_next(&mesh_it)) {
-        tb_auto meshes = ecs_field(&mesh_it, TbMeshComponent, 0);
-        for (tb_auto mesh_idx = 0; mesh_idx < mesh_it.count; ++mesh_idx) {
-          TbMesh2 mesh = meshes[mesh_idx].mesh2;
-
-          if (!tb_is_mesh_ready(it->world, mesh)) {
+      // Draws split into meshlets may need one command per meshlet
+      uint32_t opaque_cmd_cap = 0;
+      uint32_t trans_cmd_cap = 0;
+      tb_auto view = tb_get_view(view_sys, view_id);
+      const float3 view_pos = view->view_data.view_pos;
+      // LOD chosen for each slot visible to this view
+      tb_auto slot_lods = tb_alloc_nm_tp(mesh_sys->tmp_alloc,
+                                         mesh_sys->draws.slot_count, uint8_t);
+      // Pixels spanned by each slot visible to this view
+      tb_auto slot_px = tb_alloc_nm_tp(mesh_sys->tmp_alloc,
+                                       mesh_sys->draws.slot_count, float);
+      {
+        TB_TRACY_SCOPE("Gather Draws");
+        // Pixels covered by one world unit at a distance of one unit
+        const float px_per_unit =
+            height * 0.5f * SDL_fabsf(view->view_data.p.cols[1].y);
+        const float lod_threshold = TB_MESH_LOD_PIXEL_ERROR *
+                                    SDL_powf(2.0f, tb_mesh_lod_bias(ecs));
+        for (uint32_t i = 0; i < vis.count; ++i) {
+          if ((vis.masks[i] & view_bit) == 0) {
             continue;
           }
-
-          tb_auto submesh_itr = ecs_children(it->world, mesh);
-
-          uint32_t submesh_count = 0;
-          while (ecs_children_next(&submesh_itr)) {
-            submesh_count += submesh_itr.count;
+          tb_auto slot = vis.slots[i];
+          tb_auto record = &mesh_sys->draws.records[slot];
+
+          tb_auto to_draw = vis.centers[i] - view_pos;
+          const float depth = tb_dotf3(to_draw, to_draw);
+
+          // Measure from the nearest point of the bounds so that the error
+          // isn't underestimated for large draws the camera is close to
+          const float radius = tb_magf3(record->bounds.max -
+                                        record->bounds.min) *
+                               0.5f * vis.scales[i];
+          const float dist =
+              SDL_max(SDL_sqrtf(depth) - radius, TB_MESH_LOD_MIN_DISTANCE);
+          uint32_t lod = 0;
+          if (record->lods.count > 1) {
+            lod = tb_select_mesh_lod(&record->lods, vis.scales[i],
+                                     px_per_unit / dist, lod_threshold);
           }
-
-          submesh_itr = ecs_children(it->world, mesh);
-          while (ecs_children_next(&submesh_itr)) {
-            for (int32_t sm_i = 0; sm_i < submesh_itr.count; ++sm_i) {
-              TbSubMesh2 sm_ent = submesh_itr.entities[sm_i];
-              if (!ecs_has(it->world, sm_ent, TbSubMesh2Data)) {
-                TB_CHECK(false,
-                         "Submesh entity unexpectedly lacked submesh data");
-                continue;
-              }
-              tb_auto sm = ecs_get(it->world, sm_ent, TbSubMesh2Data);
-
-              // Material must be loaded and ready
-              if (!tb_is_material_ready(ecs, sm->material)) {
-                continue;
-              }
-
-              if (tb_is_mat_transparent(ecs, sm->material)) {
-                trans_draw_count += submesh_count;
-              } else {
-                opaque_draw_count += submesh_count;
-              }
-            }
+          slot_lods[slot] = lod;
+          slot_px[slot] = 2.0f * radius * px_per_unit / dist;
+
+          tb_auto draw_idx = opaque_draw_count + trans_draw_count;
+          draw_keys[draw_idx] = tb_mesh_draw_sort_key(
+              record->transparent, record->data.mat_idx, depth);
+          draw_order[draw_idx] = slot;
+          // Simplified LODs are drawn whole while LOD 0 may need one command
+          // per meshlet
+          const uint32_t cmd_count =
+              lod > 0 ? 1 : SDL_max(record->meshlet_count, 1);
+          if (record->transparent) {
+            trans_draw_count++;
+            trans_cmd_cap += cmd_count;
+          } else {
+            opaque_draw_count++;
+            opaque_cmd_cap += cmd_count;
           }
+          mesh_sys->tris_considered += record->index_count / 3;
         }
       }
-      mesh_it = ecs_query_iter(ecs, mesh_sys->mesh_query);
-      const uint32_t max_draw_count = opaque_draw_count + trans_draw_count;
-      if (max_draw_count == 0) {
+      const uint32_t gathered_count = opaque_draw_count + trans_draw_count;
+      if (gathered_count == 0) {
         continue;
       }
 
-#if TB_USE_DESC_BUFFER == 1
-      tb_auto obj_addr = tb_render_object_sys_get_table_addr(ecs);
-      tb_auto tex_addr = tb_tex_sys_get_table_addr(ecs);
-      tb_auto mat_addr = tb_mat_sys_get_table_addr(ecs);
-      tb_auto idx_addr = tb_mesh_sys_get_idx_addr(ecs);
-      tb_auto pos_addr = tb_mesh_sys_get_pos_addr(ecs);
-      tb_auto norm_addr = tb_mesh_sys_get_norm_addr(ecs);
-      tb_auto tan_addr = tb_mesh_sys_get_tan_addr(ecs);
-      tb_auto uv0_addr = tb_mesh_sys_get_uv0_addr(ecs);
-#else
-      tb_auto obj_set = tb_render_object_sys_get_set(ecs);
-      tb_auto tex_set = tb_tex_sys_get_set(ecs);
-      tb_auto mat_set = tb_mat_sys_get_set(ecs);
-      tb_auto idx_set = tb_mesh_sys_get_idx_set(ecs);
-      tb_auto pos_set = tb_mesh_sys_get_pos_set(ecs);
-      tb_auto norm_set = tb_mesh_sys_get_norm_set(ecs);
-      tb_auto tan_set = tb_mesh_sys_get_tan_set(ecs);
-      tb_auto uv0_set = tb_mesh_sys_get_uv0_set(ecs);
-#endif
-
       // Allocate indirect draw buffers
       VkDrawIndirectCommand *opaque_draw_cmds = NULL;
       uint64_t opaque_cmds_offset = 0;
       uint32_t opaque_cmd_count = 0;
       {
-        uint64_t size = sizeof(VkDrawIndirectCommand) * opaque_draw_count;
+        uint64_t size = sizeof(VkDrawIndirectCommand) * opaque_cmd_cap;
         tb_rnd_sys_copy_to_tmp_buffer2(rnd_sys, size, 0x40, &opaque_cmds_offset,
                                        (void **)&opaque_draw_cmds);
       }
@@ -947,183 +1587,124 @@ void mesh_draw_tick(ecs_iter_t *it) {
       uint64_t trans_cmds_offset = 0;
       uint32_t trans_cmd_count = 0;
       {
-        uint64_t size = sizeof(VkDrawIndirectCommand) * trans_draw_count;
+        uint64_t size = sizeof(VkDrawIndirectCommand) * trans_cmd_cap;
         tb_rnd_sys_copy_to_tmp_buffer2(rnd_sys, size, 0x40, &trans_cmds_offset,
                                        (void **)&trans_draw_cmds);
       }
 
-      // Allocate per-draw storage buffers
-      TbGLTFDrawData *opaque_draw_data = NULL;
-      const uint64_t opaque_data_size =
-          sizeof(TbGLTFDrawData) * opaque_draw_count;
-      uint64_t opaque_data_offset = 0;
-      tb_rnd_sys_copy_to_tmp_buffer2(rnd_sys, opaque_data_size, 0x40,
-                                     &opaque_data_offset,
-                                     (void **)&opaque_draw_data);
-
-      TbGLTFDrawData *trans_draw_data = NULL;
-      const uint64_t trans_data_size =
-          sizeof(TbGLTFDrawData) * trans_draw_count;
-      uint64_t trans_data_offset = 0;
-      tb_rnd_sys_copy_to_tmp_buffer2(rnd_sys, trans_data_size, 0x40,
-                                     &trans_data_offset,
-                                     (void **)&trans_draw_data);
-
-#if TB_USE_DESC_BUFFER == 1
-      // Reset descriptor buffers
-      tb_reset_descriptor_buffer(rnd_sys, &mesh_sys->opaque_draw_descs);
-      tb_reset_descriptor_buffer(rnd_sys, &mesh_sys->trans_draw_descs);
-#else
-      // Allocate per-draw descriptor sets
-      const uint32_t set_count = 2;
       {
-        VkDescriptorPoolCreateInfo create_info = {
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .maxSets = set_count * 8,
-            .poolSizeCount = 1,
-            .pPoolSizes =
-                (VkDescriptorPoolSize[1]){
-                    {
-                        .descriptorCount = set_count * 8,
-                        .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                    },
-                },
-        };
-        VkDescriptorSetLayout layouts[set_count] = {
-            mesh_sys->draw_set_layout,
-            mesh_sys->draw_set_layout,
-        };
-        tb_rnd_frame_desc_pool_tick(
-            rnd_sys, "mesh_draw_instances", &create_info, layouts, NULL,
-            mesh_sys->draw_pools.pools, set_count, set_count);
+        TB_TRACY_SCOPE("Sort Draws");
+        tb_auto enki = *ecs_singleton_get(ecs, TbTaskScheduler);
+        tb_radix_sort_u64(enki, mesh_sys->tmp_alloc, gathered_count, draw_keys,
+                          draw_order);
       }
-#endif
 
       {
-        TB_TRACY_SCOPE("Iterate Meshes");
-        while (ecs_query_next(&mesh_it)) {
-          tb_auto meshes = ecs_field(&mesh_it, TbMeshComponent, 0);
-          tb_auto render_objects = ecs_field(&mesh_it, TbRenderObject, 1);
-          for (int32_t mesh_idx = 0; mesh_idx < mesh_it.count; ++mesh_idx) {
-            tb_auto mesh = meshes[mesh_idx].mesh2;
-            tb_auto ro = render_objects[mesh_idx];
-
-            if (!tb_is_mesh_ready(it->world, mesh)) {
-              continue;
-            }
-
-            tb_auto mesh_desc_idx = *ecs_get(it->world, mesh, TbMeshIndex);
-
-            tb_auto submesh_itr = ecs_children(it->world, mesh);
-            while (ecs_children_next(&submesh_itr)) {
-              for (int32_t sm_i = 0; sm_i < submesh_itr.count; ++sm_i) {
-                TbSubMesh2 sm_ent = submesh_itr.entities[sm_i];
-                if (!ecs_has(it->world, sm_ent, TbSubMesh2Data)) {
-                  TB_CHECK(false,
-                           "Submesh entity unexpectedly lacked submesh data");
-                  continue;
-                }
-                tb_auto sm = ecs_get(it->world, sm_ent, TbSubMesh2Data);
-                // Material must be loaded and ready
-                if (!tb_is_material_ready(ecs, sm->material)) {
-                  continue;
-                }
-
-                // Deduce whether to write to opaque or transparent data
-                tb_auto draw_cmds = opaque_draw_cmds;
-                tb_auto draw_count = &opaque_cmd_count;
-                tb_auto draw_data = opaque_draw_data;
-                if (tb_is_mat_transparent(ecs, sm->material)) {
-                  draw_cmds = trans_draw_cmds;
-                  draw_count = &trans_cmd_count;
-                  draw_data = trans_draw_data;
-                }
-
-                // Write a command and a piece of draw data into the buffers
-                tb_auto draw_idx = *draw_count;
-                draw_cmds[draw_idx] = (VkDrawIndirectCommand){
-                    .vertexCount = sm->index_count,
-                    .instanceCount = 1,
-                };
-                draw_data[draw_idx] = (TbGLTFDrawData){
-                    .perm = sm->vertex_perm,
-                    .obj_idx = ro.index,
-                    .mesh_idx = mesh_desc_idx,
-                    .mat_idx = *ecs_get(ecs, sm->material, TbMaterialComponent),
-                    .index_offset = sm->index_offset,
-                    .vertex_offset = sm->vertex_offset,
-                };
-                (*draw_count) += 1;
-              }
+        TB_TRACY_SCOPE("Report Material Usage");
+        // Sorting grouped draws by material so each material is told the
+        // largest size it is drawn at once per run
+        TbMaterial material = 0;
+        float px = 0.0f;
+        for (uint32_t i = 0; i < gathered_count; ++i) {
+          tb_auto slot = draw_order[i];
+          tb_auto record = &mesh_sys->draws.records[slot];
+          if (record->material != material) {
+            if (material != 0) {
+              tb_mat_sys_report_screen_size(ecs, material, px);
             }
+            material = record->material;
+            px = 0.0f;
           }
+          px = SDL_max(px, slot_px[slot]);
+        }
+        if (material != 0) {
+          tb_mat_sys_report_screen_size(ecs, material, px);
         }
       }
 
-#if TB_USE_DESC_BUFFER == 1
-      VkDescriptorBufferBindingInfoEXT opaque_draw_addr =
-          tb_desc_buff_get_binding(&mesh_sys->opaque_draw_descs);
-      VkDescriptorBufferBindingInfoEXT trans_draw_addr =
-          tb_desc_buff_get_binding(&mesh_sys->trans_draw_descs);
-#else
-      VkDescriptorSet opaque_draw_set = tb_rnd_frame_desc_pool_get_set(
-          rnd_sys, mesh_sys->draw_pools.pools, 0);
-      VkDescriptorSet trans_draw_set = tb_rnd_frame_desc_pool_get_set(
-          rnd_sys, mesh_sys->draw_pools.pools, 1);
-#endif
+      {
+        TB_TRACY_SCOPE("Write Draws");
+        ecs_entity_t last_owner = 0;
+        float4x4 world = {.col0 = {0}};
+        for (uint32_t i = 0; i < gathered_count; ++i) {
+          tb_auto slot = draw_order[i];
+          tb_auto record = &mesh_sys->draws.records[slot];
+
+          // Deduce whether to write to opaque or transparent commands
+          tb_auto draw_cmds = opaque_draw_cmds;
+          tb_auto draw_count = &opaque_cmd_count;
+          if (record->transparent) {
+            draw_cmds = trans_draw_cmds;
+            draw_count = &trans_cmd_count;
+          }
+
+          const uint32_t lod = slot_lods[slot];
+          if (lod > 0) {
+            tb_auto lod_info = &record->lods.lods[lod];
+            draw_cmds[*draw_count] = (VkDrawIndirectCommand){
+                .vertexCount = lod_info->index_count,
+                .instanceCount = 1,
+                .firstVertex = lod_info->index_offset,
+                .firstInstance = slot,
+            };
+            (*draw_count) += 1;
+            mesh_sys->tris_submitted += lod_info->index_count / 3;
+            continue;
+          }
+
+          if (record->meshlet_count > 0) {
+            if (record->owner != last_owner) {
+              world = tb_transform_get_world_matrix(ecs, record->owner);
+              last_owner = record->owner;
+            }
+            (*draw_count) += tb_write_meshlet_draws(
+                record, slot, &world, &view->frustum, view_pos,
+                &draw_cmds[*draw_count], &mesh_sys->tris_submitted);
+            continue;
+          }
 
-      // Opaque batch is a bit special since we need to share with the shadow
-      // system
-      TB_CHECK(mesh_sys->opaque_batch == NULL, "Opaque batch was not consumed");
-      mesh_sys->opaque_batch = tb_alloc_tp(mesh_sys->tmp_alloc, TbDrawBatch);
-      tb_auto opaque_prim_batch =
-          tb_alloc_tp(mesh_sys->tmp_alloc, TbPrimitiveBatch);
+          // The draw slot is passed as the instance so that shaders can fetch
+          // the persistent draw data
+          draw_cmds[*draw_count] = (VkDrawIndirectCommand){
+              .vertexCount = record->index_count,
+              .instanceCount = 1,
+              .firstInstance = slot,
+          };
+          (*draw_count) += 1;
+          mesh_sys->tris_submitted += record->index_count / 3;
+        }
+      }
 
-      *opaque_prim_batch = (TbPrimitiveBatch){
+      TbPrimitiveBatch opaque_prim_batch = frame_prim_batch;
+      TbPrimitiveBatch trans_prim_batch = frame_prim_batch;
 #if TB_USE_DESC_BUFFER == 1
-          .view_addr = view_addr,
-          .mat_addr = mat_addr,
-          .draw_addr = opaque_draw_addr,
-          .obj_addr = obj_addr,
-          .tex_addr = tex_addr,
-          .idx_addr = idx_addr,
-          .pos_addr = pos_addr,
-          .norm_addr = norm_addr,
-          .tan_addr = tan_addr,
-          .uv0_addr = uv0_addr,
+      opaque_prim_batch.view_addr = view_addr;
+      opaque_prim_batch.draw_addr = opaque_draw_addr;
+      trans_prim_batch.view_addr = view_addr;
+      trans_prim_batch.draw_addr = trans_draw_addr;
 #else
-          .view_set = view_set,
-          .mat_set = mat_set,
-          .draw_set = opaque_draw_set,
-          .obj_set = obj_set,
-          .tex_set = tex_set,
-          .idx_set = idx_set,
-          .pos_set = pos_set,
-          .norm_set = norm_set,
-          .tan_set = tan_set,
-          .uv0_set = uv0_set,
+      opaque_prim_batch.view_set = view_set;
+      opaque_prim_batch.draw_set = opaque_draw_set;
+      trans_prim_batch.view_set = view_set;
+      trans_prim_batch.draw_set = trans_draw_set;
 #endif
-      };
 
       // Define batches
-      tb_auto opaque_draw = tb_alloc_tp(mesh_sys->tmp_alloc, TbIndirectDraw);
-      *opaque_draw =
-          (TbIndirectDraw){
-              .buffer = tb_rnd_get_gpu_tmp_buffer(rnd_sys),
-              .draw_count = opaque_cmd_count,
-              .offset = opaque_cmds_offset,
-              .stride = sizeof(VkDrawIndirectCommand),
-          },
-
-      *mesh_sys->opaque_batch = (TbDrawBatch){
+      TbDrawBatch opaque_batch = {
           .layout = mesh_sys->pipe_layout,
           .pipeline = tb_shader_get_pipeline(ecs, mesh_sys->opaque_shader),
           .viewport = {0, height, width, -(float)height, 0, 1},
           .scissor = {{0, 0}, {width, height}},
-          .user_batch = opaque_prim_batch,
+          .user_batch = &opaque_prim_batch,
           .draw_count = 1,
           .draw_size = sizeof(TbIndirectDraw),
-          .draws = opaque_draw,
+          .draws =
+              &(TbIndirectDraw){
+                  .buffer = tb_rnd_get_gpu_tmp_buffer(rnd_sys),
+                  .draw_count = opaque_cmd_count,
+                  .offset = opaque_cmds_offset,
+                  .stride = sizeof(VkDrawIndirectCommand),
+              },
           .draw_max = 1,
       };
 
@@ -1132,32 +1713,7 @@ void mesh_draw_tick(ecs_iter_t *it) {
           .pipeline = tb_shader_get_pipeline(ecs, mesh_sys->transparent_shader),
           .viewport = {0, height, width, -(float)height, 0, 1},
           .scissor = {{0, 0}, {width, height}},
-          .user_batch =
-              &(TbPrimitiveBatch){
-#if TB_USE_DESC_BUFFER == 1
-                  .view_addr = view_addr,
-                  .mat_addr = mat_addr,
-                  .draw_addr = trans_draw_addr,
-                  .obj_addr = obj_addr,
-                  .tex_addr = tex_addr,
-                  .idx_addr = idx_addr,
-                  .pos_addr = pos_addr,
-                  .norm_addr = norm_addr,
-                  .tan_addr = tan_addr,
-                  .uv0_addr = uv0_addr,
-#else
-                  .view_set = view_set,
-                  .mat_set = mat_set,
-                  .draw_set = trans_draw_set,
-                  .obj_set = obj_set,
-                  .tex_set = tex_set,
-                  .idx_set = idx_set,
-                  .pos_set = pos_set,
-                  .norm_set = norm_set,
-                  .tan_set = tan_set,
-                  .uv0_set = uv0_set,
-#endif
-              },
+          .user_batch = &trans_prim_batch,
           .draw_count = 1,
           .draw_size = sizeof(TbIndirectDraw),
           .draws =
@@ -1171,92 +1727,25 @@ void mesh_draw_tick(ecs_iter_t *it) {
       };
 
       // Prepass batch is the same as opaque but with different pipeline
-      tb_auto prepass_batch = *mesh_sys->opaque_batch;
+      tb_auto prepass_batch = opaque_batch;
       {
         prepass_batch.pipeline =
             tb_shader_get_pipeline(ecs, mesh_sys->prepass_shader);
         prepass_batch.layout = mesh_sys->prepass_layout;
       }
 
-#if TB_USE_DESC_BUFFER == 1
-      {
-        VkDeviceAddress tmp_buf_addr = tb_rnd_get_gpu_tmp_addr(rnd_sys);
-        if (opaque_data_size > 0) {
-          TbDescriptor desc = {
-              .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-              .data.pStorageBuffer =
-                  &(VkDescriptorAddressInfoEXT){
-                      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
-                      .address = tmp_buf_addr + opaque_data_offset,
-                      .range = opaque_data_size,
-                  },
-          };
-          tb_write_desc_to_buffer(rnd_sys, &mesh_sys->opaque_draw_descs, 0,
-                                  &desc);
-        }
-        if (trans_data_size > 0) {
-          TbDescriptor desc = {
-              .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-              .data.pStorageBuffer =
-                  &(VkDescriptorAddressInfoEXT){
-                      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
-                      .address = tmp_buf_addr + trans_data_offset,
-                      .range = trans_data_size,
-                  },
-          };
-          tb_write_desc_to_buffer(rnd_sys, &mesh_sys->trans_draw_descs, 0,
-                                  &desc);
-        }
-      }
-#else
-      // Write draw data buffer to descriptor sets
-      {
-        if (opaque_data_size > 0) {
-          VkWriteDescriptorSet write = {
-              .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-              .dstSet = opaque_draw_set,
-              .descriptorCount = 1,
-              .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-              .pBufferInfo =
-                  &(VkDescriptorBufferInfo){
-                      .buffer = tb_rnd_get_gpu_tmp_buffer(rnd_sys),
-                      .offset = opaque_data_offset,
-                      .range = opaque_data_size,
-                  },
-          };
-          tb_rnd_update_descriptors(rnd_sys, 1, &write);
-        }
-
-        if (trans_data_size > 0) {
-          VkWriteDescriptorSet write = {
-              .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-              .dstSet = trans_draw_set,
-              .descriptorCount = 1,
-              .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-              .pBufferInfo =
-                  &(VkDescriptorBufferInfo){
-                      .buffer = tb_rnd_get_gpu_tmp_buffer(rnd_sys),
-                      .offset = trans_data_offset,
-                      .range = trans_data_size,
-                  },
-          };
-          tb_rnd_update_descriptors(rnd_sys, 1, &write);
-        }
-      }
-#endif
-
       {
         TB_TRACY_SCOPE("Submit Batches");
-        if (opaque_data_size > 0) {
+        if (opaque_cmd_count > 0) {
           TbDrawContextId prepass_ctx2 = mesh_sys->prepass_draw_ctx2;
           tb_render_pipeline_issue_draw_batch(rp_sys, prepass_ctx2, 1,
                                               &prepass_batch);
 
           TbDrawContextId opaque_ctx2 = mesh_sys->opaque_draw_ctx2;
           tb_render_pipeline_issue_draw_batch(rp_sys, opaque_ctx2, 1,
-                                              mesh_sys->opaque_batch);
+                                              &opaque_batch);
         }
-        if (trans_data_size > 0) {
+        if (trans_cmd_count > 0) {
           TbDrawContextId trans_ctx2 = mesh_sys->transparent_draw_ctx2;
           tb_render_pipeline_issue_draw_batch(rp_sys, trans_ctx2, 1,
                                               &trans_batch);
@@ -1264,12 +1753,40 @@ void mesh_draw_tick(ecs_iter_t *it) {
       }
     }
   }
+
+  TracyCPlot("Mesh Triangles Considered", (double)mesh_sys->tris_considered);
+  TracyCPlot("Mesh Triangles Submitted", (double)mesh_sys->tris_submitted);
+  tb_frame_stat_add(TB_FRAME_STAT_TRIANGLES, (int64_t)mesh_sys->tris_submitted);
 }
 
 void tb_register_mesh_sys(TbWorld *world) {
   TB_TRACY_SCOPEC("Register Mesh Sys", TracyCategoryColorRendering);
   ecs_world_t *ecs = world->ecs;
   ECS_COMPONENT_DEFINE(ecs, TbMeshSystem);
+  ECS_COMPONENT_DEFINE(ecs, TbMeshDrawSlots);
+
+  ecs_set_hooks(ecs, TbMeshDrawSlots,
+                {
+                    .on_remove = tb_on_mesh_draw_slots_remove,
+                });
+  ecs_observer(ecs, {
+                        .query.terms = {{.id = ecs_id(TbMeshComponent)}},
+                        .events = {EcsOnSet, EcsOnRemove},
+                        .callback = tb_invalidate_mesh_draws,
+                    });
+  ecs_observer(ecs, {
+                        .query.terms = {{.id = ecs_id(TbRenderObject)},
+                                        {.id = ecs_id(TbMeshDrawSlots),
+                                         .inout = EcsInOutFilter}},
+                        .events = {EcsOnSet, EcsOnRemove},
+                        .callback = tb_invalidate_mesh_draws,
+                    });
+  ecs_observer(ecs, {
+                        .query.terms = {{.id = ecs_id(TbMaterialComponent)},
+                                        {.id = ecs_id(TbMaterialData)}},
+                        .events = {EcsOnSet, EcsOnRemove},
+                        .callback = tb_on_mesh_material_changed,
+                    });
 
   tb_auto rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem);
   tb_auto view_sys = ecs_singleton_ensure(ecs, TbViewSystem);
@@ -1285,14 +1802,26 @@ void tb_register_mesh_sys(TbWorld *world) {
                              },
                          .cache_kind = EcsQueryCacheAuto,
                      });
-  sys.mesh_query = ecs_query(ecs, {
-                                      .terms =
-                                          {
-                                              {.id = ecs_id(TbMeshComponent)},
-                                              {.id = ecs_id(TbRenderObject)},
-                                          },
-                                      .cache_kind = EcsQueryCacheAuto,
-                                  });
+  sys.pending_draw_query =
+      ecs_query(ecs, {
+                         .terms =
+                             {
+                                 {.id = ecs_id(TbMeshComponent)},
+                                 {.id = ecs_id(TbRenderObject)},
+                                 {.id = ecs_id(TbMeshDrawSlots),
+                                  .oper = EcsNot},
+                             },
+                         .cache_kind = EcsQueryCacheAuto,
+                     });
+  sys.drawn_query =
+      ecs_query(ecs, {
+                         .terms =
+                             {
+                                 {.id = ecs_id(TbMeshDrawSlots)},
+                                 {.id = ecs_id(TbRenderObject)},
+                             },
+                         .cache_kind = EcsQueryCacheAuto,
+                     });
   sys.dir_light_query =
       ecs_query(ecs, {
                          .terms =
@@ -1313,7 +1842,8 @@ void tb_unregister_mesh_sys(TbWorld *world) {
 
   TbMeshSystem *sys = ecs_singleton_ensure(ecs, TbMeshSystem);
   ecs_query_fini(sys->dir_light_query);
-  ecs_query_fini(sys->mesh_query);
+  ecs_query_fini(sys->drawn_query);
+  ecs_query_fini(sys->pending_draw_query);
   ecs_query_fini(sys->camera_query);
   destroy_mesh_system(ecs, sys);
   ecs_singleton_remove(ecs, TbMeshSystem);
@@ -1,11 +1,19 @@
 #include "tb_mesh_system.h"
 
 #include "tb_assets.h"
+#include "tb_camera_component.h"
 #include "tb_dyn_desc_pool.h"
+#include "tb_frame_stats.h"
 #include "tb_gltf.h"
 #include "tb_log.h"
 #include "tb_material_system.h"
+#include "tb_mesh_component.h"
+#include "tb_mesh_opt.h"
+#include "tb_mesh_ranges.h"
+#include "tb_offset_alloc.h"
+#include "tb_profiling.h"
 #include "tb_task_scheduler.h"
+#include "tb_transform_component.h"
 #include "tb_util.h"
 
 // Internals
@@ -15,6 +23,17 @@
 #define TB_MAX_MESH_QUEUE_PER_FRAME 4
 #define TB_MAX_SUBMESH_QUEUE_PER_FRAME 4
 
+// Capacity of the geometry arena that every mesh is suballocated from
+#ifndef TB_MESH_ARENA_MAX_INDICES
+#define TB_MESH_ARENA_MAX_INDICES (1 << 24)
+#endif
+#ifndef TB_MESH_ARENA_MAX_VERTICES
+#define TB_MESH_ARENA_MAX_VERTICES (1 << 22)
+#endif
+#define TB_MESH_ARENA_MAX_ALLOCS 16384
+// Texel buffer views must start on this alignment on every device
+#define TB_MESH_ARENA_STREAM_ALIGNMENT 256
+
 // Mesh system probably shouldn't own this
 ECS_COMPONENT_DECLARE(TbAABB);
 
@@ -30,9 +49,47 @@ typedef uint32_t TbPerFrameSubmeshQueueCounter;
 ECS_COMPONENT_DECLARE(TbPerFrameSubmeshQueueCounter);
 
 ECS_COMPONENT_DECLARE(TbSubMesh2Data);
+ECS_COMPONENT_DECLARE(TbSubMeshMeshlets);
+ECS_COMPONENT_DECLARE(TbSubMeshLods);
+
+// Each stream of the arena is viewed by one descriptor in the matching pool
+typedef enum TbMeshStream {
+  TB_MESH_STREAM_INDEX,
+  TB_MESH_STREAM_POSITION,
+  TB_MESH_STREAM_NORMAL,
+  TB_MESH_STREAM_TANGENT,
+  TB_MESH_STREAM_TEXCOORD0,
+  TB_MESH_STREAM_COUNT,
+} TbMeshStream;
+
+static const VkFormat tb_mesh_stream_formats[TB_MESH_STREAM_COUNT] = {
+    VK_FORMAT_R32_UINT,       VK_FORMAT_R16G16B16A16_SINT,
+    VK_FORMAT_R8G8B8A8_SNORM, VK_FORMAT_R8G8B8A8_SNORM,
+    VK_FORMAT_R16G16_SINT,
+};
+static const uint32_t tb_mesh_stream_strides[TB_MESH_STREAM_COUNT] = {
+    sizeof(uint32_t), sizeof(int16_t) * 4, sizeof(int8_t) * 4,
+    sizeof(int8_t) * 4, sizeof(int16_t) * 2,
+};
+
+// One buffer holding the geometry of every mesh. Indices and vertices are
+// allocated separately and a mesh's vertex range is reserved in every
+// attribute stream whether or not it uses that attribute so that one vertex
+// offset addresses them all
+typedef struct TbMeshArena {
+  SDL_Mutex *lock; // Meshes are loaded on worker threads
+  TbMeshRanges ranges;
+  TbBuffer buffer;
+  uint64_t stream_offsets[TB_MESH_STREAM_COUNT];
+  VkBufferView views[TB_MESH_STREAM_COUNT];
+  // Must outlive the descriptor pool writes that reference them
+  TbDynDescWrite desc_writes[TB_MESH_STREAM_COUNT];
+  TbMeshIndex desc_idx;
+} TbMeshArena;
 
 typedef struct TbMeshCtx {
   uint32_t owned_mesh_count;
+  TbMeshArena *arena;
   VkDescriptorSetLayout set_layout;
   TbDynDescPool idx_desc_pool;
   TbDynDescPool pos_desc_pool;
@@ -42,6 +99,8 @@ typedef struct TbMeshCtx {
 
   ecs_query_t *mesh_load_query;
   ecs_query_t *submesh_load_query;
+  ecs_query_t *camera_query;
+  ecs_query_t *inst_query;
 
   TbDescriptorBuffer idx_desc_buf;
   TbDescriptorBuffer pos_desc_buf;
@@ -52,21 +111,24 @@ typedef struct TbMeshCtx {
 ECS_COMPONENT_DECLARE(TbMeshCtx);
 
 typedef struct TbMeshData {
-  VkIndexType idx_type;
-  TbHostBuffer host_buffer;
-  TbBuffer gpu_buffer;
-#if TB_USE_DESC_BUFFER == 1
-  VkDescriptorAddressInfoEXT index_addr;
-  VkDescriptorAddressInfoEXT attribute_addr[TB_INPUT_PERM_COUNT];
-#else
-  VkBufferView index_view;
-  VkBufferView attr_views[TB_INPUT_PERM_COUNT];
-#endif
+  TbHostBuffer host_buffer; // Only used when the arena isn't host visible
+  TbOffsetAllocation index_alloc;
+  TbOffsetAllocation vertex_alloc;
+  // One entry per primitive. Handed to submeshes once they are created
+  uint32_t submesh_count;
+  TbSubMeshMeshlets *submesh_meshlets;
+  TbSubMeshLods *submesh_lods;
+  // Upload of the mesh's arena ranges. 0 when they were written directly
+  uint64_t upload_value;
 } TbMeshData;
 ECS_COMPONENT_DECLARE(TbMeshData);
 
 ECS_COMPONENT_DECLARE(TbMeshIndex);
 
+// How many holders a mesh has
+typedef uint32_t TbMeshRefCount;
+ECS_COMPONENT_DECLARE(TbMeshRefCount);
+
 // Describes the creation of a mesh that lives in a GLB file
 typedef struct TbMeshGLTFLoadRequest {
   cgltf_data *data;
@@ -85,6 +147,9 @@ ECS_TAG_DECLARE(TbMeshParsed);
 ECS_TAG_DECLARE(TbMeshReady);
 ECS_TAG_DECLARE(TbSubMeshParsed);
 ECS_TAG_DECLARE(TbSubMeshReady);
+ECS_TAG_DECLARE(TbMeshUnreferenced);
+// The mesh could not be loaded and never becomes ready
+ECS_TAG_DECLARE(TbMeshLoadFailed);
 
 typedef struct TbMeshLoadedArgs {
   ecs_world_t *ecs;
@@ -107,6 +172,16 @@ void tb_mesh_loaded(const void *args) {
     TB_CHECK(false, "Mesh load failed. Do we need to retry?");
   }
 
+  SDL_AtomicDecRef(counter);
+  tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, -1);
+
+  // Without space in the arena there is nothing for submeshes to point at
+  if (loaded_args->comp.index_alloc.offset == TB_OFFSET_ALLOC_NO_SPACE) {
+    ecs_add(ecs, mesh, TbMeshLoadFailed);
+    tb_release_glb(data);
+    return;
+  }
+
   TbSubMeshGLTFLoadRequest submesh_req = {
       .data = data,
       .gltf_mesh = gltf_mesh,
@@ -116,13 +191,12 @@ void tb_mesh_loaded(const void *args) {
   ecs_add(ecs, mesh, TbMeshParsed);
   ecs_set_ptr(ecs, mesh, TbMeshData, &loaded_args->comp);
   ecs_set_ptr(ecs, mesh, TbSubMeshGLTFLoadRequest, &submesh_req);
-
-  SDL_AtomicDecRef(counter);
 }
 
 typedef struct TbLoadCommonMeshArgs {
   ecs_world_t *ecs;
   TbRenderSystem *rnd_sys;
+  TbMeshArena *arena;
   TbMesh2 mesh;
   TbTaskScheduler enki;
   TbPinnedTask loaded_task;
@@ -134,278 +208,469 @@ typedef struct TbLoadGLTFMeshArgs {
   TbMeshQueueCounter *counter;
 } TbLoadGLTFMeshArgs;
 
-TbMeshData tb_load_gltf_mesh(TbRenderSystem *rnd_sys,
-                             const cgltf_mesh *gltf_mesh) {
-  TB_TRACY_SCOPE("Load GLTF Mesh");
-  TbMeshData data = {0};
+static uint32_t tb_mesh_stream_capacity(TbMeshStream stream) {
+  return stream == TB_MESH_STREAM_INDEX ? TB_MESH_ARENA_MAX_INDICES
+                                        : TB_MESH_ARENA_MAX_VERTICES;
+}
 
-  // Determine how big this mesh is
-  uint64_t index_size = 0;
-  uint64_t geom_size = 0;
-  uint64_t attr_size_per_type[cgltf_attribute_type_max_enum] = {0};
-  {
-    // Determine mesh index type
-    {
-      tb_auto stride = gltf_mesh->primitives[0].indices->stride;
-      if (stride == sizeof(uint16_t)) {
-        data.idx_type = VK_INDEX_TYPE_UINT16;
-      } else if (stride == sizeof(uint32_t)) {
-        data.idx_type = VK_INDEX_TYPE_UINT32;
-      } else {
-        TB_CHECK(false, "Unexpected index stride");
-      }
-    }
+// Only the first set of each attribute we care about gets a stream
+static int32_t tb_mesh_stream_from_attr(const cgltf_attribute *attr) {
+  if (attr->index != 0) {
+    return -1;
+  }
+  switch (attr->type) {
+  case cgltf_attribute_type_position:
+    return TB_MESH_STREAM_POSITION;
+  case cgltf_attribute_type_normal:
+    return TB_MESH_STREAM_NORMAL;
+  case cgltf_attribute_type_tangent:
+    return TB_MESH_STREAM_TANGENT;
+  case cgltf_attribute_type_texcoord:
+    return TB_MESH_STREAM_TEXCOORD0;
+  default:
+    return -1;
+  }
+}
 
-    uint64_t vertex_size = 0;
-    uint32_t vertex_count = 0;
-    for (cgltf_size prim_idx = 0; prim_idx < gltf_mesh->primitives_count;
-         ++prim_idx) {
-      cgltf_primitive *prim = &gltf_mesh->primitives[prim_idx];
-      cgltf_accessor *indices = prim->indices;
-      cgltf_size idx_size =
-          tb_calc_aligned_size(indices->count, indices->stride, 16);
+static TbMeshArena *tb_create_mesh_arena(TbRenderSystem *rnd_sys) {
+  TB_TRACY_SCOPE("Create Mesh Arena");
+  tb_auto limits = &rnd_sys->render_thread->gpu_props.properties.limits;
+  TB_CHECK(TB_MESH_ARENA_MAX_INDICES <= limits->maxTexelBufferElements &&
+               TB_MESH_ARENA_MAX_VERTICES <= limits->maxTexelBufferElements,
+           "Mesh arena streams exceed the max texel buffer size");
 
-      index_size += idx_size;
-      vertex_count = prim->attributes[0].data->count;
+  tb_auto arena = tb_alloc_tp(tb_global_alloc, TbMeshArena);
+  *arena = (TbMeshArena){
+      .lock = SDL_CreateMutex(),
+  };
+  tb_create_mesh_ranges(tb_global_alloc, TB_MESH_ARENA_MAX_INDICES,
+                        TB_MESH_ARENA_MAX_VERTICES, TB_MESH_ARENA_MAX_ALLOCS,
+                        &arena->ranges);
+
+  // Streams are laid out back to back
+  uint64_t size = 0;
+  for (uint32_t i = 0; i < TB_MESH_STREAM_COUNT; ++i) {
+    arena->stream_offsets[i] = size;
+    size += tb_calc_aligned_size(tb_mesh_stream_capacity(i),
+                                 tb_mesh_stream_strides[i],
+                                 TB_MESH_ARENA_STREAM_ALIGNMENT);
+  }
 
-      for (cgltf_size attr_idx = 0; attr_idx < prim->attributes_count;
-           ++attr_idx) {
-        // Only care about certain attributes at the moment
-        cgltf_attribute_type type = prim->attributes[attr_idx].type;
-        int32_t idx = prim->attributes[attr_idx].index;
-        if ((type == cgltf_attribute_type_position ||
-             type == cgltf_attribute_type_normal ||
-             type == cgltf_attribute_type_tangent ||
-             type == cgltf_attribute_type_texcoord) &&
-            idx == 0) {
-          cgltf_accessor *attr = prim->attributes[attr_idx].data;
-          uint64_t attr_size = vertex_count * attr->stride;
-          attr_size_per_type[type] += attr_size;
-        }
-      }
+  VkBufferCreateInfo create_info = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .size = size,
+      .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+               VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+               VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+               VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+               VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT |
+               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+               VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+  };
+  tb_rnd_sys_alloc_gpu_buffer(rnd_sys, &create_info, "Mesh Arena",
+                              &arena->buffer);
+
+  for (uint32_t i = 0; i < TB_MESH_STREAM_COUNT; ++i) {
+    VkBufferViewCreateInfo view_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,
+        .buffer = arena->buffer.buffer,
+        .offset = arena->stream_offsets[i],
+        .range = (uint64_t)tb_mesh_stream_capacity(i) *
+                 tb_mesh_stream_strides[i],
+        .format = tb_mesh_stream_formats[i],
+    };
+    tb_rnd_create_buffer_view(rnd_sys, &view_info, "Mesh Arena Stream View",
+                              &arena->views[i]);
+    arena->desc_writes[i] = (TbDynDescWrite){
+        .type = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
+        .desc.texel_buffer = arena->views[i],
+    };
+  }
 
-      for (uint32_t i = 0; i < cgltf_attribute_type_max_enum; ++i) {
-        tb_auto attr_size = attr_size_per_type[i];
-        if (attr_size > 0) {
-          attr_size_per_type[i] = tb_calc_aligned_size(1, attr_size, 16);
-          vertex_size += attr_size_per_type[i];
-        }
-      }
-    }
+  TB_LOG_DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+               "Created mesh arena of %.1fMB for %u indices and %u vertices",
+               (double)size / (1024.0 * 1024.0), TB_MESH_ARENA_MAX_INDICES,
+               TB_MESH_ARENA_MAX_VERTICES);
+  return arena;
+}
 
-    geom_size = index_size + vertex_size;
+static void tb_destroy_mesh_arena(TbRenderSystem *rnd_sys,
+                                  TbMeshArena *arena) {
+  for (uint32_t i = 0; i < TB_MESH_STREAM_COUNT; ++i) {
+    tb_rnd_destroy_buffer_view(rnd_sys, arena->views[i]);
   }
+  tb_rnd_free_gpu_buffer(rnd_sys, &arena->buffer);
+  tb_destroy_mesh_ranges(&arena->ranges);
+  SDL_DestroyMutex(arena->lock);
+  tb_free(tb_global_alloc, arena);
+}
 
-  uint64_t attr_offset_per_type[cgltf_attribute_type_max_enum] = {0};
-  {
-    uint64_t offset = index_size;
-    for (uint32_t i = 0; i < cgltf_attribute_type_max_enum; ++i) {
-      tb_auto attr_size = attr_size_per_type[i];
-      if (attr_size > 0) {
-        attr_offset_per_type[i] = offset;
-        offset += attr_size;
-      }
+// Reserves index and vertex ranges for a mesh. Nothing is reserved if either
+// doesn't fit
+static bool tb_mesh_arena_alloc(TbMeshArena *arena, uint32_t index_count,
+                                uint32_t vertex_count,
+                                TbOffsetAllocation *index_alloc,
+                                TbOffsetAllocation *vertex_alloc) {
+  TbMeshArenaRange range = {0};
+  SDL_LockMutex(arena->lock);
+  const bool ok =
+      tb_alloc_mesh_range(&arena->ranges, index_count, vertex_count, &range);
+  SDL_UnlockMutex(arena->lock);
+  *index_alloc = range.index_alloc;
+  *vertex_alloc = range.vertex_alloc;
+  return ok;
+}
+
+// The arena only stores 32-bit indices so 16-bit indices are widened.
+// Expects the accessor's buffer view to already be decoded
+static void tb_read_indices(const cgltf_accessor *indices, uint32_t *dst) {
+  const uint8_t *src =
+      (const uint8_t *)indices->buffer_view->data + indices->offset;
+  tb_gltf_count_copy(indices->count * sizeof(uint32_t));
+  if (indices->stride == sizeof(uint32_t)) {
+    SDL_memcpy(dst, src, indices->count * sizeof(uint32_t)); // NOLINT
+    return;
+  }
+  TB_CHECK(indices->stride == sizeof(uint16_t), "Unexpected index stride");
+  for (size_t i = 0; i < indices->count; ++i) {
+    dst[i] = ((const uint16_t *)src)[i];
+  }
+}
+
+static const cgltf_accessor *
+tb_find_prim_positions(const cgltf_primitive *prim) {
+  for (cgltf_size attr_idx = 0; attr_idx < prim->attributes_count;
+       ++attr_idx) {
+    if (prim->attributes[attr_idx].type == cgltf_attribute_type_position) {
+      return prim->attributes[attr_idx].data;
     }
   }
+  return NULL;
+}
 
-  // Create space for the mesh on the GPU
-  void *ptr = NULL;
-  TbBufferCopy buf_copy = {0};
-  {
+// Only primitives large enough for meshlets or LODs are read back on the CPU
+static bool tb_is_prim_optimized(const cgltf_primitive *prim) {
+  return prim->type == cgltf_primitive_type_triangles &&
+         prim->indices->count / 3 >=
+             SDL_min(TB_MESHLET_MIN_TRIANGLES, TB_MESH_LOD_MIN_TRIANGLES) &&
+         tb_find_prim_positions(prim) != NULL;
+}
 
-    VkBufferCreateInfo create_info = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = geom_size,
-        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
-                 VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                 VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
-                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
-                 VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT |
-                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-                 VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-    };
-    char mesh_name[512] = {0};
+// Leaves the geometry empty when the primitive is too small to optimize
+static void tb_read_prim_geometry(const cgltf_primitive *prim,
+                                  TbPrimGeometry *geom) {
+  *geom = (TbPrimGeometry){0};
+  if (!tb_is_prim_optimized(prim)) {
+    return;
+  }
 
-    tb_rnd_sys_create_gpu_buffer_noup(rnd_sys, &create_info, mesh_name,
-                                      &data.gpu_buffer, &data.host_buffer,
-                                      &ptr);
+  tb_auto indices = prim->indices;
+  const size_t index_count = indices->count;
+  tb_auto positions = tb_find_prim_positions(prim);
+  cgltf_result res =
+      tb_decompress_buffer_view(tb_thread_alloc, indices->buffer_view);
+  TB_CHECK(res == cgltf_result_success, "Failed to decode buffer view");
+  res = tb_decompress_buffer_view(tb_thread_alloc, positions->buffer_view);
+  TB_CHECK(res == cgltf_result_success, "Failed to decode buffer view");
+
+  geom->index_count = index_count;
+  geom->indices = tb_alloc_nm_tp(tb_thread_alloc, index_count, uint32_t);
+  tb_read_indices(indices, geom->indices);
+  geom->vertex_count = positions->count;
+  geom->positions =
+      tb_alloc_nm_tp(tb_thread_alloc, geom->vertex_count * 3, float);
+  cgltf_accessor_unpack_floats(positions, geom->positions,
+                               geom->vertex_count * 3);
+}
 
-    buf_copy = (TbBufferCopy){
-        .dst = data.gpu_buffer.buffer,
-        .src = data.host_buffer.buffer,
-        .region =
-            {
-                .size = create_info.size,
-            },
-    };
+static void tb_free_prim_geometry(TbPrimGeometry *geom) {
+  if (geom->indices) {
+    tb_free(tb_thread_alloc, geom->indices);
+    tb_free(tb_thread_alloc, geom->positions);
   }
+  *geom = (TbPrimGeometry){0};
+}
 
-  // Read the cgltf mesh into the driver owned memory
-  {
-    uint64_t idx_offset = 0;
-    uint64_t vertex_count = 0;
-    cgltf_size attr_count = 0;
-    for (cgltf_size prim_idx = 0; prim_idx < gltf_mesh->primitives_count;
-         ++prim_idx) {
-      tb_auto prim = &gltf_mesh->primitives[prim_idx];
+static void tb_free_prim_scratch(cgltf_size prim_count,
+                                 TbPrimGeometry *prim_geoms,
+                                 TbPrimLods *prim_lods) {
+  for (cgltf_size prim_idx = 0; prim_idx < prim_count; ++prim_idx) {
+    tb_free_lods(&prim_lods[prim_idx]);
+    tb_free_prim_geometry(&prim_geoms[prim_idx]);
+  }
+  tb_free(tb_thread_alloc, prim_lods);
+  tb_free(tb_thread_alloc, prim_geoms);
+}
 
-      {
-        tb_auto indices = prim->indices;
-        tb_auto view = indices->buffer_view;
-        cgltf_size src_size = indices->count * indices->stride;
-        cgltf_size padded_size =
-            tb_calc_aligned_size(indices->count, indices->stride, 16);
-
-        // Decode the buffer
-        cgltf_result res = tb_decompress_buffer_view(tb_thread_alloc, view);
-        TB_CHECK(res == cgltf_result_success, "Failed to decode buffer view");
-
-        void *src = ((uint8_t *)view->data) + indices->offset;
-        void *dst = ((uint8_t *)(ptr)) + idx_offset;
-        SDL_memcpy(dst, src, src_size); // NOLINT
-        idx_offset += padded_size;
-      }
+TbMeshData tb_load_gltf_mesh(TbRenderSystem *rnd_sys, TbTaskScheduler enki,
+                             TbMeshArena *arena, const cgltf_mesh *gltf_mesh) {
+  TB_TRACY_SCOPE("Load GLTF Mesh");
+  TbMeshData data = {0};
 
-      // Determine the order of attributes
-      cgltf_size attr_order[6] = {0};
-      {
-        const cgltf_attribute_type req_order[6] = {
-            cgltf_attribute_type_position, cgltf_attribute_type_normal,
-            cgltf_attribute_type_tangent,  cgltf_attribute_type_texcoord,
-            cgltf_attribute_type_joints,   cgltf_attribute_type_weights,
+  const cgltf_size prim_count = gltf_mesh->primitives_count;
+
+  // Indices and the positions of primitives that are optimized are needed
+  // on the CPU so decode them together before anything reads them
+  {
+    uint32_t decode_count = 0;
+    tb_auto decodes =
+        tb_alloc_nm_tp(tb_thread_alloc, prim_count * 2, TbBufferViewDecode);
+    for (cgltf_size prim_idx = 0; prim_idx < prim_count; ++prim_idx) {
+      tb_auto prim = &gltf_mesh->primitives[prim_idx];
+      decodes[decode_count++] = (TbBufferViewDecode){
+          .view = prim->indices->buffer_view,
+      };
+      if (tb_is_prim_optimized(prim)) {
+        decodes[decode_count++] = (TbBufferViewDecode){
+            .view = tb_find_prim_positions(prim)->buffer_view,
         };
-        cgltf_size attr_target_idx = 0;
-        for (uint32_t i = 0; i < 6; ++i) {
-          bool found = false;
-          for (cgltf_size attr_idx = 0; attr_idx < prim->attributes_count;
-               ++attr_idx) {
-            cgltf_attribute *attr = &prim->attributes[attr_idx];
-            if (attr->type == req_order[i]) {
-              attr_order[attr_target_idx] = attr_idx;
-              attr_target_idx++;
-              if (prim_idx == 0) {
-                attr_count++;
-              }
-              found = true;
-            }
-            if (found) {
-              break;
-            }
-          }
-        }
       }
+    }
+    cgltf_result res = tb_decompress_buffer_views(enki, tb_thread_alloc,
+                                                  decode_count, decodes);
+    TB_CHECK(res == cgltf_result_success, "Failed to decode buffer views");
+    tb_free(tb_thread_alloc, decodes);
+  }
 
-      for (cgltf_size attr_idx = 0; attr_idx < attr_count; ++attr_idx) {
-        cgltf_attribute *attr = &prim->attributes[attr_order[attr_idx]];
-        cgltf_accessor *accessor = attr->data;
-        cgltf_buffer_view *view = accessor->buffer_view;
+  // Large primitives are simplified up front since their LODs need space in
+  // the arena
+  tb_auto prim_geoms =
+      tb_alloc_nm_tp(tb_thread_alloc, prim_count, TbPrimGeometry);
+  tb_auto prim_lods = tb_alloc_nm_tp(tb_thread_alloc, prim_count, TbPrimLods);
+  {
+    TB_TRACY_SCOPE("Simplify Mesh");
+    const uint64_t start = SDL_GetPerformanceCounter();
+    uint32_t lod_count = 0;
+    for (cgltf_size prim_idx = 0; prim_idx < prim_count; ++prim_idx) {
+      tb_read_prim_geometry(&gltf_mesh->primitives[prim_idx],
+                            &prim_geoms[prim_idx]);
+      prim_lods[prim_idx] = tb_build_lods(&prim_geoms[prim_idx]);
+      lod_count += SDL_max(prim_lods[prim_idx].lods.count, 1) - 1;
+    }
+    if (lod_count > 0) {
+      const double ms = (double)(SDL_GetPerformanceCounter() - start) *
+                        1000.0 / (double)SDL_GetPerformanceFrequency();
+      TB_LOG_DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+                   "Simplified mesh %s into %u LODs in %.3fms",
+                   gltf_mesh->name ? gltf_mesh->name : "(unnamed)", lod_count,
+                   ms);
+    }
+  }
 
-        uint64_t mesh_vert_offset = vertex_count * attr->data->stride;
-        uint64_t vtx_offset =
-            attr_offset_per_type[attr->type] + mesh_vert_offset;
+  // Determine how much of the arena this mesh needs and which attribute
+  // streams it actually fills
+  uint32_t index_count = 0;
+  uint32_t vertex_count = 0;
+  bool stream_used[TB_MESH_STREAM_COUNT] = {[TB_MESH_STREAM_INDEX] = true};
+  for (cgltf_size prim_idx = 0; prim_idx < prim_count; ++prim_idx) {
+    tb_auto prim = &gltf_mesh->primitives[prim_idx];
+    index_count += prim->indices->count;
+    vertex_count += prim->attributes[0].data->count;
+    for (cgltf_size attr_idx = 0; attr_idx < prim->attributes_count;
+         ++attr_idx) {
+      tb_auto attr = &prim->attributes[attr_idx];
+      const int32_t stream = tb_mesh_stream_from_attr(attr);
+      if (stream >= 0) {
+        stream_used[stream] = true;
+      }
+    }
+    // Simplified indices are packed after the indices of every primitive
+    tb_auto lods = &prim_lods[prim_idx].lods;
+    for (uint32_t lod = 1; lod < lods->count; ++lod) {
+      index_count += lods->lods[lod].index_count;
+    }
+  }
 
-        size_t src_size = accessor->stride * accessor->count;
+  // Nothing is written when the arena is full. The failed ranges tell the
+  // loaded task not to create any submeshes
+  if (!tb_mesh_arena_alloc(arena, index_count, vertex_count, &data.index_alloc,
+                           &data.vertex_alloc)) {
+    TB_LOG_ERROR(SDL_LOG_CATEGORY_APPLICATION,
+                 "Mesh arena is out of space for %s (%u indices, %u vertices)",
+                 gltf_mesh->name ? gltf_mesh->name : "(unnamed)", index_count,
+                 vertex_count);
+    tb_free_prim_scratch(prim_count, prim_geoms, prim_lods);
+    return data;
+  }
 
-        // Decode the buffer
-        cgltf_result res = tb_decompress_buffer_view(tb_thread_alloc, view);
-        TB_CHECK(res == cgltf_result_success, "Failed to decode buffer view");
+  // Write each stream's range in place when the arena is host visible.
+  // Otherwise the ranges are staged back to back and copied individually
+  uint8_t *stream_ptrs[TB_MESH_STREAM_COUNT] = {0};
+  uint32_t copy_count = 0;
+  TbBufferCopy copies[TB_MESH_STREAM_COUNT] = {0};
+  uint64_t stream_sizes[TB_MESH_STREAM_COUNT] = {0};
+  uint64_t staging_size = 0;
+  for (uint32_t i = 0; i < TB_MESH_STREAM_COUNT; ++i) {
+    if (stream_used[i]) {
+      const uint32_t count =
+          i == TB_MESH_STREAM_INDEX ? index_count : vertex_count;
+      stream_sizes[i] = (uint64_t)count * tb_mesh_stream_strides[i];
+      staging_size += tb_calc_aligned_size(1, stream_sizes[i], 16);
+    }
+  }
 
-        void *src = ((uint8_t *)view->data) + accessor->offset;
-        void *dst = ((uint8_t *)(ptr)) + vtx_offset;
-        SDL_memcpy(dst, src, src_size); // NOLINT
-      }
+  uint8_t *mapped = arena->buffer.info.pMappedData;
+  if (mapped == NULL) {
+    VkBufferCreateInfo create_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = staging_size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    };
+    tb_rnd_sys_alloc_host_buffer(rnd_sys, &create_info, "Mesh Staging",
+                                 &data.host_buffer);
+  }
 
-      vertex_count += prim->attributes[0].data->count;
+  uint64_t staging_offset = 0;
+  for (uint32_t i = 0; i < TB_MESH_STREAM_COUNT; ++i) {
+    if (!stream_used[i]) {
+      continue;
     }
+    const uint64_t base = i == TB_MESH_STREAM_INDEX
+                              ? data.index_alloc.offset
+                              : data.vertex_alloc.offset;
+    const uint64_t dst_offset =
+        arena->stream_offsets[i] + base * tb_mesh_stream_strides[i];
+    if (mapped) {
+      stream_ptrs[i] = mapped + dst_offset;
+      continue;
+    }
+    stream_ptrs[i] =
+        (uint8_t *)data.host_buffer.info.pMappedData + staging_offset;
+    copies[copy_count++] = (TbBufferCopy){
+        .src = data.host_buffer.buffer,
+        .dst = arena->buffer.buffer,
+        .region =
+            {
+                .srcOffset = staging_offset,
+                .dstOffset = dst_offset,
+                .size = stream_sizes[i],
+            },
+    };
+    staging_offset += tb_calc_aligned_size(1, stream_sizes[i], 16);
+  }
 
-    // Construct one write per primitive
-    {
-      static const VkFormat
-          attr_formats_per_type[cgltf_attribute_type_max_enum] = {
-              VK_FORMAT_UNDEFINED,         VK_FORMAT_R16G16B16A16_SINT,
-              VK_FORMAT_R8G8B8A8_SNORM,    VK_FORMAT_R8G8B8A8_SNORM,
-              VK_FORMAT_R16G16_SINT,       VK_FORMAT_R8G8B8A8_UNORM,
-              VK_FORMAT_R16G16B16A16_SINT, VK_FORMAT_R8G8B8A8_SINT,
-          };
-      static const int32_t attr_idx_per_type[cgltf_attribute_type_max_enum] = {
-          -1, 0, 1, 2, 3, -1, 5, 6, -1,
-      };
-
-      // Create one buffer view for indices
-      {
-        VkFormat idx_format = VK_FORMAT_R16_UINT;
-        if (data.idx_type == VK_INDEX_TYPE_UINT32) {
-          idx_format = VK_FORMAT_R32_UINT;
-        }
-        TB_CHECK(index_size, "Unexpected index size of 0");
+  // Read the cgltf mesh into the arena
+  data.submesh_count = prim_count;
+  data.submesh_meshlets =
+      tb_alloc_nm_tp(tb_global_alloc, prim_count, TbSubMeshMeshlets);
+  data.submesh_lods =
+      tb_alloc_nm_tp(tb_global_alloc, prim_count, TbSubMeshLods);
+  SDL_memset(data.submesh_meshlets, 0, prim_count * sizeof(TbSubMeshMeshlets));
+  SDL_memset(data.submesh_lods, 0, prim_count * sizeof(TbSubMeshLods));
+  tb_auto dst_indices = (uint32_t *)stream_ptrs[TB_MESH_STREAM_INDEX];
+  uint32_t index_offset = 0;
+  uint32_t attr_count = 0;
+  for (cgltf_size prim_idx = 0; prim_idx < prim_count; ++prim_idx) {
+    tb_auto prim = &gltf_mesh->primitives[prim_idx];
+    tb_auto indices = prim->indices;
+    attr_count += prim->attributes_count;
+
+    // Decode the buffer
+    cgltf_result res =
+        tb_decompress_buffer_view(tb_thread_alloc, indices->buffer_view);
+    TB_CHECK(res == cgltf_result_success, "Failed to decode buffer view");
+
+    // Large primitives have their indices reordered into meshlets
+    tb_auto dst = &dst_indices[index_offset];
+    const bool double_sided = prim->material && prim->material->double_sided;
+    tb_auto meshlets =
+        tb_build_meshlets(&prim_geoms[prim_idx], double_sided, dst);
+    if (meshlets.count == 0) {
+      tb_read_indices(indices, dst);
+    }
+    data.submesh_meshlets[prim_idx] = meshlets;
+    index_offset += indices->count;
+  }
 
-#if TB_USE_DESC_BUFFER == 1
-        data.index_addr = (VkDescriptorAddressInfoEXT){
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
-            .address = data.gpu_buffer.address,
-            .range = index_size,
-            .format = idx_format,
-        };
-#else
-        VkBufferViewCreateInfo create_info = {
-            .sType = VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,
-            .buffer = data.gpu_buffer.buffer,
-            .offset = 0,
-            .range = index_size,
-            .format = idx_format,
-        };
-        tb_rnd_create_buffer_view(rnd_sys, &create_info, "Mesh Index View",
-                                  &data.index_view);
-#endif
+  // Views that hold exactly one accessor in the layout of its stream are
+  // decoded straight into upload memory. Any other view is decoded into
+  // memory it keeps and the accessor is copied out of it afterwards.
+  // Uncompressed views are never decoded so either way each byte is copied
+  // once, from the mapped glb to upload memory
+  uint32_t decode_count = 0;
+  tb_auto decodes =
+      tb_alloc_nm_tp(tb_thread_alloc, attr_count, TbBufferViewDecode);
+  tb_auto attr_accessors =
+      tb_alloc_nm_tp(tb_thread_alloc, attr_count, const cgltf_accessor *);
+  tb_auto attr_dsts = tb_alloc_nm_tp(tb_thread_alloc, attr_count, uint8_t *);
+  uint32_t vertex_offset = 0;
+  for (cgltf_size prim_idx = 0; prim_idx < prim_count; ++prim_idx) {
+    tb_auto prim = &gltf_mesh->primitives[prim_idx];
+    const uint32_t prim_vertex_count = prim->attributes[0].data->count;
+    for (cgltf_size attr_idx = 0; attr_idx < prim->attributes_count;
+         ++attr_idx) {
+      tb_auto attr = &prim->attributes[attr_idx];
+      const int32_t stream = tb_mesh_stream_from_attr(attr);
+      if (stream < 0) {
+        continue;
       }
-
-#if TB_USE_DESC_BUFFER == 1
-      // Set a default buffer for each primitive
-      for (size_t attr_idx = 0; attr_idx < TB_INPUT_PERM_COUNT; ++attr_idx) {
-        data.attribute_addr[attr_idx] = (VkDescriptorAddressInfoEXT){
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
-            .range = VK_WHOLE_SIZE,
-        };
+      cgltf_accessor *accessor = attr->data;
+      const uint32_t stride = tb_mesh_stream_strides[stream];
+      // A mismatch would spill into the ranges of other meshes
+      if (accessor->stride != stride || accessor->count != prim_vertex_count) {
+        TB_CHECK(false, "Unexpected vertex attribute layout");
+        continue;
       }
-#endif
-
-      for (size_t attr_idx = 0; attr_idx < attr_count; ++attr_idx) {
-        cgltf_attribute *attr = &gltf_mesh->primitives[0].attributes[attr_idx];
 
-#if TB_USE_DESC_BUFFER == 1
-        VkDeviceAddress address =
-            data.gpu_buffer.address + attr_offset_per_type[attr->type];
-        data.attribute_addr[attr_idx_per_type[attr->type]] =
-            (VkDescriptorAddressInfoEXT){
-                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
-                .address = address,
-                .range = attr_size_per_type[attr->type],
-                .format = attr_formats_per_type[attr->type],
-            };
-#else
-        // Create a buffer view per attribute
-        VkBufferViewCreateInfo create_info = {
-            .sType = VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,
-            .buffer = data.gpu_buffer.buffer,
-            .offset = attr_offset_per_type[attr->type],
-            .range = VK_WHOLE_SIZE,
-            .format = attr_formats_per_type[attr->type],
-        };
-        tb_rnd_create_buffer_view(
-            rnd_sys, &create_info, "Mesh Attribute View",
-            &data.attr_views[attr_idx_per_type[attr->type]]);
-#endif
-      }
+      cgltf_buffer_view *view = accessor->buffer_view;
+      uint8_t *dst = stream_ptrs[stream] + (uint64_t)vertex_offset * stride;
+      const bool direct = view->data == NULL && accessor->offset == 0 &&
+                          tb_buffer_view_decoded_size(view) ==
+                              (uint64_t)accessor->count * stride;
+      attr_accessors[decode_count] = accessor;
+      attr_dsts[decode_count] = dst;
+      decodes[decode_count++] = (TbBufferViewDecode){
+          .view = view,
+          .dst = direct ? dst : NULL,
+      };
     }
+    vertex_offset += prim_vertex_count;
+  }
 
-    // Make sure to flush the gpu alloc if necessary
-    tb_flush_alloc(rnd_sys, data.gpu_buffer.alloc);
+  cgltf_result res = tb_decompress_buffer_views(enki, tb_thread_alloc,
+                                                decode_count, decodes);
+  TB_CHECK(res == cgltf_result_success, "Failed to decode buffer views");
 
-    // Only enqueue this buffer upload request after the allocation is flushed
-    if (buf_copy.src != NULL) {
-      tb_rnd_upload_buffers(rnd_sys, &buf_copy, 1);
+  for (uint32_t i = 0; i < decode_count; ++i) {
+    tb_auto accessor = attr_accessors[i];
+    tb_auto view = accessor->buffer_view;
+    if (decodes[i].dst != NULL || view->data == NULL) {
+      continue;
+    }
+    const uint8_t *src = (const uint8_t *)view->data + accessor->offset;
+    const size_t size = accessor->count * accessor->stride;
+    SDL_memcpy(attr_dsts[i], src, size); // NOLINT
+    tb_gltf_count_copy(size);
+  }
+  tb_free(tb_thread_alloc, attr_dsts);
+  tb_free(tb_thread_alloc, attr_accessors);
+  tb_free(tb_thread_alloc, decodes);
+  // Pack simplified indices after the full indices of every primitive.
+  // LOD offsets are relative to the start of their primitive's indices
+  uint32_t prim_index_offset = 0;
+  for (cgltf_size prim_idx = 0; prim_idx < prim_count; ++prim_idx) {
+    tb_auto lods = &prim_lods[prim_idx];
+    for (uint32_t lod = 1; lod < lods->lods.count; ++lod) {
+      tb_auto lod_info = &lods->lods.lods[lod];
+      lod_info->index_offset = index_offset - prim_index_offset;
+      SDL_memcpy(&dst_indices[index_offset], lods->indices[lod], // NOLINT
+                 lod_info->index_count * sizeof(uint32_t));
+      index_offset += lod_info->index_count;
     }
+    prim_index_offset += gltf_mesh->primitives[prim_idx].indices->count;
+    data.submesh_lods[prim_idx] = lods->lods;
+  }
+  TB_CHECK(index_offset == index_count, "Mesh indices did not fill range");
+
+  // Make sure to flush the arena if it was written directly
+  if (copy_count == 0) {
+    tb_flush_alloc(rnd_sys, arena->buffer.alloc);
+  } else {
+    data.upload_value =
+        tb_rnd_upload_buffers_async(rnd_sys, copies, copy_count);
   }
+
+  tb_free_prim_scratch(prim_count, prim_geoms, prim_lods);
   return data;
 }
 
@@ -413,6 +678,7 @@ void tb_load_gltf_mesh_task(const void *args) {
   TB_TRACY_SCOPE("Load GLTF Mesh Task");
   tb_auto load_args = (const TbLoadGLTFMeshArgs *)args;
   tb_auto rnd_sys = load_args->common.rnd_sys;
+  tb_auto arena = load_args->common.arena;
   tb_auto mesh = load_args->common.mesh;
   tb_auto data = load_args->gltf.data;
   tb_auto index = load_args->gltf.index;
@@ -423,7 +689,8 @@ void tb_load_gltf_mesh_task(const void *args) {
   // Queue upload of mesh data to the GPU
   TbMeshData mesh_data = {0};
   if (mesh != 0) {
-    mesh_data = tb_load_gltf_mesh(rnd_sys, gltf_mesh);
+    mesh_data = tb_load_gltf_mesh(rnd_sys, load_args->common.enki, arena,
+                                  gltf_mesh);
   }
 
   // Launch pinned task to handle loading signals on main thread
@@ -450,6 +717,62 @@ void tb_reset_queue_counters(ecs_iter_t *it) {
   *submesh_counter = 0;
 }
 
+static bool tb_is_mesh_load_pending(ecs_world_t *ecs, TbMesh2 mesh) {
+  return ecs_has(ecs, mesh, TbMeshGLTFLoadRequest) ||
+         ecs_has(ecs, mesh, TbSubMeshGLTFLoadRequest);
+}
+
+// Meshes closest to the camera load first. Priorities are worked out again
+// every frame since the camera keeps moving while loads are pending
+void tb_prioritize_mesh_loads(ecs_iter_t *it) {
+  TB_TRACY_SCOPE("Prioritize Mesh Loads");
+  tb_auto ecs = it->world;
+  tb_auto ctx = ecs_field(it, TbMeshCtx, 0);
+
+  if (!ecs_query_is_true(ctx->mesh_load_query) &&
+      !ecs_query_is_true(ctx->submesh_load_query)) {
+    return;
+  }
+
+  // Start over each frame. Pending meshes got a priority when requested
+  ecs_query_t *pending_queries[] = {
+      ctx->mesh_load_query,
+      ctx->submesh_load_query,
+  };
+  for (uint32_t q = 0; q < 2; ++q) {
+    tb_auto pending_it = ecs_query_iter(ecs, pending_queries[q]);
+    while (ecs_query_next(&pending_it)) {
+      for (int32_t i = 0; i < pending_it.count; ++i) {
+        tb_auto priority =
+            ecs_get_mut(ecs, pending_it.entities[i], TbLoadPriority);
+        if (priority) {
+          *priority = 0.0f;
+        }
+      }
+    }
+  }
+
+  // A mesh is as important as its closest instance
+  const float3 camera_pos = tb_get_camera_position(ecs, ctx->camera_query);
+  tb_auto inst_it = ecs_query_iter(ecs, ctx->inst_query);
+  while (ecs_query_next(&inst_it)) {
+    tb_auto mesh_comps = ecs_field(&inst_it, TbMeshComponent, 0);
+    for (int32_t i = 0; i < inst_it.count; ++i) {
+      tb_auto mesh = mesh_comps[i].mesh2;
+      if (!ecs_is_alive(ecs, mesh) || !tb_is_mesh_load_pending(ecs, mesh)) {
+        continue;
+      }
+      tb_auto priority = ecs_get_mut(ecs, mesh, TbLoadPriority);
+      if (priority == NULL) {
+        continue;
+      }
+      tb_auto pos = tb_transform_get_world_trans(ecs, inst_it.entities[i]);
+      const float dist = tb_magf3(pos.position - camera_pos);
+      *priority = SDL_max(*priority, 1.0f / (1.0f + dist));
+    }
+  }
+}
+
 void tb_queue_gltf_mesh_loads(ecs_iter_t *it) {
   TB_TRACY_SCOPE("Queue GLTF Mesh Loads");
 
@@ -460,55 +783,73 @@ void tb_queue_gltf_mesh_loads(ecs_iter_t *it) {
   tb_auto counter = ecs_field(it, TbMeshQueueCounter, 2);
   tb_auto queue_counter = ecs_field(it, TbPerFrameMeshQueueCounter, 3);
 
-  bool saturated = false;
+  tb_auto rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem);
+  tb_auto tmp_alloc =
+      rnd_sys->render_thread->frame_states[rnd_sys->frame_idx].tmp_alloc.alloc;
 
+  // Every pending load is considered so the most important go out first
+  TbLoadQueue pending = {0};
+  TB_DYN_ARR_RESET(pending, tmp_alloc, 64);
   tb_auto mesh_it = ecs_query_iter(ecs, ctx->mesh_load_query);
   while (ecs_query_next(&mesh_it)) {
-    if (saturated) {
-      break;
-    }
-    tb_auto reqs = ecs_field(&mesh_it, TbMeshGLTFLoadRequest, 0);
     for (int32_t i = 0; i < mesh_it.count; ++i) {
-      if (*queue_counter >= TB_MAX_MESH_QUEUE_PER_FRAME) {
-        saturated = true;
-        break;
-      }
-      (*queue_counter)++;
-
-      if (SDL_GetAtomicInt(counter) > TbMaxParallelMeshLoads) {
-        saturated = true;
-        break;
-      }
       TbMesh2 ent = mesh_it.entities[i];
-      tb_auto req = reqs[i];
-
-      // This pinned task will be launched by the loading task
-      TbPinnedTask loaded_task =
-          tb_create_pinned_task(enki, tb_mesh_loaded, NULL, 0);
-
-      TbLoadGLTFMeshArgs args = {
-          .common =
-              {
-                  .ecs = ecs,
-                  .rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem),
-                  .mesh = ent,
-                  .enki = enki,
-                  .loaded_task = loaded_task,
-              },
-          .gltf = req,
-          .counter = counter,
+      TbLoadQueueEntry entry = {
+          .ent = ent,
+          .priority = tb_get_load_priority(ecs, ent),
+          .cancelled = ecs_has(ecs, ent, TbMeshUnreferenced),
       };
-      TbTask load_task = tb_async_task(enki, tb_load_gltf_mesh_task, &args,
-                                       sizeof(TbLoadGLTFMeshArgs));
-      // Apply task component to mesh entity
-      ecs_set(ecs, ent, TbTask, {load_task});
-      SDL_AtomicIncRef(counter);
-      ctx->owned_mesh_count++;
-
-      // Remove load request as it has now been enqueued to the task system
-      ecs_remove(ecs, ent, TbMeshGLTFLoadRequest);
+      TB_DYN_ARR_APPEND(pending, entry);
     }
   }
+  const int32_t frame_slots =
+      TB_MAX_MESH_QUEUE_PER_FRAME - (int32_t)*queue_counter;
+  const int32_t parallel_slots =
+      TbMaxParallelMeshLoads - SDL_GetAtomicInt(counter);
+  tb_auto dispatch = tb_plan_load_dispatch(
+      enki, tmp_alloc, &pending,
+      (uint32_t)SDL_max(SDL_min(frame_slots, parallel_slots), 0));
+
+  // Nothing wants these meshes anymore so they don't need to load at all
+  for (uint32_t i = 0; i < dispatch.dropped_count; ++i) {
+    TbMesh2 ent = TB_DYN_ARR_AT(pending, dispatch.dropped[i]).ent;
+    tb_release_glb(ecs_get(ecs, ent, TbMeshGLTFLoadRequest)->data);
+    ecs_delete(ecs, ent);
+  }
+
+  for (uint32_t i = 0; i < dispatch.count; ++i) {
+    (*queue_counter)++;
+    TbMesh2 ent = TB_DYN_ARR_AT(pending, dispatch.order[i]).ent;
+    tb_auto req = *ecs_get(ecs, ent, TbMeshGLTFLoadRequest);
+
+    // This pinned task will be launched by the loading task
+    TbPinnedTask loaded_task =
+        tb_create_pinned_task(enki, tb_mesh_loaded, NULL, 0);
+
+    TbLoadGLTFMeshArgs args = {
+        .common =
+            {
+                .ecs = ecs,
+                .rnd_sys = rnd_sys,
+                .arena = ctx->arena,
+                .mesh = ent,
+                .enki = enki,
+                .loaded_task = loaded_task,
+            },
+        .gltf = req,
+        .counter = counter,
+    };
+    TbTask load_task = tb_async_task(enki, tb_load_gltf_mesh_task, &args,
+                                     sizeof(TbLoadGLTFMeshArgs));
+    // Apply task component to mesh entity
+    ecs_set(ecs, ent, TbTask, {load_task});
+    SDL_AtomicIncRef(counter);
+    tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, 1);
+    ctx->owned_mesh_count++;
+
+    // Remove load request as it has now been enqueued to the task system
+    ecs_remove(ecs, ent, TbMeshGLTFLoadRequest);
+  }
 }
 
 typedef struct TbSubMeshLoadArgs {
@@ -526,14 +867,16 @@ void tb_load_submeshes_task(const void *args) {
   tb_auto mesh = load_args->mesh;
   tb_auto gltf_mesh = load_args->req.gltf_mesh;
   tb_auto data = load_args->req.data;
+  tb_auto mesh_data = ecs_get(ecs, mesh, TbMeshData);
 
   // As we go through submeshes we also want to construct an AABB for this
   // mesh
   TbAABB mesh_aabb = tb_aabb_init();
 
-  // Meshes are uploaded so now we just need to setup submeshes
-  uint32_t index_offset = 0;
-  uint32_t vertex_offset = 0;
+  // Meshes are uploaded so now we just need to setup submeshes.
+  // Offsets are relative to the start of the arena's streams
+  uint32_t index_offset = mesh_data ? mesh_data->index_alloc.offset : 0;
+  uint32_t vertex_offset = mesh_data ? mesh_data->vertex_alloc.offset : 0;
   for (cgltf_size i = 0; i < gltf_mesh->primitives_count; ++i) {
     tb_auto prim = &gltf_mesh->primitives[i];
 
@@ -554,6 +897,8 @@ void tb_load_submeshes_task(const void *args) {
     } else {
       submesh_data.material = tb_mat_sys_load_gltf_mat(
           ecs, data, material->name, TB_MAT_USAGE_SCENE);
+      tb_raise_load_priority(ecs, submesh_data.material,
+                             tb_get_load_priority(ecs, mesh));
     }
 
     // Determine index size and count
@@ -562,12 +907,7 @@ void tb_load_submeshes_task(const void *args) {
 
       submesh_data.index_count = indices->count;
       submesh_data.index_offset = index_offset;
-
-      // calculate the aligned size
-      size_t index_size =
-          tb_calc_aligned_size(indices->count, indices->stride, 16);
-      // calculate number of indices that represent that aligned size
-      index_offset += (index_size / indices->stride);
+      index_offset += indices->count;
     }
 
     // Determine input permutation and attribute count
@@ -621,6 +961,15 @@ void tb_load_submeshes_task(const void *args) {
     }
     ecs_set_ptr(ecs, submesh, TbAABB, &submesh_aabb);
     ecs_set_ptr(ecs, submesh, TbSubMesh2Data, &submesh_data);
+    if (mesh_data && i < mesh_data->submesh_count &&
+        mesh_data->submesh_meshlets[i].count > 0) {
+      ecs_set_ptr(ecs, submesh, TbSubMeshMeshlets,
+                  &mesh_data->submesh_meshlets[i]);
+    }
+    if (mesh_data && i < mesh_data->submesh_count &&
+        mesh_data->submesh_lods[i].count > 0) {
+      ecs_set_ptr(ecs, submesh, TbSubMeshLods, &mesh_data->submesh_lods[i]);
+    }
     ecs_add(ecs, submesh, TbSubMeshParsed);
 
     tb_aabb_add_point(&mesh_aabb, submesh_aabb.min);
@@ -629,8 +978,12 @@ void tb_load_submeshes_task(const void *args) {
   ecs_set_ptr(ecs, mesh, TbAABB, &mesh_aabb);
   ecs_remove(ecs, mesh, TbSubMeshGLTFLoadRequest);
 
+  // Materials have taken their own references so the mesh is done with it
+  tb_release_glb(data);
+
   // Mesh submeshes are loaded
   SDL_AtomicDecRef(counter);
+  tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, -1);
 }
 
 void tb_queue_gltf_submesh_loads(ecs_iter_t *it) {
@@ -640,99 +993,47 @@ void tb_queue_gltf_submesh_loads(ecs_iter_t *it) {
   tb_auto counter = ecs_field(it, TbSubMeshQueueCounter, 2);
   tb_auto queue_counter = ecs_field(it, TbPerFrameSubmeshQueueCounter, 3);
 
-  bool saturated = false;
+  tb_auto ecs = it->world;
+  tb_auto rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem);
+  tb_auto tmp_alloc =
+      rnd_sys->render_thread->frame_states[rnd_sys->frame_idx].tmp_alloc.alloc;
 
-  tb_auto submesh_it = ecs_query_iter(it->world, ctx->submesh_load_query);
+  TbLoadQueue pending = {0};
+  TB_DYN_ARR_RESET(pending, tmp_alloc, 64);
+  tb_auto submesh_it = ecs_query_iter(ecs, ctx->submesh_load_query);
   while (ecs_query_next(&submesh_it)) {
-    if (saturated) {
-      break;
-    }
-    tb_auto reqs = ecs_field(&submesh_it, TbSubMeshGLTFLoadRequest, 0);
     for (int32_t i = 0; i < submesh_it.count; ++i) {
-      if (*queue_counter >= TB_MAX_SUBMESH_QUEUE_PER_FRAME) {
-        saturated = true;
-        break;
-      }
-      (*queue_counter)++;
-      if (SDL_GetAtomicInt(counter) > TbMaxParallelMeshLoads) {
-        saturated = true;
-        break;
-      }
-
-      // Enqueue task so that the submesh loads outside of a system where the
-      // ecs will be in a writable state
-      TbSubMeshLoadArgs args = {
-          .ecs = it->world,
-          .mesh = submesh_it.entities[i],
-          .req = reqs[i],
-          .counter = counter,
-      };
-      tb_auto task = tb_create_pinned_task(enki, tb_load_submeshes_task, &args,
-                                           sizeof(TbSubMeshLoadArgs));
-      tb_launch_pinned_task(enki, task);
-
-      SDL_AtomicIncRef(counter);
+      tb_auto ent = submesh_it.entities[i];
+      TbLoadQueueEntry entry = {ent, tb_get_load_priority(ecs, ent)};
+      TB_DYN_ARR_APPEND(pending, entry);
     }
   }
-}
-
-void tb_write_mesh_attr_desc(ecs_world_t *ecs, TbMeshCtx *ctx,
-                             uint32_t mesh_count, const ecs_entity_t *entities,
-                             const TbMeshData *data, TbAllocator tmp_alloc,
-                             TbAllocator rnd_tmp_alloc, uint32_t attr_idx) {
-  TB_DYN_ARR_OF(TbDynDescWrite) writes = {0};
-  TB_DYN_ARR_RESET(writes, rnd_tmp_alloc, mesh_count);
-
-  for (uint32_t i = 0; i < mesh_count; ++i) {
-    tb_auto mesh = &data[i];
-    VkBufferView attr_view = mesh->index_view;
-    if (attr_idx > 0) {
-      attr_view = mesh->attr_views[attr_idx - 1];
-    }
-    TbDynDescWrite write = {
-        .type = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
-        .desc.texel_buffer = attr_view,
+  const int32_t frame_slots =
+      TB_MAX_SUBMESH_QUEUE_PER_FRAME - (int32_t)*queue_counter;
+  const int32_t parallel_slots =
+      TbMaxParallelMeshLoads - SDL_GetAtomicInt(counter);
+  tb_auto dispatch = tb_plan_load_dispatch(
+      enki, tmp_alloc, &pending,
+      (uint32_t)SDL_max(SDL_min(frame_slots, parallel_slots), 0));
+
+  for (uint32_t i = 0; i < dispatch.count; ++i) {
+    (*queue_counter)++;
+
+    // Enqueue task so that the submesh loads outside of a system where the
+    // ecs will be in a writable state
+    TbMesh2 mesh = TB_DYN_ARR_AT(pending, dispatch.order[i]).ent;
+    TbSubMeshLoadArgs args = {
+        .ecs = ecs,
+        .mesh = mesh,
+        .req = *ecs_get(ecs, mesh, TbSubMeshGLTFLoadRequest),
+        .counter = counter,
     };
-    TB_DYN_ARR_APPEND(writes, write);
-  }
+    tb_auto task = tb_create_pinned_task(enki, tb_load_submeshes_task, &args,
+                                         sizeof(TbSubMeshLoadArgs));
+    tb_launch_pinned_task(enki, task);
 
-  const uint32_t write_count = TB_DYN_ARR_SIZE(writes);
-  if (write_count > 0) {
-    tb_auto indices = tb_alloc_nm_tp(tmp_alloc, write_count, uint32_t);
-    TbDynDescPool *pool = NULL;
-    switch (attr_idx) {
-    case 0:
-      pool = &ctx->idx_desc_pool;
-      break;
-    case 1:
-      pool = &ctx->pos_desc_pool;
-      break;
-    case 2:
-      pool = &ctx->norm_desc_pool;
-      break;
-    case 3:
-      pool = &ctx->tan_desc_pool;
-      break;
-    case 4:
-      pool = &ctx->uv0_desc_pool;
-      break;
-    default:
-      pool = NULL;
-    }
-    TB_CHECK(pool, "Failed to find pool for attribute");
-    tb_write_dyn_desc_pool(pool, write_count, writes.data, indices);
-
-    // A bit hack but we always expect attr idx 0 (indices)
-    // so this is when we can use the reported indices to mark
-    // mesh components
-    // Ideally we'd make sure the various attr pools are in sync but for now we
-    // just pray
-    if (attr_idx == 0) {
-      TB_DYN_ARR_FOREACH(writes, i) {
-        ecs_set(ecs, entities[i], TbMeshIndex, {indices[i]});
-        ecs_add(ecs, entities[i], TbDescriptorReady);
-      }
-    }
+    SDL_AtomicIncRef(counter);
+    tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, 1);
   }
 }
 
@@ -741,20 +1042,75 @@ void tb_finalize_meshes(ecs_iter_t *it) {
 
   tb_auto ctx = ecs_field(it, TbMeshCtx, 0);
   tb_auto rnd_sys = ecs_field(it, TbRenderSystem, 1);
-  tb_auto meshes = ecs_field(it, TbMeshData, 2);
+  tb_auto mesh_datas = ecs_field(it, TbMeshData, 2);
 
   if (ctx->owned_mesh_count == 0 || it->count == 0) {
     return;
   }
 
-  // Render Thread allocator to make sure writes live
-  tb_auto rnd_tmp_alloc =
-      rnd_sys->render_thread->frame_states[rnd_sys->frame_idx].tmp_alloc.alloc;
+  // Every mesh is read through the arena's descriptors which were written
+  // once up front. Meshes still uploading are checked again next frame
+  for (int32_t i = 0; i < it->count; ++i) {
+    if (!tb_rnd_is_upload_complete(rnd_sys, mesh_datas[i].upload_value)) {
+      continue;
+    }
+    ecs_set(it->world, it->entities[i], TbMeshIndex, {ctx->arena->desc_idx});
+    ecs_add(it->world, it->entities[i], TbDescriptorReady);
+  }
+}
+
+void tb_destroy_unreferenced_meshes(ecs_iter_t *it) {
+  TB_TRACY_SCOPE("Destroy Unreferenced Meshes");
+
+  tb_auto ctx = ecs_field(it, TbMeshCtx, 0);
+  tb_auto rnd_sys = ecs_field(it, TbRenderSystem, 1);
+  tb_auto mesh_datas = ecs_field(it, TbMeshData, 2);
+
+  for (int32_t i = 0; i < it->count; ++i) {
+    TbMesh2 mesh = it->entities[i];
+    tb_auto mesh_data = &mesh_datas[i];
+
+    // Submeshes hold the mesh's material references
+    tb_auto child_iter = ecs_children(it->world, mesh);
+    while (ecs_children_next(&child_iter)) {
+      for (int32_t child_i = 0; child_i < child_iter.count; ++child_i) {
+        tb_auto submesh =
+            ecs_get(it->world, child_iter.entities[child_i], TbSubMesh2Data);
+        if (submesh) {
+          tb_mat_sys_release_mat_ref(it->world, submesh->material);
+        }
+      }
+    }
+
+    // Frames in flight may still draw from the mesh's ranges of the arena
+    TbMeshArenaRange range = {
+        .index_alloc = mesh_data->index_alloc,
+        .vertex_alloc = mesh_data->vertex_alloc,
+    };
+    tb_release_mesh_range(&ctx->arena->ranges, range);
+    tb_rnd_free_host_buffer_deferred(rnd_sys, &mesh_data->host_buffer);
+
+    // Only the CPU reads meshlets and LODs
+    for (uint32_t sm_idx = 0; sm_idx < mesh_data->submesh_count; ++sm_idx) {
+      tb_free(tb_global_alloc,
+              (void *)mesh_data->submesh_meshlets[sm_idx].meshlets);
+    }
+    tb_free(tb_global_alloc, mesh_data->submesh_meshlets);
+    tb_free(tb_global_alloc, mesh_data->submesh_lods);
 
-  // HACK: known fixed number of mesh attributes
-  for (uint32_t i = 0; i < 5; ++i) {
-    tb_write_mesh_attr_desc(it->world, ctx, it->count, it->entities, meshes,
-                            rnd_sys->tmp_alloc, rnd_tmp_alloc, i);
+    ctx->owned_mesh_count--;
+    // Takes the submeshes with it
+    ecs_delete(it->world, mesh);
+  }
+}
+
+// Failed meshes own no arena ranges or submeshes so they can simply be dropped
+void tb_destroy_failed_meshes(ecs_iter_t *it) {
+  TB_TRACY_SCOPE("Destroy Failed Meshes");
+  tb_auto ctx = ecs_field(it, TbMeshCtx, 0);
+  for (int32_t i = 0; i < it->count; ++i) {
+    ctx->owned_mesh_count--;
+    ecs_delete(it->world, it->entities[i]);
   }
 }
 
@@ -769,6 +1125,15 @@ void tb_update_mesh_pool(ecs_iter_t *it) {
   tb_tick_dyn_desc_pool(rnd_sys, &ctx->norm_desc_pool);
   tb_tick_dyn_desc_pool(rnd_sys, &ctx->tan_desc_pool);
   tb_tick_dyn_desc_pool(rnd_sys, &ctx->uv0_desc_pool);
+
+  tb_auto arena = ctx->arena;
+  SDL_LockMutex(arena->lock);
+  tb_recycle_mesh_ranges(&arena->ranges, rnd_sys->frame_idx);
+  TracyCPlot("Mesh Arena Free Indices",
+             (double)tb_offset_alloc_free_space(&arena->ranges.indices));
+  TracyCPlot("Mesh Arena Free Vertices",
+             (double)tb_offset_alloc_free_space(&arena->ranges.vertices));
+  SDL_UnlockMutex(arena->lock);
 }
 
 void tb_check_submesh_readiness(ecs_iter_t *it) {
@@ -836,6 +1201,8 @@ void tb_register_mesh2_sys(TbWorld *world) {
   ECS_COMPONENT_DEFINE(ecs, TbMeshCtx);
   ECS_COMPONENT_DEFINE(ecs, TbMeshData);
   ECS_COMPONENT_DEFINE(ecs, TbSubMesh2Data);
+  ECS_COMPONENT_DEFINE(ecs, TbSubMeshMeshlets);
+  ECS_COMPONENT_DEFINE(ecs, TbSubMeshLods);
   ECS_COMPONENT_DEFINE(ecs, TbSubMeshQueueCounter);
   ECS_COMPONENT_DEFINE(ecs, TbMeshQueueCounter);
   ECS_COMPONENT_DEFINE(ecs, TbPerFrameMeshQueueCounter);
@@ -844,17 +1211,21 @@ void tb_register_mesh2_sys(TbWorld *world) {
   ECS_COMPONENT_DEFINE(ecs, TbAABB);
   ECS_COMPONENT_DEFINE(ecs, TbMeshGLTFLoadRequest);
   ECS_COMPONENT_DEFINE(ecs, TbSubMeshGLTFLoadRequest);
+  ECS_COMPONENT_DEFINE(ecs, TbMeshRefCount);
   ECS_TAG_DEFINE(ecs, TbMeshLoaded);
   ECS_TAG_DEFINE(ecs, TbMeshParsed);
   ECS_TAG_DEFINE(ecs, TbMeshReady);
   ECS_TAG_DEFINE(ecs, TbSubMeshParsed);
   ECS_TAG_DEFINE(ecs, TbSubMeshReady);
+  ECS_TAG_DEFINE(ecs, TbMeshUnreferenced);
+  ECS_TAG_DEFINE(ecs, TbMeshLoadFailed);
 
   ECS_SYSTEM(
       ecs, tb_reset_queue_counters,
       EcsOnLoad, [out] TbPerFrameMeshQueueCounter(TbPerFrameMeshQueueCounter),
       [out] TbPerFrameSubmeshQueueCounter(TbPerFrameSubmeshQueueCounter));
 
+  ECS_SYSTEM(ecs, tb_prioritize_mesh_loads, EcsPostLoad, [in] TbMeshCtx($));
   ECS_SYSTEM(
       ecs, tb_queue_gltf_mesh_loads,
       EcsPostLoad, [in] TbMeshCtx($), [inout] TbTaskScheduler(TbTaskScheduler),
@@ -870,6 +1241,12 @@ void tb_register_mesh2_sys(TbWorld *world) {
   ECS_SYSTEM(ecs, tb_finalize_meshes, EcsPostUpdate, [in] TbMeshCtx($),
              [in] TbRenderSystem($), [in] TbMeshData, [in] TbMeshLoaded,
              !TbDescriptorReady);
+  // Meshes that are still loading are destroyed once they're ready
+  ECS_SYSTEM(ecs, tb_destroy_unreferenced_meshes,
+             EcsPostUpdate, [in] TbMeshCtx($), [in] TbRenderSystem($),
+             [in] TbMeshData, [in] TbMeshReady, [in] TbMeshUnreferenced);
+  ECS_SYSTEM(ecs, tb_destroy_failed_meshes, EcsPostUpdate, [in] TbMeshCtx($),
+             [in] TbMeshLoadFailed, [in] TbMeshUnreferenced);
   // When all meshes are loaded we start making them available to shaders
   ECS_SYSTEM(ecs, tb_update_mesh_pool,
              EcsPreStore, [in] TbMeshCtx($), [in] TbRenderSystem($));
@@ -893,6 +1270,19 @@ void tb_register_mesh2_sys(TbWorld *world) {
                               {
                                   {.id = ecs_id(TbSubMeshGLTFLoadRequest)},
                               }}),
+      .camera_query =
+          ecs_query(ecs, {.terms =
+                              {
+                                  {.id = ecs_id(TbCameraComponent)},
+                              },
+                          .cache_kind = EcsQueryCacheAuto}),
+      .inst_query =
+          ecs_query(ecs, {.terms =
+                              {
+                                  {.id = ecs_id(TbMeshComponent)},
+                                  {.id = ecs_id(TbTransformComponent)},
+                              },
+                          .cache_kind = EcsQueryCacheAuto}),
   };
 
   // Create mesh descriptor set layout
@@ -957,6 +1347,27 @@ void tb_register_mesh2_sys(TbWorld *world) {
                           &ctx.uv0_desc_pool, 0);
 #endif
 
+  ctx.arena = tb_create_mesh_arena(rnd_sys);
+#if TB_USE_DESC_BUFFER == 0
+  // All meshes share the arena's views so each pool only needs one write
+  {
+    TbDynDescPool *pools[TB_MESH_STREAM_COUNT] = {
+        &ctx.idx_desc_pool, &ctx.pos_desc_pool, &ctx.norm_desc_pool,
+        &ctx.tan_desc_pool, &ctx.uv0_desc_pool,
+    };
+    for (uint32_t i = 0; i < TB_MESH_STREAM_COUNT; ++i) {
+      uint32_t desc_idx = 0;
+      tb_write_dyn_desc_pool(pools[i], 1, &ctx.arena->desc_writes[i],
+                             &desc_idx);
+      if (i == TB_MESH_STREAM_INDEX) {
+        ctx.arena->desc_idx = desc_idx;
+      }
+      TB_CHECK(desc_idx == ctx.arena->desc_idx,
+               "Mesh stream descriptors are out of sync");
+    }
+  }
+#endif
+
   ecs_singleton_set_ptr(ecs, TbMeshCtx, &ctx);
 
   {
@@ -981,6 +1392,8 @@ void tb_unregister_mesh2_sys(TbWorld *world) {
 
   ecs_query_fini(ctx->mesh_load_query);
   ecs_query_fini(ctx->submesh_load_query);
+  ecs_query_fini(ctx->camera_query);
+  ecs_query_fini(ctx->inst_query);
 
   tb_rnd_destroy_set_layout(rnd_sys, ctx->set_layout);
 
@@ -989,13 +1402,20 @@ void tb_unregister_mesh2_sys(TbWorld *world) {
   tb_destroy_descriptor_buffer(rnd_sys, &ctx->norm_desc_buf);
   tb_destroy_descriptor_buffer(rnd_sys, &ctx->tan_desc_buf);
   tb_destroy_descriptor_buffer(rnd_sys, &ctx->uv0_desc_buf);
+#if TB_USE_DESC_BUFFER == 0
+  tb_destroy_dyn_desc_pool(rnd_sys, &ctx->idx_desc_pool);
+  tb_destroy_dyn_desc_pool(rnd_sys, &ctx->pos_desc_pool);
+  tb_destroy_dyn_desc_pool(rnd_sys, &ctx->norm_desc_pool);
+  tb_destroy_dyn_desc_pool(rnd_sys, &ctx->tan_desc_pool);
+  tb_destroy_dyn_desc_pool(rnd_sys, &ctx->uv0_desc_pool);
+#endif
+
+  tb_destroy_mesh_arena(rnd_sys, ctx->arena);
 
   // TODO: Release all default references
 
   // TODO: Check for leaks
 
-  // TODO: Clean up descriptor pool
-
   ecs_singleton_remove(ecs, TbMeshCtx);
 }
 
@@ -1060,29 +1480,31 @@ VkDescriptorBufferBindingInfoEXT tb_mesh_sys_get_uv0_addr(ecs_world_t *ecs) {
 }
 
 TbMesh2 tb_mesh_sys_load_gltf_mesh(ecs_world_t *ecs, cgltf_data *data,
-                                   const char *path, const char *name,
                                    uint32_t index) {
   TB_TRACY_SCOPE("Load GLTF Mesh");
+  TB_CHECK_RETURN(data, "Expected data", 0);
   bool deferred = false;
   if (ecs_is_deferred(ecs)) {
     deferred = ecs_defer_end(ecs);
   }
 
-  const uint32_t max_name_len = 512;
-  char mesh_name[max_name_len] = {0};
-  SDL_snprintf(mesh_name, max_name_len, "%s_%s", path, name);
+  const TbAssetHash hash = tb_glb_mesh_hash(data, &data->meshes[index]);
+  char mesh_name[32] = {0};
+  SDL_snprintf(mesh_name, sizeof(mesh_name), "mesh_%016" SDL_PRIx64,
+               hash.hash);
 
-  // If an entity already exists with this name it is either loading or loaded
+  // If an entity already exists with this hash it is either loading or loaded
   TbMesh2 mesh_ent = ecs_lookup_child(ecs, ecs_id(TbMeshCtx), mesh_name);
   if (mesh_ent != 0) {
+    (*ecs_get_mut(ecs, mesh_ent, TbMeshRefCount))++;
+    ecs_remove(ecs, mesh_ent, TbMeshUnreferenced);
+    tb_gltf_count_reuse(hash.size);
     if (deferred) {
       ecs_defer_begin(ecs);
     }
     return mesh_ent;
   }
 
-  TB_CHECK_RETURN(data, "Expected data", 0);
-
   // Create a mesh entity
   mesh_ent = ecs_new(ecs);
   ecs_set_name(ecs, mesh_ent, mesh_name);
@@ -1090,8 +1512,12 @@ TbMesh2 tb_mesh_sys_load_gltf_mesh(ecs_world_t *ecs, cgltf_data *data,
   // It is a child of the mesh system context singleton
   ecs_add_pair(ecs, mesh_ent, EcsChildOf, ecs_id(TbMeshCtx));
 
-  // Append a mesh load request onto the entity to schedule loading
+  // Append a mesh load request onto the entity to schedule loading.
+  // The glb is released once the mesh's submeshes are set up
+  tb_acquire_glb(data);
   ecs_set(ecs, mesh_ent, TbMeshGLTFLoadRequest, {data, index});
+  ecs_set(ecs, mesh_ent, TbMeshRefCount, {1});
+  ecs_set(ecs, mesh_ent, TbLoadPriority, {0});
   ecs_remove(ecs, mesh_ent, TbDescriptorReady);
 
   if (deferred) {
@@ -1101,9 +1527,36 @@ TbMesh2 tb_mesh_sys_load_gltf_mesh(ecs_world_t *ecs, cgltf_data *data,
   return mesh_ent;
 }
 
-VkBuffer tb_mesh_sys_get_gpu_mesh(ecs_world_t *ecs, TbMesh2 mesh) {
+void tb_mesh_sys_release_mesh_ref(ecs_world_t *ecs, TbMesh2 mesh) {
+  tb_auto ref_count = ecs_get_mut(ecs, mesh, TbMeshRefCount);
+  if (ref_count == NULL) {
+    return; // Mesh system is being torn down
+  }
+  if (*ref_count == 0) {
+    TB_CHECK(false, "Trying to release reference to mesh that has no "
+                    "reference holders");
+    return;
+  }
+  (*ref_count)--;
+  if (*ref_count == 0) {
+    ecs_add(ecs, mesh, TbMeshUnreferenced);
+  }
+}
+
+TbMeshGeometry tb_mesh_sys_get_gpu_geometry(ecs_world_t *ecs, TbMesh2 mesh) {
   TB_CHECK(ecs_has(ecs, mesh, TbMeshData), "Entity must have mesh data");
-  return ecs_get(ecs, mesh, TbMeshData)->gpu_buffer.buffer;
+  tb_auto arena = ecs_singleton_get(ecs, TbMeshCtx)->arena;
+  tb_auto data = ecs_get(ecs, mesh, TbMeshData);
+  const uint64_t first_index = data->index_alloc.offset;
+  const uint64_t first_vertex = data->vertex_alloc.offset;
+  return (TbMeshGeometry){
+      .buffer = arena->buffer.buffer,
+      .index_offset = arena->stream_offsets[TB_MESH_STREAM_INDEX] +
+                      first_index * sizeof(uint32_t),
+      .position_offset =
+          arena->stream_offsets[TB_MESH_STREAM_POSITION] +
+          first_vertex * tb_mesh_stream_strides[TB_MESH_STREAM_POSITION],
+  };
 }
 
 bool tb_is_mesh_ready(ecs_world_t *ecs, TbMesh2 mesh_ent) {
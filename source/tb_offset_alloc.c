@@ -0,0 +1,303 @@
+#include "tb_offset_alloc.h"
+
+#include "tb_common.h"
+
+#define TB_OFFSET_ALLOC_MANTISSA_BITS 3
+#define TB_OFFSET_ALLOC_MANTISSA_VALUE (1 << TB_OFFSET_ALLOC_MANTISSA_BITS)
+#define TB_OFFSET_ALLOC_MANTISSA_MASK (TB_OFFSET_ALLOC_MANTISSA_VALUE - 1)
+#define TB_OFFSET_ALLOC_LEAF_MASK (TB_OFFSET_ALLOC_BINS_PER_LEAF - 1)
+#define TB_OFFSET_ALLOC_TOP_SHIFT 3
+#define TB_OFFSET_ALLOC_UNUSED 0xffffffff
+
+static uint32_t tb_lowest_set_bit(uint32_t mask) {
+  return (uint32_t)SDL_MostSignificantBitIndex32(mask & (~mask + 1));
+}
+
+static uint32_t tb_lowest_set_bit_after(uint32_t mask, uint32_t start) {
+  if (start >= 32) {
+    return TB_OFFSET_ALLOC_NO_SPACE;
+  }
+  const uint32_t bits_after = mask & ~((1u << start) - 1);
+  if (bits_after == 0) {
+    return TB_OFFSET_ALLOC_NO_SPACE;
+  }
+  return tb_lowest_set_bit(bits_after);
+}
+
+// Sizes map to bins on a float scale. Allocations round up so that any block
+// in the chosen bin is big enough and free blocks round down so that they
+// never land in a bin promising more than they have
+static uint32_t tb_size_to_bin_round_up(uint32_t size) {
+  uint32_t exp = 0;
+  uint32_t mantissa = 0;
+  if (size < TB_OFFSET_ALLOC_MANTISSA_VALUE) {
+    mantissa = size;
+  } else {
+    const uint32_t highest_bit = SDL_MostSignificantBitIndex32(size);
+    const uint32_t mantissa_start = highest_bit - TB_OFFSET_ALLOC_MANTISSA_BITS;
+    exp = mantissa_start + 1;
+    mantissa = (size >> mantissa_start) & TB_OFFSET_ALLOC_MANTISSA_MASK;
+    if ((size & ((1u << mantissa_start) - 1)) != 0) {
+      mantissa++;
+    }
+  }
+  // Add rather than or so that a mantissa overflow bumps the exponent
+  return (exp << TB_OFFSET_ALLOC_MANTISSA_BITS) + mantissa;
+}
+
+static uint32_t tb_size_to_bin_round_down(uint32_t size) {
+  uint32_t exp = 0;
+  uint32_t mantissa = 0;
+  if (size < TB_OFFSET_ALLOC_MANTISSA_VALUE) {
+    mantissa = size;
+  } else {
+    const uint32_t highest_bit = SDL_MostSignificantBitIndex32(size);
+    const uint32_t mantissa_start = highest_bit - TB_OFFSET_ALLOC_MANTISSA_BITS;
+    exp = mantissa_start + 1;
+    mantissa = (size >> mantissa_start) & TB_OFFSET_ALLOC_MANTISSA_MASK;
+  }
+  return (exp << TB_OFFSET_ALLOC_MANTISSA_BITS) | mantissa;
+}
+
+static uint32_t tb_bin_to_size(uint32_t bin) {
+  const uint32_t exp = bin >> TB_OFFSET_ALLOC_MANTISSA_BITS;
+  const uint32_t mantissa = bin & TB_OFFSET_ALLOC_MANTISSA_MASK;
+  if (exp == 0) {
+    return mantissa;
+  }
+  return (mantissa | TB_OFFSET_ALLOC_MANTISSA_VALUE) << (exp - 1);
+}
+
+static uint32_t tb_insert_node_into_bin(TbOffsetAllocator *self, uint32_t size,
+                                        uint32_t data_offset) {
+  const uint32_t bin = tb_size_to_bin_round_down(size);
+  const uint32_t top_bin = bin >> TB_OFFSET_ALLOC_TOP_SHIFT;
+  const uint32_t leaf_bin = bin & TB_OFFSET_ALLOC_LEAF_MASK;
+
+  // First node in the bin marks the bin as used
+  if (self->bin_indices[bin] == TB_OFFSET_ALLOC_UNUSED) {
+    self->used_bins[top_bin] |= 1 << leaf_bin;
+    self->used_bins_top |= 1u << top_bin;
+  }
+
+  const uint32_t head = self->bin_indices[bin];
+  const uint32_t node_idx = self->free_nodes[self->free_offset--];
+  self->nodes[node_idx] = (TbOffsetAllocNode){
+      .data_offset = data_offset,
+      .data_size = size,
+      .bin_list_prev = TB_OFFSET_ALLOC_UNUSED,
+      .bin_list_next = head,
+      .neighbor_prev = TB_OFFSET_ALLOC_UNUSED,
+      .neighbor_next = TB_OFFSET_ALLOC_UNUSED,
+  };
+  if (head != TB_OFFSET_ALLOC_UNUSED) {
+    self->nodes[head].bin_list_prev = node_idx;
+  }
+  self->bin_indices[bin] = node_idx;
+
+  self->free_storage += size;
+  return node_idx;
+}
+
+static void tb_remove_node_from_bin(TbOffsetAllocator *self,
+                                    uint32_t node_idx) {
+  tb_auto node = &self->nodes[node_idx];
+
+  if (node->bin_list_prev != TB_OFFSET_ALLOC_UNUSED) {
+    // Easy case: unlink from the middle of the bin's list
+    self->nodes[node->bin_list_prev].bin_list_next = node->bin_list_next;
+    if (node->bin_list_next != TB_OFFSET_ALLOC_UNUSED) {
+      self->nodes[node->bin_list_next].bin_list_prev = node->bin_list_prev;
+    }
+  } else {
+    // Head of the list so the bin itself needs updating
+    const uint32_t bin = tb_size_to_bin_round_down(node->data_size);
+    const uint32_t top_bin = bin >> TB_OFFSET_ALLOC_TOP_SHIFT;
+    const uint32_t leaf_bin = bin & TB_OFFSET_ALLOC_LEAF_MASK;
+
+    self->bin_indices[bin] = node->bin_list_next;
+    if (node->bin_list_next != TB_OFFSET_ALLOC_UNUSED) {
+      self->nodes[node->bin_list_next].bin_list_prev = TB_OFFSET_ALLOC_UNUSED;
+    }
+
+    if (self->bin_indices[bin] == TB_OFFSET_ALLOC_UNUSED) {
+      self->used_bins[top_bin] &= ~(1 << leaf_bin);
+      if (self->used_bins[top_bin] == 0) {
+        self->used_bins_top &= ~(1u << top_bin);
+      }
+    }
+  }
+
+  self->free_nodes[++self->free_offset] = node_idx;
+  self->free_storage -= node->data_size;
+}
+
+void tb_create_offset_allocator(TbAllocator alloc, uint32_t size,
+                                uint32_t max_allocs, TbOffsetAllocator *out) {
+  TB_CHECK(max_allocs > 1, "Offset allocator needs room for allocations");
+  *out = (TbOffsetAllocator){
+      .alloc = alloc,
+      .size = size,
+      .max_allocs = max_allocs,
+      .nodes = tb_alloc_nm_tp(alloc, max_allocs, TbOffsetAllocNode),
+      .free_nodes = tb_alloc_nm_tp(alloc, max_allocs, uint32_t),
+  };
+  tb_reset_offset_allocator(out);
+}
+
+void tb_destroy_offset_allocator(TbOffsetAllocator *self) {
+  tb_free(self->alloc, self->nodes);
+  tb_free(self->alloc, self->free_nodes);
+  *self = (TbOffsetAllocator){0};
+}
+
+void tb_reset_offset_allocator(TbOffsetAllocator *self) {
+  self->free_storage = 0;
+  self->used_bins_top = 0;
+  self->free_offset = self->max_allocs - 1;
+  SDL_memset(self->used_bins, 0, sizeof(self->used_bins));
+  SDL_memset(self->bin_indices, 0xff, sizeof(self->bin_indices));
+
+  // Reversed so that node 0 is the first to be handed out
+  for (uint32_t i = 0; i < self->max_allocs; ++i) {
+    self->free_nodes[i] = self->max_allocs - i - 1;
+  }
+
+  // Start out with one free block spanning the whole range
+  tb_insert_node_into_bin(self, self->size, 0);
+}
+
+TbOffsetAllocation tb_offset_alloc(TbOffsetAllocator *self, uint32_t size) {
+  const TbOffsetAllocation no_space = {
+      .offset = TB_OFFSET_ALLOC_NO_SPACE,
+      .node = TB_OFFSET_ALLOC_NO_SPACE,
+  };
+
+  // Keep a node spare for the remainder of a split block
+  if (size == 0 || self->free_offset == 0) {
+    return no_space;
+  }
+
+  // Look for a used bin at least as large as the request
+  const uint32_t min_bin = tb_size_to_bin_round_up(size);
+  const uint32_t min_top_bin = min_bin >> TB_OFFSET_ALLOC_TOP_SHIFT;
+  const uint32_t min_leaf_bin = min_bin & TB_OFFSET_ALLOC_LEAF_MASK;
+
+  uint32_t top_bin = min_top_bin;
+  uint32_t leaf_bin = TB_OFFSET_ALLOC_NO_SPACE;
+  if (top_bin < TB_OFFSET_ALLOC_TOP_BIN_COUNT &&
+      (self->used_bins_top & (1u << top_bin)) != 0) {
+    leaf_bin = tb_lowest_set_bit_after(self->used_bins[top_bin], min_leaf_bin);
+  }
+
+  // Any leaf of a larger top bin is guaranteed to fit
+  if (leaf_bin == TB_OFFSET_ALLOC_NO_SPACE) {
+    top_bin = tb_lowest_set_bit_after(self->used_bins_top, min_top_bin + 1);
+    if (top_bin == TB_OFFSET_ALLOC_NO_SPACE) {
+      return no_space;
+    }
+    leaf_bin = tb_lowest_set_bit(self->used_bins[top_bin]);
+  }
+
+  const uint32_t bin = (top_bin << TB_OFFSET_ALLOC_TOP_SHIFT) | leaf_bin;
+
+  // Pop the head of the bin's list
+  const uint32_t node_idx = self->bin_indices[bin];
+  tb_auto node = &self->nodes[node_idx];
+  const uint32_t node_total_size = node->data_size;
+  node->data_size = size;
+  node->used = true;
+  self->bin_indices[bin] = node->bin_list_next;
+  if (node->bin_list_next != TB_OFFSET_ALLOC_UNUSED) {
+    self->nodes[node->bin_list_next].bin_list_prev = TB_OFFSET_ALLOC_UNUSED;
+  }
+  self->free_storage -= node_total_size;
+
+  if (self->bin_indices[bin] == TB_OFFSET_ALLOC_UNUSED) {
+    self->used_bins[top_bin] &= ~(1 << leaf_bin);
+    if (self->used_bins[top_bin] == 0) {
+      self->used_bins_top &= ~(1u << top_bin);
+    }
+  }
+
+  // Give whatever is left of the block back as a new free neighbor
+  const uint32_t remainder = node_total_size - size;
+  if (remainder > 0) {
+    const uint32_t new_idx =
+        tb_insert_node_into_bin(self, remainder, node->data_offset + size);
+    // Inserting doesn't move nodes so the pointer is still valid
+    if (node->neighbor_next != TB_OFFSET_ALLOC_UNUSED) {
+      self->nodes[node->neighbor_next].neighbor_prev = new_idx;
+    }
+    self->nodes[new_idx].neighbor_prev = node_idx;
+    self->nodes[new_idx].neighbor_next = node->neighbor_next;
+    node->neighbor_next = new_idx;
+  }
+
+  return (TbOffsetAllocation){
+      .offset = node->data_offset,
+      .node = node_idx,
+  };
+}
+
+void tb_offset_free(TbOffsetAllocator *self, TbOffsetAllocation allocation) {
+  if (allocation.node == TB_OFFSET_ALLOC_NO_SPACE || self->nodes == NULL) {
+    return;
+  }
+  const uint32_t node_idx = allocation.node;
+  tb_auto node = &self->nodes[node_idx];
+  TB_CHECK(node->used, "Offset allocation was already freed");
+
+  uint32_t offset = node->data_offset;
+  uint32_t size = node->data_size;
+
+  // Merge with free neighbors on either side
+  if (node->neighbor_prev != TB_OFFSET_ALLOC_UNUSED &&
+      !self->nodes[node->neighbor_prev].used) {
+    const TbOffsetAllocNode prev = self->nodes[node->neighbor_prev];
+    offset = prev.data_offset;
+    size += prev.data_size;
+    tb_remove_node_from_bin(self, node->neighbor_prev);
+    node->neighbor_prev = prev.neighbor_prev;
+  }
+  if (node->neighbor_next != TB_OFFSET_ALLOC_UNUSED &&
+      !self->nodes[node->neighbor_next].used) {
+    const TbOffsetAllocNode next = self->nodes[node->neighbor_next];
+    size += next.data_size;
+    tb_remove_node_from_bin(self, node->neighbor_next);
+    node->neighbor_next = next.neighbor_next;
+  }
+
+  const uint32_t neighbor_prev = node->neighbor_prev;
+  const uint32_t neighbor_next = node->neighbor_next;
+  node->used = false;
+  self->free_nodes[++self->free_offset] = node_idx;
+
+  // Insert the combined block and stitch it back between its neighbors
+  const uint32_t combined_idx = tb_insert_node_into_bin(self, size, offset);
+  if (neighbor_next != TB_OFFSET_ALLOC_UNUSED) {
+    self->nodes[combined_idx].neighbor_next = neighbor_next;
+    self->nodes[neighbor_next].neighbor_prev = combined_idx;
+  }
+  if (neighbor_prev != TB_OFFSET_ALLOC_UNUSED) {
+    self->nodes[combined_idx].neighbor_prev = neighbor_prev;
+    self->nodes[neighbor_prev].neighbor_next = combined_idx;
+  }
+}
+
+uint32_t tb_offset_alloc_free_space(const TbOffsetAllocator *self) {
+  if (self->free_offset == 0) {
+    return 0;
+  }
+  return self->free_storage;
+}
+
+uint32_t tb_offset_alloc_largest_free(const TbOffsetAllocator *self) {
+  if (self->free_offset == 0 || self->used_bins_top == 0) {
+    return 0;
+  }
+  const uint32_t top_bin = SDL_MostSignificantBitIndex32(self->used_bins_top);
+  const uint32_t leaf_bin =
+      SDL_MostSignificantBitIndex32(self->used_bins[top_bin]);
+  return tb_bin_to_size((top_bin << TB_OFFSET_ALLOC_TOP_SHIFT) | leaf_bin);
+}
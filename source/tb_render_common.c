@@ -1,5 +1,7 @@
 #include "tb_render_common.h"
 
+#include "tb_frame_stats.h"
+
 void tb_record_fullscreen(VkCommandBuffer buffer, const TbDrawBatch *batch,
                           const TbFullscreenBatch *fs_batch) {
   // Just drawing a fullscreen triangle
@@ -9,4 +11,5 @@ void tb_record_fullscreen(VkCommandBuffer buffer, const TbDrawBatch *batch,
   vkCmdBindDescriptorSets(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                           batch->layout, 0, 1, &fs_batch->set, 0, NULL);
   vkCmdDraw(buffer, 3, 1, 0, 0);
+  tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, 1);
 }
@@ -108,6 +108,19 @@ void tb_render_object_mark_dirty(ecs_world_t *ecs, ecs_entity_t ent) {
   }
 }
 
+// Transform uploads are ordered on the GPU so an index can be reused as soon
+// as its render object is gone
+static void tb_on_render_object_remove(ecs_iter_t *it) {
+  tb_auto ctx = ecs_singleton_get_mut(it->world, TbRenderObjectSystem);
+  if (!ctx) {
+    return;
+  }
+  tb_auto render_objects = ecs_field(it, TbRenderObject, 0);
+  for (int32_t i = 0; i < it->count; ++i) {
+    tb_return_index(&ctx->free_list, (uint32_t)render_objects[i].index);
+  }
+}
+
 void tb_update_ro_pool(ecs_iter_t *it) {
   TB_TRACY_SCOPE("Update Render Object Pool");
   tb_auto ctx = ecs_field(it, TbRenderObjectSystem, 0);
@@ -158,6 +171,11 @@ void tb_register_render_object_sys(TbWorld *world) {
   ECS_COMPONENT_DEFINE(ecs, TbRenderObjectSystem);
   ECS_TAG_DEFINE(ecs, TbRenderObjectDirty);
 
+  ecs_set_hooks(ecs, TbRenderObject,
+                {
+                    .on_remove = tb_on_render_object_remove,
+                });
+
   // Metadata for TbRenderObject
   ecs_struct(ecs, {
                       .entity = ecs_id(TbRenderObject),
@@ -229,6 +247,7 @@ void tb_unregister_render_object_sys(TbWorld *world) {
 
   tb_rnd_destroy_set_layout(rnd_sys, ctx->set_layout);
   tb_destroy_free_list(&ctx->free_list);
+  tb_destroy_dyn_desc_pool(rnd_sys, &ctx->desc_pool);
 
   tb_rnd_free_gpu_buffer(rnd_sys, &ctx->trans_buffer.gpu);
   ctx->trans_buffer = (TbTransformsBuffer){0};
@@ -4,7 +4,9 @@
 #include "tb_profiling.h"
 #include "tb_render_system.h"
 #include "tb_render_target_system.h"
+#include "tb_settings.h"
 #include "tb_shader_system.h"
+#include "tb_task_scheduler.h"
 #include "tb_texture_system.h"
 #include "tb_view_system.h"
 #include "tb_world.h"
@@ -38,10 +40,43 @@ typedef struct PassTransition {
   TbImageTransition barrier;
 } PassTransition;
 
+// How a pass touches a render target. The render graph derives pass culling,
+// transient target lifetimes and barriers from these
+typedef enum TbPassAccessType {
+  TB_PASS_ACCESS_SAMPLED,      // Sampled as SHADER_READ_ONLY_OPTIMAL
+  TB_PASS_ACCESS_STORAGE_READ, // Read as GENERAL
+  TB_PASS_ACCESS_STORAGE,      // Read and written as GENERAL
+  TB_PASS_ACCESS_COLOR_ATTACHMENT,
+  TB_PASS_ACCESS_DEPTH_ATTACHMENT,
+} TbPassAccessType;
+
+typedef struct TbPassAccess {
+  TbRenderTargetId target;
+  TbPassAccessType type;
+  // Shader stages that do the access. Defaults to fragment for sampling and
+  // compute for storage access
+  VkPipelineStageFlags stages;
+  uint32_t base_mip;
+  uint32_t mip_count; // 0 means all remaining mips
+  uint32_t base_layer;
+  uint32_t layer_count; // 0 means all remaining layers
+  bool load;            // Attachment contents are loaded rather than replaced
+} TbPassAccess;
+
+#define TB_MAX_PASS_ACCESSES 8
+
 typedef struct TbRenderPass {
-  uint32_t dep_count;
-  TbRenderPassId deps[TB_MAX_RENDER_PASS_DEPS];
+  // Declared reads plus one write per attachment
+  uint32_t access_count;
+  TbPassAccess accesses[TB_MAX_PASS_ACCESSES];
+
+  // Rendered at the dynamic resolution scale into the top left corner of its
+  // attachments
+  bool dynamic_res;
 
+  // Derived by the render graph
+  bool culled;
+  uint32_t context_idx; // Index of the pass context on the render thread
   uint32_t transition_count;
   PassTransition transitions[TB_MAX_RENDER_PASS_TRANS];
 
@@ -50,75 +85,426 @@ typedef struct TbRenderPass {
 
   VkRenderingInfo info[TB_MAX_FRAME_STATES];
 
-#ifdef TRACY_ENABLE
+  // Rolling window of the pass's GPU times and the CPU time spent recording
+  // it last frame
+  float gpu_ms_samples[TB_PASS_TIMING_WINDOW];
+  float gpu_ms_sum;
+  uint32_t gpu_ms_count;
+  uint32_t gpu_ms_head;
+  float record_ms;
+
+  // Kept outside of Tracy builds too so timings can be reported by name
   char label[TB_RP_LABEL_LEN];
-#endif
 } TbRenderPass;
 
-// For dependency graph construction
-typedef struct PassNode PassNode;
-typedef struct PassNode {
-  TbRenderPassId id;
-  uint32_t child_count;
-  PassNode **children;
-} PassNode;
-
-void sort_passes_recursive(PassNode *node, uint32_t *pass_order,
-                           uint32_t *pass_idx) {
-  if (node) {
-    // Make sure id isn't already in the order
-    bool exists = false;
-    for (uint32_t i = 0; i < *pass_idx; ++i) {
-      if (pass_order[i] == node->id) {
-        exists = true;
-        break;
+bool access_reads(const TbPassAccess *access) {
+  switch (access->type) {
+  case TB_PASS_ACCESS_COLOR_ATTACHMENT:
+  case TB_PASS_ACCESS_DEPTH_ATTACHMENT:
+    return access->load;
+  default:
+    return true;
+  }
+}
+
+bool access_writes(const TbPassAccess *access) {
+  return access->type == TB_PASS_ACCESS_STORAGE ||
+         access->type == TB_PASS_ACCESS_COLOR_ATTACHMENT ||
+         access->type == TB_PASS_ACCESS_DEPTH_ATTACHMENT;
+}
+
+void compile_pass_graph(TbRenderPipelineSystem *self) {
+  TB_TRACY_SCOPE("Compile Pass Graph");
+  tb_auto rt_sys = self->rt_sys;
+  const uint32_t pass_count = TB_DYN_ARR_SIZE(self->render_passes);
+  const uint32_t rt_count = TB_DYN_ARR_SIZE(rt_sys->render_targets);
+
+  // Passes are declared in execution order. Walk them backwards and cull any
+  // pass that only writes transient targets nothing later reads. Persistent
+  // and imported targets may be observed outside of the graph and a pass that
+  // writes no targets at all must be writing something the graph can't see
+  bool *read_later = tb_alloc_nm_tp(self->tmp_alloc, rt_count, bool);
+  SDL_memset(read_later, 0, sizeof(bool) * rt_count);
+  for (uint32_t pass_idx = pass_count; pass_idx-- > 0;) {
+    tb_auto pass = &TB_DYN_ARR_AT(self->render_passes, pass_idx);
+    bool writes = false;
+    bool needed = false;
+    for (uint32_t i = 0; i < pass->access_count; ++i) {
+      tb_auto access = &pass->accesses[i];
+      if (access_writes(access)) {
+        writes = true;
+        needed |= !tb_render_target_is_transient(rt_sys, access->target) ||
+                  read_later[access->target];
       }
     }
+    pass->culled = writes && !needed;
+    if (pass->culled) {
+      continue;
+    }
+    for (uint32_t i = 0; i < pass->access_count; ++i) {
+      if (access_reads(&pass->accesses[i])) {
+        read_later[pass->accesses[i].target] = true;
+      }
+    }
+  }
 
-    if (!exists) {
-      pass_order[(*pass_idx)++] = (uint32_t)node->id;
+  // Execution order is just declaration order minus culled passes
+  uint32_t *first_use = tb_alloc_nm_tp(self->tmp_alloc, rt_count, uint32_t);
+  uint32_t *last_use = tb_alloc_nm_tp(self->tmp_alloc, rt_count, uint32_t);
+  for (uint32_t rt_idx = 0; rt_idx < rt_count; ++rt_idx) {
+    first_use[rt_idx] = SDL_MAX_UINT32;
+    last_use[rt_idx] = 0;
+  }
+  self->live_pass_count = 0;
+  for (uint32_t pass_idx = 0; pass_idx < pass_count; ++pass_idx) {
+    tb_auto pass = &TB_DYN_ARR_AT(self->render_passes, pass_idx);
+    if (pass->culled) {
+      continue;
+    }
+    const uint32_t order_idx = self->live_pass_count++;
+    self->pass_order[order_idx] = pass_idx;
+    pass->context_idx = order_idx;
+    for (uint32_t i = 0; i < pass->access_count; ++i) {
+      const TbRenderTargetId rt = pass->accesses[i].target;
+      first_use[rt] = SDL_min(first_use[rt], order_idx);
+      last_use[rt] = SDL_max(last_use[rt], order_idx);
     }
+  }
 
-    for (uint32_t child_idx = 0; child_idx < node->child_count; ++child_idx) {
-      sort_passes_recursive(node->children[child_idx], pass_order, pass_idx);
+  for (uint32_t rt_idx = 0; rt_idx < rt_count; ++rt_idx) {
+    if (tb_render_target_is_transient(rt_sys, rt_idx)) {
+      tb_render_target_set_lifetime(rt_sys, rt_idx, first_use[rt_idx],
+                                    last_use[rt_idx]);
     }
   }
 }
 
-void sort_pass_graph(TbRenderPipelineSystem *self) {
-  TB_TRACY_SCOPE("Sort Pass Graph");
-  // Build a graph of pass nodes to determine ordering
-  const uint32_t pass_count = TB_DYN_ARR_SIZE(self->render_passes);
-  PassNode *nodes = tb_alloc_nm_tp(self->tmp_alloc, pass_count, PassNode);
-  // All nodes have worst case pass_count children
-  for (uint32_t pass_idx = 0; pass_idx < pass_count; ++pass_idx) {
-    nodes[pass_idx].id = (TbRenderPassId)pass_idx;
-    nodes[pass_idx].children =
-        tb_alloc_nm_tp(self->tmp_alloc, pass_count, PassNode *);
+// Where a pass needs a subresource to be
+typedef struct TbAccessState {
+  VkImageLayout layout;
+  VkPipelineStageFlags stages;
+  VkAccessFlags access;
+  VkAccessFlags write_access;
+} TbAccessState;
+
+TbAccessState get_access_state(const TbPassAccess *access) {
+  switch (access->type) {
+  case TB_PASS_ACCESS_SAMPLED:
+    return (TbAccessState){
+        .layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .stages = access->stages ? access->stages
+                                 : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        .access = VK_ACCESS_SHADER_READ_BIT,
+    };
+  case TB_PASS_ACCESS_STORAGE_READ:
+    return (TbAccessState){
+        .layout = VK_IMAGE_LAYOUT_GENERAL,
+        .stages = access->stages ? access->stages
+                                 : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        .access = VK_ACCESS_SHADER_READ_BIT,
+    };
+  case TB_PASS_ACCESS_STORAGE:
+    return (TbAccessState){
+        .layout = VK_IMAGE_LAYOUT_GENERAL,
+        .stages = access->stages ? access->stages
+                                 : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        .access = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        .write_access = VK_ACCESS_SHADER_WRITE_BIT,
+    };
+  case TB_PASS_ACCESS_COLOR_ATTACHMENT:
+    return (TbAccessState){
+        .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .write_access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+    };
+  case TB_PASS_ACCESS_DEPTH_ATTACHMENT:
+    return (TbAccessState){
+        .layout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+        .stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                  VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        .access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                  VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .write_access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+    };
   }
+  return (TbAccessState){0};
+}
 
-  // Build graph
-  for (uint32_t pass_idx = 0; pass_idx < pass_count; ++pass_idx) {
-    TbRenderPassId pass_id = (TbRenderPassId)pass_idx;
-    PassNode *node = &nodes[pass_idx];
-
-    // Search all other passes for children
-    for (uint32_t i = 0; i < pass_count; ++i) {
-      const TbRenderPass *pass = &TB_DYN_ARR_AT(self->render_passes, i);
-      if (i != pass_idx) {
-        for (uint32_t dep_idx = 0; dep_idx < pass->dep_count; ++dep_idx) {
-          if (pass->deps[dep_idx] == pass_id) {
-            node->children[node->child_count++] = &nodes[i];
-            break;
+// What the graph knows about one mip of one layer while walking the frame
+typedef struct TbSubresourceState {
+  VkImageLayout layout;
+  bool pending; // Last write hasn't been made visible by a barrier
+  VkPipelineStageFlags write_stages;
+  VkAccessFlags write_access;
+  VkPipelineStageFlags read_stages;    // Readers since the last write
+  VkPipelineStageFlags visible_stages; // Stages the last barrier covered
+  // That barrier, so that later readers can widen it instead of adding one
+  uint32_t barrier_pass;
+  uint32_t barrier_idx;
+} TbSubresourceState;
+
+typedef enum TbSyncOp {
+  TB_SYNC_NONE,
+  TB_SYNC_WIDEN,
+  TB_SYNC_BARRIER,
+} TbSyncOp;
+
+TbSyncOp get_sync_op(const TbSubresourceState *state, const TbAccessState *req,
+                     TbImageTransition *barrier) {
+  const bool new_stages = (req->stages & ~state->visible_stages) != 0;
+  VkPipelineStageFlags src_stages = state->read_stages;
+  VkAccessFlags src_access = VK_ACCESS_NONE;
+  if (state->layout == req->layout && !state->pending) {
+    // Read after read or write into memory nothing has touched since the
+    // last barrier. Writes still have to wait on readers
+    if (req->write_access == 0 || state->read_stages == 0) {
+      if (!new_stages) {
+        return TB_SYNC_NONE;
+      }
+      if (state->barrier_pass != InvalidRenderPassId) {
+        return TB_SYNC_WIDEN;
+      }
+      src_stages |= state->write_stages;
+    }
+  } else if (state->pending) {
+    src_stages |= state->write_stages;
+    src_access = state->write_access;
+  }
+
+  *barrier = (TbImageTransition){
+      .src_flags = src_stages ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      .dst_flags = req->stages,
+      .barrier =
+          {
+              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+              .srcAccessMask = src_access,
+              .dstAccessMask = req->access,
+              .oldLayout = state->layout,
+              .newLayout = req->layout,
+          },
+  };
+  return TB_SYNC_BARRIER;
+}
+
+void apply_access(TbSubresourceState *state, const TbAccessState *req,
+                  TbSyncOp op, uint32_t pass_idx, uint32_t barrier_idx) {
+  if (req->write_access != 0) {
+    *state = (TbSubresourceState){
+        .layout = req->layout,
+        .pending = true,
+        .write_stages = req->stages,
+        .write_access = req->write_access,
+        .barrier_pass = InvalidRenderPassId,
+    };
+    return;
+  }
+  if (op == TB_SYNC_BARRIER) {
+    state->layout = req->layout;
+    state->pending = false;
+    state->read_stages = 0;
+    state->visible_stages = 0;
+    state->barrier_pass = pass_idx;
+    state->barrier_idx = barrier_idx;
+  }
+  state->read_stages |= req->stages;
+  state->visible_stages |= req->stages;
+}
+
+bool same_sync(const TbImageTransition *a, const TbImageTransition *b) {
+  return a->src_flags == b->src_flags && a->dst_flags == b->dst_flags &&
+         a->barrier.srcAccessMask == b->barrier.srcAccessMask &&
+         a->barrier.dstAccessMask == b->barrier.dstAccessMask &&
+         a->barrier.oldLayout == b->barrier.oldLayout &&
+         a->barrier.newLayout == b->barrier.newLayout;
+}
+
+// Adds a barrier to the pass, folding it into the previous one when it just
+// continues that barrier's mip or layer range
+uint32_t push_pass_barrier(TbRenderPass *pass, TbRenderTargetId target,
+                           const TbImageTransition *barrier) {
+  if (pass->transition_count > 0) {
+    const uint32_t last_idx = pass->transition_count - 1;
+    tb_auto last = &pass->transitions[last_idx];
+    tb_auto last_range = &last->barrier.barrier.subresourceRange;
+    tb_auto range = &barrier->barrier.subresourceRange;
+    if (last->render_target == target && same_sync(&last->barrier, barrier)) {
+      if (last_range->baseArrayLayer == range->baseArrayLayer &&
+          last_range->layerCount == range->layerCount &&
+          last_range->baseMipLevel + last_range->levelCount ==
+              range->baseMipLevel) {
+        last_range->levelCount += range->levelCount;
+        return last_idx;
+      }
+      if (last_range->baseMipLevel == range->baseMipLevel &&
+          last_range->levelCount == range->levelCount &&
+          last_range->layerCount != VK_REMAINING_ARRAY_LAYERS &&
+          last_range->baseArrayLayer + last_range->layerCount ==
+              range->baseArrayLayer) {
+        last_range->layerCount += range->layerCount;
+        return last_idx;
+      }
+    }
+  }
+  TB_CHECK_RETURN(pass->transition_count < TB_MAX_RENDER_PASS_TRANS,
+                  "Too many barriers for one pass", 0);
+  pass->transitions[pass->transition_count] = (PassTransition){
+      .render_target = target,
+      .barrier = *barrier,
+  };
+  return pass->transition_count++;
+}
+
+// Walks live passes in order, tracking every subresource of every target, and
+// emits only the barriers needed for layout changes and hazards. Readers in
+// new stages widen the barrier that made the data readable rather than
+// adding their own
+void build_pass_barriers(TbRenderPipelineSystem *self) {
+  TB_TRACY_SCOPE("Build Pass Barriers");
+  tb_auto rt_sys = self->rt_sys;
+  const uint32_t rt_count = TB_DYN_ARR_SIZE(rt_sys->render_targets);
+  const uint32_t sub_count = TB_MAX_LAYERS * TB_MAX_MIPS;
+
+  tb_auto states =
+      tb_alloc_nm_tp(self->tmp_alloc, rt_count * sub_count, TbSubresourceState);
+  bool *touched = tb_alloc_nm_tp(self->tmp_alloc, rt_count, bool);
+  // Everything each target was used for, to order aliased targets
+  tb_auto used_stages =
+      tb_alloc_nm_tp(self->tmp_alloc, rt_count, VkPipelineStageFlags);
+  tb_auto written = tb_alloc_nm_tp(self->tmp_alloc, rt_count, VkAccessFlags);
+  for (uint32_t rt_idx = 0; rt_idx < rt_count; ++rt_idx) {
+    touched[rt_idx] = false;
+    used_stages[rt_idx] = 0;
+    written[rt_idx] = 0;
+    // Imported targets are handed over by the render thread already
+    // transitioned for color output
+    const bool imported = tb_render_target_is_imported(rt_sys, rt_idx);
+    for (uint32_t i = 0; i < sub_count; ++i) {
+      states[rt_idx * sub_count + i] = (TbSubresourceState){
+          .layout = imported ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+                             : VK_IMAGE_LAYOUT_UNDEFINED,
+          .visible_stages =
+              imported ? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT : 0,
+          .barrier_pass = InvalidRenderPassId,
+      };
+    }
+    touched[rt_idx] = imported;
+  }
+
+  self->barrier_count = 0;
+  self->barrier_batch_count = 0;
+  TB_DYN_ARR_FOREACH(self->render_passes, pass_idx) {
+    TB_DYN_ARR_AT(self->render_passes, pass_idx).transition_count = 0;
+  }
+
+  for (uint32_t order_idx = 0; order_idx < self->live_pass_count;
+       ++order_idx) {
+    const uint32_t pass_idx = self->pass_order[order_idx];
+    tb_auto pass = &TB_DYN_ARR_AT(self->render_passes, pass_idx);
+
+    for (uint32_t access_idx = 0; access_idx < pass->access_count;
+         ++access_idx) {
+      tb_auto access = &pass->accesses[access_idx];
+      const TbRenderTargetId rt = access->target;
+      const TbAccessState req = get_access_state(access);
+      const uint32_t mip_count = tb_render_target_get_mip_count(rt_sys, rt);
+      const uint32_t layer_count = tb_render_target_get_layer_count(rt_sys, rt);
+      TbSubresourceState *rt_states = &states[rt * sub_count];
+
+      VkImageSubresourceRange full_range = {
+          .aspectMask =
+              tb_render_target_get_format(rt_sys, rt) == VK_FORMAT_D32_SFLOAT
+                  ? VK_IMAGE_ASPECT_DEPTH_BIT
+                  : VK_IMAGE_ASPECT_COLOR_BIT,
+          .levelCount = mip_count,
+          // Cubes only have one layer of views but all six faces move
+          .layerCount = layer_count == 1 ? VK_REMAINING_ARRAY_LAYERS
+                                         : layer_count,
+      };
+
+      // The first use in a frame transitions the whole target out of
+      // undefined so later passes touching other mips or layers don't each
+      // need their own barrier
+      if (!touched[rt]) {
+        touched[rt] = true;
+        VkPipelineStageFlags src_stages = 0;
+        VkAccessFlags src_access = VK_ACCESS_NONE;
+        TbRenderTargetId prev = tb_render_target_get_alias_prev(rt_sys, rt);
+        if (prev != TbInvalidRenderTargetId) {
+          // Memory is shared so wait until the previous owner is done
+          src_stages = used_stages[prev];
+          src_access = written[prev];
+        }
+        TbImageTransition barrier = {
+            .src_flags =
+                src_stages ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            .dst_flags = req.stages,
+            .barrier =
+                {
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .srcAccessMask = src_access,
+                    .dstAccessMask = req.access,
+                    .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .newLayout = req.layout,
+                    .subresourceRange = full_range,
+                },
+        };
+        uint32_t barrier_idx = push_pass_barrier(pass, rt, &barrier);
+        for (uint32_t i = 0; i < sub_count; ++i) {
+          rt_states[i] = (TbSubresourceState){
+              .layout = req.layout,
+              .visible_stages = req.stages,
+              .barrier_pass = pass_idx,
+              .barrier_idx = barrier_idx,
+          };
+        }
+      }
+
+      const uint32_t base_mip = access->base_mip;
+      const uint32_t mips = access->mip_count ? access->mip_count
+                                              : mip_count - base_mip;
+      const uint32_t base_layer = access->base_layer;
+      const uint32_t layers = access->layer_count
+                                  ? access->layer_count
+                                  : layer_count - base_layer;
+      for (uint32_t layer = base_layer; layer < base_layer + layers; ++layer) {
+        for (uint32_t mip = base_mip; mip < base_mip + mips; ++mip) {
+          tb_auto state = &rt_states[layer * TB_MAX_MIPS + mip];
+          TbImageTransition barrier = {0};
+          TbSyncOp op = get_sync_op(state, &req, &barrier);
+          uint32_t barrier_idx = 0;
+          if (op == TB_SYNC_BARRIER) {
+            barrier.barrier.subresourceRange = (VkImageSubresourceRange){
+                .aspectMask = full_range.aspectMask,
+                .baseMipLevel = mip,
+                .levelCount = 1,
+                .baseArrayLayer = layer,
+                .layerCount = layer_count == 1 ? VK_REMAINING_ARRAY_LAYERS : 1,
+            };
+            barrier_idx = push_pass_barrier(pass, rt, &barrier);
+          } else if (op == TB_SYNC_WIDEN) {
+            tb_auto owner =
+                &TB_DYN_ARR_AT(self->render_passes, state->barrier_pass);
+            tb_auto widen = &owner->transitions[state->barrier_idx].barrier;
+            widen->dst_flags |= req.stages;
+            widen->barrier.dstAccessMask |= req.access;
           }
+          apply_access(state, &req, op, pass_idx, barrier_idx);
         }
       }
+      used_stages[rt] |= req.stages;
+      written[rt] |= req.write_access;
     }
   }
 
-  // A pre-order traversal of the graph should get us a reasonable pass order
-  uint32_t pass_idx = 0;
-  sort_passes_recursive(&nodes[0], self->pass_order, &pass_idx);
+  for (uint32_t order_idx = 0; order_idx < self->live_pass_count;
+       ++order_idx) {
+    tb_auto pass =
+        &TB_DYN_ARR_AT(self->render_passes, self->pass_order[order_idx]);
+    self->barrier_count += pass->transition_count;
+    self->barrier_batch_count += pass->transition_count > 0 ? 1 : 0;
+  }
 }
 
 typedef struct TbPipeShaderArgs {
@@ -665,6 +1051,24 @@ void record_color_copy(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
   TracyCVkZoneEnd(frame_scope);
 }
 
+void record_upscale(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
+                    uint32_t batch_count, const TbDrawBatch *batches) {
+  // Only expecting one draw per pass
+  if (batch_count != 1) {
+    return;
+  }
+
+  TB_TRACY_SCOPEC("Upscale Record", TracyCategoryColorRendering);
+  TracyCVkNamedZone(gpu_ctx, frame_scope, buffer, "Upscale", 3, true);
+  cmd_begin_label(buffer, "Upscale", (float4){0.2f, 0.4f, 0.8f, 1.0f});
+
+  tb_record_fullscreen(buffer, batches,
+                       (const TbFullscreenBatch *)batches->user_batch);
+
+  cmd_end_label(buffer);
+  TracyCVkZoneEnd(frame_scope);
+}
+
 void record_comp_copy(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
                       uint32_t batch_count, const TbDispatchBatch *batches) {
   TB_TRACY_SCOPEC("Compute Copy Record", TracyCategoryColorRendering);
@@ -765,19 +1169,23 @@ void register_pass(TbRenderPipelineSystem *self, TbRenderThread *thread,
 
     state->pass_command_buffer_count = command_buffer_count;
     {
-      TB_CHECK(state->pass_command_buffer_count < TB_MAX_COMMAND_BUFFERS,
+      TB_CHECK(state->pass_command_buffer_count <= TB_MAX_COMMAND_BUFFERS,
                "Too many command buffers");
-      VkCommandBufferAllocateInfo alloc_info = {
-          .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-          .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-          .commandBufferCount =
-              state->pass_command_buffer_count + 1, // HACK: +1 for the base
-          .commandPool = state->command_pool,
-      };
-      VkResult err = vkAllocateCommandBuffers(thread->device, &alloc_info,
-                                              state->pass_command_buffers);
-      TB_VK_CHECK(err, "Failed to allocate pass command buffer");
+      // Each buffer comes from its own pool so passes can be recorded in
+      // parallel. Buffers from earlier registrations are kept
       for (uint32_t i = 0; i < state->pass_command_buffer_count; ++i) {
+        if (state->pass_command_buffers[i] != VK_NULL_HANDLE) {
+          continue;
+        }
+        VkCommandBufferAllocateInfo alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+            .commandPool = state->pass_command_pools[i],
+        };
+        VkResult err = vkAllocateCommandBuffers(
+            thread->device, &alloc_info, &state->pass_command_buffers[i]);
+        TB_VK_CHECK(err, "Failed to allocate pass command buffer");
         SET_VK_NAME(thread->device, state->pass_command_buffers[i],
                     VK_OBJECT_TYPE_COMMAND_BUFFER, "Pass Command Buffer");
       }
@@ -831,12 +1239,11 @@ typedef struct TbAttachmentInfo {
 
 typedef struct TbRenderPassCreateInfo {
   uint32_t view_mask;
+  bool dynamic_res;
 
-  uint32_t dependency_count;
-  const TbRenderPassId *dependencies;
-
-  uint32_t transition_count;
-  const PassTransition *transitions;
+  // Targets read by the pass or written outside of its attachments
+  uint32_t access_count;
+  const TbPassAccess *accesses;
 
   uint32_t attachment_count;
   const TbAttachmentInfo *attachments;
@@ -852,20 +1259,10 @@ TbRenderPassId create_render_pass(TbRenderPipelineSystem *self,
   TB_DYN_ARR_APPEND(self->render_passes, (TbRenderPass){0});
   TbRenderPass *pass = &TB_DYN_ARR_AT(self->render_passes, id);
 
-#ifdef TRACY_ENABLE
   if (create_info->name != NULL) {
     SDL_strlcpy(pass->label, create_info->name, TB_RP_LABEL_LEN);
   }
-#endif
-
-  // Copy dependencies
-  pass->dep_count = create_info->dependency_count;
-  SDL_memset(pass->deps, InvalidRenderPassId,
-             sizeof(TbRenderPassId) * TB_MAX_RENDER_PASS_DEPS);
-  if (pass->dep_count > 0) {
-    SDL_memcpy(pass->deps, create_info->dependencies,
-               sizeof(TbRenderPassId) * pass->dep_count);
-  }
+  pass->dynamic_res = create_info->dynamic_res;
 
   // Copy attachments
   pass->attach_count = create_info->attachment_count;
@@ -885,20 +1282,47 @@ TbRenderPassId create_render_pass(TbRenderPipelineSystem *self,
     }
   }
 
-  // Copy pass transitions
-  pass->transition_count = create_info->transition_count;
-  TB_CHECK_RETURN(pass->transition_count <= TB_MAX_RENDER_PASS_TRANS,
+  // Copy accesses and resolve their ranges
+  TbRenderTargetSystem *rt_sys = self->rt_sys;
+  pass->access_count = create_info->access_count;
+  TB_CHECK_RETURN(pass->access_count + pass->attach_count <=
+                      TB_MAX_PASS_ACCESSES,
                   "Out of range", InvalidRenderPassId);
-  SDL_memset(pass->transitions, 0,
-             sizeof(PassTransition) * TB_MAX_RENDER_PASS_TRANS);
-  if (pass->transition_count > 0) {
-    SDL_memcpy(pass->transitions, create_info->transitions,
-               sizeof(PassTransition) * pass->transition_count);
+  for (uint32_t i = 0; i < pass->access_count; ++i) {
+    tb_auto access = &pass->accesses[i];
+    *access = create_info->accesses[i];
+    if (access->mip_count == 0) {
+      access->mip_count =
+          tb_render_target_get_mip_count(rt_sys, access->target) -
+          access->base_mip;
+    }
+    if (access->layer_count == 0) {
+      access->layer_count =
+          tb_render_target_get_layer_count(rt_sys, access->target) -
+          access->base_layer;
+    }
+  }
+
+  // Every attachment is written by the pass
+  for (uint32_t i = 0; i < pass->attach_count; ++i) {
+    const TbAttachmentInfo *attach_info = &create_info->attachments[i];
+    VkFormat format =
+        tb_render_target_get_format(rt_sys, attach_info->attachment);
+    pass->accesses[pass->access_count++] = (TbPassAccess){
+        .target = attach_info->attachment,
+        .type = format == VK_FORMAT_D32_SFLOAT
+                    ? TB_PASS_ACCESS_DEPTH_ATTACHMENT
+                    : TB_PASS_ACCESS_COLOR_ATTACHMENT,
+        .base_mip = attach_info->mip,
+        .mip_count = 1,
+        .base_layer = attach_info->layer,
+        .layer_count = 1,
+        .load = attach_info->load_op == VK_ATTACHMENT_LOAD_OP_LOAD,
+    };
   }
 
   // Populate rendering info if we target any attachments
   if (pass->attach_count > 0) {
-    TbRenderTargetSystem *rt_sys = self->rt_sys;
     // HACK: Assume all attachments have the same extents
     const VkExtent3D extent = tb_render_target_get_mip_extent(
         rt_sys, pass->attachments[0].layer, pass->attachments[0].mip,
@@ -957,6 +1381,8 @@ TbRenderPassId create_render_pass(TbRenderPipelineSystem *self,
   return id;
 }
 
+void reimport_render_pass(TbRenderPipelineSystem *self, TbRenderPassId id);
+
 TbRenderPipelineSystem
 create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
                               TbAllocator tmp_alloc, TbRenderSystem *rnd_sys,
@@ -968,7 +1394,10 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
       .view_sys = view_sys,
       .tmp_alloc = tmp_alloc,
       .gp_alloc = gp_alloc,
+      .render_scale = 1.0f,
   };
+  tb_dyn_res_init(&sys.dyn_res, TB_DYN_RES_DEFAULT_TARGET_MS,
+                  TB_DYN_RES_DEFAULT_MIN_SCALE, 1.0f);
 
   // Initialize the render pass array
   TB_DYN_ARR_RESET(sys.render_passes, sys.gp_alloc, 8);
@@ -983,132 +1412,19 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     const TbRenderTargetId opaque_depth = rt_sys->depth_buffer;
     const TbRenderTargetId opaque_normal = rt_sys->normal_buffer;
     const TbRenderTargetId hdr_color = rt_sys->hdr_color;
+    const TbRenderTargetId upscaled_color = rt_sys->upscaled_color;
     const TbRenderTargetId depth_copy = rt_sys->depth_buffer_copy;
     const TbRenderTargetId color_copy = rt_sys->color_copy;
     const TbRenderTargetId swapchain_target = rt_sys->swapchain;
     const TbRenderTargetId transparent_depth = rt_sys->depth_buffer;
     const TbRenderTargetId shadow_map = rt_sys->shadow_map;
     const TbRenderTargetId brightness = rt_sys->brightness;
+    const TbRenderTargetId bloom_chain = rt_sys->bloom_mip_chain;
+    const TbRenderTargetId ldr_target = rt_sys->ldr_target;
 
     // Create opaque depth normal pass
     {
-      const uint32_t trans_count = 4;
       TbRenderPassCreateInfo create_info = {
-          .transition_count = trans_count,
-          .transitions =
-              (PassTransition[trans_count]){
-                  {
-                      .render_target = sys.rt_sys->depth_buffer,
-                      .barrier =
-                          {
-                              .src_flags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask = VK_ACCESS_NONE,
-                                      .dstAccessMask =
-                                          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
-                                          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-                                      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_DEPTH_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
-                  {
-                      .render_target = sys.rt_sys->normal_buffer,
-                      .barrier =
-                          {
-                              .src_flags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask = VK_ACCESS_NONE,
-                                      .dstAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
-                  // We know we can fit some extra transitions here
-                  {
-                      .render_target = sys.rt_sys->hdr_color,
-                      .barrier =
-                          {
-                              .src_flags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask = VK_ACCESS_NONE,
-                                      .dstAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
-                  {
-                      .render_target = rt_sys->ldr_target,
-                      .barrier =
-                          {
-                              .src_flags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask = VK_ACCESS_NONE,
-                                      .dstAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
-              },
           .attachment_count = 2,
           .attachments =
               (TbAttachmentInfo[2]){
@@ -1130,6 +1446,7 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
                       .attachment = opaque_normal,
                   },
               },
+          .dynamic_res = true,
           .name = "Opaque Depth Normal Pass",
       };
 
@@ -1141,45 +1458,8 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     // Create env capture pass
     {
       for (uint32_t i = 0; i < PREFILTER_PASS_COUNT; ++i) {
-        uint32_t trans_count = 0;
-        PassTransition transitions[1] = {0};
-
-        // Do all mip transitions up-front
-        if (i == 0) {
-          trans_count = 1;
-          transitions[0] = (PassTransition){
-              .render_target = env_cube,
-              .barrier =
-                  {
-                      .src_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                      .dst_flags =
-                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                      .barrier =
-                          {
-                              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                              .srcAccessMask = VK_ACCESS_NONE,
-                              .dstAccessMask =
-                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                              .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                              .newLayout =
-                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                              .subresourceRange =
-                                  {
-                                      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                      .levelCount = PREFILTER_PASS_COUNT,
-                                      .layerCount = 6,
-                                  },
-                          },
-                  },
-          };
-        }
-
         TbRenderPassCreateInfo create_info = {
             .view_mask = 0x0000003F, // 0b00111111
-            .dependency_count = 1,
-            .dependencies = (TbRenderPassId[1]){sys.opaque_depth_normal_pass},
-            .transition_count = trans_count,
-            .transitions = transitions,
             .attachment_count = 1,
             .attachments =
                 (TbAttachmentInfo[1]){
@@ -1203,71 +1483,10 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     {
       TbRenderPassCreateInfo create_info = {
           .view_mask = 0x0000003F, // 0b00111111
-          .dependency_count = 1,
-          .dependencies =
-              (TbRenderPassId[1]){sys.env_cap_passes[PREFILTER_PASS_COUNT - 1]},
-          .transition_count = 2,
-          .transitions =
-              (PassTransition[2]){
-                  {
-                      .render_target = env_cube,
-                      .barrier =
-                          {
-                              .src_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .dstAccessMask =
-                                          VK_ACCESS_SHADER_READ_BIT,
-                                      .oldLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount =
-                                                  PREFILTER_PASS_COUNT,
-                                              .layerCount = 6,
-                                          },
-                                  },
-                          },
-                  },
-                  {
-                      .render_target = sys.rt_sys->irradiance_map,
-                      .barrier =
-                          {
-                              .src_flags =
-                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask = VK_ACCESS_NONE,
-                                      .dstAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 6,
-                                          },
-                                  },
-                          },
-                  },
+          .access_count = 1,
+          .accesses =
+              (TbPassAccess[1]){
+                  {.target = env_cube, .type = TB_PASS_ACCESS_SAMPLED},
               },
           .attachment_count = 1,
           .attachments =
@@ -1288,45 +1507,13 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     // Create environment prefiltering passes
     {
       for (uint32_t i = 0; i < PREFILTER_PASS_COUNT; ++i) {
-        uint32_t trans_count = 0;
-        PassTransition transitions[1] = {0};
-
-        // Do all mip transitions up-front
-        if (i == 0) {
-          trans_count = 1;
-          transitions[0] = (PassTransition){
-              .render_target = sys.rt_sys->prefiltered_cube,
-              .barrier =
-                  {
-                      .src_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                      .dst_flags =
-                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                      .barrier =
-                          {
-                              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                              .srcAccessMask = VK_ACCESS_NONE,
-                              .dstAccessMask =
-                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                              .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                              .newLayout =
-                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                              .subresourceRange =
-                                  {
-                                      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                      .levelCount = PREFILTER_PASS_COUNT,
-                                      .layerCount = 6,
-                                  },
-                          },
-                  },
-          };
-        }
-
         TbRenderPassCreateInfo create_info = {
             .view_mask = 0x0000003F, // 0b00111111
-            .dependency_count = 1,
-            .dependencies = (TbRenderPassId[1]){sys.irradiance_pass},
-            .transition_count = trans_count,
-            .transitions = transitions,
+            .access_count = 1,
+            .accesses =
+                (TbPassAccess[1]){
+                    {.target = env_cube, .type = TB_PASS_ACCESS_SAMPLED},
+                },
             .attachment_count = 1,
             .attachments =
                 (TbAttachmentInfo[1]){
@@ -1347,43 +1534,9 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     }
     // Create shadow passes
     {
-      // Note: this doesn't actually depend a previous pass,
-      // but for now the pass dependencies system only has one starter node,
-      // so everything must be a child of that
-
-      const uint32_t trans_count = 1;
-      PassTransition transitions[1] = {
-          {
-              .render_target = sys.rt_sys->shadow_map,
-              .barrier =
-                  {
-                      .src_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                      .dst_flags = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-                      .barrier =
-                          {
-                              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                              .srcAccessMask = VK_ACCESS_NONE,
-                              .dstAccessMask =
-                                  VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-                              .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                              .newLayout =
-                                  VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                              .subresourceRange =
-                                  {
-                                      .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                                      .levelCount = 1,
-                                      .layerCount = TB_CASCADE_COUNT,
-                                  },
-                          },
-                  },
-          },
-      };
-
       for (uint32_t cascade_idx = 0; cascade_idx < TB_CASCADE_COUNT;
            ++cascade_idx) {
         TbRenderPassCreateInfo create_info = {
-            .dependency_count = 1,
-            .dependencies = (TbRenderPassId[1]){sys.opaque_depth_normal_pass},
             .attachment_count = 1,
             .attachments =
                 (TbAttachmentInfo[1]){
@@ -1398,116 +1551,24 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
                 },
             .name = "Shadow Pass",
         };
-        // Only need to schedule transitions for the first pass
-        if (cascade_idx == 0) {
-          create_info.transition_count = trans_count;
-          create_info.transitions = transitions;
-        }
 
         TbRenderPassId id = create_render_pass(&sys, &create_info);
         TB_CHECK(id != InvalidRenderPassId, "Failed to create shadow pass");
         sys.shadow_passes[cascade_idx] = id;
       }
     }
+    // Lit passes read the view system's image based lighting and shadows
+    const uint32_t lit_access_count = 3;
+    const TbPassAccess lit_accesses[3] = {
+        {.target = shadow_map, .type = TB_PASS_ACCESS_SAMPLED},
+        {.target = irradiance_map, .type = TB_PASS_ACCESS_SAMPLED},
+        {.target = prefiltered_cube, .type = TB_PASS_ACCESS_SAMPLED},
+    };
     // Create opaque color pass
     {
-      // Transition irradiance map, prefiltered env map and shadow map
-      PassTransition irr_trans = {
-          .render_target = sys.rt_sys->irradiance_map,
-          .barrier = {
-              .src_flags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-              .dst_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-              .barrier =
-                  {
-                      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                      .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                      .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                      .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                      .subresourceRange =
-                          {
-                              .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                              .levelCount = 1,
-                              .layerCount = 6,
-                          },
-                  },
-          }};
-      PassTransition filter_trans = {
-          .render_target = sys.rt_sys->prefiltered_cube,
-          .barrier = {
-              .src_flags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-              .dst_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-              .barrier =
-                  {
-                      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                      .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                      .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                      .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                      .subresourceRange =
-                          {
-                              .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                              .levelCount = PREFILTER_PASS_COUNT,
-                              .layerCount = 6,
-                          },
-                  },
-          }};
-      PassTransition depth_trans = {
-          .render_target = sys.rt_sys->depth_buffer,
-          .barrier =
-              {
-                  .src_flags = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-                  .dst_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                  .barrier =
-                      {
-                          .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                          .srcAccessMask =
-                              VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-                          .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                          .oldLayout =
-                              VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                          .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                          .subresourceRange =
-                              {
-                                  .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                                  .levelCount = 1,
-                                  .layerCount = 1,
-                              },
-                      },
-              },
-      };
-      PassTransition shadow_trans = {
-          .render_target = sys.rt_sys->shadow_map,
-          .barrier = {
-              .src_flags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-              .dst_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-              .barrier =
-                  {
-                      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                      .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                      .oldLayout =
-                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                      .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                      .subresourceRange =
-                          {
-                              .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                              .levelCount = 1,
-                              .layerCount = TB_CASCADE_COUNT,
-                          },
-                  },
-          }};
-      const uint32_t transition_count = 4;
-      PassTransition transitions[4] = {shadow_trans, irr_trans, filter_trans,
-                                       depth_trans};
-
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 2,
-          .dependencies =
-              (TbRenderPassId[2]){sys.opaque_depth_normal_pass,
-                                  sys.shadow_passes[TB_CASCADE_COUNT - 1]},
-          .transition_count = transition_count,
-          .transitions = transitions,
+          .access_count = lit_access_count,
+          .accesses = lit_accesses,
           .attachment_count = 2,
           .attachments =
               (TbAttachmentInfo[2]){
@@ -1522,6 +1583,7 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
                       .attachment = opaque_depth,
                   },
               },
+          .dynamic_res = true,
           .name = "Opaque Color Pass",
       };
 
@@ -1532,9 +1594,6 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     // Create sky pass
     {
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 2,
-          .dependencies = (TbRenderPassId[2]){sys.opaque_depth_normal_pass,
-                                              sys.opaque_color_pass},
           .attachment_count = 2,
           .attachments =
               (TbAttachmentInfo[2]){
@@ -1549,6 +1608,7 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
                       .attachment = opaque_depth,
                   },
               },
+          .dynamic_res = true,
           .name = "Sky Pass",
       };
 
@@ -1559,40 +1619,10 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     // Create opaque depth copy pass
     {
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.sky_pass},
-          .transition_count = 1,
-          .transitions =
-              (PassTransition[1]){
-                  {
-                      .render_target = sys.rt_sys->depth_buffer_copy,
-                      .barrier =
-                          {
-                              .src_flags =
-                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask =
-                                          VK_ACCESS_SHADER_READ_BIT,
-                                      .dstAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
+          .access_count = 1,
+          .accesses =
+              (TbPassAccess[1]){
+                  {.target = opaque_depth, .type = TB_PASS_ACCESS_SAMPLED},
               },
           .attachment_count = 1,
           .attachments =
@@ -1613,70 +1643,10 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     // Create opaque color copy pass
     {
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.depth_copy_pass},
-          .transition_count = 2,
-          .transitions =
-              (PassTransition[2]){
-                  {
-                      .render_target = sys.rt_sys->hdr_color,
-                      .barrier =
-                          {
-                              .src_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .dstAccessMask =
-                                          VK_ACCESS_SHADER_READ_BIT,
-                                      .oldLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
-                  {
-                      .render_target = sys.rt_sys->color_copy,
-                      .barrier =
-                          {
-                              .src_flags =
-                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask =
-                                          VK_ACCESS_SHADER_READ_BIT,
-                                      .dstAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
+          .access_count = 1,
+          .accesses =
+              (TbPassAccess[1]){
+                  {.target = hdr_color, .type = TB_PASS_ACCESS_SAMPLED},
               },
           .attachment_count = 1,
           .attachments =
@@ -1694,46 +1664,19 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
       TB_CHECK(id != InvalidRenderPassId, "Failed to create color copy pass");
       sys.color_copy_pass = id;
     }
+    // Transparent draws like the ocean's refraction read the copies of the
+    // opaque depth and color. The copies are transient so without these
+    // accesses the copy passes would be culled and the copies aliased
+    const uint32_t trans_access_count = 2;
+    const TbPassAccess trans_accesses[2] = {
+        {.target = depth_copy, .type = TB_PASS_ACCESS_SAMPLED},
+        {.target = color_copy, .type = TB_PASS_ACCESS_SAMPLED},
+    };
     // Create transparent depth pass
     {
-      // Must transition back to depth so that we can load the contents
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.color_copy_pass},
-          .transition_count = 1,
-          .transitions =
-              (PassTransition[1]){
-                  {
-                      .render_target = sys.rt_sys->depth_buffer,
-                      .barrier =
-                          {
-                              .src_flags =
-                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask =
-                                          VK_ACCESS_SHADER_READ_BIT,
-                                      .dstAccessMask =
-                                          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-                                      .oldLayout =
-                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_DEPTH_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
-              },
+          .access_count = trans_access_count,
+          .accesses = trans_accesses,
           .attachment_count = 1,
           .attachments =
               (TbAttachmentInfo[1]){
@@ -1741,6 +1684,7 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
                       .attachment = transparent_depth,
                   },
               },
+          .dynamic_res = true,
           .name = "Transparent Depth Pass",
       };
 
@@ -1751,92 +1695,13 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     }
     // Create transparent color pass
     {
-      PassTransition transitions[3] = {
-          {
-              .render_target = sys.rt_sys->hdr_color,
-              .barrier =
-                  {
-                      .src_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                      .dst_flags =
-                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                      .barrier =
-                          {
-                              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                              .srcAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                              .dstAccessMask =
-                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                              .oldLayout =
-                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                              .newLayout =
-                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                              .subresourceRange =
-                                  {
-                                      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                      .levelCount = 1,
-                                      .layerCount = 1,
-                                  },
-                          },
-                  },
-          },
-          {
-              .render_target = sys.rt_sys->color_copy,
-              .barrier =
-                  {
-                      .src_flags =
-                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                      .dst_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                      .barrier =
-                          {
-                              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                              .srcAccessMask =
-                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                              .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                              .oldLayout =
-                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                              .newLayout =
-                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                              .subresourceRange =
-                                  {
-                                      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                      .levelCount = 1,
-                                      .layerCount = 1,
-                                  },
-                          },
-                  },
-          },
-          {
-              .render_target = sys.rt_sys->depth_buffer_copy,
-              .barrier =
-                  {
-                      .src_flags =
-                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                      .dst_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                      .barrier =
-                          {
-                              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                              .srcAccessMask =
-                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                              .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                              .oldLayout =
-                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                              .newLayout =
-                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                              .subresourceRange =
-                                  {
-                                      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                      .levelCount = 1,
-                                      .layerCount = 1,
-                                  },
-                          },
-                  },
-          },
+      const TbPassAccess accesses[5] = {
+          lit_accesses[0],   lit_accesses[1],   lit_accesses[2],
+          trans_accesses[0], trans_accesses[1],
       };
-
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.transparent_depth_pass},
-          .transition_count = 3,
-          .transitions = transitions,
+          .access_count = lit_access_count + trans_access_count,
+          .accesses = accesses,
           .attachment_count = 2,
           .attachments =
               (TbAttachmentInfo[2]){
@@ -1851,6 +1716,7 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
                       .attachment = transparent_depth,
                   },
               },
+          .dynamic_res = true,
           .name = "Transparent Color Pass",
       };
 
@@ -1859,71 +1725,39 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
                "Failed to create transparent color pass");
       sys.transparent_color_pass = id;
     }
-    // Create brightness pass
+    // Create upscale pass
     {
-      static const size_t trans_count = 2;
-      PassTransition transitions[2] = {
-          {
-              .render_target = sys.rt_sys->hdr_color,
-              .barrier =
-                  {
-                      // We know that the hdr color buffer will need to be r/w
-                      // on the fragment and compute stages
-                      .src_flags =
-                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                      .dst_flags = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
-                                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                      .barrier =
-                          {
-                              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                              .srcAccessMask =
-                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                              .dstAccessMask = VK_ACCESS_SHADER_READ_BIT |
-                                               VK_ACCESS_SHADER_WRITE_BIT,
-                              .oldLayout =
-                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                              .newLayout =
-                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                              .subresourceRange =
-                                  {
-                                      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                      .levelCount = 1,
-                                      .layerCount = 1,
-                                  },
-                          },
-                  },
-          },
-          {
-              .render_target = sys.rt_sys->brightness,
-              .barrier =
+      // Post processing runs at output resolution from here on
+      TbRenderPassCreateInfo create_info = {
+          .access_count = 1,
+          .accesses =
+              (TbPassAccess[1]){
+                  {.target = hdr_color, .type = TB_PASS_ACCESS_SAMPLED},
+              },
+          .attachment_count = 1,
+          .attachments =
+              (TbAttachmentInfo[1]){
                   {
-                      .src_flags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                      .dst_flags =
-                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                      .barrier =
-                          {
-                              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                              .srcAccessMask = VK_ACCESS_NONE,
-                              .dstAccessMask =
-                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                              .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                              .newLayout =
-                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                              .subresourceRange =
-                                  {
-                                      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                      .levelCount = 1,
-                                      .layerCount = 1,
-                                  },
-                          },
+                      .load_op = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                      .store_op = VK_ATTACHMENT_STORE_OP_STORE,
+                      .attachment = upscaled_color,
                   },
-          },
+              },
+          .name = "Upscale Pass",
       };
+
+      TbRenderPassId id = create_render_pass(&sys, &create_info);
+      TB_CHECK(id != InvalidRenderPassId, "Failed to create upscale pass");
+      sys.upscale_pass = id;
+    }
+    // Create brightness pass
+    {
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.transparent_color_pass},
-          .transition_count = trans_count,
-          .transitions = transitions,
+          .access_count = 1,
+          .accesses =
+              (TbPassAccess[1]){
+                  {.target = upscaled_color, .type = TB_PASS_ACCESS_SAMPLED},
+              },
           .attachment_count = 1,
           .attachments =
               (TbAttachmentInfo[1]){
@@ -1943,9 +1777,17 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     }
     // Create luminance compute pass
     {
+      // Only writes buffers which the graph doesn't track so it's never culled
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.brightness_pass},
+          .access_count = 1,
+          .accesses =
+              (TbPassAccess[1]){
+                  {
+                      .target = upscaled_color,
+                      .type = TB_PASS_ACCESS_SAMPLED,
+                      .stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  },
+              },
           .name = "Luminance Pass",
       };
       TbRenderPassId id = create_render_pass(&sys, &create_info);
@@ -1955,67 +1797,11 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     // Create one pass for downsampling
     {
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.luminance_pass},
-          .transition_count = 2,
-          .transitions =
-              (PassTransition[2]){
-                  // Need to read brightness
-                  {
-                      .render_target = sys.rt_sys->brightness,
-                      .barrier =
-                          {
-                              .src_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .dst_flags = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .dstAccessMask =
-                                          VK_ACCESS_SHADER_READ_BIT,
-                                      .oldLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .newLayout = VK_IMAGE_LAYOUT_GENERAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
-                  // We need the bloom chain to be readable and writable
-                  {
-                      .render_target = sys.rt_sys->bloom_mip_chain,
-                      .barrier =
-                          {
-                              .src_flags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                              .dst_flags = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask = VK_ACCESS_NONE,
-                                      .dstAccessMask =
-                                          VK_ACCESS_SHADER_READ_BIT |
-                                          VK_ACCESS_SHADER_WRITE_BIT,
-                                      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                                      .newLayout = VK_IMAGE_LAYOUT_GENERAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = TB_BLOOM_MIPS,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
+          .access_count = 2,
+          .accesses =
+              (TbPassAccess[2]){
+                  {.target = brightness, .type = TB_PASS_ACCESS_STORAGE_READ},
+                  {.target = bloom_chain, .type = TB_PASS_ACCESS_STORAGE},
               },
           .name = "Bloom Downsample",
       };
@@ -2027,8 +1813,11 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     // And one for upsampling
     {
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.bloom_downsample_pass},
+          .access_count = 1,
+          .accesses =
+              (TbPassAccess[1]){
+                  {.target = bloom_chain, .type = TB_PASS_ACCESS_STORAGE},
+              },
           .name = "Bloom Upsample",
       };
       TbRenderPassId id = create_render_pass(&sys, &create_info);
@@ -2038,46 +1827,25 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     }
     // Create tonemapping pass
     {
-      const uint32_t trans_count = 1;
-      // Need to read bloom mip chain (mip 0 only)
-      PassTransition transitions[1] = {
-          {
-              .render_target = sys.rt_sys->bloom_mip_chain,
-              .barrier =
+      TbRenderPassCreateInfo create_info = {
+          .access_count = 2,
+          .accesses =
+              (TbPassAccess[2]){
+                  {.target = upscaled_color, .type = TB_PASS_ACCESS_SAMPLED},
+                  // Only the full resolution mip of the bloom chain
                   {
-                      .src_flags = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                      .dst_flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                      .barrier =
-                          {
-                              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                              .srcAccessMask = VK_ACCESS_SHADER_READ_BIT |
-                                               VK_ACCESS_SHADER_WRITE_BIT,
-                              .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                              .oldLayout = VK_IMAGE_LAYOUT_GENERAL,
-                              .newLayout =
-                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                              .subresourceRange =
-                                  {
-                                      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                      .levelCount = 1,
-                                      .layerCount = 1,
-                                  },
-                          },
+                      .target = bloom_chain,
+                      .type = TB_PASS_ACCESS_SAMPLED,
+                      .mip_count = 1,
                   },
-          },
-      };
-      TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.bloom_upsample_pass},
-          .transition_count = trans_count,
-          .transitions = transitions,
+              },
           .attachment_count = 1,
           .attachments =
               (TbAttachmentInfo[1]){
                   {
                       .load_op = VK_ATTACHMENT_LOAD_OP_LOAD,
                       .store_op = VK_ATTACHMENT_STORE_OP_STORE,
-                      .attachment = rt_sys->ldr_target,
+                      .attachment = ldr_target,
                   },
               },
           .name = "Tonemapping Pass",
@@ -2089,41 +1857,10 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     // Create anti-aliasing pass
     {
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.tonemap_pass},
-          .transition_count = 1,
-          .transitions =
-              (PassTransition[1]){
-                  {
-                      .render_target = rt_sys->ldr_target,
-                      .barrier =
-                          {
-                              .src_flags =
-                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                              .dst_flags =
-                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                              .barrier =
-                                  {
-                                      .sType =
-                                          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                      .srcAccessMask =
-                                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                      .dstAccessMask =
-                                          VK_ACCESS_SHADER_READ_BIT,
-                                      .oldLayout =
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      .newLayout =
-                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                      .subresourceRange =
-                                          {
-                                              .aspectMask =
-                                                  VK_IMAGE_ASPECT_COLOR_BIT,
-                                              .levelCount = 1,
-                                              .layerCount = 1,
-                                          },
-                                  },
-                          },
-                  },
+          .access_count = 1,
+          .accesses =
+              (TbPassAccess[1]){
+                  {.target = ldr_target, .type = TB_PASS_ACCESS_SAMPLED},
               },
           .attachment_count = 1,
           .attachments =
@@ -2143,8 +1880,6 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     // Create UI Pass
     {
       TbRenderPassCreateInfo create_info = {
-          .dependency_count = 1,
-          .dependencies = (TbRenderPassId[1]){sys.fxaa_pass},
           .attachment_count = 1,
           .attachments =
               (TbAttachmentInfo[1]){
@@ -2162,38 +1897,48 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
     }
   }
 
-  // Calculate pass order
+  // Cull and order passes, then alias transient targets before deriving
+  // barriers since aliasing adds dependencies between targets
   const uint32_t pass_count = TB_DYN_ARR_SIZE(sys.render_passes);
   sys.pass_order = tb_alloc_nm_tp(sys.gp_alloc, pass_count, uint32_t);
 
-  sort_pass_graph(&sys);
-
-  // Once we've sorted passes, go through the passes
-  // in execution order and determine where full pipelines are used.
-  // Every time we return to the top of the pipeline, we want to keep track
-  // so we can use a different command buffer.
+  compile_pass_graph(&sys);
+  tb_alias_transient_targets(rt_sys);
+  TB_DYN_ARR_FOREACH(sys.render_passes, pass_idx) {
+    reimport_render_pass(&sys, (TbRenderPassId)pass_idx);
+  }
+  build_pass_barriers(&sys);
+
+  TB_LOG_INFO(SDL_LOG_CATEGORY_RENDER,
+              "Render graph: %u of %u passes live, %u barriers in %u batches",
+              sys.live_pass_count, pass_count, sys.barrier_count,
+              sys.barrier_batch_count);
+  TB_LOG_INFO(SDL_LOG_CATEGORY_RENDER,
+              "Render graph: aliased %.1f MiB of transient targets into "
+              "%.1f MiB per frame",
+              (double)rt_sys->transient_bytes / (1024.0 * 1024.0),
+              (double)rt_sys->aliased_bytes / (1024.0 * 1024.0));
+
+  // Go through the live passes in execution order and register them with the
+  // render thread
   {
     TB_TRACY_SCOPE("Register Passes");
-    uint32_t command_buffer_count = 0; // Treated as an index while builiding
-    // Worst case each pass needs its own command buffer
     uint32_t *command_buffer_indices =
         tb_alloc_nm_tp(sys.tmp_alloc, pass_count, uint32_t);
 
     {
       // Actually it's just faster if each pass gets their own command list for
       // now
-      command_buffer_count = pass_count;
-      for (uint32_t pass_idx = 0; pass_idx < pass_count; ++pass_idx) {
-        command_buffer_indices[pass_idx] = pass_idx;
+      const uint32_t command_buffer_count = sys.live_pass_count;
+      for (uint32_t pass_idx = 0; pass_idx < sys.live_pass_count; ++pass_idx) {
+        command_buffer_indices[sys.pass_order[pass_idx]] = pass_idx;
       }
 
-      // Ideally we'd want to have a desired # of command lists and space
-      // out recording across those but that's harder to actually implement
-      // And we can alieviate most of that if we just multithread command
-      // list recording
+      // Having a command list per pass is also what lets the render thread
+      // record every pass in parallel
 
       // Register passes in execution order
-      for (uint32_t pass_idx = 0; pass_idx < pass_count; ++pass_idx) {
+      for (uint32_t pass_idx = 0; pass_idx < sys.live_pass_count; ++pass_idx) {
         const uint32_t idx = sys.pass_order[pass_idx];
         register_pass(&sys, sys.rnd_sys->render_thread, idx,
                       command_buffer_indices, command_buffer_count);
@@ -2446,6 +2191,28 @@ create_render_pipeline_system(ecs_world_t *ecs, TbAllocator gp_alloc,
       }
     }
 
+    // Upscale
+    {
+      // Same copy shader, just writing to a target with the HDR format
+      TbPipeShaderArgs args = {
+          .rnd_sys = rnd_sys,
+          .format = tb_render_target_get_format(sys.rt_sys,
+                                                rt_sys->upscaled_color),
+          .pipe_layout = sys.copy_pipe_layout,
+      };
+      sys.upscale_shader = tb_shader_load(ecs, create_color_copy_pipeline,
+                                          &args, sizeof(TbPipeShaderArgs));
+
+      TbDrawContextDescriptor desc = {
+          .batch_size = sizeof(TbFullscreenBatch),
+          .draw_fn = record_upscale,
+          .pass_id = sys.upscale_pass,
+      };
+      sys.upscale_ctx = tb_render_pipeline_register_draw_context(&sys, &desc);
+      TB_CHECK(sys.upscale_ctx != InvalidDrawContextId,
+               "Failed to create upscale draw context");
+    }
+
     // Compute Copy
     {
       TbPipeShaderArgs args = {
@@ -2568,6 +2335,7 @@ void destroy_render_pipeline_system(ecs_world_t *ecs,
   tb_rnd_destroy_pipe_layout(self->rnd_sys, self->tonemap_pipe_layout);
   tb_shader_destroy(ecs, self->depth_copy_shader);
   tb_shader_destroy(ecs, self->color_copy_shader);
+  tb_shader_destroy(ecs, self->upscale_shader);
   tb_shader_destroy(ecs, self->comp_copy_shader);
   tb_shader_destroy(ecs, self->brightness_shader);
   tb_shader_destroy(ecs, self->tonemap_shader);
@@ -2595,7 +2363,7 @@ void destroy_render_pipeline_system(ecs_world_t *ecs,
 
 void tick_core_desc_pool(TbRenderPipelineSystem *self) {
   VkResult err = VK_SUCCESS;
-  const uint32_t set_count = 5;
+  const uint32_t set_count = 6;
   VkDescriptorPoolCreateInfo pool_info = {
       .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
       .maxSets = set_count * 4,
@@ -2619,7 +2387,7 @@ void tick_core_desc_pool(TbRenderPipelineSystem *self) {
   VkDescriptorSetLayout layouts[set_count] = {
       self->copy_set_layout,          self->copy_set_layout,
       self->lum_hist_work.set_layout, self->lum_avg_work.set_layout,
-      self->tonemap_set_layout,
+      self->tonemap_set_layout,       self->copy_set_layout,
   };
   err = tb_rnd_frame_desc_pool_tick(
       self->rnd_sys, "render_pipeline", &pool_info, layouts, NULL,
@@ -2637,18 +2405,22 @@ void tick_core_desc_pool(TbRenderPipelineSystem *self) {
       tb_rnd_frame_desc_pool_get_set(self->rnd_sys, self->descriptor_pools, 3);
   VkDescriptorSet tonemap_set =
       tb_rnd_frame_desc_pool_get_set(self->rnd_sys, self->descriptor_pools, 4);
+  VkDescriptorSet upscaled_set =
+      tb_rnd_frame_desc_pool_get_set(self->rnd_sys, self->descriptor_pools, 5);
 
   VkImageView depth_view = tb_render_target_get_view(
       self->rt_sys, self->rnd_sys->frame_idx, self->rt_sys->depth_buffer);
   VkImageView color_view = tb_render_target_get_view(
       self->rt_sys, self->rnd_sys->frame_idx, self->rt_sys->hdr_color);
+  VkImageView upscaled_view = tb_render_target_get_view(
+      self->rt_sys, self->rnd_sys->frame_idx, self->rt_sys->upscaled_color);
   VkBuffer lum_hist_buffer = self->lum_hist_work.lum_histogram.buffer;
   VkBuffer lum_avg_buffer = self->lum_avg_work.lum_avg.buffer;
   VkImageView bloom_full_view = tb_render_target_get_mip_view(
       self->rt_sys, 0, 0, self->rnd_sys->frame_idx,
       self->rt_sys->bloom_mip_chain);
 
-#define WRITE_COUNT 9
+#define WRITE_COUNT 10
   VkWriteDescriptorSet writes[WRITE_COUNT] = {
       {
           .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
@@ -2676,6 +2448,19 @@ void tick_core_desc_pool(TbRenderPipelineSystem *self) {
                   .imageView = color_view,
               },
       },
+      {
+          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+          .dstSet = upscaled_set,
+          .dstBinding = 0,
+          .dstArrayElement = 0,
+          .descriptorCount = 1,
+          .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+          .pImageInfo =
+              &(VkDescriptorImageInfo){
+                  .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                  .imageView = upscaled_view,
+              },
+      },
       {
           .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
           .dstSet = lum_hist_set,
@@ -2686,7 +2471,7 @@ void tick_core_desc_pool(TbRenderPipelineSystem *self) {
           .pImageInfo =
               &(VkDescriptorImageInfo){
                   .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                  .imageView = color_view,
+                  .imageView = upscaled_view,
               },
       },
       {
@@ -2738,7 +2523,7 @@ void tick_core_desc_pool(TbRenderPipelineSystem *self) {
           .pImageInfo =
               &(VkDescriptorImageInfo){
                   .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                  .imageView = color_view,
+                  .imageView = upscaled_view,
               },
       },
       {
@@ -2977,6 +2762,8 @@ void tick_render_pipeline_sys(ecs_iter_t *it) {
         self->rnd_sys, self->descriptor_pools, 3);
     VkDescriptorSet tonemap_set = tb_rnd_frame_desc_pool_get_set(
         self->rnd_sys, self->descriptor_pools, 4);
+    VkDescriptorSet upscaled_set = tb_rnd_frame_desc_pool_get_set(
+        self->rnd_sys, self->descriptor_pools, 5);
 
     VkDescriptorSet downsample_sets[BLUR_BATCH_COUNT] = {0};
     VkDescriptorSet upsample_sets[BLUR_BATCH_COUNT] = {0};
@@ -2991,8 +2778,15 @@ void tick_render_pipeline_sys(ecs_iter_t *it) {
     const uint32_t width = self->rnd_sys->render_thread->swapchain.width;
     const uint32_t height = self->rnd_sys->render_thread->swapchain.height;
 
+    // Copy passes are culled when nothing samples their output
+    const bool depth_copy_live =
+        !TB_DYN_ARR_AT(self->render_passes, self->depth_copy_pass).culled;
+    const bool color_copy_live =
+        !TB_DYN_ARR_AT(self->render_passes, self->color_copy_pass).culled;
+
     // Depth copy pass
-    if (tb_is_shader_ready(it->world, self->color_copy_shader)) {
+    if (depth_copy_live &&
+        tb_is_shader_ready(it->world, self->color_copy_shader)) {
       TbFullscreenBatch fs_batch = {
           .set = depth_set,
       };
@@ -3008,7 +2802,8 @@ void tick_render_pipeline_sys(ecs_iter_t *it) {
                                           &batch);
     }
     // Color copy pass
-    if (tb_is_shader_ready(it->world, self->color_copy_shader)) {
+    if (color_copy_live &&
+        tb_is_shader_ready(it->world, self->color_copy_shader)) {
       TbFullscreenBatch fs_batch = {
           .set = color_set,
       };
@@ -3023,6 +2818,25 @@ void tick_render_pipeline_sys(ecs_iter_t *it) {
       tb_render_pipeline_issue_draw_batch(self, self->color_copy_ctx, 1,
                                           &batch);
     }
+    // Upscale pass
+    if (tb_is_shader_ready(it->world, self->upscale_shader)) {
+      // Stretching the viewport by the inverse scale makes the fullscreen
+      // triangle only sample the corner the scene was rendered into
+      const float inv_scale = 1.0f / self->render_scale;
+      const float vp_width = (float)width * inv_scale;
+      const float vp_height = (float)height * inv_scale;
+      TbFullscreenBatch fs_batch = {
+          .set = color_set,
+      };
+      TbDrawBatch batch = {
+          .layout = self->copy_pipe_layout,
+          .pipeline = tb_shader_get_pipeline(it->world, self->upscale_shader),
+          .viewport = {0, vp_height, vp_width, -vp_height, 0, 1},
+          .scissor = {{0, 0}, {width, height}},
+          .user_batch = &fs_batch,
+      };
+      tb_render_pipeline_issue_draw_batch(self, self->upscale_ctx, 1, &batch);
+    }
     if (tb_is_shader_ready(it->world, self->lum_hist_work.shader) &&
         tb_is_shader_ready(it->world, self->lum_avg_work.shader)) {
       // Configurables
@@ -3072,7 +2886,7 @@ void tick_render_pipeline_sys(ecs_iter_t *it) {
     if (tb_is_shader_ready(it->world, self->brightness_shader) &&
         tb_is_texture_ready(it->world, brdf_tex)) {
       TbFullscreenBatch fs_batch = {
-          .set = color_set,
+          .set = upscaled_set,
       };
       TbDrawBatch batch = {
           .layout = self->copy_pipe_layout,
@@ -3153,6 +2967,110 @@ void tick_render_pipeline_sys(ecs_iter_t *it) {
   }
 }
 
+uint32_t scale_extent(uint32_t extent, float scale) {
+  return SDL_max((uint32_t)SDL_ceilf((float)extent * scale), 1);
+}
+
+// Draws into dynamic resolution passes only cover the scaled corner of the
+// pass's targets
+void scale_draw_batch(TbDrawBatch *batch, float scale) {
+  batch->viewport.x *= scale;
+  batch->viewport.y *= scale;
+  batch->viewport.width *= scale;
+  batch->viewport.height *= scale;
+  batch->scissor.offset.x = (int32_t)((float)batch->scissor.offset.x * scale);
+  batch->scissor.offset.y = (int32_t)((float)batch->scissor.offset.y * scale);
+  batch->scissor.extent.width =
+      scale_extent(batch->scissor.extent.width, scale);
+  batch->scissor.extent.height =
+      scale_extent(batch->scissor.extent.height, scale);
+}
+
+void push_pass_timing(TbRenderPass *pass, float gpu_ms) {
+  if (pass->gpu_ms_count == TB_PASS_TIMING_WINDOW) {
+    pass->gpu_ms_sum -= pass->gpu_ms_samples[pass->gpu_ms_head];
+  } else {
+    pass->gpu_ms_count++;
+  }
+  pass->gpu_ms_samples[pass->gpu_ms_head] = gpu_ms;
+  pass->gpu_ms_sum += gpu_ms;
+  pass->gpu_ms_head = (pass->gpu_ms_head + 1) % TB_PASS_TIMING_WINDOW;
+}
+
+void rp_gpu_timing_tick(ecs_iter_t *it) {
+  TB_TRACY_SCOPEC("GPU Timing Tick", TracyCategoryColorRendering);
+  tb_auto self = ecs_field(it, TbRenderPipelineSystem, 0);
+  tb_auto thread = self->rnd_sys->render_thread;
+  tb_auto state = &thread->frame_states[self->rnd_sys->frame_idx];
+
+  // render_frame_begin already waited on this frame state so its timestamps
+  // from TB_MAX_FRAME_STATES frames ago have been resolved
+  if (!state->timestamps_written) {
+    return;
+  }
+  self->gpu_ms = state->gpu_ms;
+  TB_DYN_ARR_FOREACH(state->pass_contexts, ctx_idx) {
+    if (ctx_idx >= TB_MAX_COMMAND_BUFFERS) {
+      break;
+    }
+    tb_auto pass_ctx = &TB_DYN_ARR_AT(state->pass_contexts, ctx_idx);
+    tb_auto pass = &TB_DYN_ARR_AT(self->render_passes, pass_ctx->id);
+    push_pass_timing(pass, state->pass_gpu_ms[ctx_idx]);
+    pass->record_ms = pass_ctx->record_ms;
+  }
+}
+
+void rp_dyn_res_tick(ecs_iter_t *it) {
+  TB_TRACY_SCOPEC("Dynamic Resolution Tick", TracyCategoryColorRendering);
+  tb_auto self = ecs_field(it, TbRenderPipelineSystem, 0);
+  tb_auto settings = ecs_singleton_get(it->world, TbSettings);
+  if (!settings) {
+    return;
+  }
+  tb_auto thread = self->rnd_sys->render_thread;
+  const uint32_t frame_idx = self->rnd_sys->frame_idx;
+
+  const float max_scale = SDL_clamp(settings->resolution_scale,
+                                    TB_DYN_RES_DEFAULT_MIN_SCALE, 1.0f);
+  // The upscale pass stretches its viewport by the inverse of the scale
+  // which can't go past the device's viewport limits
+  const uint32_t *max_dims =
+      thread->gpu_props.properties.limits.maxViewportDimensions;
+  const float min_scale = SDL_min(
+      SDL_max(TB_DYN_RES_DEFAULT_MIN_SCALE,
+              SDL_max((float)thread->swapchain.width / (float)max_dims[0],
+                      (float)thread->swapchain.height / (float)max_dims[1])),
+      max_scale);
+
+  tb_auto dyn_res = &self->dyn_res;
+  if (settings->dynamic_resolution) {
+    dyn_res->target_ms = settings->gpu_budget_ms;
+    dyn_res->min_scale = min_scale;
+    dyn_res->max_scale = max_scale;
+    dyn_res->scale = SDL_clamp(dyn_res->scale, min_scale, max_scale);
+    self->render_scale = tb_dyn_res_update(dyn_res, self->gpu_ms);
+  } else {
+    // Turning dynamic resolution on starts over from the fixed scale
+    tb_dyn_res_init(dyn_res, settings->gpu_budget_ms, min_scale, max_scale);
+    self->render_scale = max_scale;
+  }
+
+  // Targets stay at full size; scaled passes just render to less of them
+  TB_DYN_ARR_FOREACH(self->render_passes, pass_idx) {
+    tb_auto pass = &TB_DYN_ARR_AT(self->render_passes, pass_idx);
+    if (!pass->dynamic_res || pass->culled || pass->attach_count == 0) {
+      continue;
+    }
+    const VkExtent3D extent = tb_render_target_get_mip_extent(
+        self->rt_sys, pass->attachments[0].layer, pass->attachments[0].mip,
+        pass->attachments[0].attachment);
+    pass->info[frame_idx].renderArea.extent = (VkExtent2D){
+        scale_extent(extent.width, self->render_scale),
+        scale_extent(extent.height, self->render_scale),
+    };
+  }
+}
+
 void rp_check_swapchain_resize(ecs_iter_t *it) {
   TB_TRACY_SCOPEC("Check Swapchain Resize", TracyCategoryColorRendering);
   tb_auto rp_sys = ecs_field(it, TbRenderPipelineSystem, 0);
@@ -3192,6 +3110,10 @@ void tb_register_render_pipeline_sys(TbWorld *world) {
 
   tb_auto rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem);
   tb_auto rt_sys = ecs_singleton_ensure(ecs, TbRenderTargetSystem);
+
+  // Lets the render thread record passes on the task scheduler's workers.
+  // No frame has been handed to the render thread yet so this is safe
+  rnd_sys->render_thread->enki = *ecs_singleton_get(ecs, TbTaskScheduler);
   tb_auto view_sys = ecs_singleton_ensure(ecs, TbViewSystem);
 
   TbRenderPipelineSystem sys = create_render_pipeline_system(
@@ -3203,6 +3125,12 @@ void tb_register_render_pipeline_sys(TbWorld *world) {
   ECS_SYSTEM(ecs, rp_check_swapchain_resize, EcsPreFrame,
              TbRenderPipelineSystem($));
 
+  // Both run after render_frame_begin. Timings are gathered first so the
+  // scale picked for this frame's draws reacts to them
+  ECS_SYSTEM(ecs, rp_gpu_timing_tick, EcsPreUpdate,
+             TbRenderPipelineSystem($));
+  ECS_SYSTEM(ecs, rp_dyn_res_tick, EcsPreUpdate, TbRenderPipelineSystem($));
+
   ECS_SYSTEM(ecs, tick_render_pipeline_sys, EcsPostUpdate,
              TbRenderPipelineSystem($));
 }
@@ -3217,45 +3145,71 @@ void tb_unregister_render_pipeline_sys(TbWorld *world) {
 
 void reimport_render_pass(TbRenderPipelineSystem *self, TbRenderPassId id) {
   TbRenderPass *rp = &TB_DYN_ARR_AT(self->render_passes, id);
+  if (rp->attach_count == 0) {
+    return;
+  }
 
-  {
-    TbRenderTargetSystem *rt_sys = self->rt_sys;
-    // HACK: Assume all attachments have the same extents
-    const VkExtent3D extent = tb_render_target_get_mip_extent(
-        rt_sys, rp->attachments[0].layer, rp->attachments[0].mip,
-        rp->attachments[0].attachment);
+  TbRenderTargetSystem *rt_sys = self->rt_sys;
+  // HACK: Assume all attachments have the same extents
+  const VkExtent3D extent = tb_render_target_get_mip_extent(
+      rt_sys, rp->attachments[0].layer, rp->attachments[0].mip,
+      rp->attachments[0].attachment);
 
-    for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
-      // Update the pass context on each frame index
-      {
-        TbFrameState *state = &self->rnd_sys->render_thread->frame_states[i];
-        TbPassContext *context = &TB_DYN_ARR_AT(state->pass_contexts, id);
-        context->width = extent.width;
-        context->height = extent.height;
-
-        context->render_info->renderArea.extent =
-            (VkExtent2D){extent.width, extent.height};
-
-        uint32_t col_count = 0;
-        for (uint32_t attach_idx = 0; attach_idx < rp->attach_count;
-             ++attach_idx) {
-          TbRenderTargetId rt = rp->attachments[attach_idx].attachment;
-          VkFormat format = tb_render_target_get_format(rt_sys, rt);
-          VkImageView view = tb_render_target_get_mip_view(
-              rt_sys, rp->attachments[attach_idx].layer,
-              rp->attachments[attach_idx].mip, i, rt);
-
-          // Forgive the const casting :(
-          if (format == VK_FORMAT_D32_SFLOAT) {
-            ((VkRenderingAttachmentInfo *)
-                 context->render_info->pDepthAttachment)
-                ->imageView = view;
-          } else {
-            ((VkRenderingAttachmentInfo *)
-                 context->render_info->pColorAttachments)[col_count++]
-                .imageView = view;
-          }
-        }
+  // Pass contexts point at this rendering info so patching it here is enough
+  for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
+    VkRenderingInfo *info = &rp->info[i];
+    info->renderArea.extent = (VkExtent2D){extent.width, extent.height};
+
+    uint32_t col_count = 0;
+    for (uint32_t attach_idx = 0; attach_idx < rp->attach_count;
+         ++attach_idx) {
+      TbRenderTargetId rt = rp->attachments[attach_idx].attachment;
+      VkFormat format = tb_render_target_get_format(rt_sys, rt);
+      VkImageView view = tb_render_target_get_mip_view(
+          rt_sys, rp->attachments[attach_idx].layer,
+          rp->attachments[attach_idx].mip, i, rt);
+
+      // Forgive the const casting :(
+      if (format == VK_FORMAT_D32_SFLOAT) {
+        ((VkRenderingAttachmentInfo *)info->pDepthAttachment)->imageView =
+            view;
+      } else {
+        ((VkRenderingAttachmentInfo *)info->pColorAttachments)[col_count++]
+            .imageView = view;
+      }
+    }
+  }
+}
+
+void tb_render_pipeline_reimport_targets(TbRenderPipelineSystem *self) {
+  // Patch every pass and its context so that they point at the right views
+  // and VkImages
+  TB_DYN_ARR_FOREACH(self->render_passes, pass_idx) {
+    reimport_render_pass(self, (TbRenderPassId)pass_idx);
+  }
+  for (uint32_t order_idx = 0; order_idx < self->live_pass_count;
+       ++order_idx) {
+    TbRenderPass *pass =
+        &TB_DYN_ARR_AT(self->render_passes, self->pass_order[order_idx]);
+    const VkExtent3D extent = tb_render_target_get_mip_extent(
+        self->rt_sys, pass->attachments[0].layer, pass->attachments[0].mip,
+        pass->attachments[0].attachment);
+    for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES;
+         ++frame_idx) {
+      TbFrameState *state =
+          &self->rnd_sys->render_thread->frame_states[frame_idx];
+      TbPassContext *context =
+          &TB_DYN_ARR_AT(state->pass_contexts, pass->context_idx);
+      context->width = extent.width;
+      context->height = extent.height;
+      context->barrier_count = pass->transition_count;
+      for (uint32_t trans_idx = 0; trans_idx < pass->transition_count;
+           ++trans_idx) {
+        const PassTransition *transition = &pass->transitions[trans_idx];
+        TbImageTransition *barrier = &context->barriers[trans_idx];
+        *barrier = transition->barrier;
+        barrier->barrier.image = tb_render_target_get_image(
+            self->rt_sys, frame_idx, transition->render_target);
       }
     }
   }
@@ -3266,49 +3220,16 @@ void tb_rnd_on_swapchain_resize(TbRenderPipelineSystem *self) {
   // This is where, on the main thread, we have to adjust to any render passes
   // and render targets to stay up to date with the latest swapchain
 
-  // Reimport the swapchain target and resize all default targets
+  // Reimport the swapchain target and resize all default targets. Transient
+  // targets are re-aliased so aliasing barriers have to be derived again
   // The render thread should have created the necessary resources before
   // signaling the main thread
   tb_reimport_swapchain(self->rt_sys);
+  build_pass_barriers(self);
 
   // Render target system is up to date, now we just have to re-create all
   // render passes
-  {
-    reimport_render_pass(self, self->opaque_depth_normal_pass);
-    reimport_render_pass(self, self->opaque_color_pass);
-    reimport_render_pass(self, self->depth_copy_pass);
-    reimport_render_pass(self, self->color_copy_pass);
-    reimport_render_pass(self, self->sky_pass);
-    reimport_render_pass(self, self->transparent_depth_pass);
-    reimport_render_pass(self, self->transparent_color_pass);
-    reimport_render_pass(self, self->brightness_pass);
-    reimport_render_pass(self, self->bloom_blur_pass);
-    reimport_render_pass(self, self->bloom_downsample_pass);
-    reimport_render_pass(self, self->bloom_upsample_pass);
-    reimport_render_pass(self, self->tonemap_pass);
-    reimport_render_pass(self, self->fxaa_pass);
-    reimport_render_pass(self, self->ui_pass);
-  }
-
-  // We now need to patch every pass's transitions so that their targets point
-  // at the right VkImages
-  TB_DYN_ARR_FOREACH(self->render_passes, pass_idx) {
-    TbRenderPass *pass = &TB_DYN_ARR_AT(self->render_passes, pass_idx);
-    for (uint32_t trans_idx = 0; trans_idx < pass->transition_count;
-         ++trans_idx) {
-      for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES;
-           ++frame_idx) {
-        TbFrameState *state =
-            &self->rnd_sys->render_thread->frame_states[frame_idx];
-        TbPassContext *context = &TB_DYN_ARR_AT(state->pass_contexts, pass_idx);
-        const PassTransition *transition = &pass->transitions[trans_idx];
-        TbImageTransition *barrier = &context->barriers[trans_idx];
-        *barrier = transition->barrier;
-        barrier->barrier.image = tb_render_target_get_image(
-            self->rt_sys, frame_idx, transition->render_target);
-      }
-    }
-  }
+  tb_render_pipeline_reimport_targets(self);
 
   // Also clear out any draws that were in flight on the render thread
   // Any draws that had descriptors that point to these re-created resources
@@ -3396,6 +3317,9 @@ void tb_render_pipeline_issue_draw_batch(TbRenderPipelineSystem *self,
   }
 
   TbDrawContext *ctx = &TB_DYN_ARR_AT(state->draw_contexts, draw_ctx);
+  const bool scaled =
+      TB_DYN_ARR_AT(self->render_passes, ctx->pass_id).dynamic_res &&
+      self->render_scale < 1.0f;
 
   const uint32_t write_head = ctx->batch_count;
   const uint32_t new_count = ctx->batch_count + batch_count;
@@ -3437,6 +3361,9 @@ void tb_render_pipeline_issue_draw_batch(TbRenderPipelineSystem *self,
     if (batch->draw_count > write_batch->draw_max) {
       write_batch->draw_max = batch->draw_count;
     }
+    if (scaled) {
+      scale_draw_batch(write_batch, self->render_scale);
+    }
   }
 
   ctx->batch_count = new_count;
@@ -3488,3 +3415,47 @@ void tb_render_pipeline_issue_dispatch_batch(TbRenderPipelineSystem *self,
 
   ctx->batch_count = new_count;
 }
+
+uint32_t tb_render_pipeline_get_pass_timings(TbRenderPipelineSystem *self,
+                                             TbPassTiming *timings) {
+  for (uint32_t i = 0; i < self->live_pass_count; ++i) {
+    tb_auto pass = &TB_DYN_ARR_AT(self->render_passes, self->pass_order[i]);
+    timings[i] = (TbPassTiming){
+        .name = pass->label,
+        .record_ms = pass->record_ms,
+    };
+    if (pass->gpu_ms_count > 0) {
+      timings[i].gpu_ms = pass->gpu_ms_sum / (float)pass->gpu_ms_count;
+    }
+  }
+  return self->live_pass_count;
+}
+
+bool tb_render_pipeline_write_timings_csv(TbRenderPipelineSystem *self,
+                                          const char *path) {
+  TB_TRACY_SCOPE("Write Pass Timings CSV");
+  SDL_IOStream *file = SDL_IOFromFile(path, "w");
+  if (file == NULL) {
+    TB_LOG_ERROR(SDL_LOG_CATEGORY_RENDER, "Failed to open %s: %s", path,
+                 SDL_GetError());
+    return false;
+  }
+
+  tb_auto timings = tb_alloc_nm_tp(self->tmp_alloc, self->live_pass_count,
+                                   TbPassTiming);
+  const uint32_t count = tb_render_pipeline_get_pass_timings(self, timings);
+
+  bool ok = SDL_IOprintf(file, "pass,gpu_ms,record_ms\n") > 0;
+  for (uint32_t i = 0; i < count && ok; ++i) {
+    ok = SDL_IOprintf(file, "\"%s\",%.4f,%.4f\n", timings[i].name,
+                      (double)timings[i].gpu_ms,
+                      (double)timings[i].record_ms) > 0;
+  }
+  ok = ok && SDL_IOprintf(file, "\"Frame\",%.4f,\n", (double)self->gpu_ms) > 0;
+  ok = SDL_CloseIO(file) && ok;
+  if (!ok) {
+    TB_LOG_ERROR(SDL_LOG_CATEGORY_RENDER, "Failed to write %s: %s", path,
+                 SDL_GetError());
+  }
+  return ok;
+}
@@ -2,6 +2,7 @@
 
 #include "mimalloc.h"
 #include "tb_common.h"
+#include "tb_frame_stats.h"
 #include "tb_profiling.h"
 #include "tb_render_thread.h"
 #include "tb_world.h"
@@ -126,6 +127,11 @@ TbRenderSystem create_render_system(TbAllocator gp_alloc, TbAllocator tmp_alloc,
       TB_QUEUE_RESET(state->set_write_queue, tb_global_alloc, 1);
       TB_QUEUE_RESET(state->buf_copy_queue, tb_global_alloc, 1);
       TB_QUEUE_RESET(state->buf_img_copy_queue, tb_global_alloc, 1);
+      TB_QUEUE_RESET(state->async_buf_copy_queue, tb_global_alloc, 1);
+      TB_QUEUE_RESET(state->async_buf_img_copy_queue, tb_global_alloc, 1);
+      TB_QUEUE_RESET(state->free_queue, tb_global_alloc, 1);
+      // Frame states are handed to the render thread in order
+      state->upload_value = state_idx + 1;
 
       // Allocate tmp host buffer
       {
@@ -181,10 +187,34 @@ TbRenderSystem create_render_system(TbAllocator gp_alloc, TbAllocator tmp_alloc,
   return sys;
 }
 
+static void tb_rnd_process_frees(TbRenderSystem *self,
+                                 TbRenderSystemFrameState *state) {
+  TB_TRACY_SCOPE("Process GPU Frees");
+  TbGpuFree gpu_free = {0};
+  while (TB_QUEUE_POP(state->free_queue, &gpu_free)) {
+    switch (gpu_free.type) {
+    case TB_GPU_FREE_BUFFER:
+      vmaDestroyBuffer(self->vma_alloc, gpu_free.buffer, gpu_free.alloc);
+      break;
+    case TB_GPU_FREE_IMAGE:
+      vmaDestroyImage(self->vma_alloc, gpu_free.image, gpu_free.alloc);
+      break;
+    case TB_GPU_FREE_IMAGE_VIEW:
+      tb_rnd_destroy_image_view(self, gpu_free.view);
+      break;
+    }
+  }
+}
+
 void destroy_render_system(TbRenderSystem *self) {
   // Assume we have already stopped the render thread at this point
   VmaAllocator vma_alloc = self->vma_alloc;
 
+  // Nothing is in flight anymore so anything still waiting can go
+  for (uint32_t state_idx = 0; state_idx < TB_MAX_FRAME_STATES; ++state_idx) {
+    tb_rnd_process_frees(self, &self->frame_states[state_idx]);
+  }
+
   VkDevice device = self->render_thread->device;
 
   // Write out pipeline cache
@@ -220,6 +250,9 @@ void destroy_render_system(TbRenderSystem *self) {
     TB_QUEUE_DESTROY(state->set_write_queue);
     TB_QUEUE_DESTROY(state->buf_copy_queue);
     TB_QUEUE_DESTROY(state->buf_img_copy_queue);
+    TB_QUEUE_DESTROY(state->async_buf_copy_queue);
+    TB_QUEUE_DESTROY(state->async_buf_img_copy_queue);
+    TB_QUEUE_DESTROY(state->free_queue);
   }
 
   // Clean up main thread owned memory that the render thread held the primary
@@ -251,6 +284,10 @@ void render_frame_begin(ecs_iter_t *it) {
   tb_wait_render(sys->render_thread, sys->frame_idx);
   TracyCZoneEnd(wait_ctx);
 
+  // The last frame that used this frame state is done on the GPU so
+  // anything freed while it was being recorded can finally be destroyed
+  tb_rnd_process_frees(sys, &sys->frame_states[sys->frame_idx]);
+
   // Also
   // Manually zero out the previous frame's draw batches here
   // It's cleaner to do it here than dedicate a whole system to this
@@ -304,12 +341,23 @@ void render_frame_end(ecs_iter_t *it) {
       thread_state->set_write_queue = &state->set_write_queue;
       thread_state->buf_copy_queue = &state->buf_copy_queue;
       thread_state->buf_img_copy_queue = &state->buf_img_copy_queue;
+      thread_state->async_buf_copy_queue = &state->async_buf_copy_queue;
+      thread_state->async_buf_img_copy_queue = &state->async_buf_img_copy_queue;
+      thread_state->upload_value = state->upload_value;
     }
 
+    // The next time this frame state comes around it will be
+    // TB_MAX_FRAME_STATES frames later
+    state->upload_value += TB_MAX_FRAME_STATES;
+
     // Reset temp pool, the contents will still be intact for the render thread
     // but it will be reset for the next time this frame is processed
     {
       tb_auto state = &sys->frame_states[sys->frame_idx];
+      sys->tmp_bytes_last_frame = state->tmp_host_buffer.info.size;
+      TracyCPlot("Tmp Buffer Bytes", (double)sys->tmp_bytes_last_frame);
+      tb_frame_stat_set(TB_FRAME_STAT_TMP_BYTES,
+                        (int64_t)sys->tmp_bytes_last_frame);
       state->tmp_host_buffer.info.size = 0;
     }
   }
@@ -397,6 +445,12 @@ VkResult alloc_host_buffer(TbRenderSystem *self,
   return VK_SUCCESS;
 }
 
+VkResult tb_rnd_sys_alloc_host_buffer(TbRenderSystem *self,
+                                      const VkBufferCreateInfo *create_info,
+                                      const char *name, TbHostBuffer *buffer) {
+  return alloc_host_buffer(self, create_info, name, buffer);
+}
+
 VkResult tb_rnd_sys_alloc_gpu_buffer(TbRenderSystem *self,
                                      const VkBufferCreateInfo *create_info,
                                      const char *name, TbBuffer *buffer) {
@@ -581,19 +635,17 @@ VkResult tb_rnd_sys_create_gpu_buffer2_tmp(
 // This needs to be seriously re-thought from the perspective of
 // texture streaming
 // For now scheduling uploads will be the responsibility of the caller
-VkResult tb_rnd_sys_create_gpu_image(TbRenderSystem *self, const void *data,
-                                     uint64_t data_size,
-                                     const VkImageCreateInfo *create_info,
-                                     const char *name, TbImage *image,
-                                     TbHostBuffer *host) {
+VkResult tb_rnd_sys_alloc_gpu_image_upload(TbRenderSystem *self,
+                                           uint64_t data_size,
+                                           const VkImageCreateInfo *create_info,
+                                           const char *name, TbImage *image,
+                                           TbHostBuffer *host, void **ptr) {
   VkResult err = tb_rnd_sys_alloc_gpu_image(self, create_info, 0, name, image);
   TB_VK_CHECK_RET(err, "Failed to allocate gpu image for texture", err);
 
-  void *ptr = NULL;
-
   // See if we can just write to the image
-  if (!try_map(self->vma_alloc, image->alloc, &ptr)) {
-    // Allocate memory on the host and copy data to it
+  if (!try_map(self->vma_alloc, image->alloc, ptr)) {
+    // Allocate memory on the host to stage the upload from
     VkBufferCreateInfo buffer_info = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size = data_size,
@@ -602,9 +654,22 @@ VkResult tb_rnd_sys_create_gpu_image(TbRenderSystem *self, const void *data,
     err = alloc_host_buffer(self, &buffer_info, name, host);
     TB_VK_CHECK_RET(err, "Failed to allocate host buffer for texture", err);
 
-    ptr = host->info.pMappedData;
+    *ptr = host->info.pMappedData;
   }
 
+  return err;
+}
+
+VkResult tb_rnd_sys_create_gpu_image(TbRenderSystem *self, const void *data,
+                                     uint64_t data_size,
+                                     const VkImageCreateInfo *create_info,
+                                     const char *name, TbImage *image,
+                                     TbHostBuffer *host) {
+  void *ptr = NULL;
+  VkResult err = tb_rnd_sys_alloc_gpu_image_upload(
+      self, data_size, create_info, name, image, host, &ptr);
+  TB_VK_CHECK_RET(err, "Failed to allocate gpu image for texture", err);
+
   // Copy data to the buffer
   SDL_memcpy(ptr, data, data_size); // NOLINT
   tb_flush_alloc(self, image->alloc);
@@ -684,6 +749,10 @@ VkDeviceAddress tb_rnd_get_gpu_tmp_addr(TbRenderSystem *self) {
   return self->render_thread->frame_states[self->frame_idx].tmp_gpu_buf_addr;
 }
 
+uint64_t tb_rnd_sys_get_tmp_bytes(TbRenderSystem *self) {
+  return self->tmp_bytes_last_frame;
+}
+
 VkResult tb_rnd_sys_update_gpu_buffer(TbRenderSystem *self,
                                       const TbBuffer *buffer,
                                       const TbHostBuffer *host, void **ptr) {
@@ -710,6 +779,37 @@ VkResult tb_rnd_sys_update_gpu_buffer(TbRenderSystem *self,
   return err;
 }
 
+VkResult tb_rnd_sys_update_gpu_buffer_range(TbRenderSystem *self,
+                                            const TbBuffer *buffer,
+                                            const TbHostBuffer *host,
+                                            uint64_t offset, uint64_t size,
+                                            void **ptr) {
+  VkResult err = VK_SUCCESS;
+  if (buffer->info.size == 0 || size == 0) {
+    return err;
+  }
+  TB_CHECK_RETURN(offset + size <= buffer->info.size,
+                  "Update range out of bounds", VK_ERROR_UNKNOWN);
+
+  if (!try_map(self->vma_alloc, buffer->alloc, ptr)) {
+    // Only schedule an upload for the range that changed
+    TbBufferCopy upload = {
+        .src = host->buffer,
+        .dst = buffer->buffer,
+        .region =
+            {
+                .srcOffset = host->offset + offset,
+                .dstOffset = offset,
+                .size = size,
+            },
+    };
+    tb_rnd_upload_buffers(self, &upload, 1);
+
+    *ptr = host->info.pMappedData;
+  }
+  return err;
+}
+
 VkResult tb_rnd_sys_update_gpu_buffer_tmp(TbRenderSystem *self,
                                           const TbBuffer *buffer, void *data,
                                           size_t size, size_t alignment) {
@@ -870,6 +970,37 @@ void tb_rnd_upload_buffer_to_image(TbRenderSystem *self,
   }
 }
 
+uint64_t tb_rnd_upload_buffers_async(TbRenderSystem *self,
+                                     TbBufferCopy *uploads,
+                                     uint32_t upload_count) {
+  TbRenderSystemFrameState *state = &self->frame_states[self->frame_idx];
+  for (uint32_t i = 0; i < upload_count; ++i) {
+    TB_QUEUE_PUSH(state->async_buf_copy_queue, uploads[i])
+  }
+  return state->upload_value;
+}
+
+uint64_t tb_rnd_upload_buffer_to_image_async(TbRenderSystem *self,
+                                             TbBufferImageCopy *uploads,
+                                             uint32_t upload_count) {
+  TbRenderSystemFrameState *state = &self->frame_states[self->frame_idx];
+  for (uint32_t i = 0; i < upload_count; ++i) {
+    TB_QUEUE_PUSH(state->async_buf_img_copy_queue, uploads[i])
+  }
+  return state->upload_value;
+}
+
+bool tb_rnd_is_upload_complete(TbRenderSystem *self, uint64_t value) {
+  if (value == 0) {
+    return true;
+  }
+  tb_auto thread = self->render_thread;
+  uint64_t signaled = 0;
+  vkGetSemaphoreCounterValue(thread->device, thread->upload_timeline,
+                             &signaled);
+  return tb_is_upload_value_complete(signaled, value);
+}
+
 void tb_rnd_free_gpu_buffer(TbRenderSystem *self, TbBuffer *buffer) {
   vmaDestroyBuffer(self->vma_alloc, buffer->buffer, buffer->alloc);
 }
@@ -878,11 +1009,67 @@ void tb_rnd_free_gpu_image(TbRenderSystem *self, TbImage *image) {
   vmaDestroyImage(self->vma_alloc, image->image, image->alloc);
 }
 
+void tb_rnd_free_gpu_buffer_deferred(TbRenderSystem *self,
+                                     const TbBuffer *buffer) {
+  if (buffer->buffer == VK_NULL_HANDLE) {
+    return;
+  }
+  TbGpuFree gpu_free = {
+      .type = TB_GPU_FREE_BUFFER,
+      .buffer = buffer->buffer,
+      .alloc = buffer->alloc,
+  };
+  TB_QUEUE_PUSH(self->frame_states[self->frame_idx].free_queue, gpu_free);
+}
+
+void tb_rnd_free_host_buffer_deferred(TbRenderSystem *self,
+                                      const TbHostBuffer *buffer) {
+  if (buffer->buffer == VK_NULL_HANDLE) {
+    return;
+  }
+  TbGpuFree gpu_free = {
+      .type = TB_GPU_FREE_BUFFER,
+      .buffer = buffer->buffer,
+      .alloc = buffer->alloc,
+  };
+  TB_QUEUE_PUSH(self->frame_states[self->frame_idx].free_queue, gpu_free);
+}
+
+void tb_rnd_free_gpu_image_deferred(TbRenderSystem *self,
+                                    const TbImage *image) {
+  if (image->image == VK_NULL_HANDLE) {
+    return;
+  }
+  TbGpuFree gpu_free = {
+      .type = TB_GPU_FREE_IMAGE,
+      .image = image->image,
+      .alloc = image->alloc,
+  };
+  TB_QUEUE_PUSH(self->frame_states[self->frame_idx].free_queue, gpu_free);
+}
+
+void tb_rnd_destroy_image_view_deferred(TbRenderSystem *self,
+                                        VkImageView view) {
+  if (view == VK_NULL_HANDLE) {
+    return;
+  }
+  TbGpuFree gpu_free = {
+      .type = TB_GPU_FREE_IMAGE_VIEW,
+      .view = view,
+  };
+  TB_QUEUE_PUSH(self->frame_states[self->frame_idx].free_queue, gpu_free);
+}
+
 void tb_rnd_destroy_image_view(TbRenderSystem *self, VkImageView view) {
   vkDestroyImageView(self->render_thread->device, view,
                      &self->vk_host_alloc_cb);
 }
 
+void tb_rnd_destroy_buffer_view(TbRenderSystem *self, VkBufferView view) {
+  vkDestroyBufferView(self->render_thread->device, view,
+                      &self->vk_host_alloc_cb);
+}
+
 void tb_rnd_destroy_sampler(TbRenderSystem *self, VkSampler sampler) {
   vkDestroySampler(self->render_thread->device, sampler,
                    &self->vk_host_alloc_cb);
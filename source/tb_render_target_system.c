@@ -26,24 +26,33 @@ typedef struct RenderTargetLayerViews {
 
 typedef struct TbRenderTarget {
   bool imported;
+  bool transient;
   VkFormat format;
   TbImage images[TB_MAX_FRAME_STATES];
   VkImageView views[TB_MAX_FRAME_STATES];
   uint32_t layer_count;
   uint32_t mip_count;
   RenderTargetLayerViews layer_views[TB_MAX_LAYERS];
+
+  // Kept around so transient targets can be re-created when aliased
+  TbRenderTargetDescriptor desc;
+  uint32_t first_use;
+  uint32_t last_use;
+  TbRenderTargetId alias_prev;
 } TbRenderTarget;
 
-bool create_render_target(TbRenderTargetSystem *self, TbRenderTarget *rt,
-                          const TbRenderTargetDescriptor *desc) {
-  VkResult err = VK_SUCCESS;
+VkImageAspectFlagBits get_rt_aspect(VkFormat format) {
+  if (format == VK_FORMAT_D32_SFLOAT) {
+    return VK_IMAGE_ASPECT_DEPTH_BIT;
+  }
+  return VK_IMAGE_ASPECT_COLOR_BIT;
+}
 
+VkImageCreateInfo get_rt_image_info(const TbRenderTargetDescriptor *desc) {
   VkImageUsageFlagBits usage =
       VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
-  VkImageAspectFlagBits aspect = VK_IMAGE_ASPECT_COLOR_BIT;
   if (desc->format == VK_FORMAT_D32_SFLOAT) {
     usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-    aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
   }
 
   // Must set a special flag if we want to make a cubemap
@@ -53,68 +62,94 @@ bool create_render_target(TbRenderTargetSystem *self, TbRenderTarget *rt,
     create_flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
   }
 
-  // Store the render target's format so we can look it up later
-  TB_CHECK_RETURN(desc->format != VK_FORMAT_UNDEFINED,
-                  "Undefined render target format", false);
-  rt->format = desc->format;
-
   // Determine image type based on view type
   VkImageType image_type = VK_IMAGE_TYPE_2D;
   if (desc->view_type == VK_IMAGE_VIEW_TYPE_1D) {
     image_type = VK_IMAGE_TYPE_1D;
   }
 
-  // Allocate images for each frame
-  {
-    for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
-      VkImageCreateInfo create_info = {
-          .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-          .flags = create_flags,
-          .imageType = image_type,
-          .format = desc->format,
-          .extent = desc->extent,
-          .mipLevels = desc->mip_count,
-          .arrayLayers = desc->layer_count,
-          .samples = VK_SAMPLE_COUNT_1_BIT,
-          .usage = usage | VK_IMAGE_USAGE_SAMPLED_BIT,
-      };
-      VmaAllocationCreateFlags flags =
-          VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
-      err = tb_rnd_sys_alloc_gpu_image(self->rnd_sys, &create_info, flags,
-                                       desc->name, &rt->images[i]);
-      TB_VK_CHECK_RET(err, "Failed to allocate image for render target", false);
+  return (VkImageCreateInfo){
+      .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .flags = create_flags,
+      .imageType = image_type,
+      .format = desc->format,
+      .extent = desc->extent,
+      .mipLevels = desc->mip_count,
+      .arrayLayers = desc->layer_count,
+      .samples = VK_SAMPLE_COUNT_1_BIT,
+      .usage = usage | VK_IMAGE_USAGE_SAMPLED_BIT,
+  };
+}
 
-      rt->images[i].layout = VK_IMAGE_LAYOUT_UNDEFINED;
-    }
+bool create_render_target_views(TbRenderTargetSystem *self, TbRenderTarget *rt,
+                                const TbRenderTargetDescriptor *desc) {
+  VkResult err = VK_SUCCESS;
+  VkImageAspectFlagBits aspect = get_rt_aspect(desc->format);
 
-    for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
-      char view_name[100] = {0};
-      SDL_snprintf(view_name, 100, "%s TbView", desc->name); // NOLINT
-
-      VkImageViewCreateInfo create_info = {
-          .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-          .viewType = desc->view_type,
-          .format = desc->format,
-          .image = rt->images[i].image,
-          .subresourceRange = {aspect, 0, desc->mip_count, 0,
-                               desc->layer_count},
-      };
-      err = tb_rnd_create_image_view(self->rnd_sys, &create_info, view_name,
-                                     &rt->views[i]);
-      TB_VK_CHECK_RET(err, "Failed to create image view for render target",
-                      false);
-    }
+  for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
+    char view_name[100] = {0};
+    SDL_snprintf(view_name, 100, "%s TbView", desc->name); // NOLINT
+
+    VkImageViewCreateInfo create_info = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .viewType = desc->view_type,
+        .format = desc->format,
+        .image = rt->images[i].image,
+        .subresourceRange = {aspect, 0, desc->mip_count, 0, desc->layer_count},
+    };
+    err = tb_rnd_create_image_view(self->rnd_sys, &create_info, view_name,
+                                   &rt->views[i]);
+    TB_VK_CHECK_RET(err, "Failed to create image view for render target",
+                    false);
+    self->view_count++;
+  }
+
+  // Create views for each layer and each mip and each frame
 
-    // Create views for each layer and each mip and each frame
+  rt->mip_count = desc->mip_count;
 
-    rt->mip_count = desc->mip_count;
+  // Handle cubemaps which don't want a view per layer
+  if (desc->view_type == VK_IMAGE_VIEW_TYPE_CUBE) {
+    rt->layer_count = 1;
 
-    // Handle cubemaps which don't want a view per layer
-    if (desc->view_type == VK_IMAGE_VIEW_TYPE_CUBE) {
-      rt->layer_count = 1;
+    for (uint32_t mip_idx = 0; mip_idx < rt->mip_count; ++mip_idx) {
+      RenderTargetMipView *mip_view = &rt->layer_views[0].mip_views[mip_idx];
 
+      float mip_idxf = (float)mip_idx;
+
+      mip_view->extent.width =
+          (uint32_t)((float)desc->extent.width * SDL_powf(0.5f, mip_idxf));
+      mip_view->extent.height =
+          (uint32_t)((float)desc->extent.height * SDL_powf(0.5f, mip_idxf));
+      mip_view->extent.depth = desc->extent.depth;
+
+      for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
+        char view_name[100] = {0};
+        // NOLINTNEXTLINE
+        SDL_snprintf(view_name, 100, "%s Mip %d TbView", desc->name, mip_idx);
+
+        VkImageViewCreateInfo create_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .viewType = desc->view_type,
+            .format = desc->format,
+            .image = rt->images[i].image,
+            .subresourceRange = {aspect, mip_idx, 1, 0, desc->layer_count},
+        };
+        err = tb_rnd_create_image_view(self->rnd_sys, &create_info, view_name,
+                                       &mip_view->views[i]);
+        TB_VK_CHECK_RET(err, "Failed to create image view for render target",
+                        false);
+        self->view_count++;
+      }
+    }
+
+  } else {
+    rt->layer_count = desc->layer_count;
+
+    for (uint32_t layer = 0; layer < rt->layer_count; ++layer) {
+      RenderTargetLayerViews *layer_view = &rt->layer_views[layer];
       for (uint32_t mip_idx = 0; mip_idx < rt->mip_count; ++mip_idx) {
-        RenderTargetMipView *mip_view = &rt->layer_views[0].mip_views[mip_idx];
+        RenderTargetMipView *mip_view = &layer_view->mip_views[mip_idx];
 
         float mip_idxf = (float)mip_idx;
 
@@ -127,61 +162,66 @@ bool create_render_target(TbRenderTargetSystem *self, TbRenderTarget *rt,
         for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
           char view_name[100] = {0};
           // NOLINTNEXTLINE
-          SDL_snprintf(view_name, 100, "%s Mip %d TbView", desc->name, mip_idx);
+          SDL_snprintf(view_name, 100, "%s Layer %d Mip %d TbView", desc->name,
+                       layer, mip_idx);
 
           VkImageViewCreateInfo create_info = {
               .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
               .viewType = desc->view_type,
               .format = desc->format,
               .image = rt->images[i].image,
-              .subresourceRange = {aspect, mip_idx, 1, 0, desc->layer_count},
+              .subresourceRange = {aspect, mip_idx, 1, layer, 1},
           };
-          err = tb_rnd_create_image_view(self->rnd_sys, &create_info, view_name,
-                                         &mip_view->views[i]);
+          err = tb_rnd_create_image_view(self->rnd_sys, &create_info,
+                                         view_name, &mip_view->views[i]);
           TB_VK_CHECK_RET(err, "Failed to create image view for render target",
                           false);
+          self->view_count++;
         }
       }
+    }
+  }
+  return true;
+}
 
-    } else {
-      rt->layer_count = desc->layer_count;
+void destroy_render_target_views(TbRenderTargetSystem *self,
+                                 TbRenderTarget *rt) {
+  for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
+    tb_rnd_destroy_image_view(self->rnd_sys, rt->views[i]);
+    self->view_count--;
+    for (uint32_t layer = 0; layer < rt->layer_count; ++layer) {
+      for (uint32_t mip_idx = 0; mip_idx < rt->mip_count; ++mip_idx) {
+        tb_rnd_destroy_image_view(
+            self->rnd_sys, rt->layer_views[layer].mip_views[mip_idx].views[i]);
+        self->view_count--;
+      }
+    }
+  }
+}
 
-      for (uint32_t layer = 0; layer < rt->layer_count; ++layer) {
-        RenderTargetLayerViews *layer_view = &rt->layer_views[layer];
-        for (uint32_t mip_idx = 0; mip_idx < rt->mip_count; ++mip_idx) {
-          RenderTargetMipView *mip_view = &layer_view->mip_views[mip_idx];
+bool create_render_target(TbRenderTargetSystem *self, TbRenderTarget *rt,
+                          const TbRenderTargetDescriptor *desc) {
+  VkResult err = VK_SUCCESS;
 
-          float mip_idxf = (float)mip_idx;
+  // Store the render target's format so we can look it up later
+  TB_CHECK_RETURN(desc->format != VK_FORMAT_UNDEFINED,
+                  "Undefined render target format", false);
+  rt->format = desc->format;
+  rt->desc = *desc;
 
-          mip_view->extent.width =
-              (uint32_t)((float)desc->extent.width * SDL_powf(0.5f, mip_idxf));
-          mip_view->extent.height =
-              (uint32_t)((float)desc->extent.height * SDL_powf(0.5f, mip_idxf));
-          mip_view->extent.depth = desc->extent.depth;
+  // Allocate images for each frame
+  // Transient targets start out dedicated until they get aliased
+  VkImageCreateInfo create_info = get_rt_image_info(desc);
+  for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
+    VmaAllocationCreateFlags flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    err = tb_rnd_sys_alloc_gpu_image(self->rnd_sys, &create_info, flags,
+                                     desc->name, &rt->images[i]);
+    TB_VK_CHECK_RET(err, "Failed to allocate image for render target", false);
 
-          for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
-            char view_name[100] = {0};
-            // NOLINTNEXTLINE
-            SDL_snprintf(view_name, 100, "%s Layer %d Mip %d TbView",
-                         desc->name, layer, mip_idx);
-
-            VkImageViewCreateInfo create_info = {
-                .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-                .viewType = desc->view_type,
-                .format = desc->format,
-                .image = rt->images[i].image,
-                .subresourceRange = {aspect, mip_idx, 1, layer, 1},
-            };
-            err = tb_rnd_create_image_view(self->rnd_sys, &create_info,
-                                           view_name, &mip_view->views[i]);
-            TB_VK_CHECK_RET(
-                err, "Failed to create image view for render target", false);
-          }
-        }
-      }
-    }
+    rt->images[i].layout = VK_IMAGE_LAYOUT_UNDEFINED;
   }
-  return true;
+
+  return create_render_target_views(self, rt, desc);
 }
 
 void resize_render_target(TbRenderTargetSystem *self,
@@ -190,16 +230,8 @@ void resize_render_target(TbRenderTargetSystem *self,
   // Clean up old images and views
   for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
     tb_rnd_free_gpu_image(self->rnd_sys, &render_target->images[i]);
-    tb_rnd_destroy_image_view(self->rnd_sys, render_target->views[i]);
-    for (uint32_t layer = 0; layer < render_target->layer_count; ++layer) {
-      for (uint32_t mip_idx = 0; mip_idx < render_target->mip_count;
-           ++mip_idx) {
-        tb_rnd_destroy_image_view(
-            self->rnd_sys,
-            render_target->layer_views[layer].mip_views[mip_idx].views[i]);
-      }
-    }
   }
+  destroy_render_target_views(self, render_target);
 
   // Re-create render target
   create_render_target(self, render_target, desc);
@@ -259,6 +291,7 @@ TbRenderTargetSystem create_render_target_system(TbRenderSystem *rnd_sys,
   };
 
   TB_DYN_ARR_RESET(sys.render_targets, sys.gp_alloc, 8);
+  TB_DYN_ARR_RESET(sys.transient_blocks, sys.gp_alloc, 8);
 
   // Create some default render targets
   {
@@ -299,6 +332,7 @@ TbRenderTargetSystem create_render_target_system(TbRenderSystem *rnd_sys,
           .mip_count = 1,
           .layer_count = 1,
           .view_type = VK_IMAGE_VIEW_TYPE_2D,
+          .transient = true,
       };
       sys.normal_buffer = tb_create_render_target(&sys, &rt_desc);
     }
@@ -316,9 +350,28 @@ TbRenderTargetSystem create_render_target_system(TbRenderSystem *rnd_sys,
           .mip_count = 1,
           .layer_count = 1,
           .view_type = VK_IMAGE_VIEW_TYPE_2D,
+          .transient = true,
       };
       sys.hdr_color = tb_create_render_target(&sys, &rt_desc);
     }
+    // Create upscaled color target
+    {
+      TbRenderTargetDescriptor rt_desc = {
+          .name = "Upscaled Color",
+          .format = VK_FORMAT_B10G11R11_UFLOAT_PACK32,
+          .extent =
+              {
+                  .width = width,
+                  .height = height,
+                  .depth = 1,
+              },
+          .mip_count = 1,
+          .layer_count = 1,
+          .view_type = VK_IMAGE_VIEW_TYPE_2D,
+          .transient = true,
+      };
+      sys.upscaled_color = tb_create_render_target(&sys, &rt_desc);
+    }
 
     // Create depth copy target which has a different format
     {
@@ -334,6 +387,7 @@ TbRenderTargetSystem create_render_target_system(TbRenderSystem *rnd_sys,
           .mip_count = 1,
           .layer_count = 1,
           .view_type = VK_IMAGE_VIEW_TYPE_2D,
+          .transient = true,
       };
       sys.depth_buffer_copy = tb_create_render_target(&sys, &rt_desc);
     }
@@ -352,6 +406,7 @@ TbRenderTargetSystem create_render_target_system(TbRenderSystem *rnd_sys,
           .mip_count = 1,
           .layer_count = 1,
           .view_type = VK_IMAGE_VIEW_TYPE_2D,
+          .transient = true,
       };
       sys.color_copy = tb_create_render_target(&sys, &rt_desc);
     }
@@ -443,6 +498,7 @@ TbRenderTargetSystem create_render_target_system(TbRenderSystem *rnd_sys,
           .mip_count = 1,
           .layer_count = 1,
           .view_type = VK_IMAGE_VIEW_TYPE_2D,
+          .transient = true,
       };
       sys.brightness = tb_create_render_target(&sys, &rt_desc);
     }
@@ -464,6 +520,7 @@ TbRenderTargetSystem create_render_target_system(TbRenderSystem *rnd_sys,
           .mip_count = TB_BLOOM_MIPS,
           .layer_count = 1,
           .view_type = VK_IMAGE_VIEW_TYPE_2D,
+          .transient = true,
       };
       sys.bloom_mip_chain = tb_create_render_target(&sys, &rt_desc);
     }
@@ -482,6 +539,7 @@ TbRenderTargetSystem create_render_target_system(TbRenderSystem *rnd_sys,
           .mip_count = 1,
           .layer_count = 1,
           .view_type = VK_IMAGE_VIEW_TYPE_2D,
+          .transient = true,
       };
       sys.ldr_target = tb_create_render_target(&sys, &rt_desc);
     }
@@ -536,6 +594,13 @@ void destroy_render_target_system(TbRenderTargetSystem *self) {
   }
   TB_DYN_ARR_DESTROY(self->render_targets);
 
+  // Only free aliased memory once nothing is bound to it
+  TB_DYN_ARR_FOREACH(self->transient_blocks, i) {
+    vmaFreeMemory(self->rnd_sys->vma_alloc,
+                  TB_DYN_ARR_AT(self->transient_blocks, i));
+  }
+  TB_DYN_ARR_DESTROY(self->transient_blocks);
+
   *self = (TbRenderTargetSystem){0};
 }
 
@@ -617,6 +682,24 @@ void tb_reimport_swapchain(TbRenderTargetSystem *self) {
     resize_render_target(
         self, &TB_DYN_ARR_AT(self->render_targets, self->hdr_color), &rt_desc);
   }
+  {
+    TbRenderTargetDescriptor rt_desc = {
+        .name = "Upscaled Color",
+        .format = VK_FORMAT_B10G11R11_UFLOAT_PACK32,
+        .extent =
+            {
+                .width = width,
+                .height = height,
+                .depth = 1,
+            },
+        .mip_count = 1,
+        .layer_count = 1,
+        .view_type = VK_IMAGE_VIEW_TYPE_2D,
+    };
+    resize_render_target(
+        self, &TB_DYN_ARR_AT(self->render_targets, self->upscaled_color),
+        &rt_desc);
+  }
   {
     TbRenderTargetDescriptor rt_desc = {
         .name = "Depth Copy",
@@ -732,11 +815,17 @@ void tb_reimport_swapchain(TbRenderTargetSystem *self) {
     }
     reimport_render_target(self, self->swapchain, &rt_desc, images);
   }
+
+  // Resizing gave transient targets dedicated memory again
+  tb_alias_transient_targets(self);
 }
 
 TbRenderTargetId alloc_render_target(TbRenderTargetSystem *self) {
   TbRenderTargetId id = TB_DYN_ARR_SIZE(self->render_targets);
-  TbRenderTarget rt = {0};
+  TbRenderTarget rt = {
+      .first_use = SDL_MAX_UINT32,
+      .alias_prev = TbInvalidRenderTargetId,
+  };
   TB_DYN_ARR_APPEND(self->render_targets, rt);
   return id;
 }
@@ -802,6 +891,7 @@ tb_create_render_target(TbRenderTargetSystem *self,
 
   TbRenderTargetId id = alloc_render_target(self);
   TbRenderTarget *rt = &TB_DYN_ARR_AT(self->render_targets, id);
+  rt->transient = rt_desc->transient;
   bool ok = create_render_target(self, rt, rt_desc);
   TB_CHECK_RETURN(ok, "Failed to create render target",
                   TbInvalidRenderTargetId);
@@ -869,3 +959,220 @@ VkImage tb_render_target_get_image(TbRenderTargetSystem *self,
                   "Render target index out of range", VK_NULL_HANDLE);
   return TB_DYN_ARR_AT(self->render_targets, rt).images[frame_idx].image;
 }
+
+uint32_t tb_render_target_get_layer_count(TbRenderTargetSystem *self,
+                                          TbRenderTargetId rt) {
+  TB_CHECK_RETURN(rt < TB_DYN_ARR_SIZE(self->render_targets),
+                  "Render target index out of range", 0xFFFFFFFF);
+  return TB_DYN_ARR_AT(self->render_targets, rt).layer_count;
+}
+
+bool tb_render_target_is_imported(TbRenderTargetSystem *self,
+                                  TbRenderTargetId rt) {
+  TB_CHECK_RETURN(rt < TB_DYN_ARR_SIZE(self->render_targets),
+                  "Render target index out of range", false);
+  return TB_DYN_ARR_AT(self->render_targets, rt).imported;
+}
+
+bool tb_render_target_is_transient(TbRenderTargetSystem *self,
+                                   TbRenderTargetId rt) {
+  TB_CHECK_RETURN(rt < TB_DYN_ARR_SIZE(self->render_targets),
+                  "Render target index out of range", false);
+  return TB_DYN_ARR_AT(self->render_targets, rt).transient;
+}
+
+void tb_resize_render_target(TbRenderTargetSystem *self, TbRenderTargetId rt,
+                             VkExtent3D extent) {
+  TB_CHECK(rt < TB_DYN_ARR_SIZE(self->render_targets),
+           "Render target index out of range");
+  tb_auto target = &TB_DYN_ARR_AT(self->render_targets, rt);
+  TB_CHECK(!target->imported && !target->transient,
+           "Only persistent targets can be resized on their own");
+  TbRenderTargetDescriptor desc = target->desc;
+  desc.extent = extent;
+#ifndef TB_FINAL
+  // Every image and view is replaced like for like so no number of resizes
+  // may change how many are alive
+  VmaTotalStatistics before = {0};
+  vmaCalculateStatistics(self->rnd_sys->vma_alloc, &before);
+  const uint32_t view_count = self->view_count;
+#endif
+  resize_render_target(self, target, &desc);
+#ifndef TB_FINAL
+  VmaTotalStatistics after = {0};
+  vmaCalculateStatistics(self->rnd_sys->vma_alloc, &after);
+  TB_CHECK(after.total.statistics.allocationCount ==
+               before.total.statistics.allocationCount,
+           "Resizing a render target changed the allocation count");
+  TB_CHECK(self->view_count == view_count,
+           "Resizing a render target changed the view count");
+#endif
+}
+
+void tb_render_target_set_lifetime(TbRenderTargetSystem *self,
+                                   TbRenderTargetId rt, uint32_t first_use,
+                                   uint32_t last_use) {
+  TB_CHECK(rt < TB_DYN_ARR_SIZE(self->render_targets),
+           "Render target index out of range");
+  tb_auto target = &TB_DYN_ARR_AT(self->render_targets, rt);
+  target->first_use = first_use;
+  target->last_use = last_use;
+}
+
+TbRenderTargetId tb_render_target_get_alias_prev(TbRenderTargetSystem *self,
+                                                 TbRenderTargetId rt) {
+  TB_CHECK_RETURN(rt < TB_DYN_ARR_SIZE(self->render_targets),
+                  "Render target index out of range", TbInvalidRenderTargetId);
+  return TB_DYN_ARR_AT(self->render_targets, rt).alias_prev;
+}
+
+static bool rt_is_used(const TbRenderTarget *rt) {
+  return rt->first_use <= rt->last_use;
+}
+
+// Unused targets overlap nothing so they can hide in any block
+static bool rt_lifetimes_overlap(const TbRenderTarget *a,
+                                 const TbRenderTarget *b) {
+  if (!rt_is_used(a) || !rt_is_used(b)) {
+    return false;
+  }
+  return a->first_use <= b->last_use && b->first_use <= a->last_use;
+}
+
+void tb_alias_transient_targets(TbRenderTargetSystem *self) {
+  TB_TRACY_SCOPE("Alias Transient Targets");
+  VkResult err = VK_SUCCESS;
+  tb_auto vma_alloc = self->rnd_sys->vma_alloc;
+  tb_auto device = self->rnd_sys->render_thread->device;
+  const uint32_t rt_count = TB_DYN_ARR_SIZE(self->render_targets);
+
+  tb_auto targets = tb_alloc_nm_tp(self->tmp_alloc, rt_count, TbRenderTargetId);
+  tb_auto reqs =
+      tb_alloc_nm_tp(self->tmp_alloc, rt_count, VkMemoryRequirements);
+  tb_auto block_of = tb_alloc_nm_tp(self->tmp_alloc, rt_count, uint32_t);
+  uint32_t target_count = 0;
+  self->transient_bytes = 0;
+  TB_DYN_ARR_FOREACH(self->render_targets, rt_idx) {
+    tb_auto rt = &TB_DYN_ARR_AT(self->render_targets, rt_idx);
+    if (!rt->transient) {
+      continue;
+    }
+    // Every frame's image is created the same way so one query covers all
+    vkGetImageMemoryRequirements(device, rt->images[0].image, &reqs[rt_idx]);
+    self->transient_bytes += reqs[rt_idx].size;
+
+    // Keep targets sorted largest first so big targets claim blocks and
+    // smaller targets fill in behind them
+    uint32_t insert = target_count++;
+    while (insert > 0 && reqs[targets[insert - 1]].size < reqs[rt_idx].size) {
+      targets[insert] = targets[insert - 1];
+      insert--;
+    }
+    targets[insert] = (TbRenderTargetId)rt_idx;
+  }
+
+  // Greedily place each target in the first block whose members it never
+  // overlaps with
+  tb_auto blocks =
+      tb_alloc_nm_tp(self->tmp_alloc, target_count + 1, VkMemoryRequirements);
+  uint32_t block_count = 0;
+  for (uint32_t i = 0; i < target_count; ++i) {
+    const TbRenderTargetId id = targets[i];
+    tb_auto rt = &TB_DYN_ARR_AT(self->render_targets, id);
+    tb_auto req = &reqs[id];
+
+    uint32_t block = block_count;
+    for (uint32_t b = 0; b < block_count && block == block_count; ++b) {
+      if ((blocks[b].memoryTypeBits & req->memoryTypeBits) == 0) {
+        continue;
+      }
+      bool overlaps = false;
+      for (uint32_t j = 0; j < i && !overlaps; ++j) {
+        tb_auto other = &TB_DYN_ARR_AT(self->render_targets, targets[j]);
+        overlaps = block_of[targets[j]] == b && rt_lifetimes_overlap(rt, other);
+      }
+      if (!overlaps) {
+        block = b;
+      }
+    }
+
+    if (block == block_count) {
+      blocks[block_count++] = *req;
+    } else {
+      blocks[block].size = SDL_max(blocks[block].size, req->size);
+      blocks[block].alignment =
+          SDL_max(blocks[block].alignment, req->alignment);
+      blocks[block].memoryTypeBits &= req->memoryTypeBits;
+    }
+    block_of[id] = block;
+  }
+
+  // Each target's first use must wait on whoever last used the block
+  for (uint32_t i = 0; i < target_count; ++i) {
+    tb_auto rt = &TB_DYN_ARR_AT(self->render_targets, targets[i]);
+    rt->alias_prev = TbInvalidRenderTargetId;
+    if (!rt_is_used(rt)) {
+      continue;
+    }
+    uint32_t prev_last = 0;
+    for (uint32_t j = 0; j < target_count; ++j) {
+      tb_auto other = &TB_DYN_ARR_AT(self->render_targets, targets[j]);
+      if (i == j || block_of[targets[j]] != block_of[targets[i]] ||
+          !rt_is_used(other) || other->last_use >= rt->first_use) {
+        continue;
+      }
+      if (rt->alias_prev == TbInvalidRenderTargetId ||
+          other->last_use > prev_last) {
+        rt->alias_prev = targets[j];
+        prev_last = other->last_use;
+      }
+    }
+  }
+
+  // Nothing may be bound to the old blocks by the time they're freed
+  for (uint32_t i = 0; i < target_count; ++i) {
+    tb_auto rt = &TB_DYN_ARR_AT(self->render_targets, targets[i]);
+    for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+      tb_rnd_free_gpu_image(self->rnd_sys, &rt->images[frame_idx]);
+    }
+    destroy_render_target_views(self, rt);
+  }
+  TB_DYN_ARR_FOREACH(self->transient_blocks, i) {
+    vmaFreeMemory(vma_alloc, TB_DYN_ARR_AT(self->transient_blocks, i));
+  }
+  TB_DYN_ARR_CLEAR(self->transient_blocks);
+
+  self->aliased_bytes = 0;
+  for (uint32_t b = 0; b < block_count; ++b) {
+    self->aliased_bytes += blocks[b].size;
+    for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+      VmaAllocationCreateInfo create_info = {
+          .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      };
+      VmaAllocation block = VK_NULL_HANDLE;
+      err = vmaAllocateMemory(vma_alloc, &blocks[b], &create_info, &block,
+                              NULL);
+      TB_VK_CHECK(err, "Failed to allocate transient target memory");
+      TB_DYN_ARR_APPEND(self->transient_blocks, block);
+    }
+  }
+
+  for (uint32_t i = 0; i < target_count; ++i) {
+    tb_auto rt = &TB_DYN_ARR_AT(self->render_targets, targets[i]);
+    VkImageCreateInfo create_info = get_rt_image_info(&rt->desc);
+    for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+      const uint32_t block_idx =
+          block_of[targets[i]] * TB_MAX_FRAME_STATES + frame_idx;
+      tb_auto image = &rt->images[frame_idx];
+      // The image doesn't own the block so the allocation is left null
+      *image = (TbImage){.layout = VK_IMAGE_LAYOUT_UNDEFINED};
+      err = vmaCreateAliasingImage(
+          vma_alloc, TB_DYN_ARR_AT(self->transient_blocks, block_idx),
+          &create_info, &image->image);
+      TB_VK_CHECK(err, "Failed to create aliased render target image");
+      SET_VK_NAME(device, image->image, VK_OBJECT_TYPE_IMAGE, rt->desc.name);
+    }
+    bool ok = create_render_target_views(self, rt, &rt->desc);
+    TB_CHECK(ok, "Failed to create aliased render target views");
+  }
+}
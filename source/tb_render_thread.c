@@ -8,8 +8,10 @@
 
 #include "tb_common.h"
 #include "tb_engine_config.h"
+#include "tb_frame_stats.h"
 #include "tb_log.h"
 #include "tb_sdl.h"
+#include "tb_task_scheduler.h"
 #include "tb_vk.h"
 #include "tb_vk_alloc.h"
 #include "tb_vk_dbg.h"
@@ -39,12 +41,63 @@ void tb_signal_render(TbRenderThread *thread, uint32_t frame_idx) {
   SDL_SignalSemaphore(thread->frame_states[frame_idx].wait_sem);
 }
 
+float timestamp_delta_ms(const TbRenderThread *thread, uint64_t begin,
+                         uint64_t end) {
+  const uint32_t valid_bits =
+      thread->queue_props[thread->graphics_queue_family_index]
+          .timestampValidBits;
+  // Masking the difference also handles the counter wrapping around
+  const uint64_t mask =
+      valid_bits >= 64 ? SDL_MAX_UINT64 : (((uint64_t)1 << valid_bits) - 1);
+  const double period = thread->gpu_props.properties.limits.timestampPeriod;
+  return (float)((double)((end - begin) & mask) * period / 1000000.0);
+}
+
+void read_gpu_time(TbRenderThread *thread, TbFrameState *state) {
+  if (!state->timestamps_written) {
+    return;
+  }
+  const uint32_t pass_count =
+      SDL_min(TB_DYN_ARR_SIZE(state->pass_contexts), TB_MAX_COMMAND_BUFFERS);
+  const uint32_t query_count = 2 + pass_count * 2;
+  uint64_t timestamps[TB_MAX_TIMESTAMPS] = {0};
+  // Never waits; the fence has already signaled so every query is available
+  VkResult err = vkGetQueryPoolResults(
+      thread->device, state->timestamp_pool, 0, query_count,
+      sizeof(uint64_t) * query_count, timestamps, sizeof(uint64_t),
+      VK_QUERY_RESULT_64_BIT);
+  if (err != VK_SUCCESS) {
+    return;
+  }
+  state->gpu_ms = timestamp_delta_ms(thread, timestamps[0], timestamps[1]);
+  for (uint32_t i = 0; i < pass_count; ++i) {
+    const uint64_t *pass_stamps = &timestamps[2 + i * 2];
+    state->pass_gpu_ms[i] =
+        timestamp_delta_ms(thread, pass_stamps[0], pass_stamps[1]);
+  }
+}
+
 void tb_wait_render(TbRenderThread *thread, uint32_t frame_idx) {
   TB_CHECK(frame_idx < TB_MAX_FRAME_STATES, "Invalid frame index");
-  SDL_WaitSemaphore(thread->frame_states[frame_idx].signal_sem);
+  tb_auto state = &thread->frame_states[frame_idx];
+  SDL_WaitSemaphore(state->signal_sem);
   TB_TRACY_SCOPEC("Wait for GPU", TracyCategoryColorWait);
-  vkWaitForFences(thread->device, 1, &thread->frame_states[frame_idx].fence,
-                  VK_TRUE, SDL_MAX_UINT64);
+  vkWaitForFences(thread->device, 1, &state->fence, VK_TRUE, SDL_MAX_UINT64);
+  // The fence guarantees this state's timestamps are available
+  read_gpu_time(thread, state);
+}
+
+void tb_wait_render_idle(TbRenderThread *thread, uint32_t frame_idx) {
+  TB_TRACY_SCOPEC("Wait for Render Idle", TracyCategoryColorWait);
+  for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
+    if (i == frame_idx) {
+      continue;
+    }
+    tb_wait_render(thread, i);
+    // Hand the frame state back so the main thread's regular wait on it
+    // doesn't block forever
+    SDL_SignalSemaphore(thread->frame_states[i].signal_sem);
+  }
 }
 
 void tb_wait_thread_initialized(TbRenderThread *thread) {
@@ -65,6 +118,9 @@ void tb_stop_render_thread(TbRenderThread *thread) {
 
   // Wait for the GPU to be done too
   vkQueueWaitIdle(thread->graphics_queue);
+  if (thread->transfer_queue != VK_NULL_HANDLE) {
+    vkQueueWaitIdle(thread->transfer_queue);
+  }
   if (thread->graphics_queue_family_index !=
       thread->present_queue_family_index) {
     vkQueueWaitIdle(thread->present_queue);
@@ -293,9 +349,29 @@ VkResult create_semaphore(VkDevice device,
   return err;
 }
 
+VkResult create_timeline_semaphore(VkDevice device,
+                                   const VkAllocationCallbacks *vk_alloc,
+                                   const char *name, VkSemaphore *sem) {
+  VkSemaphoreTypeCreateInfo type_info = {
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+      .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+      .initialValue = 0,
+  };
+  VkSemaphoreCreateInfo create_info = {
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+      .pNext = &type_info,
+  };
+  VkResult err = vkCreateSemaphore(device, &create_info, vk_alloc, sem);
+  TB_VK_CHECK_RET(err, "Failed to create timeline semaphore", err);
+  SET_VK_NAME(device, *sem, VK_OBJECT_TYPE_SEMAPHORE, name);
+  return err;
+}
+
 bool init_frame_states(VkPhysicalDevice gpu, VkDevice device,
                        const TbSwapchain *swapchain,
                        uint32_t graphics_queue_family_index,
+                       uint32_t transfer_queue_family_index,
+                       bool timestamps,
                        VmaAllocator vma_alloc,
                        const VkAllocationCallbacks *vk_alloc,
                        TbAllocator gp_alloc, TbFrameState *states) {
@@ -347,6 +423,43 @@ bool init_frame_states(VkPhysicalDevice gpu, VkDevice device,
       TB_VK_CHECK_RET(err, "Failed to create frame state command pool", false);
       SET_VK_NAME(device, state->command_pool, VK_OBJECT_TYPE_COMMAND_POOL,
                   "Frame State Command Pool");
+
+      // Pass buffers are reset a pool at a time by whichever thread records
+      // them
+      create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+      for (uint32_t pool_idx = 0; pool_idx < TB_MAX_COMMAND_BUFFERS;
+           ++pool_idx) {
+        err = vkCreateCommandPool(device, &create_info, vk_alloc,
+                                  &state->pass_command_pools[pool_idx]);
+        TB_VK_CHECK_RET(err, "Failed to create pass command pool", false);
+        SET_VK_NAME(device, state->pass_command_pools[pool_idx],
+                    VK_OBJECT_TYPE_COMMAND_POOL, "Pass Command Pool");
+      }
+    }
+
+    if (transfer_queue_family_index != 0xFFFFFFFF) {
+      VkCommandPoolCreateInfo create_info = {
+          .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+          .queueFamilyIndex = transfer_queue_family_index,
+          .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+      };
+      err = vkCreateCommandPool(device, &create_info, vk_alloc,
+                                &state->transfer_command_pool);
+      TB_VK_CHECK_RET(err, "Failed to create transfer command pool", false);
+      SET_VK_NAME(device, state->transfer_command_pool,
+                  VK_OBJECT_TYPE_COMMAND_POOL, "Transfer Command Pool");
+
+      VkCommandBufferAllocateInfo alloc_info = {
+          .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+          .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+          .commandBufferCount = 1,
+          .commandPool = state->transfer_command_pool,
+      };
+      err = vkAllocateCommandBuffers(device, &alloc_info,
+                                     &state->transfer_command_buffer);
+      TB_VK_CHECK_RET(err, "Failed to create transfer command buffer", false);
+      SET_VK_NAME(device, state->transfer_command_buffer,
+                  VK_OBJECT_TYPE_COMMAND_BUFFER, "Transfer Command Buffer");
     }
 
     {
@@ -395,6 +508,19 @@ bool init_frame_states(VkPhysicalDevice gpu, VkDevice device,
                   "Frame State Fence");
     }
 
+    if (timestamps) {
+      VkQueryPoolCreateInfo create_info = {
+          .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+          .queryType = VK_QUERY_TYPE_TIMESTAMP,
+          .queryCount = TB_MAX_TIMESTAMPS,
+      };
+      err = vkCreateQueryPool(device, &create_info, vk_alloc,
+                              &state->timestamp_pool);
+      TB_VK_CHECK_RET(err, "Failed to create timestamp query pool", false);
+      SET_VK_NAME(device, state->timestamp_pool, VK_OBJECT_TYPE_QUERY_POOL,
+                  "Frame State Timestamp Pool");
+    }
+
     {
       TracyCGPUContext *gpu_ctx = TracyCVkContextHostCalib(
           gpu, device, vkResetQueryPool,
@@ -461,12 +587,16 @@ void destroy_frame_states(VkDevice device, VmaAllocator vma_alloc,
 
     vkFreeCommandBuffers(device, state->command_pool, 2,
                          state->base_command_buffers);
-    if (state->pass_command_buffer_count) {
-      vkFreeCommandBuffers(device, state->command_pool,
-                           state->pass_command_buffer_count,
-                           state->pass_command_buffers);
-    }
     vkDestroyCommandPool(device, state->command_pool, vk_alloc);
+    // Destroying the pools frees the pass command buffers with them
+    for (uint32_t pool_idx = 0; pool_idx < TB_MAX_COMMAND_BUFFERS;
+         ++pool_idx) {
+      vkDestroyCommandPool(device, state->pass_command_pools[pool_idx],
+                           vk_alloc);
+    }
+    if (state->transfer_command_pool != VK_NULL_HANDLE) {
+      vkDestroyCommandPool(device, state->transfer_command_pool, vk_alloc);
+    }
 
     TracyCVkContextDestroy(state->tracy_gpu_context);
 
@@ -480,6 +610,9 @@ void destroy_frame_states(VkDevice device, VmaAllocator vma_alloc,
     vkDestroySemaphore(device, state->frame_complete_sem, vk_alloc);
 
     vkDestroyFence(device, state->fence, vk_alloc);
+    if (state->timestamp_pool != VK_NULL_HANDLE) {
+      vkDestroyQueryPool(device, state->timestamp_pool, vk_alloc);
+    }
 
     vmaDestroyBuffer(vma_alloc, state->tmp_gpu_buffer, state->tmp_gpu_alloc);
 
@@ -583,9 +716,11 @@ bool find_queue_families(TbAllocator tmp_alloc, VkPhysicalDevice gpu,
                          VkSurfaceKHR surface, uint32_t queue_family_count,
                          const VkQueueFamilyProperties *queue_props,
                          uint32_t *present_queue_family_index,
-                         uint32_t *graphics_queue_family_index) {
+                         uint32_t *graphics_queue_family_index,
+                         uint32_t *transfer_queue_family_index) {
   uint32_t graphics_idx = 0xFFFFFFFF;
   uint32_t present_idx = 0xFFFFFFFF;
+  uint32_t transfer_idx = 0xFFFFFFFF;
   {
     // Iterate over each queue to learn whether it supports presenting:
     VkBool32 *supports_present =
@@ -625,9 +760,23 @@ bool find_queue_families(TbAllocator tmp_alloc, VkPhysicalDevice gpu,
     // Generate error if could not find both a graphics and a present queue
     TB_CHECK_RETURN(graphics_idx != 0xFFFFFFFF && present_idx != 0xFFFFFFFF,
                     "Invalid queue family indices", false);
+
+    // Uploads get their own queue if there is a family without graphics
+    // support. Prefer a pure copy engine over an async compute family
+    for (uint32_t i = 0; i < queue_family_count; ++i) {
+      VkQueueFlags flags = queue_props[i].queueFlags;
+      if ((flags & VK_QUEUE_TRANSFER_BIT) == 0 ||
+          (flags & VK_QUEUE_GRAPHICS_BIT) != 0) {
+        continue;
+      }
+      if (transfer_idx == 0xFFFFFFFF || (flags & VK_QUEUE_COMPUTE_BIT) == 0) {
+        transfer_idx = i;
+      }
+    }
   }
   *present_queue_family_index = present_idx;
   *graphics_queue_family_index = graphics_idx;
+  *transfer_queue_family_index = transfer_idx;
   return true;
 }
 
@@ -676,7 +825,8 @@ bool optional_device_ext(const char **out_ext_names, uint32_t *out_ext_count,
 }
 
 bool init_device(VkPhysicalDevice gpu, uint32_t graphics_queue_family_index,
-                 uint32_t present_queue_family_index, TbAllocator tmp_alloc,
+                 uint32_t present_queue_family_index,
+                 uint32_t transfer_queue_family_index, TbAllocator tmp_alloc,
                  const VkAllocationCallbacks *vk_alloc,
                  TbRenderExtensionSupport *ext_support, VkDevice *device) {
   TB_TRACY_SCOPE("Initialize Vulkan Device");
@@ -796,6 +946,7 @@ bool init_device(VkPhysicalDevice gpu, uint32_t graphics_queue_family_index,
       .shaderStorageBufferArrayNonUniformIndexing = VK_TRUE,
       .shaderStorageTexelBufferArrayNonUniformIndexing = VK_TRUE,
       .drawIndirectCount = VK_TRUE,
+      .timelineSemaphore = VK_TRUE,
   };
 
   VkPhysicalDeviceVulkan11Features vk_11_features = {
@@ -816,12 +967,13 @@ bool init_device(VkPhysicalDevice gpu, uint32_t graphics_queue_family_index,
       .vertexPipelineStoresAndAtomics = VK_TRUE,
       .fragmentStoresAndAtomics = VK_TRUE,
       .multiDrawIndirect = VK_TRUE,
+      .drawIndirectFirstInstance = VK_TRUE,
       .shaderImageGatherExtended = VK_TRUE,
   };
 
   float queue_priorities[1] = {0.0};
   uint32_t queue_count = 1;
-  VkDeviceQueueCreateInfo queues[2] = {{0}, {0}};
+  VkDeviceQueueCreateInfo queues[3] = {{0}, {0}, {0}};
   queues[0] = (VkDeviceQueueCreateInfo){
       .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
       .pNext = NULL,
@@ -841,6 +993,16 @@ bool init_device(VkPhysicalDevice gpu, uint32_t graphics_queue_family_index,
     };
     queue_count++;
   }
+  if (transfer_queue_family_index != 0xFFFFFFFF) {
+    queues[queue_count++] = (VkDeviceQueueCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .pNext = NULL,
+        .queueFamilyIndex = transfer_queue_family_index,
+        .queueCount = 1,
+        .pQueuePriorities = queue_priorities,
+        .flags = 0,
+    };
+  }
   VkDeviceCreateInfo create_info = {
       .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
       .pNext = (const void *)&vk_11_features,
@@ -863,8 +1025,9 @@ bool init_device(VkPhysicalDevice gpu, uint32_t graphics_queue_family_index,
 }
 
 bool init_queues(VkDevice device, uint32_t graphics_queue_family_index,
-                 uint32_t present_queue_family_index, VkQueue *graphics_queue,
-                 VkQueue *present_queue) {
+                 uint32_t present_queue_family_index,
+                 uint32_t transfer_queue_family_index, VkQueue *graphics_queue,
+                 VkQueue *present_queue, VkQueue *transfer_queue) {
   vkGetDeviceQueue(device, graphics_queue_family_index, 0, graphics_queue);
 
   if (graphics_queue_family_index == present_queue_family_index) {
@@ -878,6 +1041,13 @@ bool init_queues(VkDevice device, uint32_t graphics_queue_family_index,
     SET_VK_NAME(device, *present_queue, VK_OBJECT_TYPE_QUEUE, "Present Queue");
   }
 
+  *transfer_queue = VK_NULL_HANDLE;
+  if (transfer_queue_family_index != 0xFFFFFFFF) {
+    vkGetDeviceQueue(device, transfer_queue_family_index, 0, transfer_queue);
+    SET_VK_NAME(device, *transfer_queue, VK_OBJECT_TYPE_QUEUE,
+                "Transfer Queue");
+  }
+
   return true;
 }
 
@@ -1144,20 +1314,33 @@ bool init_render_thread(TbRenderThread *thread) {
                                       thread->queue_family_count,
                                       thread->queue_props,
                                       &thread->present_queue_family_index,
-                                      &thread->graphics_queue_family_index),
+                                      &thread->graphics_queue_family_index,
+                                      &thread->transfer_queue_family_index),
                   "Failed to get find queue families", false);
 
   TB_CHECK_RETURN(init_device(thread->gpu, thread->graphics_queue_family_index,
-                              thread->present_queue_family_index, tmp_alloc,
+                              thread->present_queue_family_index,
+                              thread->transfer_queue_family_index, tmp_alloc,
                               vk_alloc, &thread->ext_support, &thread->device),
                   "Failed to init device", false);
 
   TB_CHECK_RETURN(init_queues(thread->device,
                               thread->graphics_queue_family_index,
                               thread->present_queue_family_index,
-                              &thread->graphics_queue, &thread->present_queue),
+                              thread->transfer_queue_family_index,
+                              &thread->graphics_queue, &thread->present_queue,
+                              &thread->transfer_queue),
                   "Failed to init queues", false);
 
+  TB_CHECK_RETURN(create_timeline_semaphore(thread->device, vk_alloc,
+                                            "Upload Timeline",
+                                            &thread->upload_timeline) ==
+                      VK_SUCCESS,
+                  "Failed to create upload timeline", false);
+  tb_create_upload_timeline(gp_alloc,
+                            thread->transfer_queue != VK_NULL_HANDLE,
+                            &thread->uploads);
+
   TB_CHECK_RETURN(init_vma(thread->instance, thread->gpu, thread->device,
                            vk_alloc, &thread->vma_alloc),
                   "Failed to init the Vulkan Memory Allocator", false);
@@ -1167,10 +1350,23 @@ bool init_render_thread(TbRenderThread *thread) {
                                  &thread->swapchain),
                   "Failed to init swapchain", false);
 
+  // Timestamps don't need Tracy but do need a graphics queue that can write
+  // them. Lavapipe and most desktop drivers can
+  const bool timestamps =
+      thread->queue_props[thread->graphics_queue_family_index]
+              .timestampValidBits > 0 &&
+      thread->gpu_props.properties.limits.timestampPeriod > 0.0f;
+  if (!timestamps) {
+    TB_LOG_WARN(SDL_LOG_CATEGORY_RENDER,
+                "Graphics queue can't write timestamps; GPU timings disabled");
+  }
+
   TB_CHECK_RETURN(
       init_frame_states(thread->gpu, thread->device, &thread->swapchain,
-                        thread->graphics_queue_family_index, thread->vma_alloc,
-                        vk_alloc, gp_alloc, thread->frame_states),
+                        thread->graphics_queue_family_index,
+                        thread->transfer_queue_family_index, timestamps,
+                        thread->vma_alloc, vk_alloc, gp_alloc,
+                        thread->frame_states),
       "Failed to init frame states", false);
   return true;
 }
@@ -1214,11 +1410,19 @@ void *record_pass_begin(VkCommandBuffer buffer, TracyCGPUContext *ctx,
   // ret = frame_scope;
 #endif
 
-  // Perform any necessary image transitions
-  for (uint32_t i = 0; i < pass->barrier_count; ++i) {
-    const TbImageTransition *barrier = &pass->barriers[i];
-    vkCmdPipelineBarrier(buffer, barrier->src_flags, barrier->dst_flags, 0, 0,
-                         NULL, 0, NULL, 1, &barrier->barrier);
+  // Perform any necessary image transitions as one batch
+  if (pass->barrier_count > 0) {
+    VkPipelineStageFlags src_flags = 0;
+    VkPipelineStageFlags dst_flags = 0;
+    VkImageMemoryBarrier barriers[TB_MAX_BARRIERS] = {0};
+    for (uint32_t i = 0; i < pass->barrier_count; ++i) {
+      const TbImageTransition *barrier = &pass->barriers[i];
+      src_flags |= barrier->src_flags;
+      dst_flags |= barrier->dst_flags;
+      barriers[i] = barrier->barrier;
+    }
+    vkCmdPipelineBarrier(buffer, src_flags, dst_flags, 0, 0, NULL, 0, NULL,
+                         pass->barrier_count, barriers);
   }
 
   // Assume a pass with no attachments is doing compute work
@@ -1238,6 +1442,292 @@ void record_pass_end(VkCommandBuffer buffer, TracyCGPUScope *scope,
   }
 }
 
+typedef struct TbPassRecordArgs {
+  TbRenderThread *thread;
+  TbFrameState *state;
+  TracyCGPUContext *gpu_ctx;
+} TbPassRecordArgs;
+
+// Records a single pass into its own command buffer from start to finish so
+// that any thread can record it
+static void record_pass(const TbPassRecordArgs *args, uint32_t pass_idx) {
+  tb_auto state = args->state;
+  tb_auto gpu_ctx = args->gpu_ctx;
+  TbPassContext *pass = &TB_DYN_ARR_AT(state->pass_contexts, pass_idx);
+  const uint64_t start = SDL_GetPerformanceCounter();
+
+  const uint32_t buffer_idx = pass->command_buffer_index;
+  VkCommandBuffer pass_buffer = state->pass_command_buffers[buffer_idx];
+  vkResetCommandPool(args->thread->device,
+                     state->pass_command_pools[buffer_idx], 0);
+  {
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    vkBeginCommandBuffer(pass_buffer, &begin_info);
+  }
+
+  // Pass timestamps sit outside of any render pass instance since multiview
+  // passes would otherwise consume a query per view
+  const uint32_t query = 2 + pass_idx * 2;
+  const bool timestamps = state->timestamp_pool != VK_NULL_HANDLE &&
+                          pass_idx < TB_MAX_COMMAND_BUFFERS;
+  if (timestamps) {
+    vkCmdWriteTimestamp(pass_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        state->timestamp_pool, query);
+  }
+
+  void *pass_scope = record_pass_begin(pass_buffer, gpu_ctx, pass);
+  if (pass->attachment_count > 0) {
+    TB_DYN_ARR_FOREACH(state->draw_contexts, draw_idx) {
+      TbDrawContext *draw = &TB_DYN_ARR_AT(state->draw_contexts, draw_idx);
+      if (draw->pass_id == pass->id && draw->batch_count > 0) {
+        draw->record_fn(gpu_ctx, pass_buffer, draw->batch_count,
+                        draw->batches);
+      }
+    }
+  } else {
+    TB_DYN_ARR_FOREACH(state->dispatch_contexts, disp_idx) {
+      TbDispatchContext *dispatch =
+          &TB_DYN_ARR_AT(state->dispatch_contexts, disp_idx);
+      if (dispatch->pass_id == pass->id && dispatch->batch_count > 0) {
+        dispatch->record_fn(gpu_ctx, pass_buffer, dispatch->batch_count,
+                            dispatch->batches);
+      }
+    }
+  }
+  record_pass_end(pass_buffer, pass_scope, pass);
+
+  if (timestamps) {
+    vkCmdWriteTimestamp(pass_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        state->timestamp_pool, query + 1);
+  }
+
+#ifdef TRACY_ENABLE
+  cmd_end_label(pass_buffer);
+#endif
+
+  vkEndCommandBuffer(pass_buffer);
+
+  const uint64_t elapsed = SDL_GetPerformanceCounter() - start;
+  pass->record_ms =
+      (float)((double)elapsed * 1000.0 / (double)SDL_GetPerformanceFrequency());
+}
+
+static void record_passes_task(uint32_t start, uint32_t end,
+                               uint32_t threadnum, void *args) {
+  TB_TRACY_SCOPEC("Record Passes Task", TracyCategoryColorRendering);
+  (void)threadnum;
+  for (uint32_t pass_idx = start; pass_idx < end; ++pass_idx) {
+    record_pass((const TbPassRecordArgs *)args, pass_idx);
+  }
+}
+
+// Records every copy in the given queues into cmd and leaves images ready to
+// be sampled. With release set, cmd is bound for the transfer queue so each
+// destination is also released to the graphics queue family. The matching
+// acquires are queued up to be recorded once value has signaled
+static uint32_t record_uploads(TbRenderThread *thread, VkCommandBuffer cmd,
+                               TbBufferCopyQueue *buf_queue,
+                               TbBufferImageCopyQueue *img_queue, bool release,
+                               uint64_t value) {
+  uint32_t src_family = VK_QUEUE_FAMILY_IGNORED;
+  uint32_t dst_family = VK_QUEUE_FAMILY_IGNORED;
+  if (release) {
+    src_family = thread->transfer_queue_family_index;
+    dst_family = thread->graphics_queue_family_index;
+  }
+
+  uint32_t upload_count = 0;
+  // Upload all buffer requests
+  {
+    TbBufferCopy up = {0};
+    while (TB_QUEUE_POP(*buf_queue, &up)) {
+      vkCmdCopyBuffer(cmd, up.src, up.dst, 1, &up.region);
+      upload_count++;
+      tb_frame_stat_add(TB_FRAME_STAT_UPLOAD_BYTES, (int64_t)up.region.size);
+
+      if (release) {
+        VkBufferMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .srcQueueFamilyIndex = src_family,
+            .dstQueueFamilyIndex = dst_family,
+            .buffer = up.dst,
+            .offset = up.region.dstOffset,
+            .size = up.region.size,
+        };
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL,
+                             1, &barrier, 0, NULL);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        TbQueueAcquire acquire = {.value = value, .buffer = barrier};
+        tb_queue_upload_acquire(&thread->uploads, &acquire);
+      }
+    }
+  }
+
+  // Upload all buffer to image requests
+  {
+    TbBufferImageCopy up = {0};
+    while (TB_QUEUE_POP(*img_queue, &up)) {
+      upload_count++;
+      VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+      // Issue an upload command only if the src buffer exists
+      // If it doesn't, assume that we want to only do a transition but
+      // no copy
+      if (up.src != VK_NULL_HANDLE) {
+        VkImageMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .subresourceRange = up.range,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = up.dst,
+        };
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0,
+                             NULL, 1, &barrier);
+
+        // Perform the copy
+        vkCmdCopyBufferToImage(cmd, up.src, up.dst,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                               &up.region);
+        layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      }
+
+      // Transition to readable layout
+      VkImageMemoryBarrier barrier = {
+          .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+          .subresourceRange = up.range,
+          .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+          .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+          .oldLayout = layout,
+          .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+          .srcQueueFamilyIndex = src_family,
+          .dstQueueFamilyIndex = dst_family,
+          .image = up.dst,
+      };
+      if (release) {
+        // The graphics queue makes the image visible to shaders when it
+        // acquires it
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL,
+                             0, NULL, 1, &barrier);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        TbQueueAcquire acquire = {
+            .value = value,
+            .is_image = true,
+            .image = barrier,
+        };
+        tb_queue_upload_acquire(&thread->uploads, &acquire);
+      } else {
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL,
+                             0, NULL, 1, &barrier);
+      }
+    }
+  }
+  tb_frame_stat_add(TB_FRAME_STAT_UPLOADS, upload_count);
+  return upload_count;
+}
+
+// Records and submits this frame's async uploads on the transfer queue. The
+// submission signals the upload timeline even when there was nothing to
+// upload so that only this queue ever signals it
+static void submit_transfer_uploads(TbRenderThread *thread,
+                                    TbFrameState *state, uint64_t value) {
+  TB_TRACY_SCOPEC("Submit Transfer", TracyCategoryColorRendering);
+  VkDevice device = thread->device;
+  VkResult err = VK_SUCCESS;
+
+  // The transfer buffer from the last time this frame state was used may
+  // still be executing
+  if (state->transfer_value > 0) {
+    TB_TRACY_SCOPEC("Wait for Transfer", TracyCategoryColorWait);
+    VkSemaphoreWaitInfo wait_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &thread->upload_timeline,
+        .pValues = &state->transfer_value,
+    };
+    err = vkWaitSemaphores(device, &wait_info, SDL_MAX_UINT64);
+    TB_VK_CHECK(err, "Failed to wait for transfer");
+  }
+  vkResetCommandPool(device, state->transfer_command_pool, 0);
+
+  VkCommandBuffer cmd = state->transfer_command_buffer;
+  VkCommandBufferBeginInfo begin_info = {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  err = vkBeginCommandBuffer(cmd, &begin_info);
+  TB_VK_CHECK(err, "Failed to begin transfer command buffer");
+  uint32_t upload_count =
+      record_uploads(thread, cmd, state->async_buf_copy_queue,
+                     state->async_buf_img_copy_queue, true, value);
+  err = vkEndCommandBuffer(cmd);
+  TB_VK_CHECK(err, "Failed to end transfer command buffer");
+
+  VkTimelineSemaphoreSubmitInfo timeline_info = {
+      .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+      .signalSemaphoreValueCount = 1,
+      .pSignalSemaphoreValues = &value,
+  };
+  VkSubmitInfo submit_info = {
+      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext = &timeline_info,
+      .commandBufferCount = upload_count > 0 ? 1 : 0,
+      .pCommandBuffers = &cmd,
+      .signalSemaphoreCount = 1,
+      .pSignalSemaphores = &thread->upload_timeline,
+  };
+  queue_begin_label(thread->transfer_queue, "Transfer",
+                    (float4){0.1f, 0.1f, 1.0f, 1.0f});
+  err = vkQueueSubmit(thread->transfer_queue, 1, &submit_info, VK_NULL_HANDLE);
+  TB_VK_CHECK(err, "Failed to submit transfer work");
+  queue_end_label(thread->transfer_queue);
+
+  state->transfer_value = value;
+}
+
+// Records the graphics side of every ownership transfer whose release has
+// finished. Returns the timeline value the recording command buffer must
+// wait on or 0 if nothing was acquired
+static uint64_t record_acquires(TbRenderThread *thread, VkCommandBuffer cmd) {
+  if (TB_DYN_ARR_EMPTY(thread->uploads.pending)) {
+    return 0;
+  }
+
+  uint64_t signaled = 0;
+  vkGetSemaphoreCounterValue(thread->device, thread->upload_timeline,
+                             &signaled);
+  const uint64_t wait_value =
+      tb_take_upload_acquires(&thread->uploads, signaled);
+  TB_DYN_ARR_FOREACH(thread->uploads.ready, i) {
+    tb_auto acquire = &TB_DYN_ARR_AT(thread->uploads.ready, i);
+    if (acquire->is_image) {
+      vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                           VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 0,
+                           NULL, 1, &acquire->image);
+    } else {
+      vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                           VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 1,
+                           &acquire->buffer, 0, NULL);
+    }
+  }
+  return wait_value;
+}
+
 void tick_render_thread(TbRenderThread *thread, TbFrameState *state) {
   VkResult err = VK_SUCCESS;
 
@@ -1321,6 +1811,7 @@ void tick_render_thread(TbRenderThread *thread, TbFrameState *state) {
       TB_DYN_ARR_APPEND(writes, write);
     }
     uint32_t write_count = TB_DYN_ARR_SIZE(writes);
+    tb_frame_stat_add(TB_FRAME_STAT_DESC_WRITES, write_count);
 
     vkUpdateDescriptorSets(device, write_count, writes.data, 0, NULL);
 
@@ -1328,10 +1819,18 @@ void tick_render_thread(TbRenderThread *thread, TbFrameState *state) {
     TB_DYN_ARR_DESTROY(writes);
   }
 
+  const uint64_t upload_value =
+      tb_next_upload_value(&thread->uploads, state->upload_value);
+  const bool use_transfer_queue = thread->uploads.transfer_queue;
+  if (use_transfer_queue) {
+    submit_transfer_uploads(thread, state, upload_value);
+  }
+
   {
     TB_TRACY_SCOPEC("Record Draw", TracyCategoryColorRendering);
 
     TracyCGPUContext *gpu_ctx = (TracyCGPUContext *)state->tracy_gpu_context;
+    uint64_t acquire_value = 0;
 
     // Start Upload Record
     {
@@ -1340,6 +1839,13 @@ void tick_render_thread(TbRenderThread *thread, TbFrameState *state) {
       };
       err = vkBeginCommandBuffer(start_buffer, &begin_info);
       TB_VK_CHECK(err, "Failed to begin command buffer");
+
+      if (state->timestamp_pool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(start_buffer, state->timestamp_pool, 0,
+                            TB_MAX_TIMESTAMPS);
+        vkCmdWriteTimestamp(start_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                            state->timestamp_pool, 0);
+      }
     }
 
     // Upload
@@ -1348,58 +1854,14 @@ void tick_render_thread(TbRenderThread *thread, TbFrameState *state) {
         TB_TRACY_SCOPE("Record Upload");
         TracyCVkNamedZone(gpu_ctx, upload_scope, start_buffer, "Upload", 1,
                           true);
-        // Upload all buffer requests
-        {
-          TbBufferCopy up = {0};
-          while (TB_QUEUE_POP(*state->buf_copy_queue, &up)) {
-            vkCmdCopyBuffer(start_buffer, up.src, up.dst, 1, &up.region);
-          }
-        }
-
-        // Upload all buffer to image requests
-        {
-          TbBufferImageCopy up = {0};
-          while (TB_QUEUE_POP(*state->buf_img_copy_queue, &up)) {
-            // Issue an upload command only if the src buffer exists
-            // If it doesn't, assume that we want to only do a transition but
-            // no copy
-            if (up.src != VK_NULL_HANDLE) {
-              VkImageMemoryBarrier barrier = {
-                  .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                  .subresourceRange = up.range,
-                  .srcAccessMask = 0,
-                  .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-                  .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                  .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                  .image = up.dst,
-              };
-              vkCmdPipelineBarrier(start_buffer,
-                                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                   VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL,
-                                   0, NULL, 1, &barrier);
-
-              // Perform the copy
-              vkCmdCopyBufferToImage(start_buffer, up.src, up.dst,
-                                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
-                                     &up.region);
-            }
-
-            // Transition to readable layout
-            {
-              VkImageMemoryBarrier barrier = {
-                  .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                  .subresourceRange = up.range,
-                  .srcAccessMask = 0,
-                  .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                  .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                  .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                  .image = up.dst,
-              };
-              vkCmdPipelineBarrier(start_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0,
-                                   NULL, 0, NULL, 1, &barrier);
-            }
-          }
+        record_uploads(thread, start_buffer, state->buf_copy_queue,
+                       state->buf_img_copy_queue, false, 0);
+        if (use_transfer_queue) {
+          acquire_value = record_acquires(thread, start_buffer);
+        } else {
+          // Without a transfer queue async uploads just join the rest
+          record_uploads(thread, start_buffer, state->async_buf_copy_queue,
+                         state->async_buf_img_copy_queue, false, 0);
         }
 
         TracyCVkZoneEnd(upload_scope);
@@ -1448,20 +1910,49 @@ void tick_render_thread(TbRenderThread *thread, TbFrameState *state) {
       VkSemaphore wait_sems[16] = {0};
       VkPipelineStageFlags wait_stage_flags[16] = {0};
 
+      uint64_t wait_values[16] = {0};
+
       wait_sems[wait_sem_count] = img_acquired_sem;
       wait_stage_flags[wait_sem_count++] =
           VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
+      // Acquires must come after the transfer queue's releases. The value
+      // has already signaled so this wait is only there for correctness
+      if (acquire_value > 0) {
+        wait_sems[wait_sem_count] = thread->upload_timeline;
+        wait_values[wait_sem_count] = acquire_value;
+        wait_stage_flags[wait_sem_count++] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+      }
+
+      // On the graphics queue path this submission finishes the async
+      // uploads too
+      uint32_t signal_sem_count = 0;
+      VkSemaphore signal_sems[2] = {0};
+      uint64_t signal_values[2] = {0};
+      signal_sems[signal_sem_count++] = upload_complete_sem;
+      if (!use_transfer_queue) {
+        signal_sems[signal_sem_count] = thread->upload_timeline;
+        signal_values[signal_sem_count++] = upload_value;
+      }
+
       {
+        VkTimelineSemaphoreSubmitInfo timeline_info = {
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .waitSemaphoreValueCount = wait_sem_count,
+            .pWaitSemaphoreValues = wait_values,
+            .signalSemaphoreValueCount = signal_sem_count,
+            .pSignalSemaphoreValues = signal_values,
+        };
         VkSubmitInfo submit_info = {
             .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = &timeline_info,
             .waitSemaphoreCount = wait_sem_count,
             .pWaitSemaphores = wait_sems,
             .pWaitDstStageMask = wait_stage_flags,
             .commandBufferCount = 1,
             .pCommandBuffers = &start_buffer,
-            .signalSemaphoreCount = 1,
-            .pSignalSemaphores = &upload_complete_sem,
+            .signalSemaphoreCount = signal_sem_count,
+            .pSignalSemaphores = signal_sems,
         };
 
         queue_begin_label(graphics_queue, "Upload",
@@ -1477,110 +1968,67 @@ void tick_render_thread(TbRenderThread *thread, TbFrameState *state) {
     if (TB_DYN_ARR_SIZE(state->pass_contexts) > 0) {
       TB_TRACY_SCOPE("Record Passes");
       pre_final_sem = render_complete_sem;
-      uint32_t last_pass_buffer_idx = 0xFFFFFFFF;
-      TB_DYN_ARR_FOREACH(state->pass_contexts, pass_idx) {
-        TbPassContext *pass = &TB_DYN_ARR_AT(state->pass_contexts, pass_idx);
-
-        VkCommandBuffer pass_buffer =
-            state->pass_command_buffers[pass->command_buffer_index];
-        if (pass->command_buffer_index != last_pass_buffer_idx) {
-          // Submit previous command buffer
-          if (last_pass_buffer_idx != 0xFFFFFFFF) {
-            vkEndCommandBuffer(
-                state->pass_command_buffers[last_pass_buffer_idx]);
-
-            // Submit pass work
-            {
-              TB_TRACY_SCOPE("Submit Passes");
-
-              uint32_t wait_sem_count = 0;
-              VkSemaphore wait_sems[16] = {0};
-              VkPipelineStageFlags wait_stage_flags[16] = {0};
-
-              if (last_pass_buffer_idx == 0) {
-                wait_sems[wait_sem_count] = upload_complete_sem;
-                wait_stage_flags[wait_sem_count++] =
-                    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-              }
-
-              {
-                VkSubmitInfo submit_info = {
-                    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                    .waitSemaphoreCount = wait_sem_count,
-                    .pWaitSemaphores = wait_sems,
-                    .pWaitDstStageMask = wait_stage_flags,
-                    .commandBufferCount = 1,
-                    .pCommandBuffers =
-                        &state->pass_command_buffers[last_pass_buffer_idx],
-                };
-
-                err = vkQueueSubmit(graphics_queue, 1, &submit_info,
-                                    VK_NULL_HANDLE);
-                TB_VK_CHECK(err, "Failed to submit pass work");
-              }
-            }
-          }
-
-          VkCommandBufferBeginInfo begin_info = {
-              .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-          };
-          vkBeginCommandBuffer(pass_buffer, &begin_info);
-        }
-
-        void *pass_scope = record_pass_begin(pass_buffer, gpu_ctx, pass);
-        if (pass->attachment_count > 0) {
-          TB_DYN_ARR_FOREACH(state->draw_contexts, draw_idx) {
-            TbDrawContext *draw =
-                &TB_DYN_ARR_AT(state->draw_contexts, draw_idx);
-            if (draw->pass_id == pass->id && draw->batch_count > 0) {
-              draw->record_fn(gpu_ctx, pass_buffer, draw->batch_count,
-                              draw->batches);
-            }
-          }
-        } else {
-          TB_DYN_ARR_FOREACH(state->dispatch_contexts, disp_idx) {
-            TbDispatchContext *dispatch =
-                &TB_DYN_ARR_AT(state->dispatch_contexts, disp_idx);
-            if (dispatch->pass_id == pass->id && dispatch->batch_count > 0) {
-              dispatch->record_fn(gpu_ctx, pass_buffer, dispatch->batch_count,
-                                  dispatch->batches);
-            }
-          }
-        }
-        record_pass_end(pass_buffer, pass_scope, pass);
-
-#ifdef TRACY_ENABLE
-        cmd_end_label(pass_buffer);
-#endif
+      const uint32_t pass_count = TB_DYN_ARR_SIZE(state->pass_contexts);
+
+      // The render thread registers with the task scheduler the first time
+      // it sees one so that it is allowed to launch tasks of its own
+      if (thread->enki != NULL && thread->record_task == NULL) {
+        enkiRegisterExternalTaskThread(thread->enki);
+        thread->record_task =
+            enkiCreateTaskSet(thread->enki, record_passes_task);
+        tb_set_task_priority(thread->record_task, TB_TASK_PRIORITY_HIGH);
+      }
 
-        last_pass_buffer_idx = pass->command_buffer_index;
+      // Passes don't share command buffers or pools so they can all be
+      // recorded at once. Submission order below is unaffected
+      TbPassRecordArgs record_args = {
+          .thread = thread,
+          .state = state,
+          .gpu_ctx = gpu_ctx,
+      };
+      if (thread->record_task != NULL && pass_count > 1) {
+        struct enkiParamsTaskSet params =
+            enkiGetParamsTaskSet(thread->record_task);
+        params.pArgs = &record_args;
+        params.setSize = pass_count;
+        params.minRange = 1;
+        enkiSetParamsTaskSet(thread->record_task, params);
+        enkiAddTaskSet(thread->enki, thread->record_task);
+        // While waiting, only help with other high priority work so that a
+        // frame never stalls on an asset load
+        tb_wait_task_priority(thread->enki, thread->record_task,
+                              TB_TASK_PRIORITY_HIGH);
+      } else {
+        record_passes_task(0, pass_count, 0, &record_args);
       }
-      vkEndCommandBuffer(state->pass_command_buffers[last_pass_buffer_idx]);
 
-      // Submit last pass work
+      // Submit every pass in execution order with a single submission
       {
         TB_TRACY_SCOPE("Submit Passes");
+        tb_auto pass_buffers = tb_alloc_nm_tp(state->tmp_alloc.alloc,
+                                              pass_count, VkCommandBuffer);
+        TB_DYN_ARR_FOREACH(state->pass_contexts, pass_idx) {
+          tb_auto pass = &TB_DYN_ARR_AT(state->pass_contexts, pass_idx);
+          pass_buffers[pass_idx] =
+              state->pass_command_buffers[pass->command_buffer_index];
+        }
 
-        uint32_t wait_sem_count = 0;
-        VkSemaphore wait_sems[16] = {0};
-        VkPipelineStageFlags wait_stage_flags[16] = {0};
+        VkSemaphore wait_sem = upload_complete_sem;
+        VkPipelineStageFlags wait_stage_flags =
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        VkSubmitInfo submit_info = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &wait_sem,
+            .pWaitDstStageMask = &wait_stage_flags,
+            .commandBufferCount = pass_count,
+            .pCommandBuffers = pass_buffers,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &render_complete_sem,
+        };
 
-        {
-          VkSubmitInfo submit_info = {
-              .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-              .waitSemaphoreCount = wait_sem_count,
-              .pWaitSemaphores = wait_sems,
-              .pWaitDstStageMask = wait_stage_flags,
-              .commandBufferCount = 1,
-              .pCommandBuffers =
-                  &state->pass_command_buffers[last_pass_buffer_idx],
-              .signalSemaphoreCount = 1,
-              .pSignalSemaphores = &render_complete_sem,
-          };
-
-          err = vkQueueSubmit(graphics_queue, 1, &submit_info, VK_NULL_HANDLE);
-          TB_VK_CHECK(err, "Failed to submit pass work");
-        }
+        err = vkQueueSubmit(graphics_queue, 1, &submit_info, VK_NULL_HANDLE);
+        TB_VK_CHECK(err, "Failed to submit pass work");
       }
     }
 
@@ -1611,6 +2059,12 @@ void tick_render_thread(TbRenderThread *thread, TbFrameState *state) {
           end_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
           VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
 
+      if (state->timestamp_pool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(end_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            state->timestamp_pool, 1);
+        state->timestamps_written = true;
+      }
+
       vkEndCommandBuffer(end_buffer);
     }
 
@@ -1711,6 +2165,7 @@ int32_t render_thread(void *data) {
   TB_CHECK_RETURN(init_render_thread(thread), "Failed to init render thread",
                   -1);
   TracyCSetThreadName("Render Thread");
+  tb_prof_set_thread_name("Render Thread");
 
   SDL_SignalSemaphore(thread->initialized);
 
@@ -1767,9 +2222,17 @@ int32_t render_thread(void *data) {
     }
   }
 
+  if (thread->record_task != NULL) {
+    enkiDeleteTaskSet(thread->enki, thread->record_task);
+    enkiDeRegisterExternalTaskThread(thread->enki);
+  }
+
   // Frame states must be destroyed on this thread
   destroy_frame_states(thread->device, thread->vma_alloc, &thread->vk_alloc,
                        thread->frame_states);
+  vkDestroySemaphore(thread->device, thread->upload_timeline,
+                     &thread->vk_alloc);
+  tb_destroy_upload_timeline(&thread->uploads);
 
   // Also must destroy swapchain and a few other primitives here
   vkDestroySwapchainKHR(thread->device, thread->swapchain.swapchain,
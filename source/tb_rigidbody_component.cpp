@@ -270,6 +270,7 @@ void tb_on_rigidbody_removed(flecs::entity ent, TbRigidbodyComponent &rb) {
 
   auto body = JPH::BodyID(rb);
   bodies.RemoveBody(body);
+  bodies.DestroyBody(body);
 }
 
 TbComponentRegisterResult tb_register_rigidbody_comp(TbWorld *world) {
@@ -2,12 +2,14 @@
 
 #include "tb_allocator.h"
 #include "tb_assets.h"
+#include "tb_camera_component.h"
 #include "tb_common.h"
 #include "tb_gltf.h"
 #include "tb_material_system.h"
 #include "tb_mesh_system.h"
 #include "tb_profiling.h"
 #include "tb_render_object_system.h"
+#include "tb_scene_cells.h"
 #include "tb_task_scheduler.h"
 #include "tb_texture_system.h"
 #include "tb_transform_component.h"
@@ -28,6 +30,8 @@ typedef struct TbSceneCtx {
   ecs_query_t *parent_resolve_query;
   ecs_query_t *comp_ready_query;
   ecs_query_t *ent_ready_query;
+  ecs_query_t *stream_query;
+  ecs_query_t *camera_query;
 } TbSceneCtx;
 ECS_COMPONENT_DECLARE(TbSceneCtx);
 
@@ -37,6 +41,7 @@ typedef struct TbEntityLoadRequest {
   const cgltf_data *data;
   const cgltf_node *node;
   json_object *json;
+  bool detached;
 } TbEntityLoadRequest;
 typedef TB_QUEUE_OF(TbEntityLoadRequest) TbEntityTaskQueue;
 
@@ -53,15 +58,30 @@ ECS_COMPONENT_DECLARE(TbSceneEntParseCounter);
 typedef uint32_t TbSceneEntReadyCounter;
 ECS_COMPONENT_DECLARE(TbSceneEntReadyCounter);
 
+// Bytes the glTF loaders had copied when the scene started loading.
+// Other scenes loading at the same time are counted too
+typedef uint64_t TbSceneCopiedBytes;
+ECS_COMPONENT_DECLARE(TbSceneCopiedBytes);
+// Same for the bytes of content the loaders didn't load again because an
+// asset with the same content hash was already loaded
+typedef uint64_t TbSceneReusedBytes;
+ECS_COMPONENT_DECLARE(TbSceneReusedBytes);
+
+// The scene's reference to its glb, released once the scene is ready
+typedef const cgltf_data *TbSceneGLB;
+ECS_COMPONENT_DECLARE(TbSceneGLB);
+
 typedef TbScene TbSceneRef;
 ECS_COMPONENT_DECLARE(TbSceneRef);
 
 ECS_TAG_DECLARE(TbSceneRoot);
+ECS_TAG_DECLARE(TbSceneStreamed);
 ECS_TAG_DECLARE(TbSceneParsing);
 ECS_TAG_DECLARE(TbSceneParsed);
 ECS_TAG_DECLARE(TbSceneLoading);
 ECS_TAG_DECLARE(TbSceneLoaded);
 ECS_TAG_DECLARE(TbSceneReady);
+ECS_TAG_DECLARE(TbSceneUnloadRequest);
 ECS_TAG_DECLARE(TbComponentsReady);
 ECS_TAG_DECLARE(TbEntityReady);
 
@@ -70,6 +90,7 @@ typedef struct TbSceneParsedArgs {
   TbScene scene;
   uint32_t local_parent;
   const char *path;
+  const cgltf_data *data;
   TbEntityTaskQueue *queue;
 } TbSceneParsedArgs;
 
@@ -85,6 +106,7 @@ void tb_scene_parsed(const void *args) {
   ecs_add(ecs, scene, TbSceneParsed);
 
   ecs_set_ptr(ecs, scene, TbEntityTaskQueue, queue);
+  ecs_set(ecs, scene, TbSceneGLB, {load_args->data});
   ecs_set(ecs, scene, TbSceneEntityCount, {used_node_count});
   ecs_set(ecs, scene, TbSceneEntParseCounter, {used_node_count}); // Counts down
   ecs_set(ecs, scene, TbSceneEntReadyCounter, {0});               // Counts up
@@ -99,11 +121,11 @@ typedef struct TbParseSceneArgs {
   TbPinnedTask parsed_task;
 } TbParseSceneArgs;
 
-void tb_enqueue_entity_parse_req(ecs_world_t *ecs, const char *path,
-                                 TbEntityTaskQueue *queue, json_tokener *tok,
-                                 const cgltf_data *data,
-                                 const cgltf_node *node) {
-  TB_TRACY_SCOPE("Enqueue Entity Parse Req");
+static void tb_enqueue_node_parse_req(ecs_world_t *ecs, const char *path,
+                                      TbEntityTaskQueue *queue,
+                                      json_tokener *tok,
+                                      const cgltf_data *data,
+                                      const cgltf_node *node, bool detached) {
   json_object *json = NULL;
   {
     cgltf_size extra_size = 0;
@@ -130,9 +152,17 @@ void tb_enqueue_entity_parse_req(ecs_world_t *ecs, const char *path,
       .data = data,
       .node = node,
       .json = json,
+      .detached = detached,
   };
   TB_QUEUE_PUSH_PTR(queue, req);
+}
 
+void tb_enqueue_entity_parse_req(ecs_world_t *ecs, const char *path,
+                                 TbEntityTaskQueue *queue, json_tokener *tok,
+                                 const cgltf_data *data,
+                                 const cgltf_node *node) {
+  TB_TRACY_SCOPE("Enqueue Entity Parse Req");
+  tb_enqueue_node_parse_req(ecs, path, queue, tok, data, node, false);
   for (cgltf_size i = 0; i < node->children_count; ++i) {
     tb_enqueue_entity_parse_req(ecs, path, queue, tok, data, node->children[i]);
   }
@@ -153,7 +183,7 @@ void tb_parse_scene_task(const void *args) {
   // thread later
   tb_auto data = tb_read_glb(tb_global_alloc, path);
 
-  json_tokener *tok = json_tokener_new(); // TODO: clean this up alongside data
+  json_tokener *tok = json_tokener_new();
 
   // Create an entity for each node
   for (cgltf_size i = 0; i < data->scenes[0].nodes_count; ++i) {
@@ -161,10 +191,14 @@ void tb_parse_scene_task(const void *args) {
     tb_enqueue_entity_parse_req(ecs, path, queue, tok, data, node);
   }
 
+  // Parsed json objects don't depend on the tokener
+  json_tokener_free(tok);
+
   TbSceneParsedArgs parsed_args = {
       .ecs = ecs,
       .scene = scene,
       .path = path,
+      .data = data,
       .queue = queue,
   };
   tb_launch_pinned_task_args(enki, parsed_task, &parsed_args,
@@ -212,15 +246,30 @@ TbScene tb_create_scene(ecs_world_t *ecs, const char *scene_path) {
       tb_async_task(enki, tb_parse_scene_task, &args, sizeof(TbParseSceneArgs));
 
   ecs_set(ecs, scene, TbTask, {load_task});
+  ecs_set(ecs, scene, TbSceneCopiedBytes, {tb_gltf_copied_bytes()});
+  ecs_set(ecs, scene, TbSceneReusedBytes, {tb_gltf_reused_bytes()});
   ecs_add(ecs, scene, TbSceneParsing);
   ecs_add(ecs, scene, TbSceneRoot);
 
   return scene;
 }
 
+// Transform of the node's ancestors baked into its own the way the
+// transform system would combine them if they were its parents
+static TbTransform tb_node_world_transform(const cgltf_node *node) {
+  TbTransform world = tb_transform_from_node(node);
+  for (tb_auto parent = node->parent; parent; parent = parent->parent) {
+    const TbTransform parent_trans = tb_transform_from_node(parent);
+    world = tb_transform_combine(&world, &parent_trans);
+  }
+  return world;
+}
+
+// Detached entities are loaded without their parent which is loaded by
+// another scene
 ecs_entity_t tb_load_entity(ecs_world_t *ecs, const char *source_path,
                             const cgltf_data *data, const cgltf_node *node,
-                            json_object *json) {
+                            json_object *json, bool detached) {
   TB_TRACY_SCOPE("Load Entity");
   // See if the entity is enabled or a prefab
   bool enabled = true;
@@ -255,7 +304,7 @@ ecs_entity_t tb_load_entity(ecs_world_t *ecs, const char *source_path,
   // We don't know our parent yet until all entities have been loaded
   // Associate the node with the entity to be able to resolve parents
   ecs_set(ecs, ent, TbNode, {node});
-  if (node->parent) {
+  if (node->parent && !detached) {
     ecs_add(ecs, ent, TbParentRequest);
   }
 
@@ -264,6 +313,10 @@ ecs_entity_t tb_load_entity(ecs_world_t *ecs, const char *source_path,
     tb_auto load_fn = tb_get_component_load_fn("transform");
     if (load_fn) {
       load_fn(ecs, ent, source_path, data, node, NULL);
+      if (detached) {
+        tb_auto comp = ecs_get_mut(ecs, ent, TbTransformComponent);
+        comp->transform = tb_node_world_transform(node);
+      }
     }
     if (node->mesh) {
       load_fn = tb_get_component_load_fn("mesh");
@@ -335,7 +388,12 @@ void tb_load_entities(ecs_iter_t *it) {
       tb_auto node = load_req.node;
       tb_auto json = load_req.json;
 
-      tb_auto ent = tb_load_entity(ecs, source_path, data, node, json);
+      tb_auto ent = tb_load_entity(ecs, source_path, data, node, json,
+                                   load_req.detached);
+      // Components read what they need from the json while loading
+      if (json) {
+        json_object_put(json);
+      }
 
       // Entities need a refernce to their parent scene since they may not
       // be directly parented
@@ -542,11 +600,395 @@ void tb_ready_check_scenes(ecs_iter_t *it) {
       }
     }
 
+    tb_auto copy_start = ecs_get(ecs, scene, TbSceneCopiedBytes);
+    tb_auto reuse_start = ecs_get(ecs, scene, TbSceneReusedBytes);
+    if (copy_start && reuse_start) {
+      const uint64_t copied = tb_gltf_copied_bytes() - *copy_start;
+      const uint64_t reused = tb_gltf_reused_bytes() - *reuse_start;
+      TB_LOG_INFO(SDL_LOG_CATEGORY_APPLICATION,
+                  "Scene %s copied %.2fMB out of its glb and reused %.2fMB "
+                  "of assets that were already loaded",
+                  ecs_get_name(ecs, scene),
+                  (double)copied / (1024.0 * 1024.0),
+                  (double)reused / (1024.0 * 1024.0));
+    }
+
+    // Every mesh, material and texture that still needs the glb holds its
+    // own reference by now. Cleared in place so that an unload in the same
+    // frame doesn't release it again
+    tb_auto glb = ecs_get_mut(ecs, scene, TbSceneGLB);
+    if (glb && *glb) {
+      tb_release_glb(*glb);
+      *glb = NULL;
+    }
+    ecs_remove(ecs, scene, TbSceneGLB);
+
     ecs_remove(ecs, scene, TbSceneLoaded);
     ecs_add(ecs, scene, TbSceneReady);
   }
 }
 
+// Once every entity of a scene exists no task refers to the scene anymore.
+// It can be unloaded from then on even if its assets are still loading
+static bool tb_is_scene_settled(ecs_world_t *ecs, TbScene scene) {
+  return ecs_has(ecs, scene, TbSceneLoading) ||
+         ecs_has(ecs, scene, TbSceneLoaded) || tb_is_scene_ready(ecs, scene);
+}
+
+static void tb_unload_settled_scene(ecs_world_t *ecs, TbScene scene) {
+  TB_TRACY_SCOPE("Unload Scene");
+
+  // Collect first since deleting would invalidate the iterator
+  TB_DYN_ARR_OF(ecs_entity_t) entities = {0};
+  TB_DYN_ARR_RESET(entities, tb_thread_alloc, 64);
+  {
+    tb_auto filter = ecs_query(ecs, {.terms = {
+                                         {.id = ecs_id(TbSceneRef)},
+                                     }});
+    tb_auto filter_it = ecs_query_iter(ecs, filter);
+    while (ecs_query_next(&filter_it)) {
+      tb_auto scene_refs = ecs_field(&filter_it, TbSceneRef, 0);
+      for (int32_t ent_idx = 0; ent_idx < filter_it.count; ++ent_idx) {
+        if (scene_refs[ent_idx] == scene) {
+          TB_DYN_ARR_APPEND(entities, filter_it.entities[ent_idx]);
+        }
+      }
+    }
+    ecs_query_fini(filter);
+  }
+
+  // Component hooks give back the references to meshes and with them their
+  // materials and textures. Loads that haven't started yet are cancelled.
+  // Children go with their parents
+  TB_DYN_ARR_FOREACH(entities, i) {
+    tb_auto entity = TB_DYN_ARR_AT(entities, i);
+    if (ecs_is_alive(ecs, entity)) {
+      ecs_delete(ecs, entity);
+    }
+  }
+  TB_LOG_INFO(SDL_LOG_CATEGORY_APPLICATION, "Unloaded %u scene entities",
+              TB_DYN_ARR_SIZE(entities));
+  TB_DYN_ARR_DESTROY(entities);
+
+  // A scene that isn't ready yet still holds its glb
+  tb_auto glb = ecs_get(ecs, scene, TbSceneGLB);
+  if (glb && *glb) {
+    tb_release_glb(*glb);
+  }
+
+  tb_auto entity_queue = ecs_get_mut(ecs, scene, TbEntityTaskQueue);
+  if (entity_queue) {
+    TB_QUEUE_DESTROY(*entity_queue);
+  }
+  ecs_delete(ecs, scene);
+}
+
+void tb_unload_requested_scenes(ecs_iter_t *it) {
+  TB_TRACY_SCOPE("Unload Requested Scenes");
+  for (int32_t scene_idx = 0; scene_idx < it->count; ++scene_idx) {
+    tb_auto scene = it->entities[scene_idx];
+    if (tb_is_scene_settled(it->world, scene)) {
+      tb_unload_settled_scene(it->world, scene);
+    }
+  }
+}
+
+// Cells of a streamed scene. The glb stays open for as long as the scene
+// exists so that cells can be loaded again without reading it again
+typedef struct TbSceneStreaming {
+  TbSceneStreamDesc desc;
+  char *path;
+  const cgltf_data *data;
+  TbSceneCells cells;
+  TbSceneCellPlan plan;
+} TbSceneStreaming;
+ECS_COMPONENT_DECLARE(TbSceneStreaming);
+
+typedef struct TbParseStreamedSceneArgs {
+  ecs_world_t *ecs;
+  TbTaskScheduler enki;
+  TbScene scene;
+  TbSceneStreamDesc desc;
+  char *scene_path;
+  TbPinnedTask parsed_task;
+} TbParseStreamedSceneArgs;
+
+typedef struct TbStreamedSceneParsedArgs {
+  ecs_world_t *ecs;
+  TbScene scene;
+  TbSceneStreaming *streaming;
+} TbStreamedSceneParsedArgs;
+
+typedef struct TbParseSceneCellArgs {
+  ecs_world_t *ecs;
+  TbTaskScheduler enki;
+  TbScene scene;
+  TbEntityTaskQueue *queue;
+  const char *path;
+  const cgltf_data *data;
+  const TbSceneCellNode *nodes;
+  uint32_t node_count;
+  TbPinnedTask parsed_task;
+} TbParseSceneCellArgs;
+
+void tb_streamed_scene_parsed(const void *args) {
+  TB_TRACY_SCOPE("Streamed Scene Parsed");
+  tb_auto parsed_args = (const TbStreamedSceneParsedArgs *)args;
+  tb_auto ecs = parsed_args->ecs;
+  tb_auto scene = parsed_args->scene;
+
+  ecs_remove(ecs, scene, TbSceneParsing);
+  ecs_set_ptr(ecs, scene, TbSceneStreaming, parsed_args->streaming);
+  tb_free(tb_global_alloc, parsed_args->streaming);
+}
+
+void tb_parse_streamed_scene_task(const void *args) {
+  TB_TRACY_SCOPE("Parse Streamed Scene Task");
+  tb_auto parse_args = (const TbParseStreamedSceneArgs *)args;
+  tb_auto path = parse_args->scene_path;
+
+  tb_auto streaming = tb_alloc_tp(tb_global_alloc, TbSceneStreaming);
+  *streaming = (TbSceneStreaming){
+      .desc = parse_args->desc,
+      .path = path,
+      .data = tb_read_glb(tb_global_alloc, path),
+  };
+  tb_split_scene_cells(tb_global_alloc, tb_thread_alloc, streaming->data,
+                       parse_args->desc.cell_size, &streaming->cells);
+  TB_DYN_ARR_RESET(streaming->plan.loads, tb_global_alloc, 8);
+  TB_DYN_ARR_RESET(streaming->plan.unloads, tb_global_alloc, 8);
+  TB_LOG_INFO(SDL_LOG_CATEGORY_APPLICATION, "Split scene %s into %u cells",
+              path, TB_DYN_ARR_SIZE(streaming->cells));
+
+  TbStreamedSceneParsedArgs parsed_args = {
+      .ecs = parse_args->ecs,
+      .scene = parse_args->scene,
+      .streaming = streaming,
+  };
+  tb_launch_pinned_task_args(parse_args->enki, parse_args->parsed_task,
+                             &parsed_args, sizeof(TbStreamedSceneParsedArgs));
+}
+
+void tb_parse_scene_cell_task(const void *args) {
+  TB_TRACY_SCOPE("Parse Scene Cell Task");
+  tb_auto cell_args = (const TbParseSceneCellArgs *)args;
+
+  json_tokener *tok = json_tokener_new();
+  for (uint32_t i = 0; i < cell_args->node_count; ++i) {
+    tb_auto entry = &cell_args->nodes[i];
+    tb_enqueue_node_parse_req(cell_args->ecs, cell_args->path,
+                              cell_args->queue, tok, cell_args->data,
+                              entry->node, entry->detached);
+    if (!entry->subtree) {
+      continue;
+    }
+    for (cgltf_size child = 0; child < entry->node->children_count; ++child) {
+      tb_enqueue_entity_parse_req(cell_args->ecs, cell_args->path,
+                                  cell_args->queue, tok, cell_args->data,
+                                  entry->node->children[child]);
+    }
+  }
+  json_tokener_free(tok);
+
+  TbSceneParsedArgs parsed_args = {
+      .ecs = cell_args->ecs,
+      .scene = cell_args->scene,
+      .path = cell_args->path,
+      .data = cell_args->data,
+      .queue = cell_args->queue,
+  };
+  tb_launch_pinned_task_args(cell_args->enki, cell_args->parsed_task,
+                             &parsed_args, sizeof(TbSceneParsedArgs));
+}
+
+// Loads a cell like tb_create_scene loads a whole glb.
+// Expects the world not to be deferred
+static TbScene tb_load_scene_cell(ecs_world_t *ecs, TbTaskScheduler enki,
+                                  const TbSceneStreaming *streaming,
+                                  const TbSceneCell *cell) {
+  TB_TRACY_SCOPE("Load Scene Cell");
+  TbScene scene = ecs_new(ecs);
+
+  TbPinnedTask parsed_task =
+      tb_create_pinned_task(enki, tb_scene_parsed, NULL, 0);
+
+  ecs_set(ecs, scene, TbEntityTaskQueue, {0});
+  tb_auto entity_queue = ecs_get_mut(ecs, scene, TbEntityTaskQueue);
+  TB_QUEUE_RESET(*entity_queue, tb_global_alloc, 256);
+
+  // Released by the cell's scene once it is ready
+  tb_acquire_glb(streaming->data);
+
+  TbParseSceneCellArgs args = {
+      .ecs = ecs,
+      .enki = enki,
+      .scene = scene,
+      .queue = entity_queue,
+      .path = streaming->path,
+      .data = streaming->data,
+      .nodes = cell->nodes.data,
+      .node_count = TB_DYN_ARR_SIZE(cell->nodes),
+      .parsed_task = parsed_task,
+  };
+  TbTask parse_task = tb_async_task(enki, tb_parse_scene_cell_task, &args,
+                                    sizeof(TbParseSceneCellArgs));
+
+  ecs_set(ecs, scene, TbTask, {parse_task});
+  ecs_add(ecs, scene, TbSceneParsing);
+  return scene;
+}
+
+// Returns true once no cell is loaded anymore
+static bool tb_unload_scene_cells(ecs_world_t *ecs,
+                                  TbSceneStreaming *streaming) {
+  bool unloaded = true;
+  TB_DYN_ARR_FOREACH(streaming->cells, i) {
+    tb_auto cell = &TB_DYN_ARR_AT(streaming->cells, i);
+    if (cell->scene == 0) {
+      continue;
+    }
+    // Cells that are still parsing read the stream's nodes and path
+    if (!tb_is_scene_settled(ecs, cell->scene)) {
+      unloaded = false;
+      continue;
+    }
+    tb_unload_settled_scene(ecs, cell->scene);
+    cell->scene = 0;
+    cell->state = TB_SCENE_CELL_UNLOADED;
+  }
+  return unloaded;
+}
+
+static void tb_destroy_streamed_scene(ecs_world_t *ecs, TbScene scene,
+                                      TbSceneStreaming *streaming) {
+  tb_destroy_scene_cells(&streaming->cells);
+  TB_DYN_ARR_DESTROY(streaming->plan.loads);
+  TB_DYN_ARR_DESTROY(streaming->plan.unloads);
+  if (streaming->data) {
+    tb_release_glb(streaming->data);
+  }
+  tb_free(tb_global_alloc, streaming->path);
+  ecs_delete(ecs, scene);
+}
+
+static void tb_stream_scene(ecs_world_t *ecs, TbTaskScheduler enki,
+                            TbScene scene, float3 origin) {
+  tb_auto streaming = ecs_get_mut(ecs, scene, TbSceneStreaming);
+
+  if (ecs_has(ecs, scene, TbSceneUnloadRequest)) {
+    if (tb_unload_scene_cells(ecs, streaming)) {
+      tb_destroy_streamed_scene(ecs, scene, streaming);
+    }
+    return;
+  }
+
+  bool resident_ready = true;
+  TB_DYN_ARR_FOREACH(streaming->cells, i) {
+    tb_auto cell = &TB_DYN_ARR_AT(streaming->cells, i);
+    if (cell->scene == 0) {
+      continue;
+    }
+    if (tb_is_scene_ready(ecs, cell->scene)) {
+      cell->state = TB_SCENE_CELL_READY;
+    } else if (tb_is_scene_settled(ecs, cell->scene)) {
+      cell->state = TB_SCENE_CELL_LOADING;
+    }
+    resident_ready &= !cell->resident || cell->state == TB_SCENE_CELL_READY;
+  }
+
+  tb_plan_scene_cells(&streaming->desc, &streaming->cells, origin,
+                      &streaming->plan);
+  TB_DYN_ARR_FOREACH(streaming->plan.unloads, i) {
+    const uint32_t cell_idx = TB_DYN_ARR_AT(streaming->plan.unloads, i);
+    tb_auto cell = &TB_DYN_ARR_AT(streaming->cells, cell_idx);
+    tb_unload_settled_scene(ecs, cell->scene);
+    cell->scene = 0;
+    cell->state = TB_SCENE_CELL_UNLOADED;
+  }
+  TB_DYN_ARR_FOREACH(streaming->plan.loads, i) {
+    const uint32_t cell_idx = TB_DYN_ARR_AT(streaming->plan.loads, i);
+    tb_auto cell = &TB_DYN_ARR_AT(streaming->cells, cell_idx);
+    cell->scene = tb_load_scene_cell(ecs, enki, streaming, cell);
+    cell->state = TB_SCENE_CELL_PARSING;
+    resident_ready &= !cell->resident;
+  }
+
+  if (resident_ready && !ecs_has(ecs, scene, TbSceneReady)) {
+    ecs_add(ecs, scene, TbSceneReady);
+  }
+}
+
+void tb_stream_scenes(ecs_world_t *ecs) {
+  TB_TRACY_SCOPE("Stream Scenes");
+  tb_auto ctx = ecs_singleton_get(ecs, TbSceneCtx);
+  if (!ctx) {
+    return;
+  }
+  tb_auto enki = *ecs_singleton_get(ecs, TbTaskScheduler);
+
+  // Streamed scenes change tables as they become ready or are destroyed
+  TB_DYN_ARR_OF(TbScene) scenes = {0};
+  TB_DYN_ARR_RESET(scenes, tb_thread_alloc, 8);
+  tb_auto stream_it = ecs_query_iter(ecs, ctx->stream_query);
+  while (ecs_query_next(&stream_it)) {
+    for (int32_t i = 0; i < stream_it.count; ++i) {
+      TB_DYN_ARR_APPEND(scenes, stream_it.entities[i]);
+    }
+  }
+
+  // Cells stream around the first camera or around the origin without one
+  const float3 origin = tb_get_camera_position(ecs, ctx->camera_query);
+  TB_DYN_ARR_FOREACH(scenes, i) {
+    tb_stream_scene(ecs, enki, TB_DYN_ARR_AT(scenes, i), origin);
+  }
+  TB_DYN_ARR_DESTROY(scenes);
+}
+
+TbScene tb_create_streamed_scene(ecs_world_t *ecs, const char *scene_path,
+                                 const TbSceneStreamDesc *desc) {
+  TB_TRACY_SCOPE("Create Streamed Scene");
+  TbScene scene = ecs_lookup_path_w_sep(ecs, 0, scene_path, ",", NULL, true);
+  if (scene != 0) {
+    return scene;
+  }
+  TB_CHECK_RETURN(desc && desc->cell_size > 0.0f,
+                  "Streamed scenes need a cell size", 0);
+
+  tb_auto enki = *ecs_singleton_get(ecs, TbTaskScheduler);
+
+  scene = ecs_new(ecs);
+  ecs_set_name(ecs, scene, scene_path);
+
+  // Owned by the scene's streaming state once parsed
+  const size_t path_len = SDL_strnlen(scene_path, 256) + 1;
+  char *path_cpy = tb_alloc_nm_tp(tb_global_alloc, path_len, char);
+  SDL_strlcpy(path_cpy, scene_path, path_len);
+
+  TbSceneStreamDesc stream_desc = *desc;
+  stream_desc.unload_radius = SDL_max(desc->unload_radius, desc->load_radius);
+
+  TbPinnedTask parsed_task =
+      tb_create_pinned_task(enki, tb_streamed_scene_parsed, NULL, 0);
+
+  TbParseStreamedSceneArgs args = {
+      .ecs = ecs,
+      .enki = enki,
+      .scene = scene,
+      .desc = stream_desc,
+      .scene_path = path_cpy,
+      .parsed_task = parsed_task,
+  };
+  TbTask parse_task = tb_async_task(enki, tb_parse_streamed_scene_task, &args,
+                                    sizeof(TbParseStreamedSceneArgs));
+
+  ecs_set(ecs, scene, TbTask, {parse_task});
+  ecs_add(ecs, scene, TbSceneParsing);
+  ecs_add(ecs, scene, TbSceneRoot);
+  ecs_add(ecs, scene, TbSceneStreamed);
+
+  return scene;
+}
+
 void tb_register_scene_sys(TbWorld *world) {
   tb_auto ecs = world->ecs;
   ECS_COMPONENT_DEFINE(ecs, TbSceneCtx);
@@ -555,14 +997,20 @@ void tb_register_scene_sys(TbWorld *world) {
   ECS_COMPONENT_DEFINE(ecs, TbSceneEntParseCounter);
   ECS_COMPONENT_DEFINE(ecs, TbSceneEntReadyCounter);
   ECS_COMPONENT_DEFINE(ecs, TbNode);
+  ECS_COMPONENT_DEFINE(ecs, TbSceneCopiedBytes);
+  ECS_COMPONENT_DEFINE(ecs, TbSceneReusedBytes);
+  ECS_COMPONENT_DEFINE(ecs, TbSceneGLB);
   ECS_COMPONENT_DEFINE(ecs, TbSceneRef);
+  ECS_COMPONENT_DEFINE(ecs, TbSceneStreaming);
   ECS_TAG_DEFINE(ecs, TbParentRequest);
   ECS_TAG_DEFINE(ecs, TbSceneRoot);
+  ECS_TAG_DEFINE(ecs, TbSceneStreamed);
   ECS_TAG_DEFINE(ecs, TbSceneParsing);
   ECS_TAG_DEFINE(ecs, TbSceneParsed);
   ECS_TAG_DEFINE(ecs, TbSceneLoading);
   ECS_TAG_DEFINE(ecs, TbSceneLoaded);
   ECS_TAG_DEFINE(ecs, TbSceneReady);
+  ECS_TAG_DEFINE(ecs, TbSceneUnloadRequest);
   ECS_TAG_DEFINE(ecs, TbComponentsReady);
   ECS_TAG_DEFINE(ecs, TbEntityReady);
 
@@ -602,7 +1050,17 @@ void tb_register_scene_sys(TbWorld *world) {
                       {.id = ecs_id(TbSceneLoading), .inout = EcsIn},
                   },
               .cache_kind = EcsQueryCacheAuto,
-          })};
+          }),
+      .stream_query = ecs_query(
+          ecs, {
+                   .terms = {{.id = ecs_id(TbSceneStreaming), .inout = EcsIn}},
+                   .cache_kind = EcsQueryCacheAuto,
+               }),
+      .camera_query = ecs_query(
+          ecs, {
+                   .terms = {{.id = ecs_id(TbCameraComponent), .inout = EcsIn}},
+                   .cache_kind = EcsQueryCacheAuto,
+               })};
   ecs_singleton_set_ptr(ecs, TbSceneCtx, &ctx);
 
   // This is an immediate system because we are adding entities
@@ -624,12 +1082,40 @@ void tb_register_scene_sys(TbWorld *world) {
   ECS_SYSTEM(ecs, tb_ready_check_components, EcsPostLoad, [in] TbSceneCtx);
   ECS_SYSTEM(ecs, tb_ready_check_entities, EcsPostLoad, [in] TbSceneCtx);
   ECS_SYSTEM(ecs, tb_ready_check_scenes, EcsPostLoad, TbSceneLoaded);
+
+  ECS_SYSTEM(ecs, tb_unload_requested_scenes, EcsPostLoad,
+             [in] TbSceneUnloadRequest, !TbSceneStreamed);
 }
 
-void tb_unregister_scene_sys(TbWorld *world) { (void)world; }
+void tb_unregister_scene_sys(TbWorld *world) {
+  tb_auto ecs = world->ecs;
+  tb_auto ctx = ecs_singleton_ensure(ecs, TbSceneCtx);
+  ecs_query_fini(ctx->parent_resolve_query);
+  ecs_query_fini(ctx->comp_ready_query);
+  ecs_query_fini(ctx->ent_ready_query);
+  ecs_query_fini(ctx->stream_query);
+  ecs_query_fini(ctx->camera_query);
+  ecs_singleton_remove(ecs, TbSceneCtx);
+}
 
 TB_REGISTER_SYS(tb, scene, TB_SYSTEM_NORMAL)
 
 bool tb_is_scene_ready(ecs_world_t *ecs, TbScene scene) {
   return ecs_has(ecs, scene, TbSceneReady);
 }
+
+void tb_destroy_scene(ecs_world_t *ecs, TbScene scene) {
+  if (!ecs_is_alive(ecs, scene)) {
+    return;
+  }
+  // Tasks still parsing the scene reference its queue and its entities.
+  // Streamed scenes are destroyed by tb_stream_scenes once no cell is parsing
+  if (!tb_is_scene_settled(ecs, scene) ||
+      ecs_has(ecs, scene, TbSceneStreamed)) {
+    // Loading the same path again must not find the doomed scene
+    ecs_set_name(ecs, scene, NULL);
+    ecs_add(ecs, scene, TbSceneUnloadRequest);
+    return;
+  }
+  tb_unload_settled_scene(ecs, scene);
+}
@@ -0,0 +1,275 @@
+#include "tb_scene_cells.h"
+
+#include "tb_common.h"
+#include "tb_gltf.h"
+#include "tb_profiling.h"
+#include "tb_sort.h"
+
+typedef struct TbSceneCellSplit {
+  float cell_size;
+  TbSceneCell *resident;
+  // Nodes headed for cells that aren't resident along with the key of their
+  // cell, sorted into cells once every node has a key
+  TB_DYN_ARR_OF(TbSceneCellNode) nodes;
+  TB_DYN_ARR_OF(uint64_t) keys;
+} TbSceneCellSplit;
+
+// Flipping the sign bit makes negative coordinates sort before positive ones
+static uint64_t tb_scene_cell_key(int32_t x, int32_t z) {
+  return (uint64_t)((uint32_t)x ^ 0x80000000u) << 32 |
+         (uint64_t)((uint32_t)z ^ 0x80000000u);
+}
+
+static int32_t tb_scene_cell_coord(uint32_t bits) {
+  return (int32_t)(bits ^ 0x80000000u);
+}
+
+// Cameras and directional lights matter no matter where the camera is
+static bool tb_is_node_global(const cgltf_node *node) {
+  return node->camera || (node->light && node->light->type ==
+                                             cgltf_light_type_directional);
+}
+
+static bool tb_has_global_node(const cgltf_node *node) {
+  if (tb_is_node_global(node)) {
+    return true;
+  }
+  for (cgltf_size i = 0; i < node->children_count; ++i) {
+    if (tb_has_global_node(node->children[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Grows the bounds by the world space corners of every mesh in the subtree.
+// Returns false if no mesh in the subtree has bounds
+static bool tb_add_subtree_bounds(const cgltf_node *node, TbAABB *bounds) {
+  bool found = false;
+  if (node->mesh) {
+    float m[16] = {0};
+    cgltf_node_transform_world(node, m);
+    for (cgltf_size prim_idx = 0; prim_idx < node->mesh->primitives_count;
+         ++prim_idx) {
+      tb_auto prim = &node->mesh->primitives[prim_idx];
+      for (cgltf_size attr_idx = 0; attr_idx < prim->attributes_count;
+           ++attr_idx) {
+        tb_auto attr = &prim->attributes[attr_idx];
+        if (attr->type != cgltf_attribute_type_position ||
+            !attr->data->has_min || !attr->data->has_max) {
+          continue;
+        }
+        const float *min = attr->data->min;
+        const float *max = attr->data->max;
+        for (uint32_t corner = 0; corner < 8; ++corner) {
+          const float x = corner & 1 ? max[0] : min[0];
+          const float y = corner & 2 ? max[1] : min[1];
+          const float z = corner & 4 ? max[2] : min[2];
+          tb_aabb_add_point(bounds,
+                            tb_f3(m[0] * x + m[4] * y + m[8] * z + m[12],
+                                  m[1] * x + m[5] * y + m[9] * z + m[13],
+                                  m[2] * x + m[6] * y + m[10] * z + m[14]));
+        }
+        found = true;
+      }
+    }
+  }
+  for (cgltf_size i = 0; i < node->children_count; ++i) {
+    found |= tb_add_subtree_bounds(node->children[i], bounds);
+  }
+  return found;
+}
+
+static void tb_split_scene_node(TbSceneCellSplit *split,
+                                const cgltf_node *node) {
+  if (tb_is_node_global(node)) {
+    TbSceneCellNode entry = {.node = node, .subtree = true};
+    TB_DYN_ARR_APPEND(split->resident->nodes, entry);
+    return;
+  }
+
+  const float cell_size = split->cell_size;
+  TbAABB bounds = tb_aabb_init();
+  const bool has_bounds = tb_add_subtree_bounds(node, &bounds);
+  const bool too_big = has_bounds && (bounds.max.x - bounds.min.x > cell_size ||
+                                      bounds.max.z - bounds.min.z > cell_size);
+  if (node->children_count > 0 && (too_big || tb_has_global_node(node))) {
+    TbSceneCellNode entry = {.node = node};
+    TB_DYN_ARR_APPEND(split->resident->nodes, entry);
+    for (cgltf_size i = 0; i < node->children_count; ++i) {
+      tb_split_scene_node(split, node->children[i]);
+    }
+    return;
+  }
+
+  // Empty nodes and lights have no bounds and go where they are placed
+  float3 center = {0};
+  if (has_bounds) {
+    center = (bounds.min + bounds.max) * 0.5f;
+  } else {
+    float m[16] = {0};
+    cgltf_node_transform_world(node, m);
+    center = tb_f3(m[12], m[13], m[14]);
+  }
+  const int32_t x = (int32_t)SDL_floorf(center.x / cell_size);
+  const int32_t z = (int32_t)SDL_floorf(center.z / cell_size);
+
+  // A node that has a parent here was split off from it
+  TbSceneCellNode entry = {
+      .node = node,
+      .subtree = true,
+      .detached = node->parent != NULL,
+  };
+  TB_DYN_ARR_APPEND(split->nodes, entry);
+  TB_DYN_ARR_APPEND(split->keys, tb_scene_cell_key(x, z));
+}
+
+void tb_split_scene_cells(TbAllocator alloc, TbAllocator tmp_alloc,
+                          const cgltf_data *data, float cell_size,
+                          TbSceneCells *cells) {
+  TB_TRACY_SCOPE("Split Scene Cells");
+  TB_DYN_ARR_RESET(*cells, alloc, 16);
+
+  TbSceneCell resident = {.resident = true};
+  TB_DYN_ARR_RESET(resident.nodes, alloc, 16);
+
+  TbSceneCellSplit split = {.cell_size = cell_size, .resident = &resident};
+  TB_DYN_ARR_RESET(split.nodes, tmp_alloc, 64);
+  TB_DYN_ARR_RESET(split.keys, tmp_alloc, 64);
+
+  if (data && data->scenes_count > 0) {
+    tb_auto gltf_scene = &data->scenes[0];
+    for (cgltf_size i = 0; i < gltf_scene->nodes_count; ++i) {
+      tb_split_scene_node(&split, gltf_scene->nodes[i]);
+    }
+  }
+
+  // An empty cell would never finish loading
+  if (TB_DYN_ARR_EMPTY(resident.nodes)) {
+    TB_DYN_ARR_DESTROY(resident.nodes);
+  } else {
+    TB_DYN_ARR_APPEND(*cells, resident);
+  }
+
+  // The sort is stable so nodes keep their order within a cell
+  const uint32_t count = TB_DYN_ARR_SIZE(split.keys);
+  tb_auto order = tb_alloc_nm_tp(tmp_alloc, SDL_max(count, 1), uint32_t);
+  for (uint32_t i = 0; i < count; ++i) {
+    order[i] = i;
+  }
+  tb_radix_sort_u64(NULL, tmp_alloc, count, split.keys.data, order);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint64_t key = TB_DYN_ARR_AT(split.keys, i);
+    if (i == 0 || key != TB_DYN_ARR_AT(split.keys, i - 1)) {
+      TbSceneCell cell = {
+          .x = tb_scene_cell_coord((uint32_t)(key >> 32)),
+          .z = tb_scene_cell_coord((uint32_t)key),
+      };
+      TB_DYN_ARR_RESET(cell.nodes, alloc, 4);
+      TB_DYN_ARR_APPEND(*cells, cell);
+    }
+    tb_auto cell = TB_DYN_ARR_BACKPTR(*cells);
+    TB_DYN_ARR_APPEND(cell->nodes, TB_DYN_ARR_AT(split.nodes, order[i]));
+  }
+
+  tb_free(tmp_alloc, order);
+  TB_DYN_ARR_DESTROY(split.keys);
+  TB_DYN_ARR_DESTROY(split.nodes);
+}
+
+void tb_destroy_scene_cells(TbSceneCells *cells) {
+  TB_DYN_ARR_FOREACH(*cells, i) {
+    TB_DYN_ARR_DESTROY(TB_DYN_ARR_AT(*cells, i).nodes);
+  }
+  TB_DYN_ARR_DESTROY(*cells);
+}
+
+float tb_scene_cell_distance(const TbSceneCell *cell, float cell_size,
+                             float3 pos) {
+  const float min_x = (float)cell->x * cell_size;
+  const float min_z = (float)cell->z * cell_size;
+  const float dx =
+      SDL_max(SDL_max(min_x - pos.x, pos.x - (min_x + cell_size)), 0.0f);
+  const float dz =
+      SDL_max(SDL_max(min_z - pos.z, pos.z - (min_z + cell_size)), 0.0f);
+  return SDL_sqrtf(dx * dx + dz * dz);
+}
+
+void tb_plan_scene_cells(const TbSceneStreamDesc *desc,
+                         const TbSceneCells *cells, float3 origin,
+                         TbSceneCellPlan *plan) {
+  TB_TRACY_SCOPE("Plan Scene Cells");
+  TB_DYN_ARR_CLEAR(plan->loads);
+  TB_DYN_ARR_CLEAR(plan->unloads);
+  const float cell_size = desc->cell_size;
+
+  uint32_t loading_count = 0;
+  TB_DYN_ARR_FOREACH(*cells, i) {
+    tb_auto cell = &TB_DYN_ARR_AT(*cells, i);
+    if (cell->resident) {
+      if (cell->state == TB_SCENE_CELL_UNLOADED) {
+        TB_DYN_ARR_APPEND(plan->loads, (uint32_t)i);
+      }
+      continue;
+    }
+    if (cell->state == TB_SCENE_CELL_UNLOADED) {
+      continue;
+    }
+    // Cells unload further out than they load so that a camera moving
+    // along a cell's border doesn't load and unload it over and over.
+    // Cells the camera left before they were ready are abandoned
+    if (cell->state != TB_SCENE_CELL_PARSING &&
+        TB_DYN_ARR_SIZE(plan->unloads) < desc->max_unloads_per_frame &&
+        tb_scene_cell_distance(cell, cell_size, origin) >
+            desc->unload_radius) {
+      TB_DYN_ARR_APPEND(plan->unloads, (uint32_t)i);
+      continue;
+    }
+    if (cell->state != TB_SCENE_CELL_READY) {
+      loading_count++;
+    }
+  }
+
+  uint32_t budget = 0;
+  if (loading_count < desc->max_loading_cells) {
+    budget = SDL_min(desc->max_loads_per_frame,
+                     desc->max_loading_cells - loading_count);
+  }
+  if (budget == 0) {
+    return;
+  }
+
+  // Keeps the closest cells in range, nearest first
+  const uint32_t first = TB_DYN_ARR_SIZE(plan->loads);
+  TB_DYN_ARR_FOREACH(*cells, i) {
+    tb_auto cell = &TB_DYN_ARR_AT(*cells, i);
+    if (cell->resident || cell->state != TB_SCENE_CELL_UNLOADED) {
+      continue;
+    }
+    const float dist = tb_scene_cell_distance(cell, cell_size, origin);
+    if (dist > desc->load_radius) {
+      continue;
+    }
+    uint32_t slot = TB_DYN_ARR_SIZE(plan->loads);
+    if (slot - first == budget) {
+      const uint32_t last = *TB_DYN_ARR_BACKPTR(plan->loads);
+      tb_auto farthest = &TB_DYN_ARR_AT(*cells, last);
+      if (dist >= tb_scene_cell_distance(farthest, cell_size, origin)) {
+        continue;
+      }
+      slot--;
+    } else {
+      TB_DYN_ARR_APPEND(plan->loads, (uint32_t)i);
+    }
+    for (; slot > first; --slot) {
+      const uint32_t prev_idx = TB_DYN_ARR_AT(plan->loads, slot - 1);
+      tb_auto prev = &TB_DYN_ARR_AT(*cells, prev_idx);
+      if (tb_scene_cell_distance(prev, cell_size, origin) <= dist) {
+        break;
+      }
+      TB_DYN_ARR_AT(plan->loads, slot) = prev_idx;
+    }
+    TB_DYN_ARR_AT(plan->loads, slot) = (uint32_t)i;
+  }
+}
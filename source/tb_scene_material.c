@@ -3,6 +3,7 @@
 #include "tb_common.h"
 #include "tb_gltf.h"
 #include "tb_gltf.slangh"
+#include "tb_task_scheduler.h"
 #include "tb_texture_system.h"
 
 typedef struct TbSceneMaterial {
@@ -143,7 +144,7 @@ bool tb_parse_scene_mat(const cgltf_data *gltf_data, const char *name,
 }
 
 // Run in a task on the main thread
-void tb_load_scene_mat(ecs_world_t *ecs, void *mat_data) {
+void tb_load_scene_mat(ecs_world_t *ecs, TbMaterial mat, void *mat_data) {
   tb_auto scene_mat = (TbSceneMaterial *)mat_data;
   if (scene_mat == NULL) {
     return;
@@ -151,16 +152,19 @@ void tb_load_scene_mat(ecs_world_t *ecs, void *mat_data) {
 
   const cgltf_data *gltf_data = scene_mat->gltf_data;
   const char *name = scene_mat->name;
+  const TbLoadPriority priority = tb_get_load_priority(ecs, mat);
 
   tb_auto color = tb_get_default_color_tex(ecs);
   if ((scene_mat->data.perm & GLTF_PERM_BASE_COLOR_MAP) > 0) {
     color = tb_tex_sys_load_mat_tex(ecs, gltf_data, name, TB_TEX_USAGE_COLOR);
+    tb_raise_load_priority(ecs, color, priority);
   }
   scene_mat->color_map = color;
 
   tb_auto normal = tb_get_default_normal_tex(ecs);
   if ((scene_mat->data.perm & GLTF_PERM_NORMAL_MAP) > 0) {
     normal = tb_tex_sys_load_mat_tex(ecs, gltf_data, name, TB_TEX_USAGE_NORMAL);
+    tb_raise_load_priority(ecs, normal, priority);
   }
   scene_mat->normal_map = normal;
 
@@ -168,12 +172,26 @@ void tb_load_scene_mat(ecs_world_t *ecs, void *mat_data) {
   if ((scene_mat->data.perm & GLTF_PERM_PBR_METAL_ROUGH_TEX) > 0) {
     metal_rough =
         tb_tex_sys_load_mat_tex(ecs, gltf_data, name, TB_TEX_USAGE_METAL_ROUGH);
+    tb_raise_load_priority(ecs, metal_rough, priority);
   }
   scene_mat->metal_rough_map = metal_rough;
 
+  // The glb may be released after this
+  scene_mat->gltf_data = NULL;
   tb_free(tb_global_alloc, (void *)name);
 }
 
+void tb_unload_scene_mat(ecs_world_t *ecs, void *mat_data) {
+  tb_auto scene_mat = (TbSceneMaterial *)mat_data;
+  if (scene_mat == NULL) {
+    return;
+  }
+  // Defaults are owned by the texture system so releasing them is a no-op
+  tb_tex_sys_release_tex_ref(ecs, scene_mat->color_map);
+  tb_tex_sys_release_tex_ref(ecs, scene_mat->normal_map);
+  tb_tex_sys_release_tex_ref(ecs, scene_mat->metal_rough_map);
+}
+
 bool tb_is_scene_mat_ready(ecs_world_t *ecs, const TbMaterialData *data) {
   tb_auto scene_mat = (TbSceneMaterial *)data->domain_data;
   if (scene_mat == NULL) {
@@ -204,6 +222,14 @@ bool tb_is_scene_mat_trans(const TbMaterialData *data) {
   return perm & GLTF_PERM_ALPHA_CLIP || perm & GLTF_PERM_ALPHA_BLEND;
 }
 
+void tb_on_scene_mat_usage(ecs_world_t *ecs, void *mat_data,
+                           float screen_size) {
+  tb_auto scene_mat = (TbSceneMaterial *)mat_data;
+  tb_tex_sys_report_screen_size(ecs, scene_mat->color_map, screen_size);
+  tb_tex_sys_report_screen_size(ecs, scene_mat->normal_map, screen_size);
+  tb_tex_sys_report_screen_size(ecs, scene_mat->metal_rough_map, screen_size);
+}
+
 void tb_register_scene_material_domain(ecs_world_t *ecs) {
   TbSceneMaterial default_scene_mat = {
       .data =
@@ -219,10 +245,12 @@ void tb_register_scene_material_domain(ecs_world_t *ecs) {
   TbMaterialDomain domain = {
       .parse_fn = tb_parse_scene_mat,
       .load_fn = tb_load_scene_mat,
+      .unload_fn = tb_unload_scene_mat,
       .ready_fn = tb_is_scene_mat_ready,
       .get_data_fn = tb_get_scene_mat_data,
       .get_size_fn = tb_get_scene_mat_size,
       .is_trans_fn = tb_is_scene_mat_trans,
+      .usage_fn = tb_on_scene_mat_usage,
   };
 
   tb_register_mat_usage(ecs, "scene", TB_MAT_USAGE_SCENE, domain,
@@ -4,6 +4,9 @@
 #include "tb_fxaa.h"
 #include "tb_imgui.h"
 #include "tb_profiling.h"
+#include "tb_render_pipeline_system.h"
+#include "tb_render_target_system.h"
+#include "tb_texture_system.h"
 #include "tb_world.h"
 
 #include <flecs.h>
@@ -61,6 +64,15 @@ static const char *tb_fxaa_items[] = {
     "Off", "Low", "Medium", "High", "Custom",
 };
 
+static const int32_t tb_shadow_dims[] = {
+    TB_SHADOW_MAP_MIN_DIM, 1024, 2048, TB_SHADOW_MAP_DIM,
+};
+static const char *tb_shadow_dim_items[] = {
+    "512", "1024", "2048", "4096",
+};
+
+static int32_t tb_capture_frames = TB_PROF_DEFAULT_CAPTURE_FRAMES;
+
 void tick_settings_ui(ecs_iter_t *it) {
   TB_TRACY_SCOPE("Tick Settings UI");
   tb_auto ecs = it->world;
@@ -70,6 +82,98 @@ void tick_settings_ui(ecs_iter_t *it) {
     if (igBegin("Settings", settings->coreui, 0)) {
       tb_auto fxaa = ecs_singleton_ensure(ecs, TbFXAASystem);
 
+      igSliderFloat("LOD Bias", &settings->lod_bias, -2.0f, 4.0f, "%.2f", 0);
+
+      igSliderFloat("Texture Budget (MB)", &settings->tex_budget_mb, 64.0f,
+                    8192.0f, "%.0f", 0);
+      {
+        tb_auto stats = tb_tex_sys_get_stream_stats(ecs);
+        const float mb = 1.0f / (1024.0f * 1024.0f);
+        igText("Streamed Textures: %u (%u pending)", stats.texture_count,
+               stats.pending_count);
+        igText("Resident: %.1f MB of %.1f MB requested",
+               (float)stats.resident_bytes * mb,
+               (float)stats.requested_bytes * mb);
+        igText("Mip Bias: %u", stats.mip_bias);
+      }
+
+      {
+        igSliderFloat("Resolution Scale", &settings->resolution_scale,
+                      TB_DYN_RES_DEFAULT_MIN_SCALE, 1.0f, "%.2f", 0);
+        igCheckbox("Dynamic Resolution", &settings->dynamic_resolution);
+        if (settings->dynamic_resolution) {
+          igSliderFloat("GPU Budget (ms)", &settings->gpu_budget_ms, 4.0f,
+                        33.3f, "%.1f", 0);
+        }
+        tb_auto rp_sys = ecs_singleton_get(ecs, TbRenderPipelineSystem);
+        if (rp_sys) {
+          igText("Render Scale: %.2f (GPU %.2f ms)", rp_sys->render_scale,
+                 rp_sys->gpu_ms);
+        }
+      }
+
+      if (igCollapsingHeader_TreeNodeFlags("GPU Pass Timings", 0)) {
+        tb_auto rp_sys = ecs_singleton_ensure(ecs, TbRenderPipelineSystem);
+        if (igButton("Dump CSV", (ImVec2){0})) {
+          tb_render_pipeline_write_timings_csv(rp_sys, "./pass_timings.csv");
+        }
+        tb_auto timings = tb_alloc_nm_tp(rp_sys->tmp_alloc,
+                                         rp_sys->live_pass_count, TbPassTiming);
+        const uint32_t count =
+            tb_render_pipeline_get_pass_timings(rp_sys, timings);
+        tb_auto table_flags = ImGuiTableFlags_BordersInner |
+                              ImGuiTableFlags_RowBg |
+                              ImGuiTableFlags_SizingFixedFit;
+        if (igBeginTable("##pass_timings", 3, table_flags, (ImVec2){0}, 0)) {
+          igTableSetupColumn("Pass", 0, 0, 0);
+          igTableSetupColumn("GPU (ms)", 0, 0, 1);
+          igTableSetupColumn("Record (ms)", 0, 0, 2);
+          igTableHeadersRow();
+          for (uint32_t i = 0; i < count; ++i) {
+            igTableNextRow(0, 0);
+            igTableNextColumn();
+            igText("%s", timings[i].name);
+            igTableNextColumn();
+            igText("%.3f", timings[i].gpu_ms);
+            igTableNextColumn();
+            igText("%.3f", timings[i].record_ms);
+          }
+          igEndTable();
+        }
+      }
+
+      if (igCollapsingHeader_TreeNodeFlags("CPU Capture", 0)) {
+        igSliderInt("Frames", &tb_capture_frames, 1, 120, "%d", 0);
+        if (tb_prof_capturing()) {
+          igText("Capturing...");
+        } else if (igButton("Capture", (ImVec2){0})) {
+          tb_prof_request_capture((uint32_t)tb_capture_frames,
+                                  TB_PROF_DEFAULT_CAPTURE_PATH);
+        }
+        tb_auto info = tb_prof_last_capture();
+        if (info.frames > 0) {
+          igText("Last: %u events on %u threads over %u frames (%u dropped)",
+                 info.events, info.threads, info.frames, info.dropped);
+        }
+      }
+
+      {
+        int32_t dim_option = 0;
+        for (int32_t i = 0; i < 4; ++i) {
+          if (tb_shadow_dims[i] == settings->shadow_map_dim) {
+            dim_option = i;
+          }
+        }
+        if (igCombo_Str_arr("Shadow Map Size", &dim_option,
+                            tb_shadow_dim_items, 4, 4)) {
+          settings->shadow_map_dim = tb_shadow_dims[dim_option];
+        }
+        igSliderInt("Shadow Cascades", &settings->cascade_count, 1,
+                    TB_CASCADE_COUNT, "%d", 0);
+        igSliderFloat("Cascade Split Lambda", &settings->cascade_split_lambda,
+                      0.0f, 1.0f, "%.2f", 0);
+      }
+
       if (igCombo_Str_arr("FXAA", &settings->fxaa_option, tb_fxaa_items, 5,
                           5)) {
         fxaa->settings = tb_fxaa_options[settings->fxaa_option];
@@ -115,6 +219,12 @@ void tb_register_settings_sys(TbWorld *world) {
   // TODO: Apply saved settings loaded from disk
   settings.fxaa_option = 1;
   settings.fxaa = tb_fxaa_options[settings.fxaa_option];
+  settings.tex_budget_mb = TB_TEX_STREAM_DEFAULT_BUDGET_MB;
+  settings.resolution_scale = 1.0f;
+  settings.gpu_budget_ms = TB_DYN_RES_DEFAULT_TARGET_MS;
+  settings.shadow_map_dim = TB_SHADOW_MAP_DIM;
+  settings.cascade_count = TB_CASCADE_COUNT;
+  settings.cascade_split_lambda = TB_CASCADE_SPLIT_LAMBDA;
 
   // HACK: This puts a soft dependency on initialization order.
   // Assuming this function will be called after the fxaa system is already
@@ -0,0 +1,31 @@
+#include "tb_shadow_cascades.h"
+
+#include "tb_common.h"
+
+TbCascadeSettings tb_clamp_cascade_settings(int32_t map_dim,
+                                            int32_t cascade_count,
+                                            float split_lambda) {
+  // NaN fails every comparison so SDL_clamp would pass it straight through
+  if (SDL_isnanf(split_lambda)) {
+    split_lambda = TB_CASCADE_SPLIT_LAMBDA;
+  }
+  return (TbCascadeSettings){
+      .map_dim = (uint32_t)SDL_clamp(map_dim, TB_SHADOW_MAP_MIN_DIM,
+                                     TB_SHADOW_MAP_DIM),
+      .cascade_count = (uint32_t)SDL_clamp(cascade_count, 1, TB_CASCADE_COUNT),
+      .split_lambda = SDL_clamp(split_lambda, 0.0f, 1.0f),
+  };
+}
+
+void tb_calc_cascade_splits(float near, float far, uint32_t cascade_count,
+                            float split_lambda, float *splits) {
+  const float range = far - near;
+  const float ratio = far / near;
+  for (uint32_t i = 0; i < cascade_count; i++) {
+    const float p = (float)(i + 1) / (float)cascade_count;
+    const float log = near * SDL_powf(ratio, p);
+    const float uniform = near + range * p;
+    const float d = split_lambda * (log - uniform) + uniform;
+    splits[i] = (d - near) / range;
+  }
+}
@@ -1,5 +1,6 @@
 #include "tb_camera_component.h"
 #include "tb_common.h"
+#include "tb_frame_stats.h"
 #include "tb_light_component.h"
 #include "tb_mesh_component.h"
 #include "tb_mesh_rnd_sys.h"
@@ -9,6 +10,8 @@
 #include "tb_render_object_system.h"
 #include "tb_render_pipeline_system.h"
 #include "tb_render_target_system.h"
+#include "tb_render_thread.h"
+#include "tb_settings.h"
 #include "tb_shader_system.h"
 #include "tb_transform_component.h"
 #include "tb_view_system.h"
@@ -36,6 +39,11 @@ typedef struct TbShadowSystem {
 
   ecs_query_t *dir_light_query;
   TbFrameDescriptorPoolList desc_pool_list;
+
+  // Shadow settings currently in effect
+  uint32_t map_dim;
+  uint32_t cascade_count;
+  float split_lambda;
 } TbShadowSystem;
 ECS_COMPONENT_DECLARE(TbShadowSystem);
 
@@ -211,6 +219,7 @@ void shadow_pass_record(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
       tb_auto draw = &((const TbIndirectDraw *)batch->draws)[draw_idx];
       vkCmdDrawIndirect(buffer, draw->buffer, draw->offset, draw->draw_count,
                         draw->stride);
+      tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, draw->draw_count);
     }
 
     cmd_end_label(buffer);
@@ -219,6 +228,43 @@ void shadow_pass_record(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
   TracyCVkZoneEnd(frame_scope);
 }
 
+// Picks up shadow settings. Only a resolution change touches GPU resources;
+// the cascade count and split lambda are read by the next update
+void shadow_settings_tick(ecs_iter_t *it) {
+  TB_TRACY_SCOPEC("Shadow Settings", TracyCategoryColorCore);
+  ecs_world_t *ecs = it->world;
+
+  tb_auto shadow_sys = ecs_field(it, TbShadowSystem, 0);
+  tb_auto settings = ecs_singleton_get(ecs, TbSettings);
+  if (!settings) {
+    return;
+  }
+
+  const TbCascadeSettings clamped =
+      tb_clamp_cascade_settings(settings->shadow_map_dim,
+                                settings->cascade_count,
+                                settings->cascade_split_lambda);
+  shadow_sys->cascade_count = clamped.cascade_count;
+  shadow_sys->split_lambda = clamped.split_lambda;
+
+  const uint32_t dim = clamped.map_dim;
+  if (dim == shadow_sys->map_dim) {
+    return;
+  }
+
+  // Only the shadow map and the passes that render to it are re-created. The
+  // shadow pipeline uses a dynamic viewport so it can stay as is
+  tb_auto rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem);
+  tb_auto rp_sys = ecs_singleton_ensure(ecs, TbRenderPipelineSystem);
+  tb_auto rt_sys = rp_sys->rt_sys;
+  // Every frame state has its own shadow map so none may be in flight
+  tb_wait_render_idle(rnd_sys->render_thread, rnd_sys->frame_idx);
+  tb_resize_render_target(rt_sys, rt_sys->shadow_map,
+                          (VkExtent3D){dim, dim, 1});
+  tb_render_pipeline_reimport_targets(rp_sys);
+  shadow_sys->map_dim = dim;
+}
+
 void shadow_update_tick(ecs_iter_t *it) {
   TB_TRACY_SCOPEC("Shadow System Update", TracyCategoryColorCore);
   ecs_world_t *ecs = it->world;
@@ -248,27 +294,11 @@ void shadow_update_tick(ecs_iter_t *it) {
       inv_cam_vp = tb_invf44(tb_mulf44f44(proj, view));
     }
 
-    const float cascade_split_lambda = 0.95f;
+    const float clip_range = far - near;
+    const uint32_t cascade_count = shadow_sys->cascade_count;
     float cascade_splits[TB_CASCADE_COUNT] = {0};
-
-    float clip_range = far - near;
-
-    float min_z = near;
-    float max_z = near + clip_range;
-
-    float range = max_z - min_z;
-    float ratio = max_z / min_z;
-
-    // Calculate split depths based on view camera frustum
-    // Based on method presented in
-    // https://developer.nvidia.com/gpugems/GPUGems3/gpugems3_ch10.html
-    for (uint32_t i = 0; i < TB_CASCADE_COUNT; i++) {
-      float p = (i + 1) / (float)TB_CASCADE_COUNT;
-      float log = min_z * SDL_powf(ratio, p);
-      float uniform = min_z + range * p;
-      float d = cascade_split_lambda * (log - uniform) + uniform;
-      cascade_splits[i] = (d - near) / clip_range;
-    }
+    tb_calc_cascade_splits(near, far, cascade_count, shadow_sys->split_lambda,
+                           cascade_splits);
 
     ecs_iter_t light_it = ecs_query_iter(ecs, shadow_sys->dir_light_query);
     while (ecs_query_next(&light_it)) {
@@ -283,8 +313,12 @@ void shadow_update_tick(ecs_iter_t *it) {
             .view_pos = transform.position,
         };
 
+        // Unused cascades end at the far plane
+        light->cascade_count = cascade_count;
+        light->cascade_splits = (float4){-far, -far, -far, -far};
+
         float last_split_dist = 0.0f;
-        for (uint32_t cascade_idx = 0; cascade_idx < TB_CASCADE_COUNT;
+        for (uint32_t cascade_idx = 0; cascade_idx < cascade_count;
              ++cascade_idx) {
           float split_dist = cascade_splits[cascade_idx];
 
@@ -378,7 +412,7 @@ void shadow_draw_tick(ecs_iter_t *it) {
   }
 
   // The shadow batch is just the opaque batch but with a different pipeline
-  if (!mesh_sys->opaque_batch) {
+  if (!mesh_sys->shadow_batch) {
     return;
   }
 
@@ -390,8 +424,8 @@ void shadow_draw_tick(ecs_iter_t *it) {
     for (int32_t light_idx = 0; light_idx < light_it.count; ++light_idx) {
       TB_TRACY_SCOPE("Submit Batches");
       const TbDirectionalLightComponent *light = &lights[light_idx];
-      // Submit batch for each shadow cascade
-      for (uint32_t cascade_idx = 0; cascade_idx < TB_CASCADE_COUNT;
+      // Submit batch for each shadow cascade in use
+      for (uint32_t cascade_idx = 0; cascade_idx < light->cascade_count;
            ++cascade_idx) {
         tb_auto view_id = light->cascade_views[cascade_idx];
 
@@ -409,13 +443,19 @@ void shadow_draw_tick(ecs_iter_t *it) {
         }
 #endif
 
-        // Must perform the above check before we try to access the opaque batch
-        TbDrawBatch shadow_batch = *mesh_sys->opaque_batch;
+        // Only draw what the mesh system found inside this cascade
+        tb_auto cascade_draw = tb_mesh_sys_get_shadow_draw(mesh_sys, view_id);
+        if (!cascade_draw) {
+          continue;
+        }
+
+        TbDrawBatch shadow_batch = *mesh_sys->shadow_batch;
         tb_auto shadow_prim_batch =
             *(TbPrimitiveBatch *)shadow_batch.user_batch;
         shadow_batch.pipeline = shadow_sys->pipeline;
         shadow_batch.layout = shadow_sys->pipe_layout;
         shadow_batch.user_batch = &shadow_prim_batch;
+        shadow_batch.draws = (TbIndirectDraw *)cascade_draw;
 
         tb_auto batch = &shadow_batch;
         tb_auto prim_batch = (TbPrimitiveBatch *)batch->user_batch;
@@ -425,7 +465,7 @@ void shadow_draw_tick(ecs_iter_t *it) {
 #else
         prim_batch->view_set = view_set;
 #endif
-        const float dim = TB_SHADOW_MAP_DIM;
+        const float dim = (float)shadow_sys->map_dim;
         batch->viewport = (VkViewport){0, 0, dim, dim, 0, 1};
         batch->scissor = (VkRect2D){{0, 0}, {dim, dim}};
 
@@ -435,8 +475,8 @@ void shadow_draw_tick(ecs_iter_t *it) {
     }
   }
 
-  // The opaque batch has been consumed and invalidated
-  mesh_sys->opaque_batch = NULL;
+  // The shadow batch has been consumed and invalidated
+  mesh_sys->shadow_batch = NULL;
 }
 
 void tb_register_shadow_sys(TbWorld *world) {
@@ -454,6 +494,9 @@ void tb_register_shadow_sys(TbWorld *world) {
   TbShadowSystem sys = {
       .gp_alloc = world->gp_alloc,
       .tmp_alloc = world->tmp_alloc,
+      .map_dim = TB_SHADOW_MAP_DIM,
+      .cascade_count = TB_CASCADE_COUNT,
+      .split_lambda = TB_CASCADE_SPLIT_LAMBDA,
       .dir_light_query =
           ecs_query(ecs,
                     {
@@ -518,6 +561,7 @@ void tb_register_shadow_sys(TbWorld *world) {
   // Sets a singleton by ptr
   ecs_set_ptr(ecs, ecs_id(TbShadowSystem), TbShadowSystem, &sys);
 
+  ECS_SYSTEM(ecs, shadow_settings_tick, EcsOnUpdate, TbShadowSystem($));
   ECS_SYSTEM(ecs, shadow_update_tick, EcsOnUpdate, TbCameraComponent);
   ECS_SYSTEM(ecs, shadow_draw_tick, EcsOnStore, TbShadowSystem($));
 }
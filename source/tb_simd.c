@@ -722,6 +722,11 @@ TbFrustum tb_frustum_from_view_proj(const float4x4 *vp) {
   return f;
 }
 
+void tb_frustum_disable_plane(TbFrustum *frust, TbFrustumPlane plane) {
+  // Every point is at distance 1 in front of a plane with no normal
+  frust->planes[plane] = (TbPlane){.xyzw = {0, 0, 0, 1}};
+}
+
 bool tb_frustum_test_aabb(const TbFrustum *frust, const TbAABB *aabb) {
   // See
   // https://www.braynzarsoft.net/viewtutorial/q16390-34-aabb-cpu-side-frustum-culling
@@ -745,6 +750,19 @@ bool tb_frustum_test_aabb(const TbFrustum *frust, const TbAABB *aabb) {
   return true;
 }
 
+bool tb_frustum_test_sphere(const TbFrustum *frust, float3 center,
+                            float radius) {
+  // Planes are normalized so this is the signed distance to each plane
+  for (uint32_t i = 0; i < FrustumPlaneCount; ++i) {
+    const TbPlane *plane = &frust->planes[i];
+    const float3 normal = (float3){plane->xyzw.x, plane->xyzw.y, plane->xyzw.z};
+    if (tb_dotf3(normal, center) + plane->xyzw.w < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
 float tb_deg_to_rad(float d) { return d * (M_PI / 180.0f); }
 float tb_rad_to_deg(float r) { return r * (180 / M_PI); }
 
@@ -16,6 +16,7 @@
 #include "tb_camera_component.h"
 #include "tb_common.h"
 #include "tb_common.slangh"
+#include "tb_frame_stats.h"
 #include "tb_light_component.h"
 #include "tb_profiling.h"
 #include "tb_render_pipeline_system.h"
@@ -682,6 +683,7 @@ void record_sky_common(VkCommandBuffer buffer, uint32_t batch_count,
     vkCmdBindVertexBuffers(buffer, 0, 1, &sky_batch->geom_buffer,
                            &sky_batch->vertex_offset);
     vkCmdDrawIndexed(buffer, sky_batch->index_count, 1, 0, 0, 0);
+    tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, 1);
   }
 }
 
@@ -752,6 +754,7 @@ void record_irradiance(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
     vkCmdBindVertexBuffers(buffer, 0, 1, &irr_batch->geom_buffer,
                            &irr_batch->vertex_offset);
     vkCmdDrawIndexed(buffer, irr_batch->index_count, 1, 0, 0, 0);
+    tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, 1);
   }
 
   cmd_end_label(buffer);
@@ -794,6 +797,7 @@ void record_env_filter(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
     vkCmdSetScissor(buffer, 0, 1, &batch->scissor);
 
     vkCmdDrawIndexed(buffer, pre_batch->index_count, 1, 0, 0, 0);
+    tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, 1);
   }
 
   cmd_end_label(buffer);
@@ -0,0 +1,170 @@
+#include "tb_sort.h"
+
+#include "tb_common.h"
+#include "tb_profiling.h"
+
+#include <TaskScheduler_c.h>
+
+#define TB_RADIX_DIGIT_BITS 8
+#define TB_RADIX_BUCKET_COUNT (1 << TB_RADIX_DIGIT_BITS)
+#define TB_RADIX_DIGIT_MASK (TB_RADIX_BUCKET_COUNT - 1)
+#define TB_RADIX_PASS_COUNT (64 / TB_RADIX_DIGIT_BITS)
+#define TB_RADIX_MAX_CHUNKS 64
+
+typedef uint32_t TbRadixHistogram[TB_RADIX_BUCKET_COUNT];
+
+typedef struct TbRadixSortCtx {
+  uint32_t count;
+  uint32_t chunk_count;
+  uint32_t chunk_size;
+  uint32_t shift;
+  const uint64_t *src_keys;
+  const uint32_t *src_vals;
+  uint64_t *dst_keys;
+  uint32_t *dst_vals;
+  // One histogram per chunk. Turned into scatter offsets before the scatter
+  TbRadixHistogram *histograms;
+} TbRadixSortCtx;
+
+static uint32_t tb_radix_digit(uint64_t key, uint32_t shift) {
+  return (uint32_t)(key >> shift) & TB_RADIX_DIGIT_MASK;
+}
+
+static void tb_radix_histogram_chunk(TbRadixSortCtx *ctx, uint32_t chunk) {
+  tb_auto hist = ctx->histograms[chunk];
+  SDL_memset(hist, 0, sizeof(TbRadixHistogram));
+
+  const uint32_t begin = chunk * ctx->chunk_size;
+  const uint32_t end = SDL_min(begin + ctx->chunk_size, ctx->count);
+  for (uint32_t i = begin; i < end; ++i) {
+    hist[tb_radix_digit(ctx->src_keys[i], ctx->shift)]++;
+  }
+}
+
+static void tb_radix_scatter_chunk(TbRadixSortCtx *ctx, uint32_t chunk) {
+  tb_auto offsets = ctx->histograms[chunk];
+
+  const uint32_t begin = chunk * ctx->chunk_size;
+  const uint32_t end = SDL_min(begin + ctx->chunk_size, ctx->count);
+  for (uint32_t i = begin; i < end; ++i) {
+    const uint64_t key = ctx->src_keys[i];
+    const uint32_t dst = offsets[tb_radix_digit(key, ctx->shift)]++;
+    ctx->dst_keys[dst] = key;
+    ctx->dst_vals[dst] = ctx->src_vals[i];
+  }
+}
+
+static void tb_radix_histogram_task(uint32_t start, uint32_t end,
+                                    uint32_t threadnum, void *args) {
+  TB_TRACY_SCOPE("Radix Histogram");
+  (void)threadnum;
+  for (uint32_t chunk = start; chunk < end; ++chunk) {
+    tb_radix_histogram_chunk((TbRadixSortCtx *)args, chunk);
+  }
+}
+
+static void tb_radix_scatter_task(uint32_t start, uint32_t end,
+                                  uint32_t threadnum, void *args) {
+  TB_TRACY_SCOPE("Radix Scatter");
+  (void)threadnum;
+  for (uint32_t chunk = start; chunk < end; ++chunk) {
+    tb_radix_scatter_chunk((TbRadixSortCtx *)args, chunk);
+  }
+}
+
+// Runs the task over every chunk; inline when there is no task to go wide on
+static void tb_radix_run(TbTaskScheduler enki, TbTask task, TbAsyncFn2 fn,
+                         TbRadixSortCtx *ctx) {
+  if (task == NULL) {
+    fn(0, ctx->chunk_count, 0, ctx);
+    return;
+  }
+  struct enkiParamsTaskSet params = enkiGetParamsTaskSet(task);
+  params.pArgs = ctx;
+  params.setSize = ctx->chunk_count;
+  params.minRange = 1;
+  enkiSetParamsTaskSet(task, params);
+  enkiAddTaskSet(enki, task);
+  tb_wait_task(enki, task);
+}
+
+void tb_radix_sort_u64(TbTaskScheduler enki, TbAllocator tmp_alloc,
+                       uint32_t count, uint64_t *keys, uint32_t *values) {
+  TB_TRACY_SCOPEC("Radix Sort", TracyCategoryColorCore);
+  if (count < 2) {
+    return;
+  }
+
+  // Only go wide when there is enough work to pay for the task overhead
+  uint32_t chunk_count = 1;
+  if (enki != NULL && count >= TB_RADIX_SORT_PARALLEL_MIN) {
+    chunk_count = enkiGetNumTaskThreads(enki) * 2;
+    chunk_count = SDL_clamp(chunk_count, 1u, TB_RADIX_MAX_CHUNKS);
+  }
+
+  TbRadixSortCtx ctx = {
+      .count = count,
+      .chunk_count = chunk_count,
+      .chunk_size = (count + chunk_count - 1) / chunk_count,
+      .src_keys = keys,
+      .src_vals = values,
+      .dst_keys = tb_alloc_nm_tp(tmp_alloc, count, uint64_t),
+      .dst_vals = tb_alloc_nm_tp(tmp_alloc, count, uint32_t),
+      .histograms = tb_alloc_nm_tp(tmp_alloc, chunk_count, TbRadixHistogram),
+  };
+
+  TbTask hist_task = NULL;
+  TbTask scatter_task = NULL;
+  if (chunk_count > 1) {
+    hist_task = tb_create_task2(enki, tb_radix_histogram_task, &ctx);
+    scatter_task = tb_create_task2(enki, tb_radix_scatter_task, &ctx);
+  }
+
+  for (uint32_t pass = 0; pass < TB_RADIX_PASS_COUNT; ++pass) {
+    ctx.shift = pass * TB_RADIX_DIGIT_BITS;
+
+    tb_radix_run(enki, hist_task, tb_radix_histogram_task, &ctx);
+
+    // Exclusive scan over buckets and then chunks so that each chunk scatters
+    // into its own stable sub-range of every bucket
+    uint32_t offset = 0;
+    bool trivial = false;
+    for (uint32_t bucket = 0; bucket < TB_RADIX_BUCKET_COUNT; ++bucket) {
+      const uint32_t bucket_start = offset;
+      for (uint32_t chunk = 0; chunk < chunk_count; ++chunk) {
+        const uint32_t bucket_count = ctx.histograms[chunk][bucket];
+        ctx.histograms[chunk][bucket] = offset;
+        offset += bucket_count;
+      }
+      // Every key shares this digit so the pass would be a plain copy
+      if (offset - bucket_start == count) {
+        trivial = true;
+        break;
+      }
+    }
+    if (trivial) {
+      continue;
+    }
+
+    tb_radix_run(enki, scatter_task, tb_radix_scatter_task, &ctx);
+
+    // Ping-pong between the caller's arrays and the scratch arrays
+    tb_auto next_keys = (uint64_t *)ctx.src_keys;
+    tb_auto next_vals = (uint32_t *)ctx.src_vals;
+    ctx.src_keys = ctx.dst_keys;
+    ctx.src_vals = ctx.dst_vals;
+    ctx.dst_keys = next_keys;
+    ctx.dst_vals = next_vals;
+  }
+
+  // Results may have ended up in scratch memory after an odd number of passes
+  if (ctx.src_keys != keys) {
+    SDL_memcpy(keys, ctx.src_keys, sizeof(uint64_t) * count); // NOLINT
+    SDL_memcpy(values, ctx.src_vals, sizeof(uint32_t) * count); // NOLINT
+  }
+
+  if (hist_task) {
+    enkiDeleteTaskSet(enki, hist_task);
+    enkiDeleteTaskSet(enki, scatter_task);
+  }
+}
@@ -1,6 +1,7 @@
 #include "tb_task_scheduler.h"
 
 #include "tb_common.h"
+#include "tb_sort.h"
 #include "tb_system_priority.h"
 #include "tb_world.h"
 
@@ -22,6 +23,7 @@ void tb_ts_free(void *ptr) {
 ECS_COMPONENT_DECLARE(TbTask);
 ECS_COMPONENT_DECLARE(TbPinnedTask);
 ECS_COMPONENT_DECLARE(TbTaskScheduler);
+ECS_COMPONENT_DECLARE(TbLoadPriority);
 
 typedef struct TbAsyncTaskArgs {
   TbAsyncFn fn;
@@ -127,6 +129,7 @@ void tb_launch_task2(TbTaskScheduler enki, TbTask task, void *args) {
 TbTask tb_async_task(TbTaskScheduler enki, TbAsyncFn fn, void *args,
                      size_t args_size) {
   TbTask task = tb_create_task(enki, fn, args, args_size);
+  tb_set_task_priority(task, TB_TASK_PRIORITY_LOW);
   tb_launch_task(enki, task);
   return task;
 }
@@ -169,6 +172,12 @@ void tb_run_pinned_tasks(ecs_iter_t *it) {
   enkiRunPinnedTasks(enki);
 }
 
+void tb_set_task_priority(TbTask task, TbTaskPriority priority) {
+  struct enkiParamsTaskSet params = enkiGetParamsTaskSet(task);
+  params.priority = (int32_t)priority;
+  enkiSetParamsTaskSet(task, params);
+}
+
 void tb_wait_task(TbTaskScheduler enki, enkiTaskSet *task) {
   if (!enkiIsTaskSetComplete(enki, task)) {
     TB_TRACY_SCOPEC("Wait for Task", TracyCategoryColorWait);
@@ -176,6 +185,14 @@ void tb_wait_task(TbTaskScheduler enki, enkiTaskSet *task) {
   }
 }
 
+void tb_wait_task_priority(TbTaskScheduler enki, TbTask task,
+                           TbTaskPriority priority) {
+  if (!enkiIsTaskSetComplete(enki, task)) {
+    TB_TRACY_SCOPEC("Wait for Task", TracyCategoryColorWait);
+    enkiWaitForTaskSetPriority(enki, task, (int32_t)priority);
+  }
+}
+
 void tb_wait_pinned_task(TbTaskScheduler enki, enkiPinnedTask *task) {
   if (!enkiIsPinnedTaskComplete(enki, task)) {
     TB_TRACY_SCOPEC("Wait for Pinned Task", TracyCategoryColorWait);
@@ -183,15 +200,79 @@ void tb_wait_pinned_task(TbTaskScheduler enki, enkiPinnedTask *task) {
   }
 }
 
+void tb_task_thread_start(uint32_t threadnum) {
+  (void)threadnum;
+  tb_prof_set_thread_name("Task Worker");
+}
+
+TbLoadPriority tb_get_load_priority(ecs_world_t *ecs, ecs_entity_t ent) {
+  tb_auto priority = ecs_get(ecs, ent, TbLoadPriority);
+  return priority ? *priority : 0.0f;
+}
+
+void tb_raise_load_priority(ecs_world_t *ecs, ecs_entity_t ent,
+                            TbLoadPriority priority) {
+  if (tb_get_load_priority(ecs, ent) < priority) {
+    ecs_set(ecs, ent, TbLoadPriority, {priority});
+  }
+}
+
+uint32_t *tb_sort_load_queue(TbTaskScheduler enki, TbAllocator tmp_alloc,
+                             const TbLoadQueue *queue) {
+  TB_TRACY_SCOPE("Sort Load Queue");
+  const uint32_t count = TB_DYN_ARR_SIZE(*queue);
+  tb_auto order = tb_alloc_nm_tp(tmp_alloc, SDL_max(count, 1), uint32_t);
+  tb_auto keys = tb_alloc_nm_tp(tmp_alloc, SDL_max(count, 1), uint64_t);
+  for (uint32_t i = 0; i < count; ++i) {
+    // Flip the float's bits so they compare like unsigned integers and then
+    // invert them so that the highest priority sorts first
+    uint32_t bits = 0;
+    tb_auto priority = TB_DYN_ARR_AT(*queue, i).priority;
+    SDL_memcpy(&bits, &priority, sizeof(uint32_t)); // NOLINT
+    bits = (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+    keys[i] = ~bits;
+    order[i] = i;
+  }
+  tb_radix_sort_u64(enki, tmp_alloc, count, keys, order);
+  return order;
+}
+
+TbLoadDispatch tb_plan_load_dispatch(TbTaskScheduler enki,
+                                     TbAllocator tmp_alloc,
+                                     const TbLoadQueue *queue,
+                                     uint32_t slot_count) {
+  const uint32_t count = TB_DYN_ARR_SIZE(*queue);
+  TbLoadDispatch dispatch = {
+      .order = tb_sort_load_queue(enki, tmp_alloc, queue),
+      .dropped = tb_alloc_nm_tp(tmp_alloc, SDL_max(count, 1), uint32_t),
+  };
+  // Dispatched entries are compacted to the front of the sorted order
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint32_t idx = dispatch.order[i];
+    if (TB_DYN_ARR_AT(*queue, idx).cancelled) {
+      dispatch.dropped[dispatch.dropped_count++] = idx;
+    } else if (dispatch.count < slot_count) {
+      dispatch.order[dispatch.count++] = idx;
+    }
+  }
+  return dispatch;
+}
+
 void tb_register_task_scheduler_sys(TbWorld *world) {
   TB_TRACY_SCOPE("Register Task Scheduler Sys");
   ECS_COMPONENT_DEFINE(world->ecs, TbTask);
   ECS_COMPONENT_DEFINE(world->ecs, TbPinnedTask);
   ECS_COMPONENT_DEFINE(world->ecs, TbTaskScheduler);
+  ECS_COMPONENT_DEFINE(world->ecs, TbLoadPriority);
 
   tb_auto ecs = world->ecs;
   tb_auto enki = enkiNewTaskScheduler();
-  enkiInitTaskScheduler(enki);
+  // The render thread launches tasks of its own to record passes
+  struct enkiTaskSchedulerConfig config = enkiGetTaskSchedulerConfig(enki);
+  config.numExternalTaskThreads = 1;
+  // Name worker threads so that they are recognizable in CPU captures
+  config.profilerCallbacks.threadStart = tb_task_thread_start;
+  enkiInitTaskSchedulerWithConfig(enki, config);
 
   ecs_singleton_set(ecs, TbTaskScheduler, {enki});
 
@@ -0,0 +1,47 @@
+#include "tb_tex_budget.h"
+
+#include "tb_common.h"
+
+static uint32_t tb_tex_budget_level(const TbTexBudgetRequest *request,
+                                    uint32_t bias) {
+  return SDL_min(request->requested_mip + bias, request->min_mip);
+}
+
+static uint64_t tb_tex_budget_total(uint32_t count,
+                                    const TbTexBudgetRequest *requests,
+                                    uint32_t bias) {
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    total += requests[i].mips_size[tb_tex_budget_level(&requests[i], bias)];
+  }
+  return total;
+}
+
+TbTexBudgetSolution tb_solve_tex_budget(uint32_t count,
+                                        const TbTexBudgetRequest *requests,
+                                        uint64_t budget, uint32_t *levels) {
+  TB_TRACY_SCOPE("Solve Texture Budget");
+  // Past this bias every request is at its min mip
+  uint32_t max_bias = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    tb_auto request = &requests[i];
+    if (request->min_mip > request->requested_mip) {
+      max_bias = SDL_max(max_bias, request->min_mip - request->requested_mip);
+    }
+  }
+
+  TbTexBudgetSolution solution = {
+      .requested_bytes = tb_tex_budget_total(count, requests, 0),
+  };
+  solution.solved_bytes = solution.requested_bytes;
+  while (solution.solved_bytes > budget && solution.bias < max_bias) {
+    solution.bias++;
+    solution.solved_bytes =
+        tb_tex_budget_total(count, requests, solution.bias);
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+    levels[i] = tb_tex_budget_level(&requests[i], solution.bias);
+  }
+  return solution;
+}
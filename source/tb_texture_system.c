@@ -4,15 +4,34 @@
 #include "tb_common.h"
 #include "tb_descriptor_buffer.h"
 #include "tb_dyn_desc_pool.h"
+#include "tb_frame_stats.h"
 #include "tb_gltf.h"
+#include "tb_hash.h"
 #include "tb_ktx.h"
 #include "tb_queue.h"
+#include "tb_settings.h"
 #include "tb_task_scheduler.h"
+#include "tb_tex_budget.h"
+#include "tb_transcode_cache.h"
 #include "tb_world.h"
 
 static const int32_t TbMaxParallelTextureLoads = 128;
 static SDL_AtomicInt tb_parallel_tex_load_count = {0};
 
+// Basis textures are transcoded once and then cached on disk, next to the
+// pipeline cache, by a hash of their source data and the target format
+#define TB_TRANSCODE_CACHE_DIR "./transcode_cache"
+// TODO: pre-calculate the best format for the platform
+static const ktx_transcode_fmt_e TbTranscodeTarget = KTX_TTF_BC7_RGBA;
+
+// Streamed textures always keep the mips at or below this size resident
+#define TB_TEX_STREAM_MIN_SIZE 128
+// A streamed texture that nothing has reported a size for in this many frames
+// falls back to its always resident mips
+#define TB_TEX_STREAM_IDLE_FRAMES 120
+// Caps how many bytes of mips are uploaded by streaming each frame
+#define TB_TEX_STREAM_UPLOAD_BUDGET (32ull * 1024ull * 1024ull)
+
 ECS_COMPONENT_DECLARE(TbTextureUsage);
 
 typedef struct TbTextureCtx {
@@ -26,6 +45,12 @@ typedef struct TbTextureCtx {
   TbTexture default_normal_tex;
   TbTexture default_metal_rough_tex;
   TbTexture brdf_tex;
+
+  ecs_query_t *gltf_load_query;
+
+  ecs_query_t *stream_query;
+  uint64_t stream_frame;
+  TbTextureStreamStats stream_stats;
 } TbTextureCtx;
 ECS_COMPONENT_DECLARE(TbTextureCtx);
 
@@ -34,11 +59,18 @@ typedef struct TbTextureImage {
   TbHostBuffer host_buffer;
   TbImage gpu_image;
   VkImageView image_view;
+  // The image isn't handed to shaders until this upload is complete
+  uint64_t upload_value;
 } TbTextureImage;
 ECS_COMPONENT_DECLARE(TbTextureImage);
 
 ECS_COMPONENT_DECLARE(TbTextureComponent);
 
+// How many holders a texture that was loaded on behalf of an asset has.
+// Textures owned by the texture system itself don't have one
+typedef uint32_t TbTextureRefCount;
+ECS_COMPONENT_DECLARE(TbTextureRefCount);
+
 // Describes the creation of a texture that lives in a GLB file
 typedef struct TbTextureGLTFLoadRequest {
   const cgltf_data *data;
@@ -61,7 +93,21 @@ typedef struct TbTextureRawLoadRequest {
 } TbTextureRawLoadRequest;
 ECS_COMPONENT_DECLARE(TbTextureRawLoadRequest);
 
+// Present on textures whose mips are streamed in and out on demand. The
+// transcoded levels stay in memory so that any range of them can be uploaded
+// again when the texture's residency changes
+typedef struct TbTextureStreaming {
+  ktxTexture2 *ktx;
+  uint32_t resident_mip;  // Most detailed level on the gpu
+  uint32_t requested_mip; // Most detailed level its usage asks for
+  uint32_t min_mip;       // This level and every coarser one stay resident
+  float screen_size;      // Largest size in pixels reported since last update
+  uint64_t last_seen;     // Stream frame of the last report
+} TbTextureStreaming;
+ECS_COMPONENT_DECLARE(TbTextureStreaming);
+
 ECS_TAG_DECLARE(TbTextureLoaded);
+ECS_TAG_DECLARE(TbTextureUnreferenced);
 
 // Internals
 
@@ -153,12 +199,16 @@ VkImageViewType get_ktx2_image_view_type(const ktxTexture2 *t) {
 TbTextureImage tb_load_ktx_image(TbRenderSystem *rnd_sys, const char *name,
                                  ktxTexture2 *ktx) {
   TB_TRACY_SCOPE("Load KTX Texture");
-  bool needs_transcoding = ktxTexture2_NeedsTranscoding(ktx);
-  if (needs_transcoding) {
-    TB_TRACY_SCOPE("KTX Basis Transcode");
-    // TODO: pre-calculate the best format for the platform
-    ktx_error_code_e err = ktxTexture2_TranscodeBasis(ktx, KTX_TTF_BC7_RGBA, 0);
-    TB_CHECK(err == KTX_SUCCESS, "Failed to transcode basis texture");
+  TB_CHECK(!ktxTexture2_NeedsTranscoding(ktx),
+           "Basis textures should be transcoded by tb_open_ktx");
+  // Image data that can be uploaded as is gets loaded straight into upload
+  // memory. Anything that has to be transformed first is loaded onto the
+  // texture itself
+  const bool direct =
+      ktx->pData == NULL && ktx->supercompressionScheme == KTX_SS_NONE;
+  if (!direct && ktx->pData == NULL) {
+    ktx_error_code_e err = ktxTexture_LoadImageData(ktxTexture(ktx), NULL, 0);
+    TB_CHECK(err == KTX_SUCCESS, "Failed to load KTX image data");
   }
 
   size_t host_buffer_size = ktx->dataSize;
@@ -191,9 +241,18 @@ TbTextureImage tb_load_ktx_image(TbRenderSystem *rnd_sys, const char *name,
         .samples = VK_SAMPLE_COUNT_1_BIT,
         .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
     };
-    tb_rnd_sys_create_gpu_image(rnd_sys, ktx->pData, host_buffer_size,
-                                &create_info, name, &texture.gpu_image,
-                                &texture.host_buffer);
+    void *ptr = NULL;
+    tb_rnd_sys_alloc_gpu_image_upload(rnd_sys, host_buffer_size, &create_info,
+                                      name, &texture.gpu_image,
+                                      &texture.host_buffer, &ptr);
+    if (direct) {
+      ktx_error_code_e err =
+          ktxTexture_LoadImageData(ktxTexture(ktx), ptr, host_buffer_size);
+      TB_CHECK(err == KTX_SUCCESS, "Failed to load KTX image data");
+    } else {
+      SDL_memcpy(ptr, ktx->pData, host_buffer_size); // NOLINT
+    }
+    tb_flush_alloc(rnd_sys, texture.gpu_image.alloc);
   }
 
   // Create image view
@@ -244,14 +303,225 @@ TbTextureImage tb_load_ktx_image(TbRenderSystem *rnd_sys, const char *name,
 #pragma clang diagnostic pop
 
     // Will handle transitioning the image's layout to shader read only
+    texture.upload_value =
+        tb_rnd_upload_buffer_to_image_async(rnd_sys, uploads, mip_levels);
+  }
+
+  return texture;
+}
+
+static bool tb_is_ktx_streamable(const ktxTexture2 *ktx) {
+  return ktx->numDimensions == 2 && !ktx->isArray && !ktx->isCubemap &&
+         ktx->numLayers == 1 && ktx->numFaces == 1 && ktx->numLevels > 1 &&
+         ktx->numLevels <= TB_TEX_BUDGET_MAX_LEVELS;
+}
+
+static uint32_t tb_ktx_min_mip(const ktxTexture2 *ktx) {
+  const uint32_t dim = SDL_max(ktx->baseWidth, ktx->baseHeight);
+  uint32_t mip = 0;
+  while (mip + 1 < ktx->numLevels && (dim >> mip) > TB_TEX_STREAM_MIN_SIZE) {
+    mip++;
+  }
+  return mip;
+}
+
+// Bytes taken up by the levels from first_mip down to the smallest
+static uint64_t tb_ktx_mips_size(ktxTexture2 *ktx, uint32_t first_mip) {
+  uint64_t size = 0;
+  for (uint32_t level = first_mip; level < ktx->numLevels; ++level) {
+    size += ktxTexture_GetImageSize(ktxTexture(ktx), level);
+  }
+  return size;
+}
+
+// The level whose resolution matches how many pixels the texture covers,
+// assuming that it spans the surface it is on about once
+static uint32_t tb_ktx_desired_mip(const ktxTexture2 *ktx, float screen_size) {
+  if (screen_size < 1.0f) {
+    return ktx->numLevels - 1;
+  }
+  const float dim = (float)SDL_max(ktx->baseWidth, ktx->baseHeight);
+  const float mip = SDL_floorf(SDL_logf(dim / screen_size) / SDL_logf(2.0f));
+  return (uint32_t)SDL_clamp(mip, 0.0f, (float)(ktx->numLevels - 1));
+}
+
+// Uploads the levels of a 2D texture from first_mip down to the smallest.
+// The image only has room for those levels so evicted mips take up no gpu
+// memory. The texture's image data must already be loaded
+// Restreamed textures replace an image that is in use so their upload is not
+// async and lands in the frame it was queued in
+static TbTextureImage tb_upload_ktx_mips(TbRenderSystem *rnd_sys,
+                                         const char *name, ktxTexture2 *ktx,
+                                         uint32_t first_mip, bool async) {
+  TB_TRACY_SCOPE("Upload KTX Mips");
+  TB_CHECK(ktx->pData, "Streamed textures must keep their image data");
+  const uint32_t mip_levels = ktx->numLevels - first_mip;
+  const uint32_t width = SDL_max(ktx->baseWidth >> first_mip, 1);
+  const uint32_t height = SDL_max(ktx->baseHeight >> first_mip, 1);
+  const VkFormat format = (VkFormat)ktx->vkFormat;
+
+  TbTextureImage texture = {0};
+  void *ptr = NULL;
+  {
+    VkImageCreateInfo create_info = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .arrayLayers = 1,
+        .extent = (VkExtent3D){width, height, 1},
+        .format = format,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .mipLevels = mip_levels,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+    };
+    tb_rnd_sys_alloc_gpu_image_upload(
+        rnd_sys, tb_ktx_mips_size(ktx, first_mip), &create_info, name,
+        &texture.gpu_image, &texture.host_buffer, &ptr);
+  }
+
+  {
+    VkImageViewCreateInfo create_info = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = texture.gpu_image.image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+        .components =
+            {
+                VK_COMPONENT_SWIZZLE_R,
+                VK_COMPONENT_SWIZZLE_G,
+                VK_COMPONENT_SWIZZLE_B,
+                VK_COMPONENT_SWIZZLE_A,
+            },
+        .subresourceRange =
+            {
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                0,
+                mip_levels,
+                0,
+                1,
+            },
+    };
+    char view_name[100] = {0};
+    SDL_snprintf(view_name, 100, "%s Image TbView", name); // NOLINT
+    tb_rnd_create_image_view(rnd_sys, &create_info, view_name,
+                             &texture.image_view);
+  }
+
+  // Levels are packed back to back. Each level is a whole number of blocks
+  // so every level stays aligned to the format's block size
+  TbBufferImageCopy *uploads =
+      tb_alloc_nm_tp(rnd_sys->tmp_alloc, mip_levels, TbBufferImageCopy);
+  uint64_t offset = 0;
+  for (uint32_t mip = 0; mip < mip_levels; ++mip) {
+    const uint32_t level = first_mip + mip;
+    ktx_size_t level_offset = 0;
+    ktxTexture_GetImageOffset(ktxTexture(ktx), level, 0, 0, &level_offset);
+    const ktx_size_t level_size =
+        ktxTexture_GetImageSize(ktxTexture(ktx), level);
+    SDL_memcpy((uint8_t *)ptr + offset, ktx->pData + level_offset, // NOLINT
+               level_size);
+
+    uploads[mip] = (TbBufferImageCopy){
+        .src = texture.host_buffer.buffer,
+        .dst = texture.gpu_image.image,
+        .region =
+            {
+                .bufferOffset = texture.host_buffer.offset + offset,
+                .imageSubresource =
+                    {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .layerCount = 1,
+                        .mipLevel = mip,
+                    },
+                .imageExtent =
+                    {
+                        .width = SDL_max(ktx->baseWidth >> level, 1),
+                        .height = SDL_max(ktx->baseHeight >> level, 1),
+                        .depth = 1,
+                    },
+            },
+        .range =
+            {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = mip,
+                .layerCount = 1,
+                .levelCount = 1,
+            },
+    };
+    offset += level_size;
+  }
+  tb_flush_alloc(rnd_sys, texture.gpu_image.alloc);
+
+  // Will handle transitioning the image's layout to shader read only
+  if (async) {
+    texture.upload_value =
+        tb_rnd_upload_buffer_to_image_async(rnd_sys, uploads, mip_levels);
+  } else {
     tb_rnd_upload_buffer_to_image(rnd_sys, uploads, mip_levels);
   }
 
   return texture;
 }
 
+// Finds the texture that a glb material uses for the given purpose
+static const cgltf_texture *tb_find_mat_texture(const cgltf_data *data,
+                                                const char *mat_name,
+                                                TbTextureUsage usage) {
+  const cgltf_material *mat = NULL;
+  for (cgltf_size i = 0; i < data->materials_count; ++i) {
+    tb_auto material = &data->materials[i];
+    if (SDL_strcmp(mat_name, material->name) == 0) {
+      mat = material;
+      break;
+    }
+  }
+  TB_CHECK_RETURN(mat, "Failed to find material by name", NULL);
+
+  switch (usage) {
+  case TB_TEX_USAGE_COLOR:
+    if (mat->has_pbr_metallic_roughness) {
+      return mat->pbr_metallic_roughness.base_color_texture.texture;
+    }
+    if (mat->has_pbr_specular_glossiness) {
+      return mat->pbr_specular_glossiness.diffuse_texture.texture;
+    }
+    TB_CHECK(false, "Expected material to have a color texture somewhere");
+    return NULL;
+  case TB_TEX_USAGE_METAL_ROUGH:
+    if (mat->has_pbr_metallic_roughness) {
+      return mat->pbr_metallic_roughness.metallic_roughness_texture.texture;
+    }
+    TB_CHECK(false, "Expected material to have metallic roughness model");
+    return NULL;
+  case TB_TEX_USAGE_NORMAL:
+    return mat->normal_texture.texture;
+  case TB_TEX_USAGE_BRDF:
+  default:
+    TB_CHECK(false,
+             "Material textures should have Color, Metal or Normal usage");
+    return NULL;
+  }
+}
+
+static const char *tb_mat_tex_suffix(TbTextureUsage usage) {
+  switch (usage) {
+  case TB_TEX_USAGE_COLOR:
+    return "color";
+  case TB_TEX_USAGE_METAL_ROUGH:
+    return "metal";
+  case TB_TEX_USAGE_NORMAL:
+    return "normal";
+  case TB_TEX_USAGE_BRDF:
+  default:
+    return "unknown";
+  }
+}
+
+// Textures that can be streamed only get their smallest mips uploaded here.
+// Their streaming state is written to stream
 TbTextureImage tb_load_gltf_texture(TbRenderSystem *rnd_sys, const char *name,
-                                    const cgltf_texture *texture) {
+                                    const cgltf_data *data,
+                                    const cgltf_texture *texture,
+                                    TbTextureStreaming *stream) {
   TB_TRACY_SCOPE("Load GLTF Texture");
   TbTextureImage tex = {0};
 
@@ -265,18 +535,33 @@ TbTextureImage tb_load_gltf_texture(TbRenderSystem *rnd_sys, const char *name,
 
     // Points to some jpg/png whatever image format data
     uint8_t *raw_data = (uint8_t *)(image_data->data) + image_view->offset;
-    const int32_t raw_size = (int32_t)image_view->size;
-
-    // Parse the ktx texture
-    ktxTexture2 *ktx = NULL;
-    {
-      ktxTextureCreateFlags flags = KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT;
-
-      ktx_error_code_e err =
-          ktxTexture2_CreateFromMemory(raw_data, raw_size, flags, &ktx);
-      TB_CHECK(err == KTX_SUCCESS, "Failed to create KTX texture from memory");
+    const size_t raw_size = image_view->size;
+
+    // Image data is read out of the glb by tb_load_ktx_image
+    tb_auto hash = tb_glb_image_hash(data, image);
+    tb_auto ktx = tb_open_ktx(TB_TRANSCODE_CACHE_DIR, TbTranscodeTarget,
+                              raw_data, raw_size, hash.hash);
+    if (ktx != NULL && tb_is_ktx_streamable(ktx)) {
+      // The glb will be released so streamed levels need a copy of their own
+      if (ktx->pData == NULL) {
+        ktx_error_code_e err =
+            ktxTexture_LoadImageData(ktxTexture(ktx), NULL, 0);
+        TB_CHECK(err == KTX_SUCCESS, "Failed to load KTX image data");
+      }
+      const uint32_t min_mip = tb_ktx_min_mip(ktx);
+      tex = tb_upload_ktx_mips(rnd_sys, name, ktx, min_mip, true);
+      tb_gltf_count_copy(ktx->dataSize);
+      *stream = (TbTextureStreaming){
+          .ktx = ktx,
+          .resident_mip = min_mip,
+          .requested_mip = min_mip,
+          .min_mip = min_mip,
+      };
+    } else if (ktx != NULL) {
+      tex = tb_load_ktx_image(rnd_sys, name, ktx);
+      tb_gltf_count_copy(ktx->dataSize);
+      ktxTexture_Destroy(ktxTexture(ktx));
     }
-    tex = tb_load_ktx_image(rnd_sys, name, ktx);
   } else {
     TB_CHECK(false, "Uncompressed texture loading not implemented");
   }
@@ -390,7 +675,8 @@ TbTextureImage tb_load_raw_image(TbRenderSystem *rnd_sys, const char *name,
     };
 
     // Will handle transitioning the image's layout to shader read only
-    tb_rnd_upload_buffer_to_image(rnd_sys, uploads, mip_levels);
+    texture.upload_value =
+        tb_rnd_upload_buffer_to_image_async(rnd_sys, uploads, mip_levels);
   }
 
   return texture;
@@ -400,6 +686,7 @@ typedef struct TbTextureLoadedArgs {
   ecs_world_t *ecs;
   TbTexture tex;
   TbTextureImage comp;
+  TbTextureStreaming stream; // Only set for streamed textures
 } TbTextureLoadedArgs;
 
 void tb_texture_loaded(const void *args) {
@@ -408,8 +695,12 @@ void tb_texture_loaded(const void *args) {
   tb_auto tex = loaded_args->tex;
   if (tex != 0) {
     SDL_AtomicDecRef(&tb_parallel_tex_load_count);
+    tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, -1);
     ecs_add(ecs, tex, TbTextureLoaded);
     ecs_set_ptr(ecs, tex, TbTextureImage, &loaded_args->comp);
+    if (loaded_args->stream.ktx) {
+      ecs_set_ptr(ecs, tex, TbTextureStreaming, &loaded_args->stream);
+    }
   } else {
     TB_CHECK(false, "Texture load failed. Do we need to retry?");
   }
@@ -439,69 +730,33 @@ void tb_load_gltf_texture_task(const void *args) {
   tb_auto data = load_args->gltf.data;
   tb_auto mat_name = load_args->gltf.mat_name;
 
-  // Find material by name
-  struct cgltf_material *mat = NULL;
-  for (cgltf_size i = 0; i < data->materials_count; ++i) {
-    tb_auto material = &data->materials[i];
-    if (SDL_strcmp(mat_name, material->name) == 0) {
-      mat = material;
-      break;
-    }
-  }
-  if (mat == NULL) {
-    TB_CHECK(false, "Failed to find material by name");
-    tex = 0; // Invalid ent means task failed
-  }
-
+  // GLTFpack strips image names so we have to synthesize something
   char image_name[100] = {0};
-  struct cgltf_texture *texture = NULL;
-  // Find image by usage
-  switch (usage) {
-  case TB_TEX_USAGE_COLOR: {
-    if (mat->has_pbr_metallic_roughness) {
-      texture = mat->pbr_metallic_roughness.base_color_texture.texture;
-    } else if (mat->has_pbr_specular_glossiness) {
-      texture = mat->pbr_specular_glossiness.diffuse_texture.texture;
-    } else {
-      TB_CHECK(false, "Expected material to have a color texture somewhere");
-    }
-    SDL_snprintf(image_name, 100, "%s_color", mat->name);
-    break;
-  }
-  case TB_TEX_USAGE_METAL_ROUGH:
-    if (mat->has_pbr_metallic_roughness) {
-      texture = mat->pbr_metallic_roughness.metallic_roughness_texture.texture;
-    } else {
-      TB_CHECK(false, "Expected material to have metallic roughness model");
-    }
-    SDL_snprintf(image_name, 100, "%s_metal", mat->name);
-    break;
-  case TB_TEX_USAGE_NORMAL:
-    texture = mat->normal_texture.texture;
-    SDL_snprintf(image_name, 100, "%s_normal", mat->name);
-    break;
-  default:
-    texture = NULL;
-    break;
-  }
+  SDL_snprintf(image_name, 100, "%s_%s", mat_name, tb_mat_tex_suffix(usage));
+
+  tb_auto texture = tb_find_mat_texture(data, mat_name, usage);
   if (texture == NULL) {
     TB_CHECK(false, "Failed to find texture by usage");
     tex = 0; // Invalid ent means task failed
   }
 
   TbTextureImage tex_comp = {0};
+  TbTextureStreaming stream = {0};
   if (tex != 0) {
-    tex_comp = tb_load_gltf_texture(rnd_sys, image_name, texture);
+    tex_comp =
+        tb_load_gltf_texture(rnd_sys, image_name, data, texture, &stream);
   }
 
   // Strings were copies that can be freed now
   tb_free(tb_global_alloc, (void *)mat_name);
+  tb_release_glb(data);
 
   // Launch pinned task to handle loading signals on main thread
   TbTextureLoadedArgs loaded_args = {
       .ecs = load_args->common.ecs,
       .tex = tex,
       .comp = tex_comp,
+      .stream = stream,
   };
   tb_launch_pinned_task_args(load_args->common.enki,
                              load_args->common.loaded_task, &loaded_args,
@@ -522,10 +777,6 @@ void tb_load_ktx_texture_task(const void *args) {
   tb_auto path = load_args->ktx.path;
   tb_auto name = load_args->ktx.name;
 
-  ktxTexture2 *ktx = NULL;
-
-  ktxTextureCreateFlags flags = KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT;
-
   // We need to open this file with SDL_IOStream because on a platform like
   // android where the asset lives in package storage, this is the best way
   // to actually open the file you're looking for
@@ -536,13 +787,14 @@ void tb_load_ktx_texture_task(const void *args) {
   SDL_ReadIO(tex_file, (void *)tex_data, tex_size);
   SDL_CloseIO(tex_file);
 
-  ktx_error_code_e err =
-      ktxTexture2_CreateFromMemory(tex_data, tex_size, flags, &ktx);
-  TB_CHECK(err == KTX_SUCCESS, "Failed to create KTX texture from memory");
+  // Image data is loaded by tb_load_ktx_image while tex_data is still alive
+  tb_auto ktx = tb_open_ktx(TB_TRANSCODE_CACHE_DIR, TbTranscodeTarget, tex_data,
+                            tex_size, tb_hash(0, tex_data, tex_size));
 
   TbTextureImage tex_comp = {0};
   if (ktx != NULL) {
     tex_comp = tb_load_ktx_image(rnd_sys, name, ktx);
+    ktxTexture_Destroy(ktxTexture(ktx));
   }
 
   tb_free(tb_thread_alloc, tex_data);
@@ -599,21 +851,45 @@ void tb_queue_gltf_tex_loads(ecs_iter_t *it) {
 
   tb_auto enki = *ecs_field(it, TbTaskScheduler, 0);
   tb_auto rnd_sys = ecs_field(it, TbRenderSystem, 1);
-  tb_auto reqs = ecs_field(it, TbTextureGLTFLoadRequest, 2);
-  tb_auto usages = ecs_field(it, TbTextureUsage, 3);
+  tb_auto tex_ctx = ecs_field(it, TbTextureCtx, 2);
 
-  tb_auto tex_ctx = ecs_singleton_ensure(it->world, TbTextureCtx);
+  tb_auto tmp_alloc =
+      rnd_sys->render_thread->frame_states[rnd_sys->frame_idx].tmp_alloc.alloc;
 
-  // TODO: Time slice the time spent creating tasks
-  // Iterate texture load tasks
-  for (int32_t i = 0; i < it->count; ++i) {
-    if (SDL_GetAtomicInt(&tb_parallel_tex_load_count) >=
-        TbMaxParallelTextureLoads) {
-      break;
+  // Every pending load is considered so the most important go out first
+  TbLoadQueue pending = {0};
+  TB_DYN_ARR_RESET(pending, tmp_alloc, 64);
+  tb_auto tex_it = ecs_query_iter(ecs, tex_ctx->gltf_load_query);
+  while (ecs_query_next(&tex_it)) {
+    for (int32_t i = 0; i < tex_it.count; ++i) {
+      TbTexture ent = tex_it.entities[i];
+      TbLoadQueueEntry entry = {
+          .ent = ent,
+          .priority = tb_get_load_priority(ecs, ent),
+          .cancelled = ecs_has(ecs, ent, TbTextureUnreferenced),
+      };
+      TB_DYN_ARR_APPEND(pending, entry);
     }
-    TbTexture ent = it->entities[i];
-    tb_auto req = reqs[i];
-    tb_auto usage = usages[i];
+  }
+  const int32_t slot_count =
+      TbMaxParallelTextureLoads - SDL_GetAtomicInt(&tb_parallel_tex_load_count);
+  tb_auto dispatch = tb_plan_load_dispatch(enki, tmp_alloc, &pending,
+                                           (uint32_t)SDL_max(slot_count, 0));
+
+  // Nothing wants these textures anymore so they don't need to load at all
+  for (uint32_t i = 0; i < dispatch.dropped_count; ++i) {
+    TbTexture ent = TB_DYN_ARR_AT(pending, dispatch.dropped[i]).ent;
+    tb_auto req = ecs_get(ecs, ent, TbTextureGLTFLoadRequest);
+    tb_free(tb_global_alloc, (void *)req->mat_name);
+    tb_release_glb(req->data);
+    ecs_delete(ecs, ent);
+  }
+
+  // TODO: Time slice the time spent creating tasks
+  for (uint32_t i = 0; i < dispatch.count; ++i) {
+    TbTexture ent = TB_DYN_ARR_AT(pending, dispatch.order[i]).ent;
+    tb_auto req = *ecs_get(ecs, ent, TbTextureGLTFLoadRequest);
+    tb_auto usage = *ecs_get(ecs, ent, TbTextureUsage);
 
     // This pinned task will be launched by the loading task
     TbPinnedTask loaded_task =
@@ -637,6 +913,7 @@ void tb_queue_gltf_tex_loads(ecs_iter_t *it) {
     ecs_set(ecs, ent, TbTask, {load_task});
 
     SDL_AtomicIncRef(&tb_parallel_tex_load_count);
+    tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, 1);
     tex_ctx->owned_tex_count++;
 
     // Remove load request as it has now been enqueued to the task system
@@ -689,6 +966,7 @@ void tb_queue_ktx_tex_loads(ecs_iter_t *it) {
     ecs_set(ecs, ent, TbTask, {load_task});
 
     SDL_AtomicIncRef(&tb_parallel_tex_load_count);
+    tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, 1);
     tex_ctx->owned_tex_count++;
 
     // Remove load request as it has now been enqueued to the task system
@@ -742,6 +1020,7 @@ void tb_queue_raw_tex_loads(ecs_iter_t *it) {
     ecs_set(ecs, ent, TbTask, {load_task});
 
     SDL_AtomicIncRef(&tb_parallel_tex_load_count);
+    tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, 1);
     tex_ctx->owned_tex_count++;
 
     // Remove load request as it has now been enqueued to the task system
@@ -764,11 +1043,17 @@ void tb_finalize_textures(ecs_iter_t *it) {
   tb_auto rnd_tmp_alloc =
       rnd_sys->render_thread->frame_states[rnd_sys->frame_idx].tmp_alloc.alloc;
 
-  // Collect a write for every new texture
+  // Collect a write for every new texture whose upload has finished. The
+  // rest are picked up again on a later frame
   TB_DYN_ARR_OF(TbDynDescWrite) writes = {0};
+  TB_DYN_ARR_OF(ecs_entity_t) ents = {0};
   TB_DYN_ARR_RESET(writes, rnd_tmp_alloc, it->count);
+  TB_DYN_ARR_RESET(ents, rnd_tmp_alloc, it->count);
   for (int32_t i = 0; i < it->count; ++i) {
     tb_auto texture = &textures[i];
+    if (!tb_rnd_is_upload_complete(rnd_sys, texture->upload_value)) {
+      continue;
+    }
     TbDynDescWrite write = {
         .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
         .desc.image =
@@ -778,6 +1063,7 @@ void tb_finalize_textures(ecs_iter_t *it) {
             },
     };
     TB_DYN_ARR_APPEND(writes, write);
+    TB_DYN_ARR_APPEND(ents, it->entities[i]);
   }
 
   // Allocate space for indices
@@ -790,10 +1076,190 @@ void tb_finalize_textures(ecs_iter_t *it) {
 
     TB_DYN_ARR_FOREACH(writes, i) {
       // Texture is now ready to be referenced elsewhere
-      ecs_set(it->world, it->entities[i], TbTextureComponent, {tex_indices[i]});
-      ecs_add(it->world, it->entities[i], TbDescriptorReady);
+      tb_auto ent = TB_DYN_ARR_AT(ents, i);
+      ecs_set(it->world, ent, TbTextureComponent, {tex_indices[i]});
+      ecs_add(it->world, ent, TbDescriptorReady);
+    }
+  }
+}
+
+void tb_destroy_unreferenced_textures(ecs_iter_t *it) {
+  TB_TRACY_SCOPE("Destroy Unreferenced Textures");
+
+  tb_auto tex_ctx = ecs_field(it, TbTextureCtx, 0);
+  tb_auto rnd_sys = ecs_field(it, TbRenderSystem, 1);
+  tb_auto textures = ecs_field(it, TbTextureImage, 2);
+  tb_auto tex_indices = ecs_field(it, TbTextureComponent, 3);
+
+  for (int32_t i = 0; i < it->count; ++i) {
+    tb_auto texture = &textures[i];
+    // Frames in flight may still sample the texture so both the image and
+    // its descriptor slot outlive them
+    tb_rnd_destroy_image_view_deferred(rnd_sys, texture->image_view);
+    tb_rnd_free_gpu_image_deferred(rnd_sys, &texture->gpu_image);
+    tb_rnd_free_host_buffer_deferred(rnd_sys, &texture->host_buffer);
+    tb_release_dyn_desc(&tex_ctx->desc_pool, tex_indices[i]);
+    tb_auto stream = ecs_get(it->world, it->entities[i], TbTextureStreaming);
+    if (stream) {
+      ktxTexture_Destroy(ktxTexture(stream->ktx));
+    }
+    tex_ctx->owned_tex_count--;
+    ecs_delete(it->world, it->entities[i]);
+  }
+}
+
+// Replaces a streamed texture's image with one holding the levels from mip
+// down. Its descriptor slot is rewritten in place so nothing referencing the
+// texture by index has to change
+static void tb_restream_texture(TbRenderSystem *rnd_sys, TbTextureCtx *ctx,
+                                const char *name, TbTextureStreaming *stream,
+                                TbTextureImage *texture, uint32_t tex_idx,
+                                uint32_t mip) {
+  TB_TRACY_SCOPE("Restream Texture");
+  // Frames in flight may still sample the old image
+  tb_rnd_destroy_image_view_deferred(rnd_sys, texture->image_view);
+  tb_rnd_free_gpu_image_deferred(rnd_sys, &texture->gpu_image);
+  tb_rnd_free_host_buffer_deferred(rnd_sys, &texture->host_buffer);
+
+  *texture = tb_upload_ktx_mips(rnd_sys, name, stream->ktx, mip, false);
+  stream->resident_mip = mip;
+
+  TbDynDescWrite write = {
+      .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+      .desc.image =
+          (VkDescriptorImageInfo){
+              .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+              .imageView = texture->image_view,
+          },
+  };
+  tb_update_dyn_desc(&ctx->desc_pool, tex_idx, &write);
+}
+
+typedef struct TbStreamEntry {
+  ecs_entity_t ent;
+  TbTextureStreaming *stream;
+  TbTextureImage *image;
+  uint32_t tex_idx;
+} TbStreamEntry;
+
+void tb_stream_textures(ecs_iter_t *it) {
+  TB_TRACY_SCOPE("Stream Textures");
+  tb_auto ecs = it->world;
+
+  tb_auto tex_ctx = ecs_field(it, TbTextureCtx, 0);
+  tb_auto rnd_sys = ecs_field(it, TbRenderSystem, 1);
+  tb_auto enki = *ecs_field(it, TbTaskScheduler, 2);
+
+  tb_auto settings = ecs_singleton_get(ecs, TbSettings);
+  const float budget_mb =
+      settings ? settings->tex_budget_mb : TB_TEX_STREAM_DEFAULT_BUDGET_MB;
+  const uint64_t budget = (uint64_t)(SDL_max(budget_mb, 0.0f) * 1024.0f) *
+                          1024ull;
+
+  const uint64_t frame = ++tex_ctx->stream_frame;
+  tb_auto tmp_alloc =
+      rnd_sys->render_thread->frame_states[rnd_sys->frame_idx].tmp_alloc.alloc;
+
+  // Work out the level each texture's usage asks for
+  TB_DYN_ARR_OF(TbStreamEntry) entries = {0};
+  TB_DYN_ARR_RESET(entries, tmp_alloc, 64);
+  TB_DYN_ARR_OF(TbTexBudgetRequest) requests = {0};
+  TB_DYN_ARR_RESET(requests, tmp_alloc, 64);
+  tb_auto stream_it = ecs_query_iter(ecs, tex_ctx->stream_query);
+  while (ecs_query_next(&stream_it)) {
+    tb_auto streams = ecs_field(&stream_it, TbTextureStreaming, 0);
+    tb_auto images = ecs_field(&stream_it, TbTextureImage, 1);
+    tb_auto indices = ecs_field(&stream_it, TbTextureComponent, 2);
+    for (int32_t i = 0; i < stream_it.count; ++i) {
+      tb_auto stream = &streams[i];
+      uint32_t desired = stream->min_mip;
+      if (frame - stream->last_seen <= TB_TEX_STREAM_IDLE_FRAMES) {
+        desired = tb_ktx_desired_mip(stream->ktx, stream->screen_size);
+      }
+      stream->requested_mip = SDL_min(desired, stream->min_mip);
+      stream->screen_size = 0.0f;
+
+      TbStreamEntry entry = {
+          .ent = stream_it.entities[i],
+          .stream = stream,
+          .image = &images[i],
+          .tex_idx = indices[i],
+      };
+      TB_DYN_ARR_APPEND(entries, entry);
+
+      TbTexBudgetRequest request = {
+          .requested_mip = stream->requested_mip,
+          .min_mip = stream->min_mip,
+      };
+      for (uint32_t level = 0; level <= stream->min_mip; ++level) {
+        request.mips_size[level] = tb_ktx_mips_size(stream->ktx, level);
+      }
+      TB_DYN_ARR_APPEND(requests, request);
+    }
+  }
+
+  const uint32_t entry_count = TB_DYN_ARR_SIZE(entries);
+  tb_auto levels = tb_alloc_nm_tp(tmp_alloc, entry_count, uint32_t);
+  const TbTexBudgetSolution solution =
+      tb_solve_tex_budget(entry_count, requests.data, budget, levels);
+
+  // Evictions happen right away to make room. Upgrades are made in order of
+  // how large the texture appears, up to a limited amount each frame
+  TbLoadQueue upgrades = {0};
+  TB_DYN_ARR_RESET(upgrades, tmp_alloc, TB_DYN_ARR_SIZE(entries));
+  TB_DYN_ARR_FOREACH(entries, i) {
+    tb_auto entry = &TB_DYN_ARR_AT(entries, i);
+    tb_auto stream = entry->stream;
+    const uint32_t target = levels[i];
+    if (target > stream->resident_mip) {
+      tb_restream_texture(rnd_sys, tex_ctx, ecs_get_name(ecs, entry->ent),
+                          stream, entry->image, entry->tex_idx, target);
+    } else if (target < stream->resident_mip) {
+      const float dim = (float)SDL_max(stream->ktx->baseWidth,
+                                       stream->ktx->baseHeight);
+      // Index into entries rather than the entity so the upgrade can find
+      // its pointers again
+      TbLoadQueueEntry upgrade = {
+          .ent = i,
+          .priority = dim / (float)(1u << target),
+      };
+      TB_DYN_ARR_APPEND(upgrades, upgrade);
+    }
+  }
+
+  uint32_t pending_count = 0;
+  uint64_t uploaded = 0;
+  tb_auto order = tb_sort_load_queue(enki, tmp_alloc, &upgrades);
+  for (uint32_t i = 0; i < TB_DYN_ARR_SIZE(upgrades); ++i) {
+    const uint32_t entry_idx = TB_DYN_ARR_AT(upgrades, order[i]).ent;
+    tb_auto entry = &TB_DYN_ARR_AT(entries, entry_idx);
+    tb_auto stream = entry->stream;
+    const uint32_t target = levels[entry_idx];
+    const uint64_t size = tb_ktx_mips_size(stream->ktx, target);
+    // Always let one upgrade through so large textures can't stall
+    if (uploaded > 0 && uploaded + size > TB_TEX_STREAM_UPLOAD_BUDGET) {
+      pending_count++;
+      continue;
     }
+    tb_restream_texture(rnd_sys, tex_ctx, ecs_get_name(ecs, entry->ent),
+                        stream, entry->image, entry->tex_idx, target);
+    uploaded += size;
+  }
+
+  uint64_t resident_bytes = 0;
+  TB_DYN_ARR_FOREACH(entries, i) {
+    tb_auto stream = TB_DYN_ARR_AT(entries, i).stream;
+    resident_bytes += tb_ktx_mips_size(stream->ktx, stream->resident_mip);
   }
+
+  tex_ctx->stream_stats = (TbTextureStreamStats){
+      .texture_count = TB_DYN_ARR_SIZE(entries),
+      .pending_count = pending_count,
+      .mip_bias = solution.bias,
+      .resident_bytes = resident_bytes,
+      .requested_bytes = solution.requested_bytes,
+      .budget_bytes = budget,
+  };
 }
 
 void tb_update_texture_pool(ecs_iter_t *it) {
@@ -817,13 +1283,18 @@ void tb_register_texture_sys(TbWorld *world) {
   ECS_COMPONENT_DEFINE(ecs, TbTextureImage);
   ECS_COMPONENT_DEFINE(ecs, TbTextureComponent);
   ECS_COMPONENT_DEFINE(ecs, TbTextureUsage);
+  ECS_COMPONENT_DEFINE(ecs, TbTextureRefCount);
+  ECS_COMPONENT_DEFINE(ecs, TbTextureStreaming);
 
   ECS_TAG_DEFINE(ecs, TbTextureLoaded);
+  ECS_TAG_DEFINE(ecs, TbTextureUnreferenced);
 
-  ECS_SYSTEM(
-      ecs, tb_queue_gltf_tex_loads, EcsPostLoad,
-      TbTaskScheduler(TbTaskScheduler),
-      TbRenderSystem($), [in] TbTextureGLTFLoadRequest, [in] TbTextureUsage);
+  // Does nothing if the cache already exists
+  SDL_CreateDirectory(TB_TRANSCODE_CACHE_DIR);
+
+  ECS_SYSTEM(ecs, tb_queue_gltf_tex_loads, EcsPostLoad,
+             TbTaskScheduler(TbTaskScheduler), TbRenderSystem($),
+             TbTextureCtx($));
   ECS_SYSTEM(
       ecs, tb_queue_ktx_tex_loads, EcsPostLoad,
       TbTaskScheduler(TbTaskScheduler),
@@ -836,10 +1307,35 @@ void tb_register_texture_sys(TbWorld *world) {
   ECS_SYSTEM(ecs, tb_finalize_textures, EcsPostUpdate, [in] TbTextureCtx($),
              [in] TbRenderSystem($), [in] TbTextureImage, [in] TbTextureLoaded,
              !TbDescriptorReady);
+  // Textures that are still loading are destroyed once they finish
+  ECS_SYSTEM(ecs, tb_destroy_unreferenced_textures,
+             EcsPostUpdate, [in] TbTextureCtx($), [in] TbRenderSystem($),
+             [in] TbTextureImage, [in] TbTextureComponent,
+             [in] TbTextureUnreferenced);
+  // Only singletons are matched so the streaming query can be walked in one go
+  ECS_SYSTEM(ecs, tb_stream_textures, EcsPostUpdate, [inout] TbTextureCtx($),
+             [in] TbRenderSystem($), TbTaskScheduler(TbTaskScheduler));
   ECS_SYSTEM(ecs, tb_update_texture_pool,
              EcsPreStore, [in] TbTextureCtx($), [in] TbRenderSystem($));
 
-  TbTextureCtx ctx = {0};
+  TbTextureCtx ctx = {
+      .gltf_load_query =
+          ecs_query(ecs, {.terms =
+                              {
+                                  {.id = ecs_id(TbTextureGLTFLoadRequest)},
+                                  {.id = ecs_id(TbTextureUsage)},
+                              }}),
+      .stream_query =
+          ecs_query(ecs, {.terms =
+                              {
+                                  {.id = ecs_id(TbTextureStreaming)},
+                                  {.id = ecs_id(TbTextureImage)},
+                                  {.id = ecs_id(TbTextureComponent)},
+                                  {.id = TbDescriptorReady},
+                                  {.id = TbTextureUnreferenced,
+                                   .oper = EcsNot},
+                              }}),
+  };
 
   SDL_SetAtomicInt(&tb_parallel_tex_load_count, 0);
 
@@ -933,16 +1429,18 @@ void tb_unregister_texture_sys(TbWorld *world) {
   tb_auto rnd_sys = ecs_singleton_ensure(ecs, TbRenderSystem);
   tb_auto ctx = ecs_singleton_ensure(ecs, TbTextureCtx);
 
+  ecs_query_fini(ctx->gltf_load_query);
+  ecs_query_fini(ctx->stream_query);
+
   tb_destroy_descriptor_buffer(rnd_sys, &ctx->desc_buffer);
 
   tb_rnd_destroy_set_layout(rnd_sys, ctx->set_layout);
+  tb_destroy_dyn_desc_pool(rnd_sys, &ctx->desc_pool);
 
   // TODO: Release all default texture references
 
   // TODO: Check for leaks
 
-  // TODO: Clean up descriptor pool
-
   ecs_singleton_remove(ecs, TbTextureCtx);
 }
 
@@ -1003,36 +1501,33 @@ TbTexture tb_tex_sys_load_raw_tex(ecs_world_t *ecs, const char *name,
 
 TbTexture tb_tex_sys_load_mat_tex(ecs_world_t *ecs, const cgltf_data *data,
                                   const char *mat_name, TbTextureUsage usage) {
-  const uint32_t image_name_max = 100;
-  char image_name[image_name_max] = {0};
-  // GLTFpack strips image names so we have to synthesize something
-  {
-    switch (usage) {
-    case TB_TEX_USAGE_BRDF:
-    default:
-      TB_CHECK(false,
-               "Material textures should have Color, Metal or Normal usage");
-      break;
-    case TB_TEX_USAGE_COLOR:
-      SDL_snprintf(image_name, image_name_max, "%s_color", mat_name);
-      break;
-    case TB_TEX_USAGE_METAL_ROUGH:
-      SDL_snprintf(image_name, image_name_max, "%s_metal", mat_name);
-      break;
-    case TB_TEX_USAGE_NORMAL:
-      SDL_snprintf(image_name, image_name_max, "%s_normal", mat_name);
-      break;
-    }
-  }
+  TB_CHECK_RETURN(data, "Expected Data", 0);
 
-  // If an entity already exists with this name it is either loading or loaded
+  // Textures are keyed by the content of their image so the same image in
+  // several glbs is only loaded once. Usage decides the format it is loaded
+  // with so it is part of the key
+  tb_auto texture = tb_find_mat_texture(data, mat_name, usage);
+  TB_CHECK_RETURN(texture, "Failed to find texture by usage", 0);
+  tb_auto image = texture->has_basisu ? texture->basisu_image : texture->image;
+  TB_CHECK_RETURN(image, "Texture has no image", 0);
+  TbAssetHash hash = tb_glb_image_hash(data, image);
+  hash.hash = tb_hash(hash.hash, (const uint8_t *)&usage, sizeof(usage));
+  char image_name[32] = {0};
+  SDL_snprintf(image_name, sizeof(image_name), "tex_%016" SDL_PRIx64,
+               hash.hash);
+
+  // If an entity already exists with this hash it is either loading or loaded
   TbTexture tex_ent = ecs_lookup_child(ecs, ecs_id(TbTextureCtx), image_name);
   if (tex_ent != 0) {
+    tb_auto ref_count = ecs_get_mut(ecs, tex_ent, TbTextureRefCount);
+    if (ref_count) {
+      (*ref_count)++;
+      ecs_remove(ecs, tex_ent, TbTextureUnreferenced);
+    }
+    tb_gltf_count_reuse(hash.size);
     return tex_ent;
   }
 
-  TB_CHECK_RETURN(data, "Expected Data", 0);
-
   // Create a texture entity
   tex_ent = ecs_new(ecs);
   ecs_set_name(ecs, tex_ent, image_name);
@@ -1046,9 +1541,12 @@ TbTexture tb_tex_sys_load_mat_tex(ecs_world_t *ecs, const cgltf_data *data,
   // It is a child of the texture system context singleton
   ecs_add_pair(ecs, tex_ent, EcsChildOf, ecs_id(TbTextureCtx));
 
-  // Append a texture load request onto the entity to schedule loading
+  // Append a texture load request onto the entity to schedule loading.
+  // The load task releases the glb when it's done with it
+  tb_acquire_glb(data);
   ecs_set(ecs, tex_ent, TbTextureGLTFLoadRequest, {data, mat_name_cpy});
   ecs_set(ecs, tex_ent, TbTextureUsage, {usage});
+  ecs_set(ecs, tex_ent, TbTextureRefCount, {1});
   ecs_remove(ecs, tex_ent, TbDescriptorReady);
 
   return tex_ent;
@@ -1077,6 +1575,51 @@ TbTexture tb_tex_sys_load_ktx_tex(ecs_world_t *ecs, const char *path,
   return tex_ent;
 }
 
+void tb_tex_sys_release_tex_ref(ecs_world_t *ecs, TbTexture tex) {
+  tb_auto ref_count = ecs_get_mut(ecs, tex, TbTextureRefCount);
+  if (ref_count == NULL) {
+    return;
+  }
+  if (*ref_count == 0) {
+    TB_CHECK(false, "Trying to release reference to texture that has no "
+                    "reference holders");
+    return;
+  }
+  (*ref_count)--;
+  if (*ref_count == 0) {
+    ecs_add(ecs, tex, TbTextureUnreferenced);
+  }
+}
+
+void tb_tex_sys_report_screen_size(ecs_world_t *ecs, TbTexture tex,
+                                   float screen_size) {
+  tb_auto stream = ecs_get_mut(ecs, tex, TbTextureStreaming);
+  if (!stream) {
+    return;
+  }
+  tb_auto ctx = ecs_singleton_get(ecs, TbTextureCtx);
+  stream->screen_size = SDL_max(stream->screen_size, screen_size);
+  stream->last_seen = ctx->stream_frame;
+}
+
+TbTextureStreamStats tb_tex_sys_get_stream_stats(ecs_world_t *ecs) {
+  tb_auto ctx = ecs_singleton_get(ecs, TbTextureCtx);
+  if (!ctx) {
+    return (TbTextureStreamStats){0};
+  }
+  return ctx->stream_stats;
+}
+
+uint32_t tb_tex_sys_get_resident_mip(ecs_world_t *ecs, TbTexture tex) {
+  tb_auto stream = ecs_get(ecs, tex, TbTextureStreaming);
+  return stream ? stream->resident_mip : 0;
+}
+
+uint32_t tb_tex_sys_get_requested_mip(ecs_world_t *ecs, TbTexture tex) {
+  tb_auto stream = ecs_get(ecs, tex, TbTextureStreaming);
+  return stream ? stream->requested_mip : 0;
+}
+
 bool tb_is_texture_ready(ecs_world_t *ecs, TbTexture tex) {
   return ecs_has(ecs, tex, TbTextureLoaded) &&
          ecs_has(ecs, tex, TbTextureComponent) &&
@@ -0,0 +1,117 @@
+#include "tb_transcode_cache.h"
+
+#include "tb_common.h"
+
+// Stored in each cache file's key/value data so that a file can be checked
+// against the source that wants it
+#define TB_TRANSCODE_KEY_NAME "TbTranscodeKey"
+
+bool tb_transcode_cache_path(const char *dir, const TbTranscodeKey *key,
+                             char *path, size_t path_size) {
+  const int32_t len =
+      SDL_snprintf(path, path_size, "%s/%016" SDL_PRIx64 "_%u.ktx2", dir,
+                   key->content_hash, key->format);
+  return len > 0 && (size_t)len < path_size;
+}
+
+bool tb_transcode_key_matches(const TbTranscodeKey *key,
+                              const TbTranscodeKey *cached) {
+  return key->content_hash == cached->content_hash &&
+         key->format == cached->format && key->width == cached->width &&
+         key->height == cached->height && key->levels == cached->levels &&
+         key->layers == cached->layers;
+}
+
+// The key stored in a cache file. Its shape is taken from the file itself
+// rather than trusted from the stored copy
+static bool tb_read_transcode_key(ktxTexture2 *ktx, TbTranscodeKey *key) {
+  uint32_t len = 0;
+  void *value = NULL;
+  ktx_error_code_e err = ktxHashList_FindValue(
+      &ktx->kvDataHead, TB_TRANSCODE_KEY_NAME, &len, &value);
+  if (err != KTX_SUCCESS || len != sizeof(TbTranscodeKey)) {
+    return false;
+  }
+  SDL_memcpy(key, value, sizeof(TbTranscodeKey)); // NOLINT
+  key->width = ktx->baseWidth;
+  key->height = ktx->baseHeight;
+  key->levels = ktx->numLevels;
+  key->layers = ktx->numLayers;
+  return true;
+}
+
+ktxTexture2 *tb_open_ktx(const char *dir, ktx_transcode_fmt_e target,
+                         const uint8_t *data, size_t size,
+                         uint64_t content_hash) {
+  TB_TRACY_SCOPE("Open KTX Texture");
+  ktxTexture2 *ktx = NULL;
+  ktx_error_code_e err = ktxTexture2_CreateFromMemory(
+      data, size, KTX_TEXTURE_CREATE_NO_FLAGS, &ktx);
+  TB_CHECK_RETURN(err == KTX_SUCCESS,
+                  "Failed to create KTX texture from memory", NULL);
+  if (!ktxTexture2_NeedsTranscoding(ktx)) {
+    return ktx;
+  }
+
+  const TbTranscodeKey key = {
+      .content_hash = content_hash,
+      .format = (uint32_t)target,
+      .width = ktx->baseWidth,
+      .height = ktx->baseHeight,
+      .levels = ktx->numLevels,
+      .layers = ktx->numLayers,
+  };
+  char cache_path[256] = {0};
+  const bool cacheable =
+      tb_transcode_cache_path(dir, &key, cache_path, sizeof(cache_path));
+
+  // Cached textures aren't supercompressed so tb_load_ktx_image reads their
+  // image data straight from the file into upload memory
+  ktxTexture2 *cached = NULL;
+  if (cacheable &&
+      ktxTexture2_CreateFromNamedFile(cache_path, KTX_TEXTURE_CREATE_NO_FLAGS,
+                                      &cached) == KTX_SUCCESS) {
+    TbTranscodeKey cached_key = {0};
+    if (!ktxTexture2_NeedsTranscoding(cached) &&
+        tb_read_transcode_key(cached, &cached_key) &&
+        tb_transcode_key_matches(&key, &cached_key)) {
+      ktxTexture_Destroy(ktxTexture(ktx));
+      return cached;
+    }
+    TB_LOG_WARN(SDL_LOG_CATEGORY_SYSTEM, "Replacing stale transcode %s",
+                cache_path);
+    ktxTexture_Destroy(ktxTexture(cached));
+  }
+
+  err = ktxTexture_LoadImageData(ktxTexture(ktx), NULL, 0);
+  TB_CHECK(err == KTX_SUCCESS, "Failed to load KTX image data");
+  {
+    TB_TRACY_SCOPE("KTX Basis Transcode");
+    err = ktxTexture2_TranscodeBasis(ktx, target, 0);
+    TB_CHECK(err == KTX_SUCCESS, "Failed to transcode basis texture");
+  }
+  if (!cacheable) {
+    return ktx;
+  }
+
+  // Written under a temporary name first so that other loads never see a
+  // partially written file
+  {
+    TB_TRACY_SCOPE("Write Transcode Cache");
+    ktxHashList_AddKVPair(&ktx->kvDataHead, TB_TRANSCODE_KEY_NAME,
+                          sizeof(TbTranscodeKey), &key);
+    char tmp_path[300] = {0};
+    SDL_snprintf(tmp_path, sizeof(tmp_path), "%s.%" SDL_PRIu64, cache_path,
+                 (uint64_t)SDL_GetCurrentThreadID());
+    err = ktxTexture2_WriteToNamedFile(ktx, tmp_path);
+    if (err == KTX_SUCCESS) {
+      SDL_RenamePath(tmp_path, cache_path);
+    } else {
+      TB_LOG_WARN(SDL_LOG_CATEGORY_SYSTEM, "Failed to cache transcoded %s",
+                  cache_path);
+    }
+    SDL_RemovePath(tmp_path);
+  }
+
+  return ktx;
+}
@@ -0,0 +1,52 @@
+#include "tb_upload_timeline.h"
+
+#include "tb_common.h"
+
+void tb_create_upload_timeline(TbAllocator alloc, bool transfer_queue,
+                               TbUploadTimeline *timeline) {
+  *timeline = (TbUploadTimeline){.transfer_queue = transfer_queue};
+  TB_DYN_ARR_RESET(timeline->pending, alloc, 64);
+  TB_DYN_ARR_RESET(timeline->ready, alloc, 64);
+}
+
+void tb_destroy_upload_timeline(TbUploadTimeline *timeline) {
+  TB_DYN_ARR_DESTROY(timeline->pending);
+  TB_DYN_ARR_DESTROY(timeline->ready);
+  *timeline = (TbUploadTimeline){0};
+}
+
+uint64_t tb_next_upload_value(TbUploadTimeline *timeline,
+                              uint64_t frame_value) {
+  timeline->submitted = SDL_max(frame_value, timeline->submitted + 1);
+  return timeline->submitted;
+}
+
+void tb_queue_upload_acquire(TbUploadTimeline *timeline,
+                             const TbQueueAcquire *acquire) {
+  TB_CHECK(timeline->transfer_queue,
+           "Only the transfer queue path transfers ownership");
+  TB_DYN_ARR_APPEND(timeline->pending, *acquire);
+}
+
+uint64_t tb_take_upload_acquires(TbUploadTimeline *timeline,
+                                 uint64_t signaled) {
+  TB_DYN_ARR_CLEAR(timeline->ready);
+  uint64_t wait_value = 0;
+  uint32_t pending_count = 0;
+  TB_DYN_ARR_FOREACH(timeline->pending, i) {
+    tb_auto acquire = &TB_DYN_ARR_AT(timeline->pending, i);
+    if (acquire->value > signaled) {
+      // Not done yet; keep it around for a later frame
+      TB_DYN_ARR_AT(timeline->pending, pending_count++) = *acquire;
+      continue;
+    }
+    TB_DYN_ARR_APPEND(timeline->ready, *acquire);
+    wait_value = SDL_max(wait_value, acquire->value);
+  }
+  TB_DYN_ARR_RESIZE(timeline->pending, pending_count);
+  return wait_value;
+}
+
+bool tb_is_upload_value_complete(uint64_t signaled, uint64_t value) {
+  return value == 0 || signaled >= value;
+}
@@ -64,6 +64,7 @@ typedef struct VLogDrawBatch {
   VkBuffer shape_geom_buffer;
   float3 shape_scale;
   uint32_t index_count;
+  uint64_t index_offset;
   uint64_t pos_offset;
   VLogShapeType type;
 } VLogDrawBatch;
@@ -117,8 +118,8 @@ void vlog_draw_record(TracyCGPUContext *gpu_ctx, VkCommandBuffer buffer,
                               batch->layout, 0, 1, &vlog_batch->view_set, 0,
                               NULL);
 
-      vkCmdBindIndexBuffer(buffer, vlog_batch->shape_geom_buffer, 0,
-                           VK_INDEX_TYPE_UINT16);
+      vkCmdBindIndexBuffer(buffer, vlog_batch->shape_geom_buffer,
+                           vlog_batch->index_offset, VK_INDEX_TYPE_UINT32);
       vkCmdBindVertexBuffers(buffer, 0, 1, &vlog_batch->shape_geom_buffer,
                              &vlog_batch->pos_offset);
 
@@ -310,25 +311,16 @@ TbVisualLoggingSystem create_visual_logging_system(
         SDL_snprintf(name, sizeof(static_name) + 1, "%s", static_name);
         sphere_mesh->name = name;
       }
-      sys.sphere_index_type = sphere_mesh->primitives->indices->stride == 2
-                                  ? VK_INDEX_TYPE_UINT16
-                                  : VK_INDEX_TYPE_UINT32;
       sys.sphere_index_count = sphere_mesh->primitives->indices->count;
 
-      uint64_t index_size =
-          sys.sphere_index_count *
-          (sys.sphere_index_type == VK_INDEX_TYPE_UINT16 ? 2 : 4);
-      uint64_t idx_padding = index_size % (sizeof(uint16_t) * 4);
-      sys.sphere_pos_offset = index_size + idx_padding;
-
       const cgltf_node *node = &data->nodes[0];
-      sys.sphere_mesh2 =
-          tb_mesh_sys_load_gltf_mesh(ecs, data, asset_path, "sphere", 0);
+      sys.sphere_mesh2 = tb_mesh_sys_load_gltf_mesh(ecs, data, 0);
       sys.sphere_scale =
           (float3){node->scale[0], node->scale[1], node->scale[2]};
     }
 
-    // cgltf_free(data);
+    // The mesh holds its own reference until it's loaded
+    tb_release_glb(data);
   }
 
   {
@@ -441,12 +433,14 @@ void vlog_draw_tick(ecs_iter_t *it) {
         // TODO: Encode line draws into the line batch
       }
 
+      tb_auto sphere_geom =
+          tb_mesh_sys_get_gpu_geometry(it->world, sys->sphere_mesh2);
       VLogDrawBatch *loc_batch = tb_alloc_tp(sys->tmp_alloc, VLogDrawBatch);
       *loc_batch = (VLogDrawBatch){
           .index_count = sys->sphere_index_count,
-          .pos_offset = sys->sphere_pos_offset,
-          .shape_geom_buffer =
-              tb_mesh_sys_get_gpu_mesh(it->world, sys->sphere_mesh2),
+          .index_offset = sphere_geom.index_offset,
+          .pos_offset = sphere_geom.position_offset,
+          .shape_geom_buffer = sphere_geom.buffer,
           .shape_scale = sys->sphere_scale,
           .type = TB_VLOG_SHAPE_LOCATION,
           .view_set =
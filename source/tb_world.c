@@ -3,6 +3,7 @@
 #include "tb_allocator.h"
 #include "tb_assets.h"
 #include "tb_common.h"
+#include "tb_frame_stats.h"
 #include "tb_gltf.h"
 #include "tb_input_system.h"
 #include "tb_material_system.h"
@@ -47,13 +48,14 @@ typedef struct TbComponentRegistry {
 
 ECS_COMPONENT_DECLARE(TbWorldRef);
 
-#ifdef TRACY_ENABLE
 typedef struct TbPhaseTracker {
   const char *name;
+  TbProfZone prof_zone;
+#ifdef TRACY_ENABLE
   TracyCZoneCtx zone;
+#endif
 } TbPhaseTracker;
 ECS_COMPONENT_DECLARE(TbPhaseTracker);
-#endif
 
 void *ecs_malloc(ecs_size_t size) {
   TB_TRACY_SCOPEC("ecs_malloc", TracyCategoryColorMemory);
@@ -177,16 +179,18 @@ void tb_write_info(TbWorld *world) {
 }
 #endif
 
-#ifdef TRACY_ENABLE
 void tb_phase_begin(ecs_iter_t *it) {
   // Find the phase that this system depends on
   tb_auto phase = ecs_get_target(it->world, it->system, EcsDependsOn, 0);
   if (ecs_has(it->world, phase, TbPhaseTracker)) {
     tb_auto tracker = ecs_get_mut(it->world, phase, TbPhaseTracker);
+    tracker->prof_zone = tb_prof_zone_begin(tracker->name);
+#ifdef TRACY_ENABLE
     TracyCZone(ctx, true);
     TracyCZoneName(ctx, tracker->name, SDL_strlen(tracker->name));
     TracyCZoneColor(ctx, TracyCategoryColorCore);
     tracker->zone = ctx;
+#endif
   }
 }
 
@@ -194,14 +198,17 @@ void tb_phase_end(ecs_iter_t *it) {
   // Find the phase that this system depends on
   tb_auto phase = ecs_get_target(it->world, it->system, EcsDependsOn, 0);
   if (ecs_has(it->world, phase, TbPhaseTracker)) {
-    tb_auto tracker = ecs_get(it->world, phase, TbPhaseTracker);
+    tb_auto tracker = ecs_get_mut(it->world, phase, TbPhaseTracker);
+    tb_prof_zone_end(&tracker->prof_zone);
+#ifdef TRACY_ENABLE
     TracyCZoneEnd(tracker->zone);
+#endif
   }
 }
-#endif
 
 bool tb_create_world(const TbWorldDesc *desc, TbWorld *world) {
   TB_TRACY_SCOPE("Create World");
+  tb_prof_set_thread_name("Main Thread");
   TbAllocator gp_alloc = desc->gp_alloc;
 
   tb_auto ecs = ecs_init();
@@ -224,9 +231,7 @@ bool tb_create_world(const TbWorldDesc *desc, TbWorld *world) {
 
   {
     ECS_COMPONENT_DEFINE(ecs, TbWorldRef);
-#ifdef TRACY_ENABLE
     ECS_COMPONENT_DEFINE(ecs, TbPhaseTracker);
-#endif
 
     TbWorldRef ref = {world};
     ecs_singleton_set_ptr(ecs, TbWorldRef, &ref);
@@ -261,7 +266,7 @@ bool tb_create_world(const TbWorldDesc *desc, TbWorld *world) {
 
   world->render_thread = render_thread;
 
-#ifdef TRACY_ENABLE
+  // Phases are tracked for both Tracy and the internal CPU profiler
   char const *const phase_names[] = {"OnStart",    "PreFrame",   "OnLoad",
                                      "PostLoad",   "PreUpdate",  "OnUpdate",
                                      "OnValidate", "PostUpdate", "PreStore",
@@ -277,7 +282,7 @@ bool tb_create_world(const TbWorldDesc *desc, TbWorld *world) {
 
   // Run a system at the top of each phase to track beginning
   for (uint32_t i = 0; i < phase_count; ++i) {
-    ecs_set(world->ecs, phases[i], TbPhaseTracker, {phase_names[i], {0}});
+    ecs_set(world->ecs, phases[i], TbPhaseTracker, {.name = phase_names[i]});
     // Create a system per phase that matches specifically the phase entity that
     // we have attached a TbPhaseTracker component to
     ecs_system(ecs, {
@@ -286,7 +291,6 @@ bool tb_create_world(const TbWorldDesc *desc, TbWorld *world) {
                         .callback = tb_phase_begin,
                     });
   }
-#endif
 
   // Create all registered systems after sorting by priority
   {
@@ -309,7 +313,6 @@ bool tb_create_world(const TbWorldDesc *desc, TbWorld *world) {
   ECS_IMPORT(ecs, FlecsStats);
 #endif
 
-#ifdef TRACY_ENABLE
   // Run a system at the bottom of each phase to track ending
   for (uint32_t i = 0; i < phase_count; ++i) {
     ecs_system(ecs, {
@@ -318,11 +321,13 @@ bool tb_create_world(const TbWorldDesc *desc, TbWorld *world) {
                         .callback = tb_phase_end,
                     });
   }
-#endif
   return true;
 }
 
 bool tb_tick_world(TbWorld *world, float delta_seconds) {
+  // Captures start and stop on frame boundaries so this must come before the
+  // world tick scope
+  tb_prof_frame();
   TB_TRACY_SCOPEC("World Tick", TracyCategoryColorCore)
   ecs_world_t *ecs = world->ecs;
 
@@ -333,6 +338,17 @@ bool tb_tick_world(TbWorld *world, float delta_seconds) {
     return false;
   }
 
+  tb_stream_scenes(ecs);
+
+  // Every system has had its chance to record stats for this frame
+  {
+    tb_auto entities = ecs_get_entities(ecs);
+    tb_auto info = ecs_get_world_info(ecs);
+    tb_frame_stat_set(TB_FRAME_STAT_ENTITIES, entities.alive_count);
+    tb_frame_stat_set(TB_FRAME_STAT_TABLES, info->table_count);
+    tb_frame_stats_end_frame(delta_seconds * 1000.0f);
+  }
+
   // Manually check flecs for quit event
   tb_auto in_sys = ecs_singleton_get(ecs, TbInputSystem);
   if (in_sys) {
@@ -375,6 +391,22 @@ TbScene tb_load_scene(TbWorld *world, const char *scene_path) {
   return tb_create_scene(world->ecs, asset_path);
 }
 
+TbScene tb_load_streamed_scene(TbWorld *world, const char *scene_path,
+                               const TbSceneStreamDesc *desc) {
+  TB_TRACY_SCOPE("Load Streamed Scene");
+  char *asset_path = tb_resolve_asset_path(world->tmp_alloc, scene_path);
+  return tb_create_streamed_scene(world->ecs, asset_path, desc);
+}
+
+void tb_unload_scene(TbWorld *world, TbScene *scene) {
+  TB_TRACY_SCOPE("Unload Scene");
+  if (*scene == 0) {
+    return;
+  }
+  tb_destroy_scene(world->ecs, *scene);
+  *scene = 0;
+}
+
 TbLoadComponentFn tb_get_component_load_fn(const char *name) {
   for (int32_t i = 0; i < s_comp_reg.count; ++i) {
     const char *comp_name = s_comp_reg.entries[i].name;
@@ -0,0 +1,239 @@
+#include "tb_test.h"
+
+#include "tb_assets.h"
+#include "tb_common.h"
+#include "tb_gltf.h"
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_stdinc.h>
+
+#define TB_ASSETS_TEST_PATH "tb_assets_test.glb"
+#define TB_ASSETS_TEST_CYCLES 100
+
+// One triangle drawn with one textured material. Each field changes one
+// thing about the glb so that tests can tell what its hashes depend on
+typedef struct TbAssetsTestGlb {
+  float base_color_r;
+  // Where the texcoord accessor starts in its buffer view
+  uint32_t uv_offset;
+  // Texcoord set the base color texture reads
+  uint32_t texcoord;
+  // Unused materials before the drawn one
+  uint32_t leading_materials;
+  // Moves a vertex without changing the bounds
+  float third_x;
+} TbAssetsTestGlb;
+
+static const TbAssetsTestGlb tb_assets_test_default = {
+    .base_color_r = 1.0f,
+};
+
+// Chunks are padded to 4 bytes, JSON with spaces
+#define TB_ASSETS_TEST_BIN_SIZE 80
+#define TB_ASSETS_TEST_JSON_MAX 2048
+
+static const char *tb_assets_test_json =
+    "{\"asset\":{\"version\":\"2.0\"},"
+    "\"buffers\":[{\"byteLength\":80}],"
+    "\"bufferViews\":["
+    "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":36},"
+    "{\"buffer\":0,\"byteOffset\":36,\"byteLength\":32},"
+    "{\"buffer\":0,\"byteOffset\":68,\"byteLength\":6},"
+    "{\"buffer\":0,\"byteOffset\":76,\"byteLength\":4}],"
+    "\"accessors\":["
+    "{\"bufferView\":0,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\","
+    "\"min\":[0,0,0],\"max\":[1,1,0]},"
+    "{\"bufferView\":1,\"byteOffset\":%u,\"componentType\":5126,"
+    "\"count\":3,\"type\":\"VEC2\"},"
+    "{\"bufferView\":2,\"componentType\":5123,\"count\":3,"
+    "\"type\":\"SCALAR\"}],"
+    "\"images\":[{\"bufferView\":3,\"mimeType\":\"image/png\"}],"
+    "\"textures\":[{\"source\":0}],"
+    "\"materials\":[%s{\"pbrMetallicRoughness\":"
+    "{\"baseColorFactor\":[%g,0.5,0.25,1],"
+    "\"baseColorTexture\":{\"index\":0,\"texCoord\":%u}}}],"
+    "\"meshes\":[{\"primitives\":[{\"attributes\":"
+    "{\"POSITION\":0,\"TEXCOORD_0\":1},\"indices\":2,\"material\":%u}]}]}";
+
+static bool tb_assets_test_write(SDL_IOStream *io, const void *data,
+                                 size_t size) {
+  return SDL_WriteIO(io, data, size) == size;
+}
+
+static bool tb_assets_test_write_glb(const char *path,
+                                     const TbAssetsTestGlb *desc) {
+  const float positions[] = {
+      0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, desc->third_x, 1.0f, 0.0f,
+  };
+  // Enough texcoords that every uv_offset reads different values
+  const float uvs[] = {
+      0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+  };
+  const uint16_t indices[] = {0, 1, 2};
+  const uint8_t image[] = {0x89, 'P', 'N', 'G'};
+  uint8_t bin[TB_ASSETS_TEST_BIN_SIZE] = {0};
+  SDL_memcpy(bin, positions, sizeof(positions));
+  SDL_memcpy(bin + 36, uvs, sizeof(uvs));
+  SDL_memcpy(bin + 68, indices, sizeof(indices));
+  SDL_memcpy(bin + 76, image, sizeof(image));
+
+  char leading[64] = {0};
+  TB_EXPECT(desc->leading_materials * 3 < sizeof(leading));
+  for (uint32_t i = 0; i < desc->leading_materials; ++i) {
+    SDL_strlcat(leading, "{},", sizeof(leading));
+  }
+  char json[TB_ASSETS_TEST_JSON_MAX] = {0};
+  const int32_t written = SDL_snprintf(
+      json, sizeof(json), tb_assets_test_json, desc->uv_offset, leading,
+      (double)desc->base_color_r, desc->texcoord, desc->leading_materials);
+  TB_EXPECT(written > 0 && written < (int32_t)sizeof(json));
+
+  const uint32_t json_len = (uint32_t)written;
+  const uint32_t json_chunk_len = (json_len + 3) & ~3u;
+  const uint32_t header[] = {
+      0x46546C67, // glTF
+      2,
+      12 + 8 + json_chunk_len + 8 + TB_ASSETS_TEST_BIN_SIZE,
+  };
+  const uint32_t json_chunk[] = {json_chunk_len, 0x4E4F534A};
+  const uint32_t bin_chunk[] = {TB_ASSETS_TEST_BIN_SIZE, 0x004E4942};
+  const char padding[4] = {' ', ' ', ' ', ' '};
+
+  SDL_IOStream *io = SDL_IOFromFile(path, "wb");
+  TB_EXPECT(io != NULL);
+  const bool ok =
+      tb_assets_test_write(io, header, sizeof(header)) &&
+      tb_assets_test_write(io, json_chunk, sizeof(json_chunk)) &&
+      tb_assets_test_write(io, json, json_len) &&
+      tb_assets_test_write(io, padding, json_chunk_len - json_len) &&
+      tb_assets_test_write(io, bin_chunk, sizeof(bin_chunk)) &&
+      tb_assets_test_write(io, bin, sizeof(bin));
+  SDL_CloseIO(io);
+  TB_EXPECT(ok);
+  return true;
+}
+
+// Every read is matched by a release and every acquire by another release
+// so that after any number of cycles the registry is back where it started
+static bool tb_glb_registry_tests(void) {
+  TB_EXPECT(
+      tb_assets_test_write_glb(TB_ASSETS_TEST_PATH, &tb_assets_test_default));
+  const uint32_t baseline = tb_glb_count();
+
+  for (uint32_t cycle = 0; cycle < TB_ASSETS_TEST_CYCLES; ++cycle) {
+    cgltf_data *a = tb_read_glb(tb_global_alloc, TB_ASSETS_TEST_PATH);
+    cgltf_data *b = tb_read_glb(tb_global_alloc, TB_ASSETS_TEST_PATH);
+    TB_EXPECT(a != NULL && b != NULL);
+    TB_EXPECT(tb_glb_count() == baseline + 2);
+    const TbAssetHash hash = tb_glb_mesh_hash(a, &a->meshes[0]);
+    TB_EXPECT(hash.hash != 0);
+
+    // Extra references keep the glb registered
+    tb_acquire_glb(a);
+    tb_acquire_glb(a);
+    tb_release_glb(a);
+    tb_release_glb(a);
+    TB_EXPECT(tb_glb_count() == baseline + 2);
+
+    // Releasing the first glb moves the second into its place, which must
+    // not lose the second's hashes
+    tb_release_glb(a);
+    TB_EXPECT(tb_glb_count() == baseline + 1);
+    TB_EXPECT(tb_glb_mesh_hash(b, &b->meshes[0]).hash == hash.hash);
+    TB_EXPECT(tb_glb_material_hash(b, &b->materials[0]).hash != 0);
+    tb_release_glb(b);
+    TB_EXPECT(tb_glb_count() == baseline);
+  }
+
+  SDL_RemovePath(TB_ASSETS_TEST_PATH);
+  return true;
+}
+
+bool tb_assets_tests(void) { return tb_glb_registry_tests(); }
+
+// The hashes of a glb's only mesh, its drawn material and its image
+typedef struct TbAssetsTestHashes {
+  TbAssetHash mesh;
+  TbAssetHash material;
+  TbAssetHash image;
+} TbAssetsTestHashes;
+
+// Each glb is written and read on its own so no two hashes share any cgltf
+// data
+static bool tb_assets_test_hash(const TbAssetsTestGlb *desc,
+                                TbAssetsTestHashes *out) {
+  TB_EXPECT(tb_assets_test_write_glb(TB_ASSETS_TEST_PATH, desc));
+  cgltf_data *data = tb_read_glb(tb_global_alloc, TB_ASSETS_TEST_PATH);
+  TB_EXPECT(data != NULL);
+  tb_auto material = data->meshes[0].primitives[0].material;
+  TB_EXPECT(material == &data->materials[desc->leading_materials]);
+  *out = (TbAssetsTestHashes){
+      .mesh = tb_glb_mesh_hash(data, &data->meshes[0]),
+      .material = tb_glb_material_hash(data, material),
+      .image = tb_glb_image_hash(data, &data->images[0]),
+  };
+  tb_release_glb(data);
+  SDL_RemovePath(TB_ASSETS_TEST_PATH);
+  return true;
+}
+
+bool tb_asset_hash_tests(void) {
+  TbAssetsTestHashes base = {0};
+  TB_EXPECT(tb_assets_test_hash(&tb_assets_test_default, &base));
+  TB_EXPECT(base.mesh.hash != 0);
+  TB_EXPECT(base.material.hash != 0);
+  TB_EXPECT(base.image.hash != 0);
+  // Indices, positions and texcoords
+  TB_EXPECT(base.mesh.size == 6 + 36 + 24);
+  TB_EXPECT(base.material.size == 4);
+  TB_EXPECT(base.image.size == 4);
+
+  // The same content built again, and moved around inside another glb,
+  // hashes the same
+  TbAssetsTestHashes same = {0};
+  TB_EXPECT(tb_assets_test_hash(&tb_assets_test_default, &same));
+  TB_EXPECT(same.mesh.hash == base.mesh.hash);
+  TB_EXPECT(same.material.hash == base.material.hash);
+  TB_EXPECT(same.image.hash == base.image.hash);
+
+  TbAssetsTestGlb desc = tb_assets_test_default;
+  desc.leading_materials = 3;
+  TB_EXPECT(tb_assets_test_hash(&desc, &same));
+  TB_EXPECT(same.mesh.hash == base.mesh.hash);
+  TB_EXPECT(same.material.hash == base.material.hash);
+  TB_EXPECT(same.image.hash == base.image.hash);
+
+  // A different factor is a different material, and the same geometry drawn
+  // with it is a different mesh
+  TbAssetsTestHashes diff = {0};
+  desc = tb_assets_test_default;
+  desc.base_color_r = 0.5f;
+  TB_EXPECT(tb_assets_test_hash(&desc, &diff));
+  TB_EXPECT(diff.material.hash != base.material.hash);
+  TB_EXPECT(diff.mesh.hash != base.mesh.hash);
+  TB_EXPECT(diff.image.hash == base.image.hash);
+
+  // So is reading the texture through another texcoord set
+  desc = tb_assets_test_default;
+  desc.texcoord = 1;
+  TB_EXPECT(tb_assets_test_hash(&desc, &diff));
+  TB_EXPECT(diff.material.hash != base.material.hash);
+  TB_EXPECT(diff.mesh.hash != base.mesh.hash);
+
+  // Reading the same buffer view from another offset is different geometry
+  desc = tb_assets_test_default;
+  desc.uv_offset = 8;
+  TB_EXPECT(tb_assets_test_hash(&desc, &diff));
+  TB_EXPECT(diff.mesh.hash != base.mesh.hash);
+  TB_EXPECT(diff.material.hash == base.material.hash);
+
+  // As is any change to the bytes of a buffer view
+  desc = tb_assets_test_default;
+  desc.third_x = 0.5f;
+  TB_EXPECT(tb_assets_test_hash(&desc, &diff));
+  TB_EXPECT(diff.mesh.hash != base.mesh.hash);
+  TB_EXPECT(diff.mesh.size == base.mesh.size);
+  TB_EXPECT(diff.material.hash == base.material.hash);
+  return true;
+}
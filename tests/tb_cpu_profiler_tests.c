@@ -0,0 +1,185 @@
+#include "tb_test.h"
+
+#include "tb_common.h"
+#include "tb_cpu_profiler.h"
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+#include <json.h>
+
+#define TB_PROF_TEST_PATH "tb_prof_test_capture.json"
+#define TB_PROF_TEST_ZONES 100
+#define TB_PROF_TEST_WORKER_ZONES 50
+
+// Names with every kind of character the capture has to escape
+static const char *tb_prof_test_thread_name = "Prof \"Test\" \\ Thread";
+static const char *tb_prof_test_worker_name = "Prof Test Worker";
+static const char *tb_prof_test_escaped_zone = "Zone \"a\" \\b\nc\td\x01";
+
+static int tb_prof_test_worker(void *data) {
+  (void)data;
+  tb_prof_set_thread_name(tb_prof_test_worker_name);
+  for (uint32_t i = 0; i < TB_PROF_TEST_WORKER_ZONES; ++i) {
+    TB_PROF_SCOPE("Worker Zone");
+  }
+  return 0;
+}
+
+static bool tb_prof_test_ignored_zones(void) {
+  for (uint32_t i = 0; i < TB_PROF_TEST_ZONES; ++i) {
+    TB_PROF_SCOPE("Ignored Zone");
+  }
+  return true;
+}
+
+static const char *tb_prof_test_get_string(json_object *obj, const char *key) {
+  json_object *value = NULL;
+  if (!json_object_object_get_ex(obj, key, &value) ||
+      !json_object_is_type(value, json_type_string)) {
+    return NULL;
+  }
+  return json_object_get_string(value);
+}
+
+static double tb_prof_test_get_double(json_object *obj, const char *key) {
+  json_object *value = NULL;
+  if (!json_object_object_get_ex(obj, key, &value)) {
+    return -1.0;
+  }
+  return json_object_get_double(value);
+}
+
+// Reads the capture back with a real JSON parser. Every name has to survive
+// the trip unchanged and every event the profiler counted has to be there
+static bool tb_prof_test_check_capture(const TbProfCaptureInfo *info) {
+  json_object *json = json_object_from_file(TB_PROF_TEST_PATH);
+  TB_EXPECT(json != NULL);
+  json_object *events = NULL;
+  TB_EXPECT(json_object_object_get_ex(json, "traceEvents", &events));
+  TB_EXPECT(json_object_is_type(events, json_type_array));
+
+  // Each thread names itself once ahead of its zones
+  const size_t count = json_object_array_length(events);
+  TB_EXPECT(count == info->threads + info->events);
+
+  uint32_t thread_names = 0;
+  uint32_t zones = 0;
+  uint32_t worker_zones = 0;
+  uint32_t escaped_zones = 0;
+  for (size_t i = 0; i < count; ++i) {
+    json_object *event = json_object_array_get_idx(events, i);
+    const char *phase = tb_prof_test_get_string(event, "ph");
+    const char *name = tb_prof_test_get_string(event, "name");
+    TB_EXPECT(phase != NULL && name != NULL);
+
+    if (SDL_strcmp(phase, "M") == 0) {
+      TB_EXPECT(SDL_strcmp(name, "thread_name") == 0);
+      json_object *args = NULL;
+      TB_EXPECT(json_object_object_get_ex(event, "args", &args));
+      const char *thread = tb_prof_test_get_string(args, "name");
+      TB_EXPECT(thread != NULL);
+      TB_EXPECT(SDL_strcmp(thread, tb_prof_test_thread_name) == 0 ||
+                SDL_strcmp(thread, tb_prof_test_worker_name) == 0);
+      thread_names++;
+      continue;
+    }
+
+    TB_EXPECT(SDL_strcmp(phase, "X") == 0);
+    TB_EXPECT(tb_prof_test_get_double(event, "ts") >= 0.0);
+    TB_EXPECT(tb_prof_test_get_double(event, "dur") >= 0.0);
+    if (SDL_strcmp(name, "Test Zone") == 0) {
+      zones++;
+    } else if (SDL_strcmp(name, "Worker Zone") == 0) {
+      worker_zones++;
+    } else {
+      TB_EXPECT(SDL_strcmp(name, tb_prof_test_escaped_zone) == 0);
+      escaped_zones++;
+    }
+  }
+  TB_EXPECT(thread_names == 2);
+  TB_EXPECT(zones == TB_PROF_TEST_ZONES);
+  TB_EXPECT(worker_zones == TB_PROF_TEST_WORKER_ZONES);
+  TB_EXPECT(escaped_zones == 1);
+
+  json_object_put(json);
+  return true;
+}
+
+// Drives a two frame capture across the main thread and a worker the way the
+// world does and checks that only zones inside it are written out
+bool tb_prof_tests(void) {
+  tb_prof_set_thread_name(tb_prof_test_thread_name);
+  TB_EXPECT(tb_prof_test_ignored_zones());
+
+  TB_EXPECT(tb_prof_request_capture(2, TB_PROF_TEST_PATH));
+  TB_EXPECT(!tb_prof_request_capture(2, TB_PROF_TEST_PATH));
+  TB_EXPECT(!tb_prof_capturing());
+  tb_prof_frame();
+  TB_EXPECT(tb_prof_capturing());
+
+  for (uint32_t i = 0; i < TB_PROF_TEST_ZONES; ++i) {
+    TB_PROF_SCOPE("Test Zone");
+  }
+  SDL_Thread *worker = SDL_CreateThread(tb_prof_test_worker,
+                                        tb_prof_test_worker_name, NULL);
+  TB_EXPECT(worker != NULL);
+  SDL_WaitThread(worker, NULL);
+  tb_prof_frame();
+  TB_EXPECT(tb_prof_capturing());
+
+  const uint64_t now = tb_prof_now();
+  tb_prof_emit(tb_prof_test_escaped_zone, now, now + 1);
+  tb_prof_frame();
+  TB_EXPECT(!tb_prof_capturing());
+  TB_EXPECT(tb_prof_test_ignored_zones());
+
+  const TbProfCaptureInfo info = tb_prof_last_capture();
+  TB_EXPECT(info.written);
+  TB_EXPECT(info.frames == 2);
+  TB_EXPECT(info.threads == 2);
+  TB_EXPECT(info.events == TB_PROF_TEST_ZONES + TB_PROF_TEST_WORKER_ZONES + 1);
+  TB_EXPECT(info.dropped == 0);
+  TB_EXPECT(tb_prof_test_check_capture(&info));
+  SDL_RemovePath(TB_PROF_TEST_PATH);
+  return true;
+}
+
+// Cost of a zone outside of a capture, which every build pays, against one
+// that is recorded. Writing the capture out is timed on its own
+bool tb_prof_bench(void) {
+  const uint32_t zones = TB_PROF_EVENTS_PER_THREAD;
+  const uint32_t runs = 8;
+  double off_ms = 0.0;
+  double on_ms = 0.0;
+  double write_ms = 0.0;
+  for (uint32_t run = 0; run < runs; ++run) {
+    double start = tb_test_seconds();
+    for (uint32_t i = 0; i < zones; ++i) {
+      TB_PROF_SCOPE("Bench Zone");
+    }
+    off_ms += (tb_test_seconds() - start) * 1000.0;
+
+    TB_EXPECT(tb_prof_request_capture(1, TB_PROF_TEST_PATH));
+    tb_prof_frame();
+    start = tb_test_seconds();
+    for (uint32_t i = 0; i < zones; ++i) {
+      TB_PROF_SCOPE("Bench Zone");
+    }
+    on_ms += (tb_test_seconds() - start) * 1000.0;
+
+    start = tb_test_seconds();
+    tb_prof_frame();
+    write_ms += (tb_test_seconds() - start) * 1000.0;
+    const TbProfCaptureInfo info = tb_prof_last_capture();
+    TB_EXPECT(info.written);
+    TB_EXPECT(info.events == zones);
+    TB_EXPECT(info.dropped == 0);
+  }
+  SDL_RemovePath(TB_PROF_TEST_PATH);
+
+  const double ns_per_zone = 1000000.0 / ((double)zones * runs);
+  printf("  %u zones: off %7.2f ns/zone, on %7.2f ns/zone, write %8.3f ms\n",
+         zones, off_ms * ns_per_zone, on_ms * ns_per_zone, write_ms / runs);
+  return true;
+}
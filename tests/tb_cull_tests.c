@@ -0,0 +1,266 @@
+#include "tb_test.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_mesh_draws.h"
+#include "tb_pi.h"
+#include "tb_simd.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+// Built the way the shadow system builds a cascade: an orthographic
+// projection looking from the near plane at eye towards the origin
+static TbFrustum tb_cull_test_shadow_frustum(float3 eye, float radius,
+                                             float depth) {
+  const float4x4 proj =
+      tb_orthographic(-radius, radius, -radius, radius, 0.0f, depth);
+  const float4x4 view = tb_look_at(eye, TB_ORIGIN, TB_UP);
+  const float4x4 vp = tb_mulf44f44(proj, view);
+  return tb_frustum_from_view_proj(&vp);
+}
+
+static TbAABB tb_cull_test_box(float3 center, float extent) {
+  const float3 e = {extent, extent, extent};
+  return (TbAABB){.min = center - e, .max = center + e};
+}
+
+// Stands in for the transform system. Owners are indices into the worlds
+// starting from 1
+static float4x4 tb_cull_test_world(void *ctx, ecs_entity_t owner) {
+  const float4x4 *worlds = ctx;
+  return worlds[owner - 1];
+}
+
+static float4x4 tb_cull_test_transform(float3 pos, float yaw, float scale) {
+  const TbTransform trans = {
+      .position = pos,
+      .scale = {scale, scale, scale},
+      .rotation = tb_angle_axis_to_quat((float4){0, 1, 0, yaw}),
+  };
+  return tb_transform_to_matrix(&trans);
+}
+
+static void tb_cull_test_add(TbMeshDraws *draws, ecs_entity_t owner,
+                             TbAABB bounds) {
+  tb_reserve_mesh_draws(draws, 1);
+  TbMeshDrawSlots slots = {.head = TB_MESH_DRAW_SLOT_NONE};
+  const TbMeshDrawRecord record = {.bounds = bounds};
+  tb_add_mesh_draw(draws, owner, &slots, &record);
+}
+
+// The mesh system's pass over its draw records: bounds are moved into world
+// space by each owner's transform and tested against every view at once
+static bool tb_mesh_cull_tests(void) {
+  const float3 eye = {0, 0, 10};
+  TbMeshCullView views[2] = {
+      {.frustum = tb_cull_test_shadow_frustum(eye, 5.0f, 20.0f)},
+      {.frustum = tb_cull_test_shadow_frustum(eye, 5.0f, 20.0f)},
+  };
+  tb_frustum_disable_plane(&views[1].frustum, NearPlane);
+
+  const float4x4 worlds[] = {
+      // Scaled up in the middle of both views
+      tb_cull_test_transform(TB_ORIGIN, 0.0f, 2.0f),
+      // Off to the side of both
+      tb_cull_test_transform((float3){50, 0, 0}, 0.0f, 1.0f),
+      // Between the light and the near plane
+      tb_cull_test_transform((float3){0, 0, 12}, 0.0f, 1.0f),
+      // Only inside once its rotation is applied
+      tb_cull_test_transform(TB_ORIGIN, TB_PI_2, 1.0f),
+  };
+  TbMeshDraws draws = {0};
+  tb_create_mesh_draws(tb_global_alloc, 2, &draws);
+  const TbAABB unit = tb_cull_test_box(TB_ORIGIN, 0.5f);
+  tb_cull_test_add(&draws, 1, unit);
+  tb_cull_test_add(&draws, 1, tb_cull_test_box((float3){1, 0, 0}, 0.5f));
+  tb_cull_test_add(&draws, 2, unit);
+  tb_cull_test_add(&draws, 3, unit);
+  tb_cull_test_add(&draws, 4, tb_cull_test_box((float3){8, 0, 0}, 1.0f));
+
+  const TbMeshVisibleDraws vis = tb_cull_mesh_draws(
+      &draws, tb_global_alloc, tb_cull_test_world, (void *)worlds, 2, views);
+  TB_EXPECT(vis.count == 4);
+  const uint32_t slots[] = {0, 1, 3, 4};
+  const uint64_t masks[] = {0x3, 0x3, 0x2, 0x3};
+  for (uint32_t i = 0; i < vis.count; ++i) {
+    TB_EXPECT(vis.slots[i] == slots[i]);
+    TB_EXPECT(vis.masks[i] == masks[i]);
+  }
+  TB_EXPECT(SDL_fabsf(vis.scales[0] - 2.0f) < 0.001f);
+  TB_EXPECT(SDL_fabsf(vis.centers[1].x - 2.0f) < 0.001f);
+  // +X turns to -Z
+  TB_EXPECT(tb_magf3(vis.centers[3] - (float3){0, 0, -8}) < 0.001f);
+
+  tb_free(tb_global_alloc, vis.slots);
+  tb_free(tb_global_alloc, vis.masks);
+  tb_free(tb_global_alloc, vis.centers);
+  tb_free(tb_global_alloc, vis.scales);
+  tb_destroy_mesh_draws(&draws);
+  return true;
+}
+
+bool tb_cull_tests(void) {
+  const float3 eye = {0, 0, 10};
+  TbFrustum frustum = tb_cull_test_shadow_frustum(eye, 5.0f, 20.0f);
+
+  const TbAABB inside = tb_cull_test_box(TB_ORIGIN, 1.0f);
+  // Between the light and the cascade, which depth clamping still rasterizes
+  const TbAABB behind_near = tb_cull_test_box((float3){0, 0, 12}, 1.0f);
+  const TbAABB beside = tb_cull_test_box((float3){50, 0, 0}, 1.0f);
+  const TbAABB past_far = tb_cull_test_box((float3){0, 0, -30}, 1.0f);
+
+  TB_EXPECT(tb_frustum_test_aabb(&frustum, &inside));
+  TB_EXPECT(!tb_frustum_test_aabb(&frustum, &behind_near));
+  TB_EXPECT(!tb_frustum_test_aabb(&frustum, &beside));
+  TB_EXPECT(!tb_frustum_test_aabb(&frustum, &past_far));
+
+  tb_frustum_disable_plane(&frustum, NearPlane);
+  TB_EXPECT(tb_frustum_test_aabb(&frustum, &inside));
+  TB_EXPECT(tb_frustum_test_aabb(&frustum, &behind_near));
+  TB_EXPECT(!tb_frustum_test_aabb(&frustum, &beside));
+  TB_EXPECT(!tb_frustum_test_aabb(&frustum, &past_far));
+  TB_EXPECT(tb_frustum_test_sphere(&frustum, (float3){0, 0, 12}, 1.0f));
+  return tb_mesh_cull_tests();
+}
+
+// Compares culling every draw against all views in one pass, the way the mesh
+// system does it, against one pass over the draws per view
+bool tb_cull_bench(void) {
+  const uint32_t draw_count = 100000;
+  const int32_t iterations = 10;
+  const uint32_t view_counts[] = {1, 2, 6};
+
+  TbFrustum frustums[6] = {0};
+  {
+    const float4x4 proj = tb_perspective(TB_PI_2, 16.0f / 9.0f, 0.1f, 500.0f);
+    const float4x4 view = tb_look_at((float3){0, 10, 50}, TB_ORIGIN, TB_UP);
+    const float4x4 vp = tb_mulf44f44(proj, view);
+    frustums[0] = tb_frustum_from_view_proj(&vp);
+  }
+  for (uint32_t i = 1; i < 6; ++i) {
+    const float radius = 16.0f * (float)i;
+    const float3 eye = {radius, 4.0f * radius, radius};
+    frustums[i] = tb_cull_test_shadow_frustum(eye, radius, 8.0f * radius);
+    tb_frustum_disable_plane(&frustums[i], NearPlane);
+  }
+
+  tb_auto boxes = tb_alloc_nm_tp(tb_global_alloc, draw_count, TbAABB);
+  tb_auto masks = tb_alloc_nm_tp(tb_global_alloc, draw_count, uint64_t);
+  uint64_t seed = 11;
+  for (uint32_t i = 0; i < draw_count; ++i) {
+    const float3 center = {
+        (float)(tb_test_rand(&seed) % 2000) * 0.1f - 100.0f,
+        (float)(tb_test_rand(&seed) % 400) * 0.1f - 20.0f,
+        (float)(tb_test_rand(&seed) % 2000) * 0.1f - 100.0f,
+    };
+    const float extent = 0.25f + (float)(tb_test_rand(&seed) % 8) * 0.25f;
+    boxes[i] = tb_cull_test_box(center, extent);
+  }
+
+  printf("  %u draws, mean of %d runs\n", draw_count, iterations);
+  for (uint32_t c = 0; c < sizeof(view_counts) / sizeof(uint32_t); ++c) {
+    const uint32_t view_count = view_counts[c];
+    uint64_t visible = 0;
+
+    double start = tb_test_seconds();
+    for (int32_t it = 0; it < iterations; ++it) {
+      for (uint32_t i = 0; i < draw_count; ++i) {
+        uint64_t mask = 0;
+        for (uint32_t v = 0; v < view_count; ++v) {
+          if (tb_frustum_test_aabb(&frustums[v], &boxes[i])) {
+            mask |= 1ull << v;
+          }
+        }
+        masks[i] = mask;
+      }
+    }
+    const double one_pass = tb_test_seconds() - start;
+    for (uint32_t i = 0; i < draw_count; ++i) {
+      visible += (uint64_t)__builtin_popcountll(masks[i]);
+    }
+
+    start = tb_test_seconds();
+    for (int32_t it = 0; it < iterations; ++it) {
+      SDL_memset(masks, 0, sizeof(uint64_t) * draw_count); // NOLINT
+      for (uint32_t v = 0; v < view_count; ++v) {
+        for (uint32_t i = 0; i < draw_count; ++i) {
+          if (tb_frustum_test_aabb(&frustums[v], &boxes[i])) {
+            masks[i] |= 1ull << v;
+          }
+        }
+      }
+    }
+    const double per_view = tb_test_seconds() - start;
+
+    const double ms = 1000.0 / iterations;
+    printf("  %u view(s): one pass %8.3f ms, pass per view %8.3f ms, "
+           "%" SDL_PRIu64 " visible\n",
+           view_count, one_pass * ms, per_view * ms, visible);
+  }
+
+  tb_free(tb_global_alloc, boxes);
+  tb_free(tb_global_alloc, masks);
+  return true;
+}
+
+// Times the mesh system's cull of a scene's worth of submeshes against a
+// camera and four shadow cascades
+bool tb_mesh_cull_bench(void) {
+  const uint32_t instance_count = 12500;
+  const uint32_t submesh_count = 4;
+  const int32_t iterations = 10;
+  const uint32_t view_count = 5;
+
+  TbMeshCullView views[5] = {0};
+  {
+    const float4x4 proj = tb_perspective(TB_PI_2, 16.0f / 9.0f, 0.1f, 500.0f);
+    const float4x4 view = tb_look_at((float3){0, 10, 50}, TB_ORIGIN, TB_UP);
+    const float4x4 vp = tb_mulf44f44(proj, view);
+    views[0].frustum = tb_frustum_from_view_proj(&vp);
+  }
+  for (uint32_t i = 1; i < view_count; ++i) {
+    const float radius = 16.0f * (float)i;
+    const float3 eye = {radius, 4.0f * radius, radius};
+    views[i].frustum = tb_cull_test_shadow_frustum(eye, radius, 8.0f * radius);
+    tb_frustum_disable_plane(&views[i].frustum, NearPlane);
+  }
+
+  tb_auto worlds = tb_alloc_nm_tp(tb_global_alloc, instance_count, float4x4);
+  TbMeshDraws draws = {0};
+  tb_create_mesh_draws(tb_global_alloc, instance_count * submesh_count,
+                       &draws);
+  uint64_t seed = 28;
+  for (uint32_t i = 0; i < instance_count; ++i) {
+    const float3 pos = {
+        (float)(tb_test_rand(&seed) % 2000) * 0.1f - 100.0f,
+        (float)(tb_test_rand(&seed) % 400) * 0.1f - 20.0f,
+        (float)(tb_test_rand(&seed) % 2000) * 0.1f - 100.0f,
+    };
+    const float yaw = (float)(tb_test_rand(&seed) % 360) * (TB_PI / 180.0f);
+    worlds[i] = tb_cull_test_transform(pos, yaw, 1.0f);
+    for (uint32_t sm = 0; sm < submesh_count; ++sm) {
+      const float3 center = {(float)sm, 0, 0};
+      tb_cull_test_add(&draws, i + 1, tb_cull_test_box(center, 0.5f));
+    }
+  }
+
+  uint32_t visible = 0;
+  const double start = tb_test_seconds();
+  for (int32_t it = 0; it < iterations; ++it) {
+    const TbMeshVisibleDraws vis =
+        tb_cull_mesh_draws(&draws, tb_global_alloc, tb_cull_test_world,
+                           worlds, view_count, views);
+    visible = vis.count;
+    tb_free(tb_global_alloc, vis.slots);
+    tb_free(tb_global_alloc, vis.masks);
+    tb_free(tb_global_alloc, vis.centers);
+    tb_free(tb_global_alloc, vis.scales);
+  }
+  const double ms = (tb_test_seconds() - start) * 1000.0 / iterations;
+  printf("  %u submeshes, %u views, mean of %d runs: %8.3f ms, %u visible\n",
+         draws.slot_count, view_count, iterations, ms, visible);
+
+  tb_destroy_mesh_draws(&draws);
+  tb_free(tb_global_alloc, worlds);
+  return true;
+}
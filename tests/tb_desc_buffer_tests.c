@@ -0,0 +1,79 @@
+#include "tb_test.h"
+
+#include "tb_common.h"
+#include "tb_descriptor_buffer.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#define TB_DESC_BUFFER_TEST_SPAN 4096
+#define TB_DESC_BUFFER_TEST_MAX_COPIES 64
+
+// Which bytes of the buffer a set of copies uploads
+static void tb_desc_buffer_test_cover(uint32_t count,
+                                      const TbBufferCopy *copies,
+                                      bool *covered) {
+  SDL_memset(covered, 0, TB_DESC_BUFFER_TEST_SPAN * sizeof(bool));
+  for (uint32_t i = 0; i < count; ++i) {
+    tb_auto region = &copies[i].region;
+    for (VkDeviceSize b = 0; b < region->size; ++b) {
+      covered[region->dstOffset + b] = true;
+    }
+  }
+}
+
+// Descriptor sized writes land anywhere in the buffer, in any order and
+// sometimes on top of each other. Merging must upload exactly the same bytes
+// with copies that are sorted and never touch
+static bool tb_merge_buffer_copies_tests(void) {
+  const VkDeviceSize sizes[] = {16, 32, 64};
+  bool expected[TB_DESC_BUFFER_TEST_SPAN] = {0};
+  bool covered[TB_DESC_BUFFER_TEST_SPAN] = {0};
+  TbBufferCopy copies[TB_DESC_BUFFER_TEST_MAX_COPIES] = {0};
+  uint64_t seed = 0xDE5C;
+  for (uint32_t run = 0; run < 200; ++run) {
+    const uint32_t count =
+        (uint32_t)(tb_test_rand(&seed) % TB_DESC_BUFFER_TEST_MAX_COPIES);
+    for (uint32_t i = 0; i < count; ++i) {
+      const VkDeviceSize size = sizes[tb_test_rand(&seed) % 3];
+      const VkDeviceSize offset =
+          (tb_test_rand(&seed) % (TB_DESC_BUFFER_TEST_SPAN / 16)) * 16;
+      copies[i] = (TbBufferCopy){
+          .region =
+              {
+                  .srcOffset = offset,
+                  .dstOffset = offset,
+                  .size = SDL_min(size, TB_DESC_BUFFER_TEST_SPAN - offset),
+              },
+      };
+    }
+    tb_desc_buffer_test_cover(count, copies, expected);
+
+    const uint32_t merged = tb_merge_buffer_copies(count, copies);
+    TB_EXPECT(merged <= count);
+    TB_EXPECT((merged == 0) == (count == 0));
+    for (uint32_t i = 0; i < merged; ++i) {
+      TB_EXPECT(copies[i].region.srcOffset == copies[i].region.dstOffset);
+      TB_EXPECT(copies[i].region.size > 0);
+      if (i > 0) {
+        tb_auto prev = &copies[i - 1].region;
+        TB_EXPECT(prev->dstOffset + prev->size < copies[i].region.dstOffset);
+      }
+    }
+    tb_desc_buffer_test_cover(merged, copies, covered);
+    TB_EXPECT(SDL_memcmp(expected, covered, sizeof(covered)) == 0);
+  }
+
+  // Every binding of one slot rewritten in reverse is a single upload
+  for (uint32_t i = 0; i < 4; ++i) {
+    const VkDeviceSize offset = 256 + (3 - i) * 32;
+    copies[i] = (TbBufferCopy){
+        .region = {.srcOffset = offset, .dstOffset = offset, .size = 32},
+    };
+  }
+  TB_EXPECT(tb_merge_buffer_copies(4, copies) == 1);
+  TB_EXPECT(copies[0].region.dstOffset == 256);
+  TB_EXPECT(copies[0].region.size == 128);
+  return true;
+}
+
+bool tb_desc_buffer_tests(void) { return tb_merge_buffer_copies_tests(); }
@@ -0,0 +1,177 @@
+#include "tb_test.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_dyn_desc_pool.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+// Nothing here is handed to a device so any non-null value works as a handle
+static VkImageView tb_dyn_desc_test_view(uint32_t i) {
+  return (VkImageView)(uintptr_t)(i + 1);
+}
+
+static TbDynDescWrite tb_dyn_desc_test_write(uint32_t i) {
+  return (TbDynDescWrite){
+      .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+      .desc.image =
+          {
+              .imageView = tb_dyn_desc_test_view(i),
+              .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+          },
+  };
+}
+
+// Flushes one frame state and checks that it gathered a single ranged write
+// covering [first, first + count) with views made from base + index
+static bool tb_dyn_desc_test_flush_run(TbDynDescPool *pool, uint32_t frame_idx,
+                                       uint32_t first, uint32_t count,
+                                       uint32_t base) {
+  VkWriteDescriptorSet *writes = NULL;
+  const uint32_t write_count =
+      tb_flush_dyn_desc_pool(pool, frame_idx, tb_global_alloc, &writes);
+  bool ok = write_count == 1 && writes[0].dstArrayElement == first &&
+            writes[0].descriptorCount == count;
+  for (uint32_t i = 0; ok && i < count; ++i) {
+    ok = writes[0].pImageInfo[i].imageView ==
+         tb_dyn_desc_test_view(base + first + i);
+  }
+  tb_free(tb_global_alloc, writes);
+  return ok;
+}
+
+static uint32_t tb_dyn_desc_test_flush_count(TbDynDescPool *pool,
+                                             uint32_t frame_idx) {
+  VkWriteDescriptorSet *writes = NULL;
+  const uint32_t write_count =
+      tb_flush_dyn_desc_pool(pool, frame_idx, tb_global_alloc, &writes);
+  tb_free(tb_global_alloc, writes);
+  return write_count;
+}
+
+// The caller's writes may be freed right after tb_write_dyn_desc_pool. Every
+// frame state must still see the descriptors when it is flushed later
+static bool tb_dyn_desc_lifetime_tests(void) {
+  const uint32_t count = 64;
+  TbDynDescPool pool = {0};
+  tb_init_dyn_desc_storage(tb_global_alloc, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                           256, &pool);
+
+  tb_auto writes = tb_alloc_nm_tp(tb_global_alloc, count, TbDynDescWrite);
+  for (uint32_t i = 0; i < count; ++i) {
+    writes[i] = tb_dyn_desc_test_write(i);
+  }
+  uint32_t idxs[64] = {0};
+  TB_EXPECT(tb_write_dyn_desc_pool(&pool, count, writes, idxs));
+  SDL_memset(writes, 0xcd, count * sizeof(TbDynDescWrite));
+  tb_free(tb_global_alloc, writes);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    TB_EXPECT(idxs[i] == i);
+  }
+  for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+    TB_EXPECT(tb_dyn_desc_test_flush_run(&pool, frame_idx, 0, count, 0));
+    // A frame state is only written once
+    TB_EXPECT(tb_dyn_desc_test_flush_count(&pool, frame_idx) == 0);
+  }
+
+  // Only the latest update reaches a set and the run around it stays whole
+  TbDynDescWrite update = tb_dyn_desc_test_write(1000);
+  tb_update_dyn_desc(&pool, 10, &update);
+  update = tb_dyn_desc_test_write(10);
+  tb_update_dyn_desc(&pool, 10, &update);
+  update = tb_dyn_desc_test_write(11);
+  tb_update_dyn_desc(&pool, 11, &update);
+  TB_EXPECT(tb_dyn_desc_test_flush_run(&pool, 0, 10, 2, 0));
+
+  // Null descriptors are dropped which splits the run
+  update = (TbDynDescWrite){.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE};
+  tb_update_dyn_desc(&pool, 20, &update);
+  update = tb_dyn_desc_test_write(21);
+  tb_update_dyn_desc(&pool, 21, &update);
+  for (uint32_t frame_idx = 1; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+    TB_EXPECT(tb_dyn_desc_test_flush_count(&pool, frame_idx) == 2);
+  }
+  TB_EXPECT(tb_dyn_desc_test_flush_count(&pool, 0) == 1);
+
+  // Released indices come back once every frame state is past them
+  const uint32_t free_count = TB_DYN_ARR_SIZE(pool.free_list);
+  tb_release_dyn_desc(&pool, 5);
+  for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES; ++frame_idx) {
+    tb_dyn_desc_test_flush_count(&pool, frame_idx);
+    TB_EXPECT(TB_DYN_ARR_SIZE(pool.free_list) == free_count);
+  }
+  tb_dyn_desc_test_flush_count(&pool, 0);
+  TB_EXPECT(TB_DYN_ARR_SIZE(pool.free_list) == free_count + 1);
+
+  tb_destroy_dyn_desc_storage(&pool);
+  return true;
+}
+
+bool tb_dyn_desc_tests(void) { return tb_dyn_desc_lifetime_tests(); }
+
+// Writes as many texture descriptors as a large scene streams in at once and
+// flushes them to every frame state
+bool tb_dyn_desc_bench(void) {
+  const uint32_t count = 50000;
+  const int32_t iterations = 10;
+
+  tb_auto writes = tb_alloc_nm_tp(tb_global_alloc, count, TbDynDescWrite);
+  for (uint32_t i = 0; i < count; ++i) {
+    writes[i] = tb_dyn_desc_test_write(i);
+  }
+  tb_auto idxs = tb_alloc_nm_tp(tb_global_alloc, count, uint32_t);
+
+  double write_time = 0;
+  double flush_time = 0;
+  double update_time = 0;
+  uint32_t update_writes = 0;
+  uint64_t seed = 41;
+  for (int32_t it = 0; it < iterations; ++it) {
+    TbDynDescPool pool = {0};
+    tb_init_dyn_desc_storage(tb_global_alloc,
+                             VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 65536, &pool);
+
+    double start = tb_test_seconds();
+    TB_EXPECT(tb_write_dyn_desc_pool(&pool, count, writes, idxs));
+    write_time += tb_test_seconds() - start;
+
+    for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES;
+         ++frame_idx) {
+      start = tb_test_seconds();
+      VkWriteDescriptorSet *set_writes = NULL;
+      const uint32_t write_count = tb_flush_dyn_desc_pool(
+          &pool, frame_idx, tb_global_alloc, &set_writes);
+      flush_time += tb_test_seconds() - start;
+      TB_EXPECT(write_count == 1 && set_writes[0].descriptorCount == count);
+      tb_free(tb_global_alloc, set_writes);
+    }
+
+    // Textures finishing their streams in a random order
+    start = tb_test_seconds();
+    for (uint32_t i = 0; i < count / 10; ++i) {
+      const uint32_t idx = (uint32_t)(tb_test_rand(&seed) % count);
+      tb_update_dyn_desc(&pool, idx, &writes[idx]);
+    }
+    for (uint32_t frame_idx = 0; frame_idx < TB_MAX_FRAME_STATES;
+         ++frame_idx) {
+      update_writes += tb_dyn_desc_test_flush_count(&pool, frame_idx);
+    }
+    update_time += tb_test_seconds() - start;
+
+    tb_destroy_dyn_desc_storage(&pool);
+  }
+
+  const double ms = 1000.0 / iterations;
+  printf("  %u descriptors, %d frame states, mean of %d runs\n", count,
+         TB_MAX_FRAME_STATES, iterations);
+  printf("  write %8.3f ms, flush %8.3f ms per frame state\n", write_time * ms,
+         flush_time * ms / TB_MAX_FRAME_STATES);
+  printf("  %u random updates: %8.3f ms, %u ranged writes per frame state\n",
+         count / 10, update_time * ms,
+         update_writes / (iterations * TB_MAX_FRAME_STATES));
+
+  tb_free(tb_global_alloc, idxs);
+  tb_free(tb_global_alloc, writes);
+  return true;
+}
@@ -0,0 +1,160 @@
+#include "tb_test.h"
+
+#include "tb_dyn_res.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+// Frames between picking a scale and its GPU time being measured
+#define TB_DYN_RES_TEST_LAG 3
+#define TB_DYN_RES_TEST_TARGET 16.0f
+// The controller aims right at the budget so allow for rounding
+#define TB_DYN_RES_TEST_LIMIT (TB_DYN_RES_TEST_TARGET * 1.001f)
+
+// Stands in for the GPU: a frame costs the scene's full resolution time
+// scaled by the pixel count and its time arrives a few frames later
+typedef struct TbDynResTestSim {
+  TbDynResController ctrl;
+  float in_flight[TB_DYN_RES_TEST_LAG];
+  uint32_t frame;
+  uint32_t changes; // Frames where the scale changed
+  float last_ms;    // Latest time fed to the controller
+} TbDynResTestSim;
+
+static void tb_dyn_res_test_init(TbDynResTestSim *sim, float min_scale,
+                                 float max_scale) {
+  *sim = (TbDynResTestSim){0};
+  tb_dyn_res_init(&sim->ctrl, TB_DYN_RES_TEST_TARGET, min_scale, max_scale);
+}
+
+// Runs one frame of a scene that takes full_ms at full resolution
+static float tb_dyn_res_test_step(TbDynResTestSim *sim, float full_ms) {
+  const float scale = sim->ctrl.scale;
+  const uint32_t slot = sim->frame++ % TB_DYN_RES_TEST_LAG;
+  // Nothing has been measured until the first frame makes it through
+  const float measured = sim->in_flight[slot];
+  sim->in_flight[slot] = full_ms * scale * scale;
+  sim->last_ms = measured;
+  const float next = tb_dyn_res_update(&sim->ctrl, measured);
+  if (next != scale) {
+    sim->changes++;
+  }
+  return next;
+}
+
+static bool tb_dyn_res_steady_tests(void) {
+  TbDynResTestSim sim = {0};
+  tb_dyn_res_test_init(&sim, 0.5f, 1.0f);
+  // Comfortably inside the budget never drops resolution
+  for (uint32_t i = 0; i < 1000; ++i) {
+    TB_EXPECT(tb_dyn_res_test_step(&sim, 10.0f) == 1.0f);
+  }
+  TB_EXPECT(sim.changes == 0);
+
+  // Just over the budget settles on one scale rather than hunting around it
+  tb_dyn_res_test_init(&sim, 0.5f, 1.0f);
+  for (uint32_t i = 0; i < 200; ++i) {
+    tb_dyn_res_test_step(&sim, 17.0f);
+  }
+  const float settled = sim.ctrl.scale;
+  TB_EXPECT(settled < 1.0f);
+  sim.changes = 0;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    tb_dyn_res_test_step(&sim, 17.0f);
+  }
+  TB_EXPECT(sim.changes == 0);
+  TB_EXPECT(sim.ctrl.scale == settled);
+  TB_EXPECT(sim.last_ms <= TB_DYN_RES_TEST_LIMIT);
+
+  // Missing samples leave the scale alone
+  TB_EXPECT(tb_dyn_res_update(&sim.ctrl, 0.0f) == settled);
+  TB_EXPECT(tb_dyn_res_update(&sim.ctrl, -1.0f) == settled);
+  return true;
+}
+
+static bool tb_dyn_res_spike_tests(void) {
+  TbDynResTestSim sim = {0};
+  tb_dyn_res_test_init(&sim, 0.5f, 1.0f);
+  for (uint32_t i = 0; i < 100; ++i) {
+    tb_dyn_res_test_step(&sim, 10.0f);
+  }
+
+  // The first slow frame to be measured drops the scale
+  uint32_t reaction = 0;
+  while (tb_dyn_res_test_step(&sim, 30.0f) == 1.0f) {
+    reaction++;
+    TB_EXPECT(reaction <= TB_DYN_RES_TEST_LAG);
+  }
+  TB_EXPECT(sim.last_ms == 30.0f);
+
+  // Back under budget within a fraction of a second and never overshooting
+  // into a lower scale than the scene needs
+  uint32_t frames = 0;
+  while (sim.last_ms > TB_DYN_RES_TEST_LIMIT) {
+    tb_dyn_res_test_step(&sim, 30.0f);
+    TB_EXPECT(++frames < 60);
+  }
+  const float needed = SDL_sqrtf(TB_DYN_RES_TEST_TARGET / 30.0f);
+  TB_EXPECT(sim.ctrl.scale <= needed * 1.001f);
+  TB_EXPECT(sim.ctrl.scale >= needed * 0.85f);
+  for (uint32_t i = 0; i < 200; ++i) {
+    tb_dyn_res_test_step(&sim, 30.0f);
+    TB_EXPECT(sim.last_ms <= TB_DYN_RES_TEST_LIMIT);
+  }
+  return true;
+}
+
+static bool tb_dyn_res_recovery_tests(void) {
+  TbDynResTestSim sim = {0};
+  tb_dyn_res_test_init(&sim, 0.5f, 1.0f);
+  for (uint32_t i = 0; i < 200; ++i) {
+    tb_dyn_res_test_step(&sim, 30.0f);
+  }
+  TB_EXPECT(sim.ctrl.scale < 1.0f);
+
+  // Once the load goes away the scale only climbs, in small steps, and makes
+  // it all the way back to full resolution within a couple of seconds
+  float prev = sim.ctrl.scale;
+  uint32_t frames = 0;
+  while (sim.ctrl.scale < 1.0f) {
+    const float scale = tb_dyn_res_test_step(&sim, 10.0f);
+    TB_EXPECT(scale >= prev);
+    TB_EXPECT(scale <= prev * 1.06f);
+    TB_EXPECT(sim.last_ms <= TB_DYN_RES_TEST_LIMIT);
+    prev = scale;
+    TB_EXPECT(++frames < 120);
+  }
+  TB_EXPECT(sim.ctrl.scale == 1.0f);
+  return true;
+}
+
+static bool tb_dyn_res_clamp_tests(void) {
+  TbDynResTestSim sim = {0};
+  tb_dyn_res_test_init(&sim, 0.5f, 1.0f);
+  for (uint32_t i = 0; i < 500; ++i) {
+    const float scale = tb_dyn_res_test_step(&sim, 200.0f);
+    TB_EXPECT(scale >= 0.5f);
+  }
+  TB_EXPECT(sim.ctrl.scale == 0.5f);
+
+  // Starts at the max and never goes past it no matter the headroom
+  tb_dyn_res_test_init(&sim, 0.5f, 0.75f);
+  TB_EXPECT(sim.ctrl.scale == 0.75f);
+  for (uint32_t i = 0; i < 500; ++i) {
+    const float scale = tb_dyn_res_test_step(&sim, 1.0f);
+    TB_EXPECT(scale <= 0.75f);
+  }
+  TB_EXPECT(sim.ctrl.scale == 0.75f);
+
+  // A fixed scale never moves
+  tb_dyn_res_test_init(&sim, 0.6f, 0.6f);
+  for (uint32_t i = 0; i < 500; ++i) {
+    tb_dyn_res_test_step(&sim, (i / 50) % 2 ? 40.0f : 2.0f);
+  }
+  TB_EXPECT(sim.changes == 0);
+  return true;
+}
+
+bool tb_dyn_res_tests(void) {
+  return tb_dyn_res_steady_tests() && tb_dyn_res_spike_tests() &&
+         tb_dyn_res_recovery_tests() && tb_dyn_res_clamp_tests();
+}
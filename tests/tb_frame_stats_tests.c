@@ -0,0 +1,150 @@
+#include "tb_test.h"
+
+#include "tb_common.h"
+#include "tb_frame_stats.h"
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+
+#define TB_FRAME_STATS_TEST_THREADS 4
+#define TB_FRAME_STATS_TEST_ADDS 100000
+#define TB_FRAME_STATS_TEST_CSV "tb_frame_stats_test.csv"
+
+// The history is global so every test clears the levels it relies on and
+// only looks at frames it ended itself
+static void tb_frame_stats_test_clear_levels(void) {
+  for (int32_t stat = TB_FRAME_STAT_TMP_BYTES; stat < TB_FRAME_STAT_COUNT;
+       ++stat) {
+    tb_frame_stat_set((TbFrameStat)stat, 0);
+  }
+}
+
+static bool tb_frame_stats_ring_tests(void) {
+  tb_frame_stats_test_clear_levels();
+  const uint32_t frame_count = TB_FRAME_STATS_HISTORY + 44;
+  for (uint32_t i = 0; i < frame_count; ++i) {
+    tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, i);
+    tb_frame_stats_end_frame((float)i);
+  }
+  TB_EXPECT(tb_frame_stats_count() == TB_FRAME_STATS_HISTORY);
+
+  // Age 0 is the last frame ended and the oldest frames were overwritten
+  const uint64_t last = tb_frame_stats_get(0)->frame;
+  for (uint32_t age = 0; age < TB_FRAME_STATS_HISTORY; ++age) {
+    tb_auto sample = tb_frame_stats_get(age);
+    const uint32_t i = frame_count - 1 - age;
+    TB_EXPECT(sample->frame == last - age);
+    TB_EXPECT(sample->frame_ms == (float)i);
+    TB_EXPECT(sample->values[TB_FRAME_STAT_DRAW_CALLS] == i);
+  }
+  return true;
+}
+
+static bool tb_frame_stats_level_tests(void) {
+  tb_frame_stats_test_clear_levels();
+  tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, 5);
+  tb_frame_stat_add(TB_FRAME_STAT_UPLOAD_BYTES, 1ll << 40);
+  tb_frame_stat_set(TB_FRAME_STAT_ENTITIES, 42);
+  tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, 3);
+  tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, -1);
+  tb_frame_stats_end_frame(1.0f);
+
+  // Nothing recorded: counters go back to 0 while levels carry over
+  tb_frame_stats_end_frame(2.0f);
+  tb_frame_stat_add(TB_FRAME_STAT_LOADS_IN_FLIGHT, -2);
+  tb_frame_stats_end_frame(3.0f);
+
+  tb_auto first = tb_frame_stats_get(2);
+  tb_auto second = tb_frame_stats_get(1);
+  tb_auto third = tb_frame_stats_get(0);
+  TB_EXPECT(first->values[TB_FRAME_STAT_DRAW_CALLS] == 5);
+  TB_EXPECT(first->values[TB_FRAME_STAT_UPLOAD_BYTES] == 1ll << 40);
+  TB_EXPECT(first->values[TB_FRAME_STAT_ENTITIES] == 42);
+  TB_EXPECT(first->values[TB_FRAME_STAT_LOADS_IN_FLIGHT] == 2);
+  TB_EXPECT(second->values[TB_FRAME_STAT_DRAW_CALLS] == 0);
+  TB_EXPECT(second->values[TB_FRAME_STAT_UPLOAD_BYTES] == 0);
+  TB_EXPECT(second->values[TB_FRAME_STAT_ENTITIES] == 42);
+  TB_EXPECT(second->values[TB_FRAME_STAT_LOADS_IN_FLIGHT] == 2);
+  TB_EXPECT(third->values[TB_FRAME_STAT_ENTITIES] == 42);
+  TB_EXPECT(third->values[TB_FRAME_STAT_LOADS_IN_FLIGHT] == 0);
+  TB_EXPECT(third->frame == first->frame + 2);
+  return true;
+}
+
+typedef struct TbFrameStatsTestThread {
+  SDL_AtomicInt *start;
+  SDL_AtomicInt *finished;
+} TbFrameStatsTestThread;
+
+static int32_t tb_frame_stats_test_thread(void *data) {
+  TbFrameStatsTestThread *args = data;
+  while (SDL_GetAtomicInt(args->start) == 0) {
+  }
+  for (uint32_t i = 0; i < TB_FRAME_STATS_TEST_ADDS; ++i) {
+    tb_frame_stat_add(TB_FRAME_STAT_DRAW_CALLS, 1);
+    tb_frame_stat_add(TB_FRAME_STAT_TRIANGLES, 3);
+  }
+  SDL_AddAtomicInt(args->finished, 1);
+  return 0;
+}
+
+// Worker threads record while the main thread keeps ending frames. Every
+// value must land in exactly one frame
+static bool tb_frame_stats_thread_tests(void) {
+  tb_frame_stats_test_clear_levels();
+  // Drop anything left open by earlier tests
+  tb_frame_stats_end_frame(0.0f);
+
+  SDL_AtomicInt start = {0};
+  SDL_AtomicInt finished = {0};
+  TbFrameStatsTestThread args = {.start = &start, .finished = &finished};
+  SDL_Thread *threads[TB_FRAME_STATS_TEST_THREADS] = {0};
+  for (uint32_t i = 0; i < TB_FRAME_STATS_TEST_THREADS; ++i) {
+    threads[i] = SDL_CreateThread(tb_frame_stats_test_thread,
+                                  "Frame Stats Test", &args);
+    TB_EXPECT(threads[i] != NULL);
+  }
+
+  int64_t draws = 0;
+  int64_t tris = 0;
+  SDL_SetAtomicInt(&start, 1);
+  bool done = false;
+  while (!done) {
+    // One more frame after every thread is finished collects what's left
+    done = SDL_GetAtomicInt(&finished) == TB_FRAME_STATS_TEST_THREADS;
+    tb_frame_stats_end_frame(0.0f);
+    tb_auto sample = tb_frame_stats_get(0);
+    draws += sample->values[TB_FRAME_STAT_DRAW_CALLS];
+    tris += sample->values[TB_FRAME_STAT_TRIANGLES];
+  }
+  for (uint32_t i = 0; i < TB_FRAME_STATS_TEST_THREADS; ++i) {
+    SDL_WaitThread(threads[i], NULL);
+  }
+
+  const int64_t adds =
+      (int64_t)TB_FRAME_STATS_TEST_THREADS * TB_FRAME_STATS_TEST_ADDS;
+  TB_EXPECT(draws == adds);
+  TB_EXPECT(tris == adds * 3);
+  return true;
+}
+
+// A path that can't be opened is reported rather than taken down the app
+static bool tb_frame_stats_csv_tests(void) {
+  tb_frame_stats_end_frame(1.0f);
+  TB_EXPECT(tb_frame_stats_write_csv(TB_FRAME_STATS_TEST_CSV));
+  SDL_PathInfo info = {0};
+  TB_EXPECT(SDL_GetPathInfo(TB_FRAME_STATS_TEST_CSV, &info));
+  TB_EXPECT(info.size > 0);
+  SDL_RemovePath(TB_FRAME_STATS_TEST_CSV);
+
+  TB_EXPECT(
+      !tb_frame_stats_write_csv("tb_missing_dir/" TB_FRAME_STATS_TEST_CSV));
+  return true;
+}
+
+bool tb_frame_stats_tests(void) {
+  return tb_frame_stats_ring_tests() && tb_frame_stats_level_tests() &&
+         tb_frame_stats_thread_tests() && tb_frame_stats_csv_tests();
+}
@@ -0,0 +1,169 @@
+#include "tb_test.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_sort.h"
+#include "tb_task_scheduler.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <TaskScheduler_c.h>
+
+#define TB_LOAD_QUEUE_TEST_MAX_IN_FLIGHT 128
+
+static const TbLoadPriority tb_load_queue_test_priorities[] = {
+    -1.5f, 0.0f, 0.25f, 2.0f, 2.0f, 64.0f, 1e6f,
+};
+
+// Pending loads in the order the asset systems would find them
+typedef struct TbLoadQueueTest {
+  TbArenaAllocator arena;
+  uint32_t count;
+  TbLoadQueueEntry *entries;
+  uint64_t seed;
+} TbLoadQueueTest;
+
+// Drives a queue far past the parallel limit the way the asset systems do:
+// every frame some loads finish, some of what's pending is cancelled and the
+// free slots are refilled from what's left. Nothing new is queued so loads
+// must go out strictly from the highest priority down
+static bool tb_load_queue_test_run(TbTaskScheduler enki, uint32_t count,
+                                   uint64_t seed) {
+  TbLoadQueueTest t = {.count = count, .seed = seed};
+  tb_create_arena_alloc("Load Queue Test Arena", &t.arena, 16 * 1024 * 1024);
+  t.entries = tb_alloc_nm_tp(tb_global_alloc, count, TbLoadQueueEntry);
+  const uint32_t priority_count = sizeof(tb_load_queue_test_priorities) /
+                                  sizeof(tb_load_queue_test_priorities[0]);
+  for (uint32_t i = 0; i < count; ++i) {
+    t.entries[i] = (TbLoadQueueEntry){
+        .ent = i + 1,
+        .priority = tb_load_queue_test_priorities[tb_test_rand(&t.seed) %
+                                                  priority_count],
+    };
+  }
+
+  uint32_t in_flight = 0;
+  uint32_t dispatched_total = 0;
+  uint32_t dropped_total = 0;
+  TbLoadQueueEntry last = {.priority = 1e30f};
+  while (t.count > 0) {
+    t.arena = tb_reset_arena(t.arena, false);
+    tb_auto tmp_alloc = t.arena.alloc;
+
+    // Finish some loads and cancel a few pending ones
+    in_flight -= (uint32_t)(tb_test_rand(&t.seed) % (in_flight + 1));
+    for (uint32_t i = 0; i < t.count; ++i) {
+      if (tb_test_rand(&t.seed) % 64 == 0) {
+        t.entries[i].cancelled = true;
+      }
+    }
+
+    TbLoadQueue queue = {0};
+    TB_DYN_ARR_RESET(queue, tmp_alloc, t.count);
+    for (uint32_t i = 0; i < t.count; ++i) {
+      TB_DYN_ARR_APPEND(queue, t.entries[i]);
+    }
+    const uint32_t slot_count = TB_LOAD_QUEUE_TEST_MAX_IN_FLIGHT - in_flight;
+    tb_auto dispatch =
+        tb_plan_load_dispatch(enki, tmp_alloc, &queue, slot_count);
+
+    uint32_t cancelled = 0;
+    for (uint32_t i = 0; i < t.count; ++i) {
+      cancelled += t.entries[i].cancelled ? 1 : 0;
+    }
+    TB_EXPECT(dispatch.dropped_count == cancelled);
+    TB_EXPECT(dispatch.count == SDL_min(slot_count, t.count - cancelled));
+
+    // Only cancelled entries are dropped, each once
+    for (uint32_t i = 0; i < dispatch.dropped_count; ++i) {
+      const uint32_t idx = dispatch.dropped[i];
+      TB_EXPECT(idx < t.count);
+      TB_EXPECT(t.entries[idx].cancelled);
+      t.entries[idx].ent = 0;
+    }
+
+    // Dispatched from the highest priority down with ties in queue order,
+    // carrying on from where the last frame left off
+    for (uint32_t i = 0; i < dispatch.count; ++i) {
+      const uint32_t idx = dispatch.order[i];
+      TB_EXPECT(idx < t.count);
+      tb_auto entry = t.entries[idx];
+      TB_EXPECT(entry.ent != 0);
+      TB_EXPECT(!entry.cancelled);
+      TB_EXPECT(entry.priority <= last.priority);
+      if (entry.priority == last.priority) {
+        TB_EXPECT(entry.ent > last.ent);
+      }
+      last = entry;
+      t.entries[idx].ent = 0;
+    }
+
+    // Whatever is left waits for a later frame
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < t.count; ++i) {
+      if (t.entries[i].ent != 0) {
+        TB_EXPECT(!t.entries[i].cancelled);
+        TB_EXPECT(t.entries[i].priority <= last.priority);
+        t.entries[kept++] = t.entries[i];
+      }
+    }
+    TB_EXPECT(kept == t.count - dispatch.count - dispatch.dropped_count);
+    t.count = kept;
+
+    in_flight += dispatch.count;
+    TB_EXPECT(in_flight <= TB_LOAD_QUEUE_TEST_MAX_IN_FLIGHT);
+    dispatched_total += dispatch.count;
+    dropped_total += dispatch.dropped_count;
+  }
+  TB_EXPECT(dispatched_total + dropped_total == count);
+  TB_EXPECT(dropped_total > 0);
+
+  tb_free(tb_global_alloc, t.entries);
+  tb_destroy_arena_alloc(t.arena);
+  return true;
+}
+
+// A saturated queue with every slot taken still drops what was cancelled
+static bool tb_load_queue_saturated_tests(void) {
+  TbArenaAllocator arena = {0};
+  tb_create_arena_alloc("Load Queue Test Arena", &arena, 1024 * 1024);
+  TbLoadQueue queue = {0};
+  TB_DYN_ARR_RESET(queue, arena.alloc, 8);
+  TB_DYN_ARR_APPEND(queue, ((TbLoadQueueEntry){1, 1.0f, false}));
+  TB_DYN_ARR_APPEND(queue, ((TbLoadQueueEntry){2, 5.0f, true}));
+  TB_DYN_ARR_APPEND(queue, ((TbLoadQueueEntry){3, 3.0f, false}));
+  TB_DYN_ARR_APPEND(queue, ((TbLoadQueueEntry){4, -2.0f, true}));
+
+  tb_auto dispatch = tb_plan_load_dispatch(NULL, arena.alloc, &queue, 0);
+  TB_EXPECT(dispatch.count == 0);
+  TB_EXPECT(dispatch.dropped_count == 2);
+  TB_EXPECT(dispatch.dropped[0] == 1);
+  TB_EXPECT(dispatch.dropped[1] == 3);
+
+  dispatch = tb_plan_load_dispatch(NULL, arena.alloc, &queue, 1);
+  TB_EXPECT(dispatch.count == 1);
+  TB_EXPECT(dispatch.order[0] == 2);
+  TB_EXPECT(dispatch.dropped_count == 2);
+
+  // An empty queue has nothing to do
+  TB_DYN_ARR_CLEAR(queue);
+  dispatch = tb_plan_load_dispatch(NULL, arena.alloc, &queue, 4);
+  TB_EXPECT(dispatch.count == 0);
+  TB_EXPECT(dispatch.dropped_count == 0);
+
+  tb_destroy_arena_alloc(arena);
+  return true;
+}
+
+bool tb_load_queue_tests(void) {
+  TB_EXPECT(tb_load_queue_saturated_tests());
+  TB_EXPECT(tb_load_queue_test_run(NULL, 1000, 0x10AD));
+
+  // Large enough for the parallel sort
+  tb_auto enki = enkiNewTaskScheduler();
+  enkiInitTaskScheduler(enki);
+  const bool ok =
+      tb_load_queue_test_run(enki, TB_RADIX_SORT_PARALLEL_MIN * 2, 0xBEEF);
+  enkiDeleteTaskScheduler(enki);
+  TB_EXPECT(ok);
+  return true;
+}
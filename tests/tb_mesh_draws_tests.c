@@ -0,0 +1,302 @@
+#include "tb_test.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_mesh_draws.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#define TB_MESH_DRAW_TEST_INSTANCES 64
+#define TB_MESH_DRAW_TEST_MAX_SUBMESHES 4
+#define TB_MESH_DRAW_TEST_MATERIALS 8
+#define TB_MESH_DRAW_TEST_CAPACITY 256
+
+// Stands in for a mesh instance entity and the components its records are
+// built from
+typedef struct TbMeshDrawTestInstance {
+  ecs_entity_t entity;
+  uint32_t obj_idx;
+  uint32_t submesh_count;
+  TbMaterial materials[TB_MESH_DRAW_TEST_MAX_SUBMESHES];
+  bool drawn;
+  TbMeshDrawSlots slots;
+} TbMeshDrawTestInstance;
+
+typedef struct TbMeshDrawTestScene {
+  TbMeshDraws draws;
+  TbMeshDrawTestInstance instances[TB_MESH_DRAW_TEST_INSTANCES];
+  uint64_t seed;
+} TbMeshDrawTestScene;
+
+static TbMaterial tb_mesh_draw_test_material(uint64_t *seed) {
+  return 1000 + tb_test_rand(seed) % TB_MESH_DRAW_TEST_MATERIALS;
+}
+
+static void tb_mesh_draw_test_init(TbMeshDrawTestScene *scene,
+                                   uint32_t capacity) {
+  *scene = (TbMeshDrawTestScene){.seed = 27};
+  tb_create_mesh_draws(tb_global_alloc, capacity, &scene->draws);
+  for (uint32_t i = 0; i < TB_MESH_DRAW_TEST_INSTANCES; ++i) {
+    tb_auto inst = &scene->instances[i];
+    inst->entity = 100 + i;
+    inst->obj_idx = i;
+    inst->submesh_count =
+        1 + tb_test_rand(&scene->seed) % TB_MESH_DRAW_TEST_MAX_SUBMESHES;
+    for (uint32_t sm = 0; sm < inst->submesh_count; ++sm) {
+      inst->materials[sm] = tb_mesh_draw_test_material(&scene->seed);
+    }
+  }
+}
+
+// Mirrors how the mesh system writes an instance that became drawable
+static bool tb_mesh_draw_test_add(TbMeshDrawTestScene *scene,
+                                  TbMeshDrawTestInstance *inst) {
+  tb_reserve_mesh_draws(&scene->draws, inst->submesh_count);
+  inst->slots = (TbMeshDrawSlots){.head = TB_MESH_DRAW_SLOT_NONE};
+  for (uint32_t sm = 0; sm < inst->submesh_count; ++sm) {
+    TbMeshDrawRecord record = {
+        .data = {.obj_idx = inst->obj_idx, .index_offset = sm},
+        .index_count = 3 * (sm + 1),
+        .material = inst->materials[sm],
+    };
+    const uint32_t slot =
+        tb_add_mesh_draw(&scene->draws, inst->entity, &inst->slots, &record);
+    TB_EXPECT(slot != TB_MESH_DRAW_SLOT_NONE);
+    TB_EXPECT(slot >= scene->draws.dirty_min);
+    TB_EXPECT(slot <= scene->draws.dirty_max);
+  }
+  inst->drawn = true;
+  return true;
+}
+
+static void tb_mesh_draw_test_remove(TbMeshDrawTestScene *scene,
+                                     TbMeshDrawTestInstance *inst) {
+  tb_free_mesh_draws(&scene->draws, &inst->slots);
+  inst->slots = (TbMeshDrawSlots){0};
+  inst->drawn = false;
+}
+
+// Every drawn instance must own exactly its submeshes' records, every other
+// slot below the high water mark must be free and no slot may be both
+static bool tb_mesh_draw_test_check(const TbMeshDrawTestScene *scene) {
+  const TbMeshDraws *draws = &scene->draws;
+  tb_auto seen = tb_alloc_nm_tp(tb_global_alloc, draws->capacity, uint8_t);
+  SDL_memset(seen, 0, draws->capacity);
+  bool ok = true;
+
+  uint32_t owned = 0;
+  for (uint32_t i = 0; ok && i < TB_MESH_DRAW_TEST_INSTANCES; ++i) {
+    tb_auto inst = &scene->instances[i];
+    if (!inst->drawn) {
+      continue;
+    }
+    ok = inst->slots.count == inst->submesh_count;
+    bool submesh_seen[TB_MESH_DRAW_TEST_MAX_SUBMESHES] = {0};
+    uint32_t slot = inst->slots.head;
+    for (uint32_t n = 0; ok && n < inst->slots.count; ++n) {
+      ok = slot < draws->slot_count && !seen[slot];
+      if (!ok) {
+        break;
+      }
+      seen[slot] = 1;
+      tb_auto record = &draws->records[slot];
+      const uint32_t sm = record->data.index_offset;
+      ok = record->owner == inst->entity &&
+           record->data.obj_idx == inst->obj_idx &&
+           sm < inst->submesh_count && !submesh_seen[sm] &&
+           record->material == inst->materials[sm] &&
+           record->index_count == 3 * (sm + 1);
+      submesh_seen[sm] = true;
+      slot = record->next;
+      owned++;
+    }
+  }
+
+  TB_DYN_ARR_FOREACH(draws->free_slots, i) {
+    const uint32_t slot = TB_DYN_ARR_AT(draws->free_slots, i);
+    ok = ok && slot < draws->capacity && !seen[slot] &&
+         draws->records[slot].owner == 0;
+    if (ok) {
+      seen[slot] = 2;
+    }
+  }
+  ok = ok && owned + TB_DYN_ARR_SIZE(draws->free_slots) == draws->capacity;
+  for (uint32_t slot = 0; ok && slot < draws->slot_count; ++slot) {
+    ok = (seen[slot] == 1) == (draws->records[slot].owner != 0);
+  }
+
+  // Every owned slot is in exactly the chain of its material
+  uint32_t indexed = 0;
+  TbMaterial prev_mat = 0;
+  TB_DYN_ARR_FOREACH(draws->materials, m) {
+    tb_auto entry = &TB_DYN_ARR_AT(draws->materials, m);
+    ok = ok && entry->material > prev_mat &&
+         entry->head != TB_MESH_DRAW_SLOT_NONE &&
+         tb_mesh_draws_material_head(draws, entry->material) == entry->head;
+    prev_mat = entry->material;
+    uint32_t prev = TB_MESH_DRAW_SLOT_NONE;
+    uint32_t slot = entry->head;
+    while (ok && slot != TB_MESH_DRAW_SLOT_NONE) {
+      tb_auto record = &draws->records[slot];
+      ok = slot < draws->capacity && seen[slot] == 1 &&
+           record->material == entry->material && record->mat_prev == prev &&
+           ++indexed <= owned;
+      prev = slot;
+      slot = record->mat_next;
+    }
+  }
+  ok = ok && indexed == owned;
+
+  tb_free(tb_global_alloc, seen);
+  return ok;
+}
+
+static bool tb_mesh_draws_churn_tests(void) {
+  TbMeshDrawTestScene scene = {0};
+  tb_mesh_draw_test_init(&scene, TB_MESH_DRAW_TEST_CAPACITY);
+
+  uint32_t live = 0;
+  for (uint32_t i = 0; i < TB_MESH_DRAW_TEST_INSTANCES; ++i) {
+    TB_EXPECT(tb_mesh_draw_test_add(&scene, &scene.instances[i]));
+    live += scene.instances[i].submesh_count;
+  }
+  TB_EXPECT(scene.draws.slot_count == live);
+  TB_EXPECT(tb_mesh_draw_test_check(&scene));
+  tb_clear_mesh_draws_dirty(&scene.draws);
+  TB_EXPECT(scene.draws.dirty_min > scene.draws.dirty_max);
+  const uint32_t peak = scene.draws.slot_count;
+
+  // Entities being disabled and enabled again, or their render object or
+  // materials changing, drop their records and write new ones
+  for (uint32_t step = 0; step < 10000; ++step) {
+    tb_auto inst = &scene.instances[tb_test_rand(&scene.seed) %
+                                    TB_MESH_DRAW_TEST_INSTANCES];
+    switch (tb_test_rand(&scene.seed) % 3) {
+    case 0: // Toggle
+      if (inst->drawn) {
+        tb_mesh_draw_test_remove(&scene, inst);
+      } else {
+        TB_EXPECT(tb_mesh_draw_test_add(&scene, inst));
+      }
+      break;
+    case 1: // New render object
+      if (inst->drawn) {
+        tb_mesh_draw_test_remove(&scene, inst);
+        inst->obj_idx += TB_MESH_DRAW_TEST_INSTANCES;
+        TB_EXPECT(tb_mesh_draw_test_add(&scene, inst));
+      }
+      break;
+    default: { // New material on one submesh
+      const uint32_t sm = tb_test_rand(&scene.seed) % inst->submesh_count;
+      inst->materials[sm] = tb_mesh_draw_test_material(&scene.seed);
+      if (inst->drawn) {
+        tb_mesh_draw_test_remove(&scene, inst);
+        TB_EXPECT(tb_mesh_draw_test_add(&scene, inst));
+      }
+      break;
+    }
+    }
+    if (step % 64 == 0) {
+      TB_EXPECT(tb_mesh_draw_test_check(&scene));
+    }
+  }
+  TB_EXPECT(tb_mesh_draw_test_check(&scene));
+  // Freed slots are reused before new ones so churn never spreads the records
+  TB_EXPECT(scene.draws.slot_count == peak);
+
+  for (uint32_t i = 0; i < TB_MESH_DRAW_TEST_INSTANCES; ++i) {
+    if (scene.instances[i].drawn) {
+      tb_mesh_draw_test_remove(&scene, &scene.instances[i]);
+    }
+  }
+  TB_EXPECT(tb_mesh_draw_test_check(&scene));
+  TB_EXPECT(TB_DYN_ARR_SIZE(scene.draws.free_slots) == scene.draws.capacity);
+
+  tb_destroy_mesh_draws(&scene.draws);
+  return true;
+}
+
+// Scenes bigger than the pool grow it. Records that were already written
+// keep their slots since indirect commands and the GPU copy refer to them
+static bool tb_mesh_draws_grow_tests(void) {
+  TbMeshDrawTestScene scene = {0};
+  tb_mesh_draw_test_init(&scene, 16);
+  uint32_t heads[TB_MESH_DRAW_TEST_INSTANCES] = {0};
+  uint32_t live = 0;
+  for (uint32_t i = 0; i < TB_MESH_DRAW_TEST_INSTANCES; ++i) {
+    tb_auto inst = &scene.instances[i];
+    TB_EXPECT(tb_mesh_draw_test_add(&scene, inst));
+    heads[i] = inst->slots.head;
+    live += inst->submesh_count;
+    // Every earlier instance is untouched by the growth
+    for (uint32_t j = 0; j <= i; ++j) {
+      TB_EXPECT(scene.instances[j].slots.head == heads[j]);
+    }
+    TB_EXPECT(tb_mesh_draw_test_check(&scene));
+  }
+  TB_EXPECT(scene.draws.capacity >= live);
+  TB_EXPECT(scene.draws.slot_count == live);
+
+  // Slots freed before a growth are still handed out before new ones
+  tb_auto inst = &scene.instances[0];
+  const uint32_t head = inst->slots.head;
+  tb_mesh_draw_test_remove(&scene, inst);
+  tb_reserve_mesh_draws(&scene.draws, scene.draws.capacity);
+  TB_EXPECT(tb_mesh_draw_test_add(&scene, inst));
+  TB_EXPECT(inst->slots.head == head);
+  TB_EXPECT(scene.draws.slot_count == live);
+  TB_EXPECT(tb_mesh_draw_test_check(&scene));
+
+  tb_destroy_mesh_draws(&scene.draws);
+  return true;
+}
+
+// Walking a material's chain finds every instance drawing with it and
+// nothing else, which is what rebuilding them on a material change relies on
+static bool tb_mesh_draws_material_tests(void) {
+  TbMeshDrawTestScene scene = {0};
+  tb_mesh_draw_test_init(&scene, TB_MESH_DRAW_TEST_CAPACITY);
+  for (uint32_t i = 0; i < TB_MESH_DRAW_TEST_INSTANCES; ++i) {
+    TB_EXPECT(tb_mesh_draw_test_add(&scene, &scene.instances[i]));
+  }
+
+  for (uint32_t m = 0; m < TB_MESH_DRAW_TEST_MATERIALS + 1; ++m) {
+    const TbMaterial mat = 1000 + m;
+    bool found[TB_MESH_DRAW_TEST_INSTANCES] = {0};
+    uint32_t slot = tb_mesh_draws_material_head(&scene.draws, mat);
+    while (slot != TB_MESH_DRAW_SLOT_NONE) {
+      tb_auto record = &scene.draws.records[slot];
+      TB_EXPECT(record->material == mat);
+      found[record->owner - 100] = true;
+      slot = record->mat_next;
+    }
+    for (uint32_t i = 0; i < TB_MESH_DRAW_TEST_INSTANCES; ++i) {
+      tb_auto inst = &scene.instances[i];
+      bool uses = false;
+      for (uint32_t sm = 0; inst->drawn && sm < inst->submesh_count; ++sm) {
+        uses = uses || inst->materials[sm] == mat;
+      }
+      TB_EXPECT(found[i] == uses);
+    }
+
+    // Dropping every instance found, as a material change does, leaves the
+    // material with no slots and the rest of the index intact
+    for (uint32_t i = 0; i < TB_MESH_DRAW_TEST_INSTANCES; ++i) {
+      if (found[i]) {
+        tb_mesh_draw_test_remove(&scene, &scene.instances[i]);
+      }
+    }
+    TB_EXPECT(tb_mesh_draws_material_head(&scene.draws, mat) ==
+              TB_MESH_DRAW_SLOT_NONE);
+    TB_EXPECT(tb_mesh_draw_test_check(&scene));
+  }
+  TB_EXPECT(TB_DYN_ARR_EMPTY(scene.draws.materials));
+
+  tb_destroy_mesh_draws(&scene.draws);
+  return true;
+}
+
+bool tb_mesh_draws_tests(void) {
+  return tb_mesh_draws_churn_tests() && tb_mesh_draws_grow_tests() &&
+         tb_mesh_draws_material_tests();
+}
@@ -0,0 +1,229 @@
+#include "tb_test.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_mesh_opt.h"
+#include "tb_pi.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+// A UV sphere, which every simplification level can make progress on and
+// whose meshlets have well defined normal cones
+static TbPrimGeometry tb_mesh_opt_test_sphere(uint32_t rings,
+                                              uint32_t segments) {
+  TbPrimGeometry geom = {
+      .vertex_count = (rings + 1) * (segments + 1),
+      .index_count = rings * segments * 6,
+  };
+  geom.positions =
+      tb_alloc_nm_tp(tb_global_alloc, geom.vertex_count * 3, float);
+  geom.indices = tb_alloc_nm_tp(tb_global_alloc, geom.index_count, uint32_t);
+
+  float *pos = geom.positions;
+  for (uint32_t r = 0; r <= rings; ++r) {
+    const float phi = TB_PI * (float)r / (float)rings;
+    for (uint32_t s = 0; s <= segments; ++s) {
+      const float theta = 2.0f * TB_PI * (float)s / (float)segments;
+      *pos++ = SDL_sinf(phi) * SDL_cosf(theta);
+      *pos++ = SDL_cosf(phi);
+      *pos++ = SDL_sinf(phi) * SDL_sinf(theta);
+    }
+  }
+  uint32_t *idx = geom.indices;
+  for (uint32_t r = 0; r < rings; ++r) {
+    for (uint32_t s = 0; s < segments; ++s) {
+      const uint32_t a = r * (segments + 1) + s;
+      const uint32_t b = a + segments + 1;
+      *idx++ = a;
+      *idx++ = a + 1;
+      *idx++ = b;
+      *idx++ = a + 1;
+      *idx++ = b + 1;
+      *idx++ = b;
+    }
+  }
+  return geom;
+}
+
+static void tb_mesh_opt_test_free(TbPrimGeometry *geom) {
+  tb_free(tb_global_alloc, geom->positions);
+  tb_free(tb_global_alloc, geom->indices);
+  *geom = (TbPrimGeometry){0};
+}
+
+typedef struct TbMeshOptTestTri {
+  uint32_t idx[3];
+} TbMeshOptTestTri;
+
+static int32_t tb_mesh_opt_test_tri_cmp(const void *a, const void *b) {
+  const TbMeshOptTestTri *x = a;
+  const TbMeshOptTestTri *y = b;
+  for (uint32_t i = 0; i < 3; ++i) {
+    if (x->idx[i] != y->idx[i]) {
+      return x->idx[i] < y->idx[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// Triangles rotated to start at their lowest index, keeping the winding, and
+// sorted so that two index buffers can be compared as sets of triangles
+static TbMeshOptTestTri *tb_mesh_opt_test_tris(const uint32_t *indices,
+                                               size_t index_count) {
+  const size_t tri_count = index_count / 3;
+  tb_auto tris = tb_alloc_nm_tp(tb_global_alloc, tri_count, TbMeshOptTestTri);
+  for (size_t t = 0; t < tri_count; ++t) {
+    const uint32_t *src = &indices[t * 3];
+    uint32_t first = 0;
+    for (uint32_t i = 1; i < 3; ++i) {
+      if (src[i] < src[first]) {
+        first = i;
+      }
+    }
+    for (uint32_t i = 0; i < 3; ++i) {
+      tris[t].idx[i] = src[(first + i) % 3];
+    }
+  }
+  SDL_qsort(tris, tri_count, sizeof(TbMeshOptTestTri),
+            tb_mesh_opt_test_tri_cmp);
+  return tris;
+}
+
+static float3 tb_mesh_opt_test_pos(const TbPrimGeometry *geom, uint32_t v) {
+  const float *p = &geom->positions[v * 3];
+  return tb_f3(p[0], p[1], p[2]);
+}
+
+static bool tb_mesh_opt_meshlet_tests(void) {
+  TbPrimGeometry geom = tb_mesh_opt_test_sphere(48, 96);
+  tb_auto dst = tb_alloc_nm_tp(tb_global_alloc, geom.index_count, uint32_t);
+  tb_auto seen = tb_alloc_nm_tp(tb_global_alloc, geom.vertex_count, uint32_t);
+  SDL_memset(seen, 0, geom.vertex_count * sizeof(uint32_t));
+
+  const TbSubMeshMeshlets meshlets = tb_build_meshlets(&geom, false, dst);
+  TB_EXPECT(meshlets.count > 1);
+
+  // Ranges are back to back from the first index to the last
+  uint32_t index_offset = 0;
+  for (uint32_t i = 0; i < meshlets.count; ++i) {
+    tb_auto meshlet = &meshlets.meshlets[i];
+    TB_EXPECT(meshlet->index_offset == index_offset);
+    TB_EXPECT(meshlet->index_count > 0);
+    TB_EXPECT(meshlet->index_count % 3 == 0);
+    TB_EXPECT(meshlet->index_count <= TB_MESHLET_MAX_TRIANGLES * 3);
+    TB_EXPECT(meshlet->cone_cutoff <= 1.0f);
+
+    // Stays within its vertex limit and its bounds hold every vertex
+    uint32_t vertex_count = 0;
+    for (uint32_t n = 0; n < meshlet->index_count; ++n) {
+      const uint32_t v = dst[meshlet->index_offset + n];
+      TB_EXPECT(v < geom.vertex_count);
+      if (seen[v] != i + 1) {
+        seen[v] = i + 1;
+        vertex_count++;
+      }
+      const float3 to_v = tb_mesh_opt_test_pos(&geom, v) - meshlet->center;
+      TB_EXPECT(tb_magf3(to_v) <= meshlet->radius * 1.001f + 0.0001f);
+    }
+    TB_EXPECT(vertex_count <= TB_MESHLET_MAX_VERTICES);
+    index_offset += meshlet->index_count;
+  }
+  TB_EXPECT(index_offset == geom.index_count);
+
+  // Together they draw exactly the primitive's triangles, each once and with
+  // its winding intact
+  tb_auto expected = tb_mesh_opt_test_tris(geom.indices, geom.index_count);
+  tb_auto actual = tb_mesh_opt_test_tris(dst, geom.index_count);
+  TB_EXPECT(SDL_memcmp(expected, actual,
+                       geom.index_count / 3 * sizeof(TbMeshOptTestTri)) == 0);
+  tb_free(tb_global_alloc, expected);
+  tb_free(tb_global_alloc, actual);
+  tb_free(tb_global_alloc, (void *)meshlets.meshlets);
+
+  // Double sided primitives never cull by normal cone
+  const TbSubMeshMeshlets double_sided = tb_build_meshlets(&geom, true, dst);
+  TB_EXPECT(double_sided.count == meshlets.count);
+  for (uint32_t i = 0; i < double_sided.count; ++i) {
+    TB_EXPECT(double_sided.meshlets[i].cone_cutoff > 1.0f);
+  }
+  tb_free(tb_global_alloc, (void *)double_sided.meshlets);
+  tb_free(tb_global_alloc, seen);
+  tb_free(tb_global_alloc, dst);
+  tb_mesh_opt_test_free(&geom);
+
+  // Small primitives are left alone
+  geom = tb_mesh_opt_test_sphere(8, 8);
+  TB_EXPECT(geom.index_count / 3 < TB_MESHLET_MIN_TRIANGLES);
+  uint32_t untouched = 0xABCDABCD;
+  TB_EXPECT(tb_build_meshlets(&geom, false, &untouched).count == 0);
+  TB_EXPECT(untouched == 0xABCDABCD);
+  tb_mesh_opt_test_free(&geom);
+  return true;
+}
+
+static bool tb_mesh_opt_lod_tests(void) {
+  TbPrimGeometry geom = tb_mesh_opt_test_sphere(48, 96);
+  TbPrimLods lods = tb_build_lods(&geom);
+  TB_EXPECT(lods.lods.count > 1);
+  TB_EXPECT(lods.lods.count <= TB_MESH_MAX_LODS);
+  TB_EXPECT(lods.lods.lods[0].index_count == geom.index_count);
+  TB_EXPECT(lods.lods.lods[0].error == 0.0f);
+
+  // Each level is coarser than the last and never claims to be more accurate,
+  // which lets selection stop at the first level that is too coarse
+  for (uint32_t lod = 1; lod < lods.lods.count; ++lod) {
+    tb_auto prev = &lods.lods.lods[lod - 1];
+    tb_auto info = &lods.lods.lods[lod];
+    TB_EXPECT(info->index_count > 0);
+    TB_EXPECT(info->index_count % 3 == 0);
+    TB_EXPECT(info->index_count < prev->index_count);
+    TB_EXPECT(info->error >= prev->error);
+    TB_EXPECT(lods.indices[lod] != NULL);
+    for (uint32_t n = 0; n < info->index_count; ++n) {
+      TB_EXPECT(lods.indices[lod][n] < geom.vertex_count);
+    }
+  }
+  tb_free_lods(&lods);
+  tb_mesh_opt_test_free(&geom);
+
+  // Small primitives are always drawn at full detail
+  geom = tb_mesh_opt_test_sphere(8, 8);
+  TB_EXPECT(geom.index_count / 3 < TB_MESH_LOD_MIN_TRIANGLES);
+  lods = tb_build_lods(&geom);
+  TB_EXPECT(lods.lods.count == 0);
+  tb_free_lods(&lods);
+  tb_mesh_opt_test_free(&geom);
+  return true;
+}
+
+bool tb_mesh_opt_tests(void) {
+  return tb_mesh_opt_meshlet_tests() && tb_mesh_opt_lod_tests();
+}
+
+// Load time cost of building the LOD chain and meshlets of a large primitive
+bool tb_mesh_opt_bench(void) {
+  const uint32_t sizes[][2] = {{128, 256}, {256, 512}};
+  for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+    TbPrimGeometry geom = tb_mesh_opt_test_sphere(sizes[i][0], sizes[i][1]);
+    tb_auto dst = tb_alloc_nm_tp(tb_global_alloc, geom.index_count, uint32_t);
+
+    double start = tb_test_seconds();
+    TbPrimLods lods = tb_build_lods(&geom);
+    const double lod_ms = (tb_test_seconds() - start) * 1000.0;
+
+    start = tb_test_seconds();
+    const TbSubMeshMeshlets meshlets = tb_build_meshlets(&geom, false, dst);
+    const double meshlet_ms = (tb_test_seconds() - start) * 1000.0;
+
+    printf("  %8zu tris: LODs %9.3f ms (%u levels), meshlets %9.3f ms "
+           "(%u)\n",
+           geom.index_count / 3, lod_ms, lods.lods.count, meshlet_ms,
+           meshlets.count);
+
+    tb_free(tb_global_alloc, (void *)meshlets.meshlets);
+    tb_free_lods(&lods);
+    tb_free(tb_global_alloc, dst);
+    tb_mesh_opt_test_free(&geom);
+  }
+  return true;
+}
@@ -0,0 +1,158 @@
+#include "tb_test.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_mesh_ranges.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#define TB_MESH_RANGES_TEST_INDICES (1u << 16)
+#define TB_MESH_RANGES_TEST_VERTICES (1u << 14)
+#define TB_MESH_RANGES_TEST_MAX_ALLOCS 256
+#define TB_MESH_RANGES_TEST_LIVE 32
+#define TB_MESH_RANGES_TEST_CYCLES 100
+
+// A range along with its sizes and, once released, the first frame that may
+// hand it out again
+typedef struct TbMeshRangesTestRange {
+  TbMeshArenaRange range;
+  uint32_t index_count;
+  uint32_t vertex_count;
+  uint32_t free_frame;
+} TbMeshRangesTestRange;
+
+static bool tb_mesh_ranges_test_overlap(uint32_t a_offset, uint32_t a_size,
+                                        uint32_t b_offset, uint32_t b_size) {
+  return a_offset < b_offset + b_size && b_offset < a_offset + a_size;
+}
+
+// Neither the live ranges nor ranges a frame in flight may still draw from can
+// be handed out to the new range
+static bool tb_mesh_ranges_test_disjoint(const TbMeshRangesTestRange *busy,
+                                         uint32_t busy_count,
+                                         const TbMeshRangesTestRange *r) {
+  for (uint32_t i = 0; i < busy_count; ++i) {
+    tb_auto other = &busy[i];
+    if (tb_mesh_ranges_test_overlap(
+            other->range.index_alloc.offset, other->index_count,
+            r->range.index_alloc.offset, r->index_count) ||
+        tb_mesh_ranges_test_overlap(
+            other->range.vertex_alloc.offset, other->vertex_count,
+            r->range.vertex_alloc.offset, r->vertex_count)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool tb_mesh_ranges_cycle_tests(void) {
+  TbMeshRanges ranges = {0};
+  tb_create_mesh_ranges(tb_global_alloc, TB_MESH_RANGES_TEST_INDICES,
+                        TB_MESH_RANGES_TEST_VERTICES,
+                        TB_MESH_RANGES_TEST_MAX_ALLOCS, &ranges);
+  const uint32_t free_indices = tb_offset_alloc_free_space(&ranges.indices);
+  const uint32_t free_vertices = tb_offset_alloc_free_space(&ranges.vertices);
+  const uint32_t largest_indices =
+      tb_offset_alloc_largest_free(&ranges.indices);
+  const uint32_t largest_vertices =
+      tb_offset_alloc_largest_free(&ranges.vertices);
+
+  // Live ranges come first and released ones wait behind them
+  const uint32_t max_busy = TB_MESH_RANGES_TEST_LIVE * 8;
+  tb_auto busy = tb_alloc_nm_tp(tb_global_alloc, max_busy,
+                                TbMeshRangesTestRange);
+  uint32_t live_count = 0;
+  uint32_t busy_count = 0;
+
+  uint64_t seed = 0x5EED;
+  uint32_t frame = 0;
+  for (uint32_t cycle = 0; cycle < TB_MESH_RANGES_TEST_CYCLES; ++cycle) {
+    for (uint32_t i = 0; i < TB_MESH_RANGES_TEST_LIVE; ++i, ++frame) {
+      tb_recycle_mesh_ranges(&ranges, frame % TB_MAX_FRAME_STATES);
+      // Only what this frame freed can have left the busy list
+      for (uint32_t b = live_count; b < busy_count;) {
+        if (busy[b].free_frame == frame) {
+          busy[b] = busy[--busy_count];
+        } else {
+          ++b;
+        }
+      }
+
+      // Destroy a random live mesh once the arena holds enough of them
+      if (live_count == TB_MESH_RANGES_TEST_LIVE) {
+        const uint32_t victim = tb_test_rand(&seed) % live_count;
+        tb_auto released = busy[victim];
+        tb_release_mesh_range(&ranges, released.range);
+        released.free_frame = frame + 1 + TB_MAX_FRAME_STATES;
+        busy[victim] = busy[--live_count];
+        busy[live_count] = busy[--busy_count];
+        busy[busy_count++] = released;
+      }
+
+      TbMeshRangesTestRange r = {
+          .index_count = 1 + (uint32_t)(tb_test_rand(&seed) % 1024),
+          .vertex_count = 1 + (uint32_t)(tb_test_rand(&seed) % 256),
+      };
+      TB_EXPECT(tb_alloc_mesh_range(&ranges, r.index_count, r.vertex_count,
+                                    &r.range));
+      TB_EXPECT(tb_mesh_ranges_test_disjoint(busy, busy_count, &r));
+      TB_EXPECT(busy_count < max_busy);
+      // Keep live ranges in front of the released ones
+      busy[busy_count++] = busy[live_count];
+      busy[live_count++] = r;
+    }
+  }
+
+  // Nothing released comes back until every frame state has been recorded
+  // again
+  for (uint32_t i = 0; i < live_count; ++i) {
+    tb_release_mesh_range(&ranges, busy[i].range);
+  }
+  for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i, ++frame) {
+    tb_recycle_mesh_ranges(&ranges, frame % TB_MAX_FRAME_STATES);
+    TB_EXPECT(tb_offset_alloc_free_space(&ranges.indices) < free_indices);
+    TB_EXPECT(tb_offset_alloc_free_space(&ranges.vertices) < free_vertices);
+  }
+  tb_recycle_mesh_ranges(&ranges, frame % TB_MAX_FRAME_STATES);
+
+  // Every range merged back so the arena is as it started
+  TB_EXPECT(tb_offset_alloc_free_space(&ranges.indices) == free_indices);
+  TB_EXPECT(tb_offset_alloc_free_space(&ranges.vertices) == free_vertices);
+  TB_EXPECT(tb_offset_alloc_largest_free(&ranges.indices) == largest_indices);
+  TB_EXPECT(tb_offset_alloc_largest_free(&ranges.vertices) ==
+            largest_vertices);
+
+  tb_free(tb_global_alloc, busy);
+  tb_destroy_mesh_ranges(&ranges);
+  return true;
+}
+
+static bool tb_mesh_ranges_full_tests(void) {
+  TbMeshRanges ranges = {0};
+  tb_create_mesh_ranges(tb_global_alloc, TB_MESH_RANGES_TEST_INDICES,
+                        TB_MESH_RANGES_TEST_VERTICES,
+                        TB_MESH_RANGES_TEST_MAX_ALLOCS, &ranges);
+  const uint32_t free_indices = tb_offset_alloc_free_space(&ranges.indices);
+  const uint32_t free_vertices = tb_offset_alloc_free_space(&ranges.vertices);
+
+  // The indices fit but the vertices don't so neither is reserved
+  TbMeshArenaRange range = {0};
+  TB_EXPECT(!tb_alloc_mesh_range(&ranges, 16,
+                                 TB_MESH_RANGES_TEST_VERTICES + 1, &range));
+  TB_EXPECT(range.index_alloc.offset == TB_OFFSET_ALLOC_NO_SPACE);
+  TB_EXPECT(range.vertex_alloc.offset == TB_OFFSET_ALLOC_NO_SPACE);
+  TB_EXPECT(tb_offset_alloc_free_space(&ranges.indices) == free_indices);
+  TB_EXPECT(tb_offset_alloc_free_space(&ranges.vertices) == free_vertices);
+
+  TB_EXPECT(!tb_alloc_mesh_range(&ranges, TB_MESH_RANGES_TEST_INDICES + 1, 16,
+                                 &range));
+  TB_EXPECT(tb_offset_alloc_free_space(&ranges.indices) == free_indices);
+  TB_EXPECT(tb_offset_alloc_free_space(&ranges.vertices) == free_vertices);
+
+  tb_destroy_mesh_ranges(&ranges);
+  return true;
+}
+
+bool tb_mesh_ranges_tests(void) {
+  return tb_mesh_ranges_cycle_tests() && tb_mesh_ranges_full_tests();
+}
@@ -0,0 +1,146 @@
+#include "tb_test.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_offset_alloc.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#define TB_OFFSET_TEST_SIZE (1u << 20)
+#define TB_OFFSET_TEST_MAX_ALLOCS 1024
+
+typedef struct TbOffsetTestAlloc {
+  TbOffsetAllocation alloc;
+  uint32_t size;
+} TbOffsetTestAlloc;
+
+// Marks the allocation's range in the occupancy map, failing if any of it was
+// already handed out
+static bool tb_offset_test_claim(uint8_t *occupied, uint32_t offset,
+                                 uint32_t size, uint8_t value) {
+  for (uint32_t i = offset; i < offset + size; ++i) {
+    if (occupied[i] == value) {
+      return false;
+    }
+    occupied[i] = value;
+  }
+  return true;
+}
+
+static bool tb_offset_alloc_basic_tests(void) {
+  TbOffsetAllocator alloc = {0};
+  // Sizes that aren't a bin size may not be handed out whole so the tests
+  // stick to a power of two
+  tb_create_offset_allocator(tb_global_alloc, 128, 16, &alloc);
+  TB_EXPECT(tb_offset_alloc_free_space(&alloc) == 128);
+
+  tb_auto a = tb_offset_alloc(&alloc, 48);
+  tb_auto b = tb_offset_alloc(&alloc, 48);
+  TB_EXPECT(a.offset == 0);
+  TB_EXPECT(b.offset == 48);
+  TB_EXPECT(tb_offset_alloc_free_space(&alloc) == 32);
+
+  // Too big for what's left, and empty requests never succeed
+  TB_EXPECT(tb_offset_alloc(&alloc, 48).offset == TB_OFFSET_ALLOC_NO_SPACE);
+  TB_EXPECT(tb_offset_alloc(&alloc, 0).offset == TB_OFFSET_ALLOC_NO_SPACE);
+
+  // Freeing a failed allocation does nothing
+  tb_offset_free(&alloc, (TbOffsetAllocation){TB_OFFSET_ALLOC_NO_SPACE,
+                                              TB_OFFSET_ALLOC_NO_SPACE});
+
+  // Both neighbors of b merge back into a single block
+  tb_offset_free(&alloc, a);
+  tb_offset_free(&alloc, b);
+  TB_EXPECT(tb_offset_alloc_free_space(&alloc) == 128);
+  tb_auto whole = tb_offset_alloc(&alloc, 128);
+  TB_EXPECT(whole.offset == 0);
+  tb_offset_free(&alloc, whole);
+
+  // Running out of nodes fails rather than corrupting the free lists
+  TbOffsetAllocation small[16] = {{0}};
+  uint32_t small_count = 0;
+  for (uint32_t i = 0; i < 16; ++i) {
+    small[i] = tb_offset_alloc(&alloc, 1);
+    if (small[i].offset != TB_OFFSET_ALLOC_NO_SPACE) {
+      small_count++;
+    }
+  }
+  TB_EXPECT(small_count > 0 && small_count < 16);
+  for (uint32_t i = 0; i < 16; ++i) {
+    tb_offset_free(&alloc, small[i]);
+  }
+  TB_EXPECT(tb_offset_alloc(&alloc, 128).offset == 0);
+
+  tb_reset_offset_allocator(&alloc);
+  TB_EXPECT(tb_offset_alloc_free_space(&alloc) == 128);
+  tb_destroy_offset_allocator(&alloc);
+  return true;
+}
+
+// Random allocations and frees in the pattern of meshes streaming in and out
+// of the arena. Live ranges must never overlap or leave the managed range and
+// once everything is freed the whole range must be one block again
+static bool tb_offset_alloc_churn_tests(void) {
+  TbOffsetAllocator alloc = {0};
+  tb_create_offset_allocator(tb_global_alloc, TB_OFFSET_TEST_SIZE,
+                             TB_OFFSET_TEST_MAX_ALLOCS, &alloc);
+
+  tb_auto occupied =
+      tb_alloc_nm_tp(tb_global_alloc, TB_OFFSET_TEST_SIZE, uint8_t);
+  SDL_memset(occupied, 0, TB_OFFSET_TEST_SIZE);
+  tb_auto live = tb_alloc_nm_tp(tb_global_alloc, TB_OFFSET_TEST_MAX_ALLOCS,
+                                TbOffsetTestAlloc);
+  uint32_t live_count = 0;
+  uint64_t live_size = 0;
+  uint32_t failures = 0;
+
+  uint64_t seed = 3;
+  for (uint32_t step = 0; step < 200000; ++step) {
+    const uint64_t r = tb_test_rand(&seed);
+    const bool do_alloc =
+        live_count == 0 ||
+        (live_count < TB_OFFSET_TEST_MAX_ALLOCS && (r & 0xff) < 140);
+    if (do_alloc) {
+      // Mostly small ranges with the occasional large one
+      const uint32_t size = (r >> 8) % 16 == 0
+                                ? 1 + (uint32_t)((r >> 16) % 65536)
+                                : 1 + (uint32_t)((r >> 16) % 2048);
+      tb_auto a = tb_offset_alloc(&alloc, size);
+      if (a.offset == TB_OFFSET_ALLOC_NO_SPACE) {
+        failures++;
+        continue;
+      }
+      TB_EXPECT(a.offset + size <= TB_OFFSET_TEST_SIZE);
+      TB_EXPECT(tb_offset_test_claim(occupied, a.offset, size, 1));
+      live[live_count++] = (TbOffsetTestAlloc){a, size};
+      live_size += size;
+    } else {
+      const uint32_t idx = (uint32_t)((r >> 8) % live_count);
+      tb_auto victim = live[idx];
+      TB_EXPECT(
+          tb_offset_test_claim(occupied, victim.alloc.offset, victim.size, 0));
+      tb_offset_free(&alloc, victim.alloc);
+      live[idx] = live[--live_count];
+      live_size -= victim.size;
+    }
+    TB_EXPECT(alloc.free_storage == TB_OFFSET_TEST_SIZE - live_size);
+  }
+  // The pattern is meant to fill the range now and then
+  TB_EXPECT(failures > 0);
+
+  while (live_count > 0) {
+    tb_offset_free(&alloc, live[--live_count].alloc);
+  }
+  TB_EXPECT(tb_offset_alloc_free_space(&alloc) == TB_OFFSET_TEST_SIZE);
+  TB_EXPECT(tb_offset_alloc_largest_free(&alloc) == TB_OFFSET_TEST_SIZE);
+  TB_EXPECT(tb_offset_alloc(&alloc, TB_OFFSET_TEST_SIZE).offset == 0);
+
+  tb_free(tb_global_alloc, live);
+  tb_free(tb_global_alloc, occupied);
+  tb_destroy_offset_allocator(&alloc);
+  return true;
+}
+
+bool tb_offset_alloc_tests(void) {
+  return tb_offset_alloc_basic_tests() && tb_offset_alloc_churn_tests();
+}
@@ -0,0 +1,355 @@
+#include "tb_test.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_gltf.h"
+#include "tb_scene_cells.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#define TB_CELL_TEST_SIZE 16.0f
+#define TB_CELL_TEST_GRID_X 40
+#define TB_CELL_TEST_GRID_Z 25
+#define TB_CELL_TEST_TILES (TB_CELL_TEST_GRID_X * TB_CELL_TEST_GRID_Z)
+// What a loaded cell is assumed to cost for the peak memory check
+#define TB_CELL_TEST_CELL_BYTES (4ull * 1024 * 1024)
+// Frames a cell spends parsing and then waiting on its assets
+#define TB_CELL_TEST_PARSE_FRAMES 2
+#define TB_CELL_TEST_LOAD_FRAMES 6
+
+// A synthetic open world: one root holding a tile per cell, each tile with a
+// prop child, plus a camera and a sun that must stay loaded
+typedef struct TbCellTestWorld {
+  cgltf_data data;
+  cgltf_scene scene;
+  cgltf_node *root;
+  cgltf_node *nodes;
+  cgltf_node **children;
+  cgltf_mesh mesh;
+  cgltf_primitive prim;
+  cgltf_attribute attr;
+  cgltf_accessor accessor;
+  cgltf_camera camera;
+  cgltf_light sun;
+} TbCellTestWorld;
+
+static void tb_cell_test_node(cgltf_node *node, cgltf_node *parent, float x,
+                              float z) {
+  *node = (cgltf_node){
+      .parent = parent,
+      .translation = {x, 0, z},
+      .rotation = {0, 0, 0, 1},
+      .scale = {1, 1, 1},
+  };
+}
+
+// Tiles are centered in their cell and just small enough to fit in it
+static TbCellTestWorld *tb_create_cell_test_world(void) {
+  tb_auto world = tb_alloc_tp(tb_global_alloc, TbCellTestWorld);
+  *world = (TbCellTestWorld){
+      .accessor = {.has_min = true, .min = {-7, 0, -7},
+                   .has_max = true, .max = {7, 2, 7}},
+      .sun = {.type = cgltf_light_type_directional},
+  };
+  world->attr = (cgltf_attribute){
+      .type = cgltf_attribute_type_position,
+      .data = &world->accessor,
+  };
+  world->prim = (cgltf_primitive){.attributes = &world->attr,
+                                  .attributes_count = 1};
+  world->mesh = (cgltf_mesh){.primitives = &world->prim,
+                             .primitives_count = 1};
+
+  // The root, the tiles, the camera, the sun and then the props. Children
+  // are listed in the same order
+  const uint32_t node_count = 3 + TB_CELL_TEST_TILES * 2;
+  const uint32_t prop_start = 3 + TB_CELL_TEST_TILES;
+  world->nodes = tb_alloc_nm_tp(tb_global_alloc, node_count, cgltf_node);
+  world->children = tb_alloc_nm_tp(tb_global_alloc, node_count, cgltf_node *);
+  for (uint32_t i = 0; i < node_count; ++i) {
+    world->children[i] = &world->nodes[i];
+  }
+
+  tb_auto root = &world->nodes[0];
+  tb_cell_test_node(root, NULL, 0, 0);
+  root->children = &world->children[1];
+  root->children_count = TB_CELL_TEST_TILES + 2;
+  for (uint32_t i = 0; i < TB_CELL_TEST_TILES; ++i) {
+    const uint32_t col = i % TB_CELL_TEST_GRID_X;
+    const uint32_t row = i / TB_CELL_TEST_GRID_X;
+    tb_auto tile = &world->nodes[1 + i];
+    tb_auto prop = &world->nodes[prop_start + i];
+    tb_cell_test_node(tile, root, ((float)col + 0.5f) * TB_CELL_TEST_SIZE,
+                      ((float)row + 0.5f) * TB_CELL_TEST_SIZE);
+    tb_cell_test_node(prop, tile, 2, 2);
+    tile->mesh = &world->mesh;
+    tile->children = &world->children[prop_start + i];
+    tile->children_count = 1;
+    prop->mesh = &world->mesh;
+  }
+  tb_auto camera = &world->nodes[1 + TB_CELL_TEST_TILES];
+  tb_auto sun = &world->nodes[2 + TB_CELL_TEST_TILES];
+  tb_cell_test_node(camera, root, 0, 0);
+  tb_cell_test_node(sun, root, 0, 0);
+  camera->camera = &world->camera;
+  sun->light = &world->sun;
+
+  world->root = root;
+  world->scene = (cgltf_scene){.nodes = &world->root, .nodes_count = 1};
+  world->data = (cgltf_data){.scenes = &world->scene, .scenes_count = 1};
+  return world;
+}
+
+static void tb_destroy_cell_test_world(TbCellTestWorld *world) {
+  tb_free(tb_global_alloc, world->children);
+  tb_free(tb_global_alloc, world->nodes);
+  tb_free(tb_global_alloc, world);
+}
+
+static bool tb_scene_cells_split_tests(TbAllocator tmp_alloc) {
+  tb_auto world = tb_create_cell_test_world();
+  TbSceneCells cells = {0};
+  tb_split_scene_cells(tb_global_alloc, tmp_alloc, &world->data,
+                       TB_CELL_TEST_SIZE, &cells);
+
+  // The single root is split up rather than becoming one cell
+  TB_EXPECT(TB_DYN_ARR_SIZE(cells) == TB_CELL_TEST_TILES + 1);
+  uint32_t resident_count = 0;
+  TB_DYN_ARR_FOREACH(cells, i) {
+    tb_auto cell = &TB_DYN_ARR_AT(cells, i);
+    if (cell->resident) {
+      resident_count++;
+      // The root on its own, then the camera and the sun with their children
+      TB_EXPECT(TB_DYN_ARR_SIZE(cell->nodes) == 3);
+      TB_EXPECT(TB_DYN_ARR_AT(cell->nodes, 0).node == &world->nodes[0]);
+      TB_EXPECT(!TB_DYN_ARR_AT(cell->nodes, 0).subtree);
+      TB_EXPECT(TB_DYN_ARR_AT(cell->nodes, 1).node->camera);
+      TB_EXPECT(TB_DYN_ARR_AT(cell->nodes, 2).node->light);
+      TB_EXPECT(!TB_DYN_ARR_AT(cell->nodes, 1).detached);
+      continue;
+    }
+    // Each tile keeps its prop and is loaded without the root
+    TB_EXPECT(TB_DYN_ARR_SIZE(cell->nodes) == 1);
+    tb_auto entry = &TB_DYN_ARR_AT(cell->nodes, 0);
+    TB_EXPECT(entry->subtree && entry->detached);
+    TB_EXPECT(entry->node->mesh && entry->node->children_count == 1);
+    const uint32_t tile = (uint32_t)(entry->node - &world->nodes[1]);
+    TB_EXPECT(cell->x == (int32_t)(tile % TB_CELL_TEST_GRID_X));
+    TB_EXPECT(cell->z == (int32_t)(tile / TB_CELL_TEST_GRID_X));
+    // Sorted by cell
+    if (i > 1) {
+      tb_auto prev = &TB_DYN_ARR_AT(cells, i - 1);
+      TB_EXPECT(prev->x < cell->x || (prev->x == cell->x && prev->z < cell->z));
+    }
+  }
+  TB_EXPECT(resident_count == 1);
+  tb_destroy_scene_cells(&cells);
+
+  // A tile alone fits in a cell and isn't split. Negative cells work too
+  tb_auto tile = &world->nodes[1];
+  tile->parent = NULL;
+  tile->translation[0] = -24;
+  world->root = tile;
+  tb_split_scene_cells(tb_global_alloc, tmp_alloc, &world->data,
+                       TB_CELL_TEST_SIZE, &cells);
+  TB_EXPECT(TB_DYN_ARR_SIZE(cells) == 1);
+  tb_auto cell = &TB_DYN_ARR_AT(cells, 0);
+  TB_EXPECT(!cell->resident && cell->x == -2 && cell->z == 0);
+  TB_EXPECT(TB_DYN_ARR_SIZE(cell->nodes) == 1);
+  TB_EXPECT(TB_DYN_ARR_AT(cell->nodes, 0).subtree);
+  TB_EXPECT(!TB_DYN_ARR_AT(cell->nodes, 0).detached);
+  tb_destroy_scene_cells(&cells);
+
+  tb_destroy_cell_test_world(world);
+  return true;
+}
+
+typedef struct TbCellTestRun {
+  TbSceneCells cells;
+  TbSceneCellPlan plan;
+  uint32_t *timers; // Frames since each cell started loading
+  uint64_t loaded_bytes;
+  uint64_t peak_bytes;
+  uint32_t loads;
+  uint32_t unloads;
+  double max_frame;
+} TbCellTestRun;
+
+// One frame of streaming, with cells finishing their loads on a schedule
+// instead of through a world
+static bool tb_cell_test_frame(TbCellTestRun *run,
+                               const TbSceneStreamDesc *desc, float3 origin) {
+  const double start = tb_test_seconds();
+  TB_DYN_ARR_FOREACH(run->cells, i) {
+    tb_auto cell = &TB_DYN_ARR_AT(run->cells, i);
+    if (cell->state == TB_SCENE_CELL_UNLOADED) {
+      continue;
+    }
+    const uint32_t frames = ++run->timers[i];
+    if (frames >= TB_CELL_TEST_PARSE_FRAMES + TB_CELL_TEST_LOAD_FRAMES) {
+      cell->state = TB_SCENE_CELL_READY;
+    } else if (frames >= TB_CELL_TEST_PARSE_FRAMES) {
+      cell->state = TB_SCENE_CELL_LOADING;
+    }
+  }
+  tb_plan_scene_cells(desc, &run->cells, origin, &run->plan);
+  const double frame = tb_test_seconds() - start;
+  run->max_frame = SDL_max(run->max_frame, frame);
+
+  uint32_t load_count = 0;
+  TB_DYN_ARR_FOREACH(run->plan.unloads, i) {
+    const uint32_t idx = TB_DYN_ARR_AT(run->plan.unloads, i);
+    tb_auto cell = &TB_DYN_ARR_AT(run->cells, idx);
+    TB_EXPECT(!cell->resident && cell->state != TB_SCENE_CELL_UNLOADED);
+    TB_EXPECT(cell->state != TB_SCENE_CELL_PARSING);
+    TB_EXPECT(tb_scene_cell_distance(cell, desc->cell_size, origin) >
+              desc->unload_radius);
+    cell->state = TB_SCENE_CELL_UNLOADED;
+    run->loaded_bytes -= TB_CELL_TEST_CELL_BYTES;
+    run->unloads++;
+  }
+  TB_DYN_ARR_FOREACH(run->plan.loads, i) {
+    const uint32_t idx = TB_DYN_ARR_AT(run->plan.loads, i);
+    tb_auto cell = &TB_DYN_ARR_AT(run->cells, idx);
+    TB_EXPECT(cell->state == TB_SCENE_CELL_UNLOADED);
+    if (!cell->resident) {
+      TB_EXPECT(tb_scene_cell_distance(cell, desc->cell_size, origin) <=
+                desc->load_radius);
+      load_count++;
+    }
+    cell->state = TB_SCENE_CELL_PARSING;
+    run->timers[idx] = 0;
+    run->loaded_bytes += TB_CELL_TEST_CELL_BYTES;
+    run->loads++;
+  }
+  TB_EXPECT(load_count <= desc->max_loads_per_frame);
+  TB_EXPECT(TB_DYN_ARR_SIZE(run->plan.unloads) <= desc->max_unloads_per_frame);
+
+  uint32_t loading = 0;
+  TB_DYN_ARR_FOREACH(run->cells, i) {
+    tb_auto cell = &TB_DYN_ARR_AT(run->cells, i);
+    if (!cell->resident && cell->state != TB_SCENE_CELL_UNLOADED &&
+        cell->state != TB_SCENE_CELL_READY) {
+      loading++;
+    }
+  }
+  TB_EXPECT(loading <= desc->max_loading_cells);
+  run->peak_bytes = SDL_max(run->peak_bytes, run->loaded_bytes);
+  return true;
+}
+
+// Every cell in load range is ready and none past unload range is loaded
+static bool tb_cell_test_settled(const TbCellTestRun *run,
+                                 const TbSceneStreamDesc *desc,
+                                 float3 origin) {
+  TB_DYN_ARR_FOREACH(run->cells, i) {
+    tb_auto cell = &TB_DYN_ARR_AT(run->cells, i);
+    if (cell->resident) {
+      TB_EXPECT(cell->state == TB_SCENE_CELL_READY);
+      continue;
+    }
+    const float dist = tb_scene_cell_distance(cell, desc->cell_size, origin);
+    if (dist <= desc->load_radius) {
+      TB_EXPECT(cell->state == TB_SCENE_CELL_READY);
+    }
+    if (dist > desc->unload_radius) {
+      TB_EXPECT(cell->state == TB_SCENE_CELL_UNLOADED);
+    }
+  }
+  return true;
+}
+
+// Drives a camera through the synthetic world the way tb_stream_scenes
+// drives the streamed scenes of a world
+static bool tb_scene_cells_stream_tests(TbAllocator tmp_alloc) {
+  const TbSceneStreamDesc desc = {
+      .cell_size = TB_CELL_TEST_SIZE,
+      .load_radius = 48.0f,
+      .unload_radius = 80.0f,
+      .max_loads_per_frame = 4,
+      .max_unloads_per_frame = 4,
+      .max_loading_cells = 8,
+  };
+
+  tb_auto world = tb_create_cell_test_world();
+  TbCellTestRun run = {0};
+  tb_split_scene_cells(tb_global_alloc, tmp_alloc, &world->data,
+                       TB_CELL_TEST_SIZE, &run.cells);
+  TB_DYN_ARR_RESET(run.plan.loads, tb_global_alloc, 8);
+  TB_DYN_ARR_RESET(run.plan.unloads, tb_global_alloc, 8);
+  const uint32_t cell_count = TB_DYN_ARR_SIZE(run.cells);
+  run.timers = tb_alloc_nm_tp(tb_global_alloc, cell_count, uint32_t);
+  SDL_memset(run.timers, 0, sizeof(uint32_t) * cell_count);
+
+  // Across the world and back along a different row, then a stop
+  const float width = TB_CELL_TEST_GRID_X * TB_CELL_TEST_SIZE;
+  const float depth = TB_CELL_TEST_GRID_Z * TB_CELL_TEST_SIZE;
+  const float3 path[] = {
+      {0, 0, 0},
+      {width, 0, depth * 0.5f},
+      {0, 0, depth},
+      {width * 0.5f, 0, depth * 0.5f},
+  };
+  const float speed = 2.0f;
+  float3 pos = path[0];
+  for (uint32_t leg = 1; leg < sizeof(path) / sizeof(float3); ++leg) {
+    const float3 to = path[leg];
+    const float3 delta = to - pos;
+    const float len = SDL_sqrtf(delta.x * delta.x + delta.z * delta.z);
+    const uint32_t steps = (uint32_t)SDL_ceilf(len / speed);
+    const float3 from = pos;
+    for (uint32_t step = 1; step <= steps; ++step) {
+      pos = from + delta * ((float)step / (float)steps);
+      TB_EXPECT(tb_cell_test_frame(&run, &desc, pos));
+    }
+  }
+
+  // Enough frames for the last cells around the stop to finish loading
+  for (uint32_t i = 0; i < 64; ++i) {
+    TB_EXPECT(tb_cell_test_frame(&run, &desc, pos));
+  }
+  TB_EXPECT(tb_cell_test_settled(&run, &desc, pos));
+
+  // Pacing back and forth over a cell border loads and unloads what comes in
+  // and out of range the first time over and nothing after that
+  uint32_t loads = 0;
+  uint32_t unloads = 0;
+  for (uint32_t pass = 0; pass < 2; ++pass) {
+    loads = run.loads;
+    unloads = run.unloads;
+    for (uint32_t i = 0; i < 256; ++i) {
+      const float3 offset = {(float)(i % 32) - 16.0f, 0, 0};
+      TB_EXPECT(tb_cell_test_frame(&run, &desc, pos + offset));
+    }
+  }
+  TB_EXPECT(run.loads == loads && run.unloads == unloads);
+
+  // Only what is within unload range of the camera and the resident cell may
+  // ever be loaded at once
+  const int32_t reach =
+      2 * (int32_t)SDL_ceilf(desc.unload_radius / desc.cell_size) + 2;
+  const uint64_t bound =
+      (uint64_t)(reach * reach + 1) * TB_CELL_TEST_CELL_BYTES;
+  TB_EXPECT(run.peak_bytes <= bound);
+  TB_EXPECT(run.max_frame < 0.002);
+  printf("  %u cells, %u loads, %u unloads, peak %" SDL_PRIu64
+         " MiB, slowest frame %.3f ms\n",
+         cell_count, run.loads, run.unloads, run.peak_bytes / (1024 * 1024),
+         run.max_frame * 1000.0);
+
+  tb_free(tb_global_alloc, run.timers);
+  TB_DYN_ARR_DESTROY(run.plan.loads);
+  TB_DYN_ARR_DESTROY(run.plan.unloads);
+  tb_destroy_scene_cells(&run.cells);
+  tb_destroy_cell_test_world(world);
+  return true;
+}
+
+bool tb_scene_cells_tests(void) {
+  TbArenaAllocator arena = {0};
+  tb_create_arena_alloc("Scene Cells Test Arena", &arena, 16 * 1024 * 1024);
+  const bool ok = tb_scene_cells_split_tests(arena.alloc) &&
+                  tb_scene_cells_stream_tests(arena.alloc);
+  tb_destroy_arena_alloc(arena);
+  return ok;
+}
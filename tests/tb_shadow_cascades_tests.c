@@ -0,0 +1,99 @@
+#include "tb_test.h"
+
+#include "tb_common.h"
+#include "tb_shadow_cascades.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <math.h>
+
+#define TB_CASCADE_TEST_EPSILON 1e-4f
+#define TB_CASCADE_TEST_LAMBDA_STEPS 20
+
+static bool tb_cascade_clamp_tests(void) {
+  // Anything in range is left alone
+  for (int32_t count = 1; count <= TB_CASCADE_COUNT; ++count) {
+    for (uint32_t step = 0; step <= TB_CASCADE_TEST_LAMBDA_STEPS; ++step) {
+      const float lambda = (float)step / TB_CASCADE_TEST_LAMBDA_STEPS;
+      tb_auto s = tb_clamp_cascade_settings(1024, count, lambda);
+      TB_EXPECT(s.map_dim == 1024);
+      TB_EXPECT(s.cascade_count == (uint32_t)count);
+      TB_EXPECT(s.split_lambda == lambda);
+    }
+  }
+
+  tb_auto s = tb_clamp_cascade_settings(0, 0, -1.0f);
+  TB_EXPECT(s.map_dim == TB_SHADOW_MAP_MIN_DIM);
+  TB_EXPECT(s.cascade_count == 1);
+  TB_EXPECT(s.split_lambda == 0.0f);
+
+  s = tb_clamp_cascade_settings(SDL_MAX_SINT32, SDL_MAX_SINT32, 2.0f);
+  TB_EXPECT(s.map_dim == TB_SHADOW_MAP_DIM);
+  TB_EXPECT(s.cascade_count == TB_CASCADE_COUNT);
+  TB_EXPECT(s.split_lambda == 1.0f);
+
+  s = tb_clamp_cascade_settings(SDL_MIN_SINT32, SDL_MIN_SINT32,
+                                -SDL_FLT_EPSILON);
+  TB_EXPECT(s.map_dim == TB_SHADOW_MAP_MIN_DIM);
+  TB_EXPECT(s.cascade_count == 1);
+  TB_EXPECT(s.split_lambda == 0.0f);
+
+  // A broken settings file must not reach the split math
+  s = tb_clamp_cascade_settings(TB_SHADOW_MAP_DIM, TB_CASCADE_COUNT, NAN);
+  TB_EXPECT(s.split_lambda == TB_CASCADE_SPLIT_LAMBDA);
+  return true;
+}
+
+// Every cascade count and lambda, across near and far planes a camera might
+// use, must split the whole range into cascades that each start where the
+// last ended and end where the blend of uniform and logarithmic splits says
+static bool tb_cascade_split_tests(void) {
+  const float planes[][2] = {
+      {0.1f, 100.0f},
+      {0.01f, 1000.0f},
+      {1.0f, 2.0f},
+      {0.5f, 5000.0f},
+  };
+  const uint32_t plane_count = sizeof(planes) / sizeof(planes[0]);
+  for (uint32_t plane = 0; plane < plane_count; ++plane) {
+    const float near = planes[plane][0];
+    const float far = planes[plane][1];
+    for (uint32_t count = 1; count <= TB_CASCADE_COUNT; ++count) {
+      float prev_lambda_splits[TB_CASCADE_COUNT] = {0};
+      for (uint32_t step = 0; step <= TB_CASCADE_TEST_LAMBDA_STEPS; ++step) {
+        const float lambda = (float)step / TB_CASCADE_TEST_LAMBDA_STEPS;
+        float splits[TB_CASCADE_COUNT + 1] = {0};
+        splits[count] = -1.0f;
+        tb_calc_cascade_splits(near, far, count, lambda, splits);
+        // Nothing past the cascades in use is written
+        TB_EXPECT(splits[count] == -1.0f);
+
+        float prev = 0.0f;
+        for (uint32_t i = 0; i < count; ++i) {
+          const float p = (float)(i + 1) / (float)count;
+          const float uniform = p;
+          const float log =
+              (near * SDL_powf(far / near, p) - near) / (far - near);
+          const float expected = uniform + lambda * (log - uniform);
+          TB_EXPECT(SDL_fabsf(splits[i] - expected) < TB_CASCADE_TEST_EPSILON);
+          TB_EXPECT(splits[i] > prev);
+          TB_EXPECT(splits[i] <= 1.0f + TB_CASCADE_TEST_EPSILON);
+          // Leaning further toward logarithmic only pulls splits closer in
+          if (step > 0) {
+            TB_EXPECT(splits[i] <= prev_lambda_splits[i] +
+                                       TB_CASCADE_TEST_EPSILON);
+          }
+          prev_lambda_splits[i] = splits[i];
+          prev = splits[i];
+        }
+        // The last cascade always reaches the far plane
+        TB_EXPECT(SDL_fabsf(splits[count - 1] - 1.0f) <
+                  TB_CASCADE_TEST_EPSILON);
+      }
+    }
+  }
+  return true;
+}
+
+bool tb_shadow_cascades_tests(void) {
+  return tb_cascade_clamp_tests() && tb_cascade_split_tests();
+}
@@ -0,0 +1,181 @@
+#include "tb_test.h"
+
+#include "tb_allocator.h"
+#include "tb_common.h"
+#include "tb_sort.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <TaskScheduler_c.h>
+
+typedef struct TbSortCase {
+  TbArenaAllocator arena;
+  uint32_t count;
+  uint64_t *keys;
+  uint64_t *orig_keys;
+  uint32_t *values;
+} TbSortCase;
+
+static void tb_sort_case_init(TbSortCase *c, uint32_t count, uint64_t seed,
+                              uint64_t key_mask) {
+  *c = (TbSortCase){.count = count};
+  tb_create_arena_alloc("Sort Test Arena", &c->arena, 64 * 1024 * 1024);
+  c->keys = tb_alloc_nm_tp(tb_global_alloc, SDL_max(count, 1), uint64_t);
+  c->orig_keys = tb_alloc_nm_tp(tb_global_alloc, SDL_max(count, 1), uint64_t);
+  c->values = tb_alloc_nm_tp(tb_global_alloc, SDL_max(count, 1), uint32_t);
+  for (uint32_t i = 0; i < count; ++i) {
+    c->keys[i] = tb_test_rand(&seed) & key_mask;
+    c->orig_keys[i] = c->keys[i];
+    c->values[i] = i;
+  }
+}
+
+static void tb_sort_case_destroy(TbSortCase *c) {
+  tb_free(tb_global_alloc, c->keys);
+  tb_free(tb_global_alloc, c->orig_keys);
+  tb_free(tb_global_alloc, c->values);
+  tb_destroy_arena_alloc(c->arena);
+}
+
+// Keys must ascend, every value must still name the key it came with, and
+// equal keys must keep their original relative order
+static bool tb_check_sorted(const TbSortCase *c) {
+  for (uint32_t i = 0; i < c->count; ++i) {
+    TB_EXPECT(c->values[i] < c->count);
+    TB_EXPECT(c->keys[i] == c->orig_keys[c->values[i]]);
+    if (i > 0) {
+      TB_EXPECT(c->keys[i - 1] <= c->keys[i]);
+      if (c->keys[i - 1] == c->keys[i]) {
+        TB_EXPECT(c->values[i - 1] < c->values[i]);
+      }
+    }
+  }
+  return true;
+}
+
+static bool tb_sort_check_case(TbTaskScheduler enki, uint32_t count,
+                               uint64_t seed, uint64_t key_mask) {
+  TbSortCase c = {0};
+  tb_sort_case_init(&c, count, seed, key_mask);
+  tb_radix_sort_u64(enki, c.arena.alloc, c.count, c.keys, c.values);
+  const bool ok = tb_check_sorted(&c);
+  tb_sort_case_destroy(&c);
+  if (!ok) {
+    printf("  count %u, key mask 0x%llx, %s\n", count,
+           (unsigned long long)key_mask, enki ? "parallel" : "serial");
+  }
+  return ok;
+}
+
+static bool tb_sort_check_all(TbTaskScheduler enki) {
+  const uint32_t counts[] = {0, 1, 2, 3, 255, 1000,
+                             TB_RADIX_SORT_PARALLEL_MIN, 100003};
+  const uint64_t masks[] = {
+      ~0ull,                 // Full range
+      0xf,                   // Lots of duplicates to exercise stability
+      0xff00000000000000ull, // Only the top digit differs
+      0x00ff00ff00ff00ffull, // Every other digit pass is trivial
+      0,                     // Every key equal so every pass is skipped
+  };
+  for (uint32_t i = 0; i < sizeof(counts) / sizeof(uint32_t); ++i) {
+    for (uint32_t j = 0; j < sizeof(masks) / sizeof(uint64_t); ++j) {
+      const uint64_t seed = 0x9e3779b97f4a7c15ull + i * 31 + j;
+      if (!tb_sort_check_case(enki, counts[i], seed, masks[j])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool tb_sort_check_presorted(void) {
+  // Already sorted and reverse sorted input
+  TbSortCase c = {0};
+  tb_sort_case_init(&c, 4096, 1, ~0ull);
+  for (uint32_t i = 0; i < c.count; ++i) {
+    c.keys[i] = c.orig_keys[i] = (uint64_t)(c.count - i) << 20;
+  }
+  tb_radix_sort_u64(NULL, c.arena.alloc, c.count, c.keys, c.values);
+  bool ok = tb_check_sorted(&c);
+  if (ok) {
+    // Sorting the result again must change nothing
+    tb_radix_sort_u64(NULL, c.arena.alloc, c.count, c.keys, c.values);
+    ok = tb_check_sorted(&c);
+  }
+  tb_sort_case_destroy(&c);
+  return ok;
+}
+
+bool tb_sort_tests(void) {
+  TB_EXPECT(tb_sort_check_all(NULL));
+  TB_EXPECT(tb_sort_check_presorted());
+
+  // Same cases again through the parallel histogram and scatter path
+  tb_auto enki = enkiNewTaskScheduler();
+  enkiInitTaskScheduler(enki);
+  const bool ok = tb_sort_check_all(enki);
+  enkiDeleteTaskScheduler(enki);
+  TB_EXPECT(ok);
+  return true;
+}
+
+typedef struct TbSortPair {
+  uint64_t key;
+  uint32_t value;
+} TbSortPair;
+
+static int32_t tb_sort_pair_cmp(const void *a, const void *b) {
+  const uint64_t ka = ((const TbSortPair *)a)->key;
+  const uint64_t kb = ((const TbSortPair *)b)->key;
+  return (ka > kb) - (ka < kb);
+}
+
+// Times one size. Keys are fully random 64-bit values so no digit pass
+// can be skipped
+static void tb_sort_bench_count(TbTaskScheduler enki, uint32_t count) {
+  const int32_t iterations = 5;
+
+  double serial_time = 0.0;
+  double parallel_time = 0.0;
+  double qsort_time = 0.0;
+  for (int32_t it = 0; it < iterations; ++it) {
+    TbSortCase c = {0};
+    tb_sort_case_init(&c, count, 7 + (uint64_t)it, ~0ull);
+
+    double start = tb_test_seconds();
+    tb_radix_sort_u64(NULL, c.arena.alloc, c.count, c.keys, c.values);
+    serial_time += tb_test_seconds() - start;
+
+    SDL_memcpy(c.keys, c.orig_keys, sizeof(uint64_t) * count);
+    c.arena = tb_reset_arena(c.arena, false);
+    start = tb_test_seconds();
+    tb_radix_sort_u64(enki, c.arena.alloc, c.count, c.keys, c.values);
+    parallel_time += tb_test_seconds() - start;
+
+    tb_auto pairs = tb_alloc_nm_tp(c.arena.alloc, count, TbSortPair);
+    for (uint32_t i = 0; i < count; ++i) {
+      pairs[i] = (TbSortPair){c.orig_keys[i], i};
+    }
+    start = tb_test_seconds();
+    SDL_qsort(pairs, count, sizeof(TbSortPair), tb_sort_pair_cmp);
+    qsort_time += tb_test_seconds() - start;
+
+    tb_sort_case_destroy(&c);
+  }
+
+  const double ms = 1000.0 / iterations;
+  printf("  %u random 64-bit keys, mean of %d runs\n", count, iterations);
+  printf("  radix serial:   %8.3f ms\n", serial_time * ms);
+  printf("  radix parallel: %8.3f ms\n", parallel_time * ms);
+  printf("  SDL_qsort:      %8.3f ms\n", qsort_time * ms);
+}
+
+// 200k is the draw count the sort is budgeted for. 1M shows how the parallel
+// path scales past it
+bool tb_sort_bench(void) {
+  tb_auto enki = enkiNewTaskScheduler();
+  enkiInitTaskScheduler(enki);
+  tb_sort_bench_count(enki, 200000);
+  tb_sort_bench_count(enki, 1 << 20);
+  enkiDeleteTaskScheduler(enki);
+  return true;
+}
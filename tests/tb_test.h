@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// A deliberately tiny harness. Each suite is a function that returns false
+// as soon as one of its expectations fails. The test executable runs the suite
+// named on the command line, or every suite when given none
+
+#define TB_EXPECT(expr)                                                        \
+  if (!(expr)) {                                                               \
+    printf("%s:%d: expected %s\n", __FILE__, __LINE__, #expr);                 \
+    return false;                                                              \
+  }
+
+typedef bool (*TbTestSuiteFn)(void);
+
+typedef struct TbTestSuite {
+  const char *name;
+  TbTestSuiteFn fn;
+} TbTestSuite;
+
+// Seconds on a monotonic clock for the benchmark suites
+double tb_test_seconds(void);
+
+// Small deterministic generator so that failures are reproducible
+uint64_t tb_test_rand(uint64_t *state);
@@ -0,0 +1,100 @@
+#include "tb_test.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+
+bool tb_sort_tests(void);
+bool tb_sort_bench(void);
+bool tb_cull_tests(void);
+bool tb_cull_bench(void);
+bool tb_mesh_cull_bench(void);
+bool tb_offset_alloc_tests(void);
+bool tb_scene_cells_tests(void);
+bool tb_dyn_desc_tests(void);
+bool tb_dyn_desc_bench(void);
+bool tb_dyn_res_tests(void);
+bool tb_frame_stats_tests(void);
+bool tb_mesh_draws_tests(void);
+bool tb_mesh_opt_tests(void);
+bool tb_mesh_opt_bench(void);
+bool tb_mesh_ranges_tests(void);
+bool tb_assets_tests(void);
+bool tb_asset_hash_tests(void);
+bool tb_load_queue_tests(void);
+bool tb_transcode_cache_tests(void);
+bool tb_transcode_cache_bench(void);
+bool tb_tex_budget_tests(void);
+bool tb_desc_buffer_tests(void);
+bool tb_upload_timeline_tests(void);
+bool tb_shadow_cascades_tests(void);
+bool tb_prof_tests(void);
+bool tb_prof_bench(void);
+
+static const TbTestSuite tb_test_suites[] = {
+    {"sort", tb_sort_tests},
+    {"sort_bench", tb_sort_bench},
+    {"cull", tb_cull_tests},
+    {"cull_bench", tb_cull_bench},
+    {"mesh_cull_bench", tb_mesh_cull_bench},
+    {"offset_alloc", tb_offset_alloc_tests},
+    {"scene_cells", tb_scene_cells_tests},
+    {"dyn_desc", tb_dyn_desc_tests},
+    {"dyn_desc_bench", tb_dyn_desc_bench},
+    {"dyn_res", tb_dyn_res_tests},
+    {"frame_stats", tb_frame_stats_tests},
+    {"mesh_draws", tb_mesh_draws_tests},
+    {"mesh_opt", tb_mesh_opt_tests},
+    {"mesh_opt_bench", tb_mesh_opt_bench},
+    {"mesh_ranges", tb_mesh_ranges_tests},
+    {"assets", tb_assets_tests},
+    {"asset_hash", tb_asset_hash_tests},
+    {"load_queue", tb_load_queue_tests},
+    {"transcode_cache", tb_transcode_cache_tests},
+    {"transcode_cache_bench", tb_transcode_cache_bench},
+    {"tex_budget", tb_tex_budget_tests},
+    {"desc_buffer", tb_desc_buffer_tests},
+    {"upload_timeline", tb_upload_timeline_tests},
+    {"shadow_cascades", tb_shadow_cascades_tests},
+    {"prof", tb_prof_tests},
+    {"prof_bench", tb_prof_bench},
+};
+static const int32_t tb_test_suite_count =
+    sizeof(tb_test_suites) / sizeof(TbTestSuite);
+
+double tb_test_seconds(void) {
+  return (double)SDL_GetPerformanceCounter() /
+         (double)SDL_GetPerformanceFrequency();
+}
+
+uint64_t tb_test_rand(uint64_t *state) {
+  // xorshift64*
+  uint64_t x = *state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *state = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+int main(int argc, char **argv) {
+  const char *filter = argc > 1 ? argv[1] : NULL;
+  int32_t run = 0;
+  int32_t failed = 0;
+  for (int32_t i = 0; i < tb_test_suite_count; ++i) {
+    const TbTestSuite *suite = &tb_test_suites[i];
+    if (filter && SDL_strcmp(filter, suite->name) != 0) {
+      continue;
+    }
+    run++;
+    const bool passed = suite->fn();
+    printf("[%s] %s\n", passed ? "PASS" : "FAIL", suite->name);
+    if (!passed) {
+      failed++;
+    }
+  }
+  if (run == 0) {
+    printf("No test suite named %s\n", filter);
+    return 1;
+  }
+  return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+#include "tb_test.h"
+
+#include "tb_common.h"
+#include "tb_tex_budget.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#define TB_TEX_BUDGET_TEST_COUNT 32
+#define TB_TEX_BUDGET_TEST_MIN_SIZE 32
+// Bytes of upgrades let through each frame
+#define TB_TEX_BUDGET_TEST_UPLOAD (1024ull * 1024ull)
+// Frames a static scene gets to settle in
+#define TB_TEX_BUDGET_TEST_SETTLE 32
+
+// A square rgba8 texture with a full mip chain
+static TbTexBudgetRequest tb_tex_budget_test_request(uint32_t dim,
+                                                     uint32_t requested_mip) {
+  const uint32_t levels = (uint32_t)SDL_MostSignificantBitIndex32(dim) + 1;
+  TbTexBudgetRequest request = {0};
+  while ((dim >> request.min_mip) > TB_TEX_BUDGET_TEST_MIN_SIZE) {
+    request.min_mip++;
+  }
+  request.requested_mip = SDL_min(requested_mip, request.min_mip);
+  for (uint32_t level = 0; level <= request.min_mip; ++level) {
+    for (uint32_t mip = level; mip < levels; ++mip) {
+      const uint64_t mip_dim = dim >> mip;
+      request.mips_size[level] += mip_dim * mip_dim * 4;
+    }
+  }
+  return request;
+}
+
+// What the requests take when all are dropped by bias, worked out apart
+// from the solver
+static uint64_t tb_tex_budget_test_total(uint32_t count,
+                                         const TbTexBudgetRequest *requests,
+                                         uint32_t bias) {
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint32_t level =
+        SDL_min(requests[i].requested_mip + bias, requests[i].min_mip);
+    total += requests[i].mips_size[level];
+  }
+  return total;
+}
+
+// The solution fits when it can, each level is its request dropped by the
+// bias and no smaller bias would have fit
+static bool tb_tex_budget_test_check(uint32_t count,
+                                     const TbTexBudgetRequest *requests,
+                                     uint64_t budget,
+                                     const TbTexBudgetSolution *solution,
+                                     const uint32_t *levels) {
+  uint64_t min_total = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    min_total += requests[i].mips_size[requests[i].min_mip];
+    TB_EXPECT(levels[i] == SDL_min(requests[i].requested_mip + solution->bias,
+                                   requests[i].min_mip));
+  }
+  TB_EXPECT(solution->requested_bytes ==
+            tb_tex_budget_test_total(count, requests, 0));
+  TB_EXPECT(solution->solved_bytes ==
+            tb_tex_budget_test_total(count, requests, solution->bias));
+  if (min_total <= budget) {
+    TB_EXPECT(solution->solved_bytes <= budget);
+  } else {
+    TB_EXPECT(solution->solved_bytes == min_total);
+  }
+  if (solution->bias > 0) {
+    TB_EXPECT(tb_tex_budget_test_total(count, requests, solution->bias - 1) >
+              budget);
+  }
+  return true;
+}
+
+static bool tb_tex_budget_solve_tests(void) {
+  TbTexBudgetRequest requests[4] = {
+      tb_tex_budget_test_request(256, 0),
+      tb_tex_budget_test_request(1024, 1),
+      tb_tex_budget_test_request(512, 3),
+      tb_tex_budget_test_request(2048, 0),
+  };
+  const uint32_t count = sizeof(requests) / sizeof(requests[0]);
+  uint32_t levels[4] = {0};
+  const uint64_t requested = tb_tex_budget_test_total(count, requests, 0);
+
+  // Everything fits as asked
+  tb_auto solution = tb_solve_tex_budget(count, requests, requested, levels);
+  TB_EXPECT(solution.bias == 0);
+  TB_EXPECT(tb_tex_budget_test_check(count, requests, requested, &solution,
+                                     levels));
+
+  // One byte short drops every request by a level, even those that were
+  // already small, but none past its min mip
+  solution = tb_solve_tex_budget(count, requests, requested - 1, levels);
+  TB_EXPECT(solution.bias == 1);
+  TB_EXPECT(tb_tex_budget_test_check(count, requests, requested - 1,
+                                     &solution, levels));
+  TB_EXPECT(levels[2] == requests[2].min_mip);
+
+  // Every budget in between lands on the smallest bias that fits
+  const uint64_t min_total = tb_tex_budget_test_total(count, requests, 16);
+  for (uint64_t budget = min_total; budget <= requested;
+       budget += (requested - min_total) / 97) {
+    solution = tb_solve_tex_budget(count, requests, budget, levels);
+    TB_EXPECT(tb_tex_budget_test_check(count, requests, budget, &solution,
+                                       levels));
+  }
+
+  // When even the min mips don't fit that's what everything gets
+  solution = tb_solve_tex_budget(count, requests, min_total - 1, levels);
+  TB_EXPECT(tb_tex_budget_test_check(count, requests, min_total - 1,
+                                     &solution, levels));
+  for (uint32_t i = 0; i < count; ++i) {
+    TB_EXPECT(levels[i] == requests[i].min_mip);
+  }
+
+  // Nothing to stream is nothing to solve
+  solution = tb_solve_tex_budget(0, NULL, 0, NULL);
+  TB_EXPECT(solution.bias == 0 && solution.solved_bytes == 0);
+  return true;
+}
+
+// The camera starts far away, approaches, holds still, backs off and holds
+// still again. Each texture's distance is its own so requests spread over
+// several levels
+static uint32_t tb_tex_budget_test_mip(uint32_t frame, uint32_t tex) {
+  float t = 1.0f;
+  if (frame < 100) {
+    t = 1.0f - (float)frame / 100.0f;
+  } else if (frame < 200) {
+    t = 0.0f;
+  } else if (frame < 250) {
+    t = (float)(frame - 200) / 100.0f;
+  } else {
+    t = 0.5f;
+  }
+  return (uint32_t)(t * 8.0f) + tex % 3;
+}
+
+// Residency follows the solved levels the way tb_stream_textures does it.
+// Evictions land right away and upgrades are capped each frame, so a scene
+// that stops changing must settle on one set of levels and stay there
+static bool tb_tex_budget_converge_tests(void) {
+  const uint32_t dims[] = {256, 512, 1024, 2048};
+  TbTexBudgetRequest requests[TB_TEX_BUDGET_TEST_COUNT] = {0};
+  uint32_t levels[TB_TEX_BUDGET_TEST_COUNT] = {0};
+  uint32_t prev_levels[TB_TEX_BUDGET_TEST_COUNT] = {0};
+  uint32_t resident[TB_TEX_BUDGET_TEST_COUNT] = {0};
+  for (uint32_t i = 0; i < TB_TEX_BUDGET_TEST_COUNT; ++i) {
+    requests[i] = tb_tex_budget_test_request(dims[i % 4], 0);
+    resident[i] = requests[i].min_mip;
+  }
+  // Tight enough that the near part of the script has to be biased
+  const uint64_t budget =
+      tb_tex_budget_test_total(TB_TEX_BUDGET_TEST_COUNT, requests, 0) / 4;
+
+  uint32_t max_bias = 0;
+  uint32_t static_frames = 0;
+  for (uint32_t frame = 0; frame < 300; ++frame) {
+    bool moved = false;
+    for (uint32_t i = 0; i < TB_TEX_BUDGET_TEST_COUNT; ++i) {
+      const uint32_t mip =
+          SDL_min(tb_tex_budget_test_mip(frame, i), requests[i].min_mip);
+      moved |= mip != requests[i].requested_mip;
+      requests[i].requested_mip = mip;
+    }
+    static_frames = moved ? 0 : static_frames + 1;
+
+    tb_auto solution = tb_solve_tex_budget(TB_TEX_BUDGET_TEST_COUNT, requests,
+                                           budget, levels);
+    TB_EXPECT(tb_tex_budget_test_check(TB_TEX_BUDGET_TEST_COUNT, requests,
+                                       budget, &solution, levels));
+    max_bias = SDL_max(max_bias, solution.bias);
+
+    uint64_t uploaded = 0;
+    bool pending = false;
+    for (uint32_t i = 0; i < TB_TEX_BUDGET_TEST_COUNT; ++i) {
+      if (levels[i] > resident[i]) {
+        resident[i] = levels[i];
+      } else if (levels[i] < resident[i]) {
+        const uint64_t size = requests[i].mips_size[levels[i]];
+        if (uploaded > 0 && uploaded + size > TB_TEX_BUDGET_TEST_UPLOAD) {
+          pending = true;
+          continue;
+        }
+        resident[i] = levels[i];
+        uploaded += size;
+      }
+    }
+
+    // Residency never goes over what was solved for
+    uint64_t resident_bytes = 0;
+    for (uint32_t i = 0; i < TB_TEX_BUDGET_TEST_COUNT; ++i) {
+      TB_EXPECT(resident[i] >= levels[i]);
+      resident_bytes += requests[i].mips_size[resident[i]];
+    }
+    TB_EXPECT(resident_bytes <= budget);
+
+    // A static scene never changes its mind, and once every upgrade it
+    // waited on has landed residency stays put
+    if (static_frames > 0) {
+      TB_EXPECT(SDL_memcmp(levels, prev_levels, sizeof(levels)) == 0);
+    }
+    if (static_frames >= TB_TEX_BUDGET_TEST_SETTLE) {
+      TB_EXPECT(!pending);
+      TB_EXPECT(SDL_memcmp(levels, resident, sizeof(levels)) == 0);
+    }
+    SDL_memcpy(prev_levels, levels, sizeof(levels)); // NOLINT
+  }
+  TB_EXPECT(max_bias > 0);
+  return true;
+}
+
+bool tb_tex_budget_tests(void) {
+  return tb_tex_budget_solve_tests() && tb_tex_budget_converge_tests();
+}
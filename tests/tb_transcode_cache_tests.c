@@ -0,0 +1,219 @@
+#include "tb_test.h"
+
+#include "tb_common.h"
+#include "tb_transcode_cache.h"
+#include "tb_vk.h"
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_stdinc.h>
+
+#define TB_TRANSCODE_TEST_DIR "tb_transcode_test_cache"
+#define TB_TRANSCODE_TEST_HASH 0x1234ABCD5678EF00ull
+
+// A noisy basis texture written to memory the way it would be stored in a
+// glb. Free with free()
+static uint8_t *tb_transcode_test_basis(uint32_t dim, uint32_t levels,
+                                        uint64_t seed, size_t *size) {
+  ktxTextureCreateInfo info = {
+      .vkFormat = VK_FORMAT_R8G8B8A8_UNORM,
+      .baseWidth = dim,
+      .baseHeight = dim,
+      .baseDepth = 1,
+      .numDimensions = 2,
+      .numLevels = levels,
+      .numLayers = 1,
+      .numFaces = 1,
+  };
+  ktxTexture2 *ktx = NULL;
+  ktx_error_code_e err =
+      ktxTexture2_Create(&info, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &ktx);
+  if (err != KTX_SUCCESS) {
+    return NULL;
+  }
+  tb_auto pixels = tb_alloc_nm_tp(tb_global_alloc, dim * dim * 4, uint8_t);
+  for (uint32_t level = 0; level < levels; ++level) {
+    const uint32_t level_dim = SDL_max(dim >> level, 1u);
+    const size_t level_size = (size_t)level_dim * level_dim * 4;
+    for (size_t i = 0; i < level_size; ++i) {
+      pixels[i] = (uint8_t)tb_test_rand(&seed);
+    }
+    ktxTexture_SetImageFromMemory(ktxTexture(ktx), level, 0, 0, pixels,
+                                  level_size);
+  }
+  tb_free(tb_global_alloc, pixels);
+
+  uint8_t *bytes = NULL;
+  err = ktxTexture2_CompressBasis(ktx, 0);
+  if (err == KTX_SUCCESS) {
+    err = ktxTexture_WriteToMemory(ktxTexture(ktx), &bytes, size);
+  }
+  ktxTexture_Destroy(ktxTexture(ktx));
+  return err == KTX_SUCCESS ? bytes : NULL;
+}
+
+// Opens the texture through the cache. Textures served from the cache have
+// their image data left in the file while fresh transcodes hold it in memory
+static bool tb_transcode_test_open(const uint8_t *data, size_t size,
+                                   ktx_transcode_fmt_e target, uint32_t dim,
+                                   uint32_t levels, bool expect_hit) {
+  ktxTexture2 *ktx = tb_open_ktx(TB_TRANSCODE_TEST_DIR, target, data, size,
+                                 TB_TRANSCODE_TEST_HASH);
+  TB_EXPECT(ktx != NULL);
+  TB_EXPECT(!ktxTexture2_NeedsTranscoding(ktx));
+  TB_EXPECT(ktx->baseWidth == dim);
+  TB_EXPECT(ktx->numLevels == levels);
+  TB_EXPECT((ktx->pData == NULL) == expect_hit);
+  ktxTexture_Destroy(ktxTexture(ktx));
+  return true;
+}
+
+static void tb_transcode_test_clear(void) {
+  const ktx_transcode_fmt_e targets[] = {KTX_TTF_BC7_RGBA, KTX_TTF_RGBA32};
+  for (uint32_t i = 0; i < sizeof(targets) / sizeof(targets[0]); ++i) {
+    const TbTranscodeKey key = {
+        .content_hash = TB_TRANSCODE_TEST_HASH,
+        .format = (uint32_t)targets[i],
+    };
+    char path[256] = {0};
+    tb_transcode_cache_path(TB_TRANSCODE_TEST_DIR, &key, path, sizeof(path));
+    SDL_RemovePath(path);
+  }
+  SDL_RemovePath(TB_TRANSCODE_TEST_DIR);
+}
+
+static bool tb_transcode_key_tests(void) {
+  const TbTranscodeKey key = {
+      .content_hash = TB_TRANSCODE_TEST_HASH,
+      .format = KTX_TTF_BC7_RGBA,
+      .width = 256,
+      .height = 128,
+      .levels = 9,
+      .layers = 1,
+  };
+  TB_EXPECT(tb_transcode_key_matches(&key, &key));
+
+  // Any difference in content, format or shape is a miss
+  TbTranscodeKey other = key;
+  other.content_hash++;
+  TB_EXPECT(!tb_transcode_key_matches(&key, &other));
+  other = key;
+  other.format = KTX_TTF_ASTC_4x4_RGBA;
+  TB_EXPECT(!tb_transcode_key_matches(&key, &other));
+  other = key;
+  other.width = 128;
+  TB_EXPECT(!tb_transcode_key_matches(&key, &other));
+  other = key;
+  other.height = 256;
+  TB_EXPECT(!tb_transcode_key_matches(&key, &other));
+  other = key;
+  other.levels = 8;
+  TB_EXPECT(!tb_transcode_key_matches(&key, &other));
+  other = key;
+  other.layers = 6;
+  TB_EXPECT(!tb_transcode_key_matches(&key, &other));
+
+  // Hash and format name the file, the shape doesn't
+  char path[256] = {0};
+  char other_path[256] = {0};
+  TB_EXPECT(tb_transcode_cache_path("cache", &key, path, sizeof(path)));
+  TB_EXPECT(SDL_strcmp(path, "cache/1234abcd5678ef00_6.ktx2") == 0);
+  other = key;
+  other.width = 1;
+  TB_EXPECT(tb_transcode_cache_path("cache", &other, other_path,
+                                    sizeof(other_path)));
+  TB_EXPECT(SDL_strcmp(path, other_path) == 0);
+  other = key;
+  other.format = KTX_TTF_ASTC_4x4_RGBA;
+  TB_EXPECT(tb_transcode_cache_path("cache", &other, other_path,
+                                    sizeof(other_path)));
+  TB_EXPECT(SDL_strcmp(path, other_path) != 0);
+  other = key;
+  other.content_hash = 1;
+  TB_EXPECT(tb_transcode_cache_path("cache", &other, other_path,
+                                    sizeof(other_path)));
+  TB_EXPECT(SDL_strcmp(path, other_path) != 0);
+
+  // Paths that don't fit are never truncated into another file's name
+  TB_EXPECT(!tb_transcode_cache_path("cache", &key, path, 16));
+  return true;
+}
+
+// Different textures are opened under one content hash as if it had
+// collided. Each must be rejected by the file the previous one left behind
+static bool tb_transcode_cache_file_tests(void) {
+  size_t size_a = 0;
+  size_t size_b = 0;
+  size_t size_c = 0;
+  uint8_t *a = tb_transcode_test_basis(64, 1, 1, &size_a);
+  uint8_t *b = tb_transcode_test_basis(32, 1, 2, &size_b);
+  uint8_t *c = tb_transcode_test_basis(32, 2, 3, &size_c);
+  TB_EXPECT(a != NULL && b != NULL && c != NULL);
+
+  tb_transcode_test_clear();
+  SDL_CreateDirectory(TB_TRANSCODE_TEST_DIR);
+  const ktx_transcode_fmt_e bc7 = KTX_TTF_BC7_RGBA;
+  TB_EXPECT(tb_transcode_test_open(a, size_a, bc7, 64, 1, false));
+  TB_EXPECT(tb_transcode_test_open(a, size_a, bc7, 64, 1, true));
+
+  // Another format is cached on its own
+  TB_EXPECT(tb_transcode_test_open(a, size_a, KTX_TTF_RGBA32, 64, 1, false));
+  TB_EXPECT(tb_transcode_test_open(a, size_a, KTX_TTF_RGBA32, 64, 1, true));
+  TB_EXPECT(tb_transcode_test_open(a, size_a, bc7, 64, 1, true));
+
+  // A different size and then a different level count replace the file
+  TB_EXPECT(tb_transcode_test_open(b, size_b, bc7, 32, 1, false));
+  TB_EXPECT(tb_transcode_test_open(b, size_b, bc7, 32, 1, true));
+  TB_EXPECT(tb_transcode_test_open(c, size_c, bc7, 32, 2, false));
+  TB_EXPECT(tb_transcode_test_open(c, size_c, bc7, 32, 2, true));
+
+  tb_transcode_test_clear();
+  free(a);
+  free(b);
+  free(c);
+  return true;
+}
+
+bool tb_transcode_cache_tests(void) {
+  return tb_transcode_key_tests() && tb_transcode_cache_file_tests();
+}
+
+// Load time cost of a basis texture the first time it's seen, which
+// transcodes and writes the cache, against every time after that
+bool tb_transcode_cache_bench(void) {
+  const uint32_t dims[] = {256, 1024};
+  const uint32_t runs = 4;
+  for (uint32_t i = 0; i < sizeof(dims) / sizeof(dims[0]); ++i) {
+    const uint32_t levels = (uint32_t)SDL_MostSignificantBitIndex32(dims[i]);
+    size_t size = 0;
+    uint8_t *data = tb_transcode_test_basis(dims[i], levels + 1, i, &size);
+    TB_EXPECT(data != NULL);
+
+    double cold_ms = 0.0;
+    double warm_ms = 0.0;
+    for (uint32_t run = 0; run < runs; ++run) {
+      tb_transcode_test_clear();
+      SDL_CreateDirectory(TB_TRANSCODE_TEST_DIR);
+      double start = tb_test_seconds();
+      ktxTexture2 *ktx = tb_open_ktx(TB_TRANSCODE_TEST_DIR, KTX_TTF_BC7_RGBA,
+                                     data, size, TB_TRANSCODE_TEST_HASH);
+      cold_ms += (tb_test_seconds() - start) * 1000.0;
+      TB_EXPECT(ktx != NULL && ktx->pData != NULL);
+      ktxTexture_Destroy(ktxTexture(ktx));
+
+      // Cached image data is only read when it's uploaded so count it here
+      start = tb_test_seconds();
+      ktx = tb_open_ktx(TB_TRANSCODE_TEST_DIR, KTX_TTF_BC7_RGBA, data, size,
+                        TB_TRANSCODE_TEST_HASH);
+      TB_EXPECT(ktx != NULL && ktx->pData == NULL);
+      TB_EXPECT(ktxTexture_LoadImageData(ktxTexture(ktx), NULL, 0) ==
+                KTX_SUCCESS);
+      warm_ms += (tb_test_seconds() - start) * 1000.0;
+      ktxTexture_Destroy(ktxTexture(ktx));
+    }
+    printf("  %5u^2: cold %9.3f ms, warm %9.3f ms\n", dims[i],
+           cold_ms / runs, warm_ms / runs);
+    tb_transcode_test_clear();
+    free(data);
+  }
+  return true;
+}
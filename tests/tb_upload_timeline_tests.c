@@ -0,0 +1,178 @@
+#include "tb_test.h"
+
+#include "tb_common.h"
+#include "tb_render_common.h"
+#include "tb_upload_timeline.h"
+
+#define TB_UPLOAD_TEST_FRAMES 500
+#define TB_UPLOAD_TEST_MAX_PER_FRAME 4
+#define TB_UPLOAD_TEST_MAX_UPLOADS                                             \
+  (TB_UPLOAD_TEST_FRAMES * TB_UPLOAD_TEST_MAX_PER_FRAME)
+// Frames a submission may take on the fake gpu
+#define TB_UPLOAD_TEST_MAX_LATENCY 3
+
+typedef struct TbUploadTestUpload {
+  uint64_t game_value;   // What the async upload call returned
+  uint64_t submit_value; // What its submission signals
+  bool executed;
+  bool used;
+  uint32_t acquire_count;
+} TbUploadTestUpload;
+
+typedef struct TbUploadTestSubmit {
+  uint64_t value;
+  uint32_t done_frame;
+} TbUploadTestSubmit;
+
+typedef struct TbUploadTest {
+  TbUploadTestUpload uploads[TB_UPLOAD_TEST_MAX_UPLOADS];
+  uint32_t upload_count;
+  // Submissions finish in the order they were made, like a single queue
+  TbUploadTestSubmit submits[TB_UPLOAD_TEST_FRAMES];
+  uint32_t submit_head;
+  uint32_t submit_tail;
+  uint64_t signaled;
+} TbUploadTest;
+
+static TbUploadTest tb_upload_test;
+
+// Runs both halves of every frame the way the render system and render
+// thread do. The game thread queues uploads against its frame state's value
+// and uses whatever tb_is_upload_value_complete reports. The render thread
+// submits them on the transfer queue, or on the graphics queue without one,
+// and records acquires for whatever has signaled before the frame's draws
+static bool tb_upload_timeline_test_run(bool transfer_queue, uint64_t seed) {
+  TbUploadTest *t = &tb_upload_test;
+  *t = (TbUploadTest){0};
+  TbUploadTimeline timeline = {0};
+  tb_create_upload_timeline(tb_global_alloc, transfer_queue, &timeline);
+
+  uint64_t frame_values[TB_MAX_FRAME_STATES] = {0};
+  for (uint32_t i = 0; i < TB_MAX_FRAME_STATES; ++i) {
+    frame_values[i] = i + 1;
+  }
+
+  uint64_t last_value = 0;
+  for (uint32_t frame = 0; frame < TB_UPLOAD_TEST_FRAMES; ++frame) {
+    // The gpu finishes what it can
+    while (t->submit_head < t->submit_tail &&
+           t->submits[t->submit_head].done_frame <= frame) {
+      tb_auto submit = &t->submits[t->submit_head++];
+      TB_EXPECT(submit->value > t->signaled);
+      t->signaled = submit->value;
+      for (uint32_t i = 0; i < t->upload_count; ++i) {
+        if (t->uploads[i].submit_value != 0 &&
+            t->uploads[i].submit_value <= t->signaled) {
+          t->uploads[i].executed = true;
+        }
+      }
+    }
+
+    // Game thread: anything reported complete is drawn with this frame.
+    // Nothing may be reported complete before its copy has run
+    const uint32_t state_idx = frame % TB_MAX_FRAME_STATES;
+    for (uint32_t i = 0; i < t->upload_count; ++i) {
+      tb_auto upload = &t->uploads[i];
+      if (!upload->used &&
+          tb_is_upload_value_complete(t->signaled, upload->game_value)) {
+        TB_EXPECT(upload->executed);
+        upload->used = true;
+      }
+    }
+    const uint32_t first_new = t->upload_count;
+    const uint32_t new_count =
+        (uint32_t)(tb_test_rand(&seed) % (TB_UPLOAD_TEST_MAX_PER_FRAME + 1));
+    for (uint32_t i = 0; i < new_count; ++i) {
+      t->uploads[t->upload_count++] = (TbUploadTestUpload){
+          .game_value = frame_values[state_idx],
+      };
+    }
+    const uint64_t frame_value = frame_values[state_idx];
+    frame_values[state_idx] += TB_MAX_FRAME_STATES;
+
+    // Render thread
+    const uint64_t value = tb_next_upload_value(&timeline, frame_value);
+    TB_EXPECT(value > last_value);
+    TB_EXPECT(value >= frame_value);
+    last_value = value;
+    for (uint32_t i = first_new; i < t->upload_count; ++i) {
+      t->uploads[i].submit_value = value;
+      if (transfer_queue) {
+        // The barrier's offset stands in for the upload it belongs to
+        TbQueueAcquire acquire = {
+            .value = value,
+            .buffer = {.offset = i},
+        };
+        tb_queue_upload_acquire(&timeline, &acquire);
+      }
+    }
+    // Either queue signals the value once a frame even with nothing in it
+    const uint32_t latency =
+        (uint32_t)(tb_test_rand(&seed) % (TB_UPLOAD_TEST_MAX_LATENCY + 1));
+    t->submits[t->submit_tail++] = (TbUploadTestSubmit){
+        .value = value,
+        .done_frame = frame + latency,
+    };
+
+    const uint64_t wait_value = tb_take_upload_acquires(&timeline, t->signaled);
+    TB_EXPECT(wait_value <= t->signaled);
+    uint64_t max_ready = 0;
+    TB_DYN_ARR_FOREACH(timeline.ready, i) {
+      tb_auto acquire = &TB_DYN_ARR_AT(timeline.ready, i);
+      TB_EXPECT(acquire->value <= t->signaled);
+      TB_EXPECT(acquire->buffer.offset < t->upload_count);
+      tb_auto upload = &t->uploads[acquire->buffer.offset];
+      TB_EXPECT(upload->executed);
+      upload->acquire_count++;
+      max_ready = SDL_max(max_ready, acquire->value);
+    }
+    TB_EXPECT(wait_value == max_ready);
+    TB_DYN_ARR_FOREACH(timeline.pending, i) {
+      TB_EXPECT(TB_DYN_ARR_AT(timeline.pending, i).value > t->signaled);
+    }
+
+    // Everything drawn this frame was acquired before the draws, and only
+    // the transfer queue path ever transfers ownership
+    for (uint32_t i = 0; i < t->upload_count; ++i) {
+      tb_auto upload = &t->uploads[i];
+      TB_EXPECT(upload->acquire_count <= 1);
+      if (upload->used) {
+        TB_EXPECT(upload->acquire_count == (transfer_queue ? 1 : 0));
+      }
+    }
+  }
+  TB_EXPECT(t->upload_count > 0);
+  if (!transfer_queue) {
+    TB_EXPECT(TB_DYN_ARR_EMPTY(timeline.pending));
+  }
+
+  tb_destroy_upload_timeline(&timeline);
+  return true;
+}
+
+static bool tb_upload_value_tests(void) {
+  TbUploadTimeline timeline = {0};
+  tb_create_upload_timeline(tb_global_alloc, true, &timeline);
+  TB_EXPECT(tb_next_upload_value(&timeline, 1) == 1);
+  TB_EXPECT(tb_next_upload_value(&timeline, 2) == 2);
+  // A frame state handed a stale value signals the next one
+  TB_EXPECT(tb_next_upload_value(&timeline, 2) == 3);
+  TB_EXPECT(tb_next_upload_value(&timeline, 1) == 4);
+  // A skipped value is fine as long as nothing goes backwards
+  TB_EXPECT(tb_next_upload_value(&timeline, 9) == 9);
+  tb_destroy_upload_timeline(&timeline);
+
+  TB_EXPECT(tb_is_upload_value_complete(0, 0));
+  TB_EXPECT(!tb_is_upload_value_complete(0, 1));
+  TB_EXPECT(tb_is_upload_value_complete(5, 5));
+  TB_EXPECT(tb_is_upload_value_complete(6, 5));
+  TB_EXPECT(!tb_is_upload_value_complete(4, 5));
+  return true;
+}
+
+bool tb_upload_timeline_tests(void) {
+  TB_EXPECT(tb_upload_value_tests());
+  TB_EXPECT(tb_upload_timeline_test_run(true, 0x7AA5));
+  TB_EXPECT(tb_upload_timeline_test_run(false, 0x6F8A));
+  return true;
+}
@@ -78,6 +78,7 @@ int32_t main(int32_t argc, char *argv[]) {
 
   // Main loop
   bool running = true;
+  TbScene scene = 0;
 
   uint64_t time = 0;
   uint64_t start_time = SDL_GetPerformanceCounter();
@@ -96,13 +97,12 @@ int32_t main(int32_t argc, char *argv[]) {
     if (viewer) {
       // Order matters; we can get both signals at once
       if (viewer->unload_scene_signal) {
-        // TODO: Properly wait for the render thread to be finished otherwise
-        // we'll destroy resources in flight
-        // tb_unload_scene(&world, &world.scenes.data[0]);
+        // GPU resources are only destroyed once no frame in flight uses them
+        tb_unload_scene(&world, &scene);
         viewer->unload_scene_signal = false;
       }
       if (viewer->load_scene_signal) {
-        tb_load_scene(&world, viewer->selected_scene);
+        scene = tb_load_scene(&world, viewer->selected_scene);
         viewer->load_scene_signal = false;
       }
     }